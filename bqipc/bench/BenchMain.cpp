@@ -10,21 +10,322 @@
 
 #include <benchmark/benchmark.h>
 
-class FixtureTest : public benchmark::Fixture {
- public:
-  void SetUp(const ::benchmark::State& state) {}
-  void TearDown(const ::benchmark::State& state) {}
+#include <iceoryx_posh/iceoryx_posh_config.hpp>
+#include <iceoryx_posh/internal/roudi/roudi.hpp>
+#include <iceoryx_posh/roudi/iceoryx_roudi_components.hpp>
+#include <iceoryx_posh/runtime/posh_runtime_single_process.hpp>
+
+#include "SHMCli.hpp"
+#include "SHMIPCConst.hpp"
+#include "SHMSrv.hpp"
+#include "def/MarketDataIF.hpp"
+#include "def/OrderInfoIF.hpp"
+#include "util/Datetime.hpp"
+#include "util/LatencyHistogram.hpp"
+
+using namespace bq;
+
+namespace {
+
+constexpr static MsgId MSG_ID_OF_BENCH = 60001;
+constexpr static std::size_t NUM_OF_MSG_EACH_BATCH = 64;
+
+//! 接收线程的工作方式，通过--recv_param指定，比如"recvMode=BusyPoll; cpuId=3"
+std::string recvParamInStrFmt;
+
+struct BenchMsg {
+  SHMHeader shmHeader_;
+  std::uint64_t tsOfSend_{0};
 };
 
-BENCHMARK_DEFINE_F(FixtureTest, test)(benchmark::State& st) {
+//! 每个benchmark使用独立的service，避免互相干扰
+std::string MakeAddr(const std::string& name) {
+  return fmt::format("BQIPCBench@BQIPCBench@{}@Bench", name);
+}
+
+template <typename SHMIPC>
+std::shared_ptr<SHMIPC> MakeAndStart(
+    const std::string& addr, const DataRecvCallback& dataRecvCallback,
+    std::optional<ClientChannel> clientChannel = std::nullopt) {
+  auto ret = std::make_shared<SHMIPC>(addr, dataRecvCallback);
+  if constexpr (std::is_same_v<SHMIPC, SHMCli>) {
+    ret->setClientChannel(*clientChannel);
+  }
+  if (!recvParamInStrFmt.empty()) {
+    ret->setRecvParam(recvParamInStrFmt);
+  }
+  ret->start();
+  while (!ret->isReady()) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return ret;
+}
+
+//! 接收线程没有在5秒内收到全部消息的时候返回false，避免benchmark卡死
+bool WaitForRecv(const std::atomic<std::uint64_t>& numOfRecv,
+                 std::uint64_t target) {
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (numOfRecv.load(std::memory_order_acquire) < target) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void SetCountersOfLatency(benchmark::State& st,
+                          const LatencyHistogram& histogram) {
+  const auto histogramData = histogram.getData();
+  st.counters["p50(ns)"] = histogramData.getPercentile(0.5);
+  st.counters["p90(ns)"] = histogramData.getPercentile(0.9);
+  st.counters["p99(ns)"] = histogramData.getPercentile(0.99);
+  st.counters["p999(ns)"] = histogramData.getPercentile(0.999);
+  st.counters["max(ns)"] = histogramData.max_;
+}
+
+//! 和实际使用中的行情、订单大小一致
+void ApplyMsgLen(benchmark::internal::Benchmark* b) {
+  b->ArgName("len");
+  b->Arg(sizeof(LastPrice));
+  b->Arg(sizeof(Tickers));
+  b->Arg(sizeof(OrderInfo));
+  b->Arg(sizeof(Books));
+}
+
+}  // namespace
+
+//!
+//! 单向时延：SHMCli发送，SHMSrv收到之后统计，一条消息收到之后再发下一条
+//!
+static void BM_OneWay(benchmark::State& st) {
+  const auto len = static_cast<std::size_t>(st.range(0));
+  const auto addr = MakeAddr(fmt::format("OneWay-{}", len));
+
+  auto histogram = std::make_unique<LatencyHistogram>();
+  std::atomic<std::uint64_t> numOfRecv{0};
+  auto shmSrv = MakeAndStart<SHMSrv>(
+      addr, [&](const void* shmBuf, std::size_t shmBufLen) {
+        const auto now = GetTotalNSSince1970();
+        const auto msg = static_cast<const BenchMsg*>(shmBuf);
+        histogram->record(now > msg->tsOfSend_ ? now - msg->tsOfSend_ : 0);
+        numOfRecv.fetch_add(1, std::memory_order_release);
+      });
+  auto shmCli = MakeAndStart<SHMCli>(addr, nullptr, 1);
+
+  std::uint64_t numOfSend = 0;
+  for (auto _ : st) {
+    shmCli->asyncSendMsgWithZeroCopy(
+        [](void* shmBuf) {
+          static_cast<BenchMsg*>(shmBuf)->tsOfSend_ = GetTotalNSSince1970();
+        },
+        MSG_ID_OF_BENCH, len);
+    if (!WaitForRecv(numOfRecv, ++numOfSend)) {
+      st.SkipWithError("Wait for msg timeout.");
+      break;
+    }
+  }
+
+  shmCli->stop();
+  shmSrv->stop();
+  st.SetItemsProcessed(st.iterations());
+  st.SetBytesProcessed(st.iterations() * len);
+  SetCountersOfLatency(st, *histogram);
+}
+BENCHMARK(BM_OneWay)->Apply(ApplyMsgLen)->Unit(benchmark::kMicrosecond);
+
+//!
+//! 往返时延：SHMCli发送请求，SHMSrv原样应答，SHMCli收到应答之后统计
+//!
+static void BM_PingPong(benchmark::State& st) {
+  const auto len = static_cast<std::size_t>(st.range(0));
+  const auto addr = MakeAddr(fmt::format("PingPong-{}", len));
+
+  SHMSrvSPtr shmSrv;
+  shmSrv = MakeAndStart<SHMSrv>(
+      addr, [&](const void* shmBufOfReq, std::size_t shmBufLenOfReq) {
+        shmSrv->sendRspWithZeroCopy(
+            [&](void* shmBufOfRsp) {
+              memcpy(shmBufOfRsp, shmBufOfReq, shmBufLenOfReq);
+            },
+            static_cast<const SHMHeader*>(shmBufOfReq), shmBufLenOfReq);
+      });
+
+  auto histogram = std::make_unique<LatencyHistogram>();
+  std::atomic<std::uint64_t> numOfRecv{0};
+  auto shmCli = MakeAndStart<SHMCli>(
+      addr,
+      [&](const void* shmBuf, std::size_t shmBufLen) {
+        const auto now = GetTotalNSSince1970();
+        const auto msg = static_cast<const BenchMsg*>(shmBuf);
+        histogram->record(now > msg->tsOfSend_ ? now - msg->tsOfSend_ : 0);
+        numOfRecv.fetch_add(1, std::memory_order_release);
+      },
+      1);
+
+  std::uint64_t numOfSend = 0;
+  for (auto _ : st) {
+    shmCli->asyncSendReqWithZeroCopy(
+        [](void* shmBuf) {
+          static_cast<BenchMsg*>(shmBuf)->tsOfSend_ = GetTotalNSSince1970();
+        },
+        MSG_ID_OF_BENCH, len);
+    if (!WaitForRecv(numOfRecv, ++numOfSend)) {
+      st.SkipWithError("Wait for rsp timeout.");
+      break;
+    }
+  }
+
+  shmCli->stop();
+  shmSrv->stop();
+  st.SetItemsProcessed(st.iterations());
+  SetCountersOfLatency(st, *histogram);
+}
+BENCHMARK(BM_PingPong)->Apply(ApplyMsgLen)->Unit(benchmark::kMicrosecond);
+
+//!
+//! 扇出吞吐：SHMSrv通过公共频道推送，range(0)个订阅者同时接收，每次迭代推送
+//! 一批消息并等待所有订阅者收完
+//!
+static void BM_FanOut(benchmark::State& st) {
+  const auto numOfSub = static_cast<std::size_t>(st.range(0));
+  const auto len = sizeof(Tickers);
+  const auto addr = MakeAddr(fmt::format("FanOut-{}", numOfSub));
+
+  auto shmSrv = MakeAndStart<SHMSrv>(addr, nullptr);
+
+  auto histogram = std::make_unique<LatencyHistogram>();
+  std::atomic<std::uint64_t> numOfRecv{0};
+  std::vector<SHMCliSPtr> shmCliGroup;
+  for (std::size_t i = 0; i < numOfSub; ++i) {
+    shmCliGroup.emplace_back(MakeAndStart<SHMCli>(
+        addr,
+        [&](const void* shmBuf, std::size_t shmBufLen) {
+          const auto now = GetTotalNSSince1970();
+          const auto msg = static_cast<const BenchMsg*>(shmBuf);
+          histogram->record(now > msg->tsOfSend_ ? now - msg->tsOfSend_ : 0);
+          numOfRecv.fetch_add(1, std::memory_order_release);
+        },
+        PUB_CHANNEL));
+  }
+
+  std::uint64_t numOfSend = 0;
   for (auto _ : st) {
-    int times = st.range(0);
-    for (int i = 0; i < times; ++i) {
+    for (std::size_t i = 0; i < NUM_OF_MSG_EACH_BATCH; ++i) {
+      shmSrv->pushMsgWithZeroCopy(
+          [](void* shmBuf) {
+            static_cast<BenchMsg*>(shmBuf)->tsOfSend_ = GetTotalNSSince1970();
+          },
+          PUB_CHANNEL, MSG_ID_OF_BENCH, len);
     }
+    numOfSend += NUM_OF_MSG_EACH_BATCH;
+    if (!WaitForRecv(numOfRecv, numOfSend * numOfSub)) {
+      st.SkipWithError("Wait for msg timeout.");
+      break;
+    }
+  }
+
+  for (auto& shmCli : shmCliGroup) {
+    shmCli->stop();
   }
+  shmSrv->stop();
+  st.SetItemsProcessed(numOfRecv.load());
+  SetCountersOfLatency(st, *histogram);
 }
-BENCHMARK_REGISTER_F(FixtureTest, test)
-    ->Unit(benchmark::kMicrosecond)
-    ->Arg(1000);
+BENCHMARK(BM_FanOut)
+    ->ArgName("numOfSub")
+    ->RangeMultiplier(2)
+    ->Range(1, 16)
+    ->Unit(benchmark::kMicrosecond);
+
+//!
+//! 推送一条消息的开销，pushMsg需要从调用方的内存拷贝到共享内存，
+//! pushMsgWithZeroCopy直接在共享内存中填写。
+//!
+enum class PushMode { Copy = 0, ZeroCopy = 1 };
 
-BENCHMARK_MAIN();
+static void BM_Push(benchmark::State& st) {
+  const auto len = static_cast<std::size_t>(st.range(0));
+  const auto pushMode = static_cast<PushMode>(st.range(1));
+  const auto addr = MakeAddr(
+      fmt::format("Push-{}-{}", len, magic_enum::enum_name(pushMode)));
+
+  auto shmSrv = MakeAndStart<SHMSrv>(addr, nullptr);
+  std::atomic<std::uint64_t> numOfRecv{0};
+  auto shmCli = MakeAndStart<SHMCli>(
+      addr,
+      [&](const void* shmBuf, std::size_t shmBufLen) {
+        numOfRecv.fetch_add(1, std::memory_order_release);
+      },
+      PUB_CHANNEL);
+
+  std::vector<char> buf(len, 0);
+  std::uint64_t numOfSend = 0;
+  for (auto _ : st) {
+    if (pushMode == PushMode::Copy) {
+      reinterpret_cast<BenchMsg*>(buf.data())->tsOfSend_ =
+          GetTotalNSSince1970();
+      shmSrv->pushMsg(PUB_CHANNEL, MSG_ID_OF_BENCH, buf.data(), len);
+    } else {
+      shmSrv->pushMsgWithZeroCopy(
+          [](void* shmBuf) {
+            static_cast<BenchMsg*>(shmBuf)->tsOfSend_ = GetTotalNSSince1970();
+          },
+          PUB_CHANNEL, MSG_ID_OF_BENCH, len);
+    }
+    ++numOfSend;
+  }
+
+  if (!WaitForRecv(numOfRecv, numOfSend)) {
+    st.SkipWithError("Wait for msg timeout.");
+  }
+  shmCli->stop();
+  shmSrv->stop();
+  st.SetItemsProcessed(st.iterations());
+  st.SetBytesProcessed(st.iterations() * len);
+}
+BENCHMARK(BM_Push)
+    ->ArgNames({"len", "zeroCopy"})
+    ->Args({sizeof(LastPrice), 0})
+    ->Args({sizeof(LastPrice), 1})
+    ->Args({sizeof(Tickers), 0})
+    ->Args({sizeof(Tickers), 1})
+    ->Args({sizeof(OrderInfo), 0})
+    ->Args({sizeof(OrderInfo), 1})
+    ->Args({sizeof(Books), 0})
+    ->Args({sizeof(Books), 1})
+    ->Unit(benchmark::kNanosecond);
+
+//!
+//! 在进程内启动RouDi，不依赖外部的iox-roudi，也不需要网络：
+//! ./bqipc-bench [--recv_param="recvMode=BusyPoll; cpuId=3"] [benchmark参数]
+//!
+int main(int argc, char** argv) {
+  const std::string prefixOfRecvParam = "--recv_param=";
+  std::vector<char*> argGroup;
+  for (int i = 0; i < argc; ++i) {
+    const std::string arg(argv[i]);
+    if (boost::starts_with(arg, prefixOfRecvParam)) {
+      recvParamInStrFmt = arg.substr(prefixOfRecvParam.size());
+    } else {
+      argGroup.emplace_back(argv[i]);
+    }
+  }
+  argc = static_cast<int>(argGroup.size());
+
+  iox::RouDiConfig_t rouDiConfig = iox::RouDiConfig_t().setDefaults();
+  iox::roudi::IceOryxRouDiComponents rouDiComponents(rouDiConfig);
+  iox::roudi::RouDi rouDi(
+      rouDiComponents.rouDiMemoryManager, rouDiComponents.portManager,
+      iox::roudi::RouDi::RoudiStartupParameters{
+          iox::roudi::MonitoringMode::OFF, false});
+  //! SHMIPCBase中的initRuntime拿到的是这个进程内的runtime
+  iox::runtime::PoshRuntimeSingleProcess runtime("BQIPCBench");
+
+  benchmark::Initialize(&argc, argGroup.data());
+  if (benchmark::ReportUnrecognizedArguments(argc, argGroup.data())) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+  return 0;
+}
@@ -18,22 +18,34 @@
 
 namespace bq {
 
+//!
+//! v2版本的包头，固定32字节，和消息体的前半部分共用一个缓存行，消息体从32字节
+//! 对齐的位置开始：
+//! 1. 原来的 char topic_[MAX_TOPIC_LEN] 只用于日志和调试，却让每个消息多出一个
+//!    缓存行，现在替换为共享内存注册表中的topicId；
+//! 2. 按topic过滤和分发仍然使用topicHash_，需要topic字符串的时候通过
+//!    SHMIPCTopicRegistry::getTopic(topicId_)查询，不在热路径上。
+//!
 struct SHMHeader {
   SHMHeader() = default;
-  explicit SHMHeader(MsgId msgId) : msgId_(msgId) {
-    //! 防止toJson乱码
-    memset(topic_, 0, sizeof(topic_));
-  }
+  explicit SHMHeader(MsgId msgId) : msgId_(msgId) {}
 
   MsgId msgId_;
   ClientChannel clientChannel_{0};
-  Direction direction_;
+  TopicId topicId_{INVALID_TOPIC_ID};
   std::uint64_t timestamp_{0};
   TopicHash topicHash_{0};
-  char topic_[MAX_TOPIC_LEN];
+  Direction direction_;
+  std::uint8_t version_{SHM_HEADER_VERSION};
+  std::uint8_t reserved_[6]{0};
+
+  std::string getTopic() const;
 
   std::string toStr() const;
   std::string toJson() const;
 };
 
+static_assert(sizeof(SHMHeader) == SHM_HEADER_SIZE,
+              "sizeof(SHMHeader) == SHM_HEADER_SIZE");
+
 }  // namespace bq
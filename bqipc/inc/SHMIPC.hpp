@@ -12,6 +12,7 @@
 
 #include "SHMCli.hpp"
 #include "SHMHeader.hpp"
+#include "SHMIPCChunk.hpp"
 #include "SHMIPCConst.hpp"
 #include "SHMIPCDef.hpp"
 #include "SHMIPCMsgId.hpp"
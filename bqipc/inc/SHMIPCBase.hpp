@@ -18,11 +18,16 @@
 #include <iceoryx_posh/runtime/posh_runtime.hpp>
 
 #include "SHMHeader.hpp"
+#include "SHMIPCConst.hpp"
 #include "SHMIPCDef.hpp"
+#include "SHMIPCRecvParam.hpp"
 #include "util/Pch.hpp"
 
 namespace bq {
 
+class SHMIPCChunkMgr;
+using SHMIPCChunkMgrSPtr = std::shared_ptr<SHMIPCChunkMgr>;
+
 class SHMIPCBase;
 using SHMIPCBaseSPtr = std::shared_ptr<SHMIPCBase>;
 
@@ -33,10 +38,12 @@ class SHMIPCBase {
   SHMIPCBase(const SHMIPCBase&&) = delete;
   SHMIPCBase& operator=(const SHMIPCBase&&) = delete;
 
-  SHMIPCBase(const std::string& addr, const DataRecvCallback& dataRecvCallback);
+  SHMIPCBase(const std::string& addr, const DataRecvCallback& dataRecvCallback,
+             SlowConsumerPolicy slowConsumerPolicy = SlowConsumerPolicy::Block);
   SHMIPCBase(const std::string& appName, const std::string& service,
              const std::string& instance, const std::string& event,
-             const DataRecvCallback& dataRecvCallback);
+             const DataRecvCallback& dataRecvCallback,
+             SlowConsumerPolicy slowConsumerPolicy = SlowConsumerPolicy::Block);
 
  private:
   virtual void beforeInit() {}
@@ -46,6 +53,12 @@ class SHMIPCBase {
  private:
   static void dataInSHMRecvCallback(
       iox::popo::UntypedSubscriber* const subscriber, SHMIPCBase* self);
+  static void chunkReleasedCallback(iox::popo::UserTrigger* const trigger,
+                                    SHMIPCBase* self);
+
+  void handleChunk(const void* userPayload);
+  void handleChunkGroupWithConflation();
+  void updateNumOfMsgDropped(const void* userPayload);
 
  private:
   virtual void beforeUninit() {}
@@ -56,6 +69,8 @@ class SHMIPCBase {
 
  private:
   void startDataInSHMRecvThread();
+  void startDataInSHMBusyPollThread();
+  void waitAndHandleNotification();
 
  public:
   void stop();
@@ -63,6 +78,32 @@ class SHMIPCBase {
  public:
   bool isReady() { return isReady_.load(); }
 
+ public:
+  //! 接收端同时持有的chunk的上限，为0的时候不使用零拷贝，需在start之前设置
+  void setMaxNumOfChunkHeld(std::uint32_t value) { maxNumOfChunkHeld_ = value; }
+
+  //! 接收线程的工作方式，需在start之前设置，参数不合法时保持WaitSet模式
+  int setRecvParam(const std::string& recvParamInStrFmt);
+  SHMIPCRecvParamSPtr getRecvParam() const { return recvParam_; }
+  SHMIPCChunkMgrSPtr getChunkMgr() const { return chunkMgr_; }
+
+ public:
+  SlowConsumerPolicy getSlowConsumerPolicy() const {
+    return slowConsumerPolicy_;
+  }
+  //! 因为接收端处理得慢被丢弃的消息数量，根据chunk的序号计算
+  std::uint64_t getNumOfMsgDropped() const { return numOfMsgDropped_.load(); }
+  //! 因为同一个topic有更新的值而没有交给dataRecvCallback的消息数量
+  std::uint64_t getNumOfMsgConflated() const {
+    return numOfMsgConflated_.load();
+  }
+  std::string getSlowConsumerStatistics() const;
+
+  //! 包头版本和当前版本不一致而被丢弃的消息数量，比如新旧版本的进程混用
+  std::uint64_t getNumOfMsgOfInvalidVersion() const {
+    return numOfMsgOfInvalidVersion_.load();
+  }
+
  private:
   void waitForDataInSHMRecvThreadToEnd();
 
@@ -88,8 +129,25 @@ class SHMIPCBase {
 
   iox::popo::UntypedSubscriber* subscriber_{nullptr};
   iox::popo::UserTrigger* shutdownTrigger_{nullptr};
+  iox::popo::UserTrigger* chunkReleasedTrigger_{nullptr};
   iox::popo::WaitSet<>* waitset_{nullptr};
 
+  std::uint32_t maxNumOfChunkHeld_{DEFAULT_MAX_NUM_OF_CHUNK_HELD};
+  SHMIPCRecvParamSPtr recvParam_{std::make_shared<SHMIPCRecvParam>()};
+  SHMIPCChunkMgrSPtr chunkMgr_{nullptr};
+
+  SlowConsumerPolicy slowConsumerPolicy_{SlowConsumerPolicy::Block};
+  std::atomic<std::uint64_t> numOfMsgDropped_{0};
+  std::atomic<std::uint64_t> numOfMsgConflated_{0};
+  std::atomic<std::uint64_t> numOfMsgOfInvalidVersion_{0};
+
+  //! 以下只在接收线程中使用
+  ankerl::unordered_dense::map<std::uint64_t, std::uint64_t>
+      originId2NextSeqNo_;
+  std::vector<const void*> chunkGroupOfConflation_;
+  ankerl::unordered_dense::map<TopicHash, std::size_t> topicHash2PosOfLatest_;
+  std::uint32_t maxNumOfChunkConflatedEachTime_{0};
+
   std::future<void> futureDataInSHMRecv_;
   std::atomic_bool isReady_{false};
 };
@@ -0,0 +1,98 @@
+/*!
+ * \file SHMIPCChunk.hpp
+ * \project BetterQuant
+ *
+ * \author byrnexu
+ * \date 2023/03/22
+ *
+ * \brief
+ */
+
+#pragma once
+
+#include "SHMIPCDef.hpp"
+#include "SHMIPCTask.hpp"
+#include "util/Pch.hpp"
+#include "util/StdExt.hpp"
+
+namespace iox::popo {
+class UntypedSubscriber;
+class UserTrigger;
+}  // namespace iox::popo
+
+namespace bq {
+
+class SHMIPCChunkMgr;
+using SHMIPCChunkMgrSPtr = std::shared_ptr<SHMIPCChunkMgr>;
+
+//!
+//! 接收端零拷贝
+//!
+//! SHMIPCBase收到chunk之后不再拷贝，而是生成一个带引用计数的SHMChunkSPtr交给
+//! 工作线程，最后一个使用者释放之后，chunk才归还给iceoryx。
+//!
+//! iceoryx的subscriber不是线程安全的，所以工作线程并不直接release，而是放入
+//! 待归还队列并唤醒接收线程，由接收线程统一release。
+//!
+//! 每个subscriber同时持有的chunk数量有上限（maxNumOfChunkHeld），超出之后退回
+//! 拷贝，防止处理得慢的策略把共享内存池耗尽。
+//!
+class SHMIPCChunkMgr : public std::enable_shared_from_this<SHMIPCChunkMgr> {
+ public:
+  SHMIPCChunkMgr(const SHMIPCChunkMgr&) = delete;
+  SHMIPCChunkMgr& operator=(const SHMIPCChunkMgr&) = delete;
+  SHMIPCChunkMgr(const SHMIPCChunkMgr&&) = delete;
+  SHMIPCChunkMgr& operator=(const SHMIPCChunkMgr&&) = delete;
+
+  SHMIPCChunkMgr(iox::popo::UntypedSubscriber* subscriber,
+                 iox::popo::UserTrigger* chunkReleasedTrigger,
+                 std::uint32_t maxNumOfChunkHeld);
+
+ public:
+  //! 超出预算返回nullptr，由调用方拷贝
+  SHMChunkSPtr hold(const void* userPayload);
+
+  //! 只能在接收线程中调用
+  void releaseChunkGroupNoLongerUsed();
+
+  //! subscriber释放之前调用，之后归还的chunk直接丢弃
+  void close();
+
+ public:
+  std::uint32_t getNumOfChunkHeld() const { return numOfChunkHeld_.load(); }
+  std::uint64_t getNumOfChunkCopied() const {
+    return numOfChunkCopied_.load();
+  }
+
+ private:
+  void onChunkNoLongerUsed(const void* userPayload);
+
+ private:
+  iox::popo::UntypedSubscriber* subscriber_{nullptr};
+  iox::popo::UserTrigger* chunkReleasedTrigger_{nullptr};
+  const std::uint32_t maxNumOfChunkHeld_;
+
+  moodycamel::ConcurrentQueue<const void*> chunkGroupNoLongerUsed_;
+  std::atomic<std::uint32_t> numOfChunkHeld_{0};
+  std::atomic<std::uint64_t> numOfChunkCopied_{0};
+
+  bool closed_{false};
+  std::ext::spin_mutex mtxClosed_;
+};
+
+//! 接收线程在调用dataRecvCallback期间记录当前的chunk
+struct SHMIPCChunkCtx {
+  const void* userPayload_{nullptr};
+  SHMIPCChunkMgr* chunkMgr_{nullptr};
+  SHMChunkSPtr chunk_{nullptr};
+};
+
+//!
+//! 在dataRecvCallback中调用的时候，如果shmBuf就是当前收到的chunk并且没有超出
+//! 预算，那么生成零拷贝的SHMIPCTask，否则和原来一样拷贝一份。
+//!
+//! 同一个chunk多次调用返回的SHMIPCTask共享同一个chunk。
+//!
+SHMIPCTaskSPtr MakeSHMIPCTask(const void* shmBuf, std::size_t shmBufLen);
+
+}  // namespace bq
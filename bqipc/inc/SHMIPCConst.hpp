@@ -23,4 +23,16 @@ constexpr static ClientChannel MAIN_CHANNEL = 1;
 constexpr static int TIMES_OF_WAIT_FOR_SUBSCRIBER = 300;
 constexpr static std::uint32_t MAX_TOPIC_LEN = 128;
 
+//! v2版本的包头不再携带topic字符串，只携带注册表中的topicId和topicHash
+constexpr static std::uint8_t SHM_HEADER_VERSION = 2;
+constexpr static std::size_t SHM_HEADER_SIZE = 32;
+
+constexpr static TopicId INVALID_TOPIC_ID = 0;
+//! 必须是2的幂次，注册表按topicHash开放寻址
+constexpr static std::uint32_t MAX_NUM_OF_TOPIC_IN_REGISTRY = 65536;
+const static std::string NAME_OF_SHM_TOPIC_REGISTRY = "bq-shm-topic-registry";
+
+//! 接收端零拷贝的情况下，每个subscriber同时持有的chunk数量的默认上限
+constexpr static std::uint32_t DEFAULT_MAX_NUM_OF_CHUNK_HELD = 32;
+
 }  // namespace bq
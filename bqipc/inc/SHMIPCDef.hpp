@@ -15,8 +15,21 @@
 namespace bq {
 
 using ClientChannel = std::uint16_t;
+using TopicId = std::uint32_t;
 enum class Direction : std::uint8_t { Req = 1, Rsp, Push };
 
+//!
+//! 接收端处理不过来的时候的策略：
+//! Block      队列满了之后阻塞发送端，不丢消息，用于交易和风控等通道
+//! DropOldest 队列满了之后丢弃最旧的消息，发送端不会被阻塞
+//! Conflate   在DropOldest的基础上，同一个topic的最新值类行情只保留最后一条
+//!
+enum class SlowConsumerPolicy : std::uint8_t {
+  Block = 1,
+  DropOldest,
+  Conflate
+};
+
 using FillSHMBufCallback = std::function<void(void* shmBuf)>;
 using DataRecvCallback =
     std::function<void(const void* shmBuf, std::size_t shmBufLen)>;
@@ -26,6 +26,8 @@ constexpr static MsgId MSG_ID_ON_MD_BOOKS = 10005;
 constexpr static MsgId MSG_ID_ON_MD_BID1_ASK1 = 10006;
 constexpr static MsgId MSG_ID_ON_MD_LAST_PRICE = 10007;
 constexpr static MsgId MSG_ID_ON_MD_DYN_CANDLE = 10008;
+constexpr static MsgId MSG_ID_ON_MD_BOOKS_DELTA = 10009;
+constexpr static MsgId MSG_ID_BOOKS_SNAPSHOT_REQ = 10010;
 
 constexpr static MsgId MSG_ID_START_PLAYBACK_HIS_MD = 10021;
 
@@ -85,6 +87,9 @@ constexpr static MsgId MSG_ID_POS_SNAPSHOT_OF_STG_INST_ID = 10208;
 constexpr static MsgId MSG_ID_ASSETS_UPDATE = 10209;
 constexpr static MsgId MSG_ID_ASSETS_SNAPSHOT = 10210;
 
+constexpr static MsgId MSG_ID_POS_DELTA_OF_ALL = 10211;
+constexpr static MsgId MSG_ID_POS_KEYFRAME_REQ_OF_ALL = 10212;
+
 constexpr static MsgId MSG_ID_SYNC_SUB_INFO = 10301;
 
 inline std::string GetMsgName(MsgId msgId) {
@@ -107,6 +112,10 @@ inline std::string GetMsgName(MsgId msgId) {
       return "onMDLastPrice";
     case MSG_ID_ON_MD_DYN_CANDLE:
       return "onMDDynCandle";
+    case MSG_ID_ON_MD_BOOKS_DELTA:
+      return "onMDBooksDelta";
+    case MSG_ID_BOOKS_SNAPSHOT_REQ:
+      return "booksSnapshotReq";
     case MSG_ID_START_PLAYBACK_HIS_MD:
       return "startPlaybackHisMD";
 
@@ -210,6 +219,11 @@ inline std::string GetMsgName(MsgId msgId) {
     case MSG_ID_ASSETS_SNAPSHOT:
       return "assetsSnapshot";
 
+    case MSG_ID_POS_DELTA_OF_ALL:
+      return "posDeltaOfAll";
+    case MSG_ID_POS_KEYFRAME_REQ_OF_ALL:
+      return "posKeyframeReqOfAll";
+
     case MSG_ID_SYNC_SUB_INFO:
       return "syncSubInfo";
 
@@ -0,0 +1,50 @@
+/*!
+ * \file SHMIPCRecvParam.hpp
+ * \project BetterQuant
+ *
+ * \author byrnexu
+ * \date 2023/04/10
+ *
+ * \brief
+ */
+
+#pragma once
+
+#include "util/Pch.hpp"
+
+namespace bq {
+
+//!
+//! 接收线程的工作方式：
+//! WaitSet  通过iceoryx的WaitSet等待数据，空闲时不占用cpu，但是每次突发数据都要
+//!          经过一次futex唤醒
+//! BusyPoll 接收线程不停地检查队列，空闲时先自旋再让出cpu，空闲超过一定时间之后
+//!          才退回WaitSet等待，用于对时延敏感的通道
+//!
+enum class SHMIPCRecvMode : std::uint8_t { WaitSet = 1, BusyPoll };
+
+const static std::string DEFAULT_SHM_IPC_RECV_PARAM =
+    "recvMode=WaitSet; cpuId=-1; spinCountBeforeYield=10000; "
+    "microSecOfIdleBeforeWait=100000";
+
+struct SHMIPCRecvParam;
+using SHMIPCRecvParamSPtr = std::shared_ptr<SHMIPCRecvParam>;
+
+struct SHMIPCRecvParam {
+  SHMIPCRecvMode recvMode_{SHMIPCRecvMode::WaitSet};
+
+  //! 接收线程绑定的cpu，小于0则不绑定
+  int cpuId_{-1};
+
+  //! BusyPoll模式下队列为空时先自旋spinCountBeforeYield_次，之后让出cpu，
+  //! 连续空闲microSecOfIdleBeforeWait_微秒之后退回WaitSet等待，为0则一直轮询
+  std::uint32_t spinCountBeforeYield_{10000};
+  std::uint32_t microSecOfIdleBeforeWait_{100000};
+
+  std::string toStr() const;
+};
+
+std::tuple<int, SHMIPCRecvParamSPtr> MakeSHMIPCRecvParam(
+    const std::string& recvParamInStrFmt);
+
+}  // namespace bq
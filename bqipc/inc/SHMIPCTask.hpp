@@ -17,6 +17,9 @@ namespace bq {
 
 enum class CopyIPCData { True = 1, False = 2 };
 
+//! 共享内存中的chunk，最后一个使用者释放之后才归还给iceoryx
+using SHMChunkSPtr = std::shared_ptr<const void>;
+
 struct SHMIPCTask {
   SHMIPCTask() = default;
   SHMIPCTask(const void* origData, std::size_t origDataLen,
@@ -29,10 +32,22 @@ struct SHMIPCTask {
     }
     len_ = origDataLen;
   }
+
+  //! 零拷贝，data_直接指向共享内存中的chunk，只读
+  SHMIPCTask(const SHMChunkSPtr& chunk, std::size_t chunkLen)
+      : data_(const_cast<void*>(chunk.get())), len_(chunkLen), chunk_(chunk) {}
+
   void* data_{nullptr};
   std::size_t len_{0};
+  SHMChunkSPtr chunk_{nullptr};
+  //! 开启时延追踪的时候为策略引擎分发这条行情时的tsc
+  std::uint64_t tscOfDispatch_{0};
 
-  ~SHMIPCTask() { SAFE_FREE(data_); }
+  ~SHMIPCTask() {
+    if (chunk_ == nullptr) {
+      SAFE_FREE(data_);
+    }
+  }
 };
 using SHMIPCTaskSPtr = std::shared_ptr<SHMIPCTask>;
 
@@ -40,6 +55,10 @@ template <typename Msg>
 std::shared_ptr<Msg> MakeMsgSPtrByTask(
     const SHMIPCTaskSPtr& task, CopyIPCData copyIPCData = CopyIPCData::False) {
   Msg* msg = nullptr;
+  //! chunk中的数据其他进程也在使用，不能转移所有权给调用方修改，只能拷贝
+  if (task->chunk_ != nullptr) {
+    copyIPCData = CopyIPCData::True;
+  }
   if (copyIPCData == CopyIPCData::False) {
     msg = static_cast<Msg*>(task->data_);
     std::shared_ptr<Msg> ret(msg);
@@ -0,0 +1,71 @@
+/*!
+ * \file SHMIPCTopicFilter.hpp
+ * \project BetterQuant
+ *
+ * \author byrnexu
+ * \date 2023/03/20
+ *
+ * \brief
+ */
+
+#pragma once
+
+#include "SHMIPCDef.hpp"
+#include "SHMIPCMsgId.hpp"
+#include "def/DefIF.hpp"
+#include "util/Pch.hpp"
+#include "util/StdExt.hpp"
+
+namespace bq {
+
+using TopicHashGroup = absl::flat_hash_set<TopicHash>;
+using ClientChannel2TopicHashGroup =
+    absl::flat_hash_map<ClientChannel, TopicHashGroup>;
+using ClientChannel2TopicHashGroupSPtr =
+    std::shared_ptr<const ClientChannel2TopicHashGroup>;
+using ClientChannelGroupOfTopicFilter = std::vector<ClientChannel>;
+
+//!
+//! 服务端公共频道（PUB_CHANNEL）的订阅过滤器
+//!
+//! 客户端使用独立的clientChannel订阅行情，并通过MSG_ID_SYNC_SUB_INFO将订阅的
+//! topic同步给服务端，服务端据此为每个clientChannel维护一个topicHash集合，推送
+//! 公共频道的行情时只推送给订阅了该topicHash的clientChannel。
+//!
+//! 推送线程很多，更新只在服务端的接收线程，所以采用写时复制，推送线程只在获取
+//! 快照的时候加一次自旋锁。
+//!
+class SHMIPCTopicFilter {
+ public:
+  SHMIPCTopicFilter(const SHMIPCTopicFilter&) = delete;
+  SHMIPCTopicFilter& operator=(const SHMIPCTopicFilter&) = delete;
+  SHMIPCTopicFilter(const SHMIPCTopicFilter&&) = delete;
+  SHMIPCTopicFilter& operator=(const SHMIPCTopicFilter&&) = delete;
+
+  SHMIPCTopicFilter();
+
+ public:
+  void update(ClientChannel clientChannel, TopicHashGroup topicHashGroup);
+  void remove(ClientChannel clientChannel);
+
+  //! 没有任何客户端开启过滤的时候推送走原来的路径，没有额外开销
+  bool empty() const { return empty_.load(std::memory_order_acquire); }
+
+  //! 行情类消息按topicHash过滤，其他消息（比如PubTopic）推送给所有开启过滤的
+  //! clientChannel
+  ClientChannelGroupOfTopicFilter getClientChannelGroup(
+      MsgId msgId, TopicHash topicHash) const;
+
+ private:
+  ClientChannel2TopicHashGroupSPtr getSnapshot() const;
+
+ private:
+  ClientChannel2TopicHashGroupSPtr clientChannel2TopicHashGroup_;
+  mutable std::ext::spin_mutex mtxClientChannel2TopicHashGroup_;
+  std::atomic_bool empty_{true};
+  std::mutex mtxUpdate_;
+};
+
+bool IsMsgOfMarketData(MsgId msgId);
+
+}  // namespace bq
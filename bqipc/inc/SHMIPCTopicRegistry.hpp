@@ -0,0 +1,54 @@
+/*!
+ * \file SHMIPCTopicRegistry.hpp
+ * \project BetterQuant
+ *
+ * \author byrnexu
+ * \date 2023/04/06
+ *
+ * \brief
+ */
+
+#pragma once
+
+#include "SHMIPCConst.hpp"
+#include "SHMIPCDef.hpp"
+#include "def/DefIF.hpp"
+#include "def/SHMDef.hpp"
+#include "util/Pch.hpp"
+
+namespace bq {
+
+struct TopicRegistryRec {
+  std::atomic<TopicHash> topicHash_{0};
+  std::atomic<std::uint32_t> ready_{0};
+  char topic_[MAX_TOPIC_LEN];
+};
+
+//!
+//! 共享内存中的topic注册表，同一台机器上所有使用bqipc的进程共用：
+//! 1. 发布端调用intern将topic登记到以topicHash开放寻址的固定大小的表中，表中
+//!    的位置加1就是topicId，只要共享内存不删除，同一个topic的topicId不变；
+//! 2. 已经登记过的topic只需要一次原子读，没有锁和内存分配，可以在推送线程调用；
+//! 3. 接收端调用getTopic将topicId还原为topic字符串，只用于日志和调试。
+//!
+//! 表满或者共享内存打开失败的时候intern返回INVALID_TOPIC_ID，不影响消息收发。
+//!
+class SHMIPCTopicRegistry
+    : public boost::serialization::singleton<SHMIPCTopicRegistry> {
+ public:
+  TopicId intern(const std::string& topic, TopicHash topicHash);
+  TopicId intern(const std::string& topic);
+
+  std::string getTopic(TopicId topicId);
+
+ private:
+  bool open();
+
+ private:
+  std::once_flag onceFlagOfOpen_;
+  bip::shared_memory_object shmObj_;
+  bip::mapped_region mappedRegion_;
+  TopicRegistryRec* recGroup_{nullptr};
+};
+
+}  // namespace bq
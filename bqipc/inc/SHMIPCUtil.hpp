@@ -13,12 +13,17 @@
 #include "SHMHeader.hpp"
 #include "SHMIPCConst.hpp"
 #include "SHMIPCDef.hpp"
+#include "SHMIPCMsgId.hpp"
 #include "util/PchBase.hpp"
 
 namespace bq {
 
 std::once_flag& GetOnceFlagOfAssignAppName();
 
+//! 只有表示最新状态的行情（比如tickers、books）可以合并，trades和booksDelta等
+//! 逐笔消息不能合并，lastPrice用于生成动态k线，也不能合并
+bool IsMsgOfLatestValue(MsgId msgId);
+
 template <typename T>
 void InitMsgBody(void* target, const T& source) {
   const auto targetAddr = static_cast<char*>(target) + sizeof(SHMHeader);
@@ -12,6 +12,7 @@
 
 #include "SHMIPCBase.hpp"
 #include "SHMIPCMsgId.hpp"
+#include "SHMIPCTopicFilter.hpp"
 #include "util/StdExt.hpp"
 
 namespace bq {
@@ -58,6 +59,19 @@ class SHMSrv : public SHMIPCBase {
  private:
   void beforePushMsg(ClientChannel clientChannel, MsgId msgId, void* data);
 
+ public:
+  //! 客户端通过MSG_ID_SYNC_SUB_INFO同步订阅信息后，服务端更新该客户端的过滤器
+  void updateTopicFilter(ClientChannel clientChannel,
+                         TopicHashGroup topicHashGroup);
+  void removeTopicFilter(ClientChannel clientChannel);
+
+ private:
+  void pushMsgOfPubChannelWithTopicFilter(
+      const FillSHMBufCallback& fillSHMBufCallback, std::size_t len);
+  //! 频道没有subscriber的时候返回false，公共频道除外
+  bool publishCopy(ClientChannel clientChannel, const void* data,
+                   std::size_t len);
+
  private:
   SafePublisherSPtr getSafePublisher(ClientChannel clientChannel);
 
@@ -65,6 +79,8 @@ class SHMSrv : public SHMIPCBase {
   std::array<SafePublisherSPtr, std::numeric_limits<ClientChannel>::max()>
       safePublisherGroup_;
   std::ext::spin_mutex mtxPubliserGroup_;
+
+  SHMIPCTopicFilter topicFilter_;
 };
 
 }  // namespace bq
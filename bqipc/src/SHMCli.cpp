@@ -89,6 +89,7 @@ void SHMCli::asyncSendMsgWithZeroCopy(
 void SHMCli::beforeAsyncSendReq(void* data, MsgId msgId) {
   auto header = static_cast<SHMHeader*>(data);
   header->direction_ = Direction::Req;
+  header->version_ = SHM_HEADER_VERSION;
   header->msgId_ = msgId;
   //! 填写clientChannel_是为了服务端能据此生成相应的应答通道
   header->clientChannel_ = *clientChannel_;
@@ -103,6 +104,8 @@ void SHMCli::writeRawDataToSHMWithZeroCopy(
         memset(userPayload, 0, shmBufLen);
         beforeAsyncSendReq(userPayload, msgId);
         fillSHMBufCallback(userPayload);
+        //! fillSHMBufCallback可能拷贝整个结构体覆盖包头，接收端会校验版本
+        static_cast<SHMHeader*>(userPayload)->version_ = SHM_HEADER_VERSION;
         publisher_->publish(userPayload);
       })
       .or_else([&](auto& error) {
@@ -11,17 +11,23 @@
 #include "SHMHeader.hpp"
 
 #include "SHMIPCMsgId.hpp"
+#include "SHMIPCTopicRegistry.hpp"
 #include "def/Def.hpp"
 #include "util/Datetime.hpp"
 
 namespace bq {
 
+std::string SHMHeader::getTopic() const {
+  return SHMIPCTopicRegistry::get_mutable_instance().getTopic(topicId_);
+}
+
 std::string SHMHeader::toStr() const {
-  const auto topic = strlen(topic_) == 0 ? "empty" : topic_;
-  const auto ret = fmt::format("{} Channel: {} {} {} topicHash: {} topic: {}",
-                               GetMsgName(msgId_), clientChannel_,
-                               magic_enum::enum_name(direction_),
-                               ConvertTsToPtime(timestamp_), topicHash_, topic);
+  auto topic = getTopic();
+  if (topic.empty()) topic = "empty";
+  const auto ret = fmt::format(
+      "{} Channel: {} {} {} topicHash: {} topicId: {} topic: {}",
+      GetMsgName(msgId_), clientChannel_, magic_enum::enum_name(direction_),
+      ConvertTsToPtime(timestamp_), topicHash_, topicId_, topic);
   return ret;
 }
 
@@ -45,8 +51,11 @@ std::string SHMHeader::toJson() const {
   writer.Key("topicHash");
   writer.Uint64(topicHash_);
 
+  writer.Key("topicId");
+  writer.Uint(topicId_);
+
   writer.Key("topic");
-  writer.String(topic_);
+  writer.String(getTopic().c_str());
 
   writer.EndObject();
 
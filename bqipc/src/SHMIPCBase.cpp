@@ -11,9 +11,11 @@
 #include "SHMIPCBase.hpp"
 
 #include "SHMHeader.hpp"
+#include "SHMIPCChunk.hpp"
 #include "SHMIPCConst.hpp"
 #include "SHMIPCUtil.hpp"
 #include "util/Logger.hpp"
+#include "util/Util.hpp"
 
 namespace bq {
 
@@ -37,7 +39,9 @@ namespace bq {
 //! 服务端马上创建一个带有clientChannel的与之对应的publisher
 //!
 SHMIPCBase::SHMIPCBase(const std::string& addr,
-                       const DataRecvCallback& dataRecvCallback) {
+                       const DataRecvCallback& dataRecvCallback,
+                       SlowConsumerPolicy slowConsumerPolicy)
+    : slowConsumerPolicy_(slowConsumerPolicy) {
   std::vector<std::string> fieldGroup;
   boost::split(fieldGroup, addr, boost::is_any_of(SEP_OF_SHM_SVC));
   appName_ = fieldGroup[0];
@@ -53,12 +57,14 @@ SHMIPCBase::SHMIPCBase(const std::string& addr,
 
 SHMIPCBase::SHMIPCBase(const std::string& appName, const std::string& service,
                        const std::string& instance, const std::string& event,
-                       const DataRecvCallback& dataRecvCallback)
+                       const DataRecvCallback& dataRecvCallback,
+                       SlowConsumerPolicy slowConsumerPolicy)
     : appName_(appName),
       service_(service),
       instance_(instance),
       event_(event),
-      dataRecvCallback_(dataRecvCallback) {
+      dataRecvCallback_(dataRecvCallback),
+      slowConsumerPolicy_(slowConsumerPolicy) {
   std::call_once(GetOnceFlagOfAssignAppName(), [this]() {
     iox::cxx::string<64> name(iox::cxx::TruncateToCapacity, appName_);
     iox::runtime::PoshRuntime::initRuntime(name);
@@ -83,7 +89,8 @@ void SHMIPCBase::init() {
        iox::capro::IdString_t(iox::cxx::TruncateToCapacity, event_)},
       makeSubscriberOptions());
   subscriber_->subscribe();
-  LOG_I("Create subscriber. {} [{}]", appName_, subscriberName_);
+  LOG_I("Create subscriber. {} [{}] [slowConsumerPolicy = {}]", appName_,
+        subscriberName_, magic_enum::enum_name(slowConsumerPolicy_));
 
   //! stop的时候shutdownTrigger_.trigger()，waitset_->wait()中断
   shutdownTrigger_ = new iox::popo::UserTrigger();
@@ -104,21 +111,47 @@ void SHMIPCBase::init() {
               subscriberName_);
       });
 
+  //! 工作线程用完chunk之后chunkReleasedTrigger_->trigger()，由接收线程归还
+  //! subscriber最多同时持有MAX_CHUNKS_HELD_PER_SUBSCRIBER_SIMULTANEOUSLY个chunk，
+  //! 还要留一个给正在处理的chunk
+  const auto maxNumOfChunkHeld =
+      std::min(maxNumOfChunkHeld_,
+               iox::MAX_CHUNKS_HELD_PER_SUBSCRIBER_SIMULTANEOUSLY - 1);
+  //! 合并模式下一次最多取出的chunk数量，和工作线程持有的chunk加起来不能超过
+  //! subscriber同时持有chunk的上限
+  maxNumOfChunkConflatedEachTime_ = std::max<std::uint32_t>(
+      1, iox::MAX_CHUNKS_HELD_PER_SUBSCRIBER_SIMULTANEOUSLY - 1 -
+             maxNumOfChunkHeld);
+  chunkReleasedTrigger_ = new iox::popo::UserTrigger();
+  chunkMgr_ = std::make_shared<SHMIPCChunkMgr>(
+      subscriber_, chunkReleasedTrigger_, maxNumOfChunkHeld);
+  waitset_
+      ->attachEvent(
+          *chunkReleasedTrigger_,
+          iox::popo::createNotificationCallback(chunkReleasedCallback, *this))
+      .or_else([this](auto) {
+        LOG_E("Failed to attach chunk released trigger. {} [{}]", appName_,
+              subscriberName_);
+      });
+
   afterInit();
 }
 
 void SHMIPCBase::dataInSHMRecvCallback(
     iox::popo::UntypedSubscriber* const subscriber, SHMIPCBase* self) {
+  //! 先归还已经用完的chunk，腾出预算
+  self->chunkMgr_->releaseChunkGroupNoLongerUsed();
+
+  if (self->slowConsumerPolicy_ == SlowConsumerPolicy::Conflate) {
+    self->handleChunkGroupWithConflation();
+    return;
+  }
+
   while (self->subscriber_->hasData()) {
     self->subscriber_->take()
         .and_then([&](const void* userPayload) {
-          auto chunkHeader =
-              iox::mepoo::ChunkHeader::fromUserPayload(userPayload);
-          if (self->dataRecvCallback_) {
-            self->dataRecvCallback_(userPayload,
-                                    chunkHeader->userPayloadSize());
-          }
-          subscriber->release(userPayload);
+          self->updateNumOfMsgDropped(userPayload);
+          self->handleChunk(userPayload);
         })
         .or_else([self](auto& result) {
           if (result != iox::popo::ChunkReceiveResult::NO_CHUNK_AVAILABLE) {
@@ -129,8 +162,123 @@ void SHMIPCBase::dataInSHMRecvCallback(
   }
 }
 
+void SHMIPCBase::handleChunk(const void* userPayload) {
+  auto chunkHeader = iox::mepoo::ChunkHeader::fromUserPayload(userPayload);
+  //! 包头的布局由版本决定，版本不一致的消息无法解析，直接丢弃
+  const auto version =
+      chunkHeader->userPayloadSize() >= sizeof(SHMHeader)
+          ? static_cast<const SHMHeader*>(userPayload)->version_
+          : 0;
+  if (version != SHM_HEADER_VERSION) {
+    if (numOfMsgOfInvalidVersion_.fetch_add(1, std::memory_order_relaxed) ==
+        0) {
+      LOG_E(
+          "Discard msg of invalid shm header version, "
+          "the peer may be built with another version of bqipc. {} [{}] "
+          "[version = {}, expected = {}]",
+          appName_, subscriberName_, static_cast<int>(version),
+          static_cast<int>(SHM_HEADER_VERSION));
+    }
+    subscriber_->release(userPayload);
+    return;
+  }
+
+  auto& chunkCtx = std::ext::tls_get<SHMIPCChunkCtx>();
+  //! 回调中通过MakeSHMIPCTask持有chunk的话，chunk由最后一个使用者归还
+  chunkCtx.userPayload_ = userPayload;
+  chunkCtx.chunkMgr_ = maxNumOfChunkHeld_ != 0 ? chunkMgr_.get() : nullptr;
+  if (dataRecvCallback_) {
+    dataRecvCallback_(userPayload, chunkHeader->userPayloadSize());
+  }
+  const auto chunkHeld = chunkCtx.chunk_ != nullptr;
+  chunkCtx = SHMIPCChunkCtx();
+  if (!chunkHeld) {
+    subscriber_->release(userPayload);
+  }
+}
+
+//!
+//! 一次取出队列中所有的chunk，最新值类的行情同一个topicHash只把最后一条交给
+//! dataRecvCallback，其他的直接归还，交给dataRecvCallback的顺序和到达的顺序
+//! 一致，其他消息不受影响。
+//!
+void SHMIPCBase::handleChunkGroupWithConflation() {
+  auto& chunkGroup = chunkGroupOfConflation_;
+  while (subscriber_->hasData()) {
+    chunkGroup.clear();
+    auto takeFailed = false;
+    while (chunkGroup.size() < maxNumOfChunkConflatedEachTime_ &&
+           !takeFailed) {
+      subscriber_->take()
+          .and_then([&](const void* userPayload) {
+            updateNumOfMsgDropped(userPayload);
+            chunkGroup.emplace_back(userPayload);
+          })
+          .or_else([&](auto& result) {
+            takeFailed = true;
+            if (result != iox::popo::ChunkReceiveResult::NO_CHUNK_AVAILABLE) {
+              LOG_E("Error receiving chunk. {} [{}]", appName_,
+                    subscriberName_);
+            }
+          });
+    }
+    if (chunkGroup.empty()) {
+      break;
+    }
+
+    topicHash2PosOfLatest_.clear();
+    for (std::size_t pos = 0; pos < chunkGroup.size(); ++pos) {
+      const auto shmHeader = static_cast<const SHMHeader*>(chunkGroup[pos]);
+      if (IsMsgOfLatestValue(shmHeader->msgId_) &&
+          shmHeader->topicHash_ != 0) {
+        topicHash2PosOfLatest_[shmHeader->topicHash_] = pos;
+      }
+    }
+
+    for (std::size_t pos = 0; pos < chunkGroup.size(); ++pos) {
+      const auto shmHeader = static_cast<const SHMHeader*>(chunkGroup[pos]);
+      if (IsMsgOfLatestValue(shmHeader->msgId_) &&
+          shmHeader->topicHash_ != 0 &&
+          topicHash2PosOfLatest_[shmHeader->topicHash_] != pos) {
+        subscriber_->release(chunkGroup[pos]);
+        numOfMsgConflated_.fetch_add(1, std::memory_order_relaxed);
+        continue;
+      }
+      handleChunk(chunkGroup[pos]);
+    }
+  }
+  chunkGroup.clear();
+}
+
+//!
+//! 同一个publisher发出的chunk的序号是连续的，阻塞模式下不会丢消息，其他模式下
+//! 根据序号的间隔统计被iceoryx丢弃的消息数量
+//!
+void SHMIPCBase::updateNumOfMsgDropped(const void* userPayload) {
+  if (slowConsumerPolicy_ == SlowConsumerPolicy::Block) {
+    return;
+  }
+  const auto chunkHeader =
+      iox::mepoo::ChunkHeader::fromUserPayload(userPayload);
+  const auto originId = static_cast<std::uint64_t>(chunkHeader->originId());
+  const auto seqNo = chunkHeader->sequenceNumber();
+  auto& nextSeqNo = originId2NextSeqNo_[originId];
+  if (nextSeqNo != 0 && seqNo > nextSeqNo) {
+    numOfMsgDropped_.fetch_add(seqNo - nextSeqNo, std::memory_order_relaxed);
+  }
+  nextSeqNo = seqNo + 1;
+}
+
+void SHMIPCBase::chunkReleasedCallback(iox::popo::UserTrigger* const trigger,
+                                       SHMIPCBase* self) {
+  self->chunkMgr_->releaseChunkGroupNoLongerUsed();
+}
+
 void SHMIPCBase::uninit() {
   beforeUninit();
+  if (chunkMgr_) {
+    chunkMgr_->close();
+  }
   if (subscriber_) {
     delete subscriber_;
     subscriber_ = nullptr;
@@ -143,6 +291,10 @@ void SHMIPCBase::uninit() {
     delete shutdownTrigger_;
     shutdownTrigger_ = nullptr;
   }
+  if (chunkReleasedTrigger_) {
+    delete chunkReleasedTrigger_;
+    chunkReleasedTrigger_ = nullptr;
+  }
 }
 
 void SHMIPCBase::start() {
@@ -150,21 +302,87 @@ void SHMIPCBase::start() {
   //! SubMgr中尚未成功init的SHMCli被使用的情况下会堵死，因此增加了此变量用于获取
   //! isReady为true的SHMCli
   isReady_.store(true);
-  LOG_I("Start SHM IPC Channel. {} [{}]", appName_, subscriberName_);
+  LOG_I("Start SHM IPC Channel. {} [{}] [{}]", appName_, subscriberName_,
+        recvParam_->toStr());
   futureDataInSHMRecv_ =
       std::async(std::launch::async, [this]() { startDataInSHMRecvThread(); });
 }
 
 //! 此处触发静态函数dataInSHMRecvCallback
 void SHMIPCBase::startDataInSHMRecvThread() {
+  if (recvParam_->cpuId_ >= 0) {
+    SetCpuAffinityOfCurThread(recvParam_->cpuId_);
+  }
+  if (recvParam_->recvMode_ == SHMIPCRecvMode::BusyPoll) {
+    startDataInSHMBusyPollThread();
+    return;
+  }
   while (keepRunning_.load()) {
-    auto notificationVector = waitset_->wait();
-    for (auto& notification : notificationVector) {
-      (*notification)();
+    waitAndHandleNotification();
+  }
+}
+
+//!
+//! 不经过WaitSet直接检查subscriber的队列，省掉每次突发数据的futex唤醒：
+//! 1. 队列为空时先自旋spinCountBeforeYield_次，然后让出cpu；
+//! 2. 连续空闲超过microSecOfIdleBeforeWait_之后退回WaitSet等待，有数据到达或者
+//!    工作线程归还chunk的时候被唤醒，然后继续轮询。
+//! 轮询期间WaitSet中积累的通知会让下一次wait立即返回，只是多一次空的回调。
+//!
+void SHMIPCBase::startDataInSHMBusyPollThread() {
+  const auto spinCountBeforeYield = recvParam_->spinCountBeforeYield_;
+  const auto idleDurBeforeWait =
+      std::chrono::microseconds(recvParam_->microSecOfIdleBeforeWait_);
+  std::uint32_t numOfIdleLoop = 0;
+  auto idleStartTime = std::chrono::steady_clock::now();
+
+  while (keepRunning_.load(std::memory_order_relaxed)) {
+    if (subscriber_->hasData()) {
+      dataInSHMRecvCallback(subscriber_, this);
+      numOfIdleLoop = 0;
+      continue;
     }
+
+    if (numOfIdleLoop < spinCountBeforeYield) {
+      ++numOfIdleLoop;
+      CpuRelax();
+      continue;
+    }
+
+    //! 自旋结束之后才开始计时，繁忙的时候不调用now
+    chunkMgr_->releaseChunkGroupNoLongerUsed();
+    const auto now = std::chrono::steady_clock::now();
+    if (numOfIdleLoop == spinCountBeforeYield) {
+      ++numOfIdleLoop;
+      idleStartTime = now;
+    } else if (idleDurBeforeWait.count() != 0 &&
+               now - idleStartTime >= idleDurBeforeWait) {
+      waitAndHandleNotification();
+      numOfIdleLoop = 0;
+      continue;
+    }
+    std::this_thread::yield();
   }
 }
 
+void SHMIPCBase::waitAndHandleNotification() {
+  auto notificationVector = waitset_->wait();
+  for (auto& notification : notificationVector) {
+    (*notification)();
+  }
+}
+
+int SHMIPCBase::setRecvParam(const std::string& recvParamInStrFmt) {
+  const auto [ret, recvParam] = MakeSHMIPCRecvParam(recvParamInStrFmt);
+  if (ret != 0) {
+    LOG_W("Set recv param of {} failed, use {} instead. [{}]", event_,
+          recvParam_->toStr(), recvParamInStrFmt);
+    return ret;
+  }
+  recvParam_ = recvParam;
+  return 0;
+}
+
 void SHMIPCBase::stop() {
   LOG_I("Stop SHM IPC Channel. {} [{}]", appName_, subscriberName_);
   isReady_.store(false);
@@ -197,13 +415,41 @@ iox::popo::PublisherOptions SHMIPCBase::makePublisherOptions() const {
   return publisherOptions;
 }
 
+//!
+//! 发布端仍然是WAIT_FOR_CONSUMER，只有subscriber同时是BLOCK_PRODUCER的时候才会
+//! 阻塞发布端，所以一个处理得慢的行情订阅者不会影响其他订阅者
+//!
 iox::popo::SubscriberOptions SHMIPCBase::makeSubscriberOptions() const {
   iox::popo::SubscriberOptions subscriberOptions;
   subscriberOptions.subscribeOnCreate = false;
-  subscriberOptions.queueCapacity = 16U;
-  subscriberOptions.queueFullPolicy =
-      iox::popo::QueueFullPolicy::BLOCK_PRODUCER;
+  switch (slowConsumerPolicy_) {
+    case SlowConsumerPolicy::DropOldest:
+      subscriberOptions.queueCapacity = 16U;
+      subscriberOptions.queueFullPolicy =
+          iox::popo::QueueFullPolicy::DISCARD_OLDEST_DATA;
+      break;
+    case SlowConsumerPolicy::Conflate:
+      //! 队列尽量大，这样被丢弃之前有更多的机会被合并
+      subscriberOptions.queueCapacity = iox::MAX_SUBSCRIBER_QUEUE_CAPACITY;
+      subscriberOptions.queueFullPolicy =
+          iox::popo::QueueFullPolicy::DISCARD_OLDEST_DATA;
+      break;
+    default:
+      subscriberOptions.queueCapacity = 16U;
+      subscriberOptions.queueFullPolicy =
+          iox::popo::QueueFullPolicy::BLOCK_PRODUCER;
+      break;
+  }
   return subscriberOptions;
 }
 
+std::string SHMIPCBase::getSlowConsumerStatistics() const {
+  const auto ret = fmt::format(
+      "{} [{}] [slowConsumerPolicy = {}] [numOfMsgDropped = {}] "
+      "[numOfMsgConflated = {}]",
+      appName_, subscriberName_, magic_enum::enum_name(slowConsumerPolicy_),
+      getNumOfMsgDropped(), getNumOfMsgConflated());
+  return ret;
+}
+
 }  // namespace bq
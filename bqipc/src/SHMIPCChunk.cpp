@@ -0,0 +1,82 @@
+/*!
+ * \file SHMIPCChunk.cpp
+ * \project BetterQuant
+ *
+ * \author byrnexu
+ * \date 2023/03/22
+ *
+ * \brief
+ */
+
+#include "SHMIPCChunk.hpp"
+
+#include <iceoryx_posh/popo/untyped_subscriber.hpp>
+#include <iceoryx_posh/popo/user_trigger.hpp>
+
+#include "util/Logger.hpp"
+
+namespace bq {
+
+SHMIPCChunkMgr::SHMIPCChunkMgr(iox::popo::UntypedSubscriber* subscriber,
+                               iox::popo::UserTrigger* chunkReleasedTrigger,
+                               std::uint32_t maxNumOfChunkHeld)
+    : subscriber_(subscriber),
+      chunkReleasedTrigger_(chunkReleasedTrigger),
+      maxNumOfChunkHeld_(maxNumOfChunkHeld) {}
+
+SHMChunkSPtr SHMIPCChunkMgr::hold(const void* userPayload) {
+  if (numOfChunkHeld_.load() >= maxNumOfChunkHeld_) {
+    ++numOfChunkCopied_;
+    return nullptr;
+  }
+  ++numOfChunkHeld_;
+  auto self = shared_from_this();
+  return SHMChunkSPtr(userPayload, [self](const void* userPayload) {
+    self->onChunkNoLongerUsed(userPayload);
+  });
+}
+
+void SHMIPCChunkMgr::onChunkNoLongerUsed(const void* userPayload) {
+  std::lock_guard<std::ext::spin_mutex> guard(mtxClosed_);
+  if (closed_) {
+    return;
+  }
+  chunkGroupNoLongerUsed_.enqueue(userPayload);
+  //! 唤醒接收线程归还chunk，接收线程处理之前多次trigger只会唤醒一次
+  chunkReleasedTrigger_->trigger();
+}
+
+void SHMIPCChunkMgr::releaseChunkGroupNoLongerUsed() {
+  const void* userPayload = nullptr;
+  while (chunkGroupNoLongerUsed_.try_dequeue(userPayload)) {
+    subscriber_->release(userPayload);
+    --numOfChunkHeld_;
+  }
+}
+
+void SHMIPCChunkMgr::close() {
+  releaseChunkGroupNoLongerUsed();
+  {
+    std::lock_guard<std::ext::spin_mutex> guard(mtxClosed_);
+    closed_ = true;
+  }
+  if (const auto numOfChunkHeld = numOfChunkHeld_.load(); numOfChunkHeld != 0) {
+    LOG_W("{} chunks are still in use when the subscriber is released.",
+          numOfChunkHeld);
+  }
+}
+
+SHMIPCTaskSPtr MakeSHMIPCTask(const void* shmBuf, std::size_t shmBufLen) {
+  auto& chunkCtx = std::ext::tls_get<SHMIPCChunkCtx>();
+  if (chunkCtx.userPayload_ == shmBuf && chunkCtx.chunkMgr_ != nullptr) {
+    if (chunkCtx.chunk_ == nullptr) {
+      chunkCtx.chunk_ = chunkCtx.chunkMgr_->hold(shmBuf);
+    }
+    if (chunkCtx.chunk_ != nullptr) {
+      return std::make_shared<SHMIPCTask>(chunkCtx.chunk_, shmBufLen);
+    }
+  }
+  return std::make_shared<SHMIPCTask>(shmBuf, shmBufLen);
+}
+
+}  // namespace bq
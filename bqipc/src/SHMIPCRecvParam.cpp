@@ -0,0 +1,76 @@
+/*!
+ * \file SHMIPCRecvParam.cpp
+ * \project BetterQuant
+ *
+ * \author byrnexu
+ * \date 2023/04/10
+ *
+ * \brief
+ */
+
+#include "SHMIPCRecvParam.hpp"
+
+#include "def/Def.hpp"
+#include "util/Logger.hpp"
+#include "util/String.hpp"
+
+namespace bq {
+
+std::string SHMIPCRecvParam::toStr() const {
+  const auto ret = fmt::format(
+      "recvMode={}; cpuId={}; spinCountBeforeYield={}; "
+      "microSecOfIdleBeforeWait={}",
+      magic_enum::enum_name(recvMode_), cpuId_, spinCountBeforeYield_,
+      microSecOfIdleBeforeWait_);
+  return ret;
+}
+
+std::tuple<int, SHMIPCRecvParamSPtr> MakeSHMIPCRecvParam(
+    const std::string& recvParamInStrFmt) {
+  //! 只配置了部分字段的时候其他字段使用默认值
+  const auto recvParamInStrFmtWithDft =
+      recvParamInStrFmt.empty()
+          ? DEFAULT_SHM_IPC_RECV_PARAM
+          : SetParam(DEFAULT_SHM_IPC_RECV_PARAM, recvParamInStrFmt);
+  auto [retOfStr2Map, recvParamTable] = Str2Map(recvParamInStrFmtWithDft);
+  if (retOfStr2Map != 0) {
+    LOG_E("Make shm ipc recv param failed. {}", recvParamInStrFmt);
+    return {retOfStr2Map, nullptr};
+  }
+
+  std::string fieldName;
+  std::string fieldValue;
+  auto ret = std::make_shared<SHMIPCRecvParam>();
+  try {
+    fieldName = "recvmode";
+    fieldValue = recvParamTable[fieldName];
+    const auto recvMode = magic_enum::enum_cast<SHMIPCRecvMode>(fieldValue);
+    if (!recvMode.has_value()) {
+      throw std::invalid_argument(fieldValue);
+    }
+    ret->recvMode_ = recvMode.value();
+
+    fieldName = "cpuid";
+    fieldValue = recvParamTable[fieldName];
+    ret->cpuId_ = CONV(int, fieldValue);
+
+    fieldName = "spincountbeforeyield";
+    fieldValue = recvParamTable[fieldName];
+    ret->spinCountBeforeYield_ = CONV(std::uint32_t, fieldValue);
+
+    fieldName = "microsecofidlebeforewait";
+    fieldValue = recvParamTable[fieldName];
+    ret->microSecOfIdleBeforeWait_ = CONV(std::uint32_t, fieldValue);
+
+  } catch (const std::exception& e) {
+    LOG_E(
+        "Make shm ipc recv param failed "
+        "because of invalid field info of {}. {}",
+        fieldName, e.what());
+    return {-1, SHMIPCRecvParamSPtr()};
+  }
+
+  return {0, ret};
+}
+
+}  // namespace bq
@@ -0,0 +1,81 @@
+/*!
+ * \file SHMIPCTopicFilter.cpp
+ * \project BetterQuant
+ *
+ * \author byrnexu
+ * \date 2023/03/20
+ *
+ * \brief
+ */
+
+#include "SHMIPCTopicFilter.hpp"
+
+namespace bq {
+
+SHMIPCTopicFilter::SHMIPCTopicFilter()
+    : clientChannel2TopicHashGroup_(
+          std::make_shared<ClientChannel2TopicHashGroup>()) {}
+
+void SHMIPCTopicFilter::update(ClientChannel clientChannel,
+                               TopicHashGroup topicHashGroup) {
+  std::lock_guard<std::mutex> guardOfUpdate(mtxUpdate_);
+  auto snapshot = getSnapshot();
+  //! 客户端定时全量同步订阅信息，大部分时候订阅没有变化，无需重建快照
+  const auto iter = snapshot->find(clientChannel);
+  if (iter != std::end(*snapshot) && iter->second == topicHashGroup) {
+    return;
+  }
+  auto newSnapshot =
+      std::make_shared<ClientChannel2TopicHashGroup>(*snapshot);
+  (*newSnapshot)[clientChannel] = std::move(topicHashGroup);
+  {
+    std::lock_guard<std::ext::spin_mutex> guard(
+        mtxClientChannel2TopicHashGroup_);
+    clientChannel2TopicHashGroup_ = newSnapshot;
+    empty_.store(newSnapshot->empty(), std::memory_order_release);
+  }
+}
+
+void SHMIPCTopicFilter::remove(ClientChannel clientChannel) {
+  std::lock_guard<std::mutex> guardOfUpdate(mtxUpdate_);
+  auto snapshot = getSnapshot();
+  if (snapshot->find(clientChannel) == std::end(*snapshot)) {
+    return;
+  }
+  auto newSnapshot =
+      std::make_shared<ClientChannel2TopicHashGroup>(*snapshot);
+  newSnapshot->erase(clientChannel);
+  {
+    std::lock_guard<std::ext::spin_mutex> guard(
+        mtxClientChannel2TopicHashGroup_);
+    clientChannel2TopicHashGroup_ = newSnapshot;
+    empty_.store(newSnapshot->empty(), std::memory_order_release);
+  }
+}
+
+ClientChannelGroupOfTopicFilter SHMIPCTopicFilter::getClientChannelGroup(
+    MsgId msgId, TopicHash topicHash) const {
+  ClientChannelGroupOfTopicFilter ret;
+  const auto snapshot = getSnapshot();
+  const auto isMsgOfMarketData = IsMsgOfMarketData(msgId);
+  for (const auto& rec : *snapshot) {
+    const auto& topicHashGroup = rec.second;
+    if (!isMsgOfMarketData ||
+        topicHashGroup.find(topicHash) != std::end(topicHashGroup)) {
+      ret.emplace_back(rec.first);
+    }
+  }
+  return ret;
+}
+
+ClientChannel2TopicHashGroupSPtr SHMIPCTopicFilter::getSnapshot() const {
+  std::lock_guard<std::ext::spin_mutex> guard(
+      mtxClientChannel2TopicHashGroup_);
+  return clientChannel2TopicHashGroup_;
+}
+
+bool IsMsgOfMarketData(MsgId msgId) {
+  return msgId >= MSG_ID_ON_MD_TRADES && msgId <= MSG_ID_ON_MD_BOOKS_DELTA;
+}
+
+}  // namespace bq
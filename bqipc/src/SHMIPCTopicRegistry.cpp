@@ -0,0 +1,88 @@
+/*!
+ * \file SHMIPCTopicRegistry.cpp
+ * \project BetterQuant
+ *
+ * \author byrnexu
+ * \date 2023/04/06
+ *
+ * \brief
+ */
+
+#include "SHMIPCTopicRegistry.hpp"
+
+#include "util/Logger.hpp"
+
+namespace bq {
+
+TopicId SHMIPCTopicRegistry::intern(const std::string& topic,
+                                    TopicHash topicHash) {
+  if (topic.empty() || topicHash == 0 || !open()) {
+    return INVALID_TOPIC_ID;
+  }
+
+  constexpr auto mask = MAX_NUM_OF_TOPIC_IN_REGISTRY - 1;
+  auto pos = static_cast<std::uint32_t>(topicHash) & mask;
+  for (std::uint32_t i = 0; i < MAX_NUM_OF_TOPIC_IN_REGISTRY; ++i) {
+    auto& rec = recGroup_[pos];
+    auto cur = rec.topicHash_.load(std::memory_order_acquire);
+    if (cur == 0) {
+      if (rec.topicHash_.compare_exchange_strong(cur, topicHash,
+                                                 std::memory_order_acq_rel)) {
+        strncpy(rec.topic_, topic.c_str(), sizeof(rec.topic_) - 1);
+        rec.ready_.store(1, std::memory_order_release);
+        return pos + 1;
+      }
+      //! 被其他进程或者线程抢先，cur中是抢先写入的topicHash
+    }
+    if (cur == topicHash) {
+      return pos + 1;
+    }
+    pos = (pos + 1) & mask;
+  }
+
+  return INVALID_TOPIC_ID;
+}
+
+TopicId SHMIPCTopicRegistry::intern(const std::string& topic) {
+  return intern(topic, XXH3_64bits(topic.data(), topic.size()));
+}
+
+std::string SHMIPCTopicRegistry::getTopic(TopicId topicId) {
+  if (topicId == INVALID_TOPIC_ID || topicId > MAX_NUM_OF_TOPIC_IN_REGISTRY ||
+      !open()) {
+    return "";
+  }
+  const auto& rec = recGroup_[topicId - 1];
+  if (rec.ready_.load(std::memory_order_acquire) == 0) {
+    return "";
+  }
+  return rec.topic_;
+}
+
+bool SHMIPCTopicRegistry::open() {
+  std::call_once(onceFlagOfOpen_, [this]() {
+    const auto size = sizeof(TopicRegistryRec) * MAX_NUM_OF_TOPIC_IN_REGISTRY;
+    try {
+      bip::permissions perm;
+      perm.set_unrestricted();
+      shmObj_ = bip::shared_memory_object(
+          bip::open_or_create, NAME_OF_SHM_TOPIC_REGISTRY.c_str(),
+          bip::read_write, perm);
+      //! 新建的共享内存全部为0，多个进程同时truncate到相同大小不会清空内容
+      bip::offset_t curSize = 0;
+      if (!shmObj_.get_size(curSize) ||
+          curSize < static_cast<bip::offset_t>(size)) {
+        shmObj_.truncate(size);
+      }
+      mappedRegion_ = bip::mapped_region(shmObj_, bip::read_write, 0, size);
+      recGroup_ = static_cast<TopicRegistryRec*>(mappedRegion_.get_address());
+    } catch (const std::exception& e) {
+      LOG_W("Open topic registry {} failed. [{}]", NAME_OF_SHM_TOPIC_REGISTRY,
+            e.what());
+      recGroup_ = nullptr;
+    }
+  });
+  return recGroup_ != nullptr;
+}
+
+}  // namespace bq
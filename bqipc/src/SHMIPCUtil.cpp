@@ -14,6 +14,7 @@
 
 #include "CommonIPCData.hpp"
 #include "SHMIPCMsgId.hpp"
+#include "SHMIPCTopicRegistry.hpp"
 #include "SHMSrv.hpp"
 #include "util/Logger.hpp"
 
@@ -24,6 +25,17 @@ std::once_flag& GetOnceFlagOfAssignAppName() {
   return ret;
 }
 
+bool IsMsgOfLatestValue(MsgId msgId) {
+  switch (msgId) {
+    case MSG_ID_ON_MD_TICKERS:
+    case MSG_ID_ON_MD_BOOKS:
+    case MSG_ID_ON_MD_BID1_ASK1:
+      return true;
+    default:
+      return false;
+  }
+}
+
 void PubTopic(const SHMSrvSPtr& shmSrv, const std::string& topicName,
               const std::string& topic, std::string data) {
   assert(shmSrv != nullptr && "shmSrv != nullptr");
@@ -48,12 +60,13 @@ void PubTopic(const SHMSrvSPtr& shmSrv, const std::string& topicName,
   LOG_I("PUB topic {}", dataWithTopic);
 
   const auto topicHash = XXH3_64bits(topic.data(), topic.size());
+  const auto topicId =
+      SHMIPCTopicRegistry::get_mutable_instance().intern(topic, topicHash);
   shmSrv->pushMsgWithZeroCopy(
       [&](void* shmBuf) {
         auto commonIPCData = static_cast<CommonIPCData*>(shmBuf);
-        strncpy(commonIPCData->shmHeader_.topic_, topic.c_str(),
-                MAX_TOPIC_LEN - 1);
         commonIPCData->shmHeader_.topicHash_ = topicHash;
+        commonIPCData->shmHeader_.topicId_ = topicId;
         commonIPCData->dataLen_ = dataWithTopic.size();
         strncpy(commonIPCData->data_, dataWithTopic.c_str(),
                 dataWithTopic.size() - 1);
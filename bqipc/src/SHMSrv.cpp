@@ -50,6 +50,8 @@ void SHMSrv::sendRspWithZeroCopy(const FillSHMBufCallback& fillSHMBufCallback,
           memset(userPayload, 0, shmBufLen);
           beforeSendRsp(reqHeader, userPayload);
           fillSHMBufCallback(userPayload);
+          //! fillSHMBufCallback可能拷贝整个结构体覆盖包头，接收端会校验版本
+          static_cast<SHMHeader*>(userPayload)->version_ = SHM_HEADER_VERSION;
           safePublisher->publisher_->publish(userPayload);
         })
         .or_else([&](auto& error) {
@@ -65,6 +67,17 @@ void SHMSrv::sendRspWithZeroCopy(const FillSHMBufCallback& fillSHMBufCallback,
 void SHMSrv::pushMsgWithZeroCopy(const FillSHMBufCallback& fillSHMBufCallback,
                                  ClientChannel clientChannel, MsgId msgId,
                                  std::size_t shmBufLen) {
+  if (clientChannel == PUB_CHANNEL && !topicFilter_.empty()) {
+    pushMsgOfPubChannelWithTopicFilter(
+        [&](void* data) {
+          beforePushMsg(clientChannel, msgId, data);
+          fillSHMBufCallback(data);
+          static_cast<SHMHeader*>(data)->version_ = SHM_HEADER_VERSION;
+        },
+        shmBufLen);
+    return;
+  }
+
   auto safePublisher = getSafePublisher(clientChannel);
   {
     std::lock_guard<std::ext::spin_mutex> guard(
@@ -74,6 +87,7 @@ void SHMSrv::pushMsgWithZeroCopy(const FillSHMBufCallback& fillSHMBufCallback,
           memset(userPayload, 0, shmBufLen);
           beforePushMsg(clientChannel, msgId, userPayload);
           fillSHMBufCallback(userPayload);
+          static_cast<SHMHeader*>(userPayload)->version_ = SHM_HEADER_VERSION;
           safePublisher->publisher_->publish(userPayload);
         })
         .or_else([&](auto& error) {
@@ -98,8 +112,7 @@ void SHMSrv::sendRsp(const SHMHeader* reqHeader, void* data, std::size_t len) {
           beforeSendRsp(reqHeader, userPayload);
           auto shmHeader = static_cast<SHMHeader*>(userPayload);
           shmHeader->topicHash_ = srcSHMHeader->topicHash_;
-          strncpy(shmHeader->topic_, srcSHMHeader->topic_,
-                  sizeof(shmHeader->topic_) - 1);
+          shmHeader->topicId_ = srcSHMHeader->topicId_;
           memcpy(static_cast<char*>(userPayload) + sizeof(SHMHeader),
                  static_cast<char*>(data) + sizeof(SHMHeader),
                  len - sizeof(SHMHeader));
@@ -119,12 +132,28 @@ void SHMSrv::beforeSendRsp(const SHMHeader* reqHeader, void* data) {
   rspHeader->msgId_ = reqHeader->msgId_;
   rspHeader->clientChannel_ = reqHeader->clientChannel_;
   rspHeader->direction_ = Direction::Rsp;
+  rspHeader->version_ = SHM_HEADER_VERSION;
   rspHeader->timestamp_ = reqHeader->timestamp_;
 }
 
 void SHMSrv::pushMsg(ClientChannel clientChannel, MsgId msgId, void* data,
                      std::size_t len) {
   const auto srcSHMHeader = static_cast<SHMHeader*>(data);
+  if (clientChannel == PUB_CHANNEL && !topicFilter_.empty()) {
+    pushMsgOfPubChannelWithTopicFilter(
+        [&](void* userPayload) {
+          beforePushMsg(clientChannel, msgId, userPayload);
+          auto shmHeader = static_cast<SHMHeader*>(userPayload);
+          shmHeader->topicHash_ = srcSHMHeader->topicHash_;
+          shmHeader->topicId_ = srcSHMHeader->topicId_;
+          memcpy(static_cast<char*>(userPayload) + sizeof(SHMHeader),
+                 static_cast<char*>(data) + sizeof(SHMHeader),
+                 len - sizeof(SHMHeader));
+        },
+        len);
+    return;
+  }
+
   auto safePublisher = getSafePublisher(clientChannel);
   {
     std::lock_guard<std::ext::spin_mutex> guard(
@@ -135,8 +164,7 @@ void SHMSrv::pushMsg(ClientChannel clientChannel, MsgId msgId, void* data,
           beforePushMsg(clientChannel, msgId, userPayload);
           auto shmHeader = static_cast<SHMHeader*>(userPayload);
           shmHeader->topicHash_ = srcSHMHeader->topicHash_;
-          strncpy(shmHeader->topic_, srcSHMHeader->topic_,
-                  sizeof(shmHeader->topic_) - 1);
+          shmHeader->topicId_ = srcSHMHeader->topicId_;
           memcpy(static_cast<char*>(userPayload) + sizeof(SHMHeader),
                  static_cast<char*>(data) + sizeof(SHMHeader),
                  len - sizeof(SHMHeader));
@@ -157,9 +185,87 @@ void SHMSrv::beforePushMsg(ClientChannel clientChannel, MsgId msgId,
   msgHeader->msgId_ = msgId;
   msgHeader->clientChannel_ = clientChannel;
   msgHeader->direction_ = Direction::Push;
+  msgHeader->version_ = SHM_HEADER_VERSION;
   msgHeader->timestamp_ = GetTotalUSSince1970();
 }
 
+void SHMSrv::updateTopicFilter(ClientChannel clientChannel,
+                               TopicHashGroup topicHashGroup) {
+  //! 公共频道本身不参与过滤
+  if (clientChannel == PUB_CHANNEL) {
+    LOG_W("Update topic filter failed because of invalid client channel {}.",
+          clientChannel);
+    return;
+  }
+  //! 在接收线程中提前创建publisher，避免推送行情的线程等待subscriber
+  getSafePublisher(clientChannel);
+  topicFilter_.update(clientChannel, std::move(topicHashGroup));
+}
+
+void SHMSrv::removeTopicFilter(ClientChannel clientChannel) {
+  topicFilter_.remove(clientChannel);
+}
+
+//!
+//! 开启了过滤的客户端使用独立的clientChannel，公共频道的消息只推送给订阅了该
+//! topic的clientChannel，没有订阅的行情不会再出现在它的共享内存队列中。
+//!
+//! iceoryx的chunk只能由loan它的publisher发布，所以消息先在本线程的缓冲区中组装
+//! 一次，再分别拷贝到公共频道和各个匹配的频道，每个频道只在自己的loan和发布期
+//! 间持有自己的锁。公共频道没有subscriber的时候不再发布，只有开启过滤的客户端
+//! 时公共频道没有额外开销。
+//!
+void SHMSrv::pushMsgOfPubChannelWithTopicFilter(
+    const FillSHMBufCallback& fillSHMBufCallback, std::size_t len) {
+  thread_local std::vector<char> buf;
+  if (buf.size() < len) {
+    buf.resize(len);
+  }
+  memset(buf.data(), 0, len);
+  fillSHMBufCallback(buf.data());
+
+  const auto shmHeader = reinterpret_cast<const SHMHeader*>(buf.data());
+  if (getSafePublisher(PUB_CHANNEL)->publisher_->hasSubscribers()) {
+    publishCopy(PUB_CHANNEL, buf.data(), len);
+  }
+
+  const auto clientChannelGroup = topicFilter_.getClientChannelGroup(
+      shmHeader->msgId_, shmHeader->topicHash_);
+  for (const auto clientChannel : clientChannelGroup) {
+    //! 客户端退出之后移除它的过滤器，重新连接并同步订阅信息之后再加回来
+    if (!publishCopy(clientChannel, buf.data(), len)) {
+      LOG_I("Remove topic filter of {} because of no subscriber.",
+            clientChannel);
+      removeTopicFilter(clientChannel);
+    }
+  }
+}
+
+bool SHMSrv::publishCopy(ClientChannel clientChannel, const void* data,
+                         std::size_t len) {
+  auto safePublisher = getSafePublisher(clientChannel);
+  std::lock_guard<std::ext::spin_mutex> guard(
+      safePublisher->mtxWriteRawDataToSHM_);
+  if (clientChannel != PUB_CHANNEL &&
+      !safePublisher->publisher_->hasSubscribers()) {
+    return false;
+  }
+  safePublisher->publisher_->loan(len)
+      .and_then([&](auto& userPayload) {
+        memcpy(userPayload, data, len);
+        static_cast<SHMHeader*>(userPayload)->clientChannel_ = clientChannel;
+        safePublisher->publisher_->publish(userPayload);
+      })
+      .or_else([&](auto& error) {
+        std::ostringstream oss;
+        oss << error;
+        LOG_E("Unable to loan shm. {} [{}{}{}-{}{}{}] [{}]", appName_, service_,
+              SEP_OF_SHM_SVC, instance_, clientChannel, SEP_OF_SHM_SVC, event_,
+              oss.str());
+      });
+  return true;
+}
+
 SafePublisherSPtr SHMSrv::getSafePublisher(ClientChannel clientChannel) {
   auto waitForSubscriberToBeVisible =
       [&](iox::popo::UntypedPublisher* publisher) {
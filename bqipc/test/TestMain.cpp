@@ -14,6 +14,11 @@
 #include <string>
 
 #include "SHMCli.hpp"
+#include "SHMIPCChunk.hpp"
+#include "SHMIPCRecvParam.hpp"
+#include "SHMIPCTopicFilter.hpp"
+#include "SHMIPCTopicRegistry.hpp"
+#include "SHMIPCUtil.hpp"
 #include "SHMSrv.hpp"
 #include "util/Datetime.hpp"
 #include "util/Logger.hpp"
@@ -138,6 +143,78 @@ TEST(test, testSHMIPC) {
   statics("client", timeUsedOfCliRecvGroup);
 }
 
+TEST(test, testSHMIPCTopicFilter) {
+  SHMIPCTopicFilter topicFilter;
+  EXPECT_TRUE(topicFilter.empty());
+
+  topicFilter.update(10000, {1, 2});
+  topicFilter.update(10001, {2, 3});
+  EXPECT_FALSE(topicFilter.empty());
+
+  auto ret = topicFilter.getClientChannelGroup(MSG_ID_ON_MD_TICKERS, 1);
+  EXPECT_TRUE(ret == ClientChannelGroupOfTopicFilter{10000});
+
+  ret = topicFilter.getClientChannelGroup(MSG_ID_ON_MD_TICKERS, 4);
+  EXPECT_TRUE(ret.empty());
+
+  //! 非行情类消息推送给所有开启过滤的客户端
+  ret = topicFilter.getClientChannelGroup(MSG_ID_ON_PUSH_TOPIC, 4);
+  EXPECT_EQ(ret.size(), 2);
+
+  topicFilter.remove(10000);
+  topicFilter.remove(10001);
+  EXPECT_TRUE(topicFilter.empty());
+}
+
+TEST(test, testSHMIPCTopicRegistry) {
+  auto& topicRegistry = SHMIPCTopicRegistry::get_mutable_instance();
+  const std::string topic = "MD@Binance@Spot@BTC-USDT@Trades";
+  const auto topicId = topicRegistry.intern(topic);
+  EXPECT_NE(topicId, INVALID_TOPIC_ID);
+  EXPECT_EQ(topicRegistry.intern(topic), topicId);
+  EXPECT_EQ(topicRegistry.getTopic(topicId), topic);
+  EXPECT_TRUE(topicRegistry.getTopic(INVALID_TOPIC_ID).empty());
+
+  SHMHeader shmHeader;
+  shmHeader.topicId_ = topicId;
+  EXPECT_EQ(shmHeader.getTopic(), topic);
+}
+
+TEST(test, testIsMsgOfLatestValue) {
+  EXPECT_TRUE(IsMsgOfLatestValue(MSG_ID_ON_MD_TICKERS));
+  EXPECT_TRUE(IsMsgOfLatestValue(MSG_ID_ON_MD_BOOKS));
+  EXPECT_FALSE(IsMsgOfLatestValue(MSG_ID_ON_MD_TRADES));
+  EXPECT_FALSE(IsMsgOfLatestValue(MSG_ID_ON_MD_BOOKS_DELTA));
+  EXPECT_FALSE(IsMsgOfLatestValue(MSG_ID_ON_ORDER_RET));
+}
+
+TEST(test, testMakeSHMIPCRecvParam) {
+  const auto [retOfDft, dftRecvParam] = MakeSHMIPCRecvParam("");
+  EXPECT_EQ(retOfDft, 0);
+  EXPECT_EQ(dftRecvParam->recvMode_, SHMIPCRecvMode::WaitSet);
+  EXPECT_EQ(dftRecvParam->cpuId_, -1);
+
+  const auto [ret, recvParam] =
+      MakeSHMIPCRecvParam("recvMode=BusyPoll; cpuId=3");
+  EXPECT_EQ(ret, 0);
+  EXPECT_EQ(recvParam->recvMode_, SHMIPCRecvMode::BusyPoll);
+  EXPECT_EQ(recvParam->cpuId_, 3);
+  EXPECT_EQ(recvParam->spinCountBeforeYield_, 10000);
+
+  const auto [retOfInvalid, invalidRecvParam] =
+      MakeSHMIPCRecvParam("recvMode=Spin");
+  EXPECT_NE(retOfInvalid, 0);
+}
+
+TEST(test, testMakeSHMIPCTask) {
+  //! 不在接收回调中调用的时候和原来一样拷贝
+  const std::string data = "test";
+  const auto task = MakeSHMIPCTask(data.c_str(), data.size() + 1);
+  EXPECT_TRUE(task->chunk_ == nullptr);
+  EXPECT_NE(task->data_, static_cast<const void*>(data.c_str()));
+  EXPECT_STREQ(static_cast<const char*>(task->data_), data.c_str());
+}
+
 int main(int argc, char** argv) {
   testing::AddGlobalTestEnvironment(new global_event);
   testing::InitGoogleTest(&argc, argv);
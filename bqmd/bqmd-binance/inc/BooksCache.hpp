@@ -12,11 +12,24 @@
 
 #include "def/BQDef.hpp"
 #include "def/BQMDDef.hpp"
+#include "def/ConstIF.hpp"
 #include "def/Def.hpp"
 #include "util/Decimal.hpp"
 #include "util/Pch.hpp"
 #include "util/StdExt.hpp"
 
+namespace bq {
+template <typename Task, BlockType blockType>
+class TaskDispatcher;
+template <typename Task, BlockType blockType>
+using TaskDispatcherSPtr = std::shared_ptr<TaskDispatcher<Task, blockType>>;
+
+template <typename Task>
+struct AsyncTask;
+template <typename Task>
+using AsyncTaskSPtr = std::shared_ptr<AsyncTask<Task>>;
+}  // namespace bq
+
 namespace bq::md::svc {
 class MDSvc;
 }
@@ -30,8 +43,8 @@ struct BooksData;
 using BooksDataSPtr = std::shared_ptr<BooksData>;
 
 struct BooksData {
-  BooksData(const std::string symbolCode, const AsksSPtr<Decimal>& asks,
-            const BidsSPtr<Decimal>& bids, UpdateId firstUpdateId,
+  BooksData(const std::string symbolCode, const FlatAsksSPtr<Decimal>& asks,
+            const FlatBidsSPtr<Decimal>& bids, UpdateId firstUpdateId,
             UpdateId finalUpdateId)
       : symbolCode_(symbolCode),
         asks_(asks),
@@ -40,10 +53,17 @@ struct BooksData {
         finalUpdateId_(finalUpdateId) {}
 
   std::string symbolCode_;
-  AsksSPtr<Decimal> asks_{nullptr};
-  BidsSPtr<Decimal> bids_{nullptr};
+  FlatAsksSPtr<Decimal> asks_{nullptr};
+  FlatBidsSPtr<Decimal> bids_{nullptr};
+  //! 从交易所获取的全量快照中firstUpdateId_为0
   UpdateId firstUpdateId_{0};
   UpdateId finalUpdateId_{0};
+  //! 合约增量中的pu，即上一条增量的finalUpdateId，现货为0
+  UpdateId prevFinalUpdateId_{0};
+
+  //! 以下字段只在增量订单簿（BooksDelta）中使用
+  std::uint64_t seqNo_{0};
+  bool isFullRefresh_{false};
 
   std::string toShortStr() const {
     const auto ret =
@@ -57,27 +77,34 @@ struct BooksData {
 
     firstUpdateId_ = booksDataUpdate->firstUpdateId_;
     finalUpdateId_ = booksDataUpdate->finalUpdateId_;
+    prevFinalUpdateId_ = booksDataUpdate->prevFinalUpdateId_;
 
-    for (const auto& rec : *booksDataUpdate->asks_) {
-      const auto priceInUpdateData = rec.first;
-      const auto& depthDataInUpdateData = rec.second;
-      if (!DEC::ZERO(depthDataInUpdateData->size_)) {
-        (*asks_)[priceInUpdateData] = depthDataInUpdateData;
+    for (const auto& priceLevel : *booksDataUpdate->asks_) {
+      if (!DEC::ZERO(priceLevel.size_)) {
+        asks_->set(priceLevel);
       } else {
-        asks_->erase(priceInUpdateData);
+        asks_->erase(priceLevel.priceMult_);
       }
     }
 
-    for (const auto& rec : *booksDataUpdate->bids_) {
-      const auto priceInUpdateData = rec.first;
-      const auto& depthDataInUpdateData = rec.second;
-      if (!DEC::ZERO(depthDataInUpdateData->size_)) {
-        (*bids_)[priceInUpdateData] = depthDataInUpdateData;
+    for (const auto& priceLevel : *booksDataUpdate->bids_) {
+      if (!DEC::ZERO(priceLevel.size_)) {
+        bids_->set(priceLevel);
       } else {
-        bids_->erase(priceInUpdateData);
+        bids_->erase(priceLevel.priceMult_);
       }
     }
   }
+
+  //! 累积增量，和merge不同的是保留size为0的档位，接收端据此删除该价位
+  void accumulate(const BooksDataSPtr& booksDataUpdate) {
+    for (const auto& priceLevel : *booksDataUpdate->asks_) {
+      asks_->set(priceLevel);
+    }
+    for (const auto& priceLevel : *booksDataUpdate->bids_) {
+      bids_->set(priceLevel);
+    }
+  }
 };
 
 using SymbolCode2BooksData = std::map<std::string, BooksDataSPtr>;
@@ -91,6 +118,19 @@ using SymbolCode2UpdateId2BooksData =
 using SymbolCode2UpdateId2BooksDataSPtr =
     std::shared_ptr<SymbolCode2UpdateId2BooksData>;
 
+using SymbolCode2SeqNo = std::map<std::string, std::uint64_t>;
+
+struct SnapshotReq {
+  SnapshotReq(const std::string& symbolCode, const std::string& exchSymbolCode)
+      : symbolCode_(symbolCode), exchSymbolCode_(exchSymbolCode) {}
+  std::string symbolCode_;
+  std::string exchSymbolCode_;
+};
+using SnapshotReqSPtr = std::shared_ptr<SnapshotReq>;
+
+using SnapshotAsyncTask = AsyncTask<SnapshotReqSPtr>;
+using SnapshotAsyncTaskSPtr = std::shared_ptr<SnapshotAsyncTask>;
+
 class BooksCache;
 using BooksCacheSPtr = std::shared_ptr<BooksCache>;
 
@@ -101,24 +141,44 @@ class BooksCache {
   BooksCache(const BooksCache&&) = delete;
   BooksCache& operator=(const BooksCache&&) = delete;
 
-  explicit BooksCache(MDSvc* mdSvc) : mdSvc_(mdSvc) {}
+  explicit BooksCache(MDSvc* mdSvc);
+  ~BooksCache();
 
-  std::tuple<int, BooksDataSPtr> handle(const std::string& symbolCode,
-                                        const std::string& exchSymbolCode,
-                                        yyjson_val* root);
+  //! 返回合并之后的全量订单簿和本次合并的增量订单簿
+  std::tuple<int, BooksDataSPtr, BooksDataSPtr> handle(
+      const std::string& symbolCode, const std::string& exchSymbolCode,
+      yyjson_val* root);
 
  private:
   int cacheUpdateData(const std::string& symbolCode, yyjson_val* root);
 
   void removeSnapshotInOrderToRegenThem(const std::string& symbolCode);
 
-  std::tuple<int, BooksDataSPtr> mergeUpdateDataToSnapshot(
+  std::tuple<int, BooksDataSPtr, BooksDataSPtr> mergeUpdateDataToSnapshot(
       const std::string& symbolCode);
 
-  int createSnapshot(const std::string& symbolCode,
-                     const std::string& exchSymbolCode);
+  void setSeqNoOfBooksDelta(const BooksDataSPtr& booksSnapshot,
+                            BooksDataSPtr& booksDelta);
+  bool takeFullRefreshReq(const std::string& symbolCode);
+  BooksDataSPtr makeBooksDataOfFullRefresh(const BooksDataSPtr& booksSnapshot);
+
+  void initTaskDispatcherOfSnapshot();
+
+  void querySnapshotAsync(const std::string& symbolCode,
+                          const std::string& exchSymbolCode);
+  void takeSnapshotQueried(const std::string& symbolCode);
 
-  std::string getFieldNameOfFirstUpdateId() const;
+  void handleAsyncTaskOfSnapshot(SnapshotAsyncTaskSPtr& asyncTask);
+  BooksDataSPtr querySnapshot(const std::string& symbolCode,
+                              const std::string& exchSymbolCode);
+
+  bool isSpot() const;
+  bool isContinuous(const BooksDataSPtr& prevBooksData,
+                    const BooksDataSPtr& booksData) const;
+  UpdateId getUpdateIdCoveredByFirstUpdate(
+      const BooksDataSPtr& booksSnapshot) const;
+  bool isNextUpdateOfSnapshot(const BooksDataSPtr& booksSnapshot,
+                              const BooksDataSPtr& booksDataUpdate) const;
 
   BooksDataSPtr makeBooksData(const std::string& symbolCode, yyjson_val* root,
                               const char* fieldNameOfAsk,
@@ -133,6 +193,9 @@ class BooksCache {
  public:
   void reset();
 
+  //! 接收端请求全量刷新，在下一次推送该品种的时候用全量订单簿代替增量
+  void reqFullRefresh(const std::string& symbolCode);
+
  private:
   MDSvc* mdSvc_;
 
@@ -140,6 +203,32 @@ class BooksCache {
       std::make_shared<SymbolCode2UpdateId2BooksData>()};
   SymbolCode2BooksDataSPtr symbolCode2BooksDataOfSnapshot_{
       std::make_shared<SymbolCode2BooksData>()};
+
+  //! 每个品种增量订单簿的序号，以及每隔多少个增量发送一次全量刷新，以便之后
+  //! 订阅的客户端能够重建订单簿
+  SymbolCode2SeqNo symbolCode2SeqNoOfBooksDelta_;
+  std::set<std::string> symbolCodeGroupOfNewSnapshot_;
+  std::uint64_t fullRefreshIntervalOfBooksDelta_{1000};
+
+  //! 接收端请求全量刷新的品种，在SHMSrv的接收线程中写入，处理订单簿的线程取走
+  std::set<std::string> symbolCodeGroupOfFullRefreshReq_;
+  std::atomic_bool hasFullRefreshReq_{false};
+  std::ext::spin_mutex mtxFullRefreshReq_;
+
+  std::string addrOfSnapshot_;
+  std::uint32_t timeoutOfQuerySnapshot_{60000};
+
+  //! 全量快照在单独的线程中通过https请求获取，不阻塞其他品种的订单簿，
+  //! 获取期间该品种的增量继续缓存，拿到快照之后再回放
+  TaskDispatcherSPtr<SnapshotReqSPtr, BlockType::Block>
+      taskDispatcherOfSnapshot_{nullptr};
+
+  //! 正在获取全量快照的品种，只在处理订单簿的线程中访问
+  std::set<std::string> symbolCodeGroupOfSnapshotInQuery_;
+
+  //! 获取线程得到的全量快照，等待处理订单簿的线程取走，获取失败时为nullptr
+  SymbolCode2BooksData symbolCode2BooksDataOfSnapshotQueried_;
+  std::ext::spin_mutex mtxSnapshotQueried_;
 };
 
 }  // namespace bq::md::svc::binance
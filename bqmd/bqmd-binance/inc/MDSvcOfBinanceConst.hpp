@@ -33,4 +33,8 @@ const static std::string SEP_OF_TRADE_ID = "-";
 
 const static std::uint32_t MAX_BOOKS_CACHE_NUM_OF_EACH_SYM = 10000;
 
+const static std::string DEFAULT_SNAPSHOT_TASK_DISPATCHER_PARAM =
+    "moduleName=snapshotTaskDispatcherOfBinance; "
+    "taskRandAssignedThreadPoolSize=2; taskSpecificThreadPoolSize=0";
+
 }  // namespace bq::md::svc::binance
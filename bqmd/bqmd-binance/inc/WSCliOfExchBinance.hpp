@@ -12,11 +12,19 @@
 
 #include "WSCliOfExch.hpp"
 
+namespace bq {
+struct Books;
+struct InternedSymbol;
+}  // namespace bq
+
 namespace bq::md::svc::binance {
 
 class BooksCache;
 using BooksCacheSPtr = std::shared_ptr<BooksCache>;
 
+struct BooksData;
+using BooksDataSPtr = std::shared_ptr<BooksData>;
+
 class WSCliOfExchBinance;
 using WSCliOfExchBinanceSPtr = std::shared_ptr<WSCliOfExchBinance>;
 
@@ -29,6 +37,8 @@ class WSCliOfExchBinance : public WSCliOfExch {
 
   explicit WSCliOfExchBinance(MDSvc* mdSvc);
 
+  void reqFullRefreshOfBooks(const std::string& symbolCode) final;
+
  private:
   void onBeforeOpen(web::WSCli* wsCli,
                     const web::ConnMetadataSPtr& connMetadata) final;
@@ -43,8 +53,16 @@ class WSCliOfExchBinance : public WSCliOfExch {
   std::string handleMDBooks(WSCliAsyncTaskSPtr& asyncTask) final;
   bool isSubOrUnSubRet(WSCliAsyncTaskSPtr& asyncTask) final;
 
+ private:
+  const InternedSymbol* getSymbolByExchSymbolCode(
+      const std::string& exchSymbolCode) const;
+
+  void fillDepthOfBooks(Books* books, const BooksDataSPtr& snapshot);
+
  private:
   BooksCacheSPtr booksCache_{nullptr};
+  //! 为true的时候推送增量订单簿BooksDelta代替全量订单簿Books
+  bool pubBooksDelta_{false};
 };
 
 }  // namespace bq::md::svc::binance
@@ -16,15 +16,90 @@
 #include "def/BQConst.hpp"
 #include "def/BQDef.hpp"
 #include "def/StatusCode.hpp"
+#include "util/DecimalParser.hpp"
 #include "util/Json.hpp"
 #include "util/Logger.hpp"
 #include "util/StdExt.hpp"
 #include "util/String.hpp"
+#include "util/TaskDispatcher.hpp"
 #include "util/Util.hpp"
 
 namespace bq::md::svc::binance {
 
-std::tuple<int, BooksDataSPtr> BooksCache::handle(
+namespace {
+
+//! 返回前MAX_DEPTH_LEVEL档中最劣的价位，档位不足MAX_DEPTH_LEVEL的时候接收端
+//! 已经有完整的订单簿，返回false
+template <typename FlatBooksSide>
+std::tuple<bool, Price> GetBoundaryOfWindow(const FlatBooksSide& side) {
+  if (side.size() < MAX_DEPTH_LEVEL) {
+    return {false, 0};
+  }
+  return {true, side.at(MAX_DEPTH_LEVEL - 1).priceMult_};
+}
+
+//! 合并之后前MAX_DEPTH_LEVEL档中比合并之前的边界更劣的价位都是新进入的
+template <typename FlatBooksSide>
+void AddPriceLevelOfEnterWindow(const FlatBooksSide& side, Price boundary,
+                                FlatBooksSide& sideOfDelta) {
+  const auto num = std::min<std::size_t>(side.size(), MAX_DEPTH_LEVEL);
+  for (std::size_t idx = num; idx > 0; --idx) {
+    const auto& priceLevel = side.at(idx - 1);
+    if (!FlatBooksSide::IsWorse(priceLevel.priceMult_, boundary)) {
+      break;
+    }
+    sideOfDelta.set(priceLevel);
+  }
+}
+
+}  // namespace
+
+BooksCache::BooksCache(MDSvc* mdSvc) : mdSvc_(mdSvc) {
+  fullRefreshIntervalOfBooksDelta_ =
+      CONFIG["fullRefreshIntervalOfBooksDelta"].as<std::uint64_t>(
+          fullRefreshIntervalOfBooksDelta_);
+  addrOfSnapshot_ = CONFIG["addrOfSnapshot"].as<std::string>();
+  timeoutOfQuerySnapshot_ = CONFIG["timeoutOfQuerySnapshot"].as<std::uint32_t>(
+      timeoutOfQuerySnapshot_);
+  initTaskDispatcherOfSnapshot();
+}
+
+BooksCache::~BooksCache() { taskDispatcherOfSnapshot_->stop(); }
+
+void BooksCache::initTaskDispatcherOfSnapshot() {
+  //! 获取快照的线程数决定了同时有多少个品种可以并行重建订单簿
+  auto taskDispatcherParamInStrFmt =
+      SetParam(DEFAULT_TASK_DISPATCHER_PARAM,
+               CONFIG["snapshotTaskDispatcherParam"].as<std::string>(
+                   DEFAULT_SNAPSHOT_TASK_DISPATCHER_PARAM));
+  auto [ret, taskDispatcherParam] =
+      MakeTaskDispatcherParam(taskDispatcherParamInStrFmt);
+  if (ret != 0) {
+    LOG_E("Init task dispatcher of snapshot failed, use default param. {}",
+          taskDispatcherParamInStrFmt);
+    taskDispatcherParamInStrFmt = SetParam(
+        DEFAULT_TASK_DISPATCHER_PARAM, DEFAULT_SNAPSHOT_TASK_DISPATCHER_PARAM);
+    std::tie(ret, taskDispatcherParam) =
+        MakeTaskDispatcherParam(taskDispatcherParamInStrFmt);
+  }
+
+  taskDispatcherOfSnapshot_ = std::make_shared<TaskDispatcher<SnapshotReqSPtr>>(
+      taskDispatcherParam,
+      [](auto& task) {
+        const auto asyncTask =
+            std::make_shared<SnapshotAsyncTask>(task, std::any());
+        return std::make_tuple(0, asyncTask);
+      },
+      [](auto& asyncTask, auto taskSpecificThreadPoolSize) {
+        return RAND_THREAD;
+      },
+      [this](auto& asyncTask) { handleAsyncTaskOfSnapshot(asyncTask); });
+
+  taskDispatcherOfSnapshot_->init();
+  taskDispatcherOfSnapshot_->start();
+}
+
+std::tuple<int, BooksDataSPtr, BooksDataSPtr> BooksCache::handle(
     const std::string& symbolCode, const std::string& exchSymbolCode,
     yyjson_val* root) {
   //! 检查增量订单簿数据是否连续并缓存到symbolCode2UpdateId2BooksDataOfUpdateData_
@@ -32,30 +107,96 @@ std::tuple<int, BooksDataSPtr> BooksCache::handle(
   if (retOfCache == SCODE_MD_SVC_UPDATE_DATA_DISCONTINUOUS) {
     removeSnapshotInOrderToRegenThem(symbolCode);
     LOG_W("Handle {} failed.", symbolCode);
-    return {retOfCache, nullptr};
+    return {retOfCache, nullptr, nullptr};
+  }
+
+  //! 取走获取线程已经拿到的全量快照，之后和缓存的增量一起合并
+  if (!symbolCodeGroupOfSnapshotInQuery_.empty()) {
+    takeSnapshotQueried(symbolCode);
   }
 
   //! 合并增量订单簿数据到全量订单簿
-  auto [retOfMerge, booksSnapshot] = mergeUpdateDataToSnapshot(symbolCode);
+  auto [retOfMerge, booksSnapshot, booksDelta] =
+      mergeUpdateDataToSnapshot(symbolCode);
   if (retOfMerge == SCODE_MD_SVC_SNAPSHOT_NOT_EXISTS) {
-    //! 如果全量快照不存在，那么调用https请求获取
-    createSnapshot(symbolCode, exchSymbolCode);
+    //! 如果全量快照不存在，那么发起异步的https请求获取，期间增量继续缓存
+    querySnapshotAsync(symbolCode, exchSymbolCode);
     LOG_D("Handle {} failed.", symbolCode);
-    return {retOfMerge, nullptr};
+    return {retOfMerge, nullptr, nullptr};
 
   } else if (retOfMerge == SCODE_MD_SVC_FINAL_UPDATE_ID_TOO_SMALL) {
     //! 如果增量订单簿数据太旧，那么继续接收
     LOG_D("Handle {} failed, continue to recv update data.", symbolCode);
-    return {retOfMerge, nullptr};
+    return {retOfMerge, nullptr, nullptr};
 
   } else if (retOfMerge == SCODE_MD_SVC_FIRST_UPDATE_ID_TOO_LARGE) {
     //! 如果增量订单簿数据太新，那么移除以便获取更加新的全量快照
     removeSnapshotInOrderToRegenThem(symbolCode);
     LOG_D("Handle {} failed, continue to recv snapshot data.", symbolCode);
-    return {retOfMerge, nullptr};
+    return {retOfMerge, nullptr, nullptr};
+  }
+
+  setSeqNoOfBooksDelta(booksSnapshot, booksDelta);
+  return {0, booksSnapshot, booksDelta};
+}
+
+void BooksCache::setSeqNoOfBooksDelta(const BooksDataSPtr& booksSnapshot,
+                                      BooksDataSPtr& booksDelta) {
+  const auto& symbolCode = booksSnapshot->symbolCode_;
+  const auto seqNo = ++symbolCode2SeqNoOfBooksDelta_[symbolCode];
+
+  //! 重新获取了全量快照、接收端请求了全量刷新或者到了全量刷新的间隔，那么用
+  //! 全量订单簿代替增量
+  const auto isNewSnapshot = symbolCodeGroupOfNewSnapshot_.erase(symbolCode);
+  const auto isFullRefreshReq = takeFullRefreshReq(symbolCode);
+  if (isNewSnapshot != 0 || isFullRefreshReq ||
+      (fullRefreshIntervalOfBooksDelta_ != 0 &&
+       seqNo % fullRefreshIntervalOfBooksDelta_ == 0)) {
+    booksDelta = makeBooksDataOfFullRefresh(booksSnapshot);
+  }
+  booksDelta->seqNo_ = seqNo;
+}
+
+bool BooksCache::takeFullRefreshReq(const std::string& symbolCode) {
+  if (!hasFullRefreshReq_.load(std::memory_order_acquire)) {
+    return false;
+  }
+  std::lock_guard<std::ext::spin_mutex> guard(mtxFullRefreshReq_);
+  const auto ret = symbolCodeGroupOfFullRefreshReq_.erase(symbolCode) != 0;
+  if (symbolCodeGroupOfFullRefreshReq_.empty()) {
+    hasFullRefreshReq_.store(false, std::memory_order_release);
+  }
+  return ret;
+}
+
+//! 全量刷新和Books一样只带前MAX_DEPTH_LEVEL档，接收端的订单簿也只输出这么多档，
+//! 这样全量刷新的大小是固定的上限，不会随着交易所订单簿的深度变大；之后从更深
+//! 的位置进入前MAX_DEPTH_LEVEL档的价位由addPriceLevelOfEnterWindow补发
+BooksDataSPtr BooksCache::makeBooksDataOfFullRefresh(
+    const BooksDataSPtr& booksSnapshot) {
+  auto asks = std::make_shared<FlatAsks<Decimal>>();
+  asks->reserve(std::min<std::size_t>(booksSnapshot->asks_->size(),
+                                      MAX_DEPTH_LEVEL));
+  for (const auto& priceLevel : *booksSnapshot->asks_) {
+    if (asks->size() >= MAX_DEPTH_LEVEL) break;
+    asks->append(priceLevel.priceMult_, priceLevel.price_, priceLevel.size_);
+  }
+  asks->sort();
+
+  auto bids = std::make_shared<FlatBids<Decimal>>();
+  bids->reserve(std::min<std::size_t>(booksSnapshot->bids_->size(),
+                                      MAX_DEPTH_LEVEL));
+  for (const auto& priceLevel : *booksSnapshot->bids_) {
+    if (bids->size() >= MAX_DEPTH_LEVEL) break;
+    bids->append(priceLevel.priceMult_, priceLevel.price_, priceLevel.size_);
   }
+  bids->sort();
 
-  return {0, booksSnapshot};
+  const auto ret = std::make_shared<BooksData>(
+      booksSnapshot->symbolCode_, asks, bids, booksSnapshot->firstUpdateId_,
+      booksSnapshot->finalUpdateId_);
+  ret->isFullRefresh_ = true;
+  return ret;
 }
 
 /*
@@ -82,11 +223,14 @@ int BooksCache::cacheUpdateData(const std::string& symbolCode,
   UpdateId2BooksDataSPtr updateId2BooksData;
 
   //! 生成包含代码、买卖订单簿、first和finalUpdateId的booksData
-  const auto fieldNameOfFirstUpdateId = getFieldNameOfFirstUpdateId();
+  const auto fieldNameOfFirstUpdateId = "U";
   const auto fieldNameOfFinalUpdateId = "u";
   const auto booksData =
-      makeBooksData(symbolCode, root, "a", "b",
-                    fieldNameOfFirstUpdateId.c_str(), fieldNameOfFinalUpdateId);
+      makeBooksData(symbolCode, root, "a", "b", fieldNameOfFirstUpdateId,
+                    fieldNameOfFinalUpdateId);
+  if (!isSpot()) {
+    booksData->prevFinalUpdateId_ = yyjson_get_uint(yyjson_obj_get(root, "pu"));
+  }
 
   //! 通过symbolCode2UpdateId2BooksDataOfUpdateData_获取增量订单簿数据updateId2BooksData
   const auto iter =
@@ -99,15 +243,17 @@ int BooksCache::cacheUpdateData(const std::string& symbolCode,
         updateId2BooksData;
   }
 
-  //! 如果updateId2BooksData不为空，检查updateId2BooksData最后一条记录的finalUpdateId_和
-  //! 当前booksData的firstUpdateId_是否连续
+  //! 如果updateId2BooksData不为空，检查updateId2BooksData最后一条记录和当前
+  //! booksData是否连续
   if (!updateId2BooksData->empty()) {
     const auto& prevBooksData = std::rbegin(*updateId2BooksData)->second;
-    if (prevBooksData->finalUpdateId_ + 1 != booksData->firstUpdateId_) {
+    if (!isContinuous(prevBooksData, booksData)) {
       const auto statusMsg = fmt::format(
           "The updateId of {} is found to be discontinuous, resub required. "
-          "[finalUpdateIdOfPrevBook = {}; firstUpdateIdOfCurBook = {}]",
-          symbolCode, prevBooksData->finalUpdateId_, booksData->firstUpdateId_);
+          "[finalUpdateIdOfPrevBook = {}; firstUpdateIdOfCurBook = {}; "
+          "prevFinalUpdateIdOfCurBook = {}]",
+          symbolCode, prevBooksData->finalUpdateId_, booksData->firstUpdateId_,
+          booksData->prevFinalUpdateId_);
       LOG_W(statusMsg);
       //! 如果不连续清空原有增量订单簿数据
       updateId2BooksData->clear();
@@ -139,8 +285,8 @@ void BooksCache::removeSnapshotInOrderToRegenThem(
   symbolCode2BooksDataOfSnapshot_->erase(symbolCode);
 }
 
-std::tuple<int, BooksDataSPtr> BooksCache::mergeUpdateDataToSnapshot(
-    const std::string& symbolCode) {
+std::tuple<int, BooksDataSPtr, BooksDataSPtr>
+BooksCache::mergeUpdateDataToSnapshot(const std::string& symbolCode) {
   auto printDebugInfo = [](const auto& symbolCode, auto finalUpdateIdInSnapshot,
                            const auto& updateId2BooksData) {
     const auto firstRec = *updateId2BooksData->begin();
@@ -157,9 +303,10 @@ std::tuple<int, BooksDataSPtr> BooksCache::mergeUpdateDataToSnapshot(
   auto [retOfGetSnapshot, booksSnapshot] = getSnapshot(symbolCode);
   if (retOfGetSnapshot != 0) {
     LOG_D("Merge update data of {} to snapshot failed.", symbolCode);
-    return {retOfGetSnapshot, nullptr};
+    return {retOfGetSnapshot, nullptr, nullptr};
   }
-  const auto finalUpdateIdInSnapshot = booksSnapshot->finalUpdateId_ + 1;
+  const auto finalUpdateIdInSnapshot =
+      getUpdateIdCoveredByFirstUpdate(booksSnapshot);
 
   //! 获取增量订单簿数据
   auto iterUpdateId2BooksData =
@@ -182,7 +329,7 @@ std::tuple<int, BooksDataSPtr> BooksCache::mergeUpdateDataToSnapshot(
         "is too small. [{}]",
         maxFinalUpdateId, finalUpdateIdInSnapshot, symbolCode);
     updateId2BooksData->clear();
-    return {SCODE_MD_SVC_FINAL_UPDATE_ID_TOO_SMALL, nullptr};
+    return {SCODE_MD_SVC_FINAL_UPDATE_ID_TOO_SMALL, nullptr, nullptr};
   }
 
   const auto minFirstUpdateId =
@@ -194,21 +341,42 @@ std::tuple<int, BooksDataSPtr> BooksCache::mergeUpdateDataToSnapshot(
         "Min first update id of update data in cache {} > {} "
         "is too large. [{}]",
         minFirstUpdateId, finalUpdateIdInSnapshot, symbolCode);
-    return {SCODE_MD_SVC_FIRST_UPDATE_ID_TOO_LARGE, nullptr};
+    return {SCODE_MD_SVC_FIRST_UPDATE_ID_TOO_LARGE, nullptr, nullptr};
   }
 
-  //! 合并符合条件的增量订单簿数据到全量订单簿
+  //! 合并符合条件的增量订单簿数据到全量订单簿，同时累积本次合并的增量，
+  //! 获取快照期间缓存了多条增量的时候，每合并一条全量订单簿的finalUpdateId_
+  //! 随之前进，这样缓存的增量会依次回放
+  const auto booksDelta = std::make_shared<BooksData>(
+      symbolCode, std::make_shared<FlatAsks<Decimal>>(),
+      std::make_shared<FlatBids<Decimal>>(), booksSnapshot->firstUpdateId_,
+      booksSnapshot->finalUpdateId_);
+  const auto [hasBoundaryOfAsks, boundaryOfAsks] =
+      GetBoundaryOfWindow(*booksSnapshot->asks_);
+  const auto [hasBoundaryOfBids, boundaryOfBids] =
+      GetBoundaryOfWindow(*booksSnapshot->bids_);
   for (auto iter = std::begin(*updateId2BooksData);
        iter != std::end(*updateId2BooksData); ++iter) {
     const auto& booksDataUpdate = iter->second;
-    if (finalUpdateIdInSnapshot >= booksDataUpdate->firstUpdateId_ &&
-        finalUpdateIdInSnapshot <= booksDataUpdate->finalUpdateId_) {
-      booksSnapshot->merge(booksDataUpdate);
+    if (isNextUpdateOfSnapshot(booksSnapshot, booksDataUpdate)) {
       LOG_T("===== {}: Merge {} to {}. ", symbolCode,
-            booksDataUpdate->toShortStr(), finalUpdateIdInSnapshot);
+            booksDataUpdate->toShortStr(), booksSnapshot->finalUpdateId_);
+      booksSnapshot->merge(booksDataUpdate);
+      booksDelta->accumulate(booksDataUpdate);
     }
   }
 
+  //! 前MAX_DEPTH_LEVEL档中有价位被删除的时候，更深的价位会移进来，这些价位
+  //! 可能从来没有发给过接收端，需要随增量一起发出
+  if (hasBoundaryOfAsks) {
+    AddPriceLevelOfEnterWindow(*booksSnapshot->asks_, boundaryOfAsks,
+                               *booksDelta->asks_);
+  }
+  if (hasBoundaryOfBids) {
+    AddPriceLevelOfEnterWindow(*booksSnapshot->bids_, boundaryOfBids,
+                               *booksDelta->bids_);
+  }
+
   // Keep the last record for judging whether the update data is continuous
   updateId2BooksData->erase(std::begin(*updateId2BooksData),
                             std::prev(std::end(*updateId2BooksData), 1));
@@ -221,7 +389,56 @@ std::tuple<int, BooksDataSPtr> BooksCache::mergeUpdateDataToSnapshot(
   }
 #endif
 
-  return {0, booksSnapshot};
+  booksDelta->firstUpdateId_ = booksSnapshot->firstUpdateId_;
+  booksDelta->finalUpdateId_ = booksSnapshot->finalUpdateId_;
+  return {0, booksSnapshot, booksDelta};
+}
+
+void BooksCache::querySnapshotAsync(const std::string& symbolCode,
+                                    const std::string& exchSymbolCode) {
+  //! 同一个品种同时只发起一个请求
+  if (!symbolCodeGroupOfSnapshotInQuery_.emplace(symbolCode).second) {
+    return;
+  }
+  auto snapshotReq = std::make_shared<SnapshotReq>(symbolCode, exchSymbolCode);
+  if (taskDispatcherOfSnapshot_->dispatch(snapshotReq) != 0) {
+    LOG_W("Dispatch query of snapshot of {} failed.", symbolCode);
+    symbolCodeGroupOfSnapshotInQuery_.erase(symbolCode);
+  }
+}
+
+void BooksCache::takeSnapshotQueried(const std::string& symbolCode) {
+  if (symbolCodeGroupOfSnapshotInQuery_.count(symbolCode) == 0) {
+    return;
+  }
+
+  BooksDataSPtr booksSnapshot;
+  {
+    std::lock_guard<std::ext::spin_mutex> guard(mtxSnapshotQueried_);
+    const auto iter = symbolCode2BooksDataOfSnapshotQueried_.find(symbolCode);
+    if (iter == std::end(symbolCode2BooksDataOfSnapshotQueried_)) {
+      return;
+    }
+    booksSnapshot = iter->second;
+    symbolCode2BooksDataOfSnapshotQueried_.erase(iter);
+  }
+
+  //! 获取失败的时候不设置快照，之后会重新发起请求
+  symbolCodeGroupOfSnapshotInQuery_.erase(symbolCode);
+  if (booksSnapshot != nullptr) {
+    setSnapshot(symbolCode, booksSnapshot);
+  }
+}
+
+void BooksCache::handleAsyncTaskOfSnapshot(SnapshotAsyncTaskSPtr& asyncTask) {
+  const auto& snapshotReq = asyncTask->task_;
+  const auto booksSnapshot =
+      querySnapshot(snapshotReq->symbolCode_, snapshotReq->exchSymbolCode_);
+  {
+    std::lock_guard<std::ext::spin_mutex> guard(mtxSnapshotQueried_);
+    symbolCode2BooksDataOfSnapshotQueried_[snapshotReq->symbolCode_] =
+        booksSnapshot;
+  }
 }
 
 /*
@@ -253,36 +470,35 @@ std::tuple<int, BooksDataSPtr> BooksCache::mergeUpdateDataToSnapshot(
  *  ]
  * }
  */
-int BooksCache::createSnapshot(const std::string& symbolCode,
-                               const std::string& exchSymbolCode) {
-  auto addrOfSnapshot = CONFIG["addrOfSnapshot"].as<std::string>();
+//! 在获取快照的线程中执行，失败的时候返回nullptr
+BooksDataSPtr BooksCache::querySnapshot(const std::string& symbolCode,
+                                        const std::string& exchSymbolCode) {
+  auto addrOfSnapshot = addrOfSnapshot_;
   boost::replace_first(addrOfSnapshot, "symbolCode",
                        boost::to_upper_copy(exchSymbolCode));
-  const auto timeoutOfQuerySnapshot =
-      CONFIG["timeoutOfQuerySnapshot"].as<std::uint32_t>();
 
   LOG_D("Begin to query snapshot of {} from exch. ", symbolCode);
   cpr::Response rsp =
-      cpr::Get(cpr::Url{addrOfSnapshot}, cpr::Timeout(timeoutOfQuerySnapshot));
+      cpr::Get(cpr::Url{addrOfSnapshot}, cpr::Timeout(timeoutOfQuerySnapshot_));
   if (rsp.status_code != cpr::status::HTTP_OK) {
     const auto statusMsg =
         fmt::format("Query snapshot of {} from exch failed. [{}:{}] [{}]",
                     symbolCode, rsp.status_code, rsp.reason, rsp.url.str());
     LOG_W(statusMsg);
-    return -1;
+    return nullptr;
   }
 
   std::unique_ptr<yyjson_doc, AutoFreeYYDoc> doc(
       yyjson_read(rsp.text.data(), rsp.text.size(), 0));
   if (doc.get() == nullptr) {
     LOG_W("Create snapshot of {} failed. ", symbolCode);
-    return -1;
+    return nullptr;
   }
 
   yyjson_val* root = yyjson_doc_get_root(doc.get());
   if (root == nullptr) {
     LOG_W("Create snapshot of {} failed. ", symbolCode);
-    return -1;
+    return nullptr;
   }
 
   const auto fieldNameOfFirstUpdateId = "";
@@ -290,21 +506,47 @@ int BooksCache::createSnapshot(const std::string& symbolCode,
   const auto booksSnapshot =
       makeBooksData(symbolCode, root, "asks", "bids", fieldNameOfFirstUpdateId,
                     fieldNameOfFinalUpdateId);
-  setSnapshot(symbolCode, booksSnapshot);
 
   LOG_D("Query snapshot of {} from exch success. [update id = {}]", symbolCode,
         booksSnapshot->finalUpdateId_);
 
-  return 0;
+  return booksSnapshot;
 }
 
-std::string BooksCache::getFieldNameOfFirstUpdateId() const {
-  if (mdSvc_->getSymbolType() == magic_enum::enum_name(SymbolType::Spot)) {
-    return "U";
-  } else {
-    return "pu";
+bool BooksCache::isSpot() const {
+  return mdSvc_->getSymbolType() == magic_enum::enum_name(SymbolType::Spot);
+}
+
+//! 现货的增量中updateId是连续的，U等于上一条的u+1；合约的增量中updateId不
+//! 连续，pu等于上一条的u
+bool BooksCache::isContinuous(const BooksDataSPtr& prevBooksData,
+                              const BooksDataSPtr& booksData) const {
+  if (isSpot()) {
+    return prevBooksData->finalUpdateId_ + 1 == booksData->firstUpdateId_;
+  }
+  return prevBooksData->finalUpdateId_ == booksData->prevFinalUpdateId_;
+}
+
+//! 第一条合并到快照的增量需要满足 U <= 返回值 <= u，现货为lastUpdateId+1，
+//! 合约为lastUpdateId
+UpdateId BooksCache::getUpdateIdCoveredByFirstUpdate(
+    const BooksDataSPtr& booksSnapshot) const {
+  return isSpot() ? booksSnapshot->finalUpdateId_ + 1
+                  : booksSnapshot->finalUpdateId_;
+}
+
+bool BooksCache::isNextUpdateOfSnapshot(
+    const BooksDataSPtr& booksSnapshot,
+    const BooksDataSPtr& booksDataUpdate) const {
+  //! 合约的快照已经合并过增量之后，按pu和上一条合并的增量衔接
+  if (!isSpot() && booksSnapshot->firstUpdateId_ != 0) {
+    return booksDataUpdate->prevFinalUpdateId_ ==
+           booksSnapshot->finalUpdateId_;
   }
-};
+  const auto updateId = getUpdateIdCoveredByFirstUpdate(booksSnapshot);
+  return booksDataUpdate->firstUpdateId_ <= updateId &&
+         updateId <= booksDataUpdate->finalUpdateId_;
+}
 
 BooksDataSPtr BooksCache::makeBooksData(const std::string& symbolCode,
                                         yyjson_val* root,
@@ -312,58 +554,71 @@ BooksDataSPtr BooksCache::makeBooksData(const std::string& symbolCode,
                                         const char* fieldNameOfBid,
                                         const char* fieldNameOfFirstUpdateId,
                                         const char* fieldNameOfFinalUpdateId) {
-  auto asks = std::make_shared<Asks<Decimal>>();
+  //! 价格字符串直接按DBL_TO_INT_MULTI的精度转换为整数，避免浮点乘法的误差
+  //! 比如 0.29 * 1e12 截断之后得到 289999999999
+  const auto makePriceMult = [](const char* priceInStrFmt, Decimal price) {
+    std::int64_t priceMult = 0;
+    if (Str2ScaledInt(priceInStrFmt, PRECISION_OF_DBL_TO_INT_MULTI,
+                      priceMult)) {
+      return static_cast<std::uint64_t>(priceMult);
+    }
+    return static_cast<std::uint64_t>(price * DBL_TO_INT_MULTI);
+  };
+
+  //! 先不排序地追加档位，全部追加之后一次排序，避免逐个插入时移动数组
+  auto asks = std::make_shared<FlatAsks<Decimal>>();
   const auto arrayAsk = yyjson_obj_get(root, fieldNameOfAsk);
+  asks->reserve(yyjson_arr_size(arrayAsk));
   yyjson_val* valAsk;
   yyjson_arr_iter iterAsk;
   yyjson_arr_iter_init(arrayAsk, &iterAsk);
   while ((valAsk = yyjson_arr_iter_next(&iterAsk))) {
     size_t idxAskField, maxAskField;
     yyjson_val* valAskField;
+    const char* priceInStrFmt = nullptr;
     Decimal price = 0;
     Decimal size = 0;
     yyjson_arr_foreach(valAsk, idxAskField, maxAskField, valAskField) {
       if (idxAskField == 0) {
-        price = CONV(Decimal, yyjson_get_str(valAskField));
+        priceInStrFmt = yyjson_get_str(valAskField);
+        price = Str2Dbl(priceInStrFmt);
       } else if (idxAskField == 1) {
-        size = CONV(Decimal, yyjson_get_str(valAskField));
+        size = Str2Dbl(yyjson_get_str(valAskField));
       }
     }
-    const auto depthData = std::make_shared<DepthData<Decimal>>(price, size);
-    const std::uint64_t priceMult = price * DBL_TO_INT_MULTI;
-    asks->emplace(priceMult, depthData);
+    asks->append(makePriceMult(priceInStrFmt, price), price, size);
   }
+  asks->sort();
 
-  auto bids = std::make_shared<Bids<Decimal>>();
+  auto bids = std::make_shared<FlatBids<Decimal>>();
   const auto arrayBid = yyjson_obj_get(root, fieldNameOfBid);
+  bids->reserve(yyjson_arr_size(arrayBid));
   yyjson_val* valBid;
   yyjson_arr_iter iterBid;
   yyjson_arr_iter_init(arrayBid, &iterBid);
   while ((valBid = yyjson_arr_iter_next(&iterBid))) {
     size_t idxBidField, maxBidField;
     yyjson_val* valBidField;
+    const char* priceInStrFmt = nullptr;
     Decimal price = 0;
     Decimal size = 0;
     yyjson_arr_foreach(valBid, idxBidField, maxBidField, valBidField) {
       if (idxBidField == 0) {
-        price = CONV(Decimal, yyjson_get_str(valBidField));
+        priceInStrFmt = yyjson_get_str(valBidField);
+        price = Str2Dbl(priceInStrFmt);
       } else if (idxBidField == 1) {
-        size = CONV(Decimal, yyjson_get_str(valBidField));
+        size = Str2Dbl(yyjson_get_str(valBidField));
       }
     }
-    const auto depthData = std::make_shared<DepthData<Decimal>>(price, size);
-    const std::uint64_t priceMult = price * DBL_TO_INT_MULTI;
-    bids->emplace(priceMult, depthData);
+    bids->append(makePriceMult(priceInStrFmt, price), price, size);
   }
+  bids->sort();
 
   std::uint64_t firstUpdateId = 0;
   if (std::strcmp(fieldNameOfFirstUpdateId, "") != 0) {
     const auto valFirstUpdateId =
         yyjson_obj_get(root, fieldNameOfFirstUpdateId);
     firstUpdateId = yyjson_get_uint(valFirstUpdateId);
-    if (mdSvc_->getSymbolType() != magic_enum::enum_name(SymbolType::Spot)) {
-      firstUpdateId += 1;
-    }
   }
   const auto valFinalUpdateId = yyjson_obj_get(root, fieldNameOfFinalUpdateId);
   const auto finalUpdateId = yyjson_get_uint(valFinalUpdateId);
@@ -375,6 +630,14 @@ BooksDataSPtr BooksCache::makeBooksData(const std::string& symbolCode,
 void BooksCache::setSnapshot(const std::string& symbolCode,
                              const BooksDataSPtr& booksData) {
   (*symbolCode2BooksDataOfSnapshot_)[symbolCode] = booksData;
+  //! 新的快照合并之后需要全量刷新接收端的订单簿
+  symbolCodeGroupOfNewSnapshot_.emplace(symbolCode);
+}
+
+void BooksCache::reqFullRefresh(const std::string& symbolCode) {
+  std::lock_guard<std::ext::spin_mutex> guard(mtxFullRefreshReq_);
+  symbolCodeGroupOfFullRefreshReq_.emplace(symbolCode);
+  hasFullRefreshReq_.store(true, std::memory_order_release);
 }
 
 std::tuple<int, BooksDataSPtr> BooksCache::getSnapshot(
@@ -392,6 +655,13 @@ void BooksCache::reset() {
   symbolCode2UpdateId2BooksDataOfUpdateData_->clear();
   //! 清空全量订单簿数据
   symbolCode2BooksDataOfSnapshot_->clear();
+  symbolCodeGroupOfNewSnapshot_.clear();
+  //! 已经发出的请求返回的快照如果太旧，合并的时候会被丢弃并重新获取
+  symbolCodeGroupOfSnapshotInQuery_.clear();
+  {
+    std::lock_guard<std::ext::spin_mutex> guard(mtxSnapshotQueried_);
+    symbolCode2BooksDataOfSnapshotQueried_.clear();
+  }
 }
 
 }  // namespace bq::md::svc::binance
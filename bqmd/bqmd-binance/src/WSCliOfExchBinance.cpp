@@ -26,15 +26,26 @@
 #include "db/TBLMonitorOfSymbolInfo.hpp"
 #include "def/DataStruOfMD.hpp"
 #include "def/MDWSCliAsyncTaskArg.hpp"
+#include "util/BQMDUtil.hpp"
 #include "util/BQUtil.hpp"
+#include "util/DecimalParser.hpp"
 #include "util/Json.hpp"
 #include "util/String.hpp"
+#include "util/SymbolRegistry.hpp"
 #include "util/Util.hpp"
 
 namespace bq::md::svc::binance {
 
 WSCliOfExchBinance::WSCliOfExchBinance(MDSvc* mdSvc)
-    : WSCliOfExch(mdSvc), booksCache_(std::make_shared<BooksCache>(mdSvc)) {}
+    : WSCliOfExch(mdSvc), booksCache_(std::make_shared<BooksCache>(mdSvc)) {
+  pubBooksDelta_ = CONFIG["pubBooksDelta"].as<bool>(false);
+}
+
+void WSCliOfExchBinance::reqFullRefreshOfBooks(const std::string& symbolCode) {
+  if (pubBooksDelta_) {
+    booksCache_->reqFullRefresh(symbolCode);
+  }
+}
 
 void WSCliOfExchBinance::onBeforeOpen(
     web::WSCli* wsCli, const web::ConnMetadataSPtr& connMetadata) {
@@ -124,10 +135,8 @@ std::string WSCliOfExchBinance::handleMDTrades(WSCliAsyncTaskSPtr& asyncTask) {
 
   std::string exchSymbolCode = yyjson_get_str(vals);
   boost::to_lower(exchSymbolCode);
-  const auto [ret, symbolCode] =
-      mdSvc_->getTBLMonitorOfSymbolInfo()->getSymbolCode(marketCode, symbolType,
-                                                         exchSymbolCode);
-  if (ret != 0) {
+  const auto symbol = getSymbolByExchSymbolCode(exchSymbolCode);
+  if (symbol == nullptr) {
     const auto statusMsg = fmt::format(
         "Handle market data of trades failed because of "
         "get symbol code failed. [marketCode = {}, exchSymbolCode = {}]",
@@ -135,6 +144,7 @@ std::string WSCliOfExchBinance::handleMDTrades(WSCliAsyncTaskSPtr& asyncTask) {
     LOG_W(statusMsg);
     return "";
   }
+  const auto& symbolCode = symbol->symbolCode_;
 
   const auto exchSide = yyjson_get_bool(valExchSide);
   const auto a = yyjson_get_uint(vala);
@@ -146,25 +156,29 @@ std::string WSCliOfExchBinance::handleMDTrades(WSCliAsyncTaskSPtr& asyncTask) {
   const auto price = yyjson_get_str(valPrice);
   const auto size = yyjson_get_str(valSize);
 
-  const auto [topic, topicHash] =
-      MakeTopicInfo(marketCode, symbolType, symbolCode, MDType::Trades);
+  const auto topicInfo = symbol->getTopicInfo(MDType::Trades);
+  const auto& topic = topicInfo->topic_;
+  const auto topicHash = topicInfo->topicHash_;
+  const auto topicId = topicInfo->getTopicId();
 
   mdSvc_->getSHMSrv()->pushMsgWithZeroCopy(
       [&](void* shmBuf) {
         auto trades = static_cast<Trades*>(shmBuf);
         trades->shmHeader_.topicHash_ = topicHash;
+        trades->shmHeader_.topicId_ = topicId;
+        TraceMDPub(trades->mdHeader_, asyncTask->task_->tscOfRecv_);
         trades->mdHeader_.exchTs_ = exchTs;
         trades->mdHeader_.localTs_ = asyncTask->task_->localTs_;
         trades->mdHeader_.marketCode_ = mdSvc_->getMarketCodeEnum();
         trades->mdHeader_.symbolType_ = mdSvc_->getSymbolTypeEnum();
-        strncpy(trades->mdHeader_.symbolCode_, symbolCode,
+        strncpy(trades->mdHeader_.symbolCode_, symbolCode.c_str(),
                 sizeof(trades->mdHeader_.symbolCode_) - 1);
         trades->mdHeader_.mdType_ = MDType::Trades;
         trades->tradeTime_ = tradeTime * 1000;
         snprintf(trades->tradeNo_, sizeof(trades->tradeNo_) - 1,
                  "%" PRIu64 "-%" PRIu64 "-%" PRIu64 "", a, f, l);
-        trades->price_ = CONV(Decimal, price);
-        trades->size_ = CONV(Decimal, size);
+        trades->price_ = Str2Dbl(price);
+        trades->size_ = Str2Dbl(size);
         trades->side_ = GetSide(exchSide);
         if (mdSvc_->saveMarketData()) {
           arg->marketDataOfUnifiedFmt_ = trades->dataOfUnifiedFmt();
@@ -233,10 +247,8 @@ std::string WSCliOfExchBinance::handleMDTickers(WSCliAsyncTaskSPtr& asyncTask) {
 
   std::string exchSymbolCode = yyjson_get_str(vals);
   boost::to_lower(exchSymbolCode);
-  const auto [ret, symbolCode] =
-      mdSvc_->getTBLMonitorOfSymbolInfo()->getSymbolCode(marketCode, symbolType,
-                                                         exchSymbolCode);
-  if (ret != 0) {
+  const auto symbol = getSymbolByExchSymbolCode(exchSymbolCode);
+  if (symbol == nullptr) {
     const auto statusMsg = fmt::format(
         "Handle market data of tickers failed because of "
         "get symbol code failed. [marketCode = {}, exchSymbolCode = {}]",
@@ -244,6 +256,7 @@ std::string WSCliOfExchBinance::handleMDTickers(WSCliAsyncTaskSPtr& asyncTask) {
     LOG_W(statusMsg);
     return "";
   }
+  const auto& symbolCode = symbol->symbolCode_;
 
   const auto exchTs = yyjson_get_uint(valExchTs) * 1000;
   const auto lastPrice = yyjson_get_str(valLastPrice);
@@ -253,26 +266,30 @@ std::string WSCliOfExchBinance::handleMDTickers(WSCliAsyncTaskSPtr& asyncTask) {
   const auto vol = yyjson_get_str(valVol);
   const auto amt = yyjson_get_str(valAmt);
 
-  const auto [topic, topicHash] =
-      MakeTopicInfo(marketCode, symbolType, symbolCode, MDType::Tickers);
+  const auto topicInfo = symbol->getTopicInfo(MDType::Tickers);
+  const auto& topic = topicInfo->topic_;
+  const auto topicHash = topicInfo->topicHash_;
+  const auto topicId = topicInfo->getTopicId();
 
   mdSvc_->getSHMSrv()->pushMsgWithZeroCopy(
       [&](void* shmBuf) {
         auto tickers = static_cast<Tickers*>(shmBuf);
         tickers->shmHeader_.topicHash_ = topicHash;
+        tickers->shmHeader_.topicId_ = topicId;
+        TraceMDPub(tickers->mdHeader_, asyncTask->task_->tscOfRecv_);
         tickers->mdHeader_.exchTs_ = exchTs;
         tickers->mdHeader_.localTs_ = asyncTask->task_->localTs_;
         tickers->mdHeader_.marketCode_ = mdSvc_->getMarketCodeEnum();
         tickers->mdHeader_.symbolType_ = mdSvc_->getSymbolTypeEnum();
-        strncpy(tickers->mdHeader_.symbolCode_, symbolCode,
+        strncpy(tickers->mdHeader_.symbolCode_, symbolCode.c_str(),
                 sizeof(tickers->mdHeader_.symbolCode_) - 1);
         tickers->mdHeader_.mdType_ = MDType::Tickers;
-        tickers->lastPrice_ = CONV(Decimal, lastPrice);
-        tickers->open_ = CONV(Decimal, open);
-        tickers->high_ = CONV(Decimal, high);
-        tickers->low_ = CONV(Decimal, low);
-        tickers->vol_ = CONV(Decimal, vol);
-        tickers->amt_ = CONV(Decimal, amt);
+        tickers->lastPrice_ = Str2Dbl(lastPrice);
+        tickers->open_ = Str2Dbl(open);
+        tickers->high_ = Str2Dbl(high);
+        tickers->low_ = Str2Dbl(low);
+        tickers->vol_ = Str2Dbl(vol);
+        tickers->amt_ = Str2Dbl(amt);
         if (mdSvc_->saveMarketData()) {
           arg->marketDataOfUnifiedFmt_ = tickers->dataOfUnifiedFmt();
           arg->exchTs_ = exchTs;
@@ -359,10 +376,8 @@ std::string WSCliOfExchBinance::handleMDCandle(WSCliAsyncTaskSPtr& asyncTask) {
 
   std::string exchSymbolCode = yyjson_get_str(vals);
   boost::to_lower(exchSymbolCode);
-  const auto [ret, symbolCode] =
-      mdSvc_->getTBLMonitorOfSymbolInfo()->getSymbolCode(marketCode, symbolType,
-                                                         exchSymbolCode);
-  if (ret) {
+  const auto symbol = getSymbolByExchSymbolCode(exchSymbolCode);
+  if (symbol == nullptr) {
     const auto statusMsg = fmt::format(
         "Handle market data of candle failed because of "
         "get symbol code failed. [marketCode = {}, exchSymbolCode = {}]",
@@ -370,28 +385,32 @@ std::string WSCliOfExchBinance::handleMDCandle(WSCliAsyncTaskSPtr& asyncTask) {
     LOG_W(statusMsg);
     return "";
   }
+  const auto& symbolCode = symbol->symbolCode_;
 
-  const auto [topic, topicHash] =
-      MakeTopicInfo(marketCode, symbolType, symbolCode, MDType::Candle,
-                    SUFFIX_OF_CANDLE_DETAIL);
+  const auto topicInfo = symbol->getTopicInfo(MDType::Candle, true);
+  const auto& topic = topicInfo->topic_;
+  const auto topicHash = topicInfo->topicHash_;
+  const auto topicId = topicInfo->getTopicId();
 
   mdSvc_->getSHMSrv()->pushMsgWithZeroCopy(
       [&](void* shmBuf) {
         auto candle = static_cast<Candle*>(shmBuf);
         candle->shmHeader_.topicHash_ = topicHash;
+        candle->shmHeader_.topicId_ = topicId;
+        TraceMDPub(candle->mdHeader_, asyncTask->task_->tscOfRecv_);
         candle->mdHeader_.exchTs_ = exchTs;
         candle->mdHeader_.localTs_ = asyncTask->task_->localTs_;
         candle->mdHeader_.marketCode_ = mdSvc_->getMarketCodeEnum();
         candle->mdHeader_.symbolType_ = mdSvc_->getSymbolTypeEnum();
-        strncpy(candle->mdHeader_.symbolCode_, symbolCode,
+        strncpy(candle->mdHeader_.symbolCode_, symbolCode.c_str(),
                 sizeof(candle->mdHeader_.symbolCode_) - 1);
         candle->mdHeader_.mdType_ = MDType::Candle;
-        candle->open_ = CONV(Decimal, yyjson_get_str(valOpen));
-        candle->high_ = CONV(Decimal, yyjson_get_str(valHigh));
-        candle->low_ = CONV(Decimal, yyjson_get_str(valLow));
-        candle->close_ = CONV(Decimal, yyjson_get_str(valClose));
-        candle->vol_ = CONV(Decimal, yyjson_get_str(valVol));
-        candle->amt_ = CONV(Decimal, yyjson_get_str(valAmt));
+        candle->open_ = Str2Dbl(yyjson_get_str(valOpen));
+        candle->high_ = Str2Dbl(yyjson_get_str(valHigh));
+        candle->low_ = Str2Dbl(yyjson_get_str(valLow));
+        candle->close_ = Str2Dbl(yyjson_get_str(valClose));
+        candle->vol_ = Str2Dbl(yyjson_get_str(valVol));
+        candle->amt_ = Str2Dbl(yyjson_get_str(valAmt));
         if (mdSvc_->saveMarketData()) {
           arg->marketDataOfUnifiedFmt_ = candle->dataOfUnifiedFmt();
           arg->exchTs_ = exchTs;
@@ -436,10 +455,8 @@ std::string WSCliOfExchBinance::handleMDBooks(WSCliAsyncTaskSPtr& asyncTask) {
   const auto s = yyjson_obj_get(arg->root_, "s");
   std::string exchSymbolCode = yyjson_get_str(s);
   boost::to_lower(exchSymbolCode);
-  const auto [ret, symbolCode] =
-      mdSvc_->getTBLMonitorOfSymbolInfo()->getSymbolCode(marketCode, symbolType,
-                                                         exchSymbolCode);
-  if (ret != 0) {
+  const auto symbol = getSymbolByExchSymbolCode(exchSymbolCode);
+  if (symbol == nullptr) {
     const auto statusMsg = fmt::format(
         "Handle market data of books failed because of "
         "get symbol code failed. [marketCode = {}, exchSymbolCode = {}]",
@@ -447,8 +464,9 @@ std::string WSCliOfExchBinance::handleMDBooks(WSCliAsyncTaskSPtr& asyncTask) {
     LOG_W(statusMsg);
     return "";
   }
+  const auto& symbolCode = symbol->symbolCode_;
 
-  auto [retOfHandle, snapshot] =
+  auto [retOfHandle, snapshot, booksDelta] =
       booksCache_->handle(symbolCode, exchSymbolCode, arg->root_);
   if (retOfHandle != 0) {
     LOG_D("Handle market data of books snapshot for {} failed.", symbolCode);
@@ -457,47 +475,82 @@ std::string WSCliOfExchBinance::handleMDBooks(WSCliAsyncTaskSPtr& asyncTask) {
   const auto valExchTs = yyjson_obj_get(arg->root_, "E");
   const auto exchTs = yyjson_get_uint(valExchTs) * 1000;
 
-  const auto [topic, topicHash] =
-      MakeTopicInfo(marketCode, symbolType, symbolCode, MDType::Books,
-                    Int2StrInCompileTime<MAX_DEPTH_LEVEL>::type::value);
-
-  mdSvc_->getSHMSrv()->pushMsgWithZeroCopy(
-      [&](void* shmBuf) {
-        auto books = static_cast<Books*>(shmBuf);
-        books->shmHeader_.topicHash_ = topicHash;
-        books->mdHeader_.exchTs_ = exchTs;
-        books->mdHeader_.localTs_ = asyncTask->task_->localTs_;
-        books->mdHeader_.marketCode_ = mdSvc_->getMarketCodeEnum();
-        books->mdHeader_.symbolType_ = mdSvc_->getSymbolTypeEnum();
-        strncpy(books->mdHeader_.symbolCode_, symbolCode,
-                sizeof(books->mdHeader_.symbolCode_) - 1);
-        books->mdHeader_.mdType_ = MDType::Books;
-
-        std::uint32_t asksLvl = 0;
-        for (auto iter = std::begin(*snapshot->asks_);
-             iter != std::end(*snapshot->asks_); ++iter, ++asksLvl) {
-          if (asksLvl >= MAX_DEPTH_LEVEL) break;
-          const auto& depthData = iter->second;
-          books->asks_[asksLvl].price_ = depthData->price_;
-          books->asks_[asksLvl].size_ = depthData->size_;
-        }
+  const auto topicInfo = symbol->getTopicInfo(MDType::Books, true);
+  const auto& topic = topicInfo->topic_;
+  const auto topicHash = topicInfo->topicHash_;
+  const auto topicId = topicInfo->getTopicId();
+
+  const auto fillMDHeader = [&](MDHeader& mdHeader) {
+    mdHeader.exchTs_ = exchTs;
+    mdHeader.localTs_ = asyncTask->task_->localTs_;
+    mdHeader.marketCode_ = mdSvc_->getMarketCodeEnum();
+    mdHeader.symbolType_ = mdSvc_->getSymbolTypeEnum();
+    strncpy(mdHeader.symbolCode_, symbolCode.c_str(),
+            sizeof(mdHeader.symbolCode_) - 1);
+    mdHeader.mdType_ = MDType::Books;
+  };
+
+  if (pubBooksDelta_) {
+    //! 只推送变化了的档位，接收端通过BooksRebuilder重建完整的订单簿
+    const auto numOfAsks = booksDelta->asks_->size();
+    const auto numOfBids = booksDelta->bids_->size();
+    mdSvc_->getSHMSrv()->pushMsgWithZeroCopy(
+        [&](void* shmBuf) {
+          auto books = static_cast<BooksDelta*>(shmBuf);
+          books->shmHeader_.topicHash_ = topicHash;
+          books->shmHeader_.topicId_ = topicId;
+          TraceMDPub(books->mdHeader_, asyncTask->task_->tscOfRecv_);
+          fillMDHeader(books->mdHeader_);
+          books->seqNo_ = booksDelta->seqNo_;
+          books->isFullRefresh_ = booksDelta->isFullRefresh_;
+          books->numOfAsks_ = numOfAsks;
+          books->numOfBids_ = numOfBids;
+          auto depth = books->depthGroup_;
+          for (const auto& priceLevel : *booksDelta->asks_) {
+            depth->price_ = priceLevel.price_;
+            depth->size_ = priceLevel.size_;
+            ++depth;
+          }
+          for (const auto& priceLevel : *booksDelta->bids_) {
+            depth->price_ = priceLevel.price_;
+            depth->size_ = priceLevel.size_;
+            ++depth;
+          }
+        },
+        PUB_CHANNEL, MSG_ID_ON_MD_BOOKS_DELTA,
+        GetSizeOfBooksDelta(numOfAsks + numOfBids));
+
+    if (mdSvc_->saveMarketData()) {
+      auto& books = std::ext::tls_get<Books>();
+      memset(&books, 0, sizeof(Books));
+      books.shmHeader_.topicHash_ = topicHash;
+      books.shmHeader_.topicId_ = topicId;
+      fillMDHeader(books.mdHeader_);
+      fillDepthOfBooks(&books, snapshot);
+      arg->marketDataOfUnifiedFmt_ =
+          books.dataOfUnifiedFmt(mdSvc_->getBooksDepthLevelOfSave());
+      arg->exchTs_ = exchTs;
+      arg->topic_ = topic;
+    }
 
-        std::uint32_t bidsLvl = 0;
-        for (auto iter = std::begin(*snapshot->bids_);
-             iter != std::end(*snapshot->bids_); ++iter, ++bidsLvl) {
-          if (bidsLvl >= MAX_DEPTH_LEVEL) break;
-          const auto& depthData = iter->second;
-          books->bids_[bidsLvl].price_ = depthData->price_;
-          books->bids_[bidsLvl].size_ = depthData->size_;
-        }
-        if (mdSvc_->saveMarketData()) {
-          arg->marketDataOfUnifiedFmt_ =
-              books->dataOfUnifiedFmt(mdSvc_->getBooksDepthLevelOfSave());
-          arg->exchTs_ = exchTs;
-          arg->topic_ = topic;
-        }
-      },
-      PUB_CHANNEL, MSG_ID_ON_MD_BOOKS, sizeof(Books));
+  } else {
+    mdSvc_->getSHMSrv()->pushMsgWithZeroCopy(
+        [&](void* shmBuf) {
+          auto books = static_cast<Books*>(shmBuf);
+          books->shmHeader_.topicHash_ = topicHash;
+          books->shmHeader_.topicId_ = topicId;
+          TraceMDPub(books->mdHeader_, asyncTask->task_->tscOfRecv_);
+          fillMDHeader(books->mdHeader_);
+          fillDepthOfBooks(books, snapshot);
+          if (mdSvc_->saveMarketData()) {
+            arg->marketDataOfUnifiedFmt_ =
+                books->dataOfUnifiedFmt(mdSvc_->getBooksDepthLevelOfSave());
+            arg->exchTs_ = exchTs;
+            arg->topic_ = topic;
+          }
+        },
+        PUB_CHANNEL, MSG_ID_ON_MD_BOOKS, sizeof(Books));
+  }
 
   //! Total num: 10000; avg: 222; med: 35; min: 11; max: 289810
 #ifdef PERF_TEST
@@ -506,6 +559,45 @@ std::string WSCliOfExchBinance::handleMDBooks(WSCliAsyncTaskSPtr& asyncTask) {
   return topic;
 }
 
+//! 先查品种注册表，注册表中没有的时候退回品种信息表并登记到注册表
+const InternedSymbol* WSCliOfExchBinance::getSymbolByExchSymbolCode(
+    const std::string& exchSymbolCode) const {
+  auto& symbolRegistry = SymbolRegistry::get_mutable_instance();
+  auto symbolId = symbolRegistry.getIdByExchSymbolCode(
+      mdSvc_->getMarketCodeEnum(), mdSvc_->getSymbolTypeEnum(), exchSymbolCode);
+  if (symbolId == INVALID_INTERNED_SYMBOL_ID) {
+    const auto [ret, symbolCode] =
+        mdSvc_->getTBLMonitorOfSymbolInfo()->getSymbolCode(
+            mdSvc_->getMarketCode(), mdSvc_->getSymbolType(), exchSymbolCode);
+    if (ret != 0) {
+      return nullptr;
+    }
+    symbolId = symbolRegistry.intern(mdSvc_->getMarketCodeEnum(),
+                                     mdSvc_->getSymbolTypeEnum(), symbolCode,
+                                     exchSymbolCode);
+  }
+  return symbolRegistry.getSymbol(symbolId);
+}
+
+void WSCliOfExchBinance::fillDepthOfBooks(Books* books,
+                                          const BooksDataSPtr& snapshot) {
+  std::uint32_t asksLvl = 0;
+  for (auto iter = std::begin(*snapshot->asks_);
+       iter != std::end(*snapshot->asks_); ++iter, ++asksLvl) {
+    if (asksLvl >= MAX_DEPTH_LEVEL) break;
+    books->asks_[asksLvl].price_ = iter->price_;
+    books->asks_[asksLvl].size_ = iter->size_;
+  }
+
+  std::uint32_t bidsLvl = 0;
+  for (auto iter = std::begin(*snapshot->bids_);
+       iter != std::end(*snapshot->bids_); ++iter, ++bidsLvl) {
+    if (bidsLvl >= MAX_DEPTH_LEVEL) break;
+    books->bids_[bidsLvl].price_ = iter->price_;
+    books->bids_[bidsLvl].size_ = iter->size_;
+  }
+}
+
 /*
  * {
  *   "result": null,
@@ -38,6 +38,9 @@ class RawMDHandlerOfCTP : public RawMDHandler {
   std::tuple<int, RawMDAsyncTaskSPtr> makeAsyncTask(
       const RawMDSPtr& task) final;
 
+ private:
+  std::vector<std::size_t> getSizeGroupOfRawData() const final;
+
  private:
   void handleNewSymbol(RawMDAsyncTaskSPtr& asyncTask) final;
   bq::db::symbolInfo::RecordSPtr makeRecSymbolInfo(
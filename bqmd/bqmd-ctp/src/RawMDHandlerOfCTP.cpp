@@ -75,6 +75,10 @@ std::tuple<int, RawMDAsyncTaskSPtr> RawMDHandlerOfCTP::makeAsyncTask(
   return {-1, nullptr};
 }
 
+std::vector<std::size_t> RawMDHandlerOfCTP::getSizeGroupOfRawData() const {
+  return {sizeof(CThostFtdcDepthMarketDataField)};
+}
+
 void RawMDHandlerOfCTP::handleNewSymbol(RawMDAsyncTaskSPtr& asyncTask) {
   //! 代码入库
   auto recSymbolInfo = makeRecSymbolInfo(asyncTask);
@@ -184,13 +188,12 @@ bool RawMDHandlerOfCTP::handleMDTickers(RawMDAsyncTaskSPtr& asyncTask) {
   if (md->LastPrice == 0 || md->LastPrice == DBL_MAX) return false;
 
   // buf is released when asyncTask->task_ is destructed
-  auto buf = calloc(1, sizeof(Tickers));
-  asyncTask->task_->dataAfterConv_ = buf;
-  asyncTask->task_->dataAfterConvLen_ = sizeof(Tickers);
+  auto buf = asyncTask->task_->allocDataAfterConv(sizeof(Tickers));
 
   // init tickers
   auto tickers = static_cast<Tickers*>(buf);
   tickers->shmHeader_.topicHash_ = asyncTask->task_->topicHash_;
+  tickers->shmHeader_.topicId_ = asyncTask->task_->topicId_;
 
   tickers->mdHeader_.localTs_ = asyncTask->task_->localTs_;
   tickers->mdHeader_.marketCode_ = asyncTask->task_->marketCode_;
@@ -259,6 +262,7 @@ bool RawMDHandlerOfCTP::handleMDTickers(RawMDAsyncTaskSPtr& asyncTask) {
           GetMarketName(tickers->mdHeader_.marketCode_));
     return true;
   }
+  TraceMDPub(tickers->mdHeader_, asyncTask->task_->tscOfRecv_);
   shmSrv->pushMsg(PUB_CHANNEL, MSG_ID_ON_MD_TICKERS, tickers, sizeof(Tickers));
   return true;
 }
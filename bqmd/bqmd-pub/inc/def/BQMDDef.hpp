@@ -49,4 +49,114 @@ using Bids = std::map<Price, DepthDataSPtr<T>, std::greater<Price>>;
 template <typename T>
 using BidsSPtr = std::shared_ptr<Bids<T>>;
 
+//! priceMult_是价格按DBL_TO_INT_MULTI转换成的整数，用于比较和查找
+template <typename T>
+struct PriceLevel {
+  Price priceMult_{0};
+  T price_;
+  T size_;
+};
+
+//!
+//! 档位连续存放的单边订单簿，用来代替按节点分配内存的Asks和Bids：
+//! 1. 数组按Compare从劣到优排列，最优价位在数组末尾，取最优价位是O(1)，
+//!    变化最频繁的盘口附近的增删只需要移动末尾少数几个档位；
+//! 2. 查找价位使用没有分支的二分查找，档位连续存放，对缓存友好；
+//! 3. 迭代器按从优到劣的顺序遍历，和Asks、Bids的遍历顺序一致。
+//!
+template <typename T, typename Compare>
+class FlatBooksSide {
+ public:
+  using PriceLevelGroup = std::vector<PriceLevel<T>>;
+  using const_iterator = typename PriceLevelGroup::const_reverse_iterator;
+
+  const_iterator begin() const { return priceLevelGroup_.crbegin(); }
+  const_iterator end() const { return priceLevelGroup_.crend(); }
+
+  std::size_t size() const { return priceLevelGroup_.size(); }
+  bool empty() const { return priceLevelGroup_.empty(); }
+
+  //! 调用前需要确认订单簿不为空
+  const PriceLevel<T>& best() const { return priceLevelGroup_.back(); }
+
+  //! 从最优价位开始的第idx档，调用前需要确认idx小于size()
+  const PriceLevel<T>& at(std::size_t idx) const {
+    return priceLevelGroup_[priceLevelGroup_.size() - 1 - idx];
+  }
+
+  //! lhs是否是比rhs更劣的价位
+  static bool IsWorse(Price lhs, Price rhs) { return Compare()(lhs, rhs); }
+
+  void reserve(std::size_t num) { priceLevelGroup_.reserve(num); }
+  void clear() { priceLevelGroup_.clear(); }
+
+  //! 追加的时候不保证有序，全部追加完之后需要调用sort
+  void append(Price priceMult, const T& price, const T& size) {
+    priceLevelGroup_.push_back({priceMult, price, size});
+  }
+
+  //! 排序并去掉重复的价位，重复的价位保留先追加的那个
+  void sort() {
+    std::stable_sort(std::begin(priceLevelGroup_), std::end(priceLevelGroup_),
+                     [](const auto& lhs, const auto& rhs) {
+                       return Compare()(lhs.priceMult_, rhs.priceMult_);
+                     });
+    const auto iter =
+        std::unique(std::begin(priceLevelGroup_), std::end(priceLevelGroup_),
+                    [](const auto& lhs, const auto& rhs) {
+                      return lhs.priceMult_ == rhs.priceMult_;
+                    });
+    priceLevelGroup_.erase(iter, std::end(priceLevelGroup_));
+  }
+
+  //! 价位已经存在的时候覆盖，否则插入
+  void set(const PriceLevel<T>& priceLevel) {
+    const auto idx = lowerBound(priceLevel.priceMult_);
+    if (idx < priceLevelGroup_.size() &&
+        priceLevelGroup_[idx].priceMult_ == priceLevel.priceMult_) {
+      priceLevelGroup_[idx] = priceLevel;
+    } else {
+      priceLevelGroup_.insert(std::begin(priceLevelGroup_) + idx, priceLevel);
+    }
+  }
+
+  void erase(Price priceMult) {
+    const auto idx = lowerBound(priceMult);
+    if (idx < priceLevelGroup_.size() &&
+        priceLevelGroup_[idx].priceMult_ == priceMult) {
+      priceLevelGroup_.erase(std::begin(priceLevelGroup_) + idx);
+    }
+  }
+
+ private:
+  //! 返回第一个不满足Compare(priceMult_, priceMult)的下标，循环中的选择
+  //! 会被编译成cmov，不会因为分支预测失败而停顿
+  std::size_t lowerBound(Price priceMult) const {
+    auto num = priceLevelGroup_.size();
+    if (num == 0) return 0;
+    const auto* base = priceLevelGroup_.data();
+    while (num > 1) {
+      const auto half = num / 2;
+      base = Compare()(base[half].priceMult_, priceMult) ? base + half : base;
+      num -= half;
+    }
+    return (base - priceLevelGroup_.data()) +
+           (Compare()(base->priceMult_, priceMult) ? 1 : 0);
+  }
+
+ private:
+  PriceLevelGroup priceLevelGroup_;
+};
+
+//! 卖盘价格降序存放、买盘价格升序存放，最优价位都在数组末尾
+template <typename T>
+using FlatAsks = FlatBooksSide<T, std::greater<Price>>;
+template <typename T>
+using FlatAsksSPtr = std::shared_ptr<FlatAsks<T>>;
+
+template <typename T>
+using FlatBids = FlatBooksSide<T, std::less<Price>>;
+template <typename T>
+using FlatBidsSPtr = std::shared_ptr<FlatBids<T>>;
+
 }  // namespace bq::md
@@ -0,0 +1,186 @@
+/*!
+ * \file BQMDBin.hpp
+ * \project BetterQuant
+ *
+ * \author byrnexu
+ * \date 2023/03/24
+ *
+ * \brief
+ */
+
+#pragma once
+
+#include "util/BQMDHis.hpp"
+#include "util/Pch.hpp"
+
+namespace bq::md {
+
+//!
+//! 历史行情的二进制文件格式，每个topic每天一个数据文件 日期.bin 和一个索引文件
+//! 日期.bin.idx，两个文件都只追加，不截断也不改写已经写入的内容：
+//!
+//! 数据文件由若干个数据块组成：
+//!   BinBlockHeader + 记录 * numOfRec
+//!   ......
+//!
+//! 索引文件是定长的BinBlockIndex的数组（稀疏时间索引，每个数据块一条）。
+//!
+//! 每条记录的格式为：
+//!   varint(zigzag(exchTs - 上一条记录的exchTs))
+//!   varint(zigzag(localTs - exchTs))
+//!   varint(lenOfData)
+//!   data（统一格式的行情）
+//!
+//! 块内第一条记录的exchTs相对于块头中的baseExchTs编码。
+//!
+//! 查询的时候mmap数据文件，根据索引文件跳过时间范围之外的数据块，只解码命中
+//! 的数据块，不需要逐行读取和解析文本。
+//!
+//! 追加写入的时候先写完整的数据块，再追加对应的索引，所以索引中的数据块一定
+//! 是完整的；数据文件从不变小，已经mmap的读取方不会因为文件被截断而SIGBUS。
+//! 写入过程中进程退出留下的不完整的数据块不会出现在索引中，下次追加从文件末尾
+//! 开始；索引文件不存在的时候（比如旧的文件）通过遍历块头重建。
+//!
+
+#pragma pack(push, 1)
+struct BinBlockHeader {
+  std::uint32_t magic_;
+  std::uint32_t numOfRec_;
+  std::uint32_t lenOfBlock_;
+  std::uint64_t baseExchTs_;
+  std::uint64_t minExchTs_;
+  std::uint64_t maxExchTs_;
+  std::uint64_t minLocalTs_;
+  std::uint64_t maxLocalTs_;
+};
+
+struct BinBlockIndex {
+  std::uint64_t offset_;
+  std::uint64_t minExchTs_;
+  std::uint64_t maxExchTs_;
+  std::uint64_t minLocalTs_;
+  std::uint64_t maxLocalTs_;
+};
+#pragma pack(pop)
+
+using BinBlockIndexGroup = std::vector<BinBlockIndex>;
+
+class MDBinReader;
+using MDBinReaderSPtr = std::shared_ptr<MDBinReader>;
+
+class MDBinReader {
+ public:
+  MDBinReader(const MDBinReader&) = delete;
+  MDBinReader& operator=(const MDBinReader&) = delete;
+  MDBinReader(const MDBinReader&&) = delete;
+  MDBinReader& operator=(const MDBinReader&&) = delete;
+
+  explicit MDBinReader(const std::string& filename);
+
+ public:
+  int open();
+
+  //! 加载 tsBegin <= ts < tsEnd 的记录，超过maxNum条返回错误
+  int loadBetween(IndexType indexType, std::uint64_t tsBegin,
+                  std::uint64_t tsEnd, std::uint32_t maxNum,
+                  Ts2HisMDGroup& ts2HisMDGroup) const;
+
+  //! 加载 ts <= tsEnd 的最后num条记录
+  int loadBefore(IndexType indexType, std::uint64_t tsEnd, std::uint32_t num,
+                 Ts2HisMDGroup& ts2HisMDGroup) const;
+
+  //! 加载 ts >= tsBegin 的最前num条记录
+  int loadAfter(IndexType indexType, std::uint64_t tsBegin, std::uint32_t num,
+                Ts2HisMDGroup& ts2HisMDGroup) const;
+
+  const BinBlockIndexGroup& getBlockIndexGroup() const {
+    return blockIndexGroup_;
+  }
+
+ private:
+  template <typename Callback>
+  int decodeBlock(const BinBlockIndex& blockIndex, Callback&& callback) const;
+
+ private:
+  const std::string filename_;
+  boost::interprocess::file_mapping fileMapping_;
+  boost::interprocess::mapped_region mappedRegion_;
+  const char* data_{nullptr};
+  std::size_t size_{0};
+  BinBlockIndexGroup blockIndexGroup_;
+};
+
+class MDBin {
+ public:
+  MDBin() = delete;
+  MDBin(const MDBin&) = delete;
+  MDBin& operator=(const MDBin&) = delete;
+  MDBin(const MDBin&&) = delete;
+  MDBin& operator=(const MDBin&&) = delete;
+
+ public:
+  //! mdGroup中每个元素是一条统一格式的行情，结尾的换行符会被去掉，全部写入，
+  //! 最后一个数据块可能不满MAX_NUM_OF_REC_IN_BLOCK条
+  static int AppendToFile(const std::string& filename,
+                          const std::vector<std::string>& mdGroup);
+
+  //! 只写入凑满MAX_NUM_OF_REC_IN_BLOCK条的数据块，剩下的行情留在mdGroup中，
+  //! 由调用方和之后的行情一起写入，避免频繁的小批量写入产生大量很小的数据块
+  static int AppendFullBlockToFile(const std::string& filename,
+                                   std::vector<std::string>& mdGroup);
+
+  static std::string GetIndexFilenameByBinFilename(
+      const std::string& filenameOfBin);
+
+  //! 将原来的文本格式的历史行情转换成二进制格式
+  static int ConvertTextFileToBinFile(const std::string& filenameOfText,
+                                      const std::string& filenameOfBin);
+
+  //! 递归转换目录下所有的 日期.dat 文件，生成同名的 日期.bin 文件
+  static int ConvertDirToBinFmt(const std::string& path);
+
+  static std::string GetBinFilenameByMDFilename(const std::string& filenameOfMD);
+
+  //! 从统一格式的行情中直接查找时间戳，不做json解析
+  static std::tuple<int, std::uint64_t> GetTsFromUnifiedFmt(
+      std::string_view md, IndexType indexType);
+
+  //! 读取索引文件，丢弃不在数据文件[0, size)范围内或者块头无效的索引，
+  //! 索引文件不存在的时候遍历块头重建索引
+  static std::tuple<int, BinBlockIndexGroup> LoadBlockIndexGroup(
+      const std::string& filename, const char* data, std::size_t size);
+
+  //! 从offset开始遍历块头，返回完整的数据块的索引和最后一个完整数据块的结尾
+  static std::tuple<BinBlockIndexGroup, std::uint64_t> ScanBlockHeader(
+      const char* data, std::size_t size, std::uint64_t offset = 0);
+
+  static void AppendVarint(std::string& buf, std::uint64_t value);
+  static bool ReadVarint(const char*& cur, const char* end,
+                         std::uint64_t& value);
+
+  static std::uint64_t ZigzagEncode(std::int64_t value) {
+    return (static_cast<std::uint64_t>(value) << 1) ^
+           static_cast<std::uint64_t>(value >> 63);
+  }
+  static std::int64_t ZigzagDecode(std::uint64_t value) {
+    return static_cast<std::int64_t>(value >> 1) ^
+           -static_cast<std::int64_t>(value & 1);
+  }
+
+ private:
+  //! 将mdGroup中的前num条行情编码为数据块追加到文件中
+  static int AppendBlockGroupToFile(const std::string& filename,
+                                    const std::vector<std::string>& mdGroup,
+                                    std::size_t num);
+
+  //! 返回新的数据块的偏移（数据文件的大小）和需要补写的索引，补写的索引来自
+  //! 上次写完数据块之后、写索引之前进程退出的情况，或者索引文件不存在的情况
+  static std::tuple<int, BinBlockIndexGroup, std::uint64_t> PrepareToAppend(
+      const std::string& filename, const std::string& filenameOfIdx);
+
+ public:
+  inline const static std::uint32_t MAGIC_OF_BLOCK{0x424d5142};  // BQMB
+  inline const static std::uint32_t MAX_NUM_OF_REC_IN_BLOCK{256};
+};
+
+}  // namespace bq::md
@@ -42,6 +42,9 @@ using Ts2IndexWithFilenameGroup =
 using Ts2IndexWithFilenameGroupSPtr =
     std::shared_ptr<Ts2IndexWithFilenameGroup>;
 
+class MDBinReader;
+using MDBinReaderSPtr = std::shared_ptr<MDBinReader>;
+
 class MDHis {
  public:
   MDHis() = delete;
@@ -82,6 +85,10 @@ class MDHis {
   static boost::filesystem::path GetPathPrefixOfHisMD(
       const std::string& rootPath, const std::string& topic);
 
+  //! 二进制格式的历史行情文件不存在或者打开失败返回nullptr，使用文本格式
+  static MDBinReaderSPtr OpenBinFileIfExists(
+      const boost::filesystem::path& pathPrefix, const std::string& date);
+
  public:
   static std::string GetMDFilenameByIdxFilename(const std::string& idxFilename,
                                                 IndexType indexType);
@@ -19,4 +19,8 @@ std::string RemoveDepthInTopicOfBooks(const std::string& topic);
 
 std::string GetSymbolCode(MarketCode marketCode,
                           const std::string& exchSymbolCode);
+
+//! 开启时延追踪的时候在行情中写入收到和发布的tsc，关闭的时候都写入0
+void TraceMDPub(MDHeader& mdHeader, std::uint64_t tscOfRecv);
+
 }  // namespace bq::md
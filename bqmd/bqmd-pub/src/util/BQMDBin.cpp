@@ -0,0 +1,555 @@
+/*!
+ * \file BQMDBin.cpp
+ * \project BetterQuant
+ *
+ * \author byrnexu
+ * \date 2023/03/24
+ *
+ * \brief
+ */
+
+#include "util/BQMDBin.hpp"
+
+#include "def/Const.hpp"
+#include "def/Def.hpp"
+#include "def/StatusCode.hpp"
+#include "util/Logger.hpp"
+
+namespace bq::md {
+
+MDBinReader::MDBinReader(const std::string& filename) : filename_(filename) {}
+
+int MDBinReader::open() {
+  try {
+    if (boost::filesystem::file_size(filename_) == 0) {
+      return 0;
+    }
+    fileMapping_ = boost::interprocess::file_mapping(
+        filename_.c_str(), boost::interprocess::read_only);
+    mappedRegion_ = boost::interprocess::mapped_region(
+        fileMapping_, boost::interprocess::read_only);
+  } catch (const std::exception& e) {
+    LOG_W("Open bin file of his market data {} failed. [{}]", filename_,
+          e.what());
+    return SCODE_HIS_MD_OPEN_BIN_FILE_FAILED;
+  }
+
+  data_ = static_cast<const char*>(mappedRegion_.get_address());
+  size_ = mappedRegion_.get_size();
+
+  int statusCode = 0;
+  std::tie(statusCode, blockIndexGroup_) =
+      MDBin::LoadBlockIndexGroup(filename_, data_, size_);
+  return statusCode;
+}
+
+template <typename Callback>
+int MDBinReader::decodeBlock(const BinBlockIndex& blockIndex,
+                             Callback&& callback) const {
+  BinBlockHeader header;
+  std::memcpy(&header, data_ + blockIndex.offset_, sizeof(BinBlockHeader));
+
+  const char* cur = data_ + blockIndex.offset_ + sizeof(BinBlockHeader);
+  const char* end = cur + header.lenOfBlock_;
+
+  auto exchTs = header.baseExchTs_;
+  for (std::uint32_t i = 0; i < header.numOfRec_; ++i) {
+    std::uint64_t deltaOfExchTs = 0;
+    std::uint64_t deltaOfLocalTs = 0;
+    std::uint64_t lenOfData = 0;
+    if (!MDBin::ReadVarint(cur, end, deltaOfExchTs) ||
+        !MDBin::ReadVarint(cur, end, deltaOfLocalTs) ||
+        !MDBin::ReadVarint(cur, end, lenOfData) ||
+        lenOfData > static_cast<std::uint64_t>(end - cur)) {
+      LOG_W("Decode block of bin file {} failed. [offset = {}]", filename_,
+            blockIndex.offset_);
+      return SCODE_HIS_MD_INVALID_BIN_FILE;
+    }
+    exchTs += MDBin::ZigzagDecode(deltaOfExchTs);
+    const auto localTs = exchTs + MDBin::ZigzagDecode(deltaOfLocalTs);
+    callback(exchTs, localTs, std::string_view(cur, lenOfData));
+    cur += lenOfData;
+  }
+
+  return 0;
+}
+
+int MDBinReader::loadBetween(IndexType indexType, std::uint64_t tsBegin,
+                             std::uint64_t tsEnd, std::uint32_t maxNum,
+                             Ts2HisMDGroup& ts2HisMDGroup) const {
+  const auto byExchTs = indexType == IndexType::ByExchTs;
+  Ts2HisMDGroup ret;
+  for (const auto& blockIndex : blockIndexGroup_) {
+    const auto minTs = byExchTs ? blockIndex.minExchTs_ : blockIndex.minLocalTs_;
+    const auto maxTs = byExchTs ? blockIndex.maxExchTs_ : blockIndex.maxLocalTs_;
+    if (maxTs < tsBegin || minTs >= tsEnd) {
+      continue;
+    }
+
+    const auto statusCode = decodeBlock(
+        blockIndex, [&](auto exchTs, auto localTs, std::string_view md) {
+          const auto ts = byExchTs ? exchTs : localTs;
+          if (ts >= tsBegin && ts < tsEnd) {
+            ret.emplace(ts, std::string(md));
+          }
+        });
+    if (statusCode != 0) {
+      return statusCode;
+    }
+
+    if (ret.size() > maxNum) {
+      return SCODE_HIS_MD_NUM_OF_RECORDS_GREATER_THAN_LIMIT;
+    }
+  }
+
+  ts2HisMDGroup.merge(ret);
+  return 0;
+}
+
+int MDBinReader::loadBefore(IndexType indexType, std::uint64_t tsEnd,
+                            std::uint32_t num,
+                            Ts2HisMDGroup& ts2HisMDGroup) const {
+  if (num == 0) return 0;
+
+  const auto byExchTs = indexType == IndexType::ByExchTs;
+  Ts2HisMDGroup ret;
+  for (auto iter = blockIndexGroup_.rbegin(); iter != blockIndexGroup_.rend();
+       ++iter) {
+    const auto minTs = byExchTs ? iter->minExchTs_ : iter->minLocalTs_;
+    const auto maxTs = byExchTs ? iter->maxExchTs_ : iter->maxLocalTs_;
+    if (minTs > tsEnd) {
+      continue;
+    }
+    //! 已经凑够num条，并且该块中的记录都比已有的记录旧
+    if (ret.size() >= num && maxTs < std::begin(ret)->first) {
+      continue;
+    }
+
+    const auto statusCode =
+        decodeBlock(*iter, [&](auto exchTs, auto localTs, std::string_view md) {
+          const auto ts = byExchTs ? exchTs : localTs;
+          if (ts <= tsEnd) {
+            ret.emplace(ts, std::string(md));
+          }
+        });
+    if (statusCode != 0) {
+      return statusCode;
+    }
+
+    while (ret.size() > num) {
+      ret.erase(std::begin(ret));
+    }
+  }
+
+  ts2HisMDGroup.merge(ret);
+  return 0;
+}
+
+int MDBinReader::loadAfter(IndexType indexType, std::uint64_t tsBegin,
+                           std::uint32_t num,
+                           Ts2HisMDGroup& ts2HisMDGroup) const {
+  if (num == 0) return 0;
+
+  const auto byExchTs = indexType == IndexType::ByExchTs;
+  Ts2HisMDGroup ret;
+  for (const auto& blockIndex : blockIndexGroup_) {
+    const auto minTs = byExchTs ? blockIndex.minExchTs_ : blockIndex.minLocalTs_;
+    const auto maxTs = byExchTs ? blockIndex.maxExchTs_ : blockIndex.maxLocalTs_;
+    if (maxTs < tsBegin) {
+      continue;
+    }
+    //! 已经凑够num条，并且该块中的记录都比已有的记录新
+    if (ret.size() >= num && minTs > std::prev(std::end(ret))->first) {
+      continue;
+    }
+
+    const auto statusCode = decodeBlock(
+        blockIndex, [&](auto exchTs, auto localTs, std::string_view md) {
+          const auto ts = byExchTs ? exchTs : localTs;
+          if (ts >= tsBegin) {
+            ret.emplace(ts, std::string(md));
+          }
+        });
+    if (statusCode != 0) {
+      return statusCode;
+    }
+
+    while (ret.size() > num) {
+      ret.erase(std::prev(std::end(ret)));
+    }
+  }
+
+  ts2HisMDGroup.merge(ret);
+  return 0;
+}
+
+int MDBin::AppendToFile(const std::string& filename,
+                        const std::vector<std::string>& mdGroup) {
+  return AppendBlockGroupToFile(filename, mdGroup, mdGroup.size());
+}
+
+int MDBin::AppendFullBlockToFile(const std::string& filename,
+                                 std::vector<std::string>& mdGroup) {
+  const auto num = mdGroup.size() / MAX_NUM_OF_REC_IN_BLOCK *
+                   MAX_NUM_OF_REC_IN_BLOCK;
+  if (num == 0) return 0;
+  const auto statusCode = AppendBlockGroupToFile(filename, mdGroup, num);
+  if (statusCode != 0) {
+    return statusCode;
+  }
+  mdGroup.erase(std::begin(mdGroup), std::next(std::begin(mdGroup), num));
+  return 0;
+}
+
+std::tuple<int, BinBlockIndexGroup, std::uint64_t> MDBin::PrepareToAppend(
+    const std::string& filename, const std::string& filenameOfIdx) {
+  BinBlockIndexGroup blockIndexGroup;
+  const auto sizeOfData = boost::filesystem::exists(filename)
+                              ? boost::filesystem::file_size(filename)
+                              : 0;
+  if (sizeOfData == 0) {
+    boost::filesystem::remove(filenameOfIdx);
+    return {0, blockIndexGroup, 0};
+  }
+
+  //! 索引文件只通过read读取，不会被mmap，截掉不完整的最后一条索引是安全的
+  std::uint64_t endOfBlockIndexed = 0;
+  if (boost::filesystem::exists(filenameOfIdx)) {
+    const auto sizeOfIdx = boost::filesystem::file_size(filenameOfIdx);
+    const auto numOfIdx = sizeOfIdx / sizeof(BinBlockIndex);
+    if (sizeOfIdx != numOfIdx * sizeof(BinBlockIndex)) {
+      boost::filesystem::resize_file(filenameOfIdx,
+                                     numOfIdx * sizeof(BinBlockIndex));
+    }
+    if (numOfIdx != 0) {
+      BinBlockIndex blockIndex;
+      BinBlockHeader header;
+      std::ifstream inOfIdx(filenameOfIdx.c_str(), std::ios::binary);
+      inOfIdx.seekg((numOfIdx - 1) * sizeof(BinBlockIndex));
+      inOfIdx.read(reinterpret_cast<char*>(&blockIndex),
+                   sizeof(BinBlockIndex));
+      std::ifstream in(filename.c_str(), std::ios::binary);
+      in.seekg(blockIndex.offset_);
+      in.read(reinterpret_cast<char*>(&header), sizeof(BinBlockHeader));
+      if (!inOfIdx || !in || header.magic_ != MAGIC_OF_BLOCK) {
+        LOG_W("Append market data to bin file {} failed because of "
+              "invalid index file {}.",
+              filename, filenameOfIdx);
+        return {SCODE_HIS_MD_INVALID_BIN_FILE, blockIndexGroup, 0};
+      }
+      endOfBlockIndexed =
+          blockIndex.offset_ + sizeof(BinBlockHeader) + header.lenOfBlock_;
+    }
+    if (endOfBlockIndexed >= sizeOfData) {
+      return {0, blockIndexGroup, sizeOfData};
+    }
+  }
+
+  //! 只遍历没有索引的部分
+  boost::interprocess::file_mapping fileMapping(
+      filename.c_str(), boost::interprocess::read_only);
+  boost::interprocess::mapped_region mappedRegion(
+      fileMapping, boost::interprocess::read_only);
+  std::uint64_t validSize = 0;
+  std::tie(blockIndexGroup, validSize) = ScanBlockHeader(
+      static_cast<const char*>(mappedRegion.get_address()),
+      mappedRegion.get_size(), endOfBlockIndexed);
+  if (validSize != sizeOfData) {
+    LOG_W("Skip incomplete block of bin file {}. [offset = {}, size = {}]",
+          filename, validSize, sizeOfData);
+  }
+  return {0, blockIndexGroup, sizeOfData};
+}
+
+int MDBin::AppendBlockGroupToFile(const std::string& filename,
+                                  const std::vector<std::string>& mdGroup,
+                                  std::size_t num) {
+  if (num == 0) return 0;
+
+  const auto filenameOfIdx = GetIndexFilenameByBinFilename(filename);
+  BinBlockIndexGroup blockIndexGroup;
+  std::uint64_t offset = 0;
+  try {
+    int statusCode = 0;
+    std::tie(statusCode, blockIndexGroup, offset) =
+        PrepareToAppend(filename, filenameOfIdx);
+    if (statusCode != 0) {
+      return statusCode;
+    }
+  } catch (const std::exception& e) {
+    LOG_W("Append market data to bin file {} failed. [{}]", filename,
+          e.what());
+    return SCODE_HIS_MD_SAVE_BIN_FILE_FAILED;
+  }
+
+  std::ofstream out(filename.c_str(), std::ios::binary | std::ios::app);
+  if (!out.is_open()) {
+    LOG_W("Append market data to bin file failed because of open file {} "
+          "failed.",
+          filename);
+    return SCODE_HIS_MD_SAVE_BIN_FILE_FAILED;
+  }
+
+  std::string block;
+  for (std::size_t i = 0; i < num; i += MAX_NUM_OF_REC_IN_BLOCK) {
+    const auto iEnd = std::min<std::size_t>(i + MAX_NUM_OF_REC_IN_BLOCK, num);
+    BinBlockHeader header{};
+    header.magic_ = MAGIC_OF_BLOCK;
+    header.minExchTs_ = UINT64_MAX;
+    header.minLocalTs_ = UINT64_MAX;
+
+    block.clear();
+    std::uint64_t prevExchTs = 0;
+    for (std::size_t j = i; j < iEnd; ++j) {
+      std::string_view md = mdGroup[j];
+      while (!md.empty() && (md.back() == '\n' || md.back() == '\r')) {
+        md.remove_suffix(1);
+      }
+      if (md.empty()) continue;
+
+      //! 早期的行情中可能只有exchTs或者localTs，缺失的一个与另一个相同
+      auto [statusCodeOfExchTs, exchTs] =
+          GetTsFromUnifiedFmt(md, IndexType::ByExchTs);
+      auto [statusCodeOfLocalTs, localTs] =
+          GetTsFromUnifiedFmt(md, IndexType::ByLocalTs);
+      if (statusCodeOfExchTs != 0 && statusCodeOfLocalTs != 0) {
+        LOG_W("Skip market data without ts when append to bin file {}. {}",
+              filename, md);
+        continue;
+      }
+      if (statusCodeOfExchTs != 0) exchTs = localTs;
+      if (statusCodeOfLocalTs != 0) localTs = exchTs;
+
+      if (header.numOfRec_ == 0) {
+        header.baseExchTs_ = exchTs;
+        prevExchTs = exchTs;
+      }
+      AppendVarint(block, ZigzagEncode(exchTs - prevExchTs));
+      AppendVarint(block, ZigzagEncode(localTs - exchTs));
+      AppendVarint(block, md.size());
+      block.append(md.data(), md.size());
+      prevExchTs = exchTs;
+
+      ++header.numOfRec_;
+      header.minExchTs_ = std::min(header.minExchTs_, exchTs);
+      header.maxExchTs_ = std::max(header.maxExchTs_, exchTs);
+      header.minLocalTs_ = std::min(header.minLocalTs_, localTs);
+      header.maxLocalTs_ = std::max(header.maxLocalTs_, localTs);
+    }
+    if (header.numOfRec_ == 0) continue;
+
+    header.lenOfBlock_ = block.size();
+    out.write(reinterpret_cast<const char*>(&header), sizeof(BinBlockHeader));
+    out.write(block.data(), block.size());
+
+    blockIndexGroup.emplace_back(
+        BinBlockIndex{offset, header.minExchTs_, header.maxExchTs_,
+                      header.minLocalTs_, header.maxLocalTs_});
+    offset += sizeof(BinBlockHeader) + block.size();
+  }
+
+  //! 数据块全部写完之后才追加索引，读取方只会读到完整的数据块
+  out.close();
+  if (!out) {
+    LOG_W("Append market data to bin file {} failed.", filename);
+    return SCODE_HIS_MD_SAVE_BIN_FILE_FAILED;
+  }
+  if (blockIndexGroup.empty()) {
+    return 0;
+  }
+
+  std::ofstream outOfIdx(filenameOfIdx.c_str(),
+                         std::ios::binary | std::ios::app);
+  outOfIdx.write(reinterpret_cast<const char*>(blockIndexGroup.data()),
+                 blockIndexGroup.size() * sizeof(BinBlockIndex));
+  outOfIdx.close();
+  if (!outOfIdx) {
+    LOG_W("Append index to {} failed.", filenameOfIdx);
+    return SCODE_HIS_MD_SAVE_BIN_FILE_FAILED;
+  }
+  return 0;
+}
+
+std::tuple<int, BinBlockIndexGroup> MDBin::LoadBlockIndexGroup(
+    const std::string& filename, const char* data, std::size_t size) {
+  BinBlockIndexGroup blockIndexGroup;
+
+  const auto filenameOfIdx = GetIndexFilenameByBinFilename(filename);
+  std::ifstream in(filenameOfIdx.c_str(), std::ios::binary);
+  if (!in.is_open()) {
+    //! 索引文件不存在，遍历块头重建索引
+    std::uint64_t validSize = 0;
+    std::tie(blockIndexGroup, validSize) = ScanBlockHeader(data, size);
+    if (validSize != size) {
+      LOG_W(
+          "Index file of {} not exists, rebuild index of {} blocks. "
+          "[valid size = {}, size = {}]",
+          filename, blockIndexGroup.size(), validSize, size);
+    }
+    return {0, blockIndexGroup};
+  }
+
+  //! 打开数据文件之后追加的数据块不在mmap的范围内，对应的索引丢弃
+  BinBlockIndex blockIndex;
+  while (in.read(reinterpret_cast<char*>(&blockIndex),
+                 sizeof(BinBlockIndex))) {
+    if (blockIndex.offset_ + sizeof(BinBlockHeader) > size) {
+      break;
+    }
+    BinBlockHeader header;
+    std::memcpy(&header, data + blockIndex.offset_, sizeof(BinBlockHeader));
+    if (header.magic_ != MAGIC_OF_BLOCK) {
+      LOG_W("Invalid index of bin file {}. [offset = {}]", filename,
+            blockIndex.offset_);
+      return {SCODE_HIS_MD_INVALID_BIN_FILE, BinBlockIndexGroup()};
+    }
+    if (blockIndex.offset_ + sizeof(BinBlockHeader) + header.lenOfBlock_ >
+        size) {
+      break;
+    }
+    blockIndexGroup.emplace_back(blockIndex);
+  }
+  return {0, blockIndexGroup};
+}
+
+std::tuple<BinBlockIndexGroup, std::uint64_t> MDBin::ScanBlockHeader(
+    const char* data, std::size_t size, std::uint64_t offset) {
+  BinBlockIndexGroup blockIndexGroup;
+  while (offset + sizeof(BinBlockHeader) <= size) {
+    BinBlockHeader header;
+    std::memcpy(&header, data + offset, sizeof(BinBlockHeader));
+    if (header.magic_ != MAGIC_OF_BLOCK ||
+        offset + sizeof(BinBlockHeader) + header.lenOfBlock_ > size) {
+      break;
+    }
+    blockIndexGroup.emplace_back(
+        BinBlockIndex{offset, header.minExchTs_, header.maxExchTs_,
+                      header.minLocalTs_, header.maxLocalTs_});
+    offset += sizeof(BinBlockHeader) + header.lenOfBlock_;
+  }
+  return {blockIndexGroup, offset};
+}
+
+int MDBin::ConvertTextFileToBinFile(const std::string& filenameOfText,
+                                    const std::string& filenameOfBin) {
+  std::ifstream in(filenameOfText.c_str());
+  if (!in.is_open()) {
+    LOG_W("Convert {} to bin file failed because of open file failed.",
+          filenameOfText);
+    return SCODE_HIS_MD_SAVE_BIN_FILE_FAILED;
+  }
+
+  try {
+    const auto path = boost::filesystem::path(filenameOfBin).parent_path();
+    if (!path.empty() && !boost::filesystem::exists(path)) {
+      boost::filesystem::create_directories(path);
+    }
+    boost::filesystem::remove(filenameOfBin);
+    boost::filesystem::remove(GetIndexFilenameByBinFilename(filenameOfBin));
+  } catch (const std::exception& e) {
+    LOG_W("Convert {} to bin file failed. [{}]", filenameOfText, e.what());
+    return SCODE_HIS_MD_SAVE_BIN_FILE_FAILED;
+  }
+
+  //! 分批写入，避免把整个大文件读入内存
+  const std::size_t numOfRecEachBatch = 100000;
+  std::vector<std::string> mdGroup;
+  mdGroup.reserve(numOfRecEachBatch);
+
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.empty()) continue;
+    mdGroup.emplace_back(std::move(line));
+    if (mdGroup.size() >= numOfRecEachBatch) {
+      if (const auto ret = AppendFullBlockToFile(filenameOfBin, mdGroup);
+          ret != 0) {
+        return ret;
+      }
+    }
+  }
+
+  if (const auto ret = AppendToFile(filenameOfBin, mdGroup); ret != 0) {
+    return ret;
+  }
+
+  LOG_I("Convert {} to bin file {} success.", filenameOfText, filenameOfBin);
+  return 0;
+}
+
+int MDBin::ConvertDirToBinFmt(const std::string& path) {
+  const auto extOfMDFile = fmt::format(".{}", HIS_MD_FILE_EXT);
+  int ret = 0;
+  try {
+    for (const auto& entry :
+         boost::filesystem::recursive_directory_iterator(path)) {
+      if (!boost::filesystem::is_regular_file(entry.path())) continue;
+      if (entry.path().extension().string() != extOfMDFile) continue;
+      //! 原始格式的行情按小时存放，文件名不是日期，不需要转换
+      if (entry.path().stem().string().size() != 8) continue;
+
+      const auto filenameOfText = entry.path().string();
+      const auto statusCode = ConvertTextFileToBinFile(
+          filenameOfText, GetBinFilenameByMDFilename(filenameOfText));
+      if (statusCode != 0) {
+        ret = statusCode;
+      }
+    }
+  } catch (const std::exception& e) {
+    LOG_W("Convert his market data in {} to bin fmt failed. [{}]", path,
+          e.what());
+    return SCODE_HIS_MD_SAVE_BIN_FILE_FAILED;
+  }
+  return ret;
+}
+
+std::string MDBin::GetBinFilenameByMDFilename(const std::string& filenameOfMD) {
+  auto ret = boost::filesystem::path(filenameOfMD);
+  ret.replace_extension(HIS_MD_BIN_FILE_EXT);
+  return ret.string();
+}
+
+std::string MDBin::GetIndexFilenameByBinFilename(
+    const std::string& filenameOfBin) {
+  return fmt::format("{}.{}", filenameOfBin, HIS_MD_BIN_INDEX_EXT);
+}
+
+std::tuple<int, std::uint64_t> MDBin::GetTsFromUnifiedFmt(
+    std::string_view md, IndexType indexType) {
+  const std::string_view tag =
+      indexType == IndexType::ByExchTs ? R"("exchTs":)" : R"("localTs":)";
+  const auto pos = md.find(tag);
+  if (pos == std::string_view::npos) {
+    return {SCODE_HIS_MD_GET_EXCH_TS_FAILED, 0};
+  }
+
+  std::uint64_t ts = 0;
+  const auto [ptr, ec] =
+      std::from_chars(md.data() + pos + tag.size(), md.data() + md.size(), ts);
+  if (ec != std::errc()) {
+    return {SCODE_HIS_MD_GET_EXCH_TS_FAILED, 0};
+  }
+  return {0, ts};
+}
+
+void MDBin::AppendVarint(std::string& buf, std::uint64_t value) {
+  while (value >= 0x80) {
+    buf.push_back(static_cast<char>(value | 0x80));
+    value >>= 7;
+  }
+  buf.push_back(static_cast<char>(value));
+}
+
+bool MDBin::ReadVarint(const char*& cur, const char* end,
+                       std::uint64_t& value) {
+  value = 0;
+  for (std::uint32_t shift = 0; shift < 64 && cur < end; shift += 7) {
+    const auto byte = static_cast<std::uint8_t>(*cur++);
+    value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace bq::md
@@ -13,6 +13,7 @@
 #include "def/Const.hpp"
 #include "def/Def.hpp"
 #include "def/StatusCode.hpp"
+#include "util/BQMDBin.hpp"
 #include "util/File.hpp"
 #include "util/Logger.hpp"
 #include "util/Util.hpp"
@@ -63,9 +64,32 @@ std::tuple<int, Ts2HisMDGroupSPtr> MDHis::LoadHisMDBetweenTs(
 
   auto ts2IndexWithFilenameGroup =
       std::make_shared<Ts2IndexWithFilenameGroup>();
+  auto ts2HisMDGroupOfBin = std::make_shared<Ts2HisMDGroup>();
   for (day_iterator iter(dateBegin); iter <= dateEnd; ++iter) {
     const auto date = to_iso_string(*iter);
 
+    if (const auto binReader = OpenBinFileIfExists(pathPrefix, date);
+        binReader) {
+      const auto statusCodeOfLoad = binReader->loadBetween(
+          indexType, tsBegin, tsEnd, maxNumOfHisMDCanBeQeuryEachTime,
+          *ts2HisMDGroupOfBin);
+      if (statusCodeOfLoad == 0 &&
+          ts2IndexWithFilenameGroup->size() + ts2HisMDGroupOfBin->size() <=
+              maxNumOfHisMDCanBeQeuryEachTime) {
+        continue;
+      }
+      if (statusCodeOfLoad == 0 ||
+          statusCodeOfLoad == SCODE_HIS_MD_NUM_OF_RECORDS_GREATER_THAN_LIMIT) {
+        const auto statusMsg = fmt::format(
+            "Load his market data between ts failed because "
+            "rec num of result greater than the query limit {}. topic = {}",
+            maxNumOfHisMDCanBeQeuryEachTime, topic);
+        LOG_W(statusMsg);
+        return {SCODE_HIS_MD_NUM_OF_RECORDS_GREATER_THAN_LIMIT,
+                std::make_shared<Ts2HisMDGroup>()};
+      }
+    }
+
     const auto idxFilename =
         fmt::format("{}.{}.{}", date, HIS_MD_FILE_EXT,
                     indexType == IndexType::ByExchTs ? HIS_MD_INDEX_BY_ET_EXT
@@ -92,7 +116,8 @@ std::tuple<int, Ts2HisMDGroupSPtr> MDHis::LoadHisMDBetweenTs(
           iterEnd, std::end(*ts2IndexWithFilenameGroupOfCurDate));
     }
     ts2IndexWithFilenameGroup->merge(*ts2IndexWithFilenameGroupOfCurDate);
-    if (ts2IndexWithFilenameGroup->size() > maxNumOfHisMDCanBeQeuryEachTime) {
+    if (ts2IndexWithFilenameGroup->size() + ts2HisMDGroupOfBin->size() >
+        maxNumOfHisMDCanBeQeuryEachTime) {
       const auto statusMsg = fmt::format(
           "Load index of his market data between ts failed because "
           "rec num of result greater than the query limit {}. topic = {}",
@@ -108,6 +133,7 @@ std::tuple<int, Ts2HisMDGroupSPtr> MDHis::LoadHisMDBetweenTs(
   if (statusCode != 0) {
     return {statusCode, ts2HisMDGroup};
   }
+  ts2HisMDGroup->merge(*ts2HisMDGroupOfBin);
 
   return {0, ts2HisMDGroup};
 }
@@ -165,9 +191,26 @@ std::tuple<int, Ts2HisMDGroupSPtr> MDHis::LoadHisMDBeforeTs(
 
   auto ts2IndexWithFilenameGroup =
       std::make_shared<Ts2IndexWithFilenameGroup>();
+  auto ts2HisMDGroupOfBin = std::make_shared<Ts2HisMDGroup>();
   for (day_iterator iter(dateBegin); iter >= dateEnd; --iter) {
     const auto date = to_iso_string(*iter);
 
+    const auto numOfLoaded =
+        ts2IndexWithFilenameGroup->size() + ts2HisMDGroupOfBin->size();
+    if (const auto binReader = OpenBinFileIfExists(pathPrefix, date);
+        binReader) {
+      const auto tsEnd = *iter == dateBegin ? ts : UINT64_MAX;
+      const auto statusCodeOfLoad = binReader->loadBefore(
+          indexType, tsEnd, num - numOfLoaded, *ts2HisMDGroupOfBin);
+      if (statusCodeOfLoad == 0) {
+        if (ts2IndexWithFilenameGroup->size() + ts2HisMDGroupOfBin->size() >=
+            num) {
+          break;
+        }
+        continue;
+      }
+    }
+
     const auto idxFilename =
         fmt::format("{}.{}.{}", date, HIS_MD_FILE_EXT,
                     indexType == IndexType::ByExchTs ? HIS_MD_INDEX_BY_ET_EXT
@@ -187,8 +230,10 @@ std::tuple<int, Ts2HisMDGroupSPtr> MDHis::LoadHisMDBeforeTs(
       ts2IndexWithFilenameGroup->erase(iterUpperBound,
                                        std::end(*ts2IndexWithFilenameGroup));
     }
-    if (ts2IndexWithFilenameGroup->size() >= num) {
-      const auto offset = ts2IndexWithFilenameGroup->size() - num;
+    if (ts2IndexWithFilenameGroup->size() + ts2HisMDGroupOfBin->size() >=
+        num) {
+      const auto offset = ts2IndexWithFilenameGroup->size() +
+                          ts2HisMDGroupOfBin->size() - num;
       ts2IndexWithFilenameGroup->erase(
           std::begin(*ts2IndexWithFilenameGroup),
           std::next(std::begin(*ts2IndexWithFilenameGroup), offset));
@@ -201,6 +246,7 @@ std::tuple<int, Ts2HisMDGroupSPtr> MDHis::LoadHisMDBeforeTs(
   if (statusCode != 0) {
     return {statusCode, ts2HisMDGroup};
   }
+  ts2HisMDGroup->merge(*ts2HisMDGroupOfBin);
 
   if (ts2HisMDGroup->size() < num) {
     const auto statusMsg = fmt::format(
@@ -260,9 +306,26 @@ std::tuple<int, Ts2HisMDGroupSPtr> MDHis::LoadHisMDAfterTs(
 
   auto ts2IndexWithFilenameGroup =
       std::make_shared<Ts2IndexWithFilenameGroup>();
+  auto ts2HisMDGroupOfBin = std::make_shared<Ts2HisMDGroup>();
   for (day_iterator iter(dateBegin); iter <= dateEnd; ++iter) {
     const auto date = to_iso_string(*iter);
 
+    const auto numOfLoaded =
+        ts2IndexWithFilenameGroup->size() + ts2HisMDGroupOfBin->size();
+    if (const auto binReader = OpenBinFileIfExists(pathPrefix, date);
+        binReader) {
+      const auto tsBegin = *iter == dateBegin ? ts : 0;
+      const auto statusCodeOfLoad = binReader->loadAfter(
+          indexType, tsBegin, num - numOfLoaded, *ts2HisMDGroupOfBin);
+      if (statusCodeOfLoad == 0) {
+        if (ts2IndexWithFilenameGroup->size() + ts2HisMDGroupOfBin->size() >=
+            num) {
+          break;
+        }
+        continue;
+      }
+    }
+
     const auto idxFilename =
         fmt::format("{}.{}.{}", date, HIS_MD_FILE_EXT,
                     indexType == IndexType::ByExchTs ? HIS_MD_INDEX_BY_ET_EXT
@@ -282,9 +345,12 @@ std::tuple<int, Ts2HisMDGroupSPtr> MDHis::LoadHisMDAfterTs(
       ts2IndexWithFilenameGroup->erase(std::begin(*ts2IndexWithFilenameGroup),
                                        iterLowerBound);
     }
-    if (ts2IndexWithFilenameGroup->size() >= num) {
+    if (ts2IndexWithFilenameGroup->size() + ts2HisMDGroupOfBin->size() >=
+        num) {
+      const auto offset = ts2IndexWithFilenameGroup->size() +
+                          ts2HisMDGroupOfBin->size() - num;
       ts2IndexWithFilenameGroup->erase(
-          std::next(std::begin(*ts2IndexWithFilenameGroup), num),
+          std::prev(std::end(*ts2IndexWithFilenameGroup), offset),
           std::end(*ts2IndexWithFilenameGroup));
       break;
     }
@@ -295,6 +361,7 @@ std::tuple<int, Ts2HisMDGroupSPtr> MDHis::LoadHisMDAfterTs(
   if (statusCode != 0) {
     return {statusCode, ts2HisMDGroup};
   }
+  ts2HisMDGroup->merge(*ts2HisMDGroupOfBin);
 
   if (ts2HisMDGroup->size() < num) {
     const auto statusMsg = fmt::format(
@@ -414,6 +481,23 @@ boost::filesystem::path MDHis::GetPathPrefixOfHisMD(const std::string& rootPath,
   return ret;
 }
 
+MDBinReaderSPtr MDHis::OpenBinFileIfExists(
+    const boost::filesystem::path& pathPrefix, const std::string& date) {
+  const auto pathOfBin =
+      pathPrefix / fmt::format("{}.{}", date, HIS_MD_BIN_FILE_EXT);
+  if (!boost::filesystem::exists(pathOfBin)) {
+    return nullptr;
+  }
+
+  auto binReader = std::make_shared<MDBinReader>(pathOfBin.string());
+  if (binReader->open() != 0) {
+    LOG_W("Open bin file {} failed, try to load his market data of text fmt.",
+          pathOfBin.string());
+    return nullptr;
+  }
+  return binReader;
+}
+
 std::tuple<int, std::vector<IndexSPtr>> MDHis::MakeIndexGroup(
     const std::string& filename, IndexType indexType) {
   std::vector<IndexSPtr> indexGroup;
@@ -12,6 +12,7 @@
 
 #include "def/BQConst.hpp"
 #include "def/Def.hpp"
+#include "util/LatencyTrace.hpp"
 
 namespace bq::md {
 
@@ -37,4 +38,10 @@ std::string GetSymbolCode(MarketCode marketCode,
   return ret;
 }
 
+void TraceMDPub(MDHeader& mdHeader, std::uint64_t tscOfRecv) {
+  mdHeader.tscOfRecv_ = tscOfRecv;
+  mdHeader.tscOfPub_ =
+      LatencyTrace::get_mutable_instance().stamp(TraceHop::MDPub, tscOfRecv);
+}
+
 }  // namespace bq::md
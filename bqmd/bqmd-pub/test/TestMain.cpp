@@ -15,6 +15,7 @@
 
 #include "def/BQConst.hpp"
 #include "def/Def.hpp"
+#include "util/BQMDBin.hpp"
 #include "util/BQMDHis.hpp"
 #include "util/BQMDUtil.hpp"
 #include "util/Logger.hpp"
@@ -694,6 +695,102 @@ TEST(test, testAfterByLT) {
   }
 }
 
+TEST(test, testBinFile) {
+  //! 测试数据中Candle只有exchTs，Trades只有localTs
+  const std::vector<std::tuple<std::string, IndexType>> topicGroup{
+      {"MD@Binance@Spot@BTC-USDT@Candle", IndexType::ByExchTs},
+      {"MD@Binance@Spot@BTC-USDT@Trades", IndexType::ByLocalTs}};
+
+  for (const auto& [topic, indexType] : topicGroup) {
+    const auto mdType = topic.substr(topic.rfind(SEP_OF_TOPIC) + 1);
+    for (const auto& date : {"20221125", "20221126", "20221127"}) {
+      EXPECT_TRUE(MDBin::ConvertTextFileToBinFile(
+                      fmt::format("testData/MD/Binance/Spot/BTC-USDT/{}/{}.{}",
+                                  mdType, date, HIS_MD_FILE_EXT),
+                      fmt::format("testDataOfBin/MD/Binance/Spot/BTC-USDT/{}/"
+                                  "{}.{}",
+                                  mdType, date, HIS_MD_BIN_FILE_EXT)) == 0);
+    }
+  }
+
+  auto isEqual = [](const auto& lhs, const auto& rhs) {
+    const auto& [statusCodeOfLhs, ts2HisMDGroupOfLhs] = lhs;
+    const auto& [statusCodeOfRhs, ts2HisMDGroupOfRhs] = rhs;
+    return statusCodeOfLhs == statusCodeOfRhs &&
+           *ts2HisMDGroupOfLhs == *ts2HisMDGroupOfRhs;
+  };
+
+  for (const auto& [topic, indexType] : topicGroup) {
+    EXPECT_TRUE(isEqual(
+        MDHis::LoadHisMDBetweenTs("testData", topic, 1669338658437000,
+                                  1669528718861000 + 1, indexType),
+        MDHis::LoadHisMDBetweenTs("testDataOfBin", topic, 1669338658437000,
+                                  1669528718861000 + 1, indexType)));
+    EXPECT_TRUE(isEqual(
+        MDHis::LoadHisMDBetweenTs("testData", topic, 1669338718861000,
+                                  1669458718861000, indexType),
+        MDHis::LoadHisMDBetweenTs("testDataOfBin", topic, 1669338718861000,
+                                  1669458718861000, indexType)));
+    for (std::uint32_t num = 1; num <= 10; ++num) {
+      EXPECT_TRUE(isEqual(
+          MDHis::LoadHisMDBeforeTs("testData", topic, 1669458718861000, num,
+                                   indexType),
+          MDHis::LoadHisMDBeforeTs("testDataOfBin", topic, 1669458718861000,
+                                   num, indexType)));
+      EXPECT_TRUE(isEqual(
+          MDHis::LoadHisMDAfterTs("testData", topic, 1669338718861000, num,
+                                  indexType),
+          MDHis::LoadHisMDAfterTs("testDataOfBin", topic, 1669338718861000,
+                                  num, indexType)));
+    }
+  }
+
+  //! 只追加写入，数据文件不会变小，追加的数据块的索引写入索引文件，
+  //! 可以查到新追加的行情
+  const auto filenameOfBin = fmt::format(
+      "testDataOfBin/MD/Binance/Spot/BTC-USDT/Trades/20221127.{}",
+      HIS_MD_BIN_FILE_EXT);
+  const auto filenameOfIdx =
+      MDBin::GetIndexFilenameByBinFilename(filenameOfBin);
+  const auto sizeOfBin = boost::filesystem::file_size(filenameOfBin);
+  const auto sizeOfIdx = boost::filesystem::file_size(filenameOfIdx);
+  EXPECT_TRUE(sizeOfIdx % sizeof(BinBlockIndex) == 0);
+  EXPECT_TRUE(
+      MDBin::AppendToFile(
+          filenameOfBin,
+          {R"({"mdHeader":{"exchTs":1669528800000000,"localTs":)"
+           R"(1669528800000001},"data":{"value":10}})"}) == 0);
+  EXPECT_TRUE(boost::filesystem::file_size(filenameOfBin) > sizeOfBin);
+  EXPECT_TRUE(boost::filesystem::file_size(filenameOfIdx) ==
+              sizeOfIdx + sizeof(BinBlockIndex));
+  const auto [statusCode, ts2HisMDGroup] =
+      MDHis::LoadHisMDAfterTs("testDataOfBin", "MD@Binance@Spot@BTC-USDT@Trades",
+                              1669528800000000, 1, IndexType::ByLocalTs);
+  EXPECT_TRUE(statusCode == 0 && ts2HisMDGroup->size() == 1 &&
+              std::begin(*ts2HisMDGroup)->first == 1669528800000001);
+
+  //! 不满一个数据块的行情留给调用方和之后的行情一起写入
+  std::vector<std::string> mdGroup(
+      MDBin::MAX_NUM_OF_REC_IN_BLOCK + 1,
+      R"({"mdHeader":{"exchTs":1669528900000000,"localTs":)"
+      R"(1669528900000001},"data":{"value":10}})");
+  EXPECT_TRUE(MDBin::AppendFullBlockToFile(filenameOfBin, mdGroup) == 0);
+  EXPECT_TRUE(mdGroup.size() == 1);
+  EXPECT_TRUE(boost::filesystem::file_size(filenameOfIdx) ==
+              sizeOfIdx + 2 * sizeof(BinBlockIndex));
+
+  //! 索引文件丢失之后遍历块头重建
+  boost::filesystem::remove(filenameOfIdx);
+  const auto [statusCodeOfRebuild, ts2HisMDGroupOfRebuild] =
+      MDHis::LoadHisMDAfterTs("testDataOfBin", "MD@Binance@Spot@BTC-USDT@Trades",
+                              1669528800000000, 1, IndexType::ByLocalTs);
+  EXPECT_TRUE(statusCodeOfRebuild == 0 &&
+              ts2HisMDGroupOfRebuild->size() == 1 &&
+              std::begin(*ts2HisMDGroupOfRebuild)->first == 1669528800000001);
+
+  boost::filesystem::remove_all("testDataOfBin");
+}
+
 TEST(test, testGetSymInfo) {
   EXPECT_TRUE(bq::md::GetSymbolCode(MarketCode::CZCE, "RM301") == "RM2301");
 }
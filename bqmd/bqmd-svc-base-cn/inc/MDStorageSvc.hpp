@@ -49,7 +49,7 @@ using Topic2AsyncTaskGroupSPtr = std::shared_ptr<Topic2AsyncTaskGroup>;
 class MDStorageSvc {
  public:
   explicit MDStorageSvc(MDSvcOfCN const* mdSvc);
-  ~MDStorageSvc() {}
+  ~MDStorageSvc();
 
  public:
   int init();
@@ -61,6 +61,9 @@ class MDStorageSvc {
  public:
   void dispatch(RawMDAsyncTaskSPtr& asyncTask);
 
+  //! 为了避免时间戳重复而调整的次数
+  std::string getStatisticOfSeqCheck() const;
+
  private:
   void handle(RawMDAsyncTaskSPtr& asyncTask);
 
@@ -89,9 +92,8 @@ class MDStorageSvc {
   Topic2AsyncTaskGroupSPtr topic2AsyncTaskGroup_{nullptr};
   mutable std::mutex mtxTopic2AsyncTaskGroup_;
 
-  Topic2LastTsGroupSPtr topic2LastExchTsGroup_{nullptr};
-  Topic2LastTsGroupSPtr topic2LastLocalTsGroup_{nullptr};
-  mutable std::mutex mtxTopic2LastTsGroup_;
+  //! 每个处理线程中各个topic最新的exchTs和localTs
+  TopicSeqStateTableUPtr topicSeqStateTable_{nullptr};
 
   TaskDispatcherSPtr<RawMDSPtr, BlockType::Block> taskDispatcher_{nullptr};
 };
@@ -31,6 +31,9 @@ using MarketDataCondGroup = std::vector<MarketDataCondSPtr>;
 
 class SymbolInfoTable;
 using SymbolInfoTableSPtr = std::shared_ptr<SymbolInfoTable>;
+
+class Scheduler;
+using SchedulerSPtr = std::shared_ptr<Scheduler>;
 }  // namespace bq
 
 namespace bq::db {
@@ -86,6 +89,7 @@ class MDSvcOfCN : public SvcBase {
   void initSHMSrvGroup();
 
   void initTopicMgr();
+  void initSchedulerOfStatistic();
   void handleTopicNeedSubAndUnSub(
       const std::tuple<TopicGroup, TopicGroup>& topicGroupNeedSubAndUnsub);
   virtual void doSub(const MarketDataCondGroup& marketDataCond) = 0;
@@ -124,6 +128,9 @@ class MDSvcOfCN : public SvcBase {
   SymbolInfoTableSPtr getSymbolInfoTable() const { return symbolInfoTable_; }
 
   SHMSrvSPtr getSHMSrv(MarketCode marketCode) const;
+  MarketCode2SHMSrvGroupSPtr getSHMSrvGroup() const {
+    return marketCode2SHMSrvGroup_;
+  }
 
   RawMDHandlerSPtr getRawMDHandler() const { return rawMDHandler_; }
   MDStorageSvcSPtr getMDStorageSvc() const { return mdStorageSvc_; }
@@ -148,6 +155,9 @@ class MDSvcOfCN : public SvcBase {
 
   TopicMgrSPtr topicMgr_{nullptr};
 
+  //! 定时输出行情时间戳乱序和重复的统计
+  SchedulerSPtr schedulerOfStatistic_{nullptr};
+
   MDCacheSPtr mdCache_{nullptr};
   MDPlaybackSPtr mdPlayback_{nullptr};
 
@@ -14,7 +14,7 @@
 
 namespace bq::md::svc {
 
-using Topic2LastTsGroup = std::map<std::string, std::uint64_t>;
-using Topic2LastTsGroupSPtr = std::shared_ptr<Topic2LastTsGroup>;
+class TopicSeqStateTable;
+using TopicSeqStateTableUPtr = std::unique_ptr<TopicSeqStateTable>;
 
 }  // namespace bq::md::svc
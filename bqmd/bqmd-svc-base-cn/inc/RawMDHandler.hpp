@@ -29,6 +29,8 @@ using AsyncTaskSPtr = std::shared_ptr<AsyncTask<Task>>;
 
 struct RawMD;
 using RawMDSPtr = std::shared_ptr<RawMD>;
+class RawMDPool;
+using RawMDPoolSPtr = std::shared_ptr<RawMDPool>;
 using RawMDAsyncTask = AsyncTask<RawMDSPtr>;
 using RawMDAsyncTaskSPtr = std::shared_ptr<RawMDAsyncTask>;
 
@@ -52,7 +54,7 @@ class RawMDHandler {
   RawMDHandler& operator=(const RawMDHandler&&) = delete;
 
   explicit RawMDHandler(MDSvcOfCN* mdSvc);
-  ~RawMDHandler() {}
+  ~RawMDHandler();
 
  public:
   int init();
@@ -61,10 +63,20 @@ class RawMDHandler {
   RawMDSPtr makeRawMD(MsgType msgType, const void* data, std::size_t dataLen,
                       bool isLast);
 
+  //! 时间戳乱序和重复的次数
+  std::string getStatisticOfSeqCheck() const;
+
+  //! RawMD对象池中每一级内存池的占用数和耗尽次数
+  std::string getStatisticOfRawMDPool() const;
+
  private:
   virtual std::tuple<int, RawMDAsyncTaskSPtr> makeAsyncTask(
       const RawMDSPtr& task) = 0;
 
+  //! api回调中原始行情结构体的大小，用于初始化RawMD对象池
+  virtual std::vector<std::size_t> getSizeGroupOfRawData() const { return {}; }
+  void initRawMDPool();
+
  public:
   void start();
   void stop();
@@ -92,11 +104,14 @@ class RawMDHandler {
  protected:
   MDSvcOfCN* mdSvc_{nullptr};
 
-  Topic2LastTsGroupSPtr topic2LastExchTsGroup_{nullptr};
-  mutable std::mutex mtxTopic2LastExchTsGroup_;
+  //! 每个处理线程中各个topic的最新时间戳
+  TopicSeqStateTableUPtr topicSeqStateTable_{nullptr};
 
   TaskDispatcherSPtr<RawMDSPtr, BlockType::Block> taskDispatcher_{nullptr};
 
+  //! 为空的时候RawMD和转换之后的行情都在堆上分配
+  RawMDPoolSPtr rawMDPool_{nullptr};
+
  private:
   bool saveBooks_{false};
   bool saveTrades_{false};
@@ -109,7 +124,6 @@ class RawMDHandler {
   bool checkIFExchTsOfMDIsInc_{true};
 
   std::size_t loggerThresholdOfTopicRecvTimes_{100};
-  std::map<std::string, std::uint64_t> topic2CntGroup_;
 };
 
 }  // namespace bq::md::svc
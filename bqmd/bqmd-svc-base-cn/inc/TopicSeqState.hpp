@@ -0,0 +1,80 @@
+/*!
+ * \file TopicSeqState.hpp
+ * \project BetterQuant
+ *
+ * \author byrnexu
+ * \date 2023/04/15
+ *
+ * \brief
+ */
+
+#pragma once
+
+#include "MDSvcOfCNDef.hpp"
+#include "SHMIPCDef.hpp"
+#include "util/Pch.hpp"
+
+namespace bq::md::svc {
+
+struct SeqStateOfTopic {
+  bool inited_{false};
+  std::uint64_t lastExchTs_{0};
+  std::uint64_t lastLocalTs_{0};
+  std::uint64_t recvTimes_{0};
+};
+
+//!
+//! 一个处理线程中所有topic的时间戳状态，只有所属线程读写，不加锁；
+//! 计数器由所属线程写入，其他线程只做统计读取。
+//!
+struct alignas(64) SeqStateOfThread {
+  //! 以topicId为下标，按需扩容
+  std::vector<SeqStateOfTopic> seqStateGroup_;
+  //! topic注册表满的时候topicId无效，退回按topicHash查找
+  ankerl::unordered_dense::map<TopicHash, SeqStateOfTopic> topicHash2SeqState_;
+
+  std::atomic<std::uint64_t> numOfOutOfOrder_{0};
+  std::atomic<std::uint64_t> numOfDup_{0};
+
+  SeqStateOfTopic& getSeqStateOfTopic(TopicId topicId, TopicHash topicHash);
+
+  void incNumOfOutOfOrder() {
+    numOfOutOfOrder_.store(
+        numOfOutOfOrder_.load(std::memory_order_relaxed) + 1,
+        std::memory_order_relaxed);
+  }
+  void incNumOfDup() {
+    numOfDup_.store(numOfDup_.load(std::memory_order_relaxed) + 1,
+                    std::memory_order_relaxed);
+  }
+};
+
+//!
+//! TaskDispatcher按topicHash将同一个topic的行情固定分给一个线程处理，因此
+//! 每个线程各自保存自己负责的topic的最新时间戳，检查乱序和重复的时候不需要锁，
+//! 也不需要按topic字符串查找std::map。
+//!
+//! 只能在TaskDispatcher的指定线程中调用getSeqStateOfCurThread。
+//!
+class TopicSeqStateTable {
+ public:
+  TopicSeqStateTable(const TopicSeqStateTable&) = delete;
+  TopicSeqStateTable& operator=(const TopicSeqStateTable&) = delete;
+  TopicSeqStateTable(const TopicSeqStateTable&&) = delete;
+  TopicSeqStateTable& operator=(const TopicSeqStateTable&&) = delete;
+
+  explicit TopicSeqStateTable(std::uint32_t numOfThread);
+
+ public:
+  SeqStateOfThread& getSeqStateOfCurThread();
+
+  std::uint64_t getNumOfOutOfOrder() const;
+  std::uint64_t getNumOfDup() const;
+
+  std::string getStatistic() const;
+
+ private:
+  std::vector<std::unique_ptr<SeqStateOfThread>> seqStateOfThreadGroup_;
+};
+
+}  // namespace bq::md::svc
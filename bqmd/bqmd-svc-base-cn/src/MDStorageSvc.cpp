@@ -16,6 +16,7 @@
 #include "SHMIPCMsgId.hpp"
 #include "SHMIPCUtil.hpp"
 #include "SHMSrv.hpp"
+#include "TopicSeqState.hpp"
 #include "def/BQConst.hpp"
 #include "def/BQDef.hpp"
 #include "def/DataStruOfMD.hpp"
@@ -36,9 +37,9 @@ namespace bq::md::svc {
 
 MDStorageSvc::MDStorageSvc(MDSvcOfCN const* mdSvc)
     : mdSvc_(mdSvc),
-      topic2AsyncTaskGroup_(std::make_shared<Topic2AsyncTaskGroup>()),
-      topic2LastExchTsGroup_(std::make_shared<Topic2LastTsGroup>()),
-      topic2LastLocalTsGroup_(std::make_shared<Topic2LastTsGroup>()) {}
+      topic2AsyncTaskGroup_(std::make_shared<Topic2AsyncTaskGroup>()) {}
+
+MDStorageSvc::~MDStorageSvc() {}
 
 int MDStorageSvc::init() {
   const auto mdStorageSvcParamInStrFmt =
@@ -51,6 +52,9 @@ int MDStorageSvc::init() {
     return ret;
   }
 
+  topicSeqStateTable_ = std::make_unique<TopicSeqStateTable>(
+      mdStorageSvcParam->taskSpecificThreadPoolSize_);
+
   const auto cbMsgParser = nullptr;
   taskDispatcher_ = std::make_shared<TaskDispatcher<RawMDSPtr>>(
       mdStorageSvcParam, cbMsgParser,
@@ -66,7 +70,15 @@ int MDStorageSvc::init() {
 }
 
 void MDStorageSvc::start() { taskDispatcher_->start(); }
-void MDStorageSvc::stop() { taskDispatcher_->stop(); }
+void MDStorageSvc::stop() {
+  taskDispatcher_->stop();
+  LOG_I("Statistic of ts adjustment. {}", getStatisticOfSeqCheck());
+}
+
+std::string MDStorageSvc::getStatisticOfSeqCheck() const {
+  if (topicSeqStateTable_ == nullptr) return "";
+  return topicSeqStateTable_->getStatistic();
+}
 
 void MDStorageSvc::dispatch(RawMDAsyncTaskSPtr& asyncTask) {
   taskDispatcher_->dispatch(asyncTask);
@@ -144,46 +156,39 @@ void MDStorageSvc::handleMDBooks(RawMDAsyncTaskSPtr& asyncTask) {
   flushMDToTDEng(topic2AsyncTaskGroupWrittenToTDEng);
 }
 
-//! 数据库中时间戳不能重复，因此如果重复的话，增加1us
+//! 数据库中时间戳不能重复，因此如果重复的话，增加1us；
+//! 同一个topic只在一个线程中处理，按线程保存的时间戳不需要加锁
 void MDStorageSvc::checkAndUpdateTsToAvoidDulplication(
     RawMDAsyncTaskSPtr& asyncTask, MDHeader* mdHeader) {
-  const auto topic = asyncTask->task_->topic_;
-  {
-    std::lock_guard<std::mutex> guard(mtxTopic2LastTsGroup_);
-    auto iterExchTs = topic2LastExchTsGroup_->find(topic);
-    if (iterExchTs != std::end(*topic2LastExchTsGroup_)) {
-      auto& exchTsInCache = iterExchTs->second;
-      if (exchTsInCache >= mdHeader->exchTs_) {
-        //! 来了一个更加早的消息
-        LOG_T("Found exchTs in cache {} greater than exchTs of topic {}.",
-              exchTsInCache, topic);
-        exchTsInCache += 1;
-        mdHeader->exchTs_ = exchTsInCache;
-      } else {
-        //! 来了一个更加新的消息
-        exchTsInCache = mdHeader->exchTs_;
-      }
-    } else {
-      (*topic2LastExchTsGroup_)[topic] = mdHeader->exchTs_;
-    }
+  const auto& rawMD = asyncTask->task_;
+  auto& seqStateOfThread = topicSeqStateTable_->getSeqStateOfCurThread();
+  auto& seqState =
+      seqStateOfThread.getSeqStateOfTopic(rawMD->topicId_, rawMD->topicHash_);
+  if (!seqState.inited_) {
+    seqState.inited_ = true;
+    seqState.lastExchTs_ = mdHeader->exchTs_;
+    seqState.lastLocalTs_ = mdHeader->localTs_;
+    return;
+  }
 
-    auto iterLocalTs = topic2LastLocalTsGroup_->find(topic);
-    if (iterLocalTs != std::end(*topic2LastLocalTsGroup_)) {
-      auto& localTsInCache = iterLocalTs->second;
-      if (localTsInCache >= mdHeader->localTs_) {
-        //! 来了一个更加早的消息
-        LOG_W("Found localTs in cache {} greater than localTs of topic {}.",
-              localTsInCache, topic);
-        localTsInCache += 1;
-        mdHeader->localTs_ = localTsInCache;
-      } else {
-        //! 来了一个更加新的消息
-        localTsInCache = mdHeader->localTs_;
-      }
+  const auto updateTs = [&](std::uint64_t& tsInCache, std::uint64_t& ts) {
+    if (tsInCache < ts) {
+      //! 来了一个更加新的消息
+      tsInCache = ts;
+      return;
+    }
+    //! 来了一个重复或者更加早的消息
+    if (tsInCache == ts) {
+      seqStateOfThread.incNumOfDup();
     } else {
-      (*topic2LastLocalTsGroup_)[topic] = mdHeader->localTs_;
+      seqStateOfThread.incNumOfOutOfOrder();
     }
-  }
+    tsInCache += 1;
+    ts = tsInCache;
+  };
+
+  updateTs(seqState.lastExchTs_, mdHeader->exchTs_);
+  updateTs(seqState.lastLocalTs_, mdHeader->localTs_);
 }
 
 Topic2AsyncTaskGroupSPtr MDStorageSvc::getTopic2AsyncTaskGroupWrittenToTDEng(
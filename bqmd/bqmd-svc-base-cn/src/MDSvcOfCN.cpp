@@ -25,8 +25,10 @@
 #include "tdeng/TDEngConnpool.hpp"
 #include "tdeng/TDEngConst.hpp"
 #include "tdeng/TDEngParam.hpp"
+#include "util/LatencyTrace.hpp"
 #include "util/Logger.hpp"
 #include "util/MarketDataCond.hpp"
+#include "util/Scheduler.hpp"
 #include "util/String.hpp"
 #include "util/SysParams.hpp"
 #include "util/TopicMgr.hpp"
@@ -56,6 +58,11 @@ int MDSvcOfCN::prepareInit() {
   //! 时序数据库中记录行情来自哪个api
   apiName_ = CONFIG["api"]["apiName"].as<std::string>();
 
+  //! 时延追踪默认关闭，开启后向进程发送SIGUSR1输出各环节的时延分布
+  if (CONFIG["enableLatencyTrace"].as<bool>(false)) {
+    LatencyTrace::get_mutable_instance().enable();
+  }
+
   return 0;
 }
 
@@ -101,6 +108,8 @@ int MDSvcOfCN::doInit() {
   //! topic订阅管理器
   initTopicMgr();
 
+  initSchedulerOfStatistic();
+
   return 0;
 }
 
@@ -187,6 +196,22 @@ void MDSvcOfCN::initTopicMgr() {
   }
 }
 
+void MDSvcOfCN::initSchedulerOfStatistic() {
+  const auto milliSecIntervalOfStatistic =
+      CONFIG["milliSecIntervalOfStatistic"].as<std::uint32_t>(60000);
+  schedulerOfStatistic_ = std::make_shared<Scheduler>(
+      "STATISTIC",
+      [this]() {
+        LOG_I("Statistic of exch ts check. {}",
+              rawMDHandler_->getStatisticOfSeqCheck());
+        if (mdStorageSvc_) {
+          LOG_I("Statistic of ts adjustment. {}",
+                mdStorageSvc_->getStatisticOfSeqCheck());
+        }
+      },
+      milliSecIntervalOfStatistic);
+}
+
 void MDSvcOfCN::handleTopicNeedSubAndUnSub(
     const std::tuple<TopicGroup, TopicGroup>& topicGroupNeedSubAndUnsub) {
   //! 如果已经开启了全市场订阅，那么无需处理来自客户端的个股订阅请求
@@ -291,6 +316,11 @@ int MDSvcOfCN::afterRun() {
   //! 因为topicMgr_要用到gateway的订阅和取消订阅，所以必须等doRun中的gateway就绪
   topicMgr_->start();
 
+  if (const auto ret = schedulerOfStatistic_->start(); ret != 0) {
+    LOG_E("Start scheduler of statistic failed.");
+    return ret;
+  }
+
   return SvcBase::afterRun();
 }
 
@@ -308,6 +338,7 @@ void MDSvcOfCN::stopGatewayOfSim() {
 }
 
 void MDSvcOfCN::doExit(const boost::system::error_code* ec, int signalNum) {
+  schedulerOfStatistic_->stop();
   topicMgr_->stop();
 
   for (const auto marketCode2SHMSrv : *marketCode2SHMSrvGroup_) {
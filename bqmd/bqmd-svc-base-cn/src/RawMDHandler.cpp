@@ -18,6 +18,7 @@
 #include "SHMIPCMsgId.hpp"
 #include "SHMIPCUtil.hpp"
 #include "SHMSrv.hpp"
+#include "TopicSeqState.hpp"
 #include "db/TBLRecSetMaker.hpp"
 #include "db/TBLSymbolInfo.hpp"
 #include "def/BQConst.hpp"
@@ -32,6 +33,7 @@
 #include "util/FlowCtrlSvc.hpp"
 #include "util/Literal.hpp"
 #include "util/MarketDataCond.hpp"
+#include "util/RawMDPool.hpp"
 #include "util/String.hpp"
 #include "util/TaskDispatcher.hpp"
 
@@ -39,7 +41,6 @@ namespace bq::md::svc {
 
 RawMDHandler::RawMDHandler(MDSvcOfCN* mdSvc)
     : mdSvc_(mdSvc),
-      topic2LastExchTsGroup_(std::make_shared<Topic2LastTsGroup>()),
       saveBooks_(CONFIG["saveBooks"].as<bool>(false)),
       saveTrades_(CONFIG["saveTrades"].as<bool>(false)),
       saveOrders_(CONFIG["saveOrders"].as<bool>(false)),
@@ -50,6 +51,8 @@ RawMDHandler::RawMDHandler(MDSvcOfCN* mdSvc)
       loggerThresholdOfTopicRecvTimes_(
           CONFIG["loggerThresholdOfTopicRecvTimes"].as<std::size_t>(100)) {}
 
+RawMDHandler::~RawMDHandler() {}
+
 int RawMDHandler::init() {
   const auto rawMDHandlerParamInStrFmt =
       SetParam(DEFAULT_TASK_DISPATCHER_PARAM,
@@ -61,6 +64,10 @@ int RawMDHandler::init() {
     return ret;
   }
 
+  //! 同一个topic的行情固定在一个线程中处理，时间戳检查按线程保存状态
+  topicSeqStateTable_ = std::make_unique<TopicSeqStateTable>(
+      rawMDHandlerParam->taskSpecificThreadPoolSize_);
+
   taskDispatcher_ = std::make_shared<TaskDispatcher<RawMDSPtr>>(
       rawMDHandlerParam,
 
@@ -78,14 +85,6 @@ int RawMDHandler::init() {
         //! 计算rawMD也就是asyncTask->task_的topic和topicHash
         InitTopicInfo(asyncTask->task_);
 
-#ifndef _NDEBUG
-        const auto& topic = asyncTask->task_->topic_;
-        LOG_T("Init task of topic {}", topic);
-        topic2CntGroup_[topic] += 1;
-        if (topic2CntGroup_[topic] % loggerThresholdOfTopicRecvTimes_ == 0) {
-          LOG_I("Recv {} {} times", topic, topic2CntGroup_[topic]);
-        }
-#endif
         const std::uint32_t threadNo =
             asyncTask->task_->topicHash_ % taskSpecificThreadPoolSize;
 
@@ -96,31 +95,50 @@ int RawMDHandler::init() {
 
   taskDispatcher_->init();
 
+  initRawMDPool();
+
   return ret;
 }
 
+void RawMDHandler::initRawMDPool() {
+  //! 每一级内存块的数量 = 订阅的品种数 * 每个品种预留的块数，品种数为0的时候
+  //! 不使用对象池，没有用到的内存块不会占用物理内存
+  const auto numOfSymbol =
+      CONFIG["rawMDPool"]["numOfSymbol"].as<std::size_t>(0);
+  const auto numOfBlockPerSymbol =
+      CONFIG["rawMDPool"]["numOfBlockPerSymbol"].as<std::size_t>(4);
+  const auto numOfBlock = numOfSymbol * numOfBlockPerSymbol;
+  if (numOfBlock == 0) {
+    LOG_I("Init raw md pool skipped because of num of block is 0.");
+    return;
+  }
+
+  auto sizeGroupOfData = getSizeGroupOfRawData();
+  sizeGroupOfData.emplace_back(sizeof(Tickers));
+  sizeGroupOfData.emplace_back(sizeof(Trades));
+  sizeGroupOfData.emplace_back(sizeof(Orders));
+  sizeGroupOfData.emplace_back(sizeof(Books));
+  rawMDPool_ = std::make_shared<RawMDPool>(numOfBlock, sizeGroupOfData);
+  LOG_I("Init raw md pool success. [numOfSymbol = {}; numOfBlock = {}]",
+        numOfSymbol, numOfBlock);
+}
+
 RawMDSPtr RawMDHandler::makeRawMD(MsgType msgType, const void* data,
                                   std::size_t dataLen, bool isLast) {
   switch (msgType) {
     case MsgType::NewSymbol:
+      //! 代码表只在启动的时候推送，不占用对象池
       return std::make_shared<RawMD>(  //
           MsgType::NewSymbol, data, dataLen, isLast);
 
     case MsgType::Tickers:
-      return std::make_shared<RawMD>(  //
-          MsgType::Tickers, data, dataLen, isLast);
-
     case MsgType::Trades:
-      return std::make_shared<RawMD>(  //
-          MsgType::Trades, data, dataLen, isLast);
-
     case MsgType::Orders:
-      return std::make_shared<RawMD>(  //
-          MsgType::Orders, data, dataLen, isLast);
-
     case MsgType::Books:
-      return std::make_shared<RawMD>(  //
-          MsgType::Books, data, dataLen, isLast);
+      if (rawMDPool_ != nullptr) {
+        return rawMDPool_->makeRawMD(msgType, data, dataLen, isLast);
+      }
+      return std::make_shared<RawMD>(msgType, data, dataLen, isLast);
 
     default:
       return nullptr;
@@ -129,14 +147,49 @@ RawMDSPtr RawMDHandler::makeRawMD(MsgType msgType, const void* data,
   return nullptr;
 }
 
+std::string RawMDHandler::getStatisticOfSeqCheck() const {
+  if (topicSeqStateTable_ == nullptr) return "";
+  return topicSeqStateTable_->getStatistic();
+}
+
+std::string RawMDHandler::getStatisticOfRawMDPool() const {
+  if (rawMDPool_ == nullptr) return "";
+  return rawMDPool_->getStatistic();
+}
+
 void RawMDHandler::start() { taskDispatcher_->start(); }
-void RawMDHandler::stop() { taskDispatcher_->stop(); }
+
+void RawMDHandler::stop() {
+  taskDispatcher_->stop();
+  LOG_I("Statistic of exch ts check. {}", getStatisticOfSeqCheck());
+  if (rawMDPool_ != nullptr) {
+    if (rawMDPool_->getNumOfExhausted() != 0) {
+      LOG_W("Raw md pool has been exhausted, consider enlarging it. {}",
+            rawMDPool_->getStatistic());
+    } else {
+      LOG_I("Statistic of raw md pool. {}", rawMDPool_->getStatistic());
+    }
+  }
+}
 
 void RawMDHandler::dispatch(RawMDSPtr& task) {
   taskDispatcher_->dispatch(task);
 }
 
 void RawMDHandler::handle(RawMDAsyncTaskSPtr& asyncTask) {
+#ifndef NDEBUG
+  if (asyncTask->task_->msgType_ != MsgType::NewSymbol) {
+    const auto& rawMD = asyncTask->task_;
+    auto& seqState =
+        topicSeqStateTable_->getSeqStateOfCurThread().getSeqStateOfTopic(
+            rawMD->topicId_, rawMD->topicHash_);
+    seqState.recvTimes_ += 1;
+    if (seqState.recvTimes_ % loggerThresholdOfTopicRecvTimes_ == 0) {
+      LOG_I("Recv {} {} times", rawMD->topic_, seqState.recvTimes_);
+    }
+  }
+#endif
+
   switch (asyncTask->task_->msgType_) {
     case MsgType::NewSymbol:
       handleNewSymbol(asyncTask);
@@ -201,18 +254,14 @@ void RawMDHandler::handleMDBid1Ask1ByTickers(RawMDAsyncTaskSPtr& asyncTask) {
     }
   }
 
-  const auto marketName = GetMarketName(rawMD->marketCode_);
-  const auto topic =
-      fmt::format("{}{}{}{}{}{}{}{}{}", TOPIC_PREFIX_OF_MARKET_DATA,        //
-                  SEP_OF_TOPIC, marketName,                                 //
-                  SEP_OF_TOPIC, magic_enum::enum_name(rawMD->symbolType_),  //
-                  SEP_OF_TOPIC, rawMD->symbolCode_,                         //
-                  SEP_OF_TOPIC, magic_enum::enum_name(MDType::Bid1Ask1));   //
+  const auto [topicHash, topicId] =
+      GetTopicInfoOfMDType(rawMD, MDType::Bid1Ask1);
 
   const auto tickers = static_cast<Tickers*>(asyncTask->task_->dataAfterConv_);
 
   auto bid1Ask1 = std::make_unique<Bid1Ask1>();
-  bid1Ask1->shmHeader_.topicHash_ = XXH3_64bits(topic.data(), topic.size());
+  bid1Ask1->shmHeader_.topicHash_ = topicHash;
+  bid1Ask1->shmHeader_.topicId_ = topicId;
   memcpy(&bid1Ask1->mdHeader_, &tickers->mdHeader_, sizeof(MDHeader));
   bid1Ask1->mdHeader_.mdType_ = MDType::Bid1Ask1;
   bid1Ask1->askPrice_ = tickers->askPrice_;
@@ -224,7 +273,7 @@ void RawMDHandler::handleMDBid1Ask1ByTickers(RawMDAsyncTaskSPtr& asyncTask) {
   // push msg
   const auto shmSrv = mdSvc_->getSHMSrv(bid1Ask1->mdHeader_.marketCode_);
   if (!shmSrv) {
-    LOG_W("Invalid market code {}.", marketName);
+    LOG_W("Invalid market code {}.", GetMarketName(rawMD->marketCode_));
     return;
   }
   shmSrv->pushMsg(PUB_CHANNEL, MSG_ID_ON_MD_BID1_ASK1, bid1Ask1.get(),
@@ -245,18 +294,14 @@ void RawMDHandler::handleMDLastPriceByTickers(RawMDAsyncTaskSPtr& asyncTask) {
     }
   }
 
-  const auto marketName = GetMarketName(rawMD->marketCode_);
-  const auto topic =
-      fmt::format("{}{}{}{}{}{}{}{}{}", TOPIC_PREFIX_OF_MARKET_DATA,        //
-                  SEP_OF_TOPIC, marketName,                                 //
-                  SEP_OF_TOPIC, magic_enum::enum_name(rawMD->symbolType_),  //
-                  SEP_OF_TOPIC, rawMD->symbolCode_,                         //
-                  SEP_OF_TOPIC, magic_enum::enum_name(MDType::LastPrice));  //
+  const auto [topicHash, topicId] =
+      GetTopicInfoOfMDType(rawMD, MDType::LastPrice);
 
   const auto tickers = static_cast<Tickers*>(asyncTask->task_->dataAfterConv_);
 
   auto lastPrice = std::make_unique<LastPrice>();
-  lastPrice->shmHeader_.topicHash_ = XXH3_64bits(topic.data(), topic.size());
+  lastPrice->shmHeader_.topicHash_ = topicHash;
+  lastPrice->shmHeader_.topicId_ = topicId;
   memcpy(&lastPrice->mdHeader_, &tickers->mdHeader_, sizeof(MDHeader));
   lastPrice->mdHeader_.mdType_ = MDType::LastPrice;
   lastPrice->lastPrice_ = tickers->lastPrice_;
@@ -266,7 +311,7 @@ void RawMDHandler::handleMDLastPriceByTickers(RawMDAsyncTaskSPtr& asyncTask) {
   // push msg
   const auto shmSrv = mdSvc_->getSHMSrv(lastPrice->mdHeader_.marketCode_);
   if (!shmSrv) {
-    LOG_W("Invalid market code {}.", marketName);
+    LOG_W("Invalid market code {}.", GetMarketName(rawMD->marketCode_));
     return;
   }
   shmSrv->pushMsg(PUB_CHANNEL, MSG_ID_ON_MD_LAST_PRICE, lastPrice.get(),
@@ -287,18 +332,14 @@ void RawMDHandler::handleMDBid1Ask1ByBooks(RawMDAsyncTaskSPtr& asyncTask) {
     }
   }
 
-  const auto marketName = GetMarketName(rawMD->marketCode_);
-  const auto topic =
-      fmt::format("{}{}{}{}{}{}{}{}{}", TOPIC_PREFIX_OF_MARKET_DATA,        //
-                  SEP_OF_TOPIC, marketName,                                 //
-                  SEP_OF_TOPIC, magic_enum::enum_name(rawMD->symbolType_),  //
-                  SEP_OF_TOPIC, rawMD->symbolCode_,                         //
-                  SEP_OF_TOPIC, magic_enum::enum_name(MDType::Bid1Ask1));   //
+  const auto [topicHash, topicId] =
+      GetTopicInfoOfMDType(rawMD, MDType::Bid1Ask1);
 
   const auto books = static_cast<Books*>(asyncTask->task_->dataAfterConv_);
 
   auto bid1Ask1 = std::make_unique<Bid1Ask1>();
-  bid1Ask1->shmHeader_.topicHash_ = XXH3_64bits(topic.data(), topic.size());
+  bid1Ask1->shmHeader_.topicHash_ = topicHash;
+  bid1Ask1->shmHeader_.topicId_ = topicId;
   memcpy(&bid1Ask1->mdHeader_, &books->mdHeader_, sizeof(MDHeader));
   bid1Ask1->mdHeader_.mdType_ = MDType::Bid1Ask1;
   bid1Ask1->askPrice_ = books->asks_[0].price_;
@@ -310,7 +351,7 @@ void RawMDHandler::handleMDBid1Ask1ByBooks(RawMDAsyncTaskSPtr& asyncTask) {
   // push msg
   const auto shmSrv = mdSvc_->getSHMSrv(bid1Ask1->mdHeader_.marketCode_);
   if (!shmSrv) {
-    LOG_W("Invalid market code {}.", marketName);
+    LOG_W("Invalid market code {}.", GetMarketName(rawMD->marketCode_));
     return;
   }
   shmSrv->pushMsg(PUB_CHANNEL, MSG_ID_ON_MD_BID1_ASK1, bid1Ask1.get(),
@@ -331,18 +372,14 @@ void RawMDHandler::handleMDLastPriceByTrades(RawMDAsyncTaskSPtr& asyncTask) {
     }
   }
 
-  const auto marketName = GetMarketName(rawMD->marketCode_);
-  const auto topic =
-      fmt::format("{}{}{}{}{}{}{}{}{}", TOPIC_PREFIX_OF_MARKET_DATA,        //
-                  SEP_OF_TOPIC, marketName,                                 //
-                  SEP_OF_TOPIC, magic_enum::enum_name(rawMD->symbolType_),  //
-                  SEP_OF_TOPIC, rawMD->symbolCode_,                         //
-                  SEP_OF_TOPIC, magic_enum::enum_name(MDType::LastPrice));  //
+  const auto [topicHash, topicId] =
+      GetTopicInfoOfMDType(rawMD, MDType::LastPrice);
 
   const auto trades = static_cast<Trades*>(asyncTask->task_->dataAfterConv_);
 
   auto lastPrice = std::make_unique<LastPrice>();
-  lastPrice->shmHeader_.topicHash_ = XXH3_64bits(topic.data(), topic.size());
+  lastPrice->shmHeader_.topicHash_ = topicHash;
+  lastPrice->shmHeader_.topicId_ = topicId;
   memcpy(&lastPrice->mdHeader_, &trades->mdHeader_, sizeof(MDHeader));
   lastPrice->mdHeader_.mdType_ = MDType::LastPrice;
   lastPrice->lastPrice_ = trades->price_;
@@ -352,38 +389,41 @@ void RawMDHandler::handleMDLastPriceByTrades(RawMDAsyncTaskSPtr& asyncTask) {
   // push msg
   const auto shmSrv = mdSvc_->getSHMSrv(lastPrice->mdHeader_.marketCode_);
   if (!shmSrv) {
-    LOG_W("Invalid market code {}.", marketName);
+    LOG_W("Invalid market code {}.", GetMarketName(rawMD->marketCode_));
     return;
   }
   shmSrv->pushMsg(PUB_CHANNEL, MSG_ID_ON_MD_LAST_PRICE, lastPrice.get(),
                   sizeof(LastPrice));
 }
 
-//! 用于检查行情中的时间戳是否乱序，有一定的性能开销，生产环境中可以考虑关闭检测
+//! 用于检查行情中的时间戳是否乱序，同一个topic只在一个线程中处理，不需要加锁，
+//! 乱序和重复的次数通过getStatisticOfSeqCheck查询
 bool RawMDHandler::checkIfMDIsLegal(RawMDAsyncTaskSPtr& asyncTask,
                                     std::uint64_t exchTs) {
   if (!checkIFExchTsOfMDIsInc_) return true;
-  const auto& topic = asyncTask->task_->topic_;
-  {
-    std::lock_guard<std::mutex> guard(mtxTopic2LastExchTsGroup_);
-    auto iter = topic2LastExchTsGroup_->find(topic);
-    if (iter == std::end(*topic2LastExchTsGroup_)) {
-      (*topic2LastExchTsGroup_)[topic] = exchTs;
-      return true;
-    } else {
-      auto& exchTsInCache = iter->second;
-      //! 如果cache中的exchTs小于等于当前行情中的exchTs那么说明没有乱续
-      if (exchTsInCache <= exchTs) {
-        exchTsInCache = exchTs;
-        return true;
-      } else {
-        LOG_W("Found exchTs in cache {} greater than exchTs {}. {}",
-              exchTsInCache, exchTs, topic);
-        return false;
-      }
-    }
+  const auto& rawMD = asyncTask->task_;
+  auto& seqStateOfThread = topicSeqStateTable_->getSeqStateOfCurThread();
+  auto& seqState =
+      seqStateOfThread.getSeqStateOfTopic(rawMD->topicId_, rawMD->topicHash_);
+  if (!seqState.inited_) {
+    seqState.inited_ = true;
+    seqState.lastExchTs_ = exchTs;
+    return true;
+  }
+
+  //! 如果cache中的exchTs小于等于当前行情中的exchTs那么说明没有乱续
+  if (seqState.lastExchTs_ < exchTs) {
+    seqState.lastExchTs_ = exchTs;
+    return true;
+  } else if (seqState.lastExchTs_ == exchTs) {
+    seqStateOfThread.incNumOfDup();
+    return true;
+  } else {
+    seqStateOfThread.incNumOfOutOfOrder();
+    LOG_T("Found exchTs in cache {} greater than exchTs {}. {}",
+          seqState.lastExchTs_, exchTs, rawMD->topic_);
+    return false;
   }
-  return true;
 }
 
 }  // namespace bq::md::svc
@@ -49,6 +49,13 @@ void SHMSrvMsgHandler::handleSyncSubInfo(const void* shmBuf,
   const auto commonIPCData = static_cast<const CommonIPCData*>(shmBuf);
   const auto subscriber2TopicGroupInJsonFmt = std::string(commonIPCData->data_);
   mdSvc_->getTopicMgr()->updateForSrv(subscriber2TopicGroupInJsonFmt);
+
+  //! 使用独立频道的客户端，同步更新各个SHMSrv的过滤器
+  std::vector<SHMSrvSPtr> shmSrvGroup;
+  for (const auto& rec : *mdSvc_->getSHMSrvGroup()) {
+    shmSrvGroup.emplace_back(rec.second);
+  }
+  UpdateTopicFilterBySyncSubInfo(shmBuf, shmSrvGroup);
 }
 
 }  // namespace bq::md::svc
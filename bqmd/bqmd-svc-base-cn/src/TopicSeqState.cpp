@@ -0,0 +1,64 @@
+/*!
+ * \file TopicSeqState.cpp
+ * \project BetterQuant
+ *
+ * \author byrnexu
+ * \date 2023/04/15
+ *
+ * \brief
+ */
+
+#include "TopicSeqState.hpp"
+
+#include "SHMIPCConst.hpp"
+#include "util/TaskDispatcher.hpp"
+
+namespace bq::md::svc {
+
+SeqStateOfTopic& SeqStateOfThread::getSeqStateOfTopic(TopicId topicId,
+                                                      TopicHash topicHash) {
+  if (topicId == INVALID_TOPIC_ID) {
+    return topicHash2SeqState_[topicHash];
+  }
+  if (topicId >= seqStateGroup_.size()) {
+    //! 每次至少扩容一倍，避免新topic陆续出现的时候频繁搬移
+    seqStateGroup_.resize(
+        std::max<std::size_t>(topicId + 1, seqStateGroup_.size() * 2));
+  }
+  return seqStateGroup_[topicId];
+}
+
+TopicSeqStateTable::TopicSeqStateTable(std::uint32_t numOfThread) {
+  for (std::uint32_t i = 0; i < std::max<std::uint32_t>(1, numOfThread); ++i) {
+    seqStateOfThreadGroup_.emplace_back(std::make_unique<SeqStateOfThread>());
+  }
+}
+
+SeqStateOfThread& TopicSeqStateTable::getSeqStateOfCurThread() {
+  const auto threadNo = std::ext::tls_get<ThreadInfo>().no_;
+  assert(threadNo != RAND_THREAD && "threadNo != RAND_THREAD");
+  return *seqStateOfThreadGroup_[threadNo % seqStateOfThreadGroup_.size()];
+}
+
+std::uint64_t TopicSeqStateTable::getNumOfOutOfOrder() const {
+  std::uint64_t ret = 0;
+  for (const auto& seqStateOfThread : seqStateOfThreadGroup_) {
+    ret += seqStateOfThread->numOfOutOfOrder_.load(std::memory_order_relaxed);
+  }
+  return ret;
+}
+
+std::uint64_t TopicSeqStateTable::getNumOfDup() const {
+  std::uint64_t ret = 0;
+  for (const auto& seqStateOfThread : seqStateOfThreadGroup_) {
+    ret += seqStateOfThread->numOfDup_.load(std::memory_order_relaxed);
+  }
+  return ret;
+}
+
+std::string TopicSeqStateTable::getStatistic() const {
+  return fmt::format("[numOfOutOfOrder = {}; numOfDup = {}]",
+                     getNumOfOutOfOrder(), getNumOfDup());
+}
+
+}  // namespace bq::md::svc
@@ -84,6 +84,8 @@ class MDStorageSvc {
   TaskDispatcherSPtr<web::TaskFromSrvSPtr, BlockType::Block> taskDispatcher_{nullptr};
 
   Filename2MDGroupSPtr filename2MDGroup_;
+  //! 统一格式的历史行情保存为二进制格式，原始格式的行情仍然保存为文本
+  bool saveHisMDInBinFmt_{false};
   std::map<std::string, WSCliAsyncTaskArgSPtr> candleTopic2CandleData_;
 };
 
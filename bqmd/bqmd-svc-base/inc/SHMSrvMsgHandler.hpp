@@ -28,9 +28,11 @@ class SHMSrvMsgHandler {
   SHMSrvMsgHandler& operator=(const SHMSrvMsgHandler&&) = delete;
   SHMSrvMsgHandler(MDSvc* mdSvc) : mdSvc_(mdSvc) {}
 
-  void handleReq(const void* shmBuf, std::size_t shmBufLen) {
-    doHandleReq(shmBuf, shmBufLen);
-  }
+  void handleReq(const void* shmBuf, std::size_t shmBufLen);
+
+ private:
+  void handleSyncSubInfo(const void* shmBuf, std::size_t shmBufLen);
+  void handleBooksSnapshotReq(const void* shmBuf, std::size_t shmBufLen);
 
  private:
   virtual void doHandleReq(const void* shmBuf, std::size_t shmBufLen) {}
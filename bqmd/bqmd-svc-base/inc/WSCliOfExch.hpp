@@ -87,6 +87,10 @@ class WSCliOfExch {
     return taskDispatcher_;
   }
 
+  //! 接收端请求立即发送该品种订单簿的全量刷新，只有推送增量订单簿的行情服务
+  //! 需要实现，在SHMSrv的接收线程中调用
+  virtual void reqFullRefreshOfBooks(const std::string& symbolCode) {}
+
  protected:
   MDSvc* mdSvc_;
 
@@ -20,6 +20,7 @@
 #include "def/BQConst.hpp"
 #include "def/BQDef.hpp"
 #include "def/MDWSCliAsyncTaskArg.hpp"
+#include "util/BQMDBin.hpp"
 #include "util/BQMDUtil.hpp"
 #include "util/Datetime.hpp"
 #include "util/File.hpp"
@@ -45,6 +46,8 @@ int MDStorageSvc::init() {
     return ret;
   }
 
+  saveHisMDInBinFmt_ = CONFIG["saveHisMDInBinFmt"].as<bool>(false);
+
   taskDispatcher_ = std::make_shared<TaskDispatcher<web::TaskFromSrvSPtr>>(
       mdStorageSvcParam, nullptr,
       [](auto& asyncTask, auto taskSpecificThreadPoolSize) {
@@ -147,8 +150,9 @@ void MDStorageSvc::cacheMDOfUnifiedFmt(
   }
 
   const auto exchDate = GetDateInStrFmtFromTs(arg->exchTs_);
-  const auto fileNameOfMDOfUnifiedFmt =
-      fmt::format("{}.{}", exchDate, HIS_MD_FILE_EXT);
+  const auto fileNameOfMDOfUnifiedFmt = fmt::format(
+      "{}.{}", exchDate,
+      saveHisMDInBinFmt_ ? HIS_MD_BIN_FILE_EXT : HIS_MD_FILE_EXT);
 
   if (marketDataCond->mdType_ != MDType::Candle) {
     const auto pathOfMD = storagePath / fileNameOfMDOfUnifiedFmt;
@@ -259,6 +263,16 @@ void MDStorageSvc::flushMDInCacheToDisk() {
   for (auto& rec : *filename2MDGroup) {
     if (rec.second.empty()) continue;
     const auto fileName = rec.first;
+    //! 每一轮都把所有行情写入，最后一个数据块可能不满，这样进程崩溃的时候
+    //! 不会丢失行情，另一个进程中的查询服务也能立即读到这些行情
+    if (boost::algorithm::ends_with(fileName, HIS_MD_BIN_FILE_EXT)) {
+      LOG_D(
+          "Flush market data in cache to disk. "
+          "[fileName = {}, row num = {}]",
+          fileName, rec.second.size());
+      MDBin::AppendToFile(fileName, rec.second);
+      continue;
+    }
     const auto fileCont = boost::join(rec.second, "");
     LOG_D(
         "Flush market data in cache to disk. "
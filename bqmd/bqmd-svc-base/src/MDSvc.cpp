@@ -25,6 +25,7 @@
 #include "db/TBLMonitorOfSymbolInfo.hpp"
 #include "def/Const.hpp"
 #include "util/FlowCtrlSvc.hpp"
+#include "util/LatencyTrace.hpp"
 #include "util/Literal.hpp"
 #include "util/String.hpp"
 
@@ -45,6 +46,11 @@ int MDSvc::prepareInit() {
     return retOfLoggerInit;
   }
 
+  //! 时延追踪默认关闭，开启后向进程发送SIGUSR1输出各环节的时延分布
+  if (CONFIG["enableLatencyTrace"].as<bool>(false)) {
+    LatencyTrace::get_mutable_instance().enable();
+  }
+
   return 0;
 }
 
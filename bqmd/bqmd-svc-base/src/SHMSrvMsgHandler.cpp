@@ -11,5 +11,44 @@
 #include "SHMSrvMsgHandler.hpp"
 
 #include "MDSvc.hpp"
+#include "SHMIPC.hpp"
+#include "WSCliOfExch.hpp"
+#include "def/DataStruOfMD.hpp"
+#include "util/Logger.hpp"
+#include "util/TopicMgr.hpp"
 
-namespace bq::md::svc {}
+namespace bq::md::svc {
+
+void SHMSrvMsgHandler::handleReq(const void* shmBuf, std::size_t shmBufLen) {
+  const auto shmHeader = static_cast<const SHMHeader*>(shmBuf);
+  switch (shmHeader->msgId_) {
+    case MSG_ID_SYNC_SUB_INFO:
+      handleSyncSubInfo(shmBuf, shmBufLen);
+      break;
+    case MSG_ID_BOOKS_SNAPSHOT_REQ:
+      handleBooksSnapshotReq(shmBuf, shmBufLen);
+      break;
+    default:
+      break;
+  }
+  doHandleReq(shmBuf, shmBufLen);
+}
+
+//! 这里的订阅信息仅用于更新SHMSrv的过滤器，交易所的订阅仍由SubAndUnSubSvc维护
+void SHMSrvMsgHandler::handleSyncSubInfo(const void* shmBuf,
+                                         std::size_t shmBufLen) {
+  UpdateTopicFilterBySyncSubInfo(shmBuf, {mdSvc_->getSHMSrv()});
+}
+
+void SHMSrvMsgHandler::handleBooksSnapshotReq(const void* shmBuf,
+                                              std::size_t shmBufLen) {
+  const auto booksSnapshotReq = static_cast<const BooksSnapshotReq*>(shmBuf);
+  LOG_I("Recv snapshot req of books {}. [clientChannel = {}; seqNo = {}]",
+        booksSnapshotReq->symbolCode_,
+        booksSnapshotReq->shmHeader_.clientChannel_,
+        booksSnapshotReq->seqNo_);
+  mdSvc_->getWSCliOfExch()->reqFullRefreshOfBooks(
+      booksSnapshotReq->symbolCode_);
+}
+
+}  // namespace bq::md::svc
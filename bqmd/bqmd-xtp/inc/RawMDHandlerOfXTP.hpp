@@ -36,6 +36,9 @@ class RawMDHandlerOfXTP : public RawMDHandler {
   std::tuple<int, RawMDAsyncTaskSPtr> makeAsyncTask(
       const RawMDSPtr& task) final;
 
+ private:
+  std::vector<std::size_t> getSizeGroupOfRawData() const final;
+
  private:
   void handleNewSymbol(RawMDAsyncTaskSPtr& asyncTask) final;
   bool handleMDTickers(RawMDAsyncTaskSPtr& asyncTask) final;
@@ -86,6 +86,10 @@ std::tuple<int, RawMDAsyncTaskSPtr> RawMDHandlerOfXTP::makeAsyncTask(
   return {-1, nullptr};
 }
 
+std::vector<std::size_t> RawMDHandlerOfXTP::getSizeGroupOfRawData() const {
+  return {sizeof(XTPMD), sizeof(XTPTBT), sizeof(XTPOB)};
+}
+
 void RawMDHandlerOfXTP::handleNewSymbol(RawMDAsyncTaskSPtr& asyncTask) {
   const auto exchSymbolInfo = static_cast<XTPQFI*>(asyncTask->task_->data_);
 
@@ -169,13 +173,12 @@ bool RawMDHandlerOfXTP::handleMDTickers(RawMDAsyncTaskSPtr& asyncTask) {
   if (md->last_price == 0 || md->last_price == DBL_MAX) return false;
 
   // buf is released when asyncTask->task_ is destructed
-  auto buf = calloc(1, sizeof(Tickers));
-  asyncTask->task_->dataAfterConv_ = buf;
-  asyncTask->task_->dataAfterConvLen_ = sizeof(Tickers);
+  auto buf = asyncTask->task_->allocDataAfterConv(sizeof(Tickers));
 
   // init tickers
   auto tickers = static_cast<Tickers*>(buf);
   tickers->shmHeader_.topicHash_ = asyncTask->task_->topicHash_;
+  tickers->shmHeader_.topicId_ = asyncTask->task_->topicId_;
 
   tickers->mdHeader_.localTs_ = asyncTask->task_->localTs_;
   tickers->mdHeader_.marketCode_ = asyncTask->task_->marketCode_;
@@ -237,6 +240,7 @@ bool RawMDHandlerOfXTP::handleMDTickers(RawMDAsyncTaskSPtr& asyncTask) {
           GetMarketName(tickers->mdHeader_.marketCode_));
     return true;
   }
+  TraceMDPub(tickers->mdHeader_, asyncTask->task_->tscOfRecv_);
   shmSrv->pushMsg(PUB_CHANNEL, MSG_ID_ON_MD_TICKERS, tickers, sizeof(Tickers));
   return true;
 }
@@ -253,14 +257,13 @@ bool RawMDHandlerOfXTP::handleMDTrades(RawMDAsyncTaskSPtr& asyncTask) {
   if (md->trade.qty == 0 || md->trade.qty == DBL_MAX) return false;
 
   // buf is released when asyncTask->task_ is destructed
-  auto buf = calloc(1, sizeof(Trades));
-  asyncTask->task_->dataAfterConv_ = buf;
-  asyncTask->task_->dataAfterConvLen_ = sizeof(Trades);
+  auto buf = asyncTask->task_->allocDataAfterConv(sizeof(Trades));
 
   // init trades
   auto trades = static_cast<Trades*>(buf);
 
   trades->shmHeader_.topicHash_ = asyncTask->task_->topicHash_;
+  trades->shmHeader_.topicId_ = asyncTask->task_->topicId_;
 
   trades->mdHeader_.localTs_ = asyncTask->task_->localTs_;
   trades->mdHeader_.marketCode_ = asyncTask->task_->marketCode_;
@@ -293,6 +296,7 @@ bool RawMDHandlerOfXTP::handleMDTrades(RawMDAsyncTaskSPtr& asyncTask) {
           GetMarketName(trades->mdHeader_.marketCode_));
     return true;
   }
+  TraceMDPub(trades->mdHeader_, asyncTask->task_->tscOfRecv_);
   shmSrv->pushMsg(PUB_CHANNEL, MSG_ID_ON_MD_TRADES, trades, sizeof(Trades));
   return true;
 }
@@ -309,14 +313,13 @@ bool RawMDHandlerOfXTP::handleMDOrders(RawMDAsyncTaskSPtr& asyncTask) {
   if (md->entrust.qty == 0 || md->entrust.qty == DBL_MAX) return false;
 
   // buf is released when asyncTask->task_ is destructed
-  auto buf = calloc(1, sizeof(Orders));
-  asyncTask->task_->dataAfterConv_ = buf;
-  asyncTask->task_->dataAfterConvLen_ = sizeof(Orders);
+  auto buf = asyncTask->task_->allocDataAfterConv(sizeof(Orders));
 
   // init orders
   auto orders = static_cast<Orders*>(buf);
 
   orders->shmHeader_.topicHash_ = asyncTask->task_->topicHash_;
+  orders->shmHeader_.topicId_ = asyncTask->task_->topicId_;
 
   orders->mdHeader_.localTs_ = asyncTask->task_->localTs_;
   orders->mdHeader_.marketCode_ = asyncTask->task_->marketCode_;
@@ -345,6 +348,7 @@ bool RawMDHandlerOfXTP::handleMDOrders(RawMDAsyncTaskSPtr& asyncTask) {
           GetMarketName(orders->mdHeader_.marketCode_));
     return true;
   }
+  TraceMDPub(orders->mdHeader_, asyncTask->task_->tscOfRecv_);
   shmSrv->pushMsg(PUB_CHANNEL, MSG_ID_ON_MD_ORDERS, orders, sizeof(Orders));
   return true;
 }
@@ -358,13 +362,12 @@ bool RawMDHandlerOfXTP::handleMDBooks(RawMDAsyncTaskSPtr& asyncTask) {
   }
 
   // buf is released when asyncTask->task_ is destructed
-  auto buf = calloc(1, sizeof(Books));
-  asyncTask->task_->dataAfterConv_ = buf;
-  asyncTask->task_->dataAfterConvLen_ = sizeof(Books);
+  auto buf = asyncTask->task_->allocDataAfterConv(sizeof(Books));
 
   // init books
   auto books = static_cast<Books*>(buf);
   books->shmHeader_.topicHash_ = asyncTask->task_->topicHash_;
+  books->shmHeader_.topicId_ = asyncTask->task_->topicId_;
 
   books->mdHeader_.localTs_ = asyncTask->task_->localTs_;
   books->mdHeader_.marketCode_ = asyncTask->task_->marketCode_;
@@ -403,6 +406,7 @@ bool RawMDHandlerOfXTP::handleMDBooks(RawMDAsyncTaskSPtr& asyncTask) {
           GetMarketName(books->mdHeader_.marketCode_));
     return true;
   }
+  TraceMDPub(books->mdHeader_, asyncTask->task_->tscOfRecv_);
   shmSrv->pushMsg(PUB_CHANNEL, MSG_ID_ON_MD_BOOKS, books, sizeof(Books));
   return true;
 }
@@ -10,6 +10,7 @@
 
 #pragma once
 
+#include "OrderInfoArchive.hpp"
 #include "db/DBEng.hpp"
 #include "db/TBLOrderInfo.hpp"
 #include "db/TBLRecSetMaker.hpp"
@@ -26,7 +27,9 @@
 #include "util/Datetime.hpp"
 #include "util/FeeInfoCache.hpp"
 #include "util/Json.hpp"
+#include "util/LatencyTrace.hpp"
 #include "util/Logger.hpp"
+#include "util/MemPool.hpp"
 #include "util/PchBase.hpp"
 
 namespace bq::db {
@@ -47,30 +50,30 @@ using OpenedContractGroupSPtr = std::shared_ptr<OpenedContractGroup>;
 struct StgInstInfo;
 using StgInstInfoSPtr = std::shared_ptr<StgInstInfo>;
 
-//! OrderId索引
+//! OrderId索引，只有精确查找，使用哈希索引
 struct TagOrderIdOfOM {};
-struct KeyOrderIdOfOM
-    : boost::multi_index::composite_key<
-          OrderInfo, MIDX_MEMBER(OrderInfo, OrderId, orderId_)> {};
-using MIdxOrderIdOfOM = boost::multi_index::ordered_unique<
-    boost::multi_index::tag<TagOrderIdOfOM>, KeyOrderIdOfOM,
-    boost::multi_index::composite_key_result_less<
-        KeyOrderIdOfOM ::result_type>>;
+struct KeyOrderIdOfOM : MIDX_MEMBER(OrderInfo, OrderId, orderId_) {};
+using MIdxOrderIdOfOM =
+    boost::multi_index::hashed_unique<boost::multi_index::tag<TagOrderIdOfOM>,
+                                      KeyOrderIdOfOM>;
 
-//! MarketCode和ExchOrderId联合索引
+//! MarketCode和ExchOrderId联合索引，只有精确查找，使用哈希索引
 struct TagMarketCodeExchOrderIdOfOM {};
 struct KeyMarketCodeExchOrderIdOfOM
     : boost::multi_index::composite_key<
           OrderInfo, MIDX_MEMBER(OrderInfo, MarketCode, marketCode_),
           MIDX_MEMBER(OrderInfo, std::uint64_t, hashOfExchOrderId_)> {};
-using MIdxMarketCodeExchOrderIdOfOM = boost::multi_index::ordered_non_unique<
+using MIdxMarketCodeExchOrderIdOfOM = boost::multi_index::hashed_non_unique<
     boost::multi_index::tag<TagMarketCodeExchOrderIdOfOM>,
     KeyMarketCodeExchOrderIdOfOM,
-    boost::multi_index::composite_key_result_less<
+    boost::multi_index::composite_key_result_hash<
+        KeyMarketCodeExchOrderIdOfOM ::result_type>,
+    boost::multi_index::composite_key_result_equal_to<
         KeyMarketCodeExchOrderIdOfOM ::result_type>>;
 
 //! acctId + marketCode + symbolType + symbolCode + posDirection 联合索引，
-//! 用于查找某个品种是否有在途开仓单
+//! 用于查找某个品种是否有在途开仓单，条件查询的时候需要按前缀做范围查找，
+//! 因此保留有序索引
 struct TagAcctIdAndSymInfoOfOM {};
 struct KeyAcctIdAndSymInfoOfOM
     : boost::multi_index::composite_key<
@@ -84,7 +87,7 @@ using MIdxAcctIdAndSymInfoOfOM = boost::multi_index::ordered_non_unique<
     boost::multi_index::composite_key_result_less<
         KeyAcctIdAndSymInfoOfOM ::result_type>>;
 
-//! StgInstId 层面索引
+//! StgInstId 层面索引，只按完整的key查找，使用哈希索引
 struct TagStgInstIdOfOM {};
 struct KeyStgInstIdOfOM
     : boost::multi_index::composite_key<
@@ -92,12 +95,14 @@ struct KeyStgInstIdOfOM
           MIDX_MEMBER(OrderInfo, UserId, userId_),
           MIDX_MEMBER(OrderInfo, StgId, stgId_),
           MIDX_MEMBER(OrderInfo, StgInstId, stgInstId_)> {};
-using MIdxStgInstIdOfOM = boost::multi_index::ordered_non_unique<
+using MIdxStgInstIdOfOM = boost::multi_index::hashed_non_unique<
     boost::multi_index::tag<TagStgInstIdOfOM>, KeyStgInstIdOfOM,
-    boost::multi_index::composite_key_result_less<
+    boost::multi_index::composite_key_result_hash<
+        KeyStgInstIdOfOM ::result_type>,
+    boost::multi_index::composite_key_result_equal_to<
         KeyStgInstIdOfOM ::result_type>>;
 
-//! ClosedTime索引
+//! ClosedTime索引，淘汰最早完结的订单需要有序
 struct TagClosedTimeOfOM {};
 struct KeyClosedTimeOfOM
     : boost::multi_index::composite_key<
@@ -109,19 +114,18 @@ using MIdxClosedTimeOfOM = boost::multi_index::ordered_non_unique<
 
 //! AlgoId索引
 struct TagAlgoIdOfOM {};
-struct KeyAlgoIdOfOM : boost::multi_index::composite_key<
-                           OrderInfo, MIDX_MEMBER(OrderInfo, AlgoId, algoId_)> {
-};
-using MIdxAlgoIdOfOM = boost::multi_index::ordered_non_unique<
-    boost::multi_index::tag<TagAlgoIdOfOM>, KeyAlgoIdOfOM,
-    boost::multi_index::composite_key_result_less<KeyAlgoIdOfOM ::result_type>>;
+struct KeyAlgoIdOfOM : MIDX_MEMBER(OrderInfo, AlgoId, algoId_) {};
+using MIdxAlgoIdOfOM = boost::multi_index::hashed_non_unique<
+    boost::multi_index::tag<TagAlgoIdOfOM>, KeyAlgoIdOfOM>;
+
+//! allocate_shared分配的内存块中除了OrderInfo还有虚表指针、引用计数和分配器
+constexpr static std::size_t EXTRA_SIZE_OF_ORDER_INFO_IN_MEM_POOL = 64;
 
 template <typename... IndexTypes>
 class OrdMgr {
   //! 用于存放在途订单的OrderInfoGroup
   using OrderInfoGroup = boost::multi_index::multi_index_container<
       OrderInfoSPtr, boost::multi_index::indexed_by<IndexTypes...>>;
-  using OrderInfoGroupSPtr = std::shared_ptr<OrderInfoGroup>;
 
   //! 用于存放最近若干笔已完结订单的OrderInfoOfClosedGroup
   using OrderInfoOfClosedGroup = boost::multi_index::multi_index_container<
@@ -129,7 +133,18 @@ class OrdMgr {
       boost::multi_index::indexed_by<MIdxOrderIdOfOM,                //
                                      MIdxMarketCodeExchOrderIdOfOM,  //
                                      MIdxClosedTimeOfOM>>;
-  using OrderInfoOfClosedGroupSPtr = std::shared_ptr<OrderInfoOfClosedGroup>;
+
+  //!
+  //! 按acctId分片，每个分片有各自的在途订单、最近完结订单和锁，不同账户的
+  //! 订单不会竞争同一把锁；只有orderId或者exchOrderId的时候不知道订单属于
+  //! 哪个账户，需要依次查找各个分片。默认只有一个分片。
+  //!
+  struct alignas(CACHE_LINE_SIZE) Shard {
+    OrderInfoGroup orderInfoGroup_;
+    OrderInfoOfClosedGroup orderInfoOfClosedGroup_;
+    mutable std::ext::spin_mutex mtxOrderInfoGroup_;
+  };
+  using ShardUPtr = std::unique_ptr<Shard>;
 
  public:
   OrdMgr(const OrdMgr&) = delete;
@@ -143,11 +158,45 @@ class OrdMgr {
   int init(const YAML::Node& node, const db::DBEngSPtr& dbEng,
            const std::string& sql);
 
+  //! 每个分片各自保留最近value笔已完结订单
   void resetMaxSizeOfOrderInfoOfClosedGroup(std::size_t value) {
     if (value < 128) value = 128;
     maxSizeOfOrderInfoOfClosedGroup_ = value;
   }
 
+  //! 开启归档之后完结超过value秒的订单不再保留在内存中
+  void resetSecOfKeepingClosedOrderInMem(std::uint32_t value) {
+    secOfKeepingClosedOrderInMem_ = value;
+  }
+
+  //! 开启之后从内存中淘汰的已完结订单写入dirOfArchive下的归档文件，
+  //! 按orderId或者exchOrderId查询已完结订单的时候最后从归档中查找
+  int enableArchive(const std::string& dirOfArchive,
+                    std::size_t maxNumOfIndexedRec =
+                        DEFAULT_MAX_NUM_OF_INDEXED_REC_IN_ARCHIVE);
+
+  //! 由计划任务定期调用，没有订单完结的分片也能按时淘汰
+  template <LockFunc lockFunc>
+  void evictOrderInfoOfClosedGroup();
+
+  //! 分片不加锁的OrdMgr只能在所属线程中淘汰，计划任务调用这个函数，所属线程
+  //! 下一次添加或者更新订单的时候淘汰
+  void requestEviction() {
+    isEvictionRequested_.store(true, std::memory_order_relaxed);
+  }
+
+  std::size_t getSizeOfArchive() const {
+    return orderInfoArchive_ ? orderInfoArchive_->size() : 0;
+  }
+
+  //! 只能在添加订单之前调用，分片数为0的时候按1处理
+  void resetNumOfShard(std::uint32_t value);
+
+  //! numOfBlock为0的时候不使用内存池
+  void resetMemPool(std::size_t numOfBlock);
+
+  std::size_t getNumOfShard() const { return shardGroup_.size(); }
+
  private:
   int initOrderInfoGroup(const std::string& sql);
 
@@ -155,8 +204,9 @@ class OrdMgr {
   template <LockFunc lockFunc, DeepClone deepClone>
   int add(const OrderInfoSPtr& orderInfo);
 
+  //! 从acctId所在的分片开始查找，不知道acctId的时候填0
   template <LockFunc lockFunc>
-  int remove(OrderId orderId);
+  int remove(OrderId orderId, AcctId acctId = 0);
 
  public:
   template <LockFunc lockFunc>
@@ -201,8 +251,7 @@ class OrdMgr {
  public:
   template <LockFunc lockFunc, DeepClone deepClone>
   std::vector<OrderInfoSPtr> getOrderInfoGroup(
-      const ConditionTemplate& ConditionTemplate,
-      const ConditionFieldGroup& conditionFieldGroup) const;
+      const CompiledCondition& compiledCondition) const;
 
  public:
   template <LockFunc lockFunc, DeepClone deepClone>
@@ -215,6 +264,8 @@ class OrdMgr {
   Decimal getFrozenPos(const OrderInfoSPtr& orderInfo, AcctId acctId);
 
  public:
+  //! 只有交易网关用交易所的回报更新订单，交易所第一次确认订单的时候在这里统计
+  //! 时延追踪的ExchAck
   template <LockFunc lockFunc, DeepClone deepClone>
   std::tuple<IsSomeFieldOfOrderUpdated, OrderInfoSPtr>
   updateByOrderInfoFromExch(
@@ -229,6 +280,43 @@ class OrdMgr {
   template <LockFunc lockFunc>
   bool compAndCheckIfUpdate(const OrderInfoSPtr& orderInfoFromExch);
 
+ private:
+  template <LockFunc lockFunc, DeepClone deepClone, typename UpdateFunc>
+  OrderInfoSPtr updateByOrderInfo(const OrderInfoSPtr& orderInfo,
+                                  const UpdateFunc& updateFunc);
+
+  template <typename Tag, typename Key, typename UpdateFunc>
+  OrderInfoSPtr updateByOrderInfoInShard(
+      Shard& shard, const Key& key, const OrderInfoSPtr& orderInfo,
+      const UpdateFunc& updateFunc, std::size_t& numOfOrderInfoToArchive);
+
+  template <typename UpdateFunc>
+  OrderInfoSPtr updateByOrderInfoInArchive(std::uint64_t hashOfExchOrderId,
+                                           const OrderInfoSPtr& orderInfo,
+                                           const UpdateFunc& updateFunc);
+
+  void evictOrderInfoOfClosedGroupInShard(
+      Shard& shard, std::size_t& numOfOrderInfoToArchive);
+
+  template <LockFunc lockFunc>
+  void evictIfRequested();
+
+ private:
+  std::size_t getShardNo(AcctId acctId) const {
+    return shardGroup_.size() == 1 ? 0 : acctId % shardGroup_.size();
+  }
+  Shard& getShard(AcctId acctId) const {
+    return *shardGroup_[getShardNo(acctId)];
+  }
+
+  OrderInfoSPtr makeOrderInfo(const OrderInfo& orderInfo) const {
+    if (!memPoolOfOrderInfo_) {
+      return std::make_shared<OrderInfo>(orderInfo);
+    }
+    return std::allocate_shared<OrderInfo>(
+        MemPoolAllocator<OrderInfo>(memPoolOfOrderInfo_), orderInfo);
+  }
+
  public:
   YAML::Node& getNode() { return node_; }
 
@@ -237,19 +325,25 @@ class OrdMgr {
 
   db::DBEngSPtr dbEng_{nullptr};
 
-  OrderInfoGroupSPtr orderInfoGroup_{nullptr};
-  OrderInfoOfClosedGroupSPtr orderInfoOfClosedGroup_{nullptr};
+  std::vector<ShardUPtr> shardGroup_;
   std::size_t maxSizeOfOrderInfoOfClosedGroup_{1024};
-  mutable std::ext::spin_mutex mtxOrderInfoGroup_;
+  std::uint32_t secOfKeepingClosedOrderInMem_{3600};
+
+  //! 为空的时候不按时间淘汰，超过数量上限的已完结订单直接丢弃
+  OrderInfoArchiveSPtr orderInfoArchive_{nullptr};
+  std::atomic<bool> isEvictionRequested_{false};
+
+  //! 深拷贝出来的订单从内存池中分配，池耗尽的时候退回堆上分配
+  FixedSizeMemPoolSPtr memPoolOfOrderInfo_{nullptr};
 };
 
 template <typename... IndexTypes>
 using OrdMgrSPtr = std::shared_ptr<OrdMgr<IndexTypes...>>;
 
 template <typename... IndexTypes>
-OrdMgr<IndexTypes...>::OrdMgr()
-    : orderInfoGroup_(std::make_shared<OrderInfoGroup>()),
-      orderInfoOfClosedGroup_(std::make_shared<OrderInfoOfClosedGroup>()) {}
+OrdMgr<IndexTypes...>::OrdMgr() {
+  resetNumOfShard(1);
+}
 
 template <typename... IndexTypes>
 int OrdMgr<IndexTypes...>::init(const YAML::Node& node,
@@ -258,6 +352,23 @@ int OrdMgr<IndexTypes...>::init(const YAML::Node& node,
   node_ = node;
   dbEng_ = dbEng;
 
+  resetNumOfShard(node["ordMgr"]["numOfShard"].as<std::uint32_t>(1));
+  resetMemPool(node["ordMgr"]["numOfPooledOrderInfo"].as<std::size_t>(4096));
+  resetSecOfKeepingClosedOrderInMem(
+      node["ordMgr"]["secOfKeepingClosedOrderInMem"].as<std::uint32_t>(3600));
+
+  const auto dirOfArchive = node["ordMgr"]["dirOfArchive"].as<std::string>("");
+  if (!dirOfArchive.empty()) {
+    const auto retOfEnable = enableArchive(
+        dirOfArchive, node["ordMgr"]["maxNumOfIndexedRecInArchive"]
+                          .as<std::size_t>(
+                              DEFAULT_MAX_NUM_OF_INDEXED_REC_IN_ARCHIVE));
+    if (retOfEnable != 0) {
+      LOG_W("Init failed because of enable archive failed. [{}]", dirOfArchive);
+      return retOfEnable;
+    }
+  }
+
   auto retOfInitOrd = initOrderInfoGroup(sql);
   if (retOfInitOrd != 0) {
     LOG_W("Init failed. [{}]", sql);
@@ -266,6 +377,38 @@ int OrdMgr<IndexTypes...>::init(const YAML::Node& node,
   return 0;
 }
 
+template <typename... IndexTypes>
+void OrdMgr<IndexTypes...>::resetNumOfShard(std::uint32_t value) {
+  if (value == 0) value = 1;
+  shardGroup_.clear();
+  for (std::uint32_t i = 0; i < value; ++i) {
+    shardGroup_.emplace_back(std::make_unique<Shard>());
+  }
+}
+
+template <typename... IndexTypes>
+void OrdMgr<IndexTypes...>::resetMemPool(std::size_t numOfBlock) {
+  if (numOfBlock == 0) {
+    memPoolOfOrderInfo_.reset();
+    return;
+  }
+  memPoolOfOrderInfo_ = std::make_shared<FixedSizeMemPool>(
+      sizeof(OrderInfo) + EXTRA_SIZE_OF_ORDER_INFO_IN_MEM_POOL, numOfBlock);
+}
+
+template <typename... IndexTypes>
+int OrdMgr<IndexTypes...>::enableArchive(const std::string& dirOfArchive,
+                                         std::size_t maxNumOfIndexedRec) {
+  auto orderInfoArchive =
+      std::make_shared<OrderInfoArchive>(dirOfArchive, maxNumOfIndexedRec);
+  const auto ret = orderInfoArchive->open();
+  if (ret != 0) {
+    return ret;
+  }
+  orderInfoArchive_ = orderInfoArchive;
+  return 0;
+}
+
 template <typename... IndexTypes>
 int OrdMgr<IndexTypes...>::initOrderInfoGroup(const std::string& sql) {
   auto [retOfMaker, tblRecSet] =
@@ -275,6 +418,7 @@ int OrdMgr<IndexTypes...>::initOrderInfoGroup(const std::string& sql) {
     return retOfMaker;
   }
 
+  std::size_t size = 0;
   for (const auto& tblRec : *tblRecSet) {
     const auto recOrderInfo = tblRec.second->getRecWithAllFields();
     auto orderInfo = MakeOrderInfo(recOrderInfo);
@@ -286,18 +430,23 @@ int OrdMgr<IndexTypes...>::initOrderInfoGroup(const std::string& sql) {
       orderInfo->hashOfSymbolCode_ =
           XXH3_64bits(orderInfo->symbolCode_, strlen(orderInfo->symbolCode_));
     }
-    orderInfoGroup_->emplace(orderInfo);
+    auto& shard = getShard(orderInfo->acctId_);
+    if (shard.orderInfoGroup_.emplace(orderInfo).second) {
+      ++size;
+    }
   }
-  LOG_I("Init order info group success. [size = {}]", orderInfoGroup_->size());
+  LOG_I("Init order info group success. [size = {}; numOfShard = {}]", size,
+        shardGroup_.size());
   return 0;
 }
 
 template <typename... IndexTypes>
 template <LockFunc lockFunc, DeepClone deepClone>
 int OrdMgr<IndexTypes...>::add(const OrderInfoSPtr& orderInfo) {
+  evictIfRequested<lockFunc>();
   OrderInfoSPtr orderInfoClone;
   if constexpr (deepClone == DeepClone::True) {
-    orderInfoClone = std::make_shared<OrderInfo>(*orderInfo);
+    orderInfoClone = makeOrderInfo(*orderInfo);
   } else {
     orderInfoClone = orderInfo;
   }
@@ -305,10 +454,15 @@ int OrdMgr<IndexTypes...>::add(const OrderInfoSPtr& orderInfo) {
     orderInfoClone->hashOfExchOrderId_ = XXH3_64bits(
         orderInfoClone->exchOrderId_, strlen(orderInfoClone->exchOrderId_));
   }
+  if (orderInfoClone->symbolCode_[0] != '\0') {
+    orderInfoClone->hashOfSymbolCode_ = XXH3_64bits(
+        orderInfoClone->symbolCode_, strlen(orderInfoClone->symbolCode_));
+  }
   decltype(std::declval<OrderInfoGroup>().emplace(orderInfo)) ret;
   {
-    SPIN_LOCK(mtxOrderInfoGroup_);
-    ret = orderInfoGroup_->emplace(orderInfoClone);
+    auto& shard = getShard(orderInfoClone->acctId_);
+    SPIN_LOCK(shard.mtxOrderInfoGroup_);
+    ret = shard.orderInfoGroup_.emplace(orderInfoClone);
   }
   if (!ret.second) {
     LOG_W(
@@ -321,10 +475,12 @@ int OrdMgr<IndexTypes...>::add(const OrderInfoSPtr& orderInfo) {
 
 template <typename... IndexTypes>
 template <LockFunc lockFunc>
-int OrdMgr<IndexTypes...>::remove(OrderId orderId) {
-  {
-    SPIN_LOCK(mtxOrderInfoGroup_);
-    auto& idx = orderInfoGroup_->template get<TagOrderIdOfOM>();
+int OrdMgr<IndexTypes...>::remove(OrderId orderId, AcctId acctId) {
+  const auto shardNo = getShardNo(acctId);
+  for (std::size_t i = 0; i < shardGroup_.size(); ++i) {
+    auto& shard = *shardGroup_[(shardNo + i) % shardGroup_.size()];
+    SPIN_LOCK(shard.mtxOrderInfoGroup_);
+    auto& idx = shard.orderInfoGroup_.template get<TagOrderIdOfOM>();
     const auto iter = idx.find(orderId);
     if (iter != std::end(idx)) {
       LOG_D("Remove order info in order info group. {}", (*iter)->toShortStr());
@@ -353,8 +509,9 @@ bool OrdMgr<IndexTypes...>::existsOpenPendingOrders(
                                    hashOfSymbolCode,        //
                                    PosDirection::Open);
   {
-    SPIN_LOCK(mtxOrderInfoGroup_);
-    auto& idx = orderInfoGroup_->template get<TagAcctIdAndSymInfoOfOM>();
+    auto& shard = getShard(orderInfo->acctId_);
+    SPIN_LOCK(shard.mtxOrderInfoGroup_);
+    auto& idx = shard.orderInfoGroup_.template get<TagAcctIdAndSymInfoOfOM>();
     const auto iter = idx.find(key);
     if (iter != std::end(idx)) {
       LOG_W(
@@ -370,24 +527,24 @@ template <typename... IndexTypes>
 template <LockFunc lockFunc, DeepClone deepClone>
 std::tuple<int, OrderInfoSPtr> OrdMgr<IndexTypes...>::getOrderInfo(
     OrderId orderId, QryFromClosedOrder qryFromClosedOrder, WriteLog writeLog) {
-  {
-    SPIN_LOCK(mtxOrderInfoGroup_);
-    auto& idx = orderInfoGroup_->template get<TagOrderIdOfOM>();
+  for (const auto& shard : shardGroup_) {
+    SPIN_LOCK(shard->mtxOrderInfoGroup_);
+    auto& idx = shard->orderInfoGroup_.template get<TagOrderIdOfOM>();
     const auto iter = idx.find(orderId);
     if (iter != std::end(idx)) {
       if constexpr (deepClone == DeepClone::True) {
-        return {0, std::make_shared<OrderInfo>(**iter)};
+        return {0, makeOrderInfo(**iter)};
       } else {
         return {0, *iter};
       }
     }
 
     if (qryFromClosedOrder == QryFromClosedOrder::True) {
-      auto& idx = orderInfoOfClosedGroup_->template get<TagOrderIdOfOM>();
+      auto& idx = shard->orderInfoOfClosedGroup_.template get<TagOrderIdOfOM>();
       const auto iter = idx.find(orderId);
       if (iter != std::end(idx)) {
         if constexpr (deepClone == DeepClone::True) {
-          return {0, std::make_shared<OrderInfo>(**iter)};
+          return {0, makeOrderInfo(**iter)};
         } else {
           return {0, *iter};
         }
@@ -395,6 +552,13 @@ std::tuple<int, OrderInfoSPtr> OrdMgr<IndexTypes...>::getOrderInfo(
     }
   }
 
+  if (qryFromClosedOrder == QryFromClosedOrder::True && orderInfoArchive_) {
+    auto orderInfo = orderInfoArchive_->get(orderId);
+    if (orderInfo) {
+      return {0, orderInfo};
+    }
+  }
+
   if (writeLog == WriteLog::True) {
     LOG_W(
         "Get order info from order info group failed "
@@ -420,26 +584,27 @@ std::tuple<int, OrderInfoSPtr> OrdMgr<IndexTypes...>::getOrderInfo(
 
   const auto hashOfExchOrderId =
       XXH3_64bits(exchOrderId.data(), exchOrderId.size());
-  {
-    SPIN_LOCK(mtxOrderInfoGroup_);
-    auto& idx = orderInfoGroup_->template get<TagMarketCodeExchOrderIdOfOM>();
-    const auto iter = idx.find(std::make_tuple(marketCode, hashOfExchOrderId));
+  const auto key = std::make_tuple(marketCode, hashOfExchOrderId);
+  for (const auto& shard : shardGroup_) {
+    SPIN_LOCK(shard->mtxOrderInfoGroup_);
+    auto& idx =
+        shard->orderInfoGroup_.template get<TagMarketCodeExchOrderIdOfOM>();
+    const auto iter = idx.find(key);
     if (iter != std::end(idx)) {
       if constexpr (deepClone == DeepClone::True) {
-        return {0, std::make_shared<OrderInfo>(**iter)};
+        return {0, makeOrderInfo(**iter)};
       } else {
         return {0, *iter};
       }
     }
 
     if (qryFromClosedOrder == QryFromClosedOrder::True) {
-      auto& idx =
-          orderInfoOfClosedGroup_->template get<TagMarketCodeExchOrderIdOfOM>();
-      const auto iter =
-          idx.find(std::make_tuple(marketCode, hashOfExchOrderId));
+      auto& idx = shard->orderInfoOfClosedGroup_
+                      .template get<TagMarketCodeExchOrderIdOfOM>();
+      const auto iter = idx.find(key);
       if (iter != std::end(idx)) {
         if constexpr (deepClone == DeepClone::True) {
-          return {0, std::make_shared<OrderInfo>(**iter)};
+          return {0, makeOrderInfo(**iter)};
         } else {
           return {0, *iter};
         }
@@ -447,6 +612,13 @@ std::tuple<int, OrderInfoSPtr> OrdMgr<IndexTypes...>::getOrderInfo(
     }
   }
 
+  if (qryFromClosedOrder == QryFromClosedOrder::True && orderInfoArchive_) {
+    auto orderInfo = orderInfoArchive_->get(marketCode, hashOfExchOrderId);
+    if (orderInfo) {
+      return {0, orderInfo};
+    }
+  }
+
   if (writeLog == WriteLog::True) {
     LOG_W(
         "Get order info from order info group failed "
@@ -464,15 +636,11 @@ template <LockFunc lockFunc, DeepClone deepClone>
 std::tuple<int, OrderInfoSPtr> OrdMgr<IndexTypes...>::getOrderInfo(
     std::vector<MarketCode> marketCodeGroup, const std::string& exchOrderId,
     QryFromClosedOrder qryFromClosedOrder) {
-  {
-    SPIN_LOCK(mtxOrderInfoGroup_);
-    for (const auto marketCode : marketCodeGroup) {
-      const auto [statusCode, orderInfo] =
-          getOrderInfo<LockFunc::False, deepClone>(
-              marketCode, exchOrderId, qryFromClosedOrder, WriteLog::False);
-      if (statusCode == 0 && orderInfo) {
-        return {statusCode, orderInfo};
-      }
+  for (const auto marketCode : marketCodeGroup) {
+    const auto [statusCode, orderInfo] = getOrderInfo<lockFunc, deepClone>(
+        marketCode, exchOrderId, qryFromClosedOrder, WriteLog::False);
+    if (statusCode == 0 && orderInfo) {
+      return {statusCode, orderInfo};
     }
   }
   LOG_W(
@@ -489,13 +657,13 @@ std::vector<OrderInfoSPtr> OrdMgr<IndexTypes...>::getOrderInfoGroup(
     std::uint32_t secAgoTheOrderNeedToBeSynced) const {
   const auto now = GetTotalUSSince1970();
   std::vector<OrderInfoSPtr> ret;
-  {
-    SPIN_LOCK(mtxOrderInfoGroup_);
-    for (const auto& rec : *orderInfoGroup_) {
+  for (const auto& shard : shardGroup_) {
+    SPIN_LOCK(shard->mtxOrderInfoGroup_);
+    for (const auto& rec : shard->orderInfoGroup_) {
       const auto td = now - rec->orderTime_;
       if (td > secAgoTheOrderNeedToBeSynced * 1000 * 1000) {
         if constexpr (deepClone == DeepClone::True) {
-          ret.emplace_back(std::make_shared<OrderInfo>(*rec));
+          ret.emplace_back(makeOrderInfo(*rec));
         } else {
           ret.emplace_back(rec);
         }
@@ -510,16 +678,16 @@ template <LockFunc lockFunc, DeepClone deepClone>
 std::vector<OrderInfoSPtr> OrdMgr<IndexTypes...>::getOrderInfoGroupOfStgInst(
     const StgInstInfoSPtr& stgInstInfo) const {
   std::vector<OrderInfoSPtr> ret;
-  {
-    SPIN_LOCK(mtxOrderInfoGroup_);
-    auto& idx = orderInfoGroup_->template get<TagStgInstIdOfOM>();
-    const auto key =
-        std::make_tuple(stgInstInfo->productId_, stgInstInfo->userId_,
-                        stgInstInfo->stgId_, stgInstInfo->stgInstId_);
+  const auto key =
+      std::make_tuple(stgInstInfo->productId_, stgInstInfo->userId_,
+                      stgInstInfo->stgId_, stgInstInfo->stgInstId_);
+  for (const auto& shard : shardGroup_) {
+    SPIN_LOCK(shard->mtxOrderInfoGroup_);
+    auto& idx = shard->orderInfoGroup_.template get<TagStgInstIdOfOM>();
     const auto range = idx.equal_range(key);
     for (auto iter = range.first; iter != range.second; ++iter) {
       if constexpr (deepClone == DeepClone::True) {
-        ret.emplace_back(std::make_shared<OrderInfo>(**iter));
+        ret.emplace_back(makeOrderInfo(**iter));
       } else {
         ret.emplace_back(*iter);
       }
@@ -532,9 +700,9 @@ template <typename... IndexTypes>
 template <LockFunc lockFunc>
 std::vector<OrderId> OrdMgr<IndexTypes...>::getOrderIdGroupOfStg(StgId stgId) {
   std::vector<OrderId> ret;
-  {
-    SPIN_LOCK(mtxOrderInfoGroup_);
-    for (const auto& orderInfo : *orderInfoGroup_) {
+  for (const auto& shard : shardGroup_) {
+    SPIN_LOCK(shard->mtxOrderInfoGroup_);
+    for (const auto& orderInfo : shard->orderInfoGroup_) {
       if (stgId == 0) {
         ret.emplace_back(orderInfo->orderId_);
       } else {
@@ -552,9 +720,9 @@ template <LockFunc lockFunc>
 std::vector<OrderId> OrdMgr<IndexTypes...>::getOrderIdGroupOfStgInst(
     StgInstId stgInstId) {
   std::vector<OrderId> ret;
-  {
-    SPIN_LOCK(mtxOrderInfoGroup_);
-    for (const auto& orderInfo : *orderInfoGroup_) {
+  for (const auto& shard : shardGroup_) {
+    SPIN_LOCK(shard->mtxOrderInfoGroup_);
+    for (const auto& orderInfo : shard->orderInfoGroup_) {
       if (orderInfo->stgInstId_ == stgInstId) {
         ret.emplace_back(orderInfo->orderId_);
       }
@@ -568,9 +736,9 @@ template <LockFunc lockFunc>
 std::vector<OrderId> OrdMgr<IndexTypes...>::getOrderIdGroupOfAlgo(
     AlgoId algoId) {
   std::vector<OrderId> ret;
-  {
-    SPIN_LOCK(mtxOrderInfoGroup_);
-    auto& idx = orderInfoGroup_->template get<TagAlgoIdOfOM>();
+  for (const auto& shard : shardGroup_) {
+    SPIN_LOCK(shard->mtxOrderInfoGroup_);
+    auto& idx = shard->orderInfoGroup_.template get<TagAlgoIdOfOM>();
     const auto range = idx.equal_range(algoId);
     for (auto iter = range.first; iter != range.second; ++iter) {
       ret.emplace_back((*iter)->orderId_);
@@ -590,12 +758,13 @@ std::vector<OrderInfoSPtr> OrdMgr<IndexTypes...>::getOrderInfoGroup(
   const auto key = std::make_tuple(acctId, marketCode, symbolType,
                                    hashOfSymbolCode, PosDirection::Open);
   {
-    SPIN_LOCK(mtxOrderInfoGroup_);
-    auto& idx = orderInfoGroup_->template get<TagAcctIdAndSymInfoOfOM>();
+    auto& shard = getShard(acctId);
+    SPIN_LOCK(shard.mtxOrderInfoGroup_);
+    auto& idx = shard.orderInfoGroup_.template get<TagAcctIdAndSymInfoOfOM>();
     const auto range = idx.equal_range(key);
     for (auto iter = range.first; iter != range.second; ++iter) {
       if constexpr (deepClone == DeepClone::True) {
-        ret.emplace_back(std::make_shared<OrderInfo>(**iter));
+        ret.emplace_back(makeOrderInfo(**iter));
       } else {
         ret.emplace_back(*iter);
       }
@@ -616,8 +785,9 @@ Decimal OrdMgr<IndexTypes...>::getFrozenPos(const OrderInfoSPtr& orderInfo,
       std::make_tuple(acctId, orderInfo->marketCode_, orderInfo->symbolType_,
                       hashOfSymbolCode, PosDirection::Close);
   {
-    SPIN_LOCK(mtxOrderInfoGroup_);
-    auto& idx = orderInfoGroup_->template get<TagAcctIdAndSymInfoOfOM>();
+    auto& shard = getShard(acctId);
+    SPIN_LOCK(shard.mtxOrderInfoGroup_);
+    auto& idx = shard.orderInfoGroup_.template get<TagAcctIdAndSymInfoOfOM>();
     const auto range = idx.equal_range(key);
     for (auto iter = range.first; iter != range.second; ++iter) {
       const auto& orderInfoInOrdMgr = *iter;
@@ -641,312 +811,224 @@ OrdMgr<IndexTypes...>::updateByOrderInfoFromExch(
   IsSomeFieldOfOrderUpdated isTheOrderInfoUpdated =
       IsSomeFieldOfOrderUpdated::False;
 
-  IsTheKeyFieldOfOrderUpdated isTheKeyFieldOfOrderUpdated =
-      IsTheKeyFieldOfOrderUpdated::False;
-
-  OrderInfoSPtr orderInfoInOrdMgr = nullptr;
-  {
-    SPIN_LOCK(mtxOrderInfoGroup_);
-    if (orderInfoFromExch->orderId_ != 0) {
-      //! 根据 orderId 获取订单
-      auto& idx = orderInfoGroup_->template get<TagOrderIdOfOM>();
-      auto iter = idx.find(orderInfoFromExch->orderId_);
-      if (iter != std::end(idx)) {
-        orderInfoInOrdMgr = *iter;
-
-        //! 那么更新此订单
+  const auto orderInfoInOrdMgr = updateByOrderInfo<lockFunc, deepClone>(
+      orderInfoFromExch, [&](const OrderInfoSPtr& orderInfoInOrdMgr) {
+        const auto orderStatusBeforeUpdate = orderInfoInOrdMgr->orderStatus_;
+        IsTheKeyFieldOfOrderUpdated isTheKeyFieldOfOrderUpdated;
         std::tie(isTheOrderInfoUpdated, isTheKeyFieldOfOrderUpdated) =
             orderInfoInOrdMgr->updateByOrderInfoFromExch(
                 orderInfoFromExch, noUsedToCalcPos, feeInfoCache,
                 openedContractGroup);
-
-        //! 如果订单完结那么移动到最近完结的订单列表中
-        if (orderInfoInOrdMgr->closed()) {
-          (*iter)->closedTime_ = GetTotalUSSince1970();
-          orderInfoOfClosedGroup_->emplace(*iter);
-          if (orderInfoOfClosedGroup_->size() >
-              maxSizeOfOrderInfoOfClosedGroup_) {
-            auto& idxOfClosed =
-                orderInfoOfClosedGroup_->template get<TagClosedTimeOfOM>();
-            idxOfClosed.erase(std::begin(idxOfClosed));
-          }
-          idx.erase(iter);
-        } else {
-          //! 如果索引字段发生变化，那么需要replace
-          if (isTheKeyFieldOfOrderUpdated ==
-              IsTheKeyFieldOfOrderUpdated::True) {
-            idx.replace(iter, orderInfoInOrdMgr);
-          }
+        if (orderStatusBeforeUpdate <= OrderStatus::Pending &&
+            orderInfoInOrdMgr->orderStatus_ > OrderStatus::Pending) {
+          LatencyTrace::get_mutable_instance().stamp(
+              orderInfoInOrdMgr->traceCtx_, TraceHop::ExchAck);
         }
+        return isTheKeyFieldOfOrderUpdated;
+      });
 
-      } else {
-        //! 继续尝试从已完结订单列表中获取
-        auto& idxOfClosed =
-            orderInfoOfClosedGroup_->template get<TagOrderIdOfOM>();
-        auto iterOfClosed = idxOfClosed.find(orderInfoFromExch->orderId_);
-        if (iterOfClosed != std::end(idxOfClosed)) {
-          orderInfoInOrdMgr = *iterOfClosed;
-          LOG_I("Get order info from order info of closed group. {}",
-                orderInfoFromExch->toShortStr());
-
-          //! 那么更新此订单
-          std::tie(isTheOrderInfoUpdated, isTheKeyFieldOfOrderUpdated) =
-              orderInfoInOrdMgr->updateByOrderInfoFromExch(
-                  orderInfoFromExch, noUsedToCalcPos, feeInfoCache,
-                  openedContractGroup);
-
-          //! 如果索引字段发生变化，那么需要replace
-          if (isTheKeyFieldOfOrderUpdated ==
-              IsTheKeyFieldOfOrderUpdated::True) {
-            idxOfClosed.replace(iterOfClosed, orderInfoInOrdMgr);
-          }
-
-        } else {
-          LOG_I(
-              "Update by order info from exch failed, may be the rtn trade"
-              "of orders out of order and severly delayed. {}",
-              orderInfoFromExch->toShortStr());
-          return {isTheOrderInfoUpdated, nullptr};
-        }
-      }
+  return {isTheOrderInfoUpdated, orderInfoInOrdMgr};
+}
 
-      if constexpr (deepClone == DeepClone::True) {
-        return {isTheOrderInfoUpdated,
-                std::make_shared<OrderInfo>(*orderInfoInOrdMgr)};
-      } else {
-        return {isTheOrderInfoUpdated, orderInfoInOrdMgr};
-      }
+template <typename... IndexTypes>
+template <LockFunc lockFunc>
+std::tuple<IsTheOrderCanBeUsedCalcPos, OrderInfoSPtr>
+OrdMgr<IndexTypes...>::updateByOrderInfoFromTDGW(
+    const OrderInfoSPtr& orderInfoFromTDGW) {
+  IsTheOrderCanBeUsedCalcPos isTheOrderCanBeUsedCalcPos =
+      IsTheOrderCanBeUsedCalcPos::False;
 
-    } else if (orderInfoFromExch->marketCode_ != MarketCode::Others &&
-               orderInfoFromExch->exchOrderId_[0] != '\0') {
-      //! 根据 marketCode 和 exchOrderId 获取订单
-      auto& idx = orderInfoGroup_->template get<TagMarketCodeExchOrderIdOfOM>();
-      const auto hashOfExchOrderId =
-          XXH3_64bits(orderInfoFromExch->exchOrderId_,
-                      strlen(orderInfoFromExch->exchOrderId_));
-      const auto iter = idx.find(
-          std::make_tuple(orderInfoFromExch->marketCode_, hashOfExchOrderId));
-      if (iter != std::end(idx)) {
-        orderInfoInOrdMgr = *iter;
+  const auto orderInfoInOrdMgr = updateByOrderInfo<lockFunc, DeepClone::False>(
+      orderInfoFromTDGW, [&](const OrderInfoSPtr& orderInfoInOrdMgr) {
+        IsTheKeyFieldOfOrderUpdated isTheKeyFieldOfOrderUpdated;
+        std::tie(isTheOrderCanBeUsedCalcPos, isTheKeyFieldOfOrderUpdated) =
+            orderInfoInOrdMgr->updateByOrderInfoFromTDGW(orderInfoFromTDGW);
+        return isTheKeyFieldOfOrderUpdated;
+      });
 
-        //! 那么更新此订单
-        std::tie(isTheOrderInfoUpdated, isTheKeyFieldOfOrderUpdated) =
-            orderInfoInOrdMgr->updateByOrderInfoFromExch(
-                orderInfoFromExch, noUsedToCalcPos, feeInfoCache,
-                openedContractGroup);
+  return {isTheOrderCanBeUsedCalcPos, orderInfoInOrdMgr};
+}
 
-        //! 如果订单完结那么移动到最近完结的订单列表中
-        if (orderInfoInOrdMgr->closed()) {
-          (*iter)->closedTime_ = GetTotalUSSince1970();
-          orderInfoOfClosedGroup_->emplace(*iter);
-          if (orderInfoOfClosedGroup_->size() >
-              maxSizeOfOrderInfoOfClosedGroup_) {
-            auto& idxOfClosed =
-                orderInfoOfClosedGroup_->template get<TagClosedTimeOfOM>();
-            idxOfClosed.erase(std::begin(idxOfClosed));
-          }
-          idx.erase(iter);
-        } else {
-          //! 如果索引字段发生变化，那么需要replace
-          if (isTheKeyFieldOfOrderUpdated ==
-              IsTheKeyFieldOfOrderUpdated::True) {
-            idx.replace(iter, orderInfoInOrdMgr);
-          }
-        }
+//! 先根据 orderId，没有 orderId 的时候根据 marketCode 和 exchOrderId 获取订单，
+//! 从订单所属账户的分片开始查找，找到之后在锁内调用updateFunc更新订单，
+//! 内存中找不到的时候最后从归档中查找
+template <typename... IndexTypes>
+template <LockFunc lockFunc, DeepClone deepClone, typename UpdateFunc>
+OrderInfoSPtr OrdMgr<IndexTypes...>::updateByOrderInfo(
+    const OrderInfoSPtr& orderInfo, const UpdateFunc& updateFunc) {
+  evictIfRequested<lockFunc>();
+  const auto qryByOrderId = orderInfo->orderId_ != 0;
+  if (!qryByOrderId && (orderInfo->marketCode_ == MarketCode::Others ||
+                        orderInfo->exchOrderId_[0] == '\0')) {
+    return nullptr;
+  }
 
+  const auto hashOfExchOrderId =
+      qryByOrderId ? 0
+                   : XXH3_64bits(orderInfo->exchOrderId_,
+                                 strlen(orderInfo->exchOrderId_));
+  const auto shardNo = getShardNo(orderInfo->acctId_);
+  for (std::size_t i = 0; i < shardGroup_.size(); ++i) {
+    auto& shard = *shardGroup_[(shardNo + i) % shardGroup_.size()];
+    OrderInfoSPtr orderInfoInOrdMgr;
+    std::size_t numOfOrderInfoToArchive = 0;
+    {
+      SPIN_LOCK(shard.mtxOrderInfoGroup_);
+      if (qryByOrderId) {
+        orderInfoInOrdMgr = updateByOrderInfoInShard<TagOrderIdOfOM>(
+            shard, orderInfo->orderId_, orderInfo, updateFunc,
+            numOfOrderInfoToArchive);
       } else {
-        //! 继续尝试从已完结订单列表中获取
-        auto& idxOfClosed = orderInfoOfClosedGroup_
-                                ->template get<TagMarketCodeExchOrderIdOfOM>();
-        auto iterOfClosed = idxOfClosed.find(
-            std::make_tuple(orderInfoFromExch->marketCode_, hashOfExchOrderId));
-        if (iterOfClosed != std::end(idxOfClosed)) {
-          orderInfoInOrdMgr = *iterOfClosed;
-          LOG_I("Get order info from order info of closed group. {}",
-                orderInfoFromExch->toShortStr());
-
-          //! 那么更新此订单
-          std::tie(isTheOrderInfoUpdated, isTheKeyFieldOfOrderUpdated) =
-              orderInfoInOrdMgr->updateByOrderInfoFromExch(
-                  orderInfoFromExch, noUsedToCalcPos, feeInfoCache,
-                  openedContractGroup);
-
-          //! 如果索引字段发生变化，那么需要replace
-          if (isTheKeyFieldOfOrderUpdated ==
-              IsTheKeyFieldOfOrderUpdated::True) {
-            idxOfClosed.replace(iterOfClosed, orderInfoInOrdMgr);
-          }
-
-        } else {
-          LOG_I(
-              "Update by order info from exch failed, may be the rtn trade"
-              "of orders out of order and severly delayed. {}",
-              orderInfoFromExch->toShortStr());
-          return {isTheOrderInfoUpdated, nullptr};
-        }
+        orderInfoInOrdMgr =
+            updateByOrderInfoInShard<TagMarketCodeExchOrderIdOfOM>(
+                shard,
+                std::make_tuple(orderInfo->marketCode_, hashOfExchOrderId),
+                orderInfo, updateFunc, numOfOrderInfoToArchive);
       }
+    }
+    //! 写文件比较慢，在锁外写入归档
+    if (numOfOrderInfoToArchive != 0) {
+      orderInfoArchive_->flushPending();
+    }
 
+    if (orderInfoInOrdMgr) {
       if constexpr (deepClone == DeepClone::True) {
-        return {isTheOrderInfoUpdated,
-                std::make_shared<OrderInfo>(*orderInfoInOrdMgr)};
+        return makeOrderInfo(*orderInfoInOrdMgr);
       } else {
-        return {isTheOrderInfoUpdated, orderInfoInOrdMgr};
+        return orderInfoInOrdMgr;
       }
+    }
+  }
 
-    } else {
-      return {isTheOrderInfoUpdated, nullptr};
+  if (orderInfoArchive_) {
+    auto orderInfoInArchive =
+        updateByOrderInfoInArchive(hashOfExchOrderId, orderInfo, updateFunc);
+    if (orderInfoInArchive) {
+      return orderInfoInArchive;
     }
   }
+
+  LOG_I(
+      "Update by order info from exch failed, may be the rtn trade"
+      "of orders out of order and severly delayed. {}",
+      orderInfo->toShortStr());
+  return nullptr;
 }
 
+//! 索引字段是在OrderInfo内部直接修改的，replace的时候哈希索引会认为元素没有
+//! 变化，因此用modify通知容器重新计算该元素在所有索引中的位置
 template <typename... IndexTypes>
-template <LockFunc lockFunc>
-std::tuple<IsTheOrderCanBeUsedCalcPos, OrderInfoSPtr>
-OrdMgr<IndexTypes...>::updateByOrderInfoFromTDGW(
-    const OrderInfoSPtr& orderInfoFromTDGW) {
-  IsTheOrderCanBeUsedCalcPos isTheOrderCanBeUsedCalcPos =
-      IsTheOrderCanBeUsedCalcPos::False;
-
-  IsTheKeyFieldOfOrderUpdated isTheKeyFieldOfOrderUpdated =
-      IsTheKeyFieldOfOrderUpdated::False;
-
-  OrderInfoSPtr orderInfoInOrdMgr = nullptr;
-  {
-    SPIN_LOCK(mtxOrderInfoGroup_);
-    if (orderInfoFromTDGW->orderId_ != 0) {
-      //! 根据 orderId 获取订单
-      auto& idx = orderInfoGroup_->template get<TagOrderIdOfOM>();
-      auto iter = idx.find(orderInfoFromTDGW->orderId_);
-      if (iter != std::end(idx)) {
-        orderInfoInOrdMgr = *iter;
-
-        //! 那么更新此订单
-        std::tie(isTheOrderCanBeUsedCalcPos, isTheKeyFieldOfOrderUpdated) =
-            orderInfoInOrdMgr->updateByOrderInfoFromTDGW(orderInfoFromTDGW);
-
-        //! 如果订单完结那么移动到最近完结的订单列表中
-        if (orderInfoInOrdMgr->closed()) {
-          (*iter)->closedTime_ = GetTotalUSSince1970();
-          orderInfoOfClosedGroup_->emplace(*iter);
-          if (orderInfoOfClosedGroup_->size() >
-              maxSizeOfOrderInfoOfClosedGroup_) {
-            auto& idxOfClosed =
-                orderInfoOfClosedGroup_->template get<TagClosedTimeOfOM>();
-            idxOfClosed.erase(std::begin(idxOfClosed));
-          }
-          idx.erase(iter);
-        } else {
-          //! 如果索引字段发生变化，那么需要replace
-          if (isTheKeyFieldOfOrderUpdated ==
-              IsTheKeyFieldOfOrderUpdated::True) {
-            idx.replace(iter, orderInfoInOrdMgr);
-          }
-        }
-
-      } else {
-        //! 继续尝试从已完结订单列表中获取
-        auto& idxOfClosed =
-            orderInfoOfClosedGroup_->template get<TagOrderIdOfOM>();
-        auto iterOfClosed = idxOfClosed.find(orderInfoFromTDGW->orderId_);
-        if (iterOfClosed != std::end(idxOfClosed)) {
-          orderInfoInOrdMgr = *iterOfClosed;
-          LOG_I("Get order info from order info of closed group. {}",
-                orderInfoFromTDGW->toShortStr());
-
-          //! 那么更新此订单
-          std::tie(isTheOrderCanBeUsedCalcPos, isTheKeyFieldOfOrderUpdated) =
-              orderInfoInOrdMgr->updateByOrderInfoFromTDGW(orderInfoFromTDGW);
-
-          //! 如果索引字段发生变化，那么需要replace
-          if (isTheKeyFieldOfOrderUpdated ==
-              IsTheKeyFieldOfOrderUpdated::True) {
-            idxOfClosed.replace(iterOfClosed, orderInfoInOrdMgr);
-          }
-
-        } else {
-          LOG_I(
-              "Update by order info from exch failed, may be the rtn trade"
-              "of orders out of order and severly delayed. {}",
-              orderInfoFromTDGW->toShortStr());
-          return {isTheOrderCanBeUsedCalcPos, nullptr};
-        }
+template <typename Tag, typename Key, typename UpdateFunc>
+OrderInfoSPtr OrdMgr<IndexTypes...>::updateByOrderInfoInShard(
+    Shard& shard, const Key& key, const OrderInfoSPtr& orderInfo,
+    const UpdateFunc& updateFunc, std::size_t& numOfOrderInfoToArchive) {
+  auto& idx = shard.orderInfoGroup_.template get<Tag>();
+  const auto iter = idx.find(key);
+  if (iter != std::end(idx)) {
+    const auto orderInfoInOrdMgr = *iter;
+
+    //! 那么更新此订单
+    const auto isTheKeyFieldOfOrderUpdated = updateFunc(orderInfoInOrdMgr);
+
+    //! 如果订单完结那么移动到最近完结的订单列表中
+    if (orderInfoInOrdMgr->closed()) {
+      orderInfoInOrdMgr->closedTime_ = GetTotalUSSince1970();
+      shard.orderInfoOfClosedGroup_.emplace(orderInfoInOrdMgr);
+      idx.erase(iter);
+      evictOrderInfoOfClosedGroupInShard(shard, numOfOrderInfoToArchive);
+    } else {
+      //! 如果索引字段发生变化，那么需要重建索引
+      if (isTheKeyFieldOfOrderUpdated == IsTheKeyFieldOfOrderUpdated::True) {
+        idx.modify(iter, [](OrderInfoSPtr&) {});
       }
+    }
+    return orderInfoInOrdMgr;
+  }
 
-      return {isTheOrderCanBeUsedCalcPos, orderInfoInOrdMgr};
-
-    } else if (orderInfoFromTDGW->marketCode_ != MarketCode::Others &&
-               orderInfoFromTDGW->exchOrderId_[0] != '\0') {
-      //! 根据 marketCode 和 exchOrderId 获取订单
-      auto& idx = orderInfoGroup_->template get<TagMarketCodeExchOrderIdOfOM>();
-      const auto hashOfExchOrderId =
-          XXH3_64bits(orderInfoFromTDGW->exchOrderId_,
-                      strlen(orderInfoFromTDGW->exchOrderId_));
-      const auto iter = idx.find(
-          std::make_tuple(orderInfoFromTDGW->marketCode_, hashOfExchOrderId));
-      if (iter != std::end(idx)) {
-        orderInfoInOrdMgr = *iter;
+  //! 继续尝试从已完结订单列表中获取
+  auto& idxOfClosed = shard.orderInfoOfClosedGroup_.template get<Tag>();
+  const auto iterOfClosed = idxOfClosed.find(key);
+  if (iterOfClosed == std::end(idxOfClosed)) {
+    return nullptr;
+  }
 
-        //! 那么更新此订单
-        std::tie(isTheOrderCanBeUsedCalcPos, isTheKeyFieldOfOrderUpdated) =
-            orderInfoInOrdMgr->updateByOrderInfoFromTDGW(orderInfoFromTDGW);
+  const auto orderInfoInOrdMgr = *iterOfClosed;
+  LOG_I("Get order info from order info of closed group. {}",
+        orderInfo->toShortStr());
 
-        //! 如果订单完结
-        if (orderInfoInOrdMgr->closed()) {
-          (*iter)->closedTime_ = GetTotalUSSince1970();
-          orderInfoOfClosedGroup_->emplace(*iter);
-          if (orderInfoOfClosedGroup_->size() >
-              maxSizeOfOrderInfoOfClosedGroup_) {
-            auto& idxOfClosed =
-                orderInfoOfClosedGroup_->template get<TagClosedTimeOfOM>();
-            idxOfClosed.erase(std::begin(idxOfClosed));
-          }
-          idx.erase(iter);
-        } else {
-          //! 如果索引字段发生变化，那么需要replace
-          if (isTheKeyFieldOfOrderUpdated ==
-              IsTheKeyFieldOfOrderUpdated::True) {
-            idx.replace(iter, orderInfoInOrdMgr);
-          }
-        }
+  //! 那么更新此订单
+  const auto isTheKeyFieldOfOrderUpdated = updateFunc(orderInfoInOrdMgr);
 
-      } else {
-        //! 继续尝试从已完结订单列表中获取
-        auto& idxOfClosed = orderInfoOfClosedGroup_
-                                ->template get<TagMarketCodeExchOrderIdOfOM>();
-        auto iterOfClosed = idxOfClosed.find(
-            std::make_tuple(orderInfoFromTDGW->marketCode_, hashOfExchOrderId));
-        if (iterOfClosed != std::end(idxOfClosed)) {
-          orderInfoInOrdMgr = *iterOfClosed;
-          LOG_I("Get order info from order info of closed group. {}",
-                orderInfoFromTDGW->toShortStr());
-
-          //! 那么更新此订单
-          std::tie(isTheOrderCanBeUsedCalcPos, isTheKeyFieldOfOrderUpdated) =
-              orderInfoInOrdMgr->updateByOrderInfoFromTDGW(orderInfoFromTDGW);
-
-          //! 如果索引字段发生变化，那么需要replace
-          if (isTheKeyFieldOfOrderUpdated ==
-              IsTheKeyFieldOfOrderUpdated::True) {
-            idxOfClosed.replace(iterOfClosed, orderInfoInOrdMgr);
-          }
+  //! 如果索引字段发生变化，那么需要重建索引
+  if (isTheKeyFieldOfOrderUpdated == IsTheKeyFieldOfOrderUpdated::True) {
+    idxOfClosed.modify(iterOfClosed, [](OrderInfoSPtr&) {});
+  }
+  return orderInfoInOrdMgr;
+}
 
-        } else {
-          LOG_I(
-              "Update by order info from exch failed, may be the rtn trade"
-              "of orders out of order and severly delayed. {}",
-              orderInfoFromTDGW->toShortStr());
-          return {isTheOrderCanBeUsedCalcPos, nullptr};
-        }
-      }
+//! 归档中的订单已经完结，很少会再有更新，更新之后重新追加到归档中
+template <typename... IndexTypes>
+template <typename UpdateFunc>
+OrderInfoSPtr OrdMgr<IndexTypes...>::updateByOrderInfoInArchive(
+    std::uint64_t hashOfExchOrderId, const OrderInfoSPtr& orderInfo,
+    const UpdateFunc& updateFunc) {
+  const auto orderInfoInArchive = orderInfoArchive_->update(
+      orderInfo->orderId_, orderInfo->marketCode_, hashOfExchOrderId,
+      [&](const OrderInfoSPtr& orderInfoInArchive) {
+        updateFunc(orderInfoInArchive);
+      });
+  if (orderInfoInArchive) {
+    LOG_I("Get order info from archive. {}", orderInfo->toShortStr());
+  }
+  return orderInfoInArchive;
+}
 
-      return {isTheOrderCanBeUsedCalcPos, orderInfoInOrdMgr};
+template <typename... IndexTypes>
+template <LockFunc lockFunc>
+void OrdMgr<IndexTypes...>::evictOrderInfoOfClosedGroup() {
+  std::size_t numOfOrderInfoToArchive = 0;
+  for (const auto& shard : shardGroup_) {
+    SPIN_LOCK(shard->mtxOrderInfoGroup_);
+    evictOrderInfoOfClosedGroupInShard(*shard, numOfOrderInfoToArchive);
+  }
+  if (numOfOrderInfoToArchive != 0) {
+    orderInfoArchive_->flushPending();
+  }
+}
 
-    } else {
-      return {isTheOrderCanBeUsedCalcPos, nullptr};
-    }
+template <typename... IndexTypes>
+template <LockFunc lockFunc>
+void OrdMgr<IndexTypes...>::evictIfRequested() {
+  if (isEvictionRequested_.load(std::memory_order_relaxed)) {
+    isEvictionRequested_.store(false, std::memory_order_relaxed);
+    evictOrderInfoOfClosedGroup<lockFunc>();
   }
+}
 
-  return {IsTheOrderCanBeUsedCalcPos::False, nullptr};
+//!
+//! 在分片锁内调用，超过数量上限的已完结订单从内存中淘汰；开启归档的时候完结
+//! 超过secOfKeepingClosedOrderInMem_秒的订单也会淘汰，淘汰的订单在锁释放之前
+//! 放入归档的待写入列表，这样查询和迟到的回报始终能找到该订单
+//!
+template <typename... IndexTypes>
+void OrdMgr<IndexTypes...>::evictOrderInfoOfClosedGroupInShard(
+    Shard& shard, std::size_t& numOfOrderInfoToArchive) {
+  const auto now = GetTotalUSSince1970();
+  const auto usOfKeeping =
+      static_cast<std::uint64_t>(secOfKeepingClosedOrderInMem_) * 1000 * 1000;
+  auto& idx = shard.orderInfoOfClosedGroup_.template get<TagClosedTimeOfOM>();
+  while (!idx.empty()) {
+    const auto iter = std::begin(idx);
+    if (idx.size() <= maxSizeOfOrderInfoOfClosedGroup_ &&
+        (!orderInfoArchive_ || (*iter)->closedTime_ + usOfKeeping > now)) {
+      break;
+    }
+    if (orderInfoArchive_) {
+      orderInfoArchive_->addToPending(*iter);
+      ++numOfOrderInfoToArchive;
+    }
+    idx.erase(iter);
+  }
 }
 
 template <typename... IndexTypes>
@@ -955,25 +1037,22 @@ bool OrdMgr<IndexTypes...>::compAndCheckIfUpdate(
     const OrderInfoSPtr& orderInfoFromExch) {
   int statusCode = 0;
   OrderInfoSPtr orderInfoInOrdMgr = nullptr;
-  {
-    SPIN_LOCK(mtxOrderInfoGroup_);
-    if (orderInfoFromExch->orderId_ != 0) {
-      //! 先通过orderInfoFromExch->orderId_查找订单
+  if (orderInfoFromExch->orderId_ != 0) {
+    //! 先通过orderInfoFromExch->orderId_查找订单
+    std::tie(statusCode, orderInfoInOrdMgr) =
+        getOrderInfo<lockFunc, DeepClone::False>(orderInfoFromExch->orderId_,
+                                                 QryFromClosedOrder::False,
+                                                 WriteLog::False);
+  }
+
+  //! 如果通过orderId没有获取到订单
+  if (!orderInfoInOrdMgr) {
+    if (orderInfoFromExch->exchOrderId_[0] != '\0' &&
+        orderInfoFromExch->marketCode_ != MarketCode::Others) {
       std::tie(statusCode, orderInfoInOrdMgr) =
-          getOrderInfo<LockFunc::False, DeepClone::False>(
-              orderInfoFromExch->orderId_, QryFromClosedOrder::False,
-              WriteLog::False);
-    }
-
-    //! 如果通过orderId没有获取到订单
-    if (!orderInfoInOrdMgr) {
-      if (orderInfoFromExch->exchOrderId_[0] != '\0' &&
-          orderInfoFromExch->marketCode_ != MarketCode::Others) {
-        std::tie(statusCode, orderInfoInOrdMgr) =
-            getOrderInfo<LockFunc::False, DeepClone::False>(
-                orderInfoFromExch->marketCode_, orderInfoFromExch->exchOrderId_,
-                QryFromClosedOrder::False, WriteLog::False);
-      }
+          getOrderInfo<lockFunc, DeepClone::False>(
+              orderInfoFromExch->marketCode_, orderInfoFromExch->exchOrderId_,
+              QryFromClosedOrder::False, WriteLog::False);
     }
   }
 
@@ -992,26 +1071,47 @@ bool OrdMgr<IndexTypes...>::compAndCheckIfUpdate(
 template <typename... IndexTypes>
 template <LockFunc lockFunc, DeepClone deepClone>
 std::vector<OrderInfoSPtr> OrdMgr<IndexTypes...>::getOrderInfoGroup(
-    const ConditionTemplate& conditionTemplate,
-    const ConditionFieldGroup& conditionFieldGroup) const {
+    const CompiledCondition& compiledCondition) const {
   std::vector<OrderInfoSPtr> ret;
-  {
-    SPIN_LOCK(mtxOrderInfoGroup_);
-    for (const auto& orderInfo : *orderInfoGroup_) {
-      //! 根据条件字段得到map类型的conditionValue
-      const auto conditionValue =
-          CreateConditioValue(orderInfo, conditionFieldGroup);
-      //! 比较两个map类型conditionValue, conditionTemplate
-      const auto [statusCode, statusMsg, matchCond] =
-          MatchConditionTemplate(conditionValue, conditionTemplate);
-      if (matchCond) {
-        if constexpr (deepClone == DeepClone::True) {
-          ret.emplace_back(std::make_shared<OrderInfo>(*orderInfo));
-        } else {
-          ret.emplace_back(orderInfo);
-        }
-      }
+  if (compiledCondition.neverMatch_) {
+    return ret;
+  }
+
+  const auto addIfMatch = [&](const OrderInfoSPtr& orderInfo) {
+    if (!MatchCompiledCondition(*orderInfo, compiledCondition)) {
+      return;
     }
+    if constexpr (deepClone == DeepClone::True) {
+      ret.emplace_back(makeOrderInfo(*orderInfo));
+    } else {
+      ret.emplace_back(orderInfo);
+    }
+  };
+
+  //! 条件模板固定了acctId的时候只需要查找一个分片，并且有联合索引的时候不需要
+  //! 遍历分片中所有订单
+  if (compiledCondition.isExact(ConditionField::AcctId)) {
+    const auto acctId = static_cast<AcctId>(
+        compiledCondition.getExactValue(ConditionField::AcctId));
+    auto& shard = getShard(acctId);
+    SPIN_LOCK(shard.mtxOrderInfoGroup_);
+    if constexpr ((std::is_same_v<IndexTypes, MIdxAcctIdAndSymInfoOfOM> ||
+                   ...)) {
+      const auto& idx =
+          shard.orderInfoGroup_.template get<TagAcctIdAndSymInfoOfOM>();
+      const auto range = EqualRangeOfAcctIdAndSymInfo(idx, compiledCondition);
+      std::for_each(range.first, range.second, addIfMatch);
+    } else {
+      std::for_each(std::begin(shard.orderInfoGroup_),
+                    std::end(shard.orderInfoGroup_), addIfMatch);
+    }
+    return ret;
+  }
+
+  for (const auto& shard : shardGroup_) {
+    SPIN_LOCK(shard->mtxOrderInfoGroup_);
+    std::for_each(std::begin(shard->orderInfoGroup_),
+                  std::end(shard->orderInfoGroup_), addIfMatch);
   }
   return ret;
 }
@@ -0,0 +1,117 @@
+/*!
+ * \file OrderInfoArchive.hpp
+ * \project BetterQuant
+ *
+ * \author byrnexu
+ * \date 2023/04/18
+ *
+ * \brief
+ */
+
+#pragma once
+
+#include "def/BQDef.hpp"
+#include "util/Pch.hpp"
+
+namespace bq {
+
+struct OrderInfo;
+using OrderInfoSPtr = std::shared_ptr<OrderInfo>;
+
+//! 归档索引默认保留最近追加的记录数量
+constexpr static std::size_t DEFAULT_MAX_NUM_OF_INDEXED_REC_IN_ARCHIVE =
+    256 * 1024;
+
+using UpdateFuncOfArchive = std::function<void(const OrderInfoSPtr& orderInfo)>;
+
+//!
+//! 已完结订单的磁盘归档，只追加不修改：
+//! 1. 每笔订单按sizeof(OrderInfo)定长写入文件，内存中只保留orderId和
+//!    marketCode + exchOrderId到记录号的索引；
+//! 2. 同一笔订单再次追加的时候索引指向最新的记录，旧记录不再使用；
+//! 3. 索引只保留最近追加的maxNumOfIndexedRec条记录，更早的订单从归档中查不到，
+//!    内存不随运行时间增长；
+//! 4. OrdMgr在分片锁内把淘汰的订单放入待写入列表，锁外再写入文件，待写入的
+//!    订单同样可以查询和更新；
+//! 5. 订单以数据库为准，归档文件只在本进程内有效，打开时清空，析构时删除。
+//!
+class OrderInfoArchive {
+ public:
+  OrderInfoArchive(const OrderInfoArchive&) = delete;
+  OrderInfoArchive& operator=(const OrderInfoArchive&) = delete;
+  OrderInfoArchive(const OrderInfoArchive&&) = delete;
+  OrderInfoArchive& operator=(const OrderInfoArchive&&) = delete;
+
+  explicit OrderInfoArchive(const std::string& dirOfArchive,
+                            std::size_t maxNumOfIndexedRec =
+                                DEFAULT_MAX_NUM_OF_INDEXED_REC_IN_ARCHIVE);
+  ~OrderInfoArchive();
+
+ public:
+  int open();
+
+  //! 在分片锁内调用，只放入待写入列表，不写文件
+  void addToPending(const OrderInfoSPtr& orderInfo);
+
+  //! 在分片锁外调用，把待写入列表中的订单追加到文件中
+  int flushPending();
+
+  //! 找不到的时候返回nullptr，返回的是归档记录的拷贝
+  OrderInfoSPtr get(OrderId orderId);
+  OrderInfoSPtr get(MarketCode marketCode, std::uint64_t hashOfExchOrderId);
+
+  //! orderId为0的时候按exchOrderId查找，找到之后在锁内更新并重新追加，
+  //! 返回更新之后的拷贝，找不到的时候返回nullptr
+  OrderInfoSPtr update(OrderId orderId, MarketCode marketCode,
+                       std::uint64_t hashOfExchOrderId,
+                       const UpdateFuncOfArchive& updateFunc);
+
+  //! 索引中的订单数量，不包括待写入的订单
+  std::size_t size() const;
+  const std::string& getPath() const { return path_; }
+
+ private:
+  int append(const OrderInfoSPtr& orderInfo);
+  OrderInfoSPtr read(std::uint64_t recNo);
+
+  OrderInfoSPtr find(OrderId orderId);
+  OrderInfoSPtr find(MarketCode marketCode, std::uint64_t hashOfExchOrderId);
+
+  static std::uint64_t GetKeyOfExchOrderId(MarketCode marketCode,
+                                           std::uint64_t hashOfExchOrderId) {
+    return hashOfExchOrderId ^
+           (static_cast<std::uint64_t>(marketCode) * 0x9E3779B97F4A7C15ULL);
+  }
+
+ private:
+  struct IndexedRec {
+    OrderId orderId_;
+    std::uint64_t keyOfExchOrderId_;
+    std::uint64_t recNo_;
+  };
+
+ private:
+  std::string dirOfArchive_;
+  const std::size_t maxNumOfIndexedRec_;
+  std::string path_;
+
+  std::fstream fs_;
+  std::uint64_t numOfRec_{0};
+
+  ankerl::unordered_dense::map<OrderId, std::uint64_t> orderId2RecNo_;
+  ankerl::unordered_dense::map<std::uint64_t, std::uint64_t>
+      exchOrderId2RecNo_;
+  //! 按追加顺序保存已索引的记录，超过上限的时候从最早的开始移出索引
+  std::deque<IndexedRec> indexedRecGroup_;
+
+  //! 待写入的订单按淘汰的先后顺序写入文件
+  std::vector<OrderInfoSPtr> pendingOrderGroup_;
+  ankerl::unordered_dense::map<OrderId, OrderInfoSPtr> orderId2PendingOrder_;
+  ankerl::unordered_dense::map<std::uint64_t, OrderInfoSPtr>
+      exchOrderId2PendingOrder_;
+
+  mutable std::mutex mtx_;
+};
+using OrderInfoArchiveSPtr = std::shared_ptr<OrderInfoArchive>;
+
+}  // namespace bq
@@ -0,0 +1,222 @@
+/*!
+ * \file OrderInfoArchive.cpp
+ * \project BetterQuant
+ *
+ * \author byrnexu
+ * \date 2023/04/18
+ *
+ * \brief
+ */
+
+#include "OrderInfoArchive.hpp"
+
+#include <unistd.h>
+
+#include "def/OrderInfo.hpp"
+#include "def/StatusCode.hpp"
+#include "util/Logger.hpp"
+
+namespace bq {
+
+OrderInfoArchive::OrderInfoArchive(const std::string& dirOfArchive,
+                                   std::size_t maxNumOfIndexedRec)
+    : dirOfArchive_(dirOfArchive),
+      maxNumOfIndexedRec_(std::max<std::size_t>(maxNumOfIndexedRec, 1)) {}
+
+OrderInfoArchive::~OrderInfoArchive() {
+  std::lock_guard<std::mutex> guard(mtx_);
+  if (fs_.is_open()) {
+    fs_.close();
+  }
+  if (!path_.empty()) {
+    boost::system::error_code ec;
+    boost::filesystem::remove(path_, ec);
+  }
+}
+
+int OrderInfoArchive::open() {
+  //! 同一个进程中可能有多个OrdMgr，文件名中加上实例序号
+  static std::atomic<std::uint32_t> instanceNo{0};
+
+  std::lock_guard<std::mutex> guard(mtx_);
+  try {
+    if (!boost::filesystem::exists(dirOfArchive_)) {
+      boost::filesystem::create_directories(dirOfArchive_);
+    }
+  } catch (const std::exception& e) {
+    LOG_W("Create directories {} failed. [{}]", dirOfArchive_, e.what());
+    return SCODE_ORD_MGR_OPEN_ARCHIVE_FAILED;
+  }
+
+  const auto path = boost::filesystem::path(dirOfArchive_) /
+                    fmt::format("OrdMgr-{}-{}.arc", ::getpid(), instanceNo++);
+  path_ = path.string();
+  fs_.open(path_, std::ios::binary | std::ios::in | std::ios::out |
+                      std::ios::trunc);
+  if (!fs_.is_open()) {
+    LOG_W("Open archive of order info {} failed.", path_);
+    return SCODE_ORD_MGR_OPEN_ARCHIVE_FAILED;
+  }
+
+  LOG_I("Open archive of order info {} success.", path_);
+  return 0;
+}
+
+void OrderInfoArchive::addToPending(const OrderInfoSPtr& orderInfo) {
+  std::lock_guard<std::mutex> guard(mtx_);
+  pendingOrderGroup_.emplace_back(orderInfo);
+  orderId2PendingOrder_[orderInfo->orderId_] = orderInfo;
+  if (orderInfo->hashOfExchOrderId_ != 0) {
+    exchOrderId2PendingOrder_[GetKeyOfExchOrderId(
+        orderInfo->marketCode_, orderInfo->hashOfExchOrderId_)] = orderInfo;
+  }
+}
+
+//! 写入和移出待写入列表在同一把锁内完成，查询不会两边都找不到
+int OrderInfoArchive::flushPending() {
+  std::lock_guard<std::mutex> guard(mtx_);
+  int ret = 0;
+  for (const auto& orderInfo : pendingOrderGroup_) {
+    if (const auto statusCode = append(orderInfo); statusCode != 0) {
+      ret = statusCode;
+    }
+  }
+  pendingOrderGroup_.clear();
+  orderId2PendingOrder_.clear();
+  exchOrderId2PendingOrder_.clear();
+  return ret;
+}
+
+OrderInfoSPtr OrderInfoArchive::get(OrderId orderId) {
+  std::lock_guard<std::mutex> guard(mtx_);
+  const auto orderInfo = find(orderId);
+  return orderInfo ? std::make_shared<OrderInfo>(*orderInfo) : nullptr;
+}
+
+OrderInfoSPtr OrderInfoArchive::get(MarketCode marketCode,
+                                    std::uint64_t hashOfExchOrderId) {
+  std::lock_guard<std::mutex> guard(mtx_);
+  const auto orderInfo = find(marketCode, hashOfExchOrderId);
+  return orderInfo ? std::make_shared<OrderInfo>(*orderInfo) : nullptr;
+}
+
+//! 待写入的订单直接在原记录上更新，之后随待写入列表一起写入文件
+OrderInfoSPtr OrderInfoArchive::update(OrderId orderId, MarketCode marketCode,
+                                       std::uint64_t hashOfExchOrderId,
+                                       const UpdateFuncOfArchive& updateFunc) {
+  std::lock_guard<std::mutex> guard(mtx_);
+  const auto orderInfo =
+      orderId != 0 ? find(orderId) : find(marketCode, hashOfExchOrderId);
+  if (!orderInfo) {
+    return nullptr;
+  }
+
+  updateFunc(orderInfo);
+  if (orderId2PendingOrder_.find(orderInfo->orderId_) !=
+      std::end(orderId2PendingOrder_)) {
+    return std::make_shared<OrderInfo>(*orderInfo);
+  }
+  append(orderInfo);
+  return orderInfo;
+}
+
+std::size_t OrderInfoArchive::size() const {
+  std::lock_guard<std::mutex> guard(mtx_);
+  return orderId2RecNo_.size();
+}
+
+int OrderInfoArchive::append(const OrderInfoSPtr& orderInfo) {
+  fs_.seekp(numOfRec_ * sizeof(OrderInfo));
+  fs_.write(reinterpret_cast<const char*>(orderInfo.get()), sizeof(OrderInfo));
+  if (!fs_) {
+    fs_.clear();
+    LOG_W("Append order info to archive {} failed. {}", path_,
+          orderInfo->toShortStr());
+    return SCODE_ORD_MGR_APPEND_TO_ARCHIVE_FAILED;
+  }
+
+  const auto recNo = numOfRec_++;
+  const auto keyOfExchOrderId =
+      orderInfo->hashOfExchOrderId_ == 0
+          ? 0
+          : GetKeyOfExchOrderId(orderInfo->marketCode_,
+                                orderInfo->hashOfExchOrderId_);
+  orderId2RecNo_[orderInfo->orderId_] = recNo;
+  if (keyOfExchOrderId != 0) {
+    exchOrderId2RecNo_[keyOfExchOrderId] = recNo;
+  }
+  indexedRecGroup_.emplace_back(
+      IndexedRec{orderInfo->orderId_, keyOfExchOrderId, recNo});
+
+  //! 同一笔订单重新追加之后索引已经指向新的记录，这里只移除仍然指向旧记录的
+  while (indexedRecGroup_.size() > maxNumOfIndexedRec_) {
+    const auto& indexedRec = indexedRecGroup_.front();
+    const auto iter = orderId2RecNo_.find(indexedRec.orderId_);
+    if (iter != std::end(orderId2RecNo_) &&
+        iter->second == indexedRec.recNo_) {
+      orderId2RecNo_.erase(iter);
+    }
+    if (indexedRec.keyOfExchOrderId_ != 0) {
+      const auto iter = exchOrderId2RecNo_.find(indexedRec.keyOfExchOrderId_);
+      if (iter != std::end(exchOrderId2RecNo_) &&
+          iter->second == indexedRec.recNo_) {
+        exchOrderId2RecNo_.erase(iter);
+      }
+    }
+    indexedRecGroup_.pop_front();
+  }
+  return 0;
+}
+
+OrderInfoSPtr OrderInfoArchive::read(std::uint64_t recNo) {
+  auto orderInfo = std::make_shared<OrderInfo>();
+  fs_.seekg(recNo * sizeof(OrderInfo));
+  fs_.read(reinterpret_cast<char*>(orderInfo.get()), sizeof(OrderInfo));
+  if (!fs_) {
+    fs_.clear();
+    LOG_W("Read order info from archive {} failed. [recNo = {}]", path_,
+          recNo);
+    return nullptr;
+  }
+  return orderInfo;
+}
+
+OrderInfoSPtr OrderInfoArchive::find(OrderId orderId) {
+  const auto iterOfPending = orderId2PendingOrder_.find(orderId);
+  if (iterOfPending != std::end(orderId2PendingOrder_)) {
+    return iterOfPending->second;
+  }
+
+  const auto iter = orderId2RecNo_.find(orderId);
+  if (iter == std::end(orderId2RecNo_)) {
+    return nullptr;
+  }
+  return read(iter->second);
+}
+
+OrderInfoSPtr OrderInfoArchive::find(MarketCode marketCode,
+                                     std::uint64_t hashOfExchOrderId) {
+  const auto keyOfExchOrderId =
+      GetKeyOfExchOrderId(marketCode, hashOfExchOrderId);
+
+  //! 索引中只有组合之后的哈希值，需要用记录中的原始字段确认
+  const auto matched = [&](const OrderInfoSPtr& orderInfo) {
+    return orderInfo && orderInfo->marketCode_ == marketCode &&
+           orderInfo->hashOfExchOrderId_ == hashOfExchOrderId;
+  };
+
+  const auto iterOfPending = exchOrderId2PendingOrder_.find(keyOfExchOrderId);
+  if (iterOfPending != std::end(exchOrderId2PendingOrder_) &&
+      matched(iterOfPending->second)) {
+    return iterOfPending->second;
+  }
+
+  const auto iter = exchOrderId2RecNo_.find(keyOfExchOrderId);
+  if (iter == std::end(exchOrderId2RecNo_)) {
+    return nullptr;
+  }
+  auto orderInfo = read(iter->second);
+  return matched(orderInfo) ? orderInfo : nullptr;
+}
+
+}  // namespace bq
@@ -29,6 +29,190 @@ TEST(test, test1) {
       OrdMgr<MIdxOrderIdOfOM, MIdxMarketCodeExchOrderIdOfOM>>();
 }
 
+TEST(test, testUpdateByOrderInfoFromTDGWWithShard) {
+  auto ordMgr = std::make_shared<
+      OrdMgr<MIdxOrderIdOfOM, MIdxMarketCodeExchOrderIdOfOM>>();
+  ordMgr->resetNumOfShard(4);
+  ordMgr->resetMemPool(16);
+  EXPECT_TRUE(ordMgr->getNumOfShard() == 4);
+
+  for (OrderId orderId = 1; orderId <= 8; ++orderId) {
+    auto orderInfo = std::make_shared<OrderInfo>();
+    orderInfo->orderId_ = orderId;
+    orderInfo->acctId_ = orderId;
+    orderInfo->marketCode_ = MarketCode::Binance;
+    orderInfo->orderStatus_ = OrderStatus::Created;
+    const auto ret = ordMgr->add<LockFunc::True, DeepClone::True>(orderInfo);
+    EXPECT_TRUE(ret == 0);
+  }
+
+  //! 交易所确认之后exchOrderId写入已有订单，需要能按exchOrderId查到
+  auto orderInfoFromTDGW = std::make_shared<OrderInfo>();
+  orderInfoFromTDGW->orderId_ = 3;
+  orderInfoFromTDGW->orderStatus_ = OrderStatus::ConfirmedByExch;
+  strcpy(orderInfoFromTDGW->exchOrderId_, "exchOrderId3");
+  ordMgr->updateByOrderInfoFromTDGW<LockFunc::True>(orderInfoFromTDGW);
+
+  const auto [statusCode, orderInfo] =
+      ordMgr->getOrderInfo<LockFunc::True, DeepClone::True>(
+          MarketCode::Binance, "exchOrderId3");
+  EXPECT_TRUE(statusCode == 0);
+  EXPECT_TRUE(orderInfo && orderInfo->orderId_ == 3);
+
+  //! 只有exchOrderId的撤单回报，订单完结之后移动到最近完结的订单列表中
+  orderInfoFromTDGW = std::make_shared<OrderInfo>();
+  orderInfoFromTDGW->marketCode_ = MarketCode::Binance;
+  orderInfoFromTDGW->orderStatus_ = OrderStatus::Canceled;
+  strcpy(orderInfoFromTDGW->exchOrderId_, "exchOrderId3");
+  const auto [isTheOrderCanBeUsedCalcPos, orderInfoInOrdMgr] =
+      ordMgr->updateByOrderInfoFromTDGW<LockFunc::True>(orderInfoFromTDGW);
+  EXPECT_TRUE(orderInfoInOrdMgr && orderInfoInOrdMgr->closed());
+
+  const auto [statusCodeOfOpen, orderInfoOfOpen] =
+      ordMgr->getOrderInfo<LockFunc::True, DeepClone::False>(
+          3, QryFromClosedOrder::False, WriteLog::False);
+  EXPECT_TRUE(statusCodeOfOpen != 0);
+  const auto [statusCodeOfClosed, orderInfoOfClosed] =
+      ordMgr->getOrderInfo<LockFunc::True, DeepClone::False>(
+          3, QryFromClosedOrder::True);
+  EXPECT_TRUE(statusCodeOfClosed == 0);
+  EXPECT_TRUE(ordMgr->getOrderIdGroupOfStg<LockFunc::True>().size() == 7);
+}
+
+TEST(test, testArchiveOfClosedOrder) {
+  auto ordMgr = std::make_shared<
+      OrdMgr<MIdxOrderIdOfOM, MIdxMarketCodeExchOrderIdOfOM>>();
+  ordMgr->resetNumOfShard(2);
+  ordMgr->resetSecOfKeepingClosedOrderInMem(0);
+  EXPECT_TRUE(ordMgr->enableArchive("data/archive/bqordmgr-test") == 0);
+
+  for (OrderId orderId = 1; orderId <= 4; ++orderId) {
+    auto orderInfo = std::make_shared<OrderInfo>();
+    orderInfo->orderId_ = orderId;
+    orderInfo->acctId_ = orderId;
+    orderInfo->marketCode_ = MarketCode::Binance;
+    orderInfo->orderStatus_ = OrderStatus::Created;
+    const auto ret = ordMgr->add<LockFunc::True, DeepClone::True>(orderInfo);
+    EXPECT_TRUE(ret == 0);
+  }
+
+  //! 订单完结之后立即从内存中淘汰并写入归档
+  auto orderInfoFromTDGW = std::make_shared<OrderInfo>();
+  orderInfoFromTDGW->orderId_ = 2;
+  orderInfoFromTDGW->orderStatus_ = OrderStatus::Canceled;
+  strcpy(orderInfoFromTDGW->exchOrderId_, "exchOrderId2");
+  ordMgr->updateByOrderInfoFromTDGW<LockFunc::True>(orderInfoFromTDGW);
+  EXPECT_TRUE(ordMgr->getSizeOfArchive() == 1);
+  EXPECT_TRUE(ordMgr->getOrderIdGroupOfStg<LockFunc::True>().size() == 3);
+
+  const auto [statusCodeOfOpen, orderInfoOfOpen] =
+      ordMgr->getOrderInfo<LockFunc::True, DeepClone::False>(
+          2, QryFromClosedOrder::False, WriteLog::False);
+  EXPECT_TRUE(statusCodeOfOpen != 0);
+
+  const auto [statusCode, orderInfo] =
+      ordMgr->getOrderInfo<LockFunc::True, DeepClone::False>(
+          2, QryFromClosedOrder::True);
+  EXPECT_TRUE(statusCode == 0);
+  EXPECT_TRUE(orderInfo && orderInfo->closed());
+
+  const auto [statusCodeOfExch, orderInfoOfExch] =
+      ordMgr->getOrderInfo<LockFunc::True, DeepClone::False>(
+          MarketCode::Binance, "exchOrderId2", QryFromClosedOrder::True);
+  EXPECT_TRUE(statusCodeOfExch == 0);
+  EXPECT_TRUE(orderInfoOfExch && orderInfoOfExch->orderId_ == 2);
+
+  //! 已归档订单的迟到回报仍然可以更新
+  orderInfoFromTDGW = std::make_shared<OrderInfo>();
+  orderInfoFromTDGW->marketCode_ = MarketCode::Binance;
+  orderInfoFromTDGW->orderStatus_ = OrderStatus::Canceled;
+  strcpy(orderInfoFromTDGW->exchOrderId_, "exchOrderId2");
+  const auto [isTheOrderCanBeUsedCalcPos, orderInfoInArchive] =
+      ordMgr->updateByOrderInfoFromTDGW<LockFunc::True>(orderInfoFromTDGW);
+  EXPECT_TRUE(orderInfoInArchive && orderInfoInArchive->orderId_ == 2);
+  EXPECT_TRUE(ordMgr->getSizeOfArchive() == 1);
+}
+
+TEST(test, testEvictionOfClosedOrder) {
+  using TestOrdMgr = OrdMgr<MIdxOrderIdOfOM, MIdxMarketCodeExchOrderIdOfOM>;
+  const auto addAndClose = [](const std::shared_ptr<TestOrdMgr>& ordMgr,
+                              OrderId orderId) {
+    auto orderInfo = std::make_shared<OrderInfo>();
+    orderInfo->orderId_ = orderId;
+    orderInfo->acctId_ = orderId;
+    orderInfo->orderStatus_ = OrderStatus::Created;
+    ordMgr->add<LockFunc::True, DeepClone::True>(orderInfo);
+    orderInfo->orderStatus_ = OrderStatus::Canceled;
+    ordMgr->updateByOrderInfoFromTDGW<LockFunc::True>(orderInfo);
+  };
+
+  //! 没有开启归档的时候不按时间淘汰
+  auto ordMgr = std::make_shared<TestOrdMgr>();
+  ordMgr->resetSecOfKeepingClosedOrderInMem(0);
+  addAndClose(ordMgr, 1);
+  ordMgr->evictOrderInfoOfClosedGroup<LockFunc::True>();
+  const auto [statusCode, orderInfo] =
+      ordMgr->getOrderInfo<LockFunc::True, DeepClone::False>(
+          1, QryFromClosedOrder::True);
+  EXPECT_TRUE(statusCode == 0);
+
+  //! 计划任务淘汰没有新订单完结的分片
+  ordMgr = std::make_shared<TestOrdMgr>();
+  ordMgr->resetNumOfShard(2);
+  EXPECT_TRUE(ordMgr->enableArchive("data/archive/bqordmgr-test") == 0);
+  addAndClose(ordMgr, 1);
+  EXPECT_TRUE(ordMgr->getSizeOfArchive() == 0);
+  ordMgr->resetSecOfKeepingClosedOrderInMem(0);
+  ordMgr->evictOrderInfoOfClosedGroup<LockFunc::True>();
+  EXPECT_TRUE(ordMgr->getSizeOfArchive() == 1);
+
+  //! 分片不加锁的OrdMgr在下一次添加订单的时候淘汰
+  ordMgr->resetSecOfKeepingClosedOrderInMem(3600);
+  addAndClose(ordMgr, 2);
+  EXPECT_TRUE(ordMgr->getSizeOfArchive() == 1);
+  ordMgr->resetSecOfKeepingClosedOrderInMem(0);
+  ordMgr->requestEviction();
+  auto orderInfoOfShard = std::make_shared<OrderInfo>();
+  orderInfoOfShard->orderId_ = 3;
+  orderInfoOfShard->orderStatus_ = OrderStatus::Created;
+  ordMgr->add<LockFunc::False, DeepClone::True>(orderInfoOfShard);
+  EXPECT_TRUE(ordMgr->getSizeOfArchive() == 2);
+}
+
+TEST(test, testOrderInfoArchive) {
+  OrderInfoArchive orderInfoArchive("data/archive/bqordmgr-test", 2);
+  EXPECT_TRUE(orderInfoArchive.open() == 0);
+
+  for (OrderId orderId = 1; orderId <= 3; ++orderId) {
+    auto orderInfo = std::make_shared<OrderInfo>();
+    orderInfo->orderId_ = orderId;
+    orderInfo->marketCode_ = MarketCode::Binance;
+    orderInfo->hashOfExchOrderId_ = orderId * 100;
+    orderInfo->orderStatus_ = OrderStatus::Canceled;
+    orderInfoArchive.addToPending(orderInfo);
+  }
+
+  //! 写入文件之前也能查到
+  EXPECT_TRUE(orderInfoArchive.size() == 0);
+  EXPECT_TRUE(orderInfoArchive.get(1) != nullptr);
+  EXPECT_TRUE(orderInfoArchive.get(MarketCode::Binance, 300) != nullptr);
+
+  //! 索引只保留最近追加的2条记录
+  EXPECT_TRUE(orderInfoArchive.flushPending() == 0);
+  EXPECT_TRUE(orderInfoArchive.size() == 2);
+  EXPECT_TRUE(orderInfoArchive.get(1) == nullptr);
+  EXPECT_TRUE(orderInfoArchive.get(MarketCode::Binance, 100) == nullptr);
+
+  //! 重新追加的订单不会因为旧记录移出索引而查不到
+  const auto orderInfo = orderInfoArchive.update(
+      2, MarketCode::Binance, 0,
+      [](const OrderInfoSPtr& orderInfo) { orderInfo->statusCode_ = 1; });
+  EXPECT_TRUE(orderInfo && orderInfo->statusCode_ == 1);
+  EXPECT_TRUE(orderInfoArchive.size() == 2);
+  EXPECT_TRUE(orderInfoArchive.get(2)->statusCode_ == 1);
+  EXPECT_TRUE(orderInfoArchive.get(3) != nullptr);
+}
+
 int main(int argc, char** argv) {
   testing::AddGlobalTestEnvironment(new global_event);
   testing::InitGoogleTest(&argc, argv);
@@ -26,6 +26,7 @@
 #include "util/Decimal.hpp"
 #include "util/Json.hpp"
 #include "util/Logger.hpp"
+#include "util/MemPool.hpp"
 #include "util/Pch.hpp"
 #include "util/StdExt.hpp"
 
@@ -44,16 +45,16 @@ namespace bq {
 struct StgInstInfo;
 using StgInstInfoSPtr = std::shared_ptr<StgInstInfo>;
 
+//! 仓位key的哈希值索引，只有精确查找，使用哈希索引
 struct TagMainOfPM {};
-struct KeyMainOfPM
-    : boost::multi_index::composite_key<
-          PosInfo, MIDX_MEMBER(PosInfo, std::uint64_t, keyHash_)> {};
-using MIdxMainOfPM = boost::multi_index::ordered_unique<
-    boost::multi_index::tag<TagMainOfPM>, KeyMainOfPM,
-    boost::multi_index::composite_key_result_less<KeyMainOfPM ::result_type>>;
+struct KeyMainOfPM : MIDX_MEMBER(PosInfo, std::uint64_t, keyHash_) {};
+using MIdxMainOfPM =
+    boost::multi_index::hashed_unique<boost::multi_index::tag<TagMainOfPM>,
+                                      KeyMainOfPM>;
 
 //! acctId + marketCode + symbolType + symbolCode 联合索引，
-//! 用于查找某个品种的开仓数量信息
+//! 用于查找某个品种的开仓数量信息，条件查询的时候需要按前缀做范围查找，
+//! 因此保留有序索引
 struct TagAcctIdAndSymInfoOfPM {};
 struct KeyAcctIdAndSymInfoOfPM
     : boost::multi_index::composite_key<
@@ -66,7 +67,7 @@ using MIdxAcctIdAndSymInfoOfPM = boost::multi_index::ordered_non_unique<
     boost::multi_index::composite_key_result_less<
         KeyAcctIdAndSymInfoOfPM ::result_type>>;
 
-//! StgInstId 层面索引
+//! StgInstId 层面索引，只按完整的key查找，使用哈希索引
 struct TagStgInstIdOfPM {};
 struct KeyStgInstIdOfPM
     : boost::multi_index::composite_key<
@@ -74,16 +75,30 @@ struct KeyStgInstIdOfPM
           MIDX_MEMBER(PosInfo, UserId, userId_),
           MIDX_MEMBER(PosInfo, StgId, stgId_),
           MIDX_MEMBER(PosInfo, StgInstId, stgInstId_)> {};
-using MIdxStgInstIdOfPM = boost::multi_index::ordered_non_unique<
+using MIdxStgInstIdOfPM = boost::multi_index::hashed_non_unique<
     boost::multi_index::tag<TagStgInstIdOfPM>, KeyStgInstIdOfPM,
-    boost::multi_index::composite_key_result_less<
+    boost::multi_index::composite_key_result_hash<
+        KeyStgInstIdOfPM ::result_type>,
+    boost::multi_index::composite_key_result_equal_to<
         KeyStgInstIdOfPM ::result_type>>;
 
+//! allocate_shared分配的内存块中除了PosInfo还有虚表指针、引用计数和分配器
+constexpr static std::size_t EXTRA_SIZE_OF_POS_INFO_IN_MEM_POOL = 64;
+
 template <typename... IndexTypes>
 class PosMgr {
   using PosInfoTable = boost::multi_index::multi_index_container<
       PosInfoSPtr, boost::multi_index::indexed_by<IndexTypes...>>;
-  using PosInfoTableSPtr = std::shared_ptr<PosInfoTable>;
+
+  //!
+  //! 按acctId分片，每个分片有各自的仓位表和锁，不同账户的仓位更新不会竞争
+  //! 同一把锁；按策略或者全量查询的时候需要依次查找各个分片。默认只有一个分片。
+  //!
+  struct alignas(CACHE_LINE_SIZE) Shard {
+    PosInfoTable posInfoTable_;
+    mutable std::ext::spin_mutex mtxPosInfoTable_;
+  };
+  using ShardUPtr = std::unique_ptr<Shard>;
 
  public:
   PosMgr(const PosMgr&) = delete;
@@ -99,6 +114,14 @@ class PosMgr {
 
   void setSyncToDB(SyncToDB value) { syncToDB_ = value; }
 
+  //! 只能在添加仓位之前调用，分片数为0的时候按1处理
+  void resetNumOfShard(std::uint32_t value);
+
+  //! numOfBlock为0的时候不使用内存池
+  void resetMemPool(std::size_t numOfBlock);
+
+  std::size_t getNumOfShard() const { return shardGroup_.size(); }
+
  private:
   int initPosInfoTable(const std::string& sql);
 
@@ -153,8 +176,7 @@ class PosMgr {
  public:
   template <LockFunc lockFunc, DeepClone deepClone>
   PosInfoGroup getPosInfoGroup(
-      const ConditionTemplate& ConditionTemplate,
-      const ConditionFieldGroup& conditionFieldGroup) const;
+      const CompiledCondition& compiledCondition) const;
 
  public:
   template <LockFunc lockFunc>
@@ -172,22 +194,40 @@ class PosMgr {
  private:
   void addPosInfo(const PosInfoSPtr& posInfo);
 
+  std::size_t getShardNo(AcctId acctId) const {
+    return shardGroup_.size() == 1 ? 0 : acctId % shardGroup_.size();
+  }
+  Shard& getShard(AcctId acctId) const {
+    return *shardGroup_[getShardNo(acctId)];
+  }
+
+  PosInfoSPtr makePosInfo(const PosInfo& posInfo) const {
+    if (!memPoolOfPosInfo_) {
+      return std::make_shared<PosInfo>(posInfo);
+    }
+    return std::allocate_shared<PosInfo>(
+        MemPoolAllocator<PosInfo>(memPoolOfPosInfo_), posInfo);
+  }
+
  private:
   YAML::Node node_;
 
   db::DBEngSPtr dbEng_{nullptr};
   SyncToDB syncToDB_{SyncToDB::True};
 
-  PosInfoTableSPtr posInfoTable_{nullptr};
-  mutable std::ext::spin_mutex mtxPosInfoTable_;
+  std::vector<ShardUPtr> shardGroup_;
+
+  //! 深拷贝出来的仓位从内存池中分配，池耗尽的时候退回堆上分配
+  FixedSizeMemPoolSPtr memPoolOfPosInfo_{nullptr};
 };
 
 template <typename... IndexTypes>
 using PosMgrSPtr = std::shared_ptr<PosMgr<IndexTypes...>>;
 
 template <typename... IndexTypes>
-PosMgr<IndexTypes...>::PosMgr()
-    : posInfoTable_(std::make_shared<PosInfoTable>()) {}
+PosMgr<IndexTypes...>::PosMgr() {
+  resetNumOfShard(1);
+}
 
 template <typename... IndexTypes>
 int PosMgr<IndexTypes...>::init(const YAML::Node& node,
@@ -196,6 +236,9 @@ int PosMgr<IndexTypes...>::init(const YAML::Node& node,
   node_ = node;
   dbEng_ = dbEng;
 
+  resetNumOfShard(node["posMgr"]["numOfShard"].as<std::uint32_t>(1));
+  resetMemPool(node["posMgr"]["numOfPooledPosInfo"].as<std::size_t>(1024));
+
   const auto ret = initPosInfoTable(sql);
   if (ret != 0) {
     LOG_W("Init failed. [{}]", sql);
@@ -204,6 +247,25 @@ int PosMgr<IndexTypes...>::init(const YAML::Node& node,
   return 0;
 }
 
+template <typename... IndexTypes>
+void PosMgr<IndexTypes...>::resetNumOfShard(std::uint32_t value) {
+  if (value == 0) value = 1;
+  shardGroup_.clear();
+  for (std::uint32_t i = 0; i < value; ++i) {
+    shardGroup_.emplace_back(std::make_unique<Shard>());
+  }
+}
+
+template <typename... IndexTypes>
+void PosMgr<IndexTypes...>::resetMemPool(std::size_t numOfBlock) {
+  if (numOfBlock == 0) {
+    memPoolOfPosInfo_.reset();
+    return;
+  }
+  memPoolOfPosInfo_ = std::make_shared<FixedSizeMemPool>(
+      sizeof(PosInfo) + EXTRA_SIZE_OF_POS_INFO_IN_MEM_POOL, numOfBlock);
+}
+
 template <typename... IndexTypes>
 int PosMgr<IndexTypes...>::initPosInfoTable(const std::string& sql) {
   const auto [ret, tblRecSet] =
@@ -218,7 +280,8 @@ int PosMgr<IndexTypes...>::initPosInfoTable(const std::string& sql) {
     const auto posInfo = MakePosInfo(recPosInfo);
     addPosInfo(posInfo);
   }
-  LOG_I("Init pos info group success. [size = {}]", posInfoTable_->size());
+  LOG_I("Init pos info group success. [size = {}; numOfShard = {}]",
+        tblRecSet->size(), shardGroup_.size());
 
   return 0;
 }
@@ -226,8 +289,10 @@ int PosMgr<IndexTypes...>::initPosInfoTable(const std::string& sql) {
 template <typename... IndexTypes>
 std::string PosMgr<IndexTypes...>::toStr() const {
   std::vector<std::string> strGrp;
-  for (const auto& rec : *posInfoTable_) {
-    strGrp.emplace_back(rec->toStr());
+  for (const auto& shard : shardGroup_) {
+    for (const auto& rec : shard->posInfoTable_) {
+      strGrp.emplace_back(rec->toStr());
+    }
   }
   std::sort(strGrp.begin(), strGrp.end());
 
@@ -314,7 +379,8 @@ PosChgInfoSPtr PosMgr<IndexTypes...>::updateByOrderInfoFromTDGW(
   //!
 
   {
-    SPIN_LOCK(mtxPosInfoTable_);
+    auto& shard = getShard(orderInfo->acctId_);
+    SPIN_LOCK(shard.mtxPosInfoTable_);
 
     if (orderInfo->symbolType_ == SymbolType::Spot ||
         orderInfo->symbolType_ == SymbolType::Perp ||
@@ -379,7 +445,8 @@ PosChgInfoSPtr PosMgr<IndexTypes...>::updateByOrderInfoSinglePosSideOfBid(
 
   PosInfoSPtr origPosInfoOfBid;
   PosInfoSPtr origPosInfoOfAsk;
-  auto& idx = posInfoTable_->template get<TagMainOfPM>();
+  auto& idx =
+      getShard(orderInfo->acctId_).posInfoTable_.template get<TagMainOfPM>();
 
   //! 获取当前合约多头仓位，如果没有生成一条0仓位记录
   const auto posKeyOfBid = orderInfo->getPosKeyOfBid();
@@ -475,7 +542,8 @@ PosChgInfoSPtr PosMgr<IndexTypes...>::updateByOrderInfoSinglePosSideOfAsk(
 
   PosInfoSPtr origPosInfoOfBid;
   PosInfoSPtr origPosInfoOfAsk;
-  auto& idx = posInfoTable_->template get<TagMainOfPM>();
+  auto& idx =
+      getShard(orderInfo->acctId_).posInfoTable_.template get<TagMainOfPM>();
 
   //! 获取当前合约多头仓位，如果没有生成一条0仓位记录
   const auto posKeyOfBid = orderInfo->getPosKeyOfBid();
@@ -607,7 +675,8 @@ PosChgInfoSPtr PosMgr<IndexTypes...>::updateByOrderInfoDoublePosSideOfBidLong(
   auto ret = std::make_shared<PosChgInfo>();
 
   //! 先获取目前仓位
-  auto& idx = posInfoTable_->template get<TagMainOfPM>();
+  auto& idx =
+      getShard(orderInfo->acctId_).posInfoTable_.template get<TagMainOfPM>();
   const auto posKey = orderInfo->getPosKey();
   const auto posKeyHash = XXH3_64bits(posKey.data(), posKey.size());
   auto iter = idx.find(posKeyHash);
@@ -647,7 +716,8 @@ PosChgInfoSPtr PosMgr<IndexTypes...>::updateByOrderInfoDoublePosSideOfAskLong(
   auto ret = std::make_shared<PosChgInfo>();
 
   //! 先获取目前多头仓位
-  auto& idx = posInfoTable_->template get<TagMainOfPM>();
+  auto& idx =
+      getShard(orderInfo->acctId_).posInfoTable_.template get<TagMainOfPM>();
   const auto posKeyOfBid = orderInfo->getPosKeyOfBid();
   const auto posKeyOfBidHash =
       XXH3_64bits(posKeyOfBid.data(), posKeyOfBid.size());
@@ -689,7 +759,8 @@ PosChgInfoSPtr PosMgr<IndexTypes...>::updateByOrderInfoDoublePosSideOfAskShort(
   auto ret = std::make_shared<PosChgInfo>();
 
   //! 先获取目前仓位
-  auto& idx = posInfoTable_->template get<TagMainOfPM>();
+  auto& idx =
+      getShard(orderInfo->acctId_).posInfoTable_.template get<TagMainOfPM>();
   const auto posKey = orderInfo->getPosKey();
   const auto posKeyHash = XXH3_64bits(posKey.data(), posKey.size());
   auto iter = idx.find(posKeyHash);
@@ -728,7 +799,8 @@ PosChgInfoSPtr PosMgr<IndexTypes...>::updateByOrderInfoDoublePosSideOfBidShort(
   auto ret = std::make_shared<PosChgInfo>();
 
   //! 先获取目前空头仓位
-  auto& idx = posInfoTable_->template get<TagMainOfPM>();
+  auto& idx =
+      getShard(orderInfo->acctId_).posInfoTable_.template get<TagMainOfPM>();
   const auto posKeyOfAsk = orderInfo->getPosKeyOfAsk();
   const auto posKeyOfAskHash =
       XXH3_64bits(posKeyOfAsk.data(), posKeyOfAsk.size());
@@ -846,10 +918,10 @@ template <typename... IndexTypes>
 template <LockFunc lockFunc>
 PosInfoGroup PosMgr<IndexTypes...>::getPosInfoGroup() const {
   PosInfoGroup ret;
-  {
-    SPIN_LOCK(mtxPosInfoTable_);
-    for (const auto& posInfo : *posInfoTable_) {
-      ret.emplace_back(std::make_shared<PosInfo>(*posInfo));
+  for (const auto& shard : shardGroup_) {
+    SPIN_LOCK(shard->mtxPosInfoTable_);
+    for (const auto& posInfo : shard->posInfoTable_) {
+      ret.emplace_back(makePosInfo(*posInfo));
     }
   }
   return ret;
@@ -866,12 +938,13 @@ PosInfoGroup PosMgr<IndexTypes...>::getPosInfoGroup(
   const auto key =
       std::make_tuple(acctId, marketCode, symbolType, hashOfSymbolCode);
   {
-    SPIN_LOCK(mtxPosInfoTable_);
-    auto& idx = posInfoTable_->template get<TagAcctIdAndSymInfoOfPM>();
+    auto& shard = getShard(acctId);
+    SPIN_LOCK(shard.mtxPosInfoTable_);
+    auto& idx = shard.posInfoTable_.template get<TagAcctIdAndSymInfoOfPM>();
     const auto range = idx.equal_range(key);
     for (auto iter = range.first; iter != range.second; ++iter) {
       if constexpr (deepClone == DeepClone::True) {
-        ret.emplace_back(std::make_shared<PosInfo>(**iter));
+        ret.emplace_back(makePosInfo(**iter));
       } else {
         ret.emplace_back(*iter);
       }
@@ -888,13 +961,13 @@ PosInfoGroup PosMgr<IndexTypes...>::getPosInfoGroupOfStgInst(
   const auto key =
       std::make_tuple(stgInstInfo->productId_, stgInstInfo->userId_,
                       stgInstInfo->stgId_, stgInstInfo->stgInstId_);
-  {
-    SPIN_LOCK(mtxPosInfoTable_);
-    auto& idx = posInfoTable_->template get<TagStgInstIdOfPM>();
+  for (const auto& shard : shardGroup_) {
+    SPIN_LOCK(shard->mtxPosInfoTable_);
+    auto& idx = shard->posInfoTable_.template get<TagStgInstIdOfPM>();
     const auto range = idx.equal_range(key);
     for (auto iter = range.first; iter != range.second; ++iter) {
       if constexpr (deepClone == DeepClone::True) {
-        ret.emplace_back(std::make_shared<PosInfo>(**iter));
+        ret.emplace_back(makePosInfo(**iter));
       } else {
         ret.emplace_back(*iter);
       }
@@ -906,26 +979,47 @@ PosInfoGroup PosMgr<IndexTypes...>::getPosInfoGroupOfStgInst(
 template <typename... IndexTypes>
 template <LockFunc lockFunc, DeepClone deepClone>
 PosInfoGroup PosMgr<IndexTypes...>::getPosInfoGroup(
-    const ConditionTemplate& conditionTemplate,
-    const ConditionFieldGroup& conditionFieldGroup) const {
+    const CompiledCondition& compiledCondition) const {
   PosInfoGroup ret;
-  {
-    SPIN_LOCK(mtxPosInfoTable_);
-    for (const auto& posInfo : *posInfoTable_) {
-      //! 根据条件字段得到map类型的conditionValue
-      const auto conditionValue =
-          CreateConditioValue(posInfo, conditionFieldGroup);
-      //! 比较两个map类型conditionValue, conditionTemplate
-      const auto [statusCode, statusMsg, matchCond] =
-          MatchConditionTemplate(conditionValue, conditionTemplate);
-      if (matchCond) {
-        if constexpr (deepClone == DeepClone::True) {
-          ret.emplace_back(std::make_shared<PosInfo>(*posInfo));
-        } else {
-          ret.emplace_back(posInfo);
-        }
-      }
+  if (compiledCondition.neverMatch_) {
+    return ret;
+  }
+
+  const auto addIfMatch = [&](const PosInfoSPtr& posInfo) {
+    if (!MatchCompiledCondition(*posInfo, compiledCondition)) {
+      return;
+    }
+    if constexpr (deepClone == DeepClone::True) {
+      ret.emplace_back(makePosInfo(*posInfo));
+    } else {
+      ret.emplace_back(posInfo);
     }
+  };
+
+  //! 条件模板固定了acctId的时候只需要查找一个分片，并且有联合索引的时候不需要
+  //! 遍历分片中所有仓位
+  if (compiledCondition.isExact(ConditionField::AcctId)) {
+    const auto acctId = static_cast<AcctId>(
+        compiledCondition.getExactValue(ConditionField::AcctId));
+    auto& shard = getShard(acctId);
+    SPIN_LOCK(shard.mtxPosInfoTable_);
+    if constexpr ((std::is_same_v<IndexTypes, MIdxAcctIdAndSymInfoOfPM> ||
+                   ...)) {
+      const auto& idx =
+          shard.posInfoTable_.template get<TagAcctIdAndSymInfoOfPM>();
+      const auto range = EqualRangeOfAcctIdAndSymInfo(idx, compiledCondition);
+      std::for_each(range.first, range.second, addIfMatch);
+    } else {
+      std::for_each(std::begin(shard.posInfoTable_),
+                    std::end(shard.posInfoTable_), addIfMatch);
+    }
+    return ret;
+  }
+
+  for (const auto& shard : shardGroup_) {
+    SPIN_LOCK(shard->mtxPosInfoTable_);
+    std::for_each(std::begin(shard->posInfoTable_),
+                  std::end(shard->posInfoTable_), addIfMatch);
   }
   return ret;
 }
@@ -942,8 +1036,9 @@ Decimal PosMgr<IndexTypes...>::getHoldPos(const OrderInfoSPtr& orderInfo,
                                    orderInfo->symbolType_, hashOfSymbolCode);
   //! 如果下的多单，那么可借用的是空头头寸，如果下的是空单，那么可借用的是多头头寸
   {
-    SPIN_LOCK(mtxPosInfoTable_);
-    auto& idx = posInfoTable_->template get<TagAcctIdAndSymInfoOfPM>();
+    auto& shard = getShard(acctId);
+    SPIN_LOCK(shard.mtxPosInfoTable_);
+    auto& idx = shard.posInfoTable_.template get<TagAcctIdAndSymInfoOfPM>();
     const auto range = idx.equal_range(key);
     for (auto iter = range.first; iter != range.second; ++iter) {
       const auto& posInfo = *iter;
@@ -973,7 +1068,7 @@ void PosMgr<IndexTypes...>::addPosInfo(const PosInfoSPtr& posInfo) {
     posInfo->hashOfSymbolCode_ =
         XXH3_64bits(posInfo->symbolCode_, strlen(posInfo->symbolCode_));
   }
-  posInfoTable_->emplace(posInfo);
+  getShard(posInfo->acctId_).posInfoTable_.emplace(posInfo);
 }
 
 }  // namespace bq
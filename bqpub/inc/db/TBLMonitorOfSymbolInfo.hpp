@@ -14,6 +14,7 @@
 #include "db/TBLSymbolInfo.hpp"
 #include "def/StatusCode.hpp"
 #include "util/StdExt.hpp"
+#include "util/SymbolRegistry.hpp"
 
 namespace bq::db {
 
@@ -125,6 +126,7 @@ class TBLMonitorOfSymbolInfo : public TBLMonitor<TBLSymbolInfo> {
         auto symbolInfo = tblRec.second->getRecWithAllFields();
         symbolInfo->initHashInfo();
         midxSymbolInfo_.emplace(symbolInfo);
+        internToSymbolRegistry(symbolInfo);
         LOG_D(fmt::format(
             "Add rec {} - {} to tbl symbol info of cache. "
             "hashOfMktSym: {}, hashOfMktSymExchSym: {}",
@@ -163,6 +165,7 @@ class TBLMonitorOfSymbolInfo : public TBLMonitor<TBLSymbolInfo> {
         auto item = rec.second->getRecWithAllFields();
         item->initHashInfo();
         midxSymbolInfo_.emplace(item);
+        internToSymbolRegistry(item);
       }
 
       for (auto& rec : *tblRecSetDel) {
@@ -175,10 +178,27 @@ class TBLMonitorOfSymbolInfo : public TBLMonitor<TBLSymbolInfo> {
         auto item = rec.second->getRecWithAllFields();
         item->initHashInfo();
         midxSymbolInfo_.emplace(item);
+        internToSymbolRegistry(item);
       }
     }
   }
 
+  //! 删除的品种不从注册表中删除，已经分配的InternedSymbolId始终有效
+  static void internToSymbolRegistry(const RecSymbolInfoSPtr& symbolInfo) {
+    const auto symbolType =
+        magic_enum::enum_cast<SymbolType>(symbolInfo->symbolType);
+    if (!symbolType.has_value()) {
+      LOG_W("Intern {} - {} to symbol registry failed because of invalid "
+            "symbol type {}.",
+            symbolInfo->marketCode, symbolInfo->symbolCode,
+            symbolInfo->symbolType);
+      return;
+    }
+    SymbolRegistry::get_mutable_instance().intern(
+        GetMarketCode(symbolInfo->marketCode), symbolType.value(),
+        symbolInfo->symbolCode, symbolInfo->exchSymbolCode);
+  }
+
  private:
   MIDXSymbolInfo midxSymbolInfo_;
   mutable std::ext::spin_mutex mtxMIDXSymbolInfo_;
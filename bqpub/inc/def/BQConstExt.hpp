@@ -53,6 +53,8 @@ enum class TableChgType { Add = 1, Del = 2, Chg = 3 };
 const static std::size_t MAX_TD_SRV_RISK_PLUGIN_NUM = 32;
 
 const static std::string HIS_MD_FILE_EXT = "dat";
+const static std::string HIS_MD_BIN_FILE_EXT = "bin";
+const static std::string HIS_MD_BIN_INDEX_EXT = "idx";
 const static std::string HIS_MD_INDEX_BY_ET_EXT = "et";
 const static std::string HIS_MD_INDEX_BY_LT_EXT = "lt";
 
@@ -66,6 +68,7 @@ const static std::string TBENG_ORIG_DATA_TABLE_NAME_SUFFIX = "origData";
 const static std::string TBENG_TABLE_NAME_OF_ORIG_MD = "origData";
 
 const static std::uint64_t DBL_TO_INT_MULTI = 1000000000000;
+const static std::uint32_t PRECISION_OF_DBL_TO_INT_MULTI = 12;
 const static std::uint64_t DBL_PREC_FOR_ORDER = 10;
 const static std::uint64_t DBL_PREC_FOR_PRINT = 10;
 
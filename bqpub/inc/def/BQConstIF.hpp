@@ -242,6 +242,8 @@ constexpr static std::uint32_t MAX_DEPTH_LEVEL = 400;
 constexpr static std::uint32_t MAX_DEPTH_LEVEL_OF_CN = 10;
 constexpr static std::uint32_t MAX_DEPTH_LEVEL_IN_TICKER = 10;
 
+constexpr static std::uint32_t INVALID_SYMBOL_ID = UINT32_MAX;
+
 const static std::string SEP_OF_DEPTH_FIELDS = ",";
 const static std::string SEP_OF_DEPTH_REC = ";";
 
@@ -263,6 +265,14 @@ const static std::string TOPIC_PREFIX_OF_MARKET_DATA = "MD";
 const static std::string TOPIC_PREFIX_OF_TRADE_DATA = "TD";
 const static std::string SEP_OF_TOPIC = "@";
 
+//! 风控服务发布全部仓位的关键帧和增量
+const static std::string TOPIC_OF_POS_INFO_OF_ALL =
+    "RISK@PubChannel@Trade@PosInfo@All";
+
+//! 风控服务按盈亏监控条件计算好的盈亏，交易服务的盈亏监控插件从中读取
+const static std::string SEGMENT_OF_PNL_TABLE_OF_CONDITION =
+    "RISK-PNL-TABLE-OF-CONDITION.dat";
+
 const static std::string SEP_OF_SYMBOL_SPOT = "-";
 const static std::string SEP_OF_SYMBOL_FUTURES = "-";
 const static std::string SEP_OF_SYMBOL_PERP = "-";
@@ -42,6 +42,8 @@ using TrdAcctId = std::uint32_t;
 
 using OrderId = std::uint64_t;
 
+using SymbolId = std::uint32_t;
+
 struct MDHeader {
   std::uint64_t exchTs_;
   std::uint64_t localTs_;
@@ -49,6 +51,9 @@ struct MDHeader {
   SymbolType symbolType_;
   char symbolCode_[MAX_SYMBOL_CODE_LEN];
   MDType mdType_;
+  //! 开启时延追踪的时候为行情服务收到和发布这条行情时的tsc
+  std::uint64_t tscOfRecv_{0};
+  std::uint64_t tscOfPub_{0};
   std::string toStr() const;
   std::string getTopicPrefix() const;
   std::string toJson() const;
@@ -28,4 +28,113 @@ using ConditionTemplate = std::map<std::string, std::string>;
 //! map of {{"acctId":"10000"}, {"marketCode":"SSE"}}
 using ConditionValue = std::map<std::string, std::string>;
 
+//! 条件字段编号，ConditionKey中的值按照字段编号从小到大依次存放
+enum class ConditionField : std::uint8_t {
+  ProductGrpId = 0,
+  ProductId,
+  UserId,
+  AcctGrpId,
+  AcctId,
+  TrdAcctId,
+  StgGrpId,
+  StgId,
+  StgInstId,
+  AlgoId,
+  MarketCode,
+  SymbolType,
+  SymbolCode,
+  Side,
+  PosDirection,
+  PosSide,
+  ParValue,
+  OrderType,
+  OrderTypeExtra,
+  FeeCurrency,
+  Max
+};
+
+constexpr static std::size_t MAX_NUM_OF_CONDITION_FIELD =
+    static_cast<std::size_t>(ConditionField::Max);
+
+//! ["acctId", "marketCode"] -> (1 << AcctId) | (1 << MarketCode)
+using ConditionFieldMask = std::uint32_t;
+
+inline ConditionFieldMask MaskOf(ConditionField field) {
+  return 1U << static_cast<std::uint32_t>(field);
+}
+
+//!
+//! 编译后的条件值：字段掩码加上按字段编号排列的整数元组，
+//! 整数字段和枚举直接存值，symbolCode、parValue和feeCurrency存字符串形式
+//! 的XXH3哈希值。
+//! 构建、比较和哈希都不需要分配内存，用来代替ConditionValue和
+//! conditionValueInStrFmt作为流控状态等容器的键值。
+//!
+struct ConditionKey {
+  ConditionFieldMask fieldMask_{0};
+  std::uint32_t num_{0};
+  std::array<std::uint64_t, MAX_NUM_OF_CONDITION_FIELD> valueGroup_{};
+
+  bool operator==(const ConditionKey& rhs) const {
+    return fieldMask_ == rhs.fieldMask_ &&
+           std::memcmp(valueGroup_.data(), rhs.valueGroup_.data(),
+                       num_ * sizeof(std::uint64_t)) == 0;
+  }
+
+  std::uint64_t hash() const {
+    return XXH3_64bits_withSeed(valueGroup_.data(),
+                                num_ * sizeof(std::uint64_t), fieldMask_);
+  }
+
+  std::string toStr() const;
+};
+
+struct ConditionKeyHash {
+  using is_avalanching = void;
+  std::uint64_t operator()(const ConditionKey& conditionKey) const noexcept {
+    return conditionKey.hash();
+  }
+};
+
+//!
+//! 编译后的条件模板，比如 acctId=10000&marketCode=*&symbolCode=IF* 编译成：
+//! 1. fieldMask_ 模板中出现的所有字段；
+//! 2. exactMask_ 被固定为精确值的字段，也就是 acctId，对应的值在exactKey_中；
+//! 3. 空值和*不参与比较，前缀通配符比如 IF* 放在prefixGroup_中单独处理。
+//! 匹配的时候只是对整数元组做异或和按位与，没有分支和内存分配。
+//!
+struct CompiledCondition {
+  ConditionFieldMask fieldMask_{0};
+  ConditionFieldMask exactMask_{0};
+  ConditionKey exactKey_;
+  std::array<std::uint64_t, MAX_NUM_OF_CONDITION_FIELD> cmpMaskGroup_{};
+  std::vector<std::pair<ConditionField, std::string>> prefixGroup_;
+
+  //! 模板中某个字段的值不合法，比如 acctId=abc，那么任何记录都不匹配
+  bool neverMatch_{false};
+
+  bool isExact(ConditionField field) const {
+    return (exactMask_ & MaskOf(field)) != 0;
+  }
+
+  //! 返回精确字段在exactKey_中的值，调用前需要先用isExact判断
+  std::uint64_t getExactValue(ConditionField field) const {
+    const auto lowerMask = MaskOf(field) - 1;
+    const auto pos = __builtin_popcount(fieldMask_ & lowerMask);
+    return exactKey_.valueGroup_[pos];
+  }
+
+  //! 仅比较整数元组，conditionKey必须是用fieldMask_生成的
+  bool matchExactField(const ConditionKey& conditionKey) const {
+    std::uint64_t diff = conditionKey.fieldMask_ ^ fieldMask_;
+    for (std::uint32_t i = 0; i < exactKey_.num_; ++i) {
+      diff |= (conditionKey.valueGroup_[i] ^ exactKey_.valueGroup_[i]) &
+              cmpMaskGroup_[i];
+    }
+    return diff == 0 && !neverMatch_;
+  }
+
+  std::string toStr() const;
+};
+
 }  // namespace bq
@@ -20,6 +20,9 @@ namespace bq {
 struct OrderInfo;
 using OrderInfoSPtr = std::shared_ptr<OrderInfo>;
 
+struct PosInfo;
+using PosInfoSPtr = std::shared_ptr<PosInfo>;
+
 //! vector of ["acctId", "marketCode"]
 using ConditionFieldGroup = std::vector<std::string>;
 
@@ -39,6 +42,71 @@ std::tuple<int, std::string, bool> MatchConditionTemplate(
     const ConditionValue& conditionValue,
     const ConditionTemplate& conditionTemplate);
 
+//! "acctId" -> ConditionField::AcctId
+std::tuple<int, std::string, ConditionField> GetConditionField(
+    const std::string& fieldName);
+
+//! ["acctId", "marketCode"] -> (1 << AcctId) | (1 << MarketCode)
+std::tuple<int, std::string, ConditionFieldMask> MakeConditionFieldMask(
+    const ConditionFieldGroup& conditionFieldGroup);
+
+//! {{"acctId":"10000"}, {"symbolCode":"IF*"}} -> CompiledCondition
+std::tuple<int, std::string, CompiledCondition> CompileConditionTemplate(
+    const ConditionTemplate& conditionTemplate);
+
+//! 根据fieldMask从记录中取出对应字段填充conditionKey，记录中没有某个字段比如
+//! 仓位信息中的orderType，那么返回false
+bool MakeConditionKey(const OrderInfo& rec, ConditionFieldMask fieldMask,
+                      ConditionKey& conditionKey);
+bool MakeConditionKey(const PosInfo& rec, ConditionFieldMask fieldMask,
+                      ConditionKey& conditionKey);
+
+//! conditionKey必须是用compiledCondition.fieldMask_从rec生成的
+bool MatchCompiledCondition(const OrderInfo& rec,
+                            const ConditionKey& conditionKey,
+                            const CompiledCondition& compiledCondition);
+bool MatchCompiledCondition(const PosInfo& rec,
+                            const ConditionKey& conditionKey,
+                            const CompiledCondition& compiledCondition);
+
+bool MatchCompiledCondition(const OrderInfo& rec,
+                            const CompiledCondition& compiledCondition);
+bool MatchCompiledCondition(const PosInfo& rec,
+                            const CompiledCondition& compiledCondition);
+
+//!
+//! 条件模板中acctId是精确值的时候，可以用 acctId + marketCode + symbolType +
+//! symbolCode 联合索引中被固定的最长前缀缩小查找范围，范围内的记录仍然需要用
+//! MatchCompiledCondition过滤
+//!
+template <typename Index>
+auto EqualRangeOfAcctIdAndSymInfo(const Index& idx,
+                                  const CompiledCondition& compiledCondition) {
+  const auto acctId = static_cast<AcctId>(
+      compiledCondition.getExactValue(ConditionField::AcctId));
+  if (!compiledCondition.isExact(ConditionField::MarketCode)) {
+    return idx.equal_range(std::make_tuple(acctId));
+  }
+
+  const auto marketCode = static_cast<MarketCode>(
+      compiledCondition.getExactValue(ConditionField::MarketCode));
+  if (!compiledCondition.isExact(ConditionField::SymbolType)) {
+    return idx.equal_range(std::make_tuple(acctId, marketCode));
+  }
+
+  const auto symbolType = static_cast<SymbolType>(
+      compiledCondition.getExactValue(ConditionField::SymbolType));
+  if (!compiledCondition.isExact(ConditionField::SymbolCode)) {
+    return idx.equal_range(std::make_tuple(acctId, marketCode, symbolType));
+  }
+
+  //! 索引中存放的也是symbolCode的XXH3哈希值
+  const auto hashOfSymbolCode =
+      compiledCondition.getExactValue(ConditionField::SymbolCode);
+  return idx.equal_range(
+      std::make_tuple(acctId, marketCode, symbolType, hashOfSymbolCode));
+}
+
 //! acctId=10000&marketCode=SSE -> acctId&marketCode
 std::string ExtractFieldName(const std::string& cond);
 
@@ -121,6 +121,47 @@ struct Books {
 using BooksSPtr = std::shared_ptr<Books>;
 using BooksUPtr = std::unique_ptr<Books>;
 
+//!
+//! 增量订单簿，只包含变化了的档位，topic和Books相同
+//!
+//! depthGroup_中先是numOfAsks_个卖档，然后是numOfBids_个买档，size_为0表示删除
+//! 该价位。同一个品种的seqNo_连续递增，isFullRefresh_为true的时候包含完整的订单
+//! 簿，接收端需丢弃之前的订单簿。
+//!
+//! 交易所的增量订单簿中没有最新价、成交量等字段，因此这里只有档位。
+//!
+struct BooksDelta {
+  SHMHeader shmHeader_;
+  MDHeader mdHeader_;
+
+  std::uint64_t seqNo_{0};
+  bool isFullRefresh_{false};
+
+  std::uint32_t numOfAsks_{0};
+  std::uint32_t numOfBids_{0};
+  Depth depthGroup_[0];
+
+  const Depth* asks() const { return depthGroup_; }
+  const Depth* bids() const { return depthGroup_ + numOfAsks_; }
+  std::size_t size() const {
+    return sizeof(BooksDelta) + (numOfAsks_ + numOfBids_) * sizeof(Depth);
+  }
+
+  std::string toStr() const;
+};
+
+inline std::size_t GetSizeOfBooksDelta(std::uint32_t numOfDepth) {
+  return sizeof(BooksDelta) + numOfDepth * sizeof(Depth);
+}
+
+//! 接收端还没有收到全量刷新或者发现seqNo不连续之后，请求行情服务立即发送
+//! 该品种的全量刷新，seqNo_是接收端最后一次成功处理的序号
+struct BooksSnapshotReq {
+  SHMHeader shmHeader_{MSG_ID_BOOKS_SNAPSHOT_REQ};
+  char symbolCode_[MAX_SYMBOL_CODE_LEN];
+  std::uint64_t seqNo_{0};
+};
+
 struct Bid1Ask1 {
   SHMHeader shmHeader_;
   MDHeader mdHeader_;
@@ -261,4 +302,26 @@ std::tuple<int, Tickers> MakeTickers(const std::string& jsonStr);
 
 MsgId GetMsgIdByMDType(MDType mdType);
 
+//! 所有行情结构体都以SHMHeader和MDHeader开头，取MDHeader不需要按msgId转换类型
+constexpr static std::size_t OFFSET_OF_MD_HEADER = offsetof(Trades, mdHeader_);
+static_assert(offsetof(Orders, mdHeader_) == OFFSET_OF_MD_HEADER,
+              "offsetof(Orders, mdHeader_) == OFFSET_OF_MD_HEADER");
+static_assert(offsetof(Books, mdHeader_) == OFFSET_OF_MD_HEADER,
+              "offsetof(Books, mdHeader_) == OFFSET_OF_MD_HEADER");
+static_assert(offsetof(BooksDelta, mdHeader_) == OFFSET_OF_MD_HEADER,
+              "offsetof(BooksDelta, mdHeader_) == OFFSET_OF_MD_HEADER");
+static_assert(offsetof(Bid1Ask1, mdHeader_) == OFFSET_OF_MD_HEADER,
+              "offsetof(Bid1Ask1, mdHeader_) == OFFSET_OF_MD_HEADER");
+static_assert(offsetof(LastPrice, mdHeader_) == OFFSET_OF_MD_HEADER,
+              "offsetof(LastPrice, mdHeader_) == OFFSET_OF_MD_HEADER");
+static_assert(offsetof(Tickers, mdHeader_) == OFFSET_OF_MD_HEADER,
+              "offsetof(Tickers, mdHeader_) == OFFSET_OF_MD_HEADER");
+static_assert(offsetof(Candle, mdHeader_) == OFFSET_OF_MD_HEADER,
+              "offsetof(Candle, mdHeader_) == OFFSET_OF_MD_HEADER");
+
+inline const MDHeader& GetMDHeader(const void* md) {
+  return *reinterpret_cast<const MDHeader*>(static_cast<const char*>(md) +
+                                            OFFSET_OF_MD_HEADER);
+}
+
 }  // namespace bq
@@ -13,6 +13,7 @@
 #include "SHMHeader.hpp"
 #include "def/BQConstIF.hpp"
 #include "def/BQDefIF.hpp"
+#include "util/LatencyTraceDef.hpp"
 
 namespace bq {
 
@@ -127,6 +128,10 @@ struct OrderInfo {
   std::uint64_t hashOfExchOrderId_{0};
   /// 辅助变量，内部使用
   std::uint64_t closedTime_{0};
+  /// 辅助变量，内部使用，进入上一个风控模组的时间
+  std::uint64_t tsOfPrevRiskCtrlModule_{0};
+  /// 时延追踪上下文，未开启时延追踪的时候全为0
+  TraceCtx traceCtx_;
 
   std::uint32_t extDataLen_{0};
   char extData_[0];
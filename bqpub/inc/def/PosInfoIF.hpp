@@ -138,15 +138,39 @@ using PosUpdateOfStgInstIdForPubSPtr =
 Key2PosInfoGroup MakePosUpdateOfStgInstId(
     const PosUpdateOfStgInstIdForPubSPtr& posUpdateOfStgInstIdForPub);
 
+//! 作为关键帧发送时seqNo_是已经包含在其中的最后一个增量的序号
 struct PosUpdateOfAllForPub {
   SHMHeader shmHeader_{MSG_ID_POS_UPDATE_OF_STG_INST_ID};
-  std::uint16_t num_;
-  char posInfoGroup_[0];
+  std::uint64_t seqNo_{0};
+  std::uint32_t num_;
+  alignas(PosInfo) char posInfoGroup_[0];
 };
 using PosUpdateOfAllForPubSPtr = std::shared_ptr<PosUpdateOfAllForPub>;
 Key2PosInfoGroup MakePosUpdateOfAll(
     const PosUpdateOfAllForPubSPtr& posUpdateOfAllForPub);
 
+enum class PosDeltaType : std::uint8_t { Add = 1, Chg = 2, Del = 3 };
+
+struct PosDelta {
+  PosDeltaType posDeltaType_{PosDeltaType::Chg};
+  PosInfo posInfo_;
+};
+using PosDeltaGroup = std::vector<PosDelta>;
+
+//! 相邻两次发布之间新增、变化和移除的仓位，seqNo_逐条加1
+struct PosDeltaOfAllForPub {
+  SHMHeader shmHeader_{MSG_ID_POS_DELTA_OF_ALL};
+  std::uint64_t seqNo_{0};
+  std::uint32_t num_;
+  alignas(PosDelta) char posDeltaGroup_[0];
+};
+
+//! 接收端发现seqNo不连续之后请求风控服务立即发送一次关键帧
+struct PosKeyframeReqOfAll {
+  SHMHeader shmHeader_{MSG_ID_POS_KEYFRAME_REQ_OF_ALL};
+  std::uint64_t seqNo_{0};
+};
+
 using Key2PosInfoBundle = std::map<std::string, PosInfoGroupSPtr>;
 using Key2PosInfoBundleSPtr = std::shared_ptr<Key2PosInfoBundle>;
 
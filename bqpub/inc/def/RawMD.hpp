@@ -10,66 +10,44 @@
 
 #pragma once
 
+#include "SHMIPCDef.hpp"
 #include "def/BQConst.hpp"
 #include "def/DefIF.hpp"
 #include "util/Datetime.hpp"
 #include "util/Pch.hpp"
+#include "util/SymbolRegistry.hpp"
 
 namespace bq {
 
 template <typename Task>
 struct AsyncTask;
 
+class RawMDPool;
+using RawMDPoolSPtr = std::shared_ptr<RawMDPool>;
+
 struct RawMD {
   RawMD(MsgType msgType, const void* data, std::uint32_t dataLen, bool isLast,
-        std::uint64_t localTs = GetTotalUSSince1970()) {
-    msgType_ = msgType;
-    localTs_ = localTs;
-
-    dataLen_ = dataLen;
-    data_ = malloc(dataLen);
-    memcpy(data_, data, dataLen_);
-
-    isLast_ = isLast;
-
-    switch (msgType) {
-      case MsgType::Tickers:
-        mdType_ = MDType::Tickers;
-        break;
-      case MsgType::Trades:
-        mdType_ = MDType::Trades;
-        break;
-      case MsgType::Orders:
-        mdType_ = MDType::Orders;
-        break;
-      case MsgType::Books:
-        mdType_ = MDType::Books;
-        break;
-      case MsgType::Candle:
-        mdType_ = MDType::Candle;
-        break;
-      case MsgType::Bid1Ask1:
-        mdType_ = MDType::Bid1Ask1;
-        break;
-      case MsgType::LastPrice:
-        mdType_ = MDType::LastPrice;
-        break;
-      case MsgType::DynCandle:
-        mdType_ = MDType::DynCandle;
-        break;
-      default:
-        mdType_ = MDType::Others;
-        break;
-    }
-  }
-
-  ~RawMD() {
-    SAFE_FREE(data_);
-    SAFE_FREE(dataAfterConv_);
-  }
+        std::uint64_t localTs = GetTotalUSSince1970());
+
+  //! data_和dataAfterConv_从rawMDPool中分配，析构的时候归还
+  RawMD(const RawMDPoolSPtr& rawMDPool, MsgType msgType, const void* data,
+        std::uint32_t dataLen, bool isLast,
+        std::uint64_t localTs = GetTotalUSSince1970());
+
+  ~RawMD();
+
+  //! 分配转换之后的统一格式行情的内存并清零，析构的时候释放
+  void* allocDataAfterConv(std::uint32_t dataAfterConvLen);
 
+ private:
+  void init(MsgType msgType, std::uint32_t dataLen, bool isLast,
+            std::uint64_t localTs);
+
+ public:
   MsgType msgType_;
   std::uint64_t localTs_;
+  //! 开启时延追踪的时候为收到行情时的tsc，否则为0
+  std::uint64_t tscOfRecv_{0};
 
   std::uint32_t dataLen_{0};
   void* data_{nullptr};
@@ -80,12 +58,16 @@ struct RawMD {
   MarketCode marketCode_;
   SymbolType symbolType_;
   std::string symbolCode_;
+  InternedSymbolId symbolId_{INVALID_INTERNED_SYMBOL_ID};
 
   std::string topic_;
   TopicHash topicHash_;
+  TopicId topicId_{0};
 
   std::uint32_t dataAfterConvLen_{0};
   void* dataAfterConv_{nullptr};
+
+  RawMDPoolSPtr rawMDPool_{nullptr};
 };
 using RawMDSPtr = std::shared_ptr<RawMD>;
 
@@ -94,4 +76,7 @@ using RawMDAsyncTaskSPtr = std::shared_ptr<RawMDAsyncTask>;
 
 void InitTopicInfo(RawMDSPtr& rawMD);
 
+std::tuple<TopicHash, TopicId> GetTopicInfoOfMDType(const RawMDSPtr& rawMD,
+                                                    MDType mdType);
+
 }  // namespace bq
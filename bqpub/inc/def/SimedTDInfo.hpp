@@ -15,6 +15,9 @@
 
 namespace bq {
 
+struct OrderInfo;
+using OrderInfoSPtr = std::shared_ptr<OrderInfo>;
+
 inline Decimal Slippage(Decimal value) { return value; }
 inline Decimal FilledPer(Decimal value) { return value; }
 
@@ -63,4 +66,17 @@ int checkIfSimedTDInfoValid(const SimedTDInfoSPtr& simedTDInfo);
 
 std::string ConvertSimedTDInfoToJsonFmt(const SimedTDInfoSPtr& simedTDInfo);
 
+//! 根据一条模拟成交明细更新委托的lastTrade相关字段以及成交均价和成交数量，
+//! 模拟交易和回测共用，手续费由调用方计算
+void UpdateOrderInfoByTransDetail(const OrderInfoSPtr& orderInfo,
+                                  const TransDetailSPtr& transDetail,
+                                  const std::string& tradeId,
+                                  std::uint64_t dealTime);
+
+//! 根据一笔成交更新委托的lastTrade相关字段以及成交均价和成交数量，dealSize为
+//! 正数，卖单的成交数量在这里转为负数
+void UpdateOrderInfoByFill(const OrderInfoSPtr& orderInfo, Decimal dealPrice,
+                           Decimal dealSize, const std::string& tradeId,
+                           std::uint64_t dealTime);
+
 }  // namespace bq
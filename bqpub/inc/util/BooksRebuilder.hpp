@@ -0,0 +1,85 @@
+/*!
+ * \file BooksRebuilder.hpp
+ * \project BetterQuant
+ *
+ * \author byrnexu
+ * \date 2023/03/24
+ *
+ * \brief
+ */
+
+#pragma once
+
+#include "def/BQConstIF.hpp"
+#include "def/BQDefIF.hpp"
+#include "def/DefIF.hpp"
+#include "def/MarketDataIF.hpp"
+#include "util/PchBase.hpp"
+#include "util/StdExt.hpp"
+
+namespace bq {
+
+using AsksOfRebuilder = std::map<Decimal, Depth>;
+using BidsOfRebuilder = std::map<Decimal, Depth, std::greater<Decimal>>;
+
+struct BooksOfRebuilder {
+  std::uint64_t seqNo_{0};
+  bool isReady_{false};
+  //! 本次等待全量刷新期间是否已经请求过快照，收到全量刷新之后重置
+  bool isSnapshotReqSent_{false};
+  AsksOfRebuilder asks_;
+  BidsOfRebuilder bids_;
+};
+using BooksOfRebuilderSPtr = std::shared_ptr<BooksOfRebuilder>;
+
+//! 参数是需要全量刷新的品种的行情头和接收端最后一次成功处理的seqNo
+using BooksSnapshotReqCallback =
+    std::function<void(const MDHeader& mdHeader, std::uint64_t seqNo)>;
+
+//!
+//! 接收端根据BooksDelta重建完整的订单簿Books
+//!
+//! 每个topic维护一份订单簿，收到isFullRefresh_的增量之后才开始输出，seqNo_不连续
+//! 的时候丢弃该topic的订单簿并等待全量刷新。等待期间通过回调请求行情服务立即
+//! 发送全量刷新（每次等待只请求一次），这样后加入的接收端和丢了增量的接收端
+//! 不用等到下一次定期的全量刷新；请求丢失的时候定期的全量刷新兜底。
+//!
+class BooksRebuilder {
+ public:
+  BooksRebuilder(const BooksRebuilder&) = delete;
+  BooksRebuilder& operator=(const BooksRebuilder&) = delete;
+  BooksRebuilder(const BooksRebuilder&&) = delete;
+  BooksRebuilder& operator=(const BooksRebuilder&&) = delete;
+
+  explicit BooksRebuilder(
+      const BooksSnapshotReqCallback& booksSnapshotReqCallback = nullptr);
+
+ public:
+  //! 将booksDelta合并之后的订单簿写入books，books由调用方分配
+  int rebuild(const BooksDelta* booksDelta, Books* books);
+
+  void reset();
+
+ private:
+  BooksOfRebuilderSPtr getBooksOfRebuilder(TopicHash topicHash);
+
+  void reqSnapshotIfNotSent(const BooksDelta* booksDelta,
+                            BooksOfRebuilder& booksOfRebuilder);
+
+  template <typename DepthGroup>
+  void mergeDepth(DepthGroup& depthGroup, const Depth* depthDelta,
+                  std::uint32_t numOfDepthDelta);
+
+  template <typename DepthGroup>
+  void copyDepth(const DepthGroup& depthGroup, Depth* depth);
+
+ private:
+  BooksSnapshotReqCallback booksSnapshotReqCallback_{nullptr};
+
+  std::map<TopicHash, BooksOfRebuilderSPtr> topicHash2BooksOfRebuilder_;
+  std::ext::spin_mutex mtxTopicHash2BooksOfRebuilder_;
+};
+
+using BooksRebuilderSPtr = std::shared_ptr<BooksRebuilder>;
+
+}  // namespace bq
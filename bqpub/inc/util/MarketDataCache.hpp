@@ -25,6 +25,18 @@ namespace bq {
 
 class RiskMgr;
 
+struct TickersSlot;
+
+//! 默认最多缓存的品种数量
+constexpr static std::uint32_t DEFAULT_MAX_NUM_OF_SYMBOL_IN_MD_CACHE = 8192;
+
+//!
+//! 最新行情缓存
+//!
+//! 按topicHash开放寻址的预分配槽位表，槽位一旦分配就不再释放，槽位下标即
+//! SymbolId。每个槽位使用序列锁（seqlock），写入方不分配内存，读取方不阻塞，
+//! 读取过程中遇到写入则重读。
+//!
 class MarketDataCache {
  public:
   MarketDataCache(const MarketDataCache&) = delete;
@@ -32,22 +44,41 @@ class MarketDataCache {
   MarketDataCache(const MarketDataCache&&) = delete;
   MarketDataCache& operator=(const MarketDataCache&&) = delete;
 
-  explicit MarketDataCache();
+  explicit MarketDataCache(
+      std::uint32_t maxNumOfSymbol = DEFAULT_MAX_NUM_OF_SYMBOL_IN_MD_CACHE);
+  ~MarketDataCache();
 
  public:
-  void cache(const TickersSPtr& tickers);
+  void cache(const Tickers* tickers);
+  void cache(const TickersSPtr& tickers) { cache(tickers.get()); }
+
   TickersSPtr getLastTickers(const std::string& topic);
   TickersSPtr getLastTickers(MarketCode marketCode, SymbolType symbolType,
                              const std::string& symbolCode);
 
+ public:
+  //! 以下接口将行情拷贝到调用方提供的tickers中，不分配内存，找不到返回false
+  bool getLastTickers(TopicHash topicHash, Tickers& tickers) const;
+
+  //! 查询之前先通过getSymbolId获取一次SymbolId，之后的查询不再需要拼接topic
+  SymbolId getSymbolId(MarketCode marketCode, SymbolType symbolType,
+                       const std::string& symbolCode);
+  bool getLastTickers(MarketCode marketCode, SymbolType symbolType,
+                      SymbolId symbolId, Tickers& tickers) const;
+
  private:
+  static std::uint32_t getNumOfSlot(std::uint32_t maxNumOfSymbol);
+  SymbolId findSlot(TopicHash topicHash) const;
+  SymbolId findOrAllocSlot(TopicHash topicHash);
+  bool readSlot(SymbolId symbolId, Tickers& tickers) const;
+
   std::string tickers2Str() const;
 
  private:
-  std::map<TopicHash, TickersSPtr> topic2LastTickersGroup_;
-  std::ext::spin_mutex mtxTopic2LastTickersGroup_;
+  const std::uint32_t numOfSlot_;
+  std::unique_ptr<TickersSlot[]> slots_;
 
-  std::uint64_t timesOfRecvTickers_{0};
+  std::atomic<std::uint64_t> timesOfRecvTickers_{0};
 };
 
 using MarketDataCacheSPtr = std::shared_ptr<MarketDataCache>;
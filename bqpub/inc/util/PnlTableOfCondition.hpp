@@ -0,0 +1,114 @@
+/*!
+ * \file PnlTableOfCondition.hpp
+ * \project BetterQuant
+ *
+ * \author byrnexu
+ * \date 2023/04/21
+ *
+ * \brief
+ */
+
+#pragma once
+
+#include "def/BQDefIF.hpp"
+#include "def/SHMDef.hpp"
+#include "util/PchBase.hpp"
+
+namespace bq {
+
+//! 默认最多监控的条件数量
+constexpr static std::uint32_t DEFAULT_MAX_NUM_OF_CONDITION_IN_PNL_TABLE = 4096;
+constexpr static std::uint16_t MAX_CONDITION_LEN = 256;
+
+//! 读取方遇到写入重读的最大次数，超过之后按没有盈亏处理
+constexpr static std::uint32_t MAX_NUM_OF_RETRY_OF_GET_PNL = 1024;
+//! 前面几次重读只自旋，之后每次重读前让出cpu，给写入方完成写入的机会
+constexpr static std::uint32_t NUM_OF_RETRY_OF_GET_PNL_BEFORE_YIELD = 64;
+
+constexpr static const char* NAME_OF_PNL_TABLE_HEADER =
+    "PnlTableHeaderOfCondition";
+constexpr static const char* NAME_OF_PNL_SLOT_GROUP = "PnlSlotGroupOfCondition";
+
+struct PnlOfCondition {
+  Decimal pnlUnReal_{0};
+  Decimal pnlReal_{0};
+  Decimal fee_{0};
+  std::uint64_t updateTime_{0};
+
+  Decimal getTotalPnl() const { return pnlUnReal_ + pnlReal_ - fee_; }
+  std::uint64_t delay() const;
+};
+
+struct PnlTableHeaderOfCondition {
+  explicit PnlTableHeaderOfCondition(std::uint32_t numOfSlot)
+      : numOfSlot_(numOfSlot) {}
+  const std::uint32_t numOfSlot_;
+};
+
+//! lenOfCondition_为0表示槽位已经分配但是condition_还没有写完
+struct PnlSlotOfCondition {
+  std::atomic<std::uint64_t> hashOfCondition_{0};
+  std::atomic<std::uint32_t> lenOfCondition_{0};
+  char condition_[MAX_CONDITION_LEN];
+  std::atomic<std::uint64_t> seqNo_{0};
+  PnlOfCondition pnlOfCondition_;
+};
+
+//! 返回0表示pnlOfCondition计算成功，其他值跳过该条件，不更新槽位
+using CalcPnlOfConditionCallback = std::function<int(
+    const std::string& condition, PnlOfCondition& pnlOfCondition)>;
+
+//!
+//! 共享内存中按条件（例如"acctId=10000&trdAcctId=100000"）计算好的盈亏
+//!
+//! 交易服务的盈亏监控插件通过reg注册需要监控的条件，风控服务定期通过update
+//! 遍历已注册的条件，对每个条件只计算一次盈亏并写入对应的槽位。槽位按条件的
+//! XXH3哈希开放寻址，一旦分配就不再释放；每个槽位使用序列锁（seqlock），读取
+//! 方不加锁，读取过程中遇到写入则重读。
+//!
+//! 写入方在写入过程中退出会让槽位的序列号停留在奇数，因此风控服务启动的时候
+//! 先通过resetSeqNoOfWriter复位这些槽位，读取方的重读次数也有上限。
+//!
+class PnlTableOfCondition {
+ public:
+  PnlTableOfCondition(const PnlTableOfCondition&) = delete;
+  PnlTableOfCondition& operator=(const PnlTableOfCondition&) = delete;
+  PnlTableOfCondition(const PnlTableOfCondition&&) = delete;
+  PnlTableOfCondition& operator=(const PnlTableOfCondition&&) = delete;
+
+  PnlTableOfCondition() = default;
+
+ public:
+  //! 共享内存已经存在的时候沿用其中的槽位数量，忽略maxNumOfCondition
+  void load(const std::string& segmentIdentity,
+            std::uint32_t maxNumOfCondition =
+                DEFAULT_MAX_NUM_OF_CONDITION_IN_PNL_TABLE);
+
+  //! 重复注册同一个条件直接返回true，条件过长或者没有空闲槽位返回false
+  bool reg(const std::string& condition);
+
+  //! 只在写入方启动的时候调用，返回复位的槽位数量
+  std::uint32_t resetSeqNoOfWriter();
+
+  //! 返回成功更新的条件的数量
+  std::uint32_t update(const CalcPnlOfConditionCallback& calcPnlOfCondition);
+
+  //! 条件没有注册、还没有计算过盈亏或者重读次数超过上限返回false
+  bool getPnl(std::uint64_t hashOfCondition,
+              PnlOfCondition& pnlOfCondition) const;
+
+  std::uint32_t getNumOfSlot() const;
+
+ private:
+  static std::uint32_t CalcNumOfSlot(std::uint32_t maxNumOfCondition);
+  PnlSlotOfCondition* findSlot(std::uint64_t hashOfCondition) const;
+
+ private:
+  std::shared_ptr<bip::managed_shared_memory> segment_{nullptr};
+  PnlTableHeaderOfCondition* header_{nullptr};
+  PnlSlotOfCondition* slots_{nullptr};
+};
+
+using PnlTableOfConditionSPtr = std::shared_ptr<PnlTableOfCondition>;
+
+}  // namespace bq
@@ -38,6 +38,9 @@ class PosSnapshot {
  public:
   const std::map<std::string, PosInfoSPtr>& getPosInfoDetail() const;
 
+  //! 按仓位增量原地更新仓位明细，同时清空按条件缓存的查询结果
+  void applyPosDelta(const PosDelta& posDelta);
+
   std::tuple<int, PnlSPtr> queryPnl(
       const std::string& queryCond,
       const std::string& quoteCurrencyForCalc = "USDT",
@@ -45,6 +45,8 @@ class PosSnapshotImpl {
  public:
   const std::map<std::string, PosInfoSPtr>& getPosInfoDetail() const;
 
+  void applyPosDelta(const PosDelta& posDelta);
+
   std::tuple<int, PnlSPtr> queryPnl(
       const std::string& queryCond, const std::string& quoteCurrencyForCalc,
       const std::string& quoteCurrencyForConv,
@@ -0,0 +1,68 @@
+/*!
+ * \file PosSnapshotRebuilder.hpp
+ * \project BetterQuant
+ *
+ * \author byrnexu
+ * \date 2023/04/20
+ *
+ * \brief
+ */
+
+#pragma once
+
+#include "def/DefIF.hpp"
+#include "def/PosInfoIF.hpp"
+#include "util/PchBase.hpp"
+
+namespace bq {
+
+class PosSnapshot;
+using PosSnapshotSPtr = std::shared_ptr<PosSnapshot>;
+
+//! 参数是接收端最后一次成功处理的seqNo
+using PosKeyframeReqCallback = std::function<void(std::uint64_t seqNo)>;
+
+//!
+//! 接收端根据"RISK@PubChannel@Trade@PosInfo@All"上的关键帧和增量维护全部仓位
+//!
+//! 收到关键帧（MSG_ID_POS_SNAPSHOT_OF_ALL）之后重建PosSnapshot，之后的增量
+//! （MSG_ID_POS_DELTA_OF_ALL）原地更新该PosSnapshot；seqNo_不连续的时候通过
+//! posKeyframeReqCallback请求风控服务立即发送关键帧，收到之前丢弃所有增量。
+//! MSG_ID_POS_UPDATE_OF_ALL和关键帧的格式相同，同样按关键帧处理。
+//!
+class PosSnapshotRebuilder {
+ public:
+  PosSnapshotRebuilder(const PosSnapshotRebuilder&) = delete;
+  PosSnapshotRebuilder& operator=(const PosSnapshotRebuilder&) = delete;
+  PosSnapshotRebuilder(const PosSnapshotRebuilder&&) = delete;
+  PosSnapshotRebuilder& operator=(const PosSnapshotRebuilder&&) = delete;
+
+  explicit PosSnapshotRebuilder(
+      const PosKeyframeReqCallback& posKeyframeReqCallback = nullptr,
+      const MarketDataCacheSPtr& marketDataCache = nullptr);
+
+ public:
+  //! 返回0表示getPosSnapshot()中的仓位已经更新
+  int rebuild(const void* shmBuf);
+
+  //! 收到第一个关键帧之前返回nullptr
+  PosSnapshotSPtr getPosSnapshot() const { return posSnapshot_; }
+  std::uint64_t getSeqNo() const { return seqNo_; }
+  bool isReady() const { return isReady_; }
+
+ private:
+  int onPosKeyframe(const PosUpdateOfAllForPub* posUpdateOfAllForPub);
+  int onPosDelta(const PosDeltaOfAllForPub* posDeltaOfAllForPub);
+
+ private:
+  PosKeyframeReqCallback posKeyframeReqCallback_{nullptr};
+  MarketDataCacheSPtr marketDataCache_{nullptr};
+
+  PosSnapshotSPtr posSnapshot_{nullptr};
+  std::uint64_t seqNo_{0};
+  bool isReady_{false};
+};
+
+using PosSnapshotRebuilderSPtr = std::shared_ptr<PosSnapshotRebuilder>;
+
+}  // namespace bq
@@ -0,0 +1,62 @@
+/*!
+ * \file RawMDPool.hpp
+ * \project BetterQuant
+ *
+ * \author byrnexu
+ * \date 2023/04/14
+ *
+ * \brief
+ */
+
+#pragma once
+
+#include "util/MemPool.hpp"
+#include "util/Pch.hpp"
+
+namespace bq {
+
+enum class MsgType : std::uint8_t;
+
+struct RawMD;
+using RawMDSPtr = std::shared_ptr<RawMD>;
+
+class RawMDPool;
+using RawMDPoolSPtr = std::shared_ptr<RawMDPool>;
+
+//!
+//! 国内行情网关中RawMD的对象池，避免在api的回调线程中分配内存：
+//! 1. RawMD对象和shared_ptr的引用计数通过allocate_shared分配在同一个内存块中；
+//! 2. 原始行情（data_）和转换之后的行情（dataAfterConv_）按大小分级，每一级
+//!    一个定长内存块池，分配的时候选择放得下的最小的一级；
+//! 3. 每一级的块数按订阅的品种数估算，行情发布（以及落盘）之后RawMD析构，
+//!    内存块随之回收，池耗尽的时候退回堆上分配并计数。
+//!
+class RawMDPool : public std::enable_shared_from_this<RawMDPool> {
+ public:
+  RawMDPool(const RawMDPool&) = delete;
+  RawMDPool& operator=(const RawMDPool&) = delete;
+  RawMDPool(const RawMDPool&&) = delete;
+  RawMDPool& operator=(const RawMDPool&&) = delete;
+
+  //! sizeGroupOfData是原始行情和转换之后行情可能的大小
+  RawMDPool(std::size_t numOfBlock,
+            const std::vector<std::size_t>& sizeGroupOfData);
+
+ public:
+  RawMDSPtr makeRawMD(MsgType msgType, const void* data, std::uint32_t dataLen,
+                      bool isLast);
+
+  void* allocData(std::size_t dataLen);
+  void freeData(void* data);
+
+  //! 每一级内存池的占用数和耗尽次数
+  std::string getStatistic() const;
+  std::uint64_t getNumOfExhausted() const;
+
+ private:
+  FixedSizeMemPoolSPtr memPoolOfRawMD_{nullptr};
+  //! 按块大小升序排列
+  std::vector<FixedSizeMemPoolSPtr> memPoolGroupOfData_;
+};
+
+}  // namespace bq
@@ -0,0 +1,217 @@
+/*!
+ * \file SimedMatchingEngine.hpp
+ * \project BetterQuant
+ *
+ * \author byrnexu
+ * \date 2023/03/30
+ *
+ * \brief
+ */
+
+#pragma once
+
+#include "SHMIPCMsgId.hpp"
+#include "def/BQConstIF.hpp"
+#include "def/BQDefIF.hpp"
+#include "def/DefIF.hpp"
+#include "def/MarketDataIF.hpp"
+#include "util/PchBase.hpp"
+
+namespace bq {
+
+struct OrderInfo;
+using OrderInfoSPtr = std::shared_ptr<OrderInfo>;
+
+//! 订单簿快照只读共享，可以直接引用收到的行情而不用拷贝
+using BooksCSPtr = std::shared_ptr<const Books>;
+
+//!
+//! 模拟撮合产生的回报，msgId为MSG_ID_ON_ORDER_RET或者MSG_ID_ON_CANCEL_ORDER_RET，
+//! liquidityDirection只对成交回报有意义，调用方据此计算手续费
+//!
+using CBOnSimedOrderRet =
+    std::function<void(const OrderInfoSPtr& orderInfo, MsgId msgId,
+                       LiquidityDirection liquidityDirection)>;
+
+struct SimedMatchingEngineParam {
+  std::uint64_t usLatencyOfOrder_{0};
+  std::uint64_t usLatencyOfCancelOrder_{0};
+
+  //! 撮合引擎按品种分片，no_和numOfShard_用于生成不重复的交易所订单号和成交号
+  std::uint32_t no_{0};
+  std::uint32_t numOfShard_{1};
+};
+
+struct SimedOrder {
+  explicit SimedOrder(const OrderInfoSPtr& orderInfo) : orderInfo_(orderInfo) {}
+  OrderInfoSPtr orderInfo_;
+  //! 估算的排在本订单前面的挂单数量，消耗完之后对手方的成交才会撮合本订单
+  Decimal queueAhead_{0};
+};
+using SimedOrderSPtr = std::shared_ptr<SimedOrder>;
+
+//! 同一价位的订单按时间优先排队
+using SimedOrderQueue = std::list<SimedOrderSPtr>;
+using SimedAsks = std::map<Decimal, SimedOrderQueue>;
+using SimedBids = std::map<Decimal, SimedOrderQueue, std::greater<Decimal>>;
+
+//! 还在路上的报单和撤单请求，到达时间为请求时间加上延时
+struct SimedReq {
+  OrderInfoSPtr orderInfo_;
+  bool isCancel_{false};
+};
+using TsOfArrival2SimedReq = std::multimap<std::uint64_t, SimedReq>;
+
+class SimedMatchingEngine;
+
+//!
+//! 单个品种的模拟撮合：
+//! 1. 新订单按对手方档位逐档吃单（Taker），剩余部分挂单，挂单时同价位的市场挂单
+//!    数量作为排队位置；
+//! 2. 收到Trades时，成交价优于挂单价的订单直接成交，等于挂单价的订单先消耗排队
+//!    位置再成交（Maker）；
+//! 3. 收到Books时，对手方越过挂单价的订单成交（Maker），同价位的市场挂单减少时
+//!    排队位置随之前移。
+//!
+//! 档位查找在有序的Depth数组上二分，每个事件的开销为O(log levels)加上实际撮合
+//! 的订单数量。非线程安全，同一个品种的所有事件必须在同一个线程中处理。
+//!
+class SimedOrderBook {
+ public:
+  SimedOrderBook(const SimedOrderBook&) = delete;
+  SimedOrderBook& operator=(const SimedOrderBook&) = delete;
+  SimedOrderBook(const SimedOrderBook&&) = delete;
+  SimedOrderBook& operator=(const SimedOrderBook&&) = delete;
+
+  explicit SimedOrderBook(SimedMatchingEngine* simedMatchingEngine);
+
+ public:
+  void order(const OrderInfoSPtr& orderInfo, std::uint64_t ts);
+  void cancelOrder(const OrderInfoSPtr& orderInfo, std::uint64_t ts);
+
+  void onBooks(const BooksCSPtr& books, std::uint64_t ts);
+  void onTrades(const Trades& trades, std::uint64_t ts);
+
+  //! 处理到达时间不晚于ts的请求
+  void advanceTo(std::uint64_t ts);
+
+  std::size_t getNumOfOrder() const { return orderId2SimedOrder_.size(); }
+  std::size_t getNumOfReqInFlight() const {
+    return tsOfArrival2SimedReq_.size();
+  }
+
+ public:
+  //! 有效档位都在Depth数组的前部，二分查找价格不为0的档位数量
+  static std::uint32_t GetNumOfDepth(const Depth* depth);
+
+  //! 卖档按价格升序、买档按价格降序，二分查找价格为price的档位，找不到返回num
+  static std::uint32_t FindDepth(const Depth* depth, std::uint32_t num,
+                                 Decimal price, Side side);
+
+  //! side方向的订单价格为orderPrice时，是否可以和价格为priceOfOppo的对手方成交
+  static bool IsCrossed(Side side, Decimal orderPrice, Decimal priceOfOppo);
+
+  //! 对于side方向的订单来说，lhs是否是比rhs更优的价格
+  static bool IsBetter(Side side, Decimal lhs, Decimal rhs);
+
+ private:
+  void execOrder(const OrderInfoSPtr& orderInfo, std::uint64_t ts);
+  void execCancelOrder(const OrderInfoSPtr& orderInfo, std::uint64_t ts);
+
+  Decimal getSizeCanBeTaken(const OrderInfoSPtr& orderInfo) const;
+  void take(const OrderInfoSPtr& orderInfo,
+            LiquidityDirection liquidityDirection, std::uint64_t ts);
+  void rest(const OrderInfoSPtr& orderInfo);
+
+  template <typename SimedOrderGroup>
+  void matchByBooks(SimedOrderGroup& simedOrderGroup, Side side,
+                    std::uint64_t ts);
+  template <typename SimedOrderGroup>
+  void matchByTrades(SimedOrderGroup& simedOrderGroup, Side side,
+                     const Trades& trades, std::uint64_t ts);
+  template <typename SimedOrderGroup>
+  void updateQueueAhead(SimedOrderGroup& simedOrderGroup, Side side);
+  void removeFilledSimedOrder(SimedOrderQueue& simedOrderQueue);
+
+  void fill(const OrderInfoSPtr& orderInfo, Decimal dealPrice,
+            Decimal dealSize, LiquidityDirection liquidityDirection,
+            std::uint64_t ts);
+  void removeSimedOrder(const SimedOrderSPtr& simedOrder);
+
+ private:
+  //! 对手方的档位和从当前快照中已经吃掉的数量
+  std::tuple<const Depth*, std::uint32_t> getDepthOfOppo(Side side) const;
+  std::tuple<const Depth*, std::uint32_t> getDepthOfSameSide(Side side) const;
+  std::map<Decimal, Decimal>& getSizeTakenOfOppo(Side side);
+
+ private:
+  SimedMatchingEngine* simedMatchingEngine_{nullptr};
+
+  BooksCSPtr books_{nullptr};
+  std::uint32_t numOfAsks_{0};
+  std::uint32_t numOfBids_{0};
+
+  //! 同一份快照中的流动性只能被模拟订单吃一次，收到新的快照之后清空
+  std::map<Decimal, Decimal> sizeTakenOfAsks_;
+  std::map<Decimal, Decimal> sizeTakenOfBids_;
+
+  SimedAsks simedAsks_;
+  SimedBids simedBids_;
+  std::map<OrderId, SimedOrderSPtr> orderId2SimedOrder_;
+
+  TsOfArrival2SimedReq tsOfArrival2SimedReq_;
+};
+using SimedOrderBookSPtr = std::shared_ptr<SimedOrderBook>;
+
+using SymbolKeyOfSimedMatching =
+    std::tuple<MarketCode, SymbolType, std::string>;
+
+using SimedMatchingEngineSPtr = std::shared_ptr<SimedMatchingEngine>;
+
+//!
+//! 模拟撮合引擎的一个分片，管理分配到本分片的所有品种，不同分片之间没有共享
+//! 状态，调用方按品种把事件分发到固定的线程即可并行撮合。
+//!
+class SimedMatchingEngine {
+  friend class SimedOrderBook;
+
+ public:
+  SimedMatchingEngine(const SimedMatchingEngine&) = delete;
+  SimedMatchingEngine& operator=(const SimedMatchingEngine&) = delete;
+  SimedMatchingEngine(const SimedMatchingEngine&&) = delete;
+  SimedMatchingEngine& operator=(const SimedMatchingEngine&&) = delete;
+
+  SimedMatchingEngine(const SimedMatchingEngineParam& param,
+                      const CBOnSimedOrderRet& cbOnSimedOrderRet);
+
+ public:
+  void order(const OrderInfoSPtr& orderInfo, std::uint64_t ts);
+  void cancelOrder(const OrderInfoSPtr& orderInfo, std::uint64_t ts);
+
+  void onBooks(const BooksCSPtr& books, std::uint64_t ts);
+  void onTrades(const Trades& trades, std::uint64_t ts);
+
+  //! 调用方按品种分片的时候使用，保证同一个品种总是分配到同一个分片
+  static std::uint32_t GetShardNo(const std::string& symbolCode,
+                                  std::uint32_t numOfShard);
+
+ private:
+  SimedOrderBookSPtr getSimedOrderBook(MarketCode marketCode,
+                                       SymbolType symbolType,
+                                       const std::string& symbolCode);
+
+  std::string getNextExchOrderId();
+  std::string getNextTradeId();
+
+ private:
+  const SimedMatchingEngineParam param_;
+  CBOnSimedOrderRet cbOnSimedOrderRet_{nullptr};
+
+  std::map<SymbolKeyOfSimedMatching, SimedOrderBookSPtr>
+      symbolKey2SimedOrderBook_;
+
+  std::uint64_t noOfExchOrderId_{0};
+  std::uint64_t noOfTradeId_{0};
+};
+
+}  // namespace bq
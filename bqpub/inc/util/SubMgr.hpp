@@ -10,6 +10,7 @@
 
 #pragma once
 
+#include "SHMIPCConst.hpp"
 #include "SHMIPCDef.hpp"
 #include "def/Def.hpp"
 #include "util/Pch.hpp"
@@ -17,6 +18,8 @@
 
 namespace bq {
 
+struct MDHeader;
+
 using SubscriberGroup = std::vector<ClientChannel>;
 using TopicHash2SubscriberGroup =
     absl::node_hash_map<TopicHash, SubscriberGroup>;
@@ -31,10 +34,21 @@ class SubMgr {
   SubMgr(const SubMgr&&) = delete;
   SubMgr& operator=(const SubMgr&&) = delete;
 
+  //! clientChannelOfMD不为PUB_CHANNEL的时候，使用独立的频道订阅行情服务，行情
+  //! 服务根据TopicMgr同步的订阅信息只推送订阅了的行情
   SubMgr(const std::string& appNameOfSubscriber,
-         const DataRecvCallback& dataRecvCallback);
+         const DataRecvCallback& dataRecvCallback,
+         ClientChannel clientChannelOfMD = PUB_CHANNEL);
   ~SubMgr();
 
+  //! 接收端零拷贝时每个SHMCli同时持有的chunk的上限，需在sub之前设置
+  void setMaxNumOfChunkHeld(std::uint32_t value) { maxNumOfChunkHeld_ = value; }
+
+  //! 行情频道处理不过来时的策略，只对行情服务的SHMCli生效，需在sub之前设置
+  void setSlowConsumerPolicyOfMD(SlowConsumerPolicy value) {
+    slowConsumerPolicyOfMD_ = value;
+  }
+
  public:
   //! 因为WebSrv停止时异常，所以用stop方法手动停止SubMgr
   void start();
@@ -53,12 +67,21 @@ class SubMgr {
   SubscriberGroup getSubscriberGroupByTopicHash(TopicHash topicHash) const;
   Addr2SHMCliGroup getSHMCliGroup() const;
 
+  //! 返回订阅topic时创建的SHMCli，不存在或者没有就绪的时候返回nullptr
+  SHMCliSPtr getSHMCliByTopic(const std::string& topic) const;
+
+  //! 请求发布该订单簿的行情服务立即发送一次全量刷新，用于BooksRebuilder
+  void reqBooksSnapshot(const MDHeader& mdHeader, std::uint64_t seqNo) const;
+
  private:
   void initSHMCli(const std::string& addr);
 
  private:
   std::string appNameOfSubscriber_;
   DataRecvCallback dataRecvCallback_{nullptr};
+  ClientChannel clientChannelOfMD_{PUB_CHANNEL};
+  std::uint32_t maxNumOfChunkHeld_{DEFAULT_MAX_NUM_OF_CHUNK_HELD};
+  SlowConsumerPolicy slowConsumerPolicyOfMD_{SlowConsumerPolicy::Block};
 
   TopicHash2SubscriberGroup topicHash2SubscriberGroup_;
   mutable std::ext::spin_mutex mtxTopicHash2SubscriberGroup_;
@@ -0,0 +1,138 @@
+/*!
+ * \file SymbolRegistry.hpp
+ * \project BetterQuant
+ *
+ * \author byrnexu
+ * \date 2023/04/13
+ *
+ * \brief
+ */
+
+#pragma once
+
+#include "SHMIPCConst.hpp"
+#include "SHMIPCDef.hpp"
+#include "def/BQConstIF.hpp"
+#include "def/DefIF.hpp"
+#include "util/Pch.hpp"
+
+namespace bq {
+
+using InternedSymbolId = std::uint32_t;
+constexpr static InternedSymbolId INVALID_INTERNED_SYMBOL_ID = UINT32_MAX;
+
+//! 进程内最多登记的品种数量，下面的索引表大小是它的2倍
+constexpr static std::uint32_t MAX_NUM_OF_SYMBOL_IN_REGISTRY = 65536;
+
+//! 以MDType的值为下标，Trades(1) ~ DynCandle(8)
+constexpr static std::uint32_t NUM_OF_MD_TYPE_IN_SYMBOL_REGISTRY = 9;
+
+struct TopicInfoOfSymbol {
+  std::string topic_;
+  TopicHash topicHash_{0};
+  //! 第一次使用的时候才登记到共享内存的topic注册表，避免占满注册表
+  mutable std::atomic<TopicId> topicId_{INVALID_TOPIC_ID};
+
+  TopicId getTopicId() const;
+};
+
+//!
+//! 登记之后不再修改也不再释放，可以在任何线程无锁读取
+//!
+struct InternedSymbol {
+  InternedSymbolId symbolId_{INVALID_INTERNED_SYMBOL_ID};
+  MarketCode marketCode_;
+  SymbolType symbolType_;
+  std::string symbolCode_;
+  std::string exchSymbolCode_;
+
+  //! MD@Binance@Spot@BTC-USDT@Books
+  TopicInfoOfSymbol topicInfoGroup_[NUM_OF_MD_TYPE_IN_SYMBOL_REGISTRY];
+
+  //! 带后缀的topic，只有Books和Candle和上面不同：
+  //! MD@Binance@Spot@BTC-USDT@Books@400
+  //! MD@Binance@Spot@BTC-USDT@Candle@detail
+  TopicInfoOfSymbol topicInfoWithExtGroup_[NUM_OF_MD_TYPE_IN_SYMBOL_REGISTRY];
+
+  //! mdType为Others等不在表中的类型时返回nullptr
+  const TopicInfoOfSymbol* getTopicInfo(MDType mdType,
+                                        bool withExt = false) const;
+};
+
+struct IdxRecOfSymbolRegistry {
+  std::atomic<std::uint64_t> keyHash_{0};
+  std::atomic<InternedSymbolId> symbolId_{INVALID_INTERNED_SYMBOL_ID};
+};
+
+//!
+//! 进程内的品种注册表，将 (MarketCode, SymbolType, symbolCode) 映射为连续的
+//! InternedSymbolId，并预先生成每种MDType的topic和topicHash：
+//! 1. 启动的时候由TBLMonitorOfSymbolInfo和SymbolInfoTable登记，之后随着
+//!    品种表的变化增量登记，没有登记过的品种在第一次使用的时候登记；
+//! 2. symbolCode和exchSymbolCode各有一张按hash开放寻址的索引表，查询只需要
+//!    一次hash和几次原子读，没有锁、格式化和内存分配；
+//! 3. 品种只增不删，exchSymbolCode变化的时候登记一个新的InternedSymbol，
+//!    旧的InternedSymbolId仍然有效。
+//!
+//! 注册表满的时候intern返回INVALID_INTERNED_SYMBOL_ID，调用方退回原来的方式。
+//!
+class SymbolRegistry : public boost::serialization::singleton<SymbolRegistry> {
+ public:
+  SymbolRegistry();
+  ~SymbolRegistry();
+
+ public:
+  InternedSymbolId intern(MarketCode marketCode, SymbolType symbolType,
+                          const std::string& symbolCode,
+                          const std::string& exchSymbolCode = "");
+
+  InternedSymbolId getIdBySymbolCode(MarketCode marketCode,
+                                     SymbolType symbolType,
+                                     const std::string& symbolCode) const;
+
+  InternedSymbolId getIdByExchSymbolCode(
+      MarketCode marketCode, SymbolType symbolType,
+      const std::string& exchSymbolCode) const;
+
+  const InternedSymbol* getSymbol(InternedSymbolId symbolId) const;
+
+  //! 登记失败的时候现场计算topicHash
+  TopicHash getTopicHash(MarketCode marketCode, SymbolType symbolType,
+                         const std::string& symbolCode, MDType mdType);
+
+  std::size_t size() const;
+
+ private:
+  static std::uint64_t getKeyHash(MarketCode marketCode, SymbolType symbolType,
+                                  const std::string& code);
+
+  InternedSymbolId add(MarketCode marketCode, SymbolType symbolType,
+                       const std::string& symbolCode,
+                       const std::string& exchSymbolCode);
+
+  InternedSymbolId find(const IdxRecOfSymbolRegistry* idx,
+                        std::uint64_t keyHash, MarketCode marketCode,
+                        SymbolType symbolType, const std::string& code,
+                        bool isExchSymbolCode) const;
+
+  void setIdx(IdxRecOfSymbolRegistry* idx, std::uint64_t keyHash,
+              MarketCode marketCode, SymbolType symbolType,
+              const std::string& code, bool isExchSymbolCode,
+              InternedSymbolId symbolId);
+
+ private:
+  std::unique_ptr<std::atomic<InternedSymbol*>[]> symbolGroup_;
+  std::atomic<std::uint32_t> numOfSymbol_{0};
+
+  std::unique_ptr<IdxRecOfSymbolRegistry[]> idxOfSymbolCode_;
+  std::unique_ptr<IdxRecOfSymbolRegistry[]> idxOfExchSymbolCode_;
+
+  //! 只有登记的时候加锁，查询不加锁
+  std::mutex mtxAdd_;
+};
+
+std::string MakeTopicOfSymbol(MarketCode marketCode, SymbolType symbolType,
+                              const std::string& symbolCode, MDType mdType,
+                              bool withExt = false);
+
+}  // namespace bq
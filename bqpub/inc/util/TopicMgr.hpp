@@ -8,6 +8,7 @@
  * \brief
  */
 
+#include "SHMIPCTopicFilter.hpp"
 #include "def/BQDef.hpp"
 #include "def/Const.hpp"
 #include "def/Def.hpp"
@@ -112,4 +113,13 @@ class TopicMgr {
   mutable std::mutex mtxTopicMgr;
 };
 
+//! 将客户端同步过来的json格式的订阅信息转换为服务端过滤器用到的topicHash集合
+TopicHashGroup MakeTopicHashGroup(
+    const std::string& subscriber2TopicGroupInJsonFmt);
+
+//! 行情服务收到MSG_ID_SYNC_SUB_INFO之后调用，使用独立频道的客户端同步更新各个
+//! SHMSrv的过滤器，使用公共频道的客户端不过滤
+void UpdateTopicFilterBySyncSubInfo(const void* shmBuf,
+                                    const std::vector<SHMSrvSPtr>& shmSrvGroup);
+
 }  // namespace bq
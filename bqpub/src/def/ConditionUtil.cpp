@@ -14,6 +14,7 @@
 #include "def/DataStruOfTD.hpp"
 #include "def/Def.hpp"
 #include "def/Field.hpp"
+#include "def/PosInfo.hpp"
 
 namespace bq {
 
@@ -138,6 +139,375 @@ std::tuple<int, std::string, bool> MatchConditionTemplate(
   return {0, "", true};
 }
 
+//! "acctId" -> ConditionField::AcctId
+std::tuple<int, std::string, ConditionField> GetConditionField(
+    const std::string& fieldName) {
+  if (fieldName == FIELD_PRODUCT_GRP_ID) {
+    return {0, "", ConditionField::ProductGrpId};
+  } else if (fieldName == FIELD_PRODUCT_ID) {
+    return {0, "", ConditionField::ProductId};
+  } else if (fieldName == FIELD_USER_ID) {
+    return {0, "", ConditionField::UserId};
+  } else if (fieldName == FIELD_ACCT_GRP_ID) {
+    return {0, "", ConditionField::AcctGrpId};
+  } else if (fieldName == FIELD_ACCT_ID) {
+    return {0, "", ConditionField::AcctId};
+  } else if (fieldName == FIELD_TRD_ACCT_ID) {
+    return {0, "", ConditionField::TrdAcctId};
+  } else if (fieldName == FIELD_STG_GRP_ID) {
+    return {0, "", ConditionField::StgGrpId};
+  } else if (fieldName == FIELD_STG_ID) {
+    return {0, "", ConditionField::StgId};
+  } else if (fieldName == FIELD_STG_INST_ID) {
+    return {0, "", ConditionField::StgInstId};
+  } else if (fieldName == FIELD_ALGO_ID) {
+    return {0, "", ConditionField::AlgoId};
+  } else if (fieldName == FIELD_MARKET_CODE) {
+    return {0, "", ConditionField::MarketCode};
+  } else if (fieldName == FIELD_SYMBOL_TYPE) {
+    return {0, "", ConditionField::SymbolType};
+  } else if (fieldName == FIELD_SYMBOL_CODE) {
+    return {0, "", ConditionField::SymbolCode};
+  } else if (fieldName == FIELD_SIDE) {
+    return {0, "", ConditionField::Side};
+  } else if (fieldName == FIELD_POS_DIRECTION) {
+    return {0, "", ConditionField::PosDirection};
+  } else if (fieldName == FIELD_POS_SIDE) {
+    return {0, "", ConditionField::PosSide};
+  } else if (fieldName == FIELD_PAR_VALUE) {
+    return {0, "", ConditionField::ParValue};
+  } else if (fieldName == FIELD_ORDER_TYPE) {
+    return {0, "", ConditionField::OrderType};
+  } else if (fieldName == FIELD_ORDER_TYPE_EXTRA) {
+    return {0, "", ConditionField::OrderTypeExtra};
+  } else if (fieldName == FIELD_FEE_CURRENCY) {
+    return {0, "", ConditionField::FeeCurrency};
+  }
+
+  const auto statusMsg = fmt::format(
+      "Get condition field failed because of invalid field name {}.",
+      fieldName);
+  return {-1, statusMsg, ConditionField::Max};
+}
+
+//! ["acctId", "marketCode"] -> (1 << AcctId) | (1 << MarketCode)
+std::tuple<int, std::string, ConditionFieldMask> MakeConditionFieldMask(
+    const ConditionFieldGroup& conditionFieldGroup) {
+  ConditionFieldMask fieldMask = 0;
+  for (const auto& fieldName : conditionFieldGroup) {
+    const auto [statusCode, statusMsg, field] = GetConditionField(fieldName);
+    if (statusCode != 0) {
+      return {statusCode, statusMsg, fieldMask};
+    }
+    fieldMask |= MaskOf(field);
+  }
+  return {0, "", fieldMask};
+}
+
+template <typename T>
+bool ParseIntOfConditionField(const std::string& valueInStrFmt,
+                               std::uint64_t& value) {
+  T v{0};
+  const auto end = valueInStrFmt.data() + valueInStrFmt.size();
+  const auto [ptr, ec] = std::from_chars(valueInStrFmt.data(), end, v);
+  //! 原来是按字符串比较的，所以 010000 这样的值不能和 10000 匹配
+  if (ec != std::errc() || ptr != end ||
+      fmt::format("{}", v) != valueInStrFmt) {
+    return false;
+  }
+  value = static_cast<std::uint64_t>(v);
+  return true;
+}
+
+template <typename E>
+bool ParseEnumOfConditionField(const std::string& valueInStrFmt,
+                               std::uint64_t& value) {
+  const auto v = magic_enum::enum_cast<E>(valueInStrFmt);
+  if (!v.has_value()) {
+    return false;
+  }
+  value = static_cast<std::uint64_t>(v.value());
+  return true;
+}
+
+//! 将条件模板中的字符串值转换成ConditionKey中的整数值
+bool ParseValueOfConditionField(ConditionField field,
+                                const std::string& valueInStrFmt,
+                                std::uint64_t& value) {
+  switch (field) {
+    case ConditionField::ProductGrpId:
+    case ConditionField::ProductId:
+    case ConditionField::UserId:
+    case ConditionField::AcctGrpId:
+    case ConditionField::AcctId:
+    case ConditionField::TrdAcctId:
+    case ConditionField::StgGrpId:
+    case ConditionField::StgId:
+    case ConditionField::StgInstId:
+    case ConditionField::AlgoId:
+      return ParseIntOfConditionField<std::uint64_t>(valueInStrFmt, value);
+
+
+    case ConditionField::MarketCode: {
+      const auto marketCode = GetMarketCode(valueInStrFmt);
+      if (GetMarketName(marketCode) != valueInStrFmt) {
+        return false;
+      }
+      value = static_cast<std::uint64_t>(marketCode);
+      return true;
+    }
+
+    case ConditionField::SymbolType:
+      return ParseEnumOfConditionField<SymbolType>(valueInStrFmt, value);
+    case ConditionField::Side:
+      return ParseEnumOfConditionField<Side>(valueInStrFmt, value);
+    case ConditionField::PosDirection:
+      return ParseEnumOfConditionField<PosDirection>(valueInStrFmt, value);
+    case ConditionField::PosSide:
+      return ParseEnumOfConditionField<PosSide>(valueInStrFmt, value);
+    case ConditionField::OrderType:
+      return ParseEnumOfConditionField<OrderType>(valueInStrFmt, value);
+    case ConditionField::OrderTypeExtra:
+      return ParseEnumOfConditionField<OrderTypeExtra>(valueInStrFmt, value);
+
+    case ConditionField::SymbolCode:
+    case ConditionField::ParValue:
+    case ConditionField::FeeCurrency:
+      value = XXH3_64bits(valueInStrFmt.data(), valueInStrFmt.size());
+      return true;
+
+    default:
+      return false;
+  }
+}
+
+//! {{"acctId":"10000"}, {"symbolCode":"IF*"}} -> CompiledCondition
+std::tuple<int, std::string, CompiledCondition> CompileConditionTemplate(
+    const ConditionTemplate& conditionTemplate) {
+  CompiledCondition compiledCondition;
+
+  for (const auto& rec : conditionTemplate) {
+    const auto [statusCode, statusMsg, field] = GetConditionField(rec.first);
+    if (statusCode != 0) {
+      return {statusCode, statusMsg, compiledCondition};
+    }
+    compiledCondition.fieldMask_ |= MaskOf(field);
+  }
+
+  auto& exactKey = compiledCondition.exactKey_;
+  exactKey.fieldMask_ = compiledCondition.fieldMask_;
+  exactKey.num_ = __builtin_popcount(compiledCondition.fieldMask_);
+
+  for (const auto& [fieldName, valueInStrFmt] : conditionTemplate) {
+    const auto field = std::get<2>(GetConditionField(fieldName));
+
+    //! 空值或者通配符不参与比较
+    if (valueInStrFmt.empty() || valueInStrFmt == "*") {
+      continue;
+    }
+
+    //! IF* 这样的前缀通配符只对字符串类型的字段有意义
+    if ((field == ConditionField::SymbolCode ||
+         field == ConditionField::FeeCurrency) &&
+        valueInStrFmt.back() == '*') {
+      compiledCondition.prefixGroup_.emplace_back(field, valueInStrFmt);
+      continue;
+    }
+
+    std::uint64_t value = 0;
+    if (!ParseValueOfConditionField(field, valueInStrFmt, value)) {
+      compiledCondition.neverMatch_ = true;
+      continue;
+    }
+
+    const auto pos = __builtin_popcount(compiledCondition.fieldMask_ &
+                                        (MaskOf(field) - 1));
+    compiledCondition.exactMask_ |= MaskOf(field);
+    exactKey.valueGroup_[pos] = value;
+    compiledCondition.cmpMaskGroup_[pos] = UINT64_MAX;
+  }
+
+  return {0, "", compiledCondition};
+}
+
+template <typename T>
+bool GetValueOfConditionField(const T& rec, ConditionField field,
+                              std::uint64_t& value) {
+  switch (field) {
+    case ConditionField::ProductGrpId:
+      value = rec.productGrpId_;
+      return true;
+    case ConditionField::ProductId:
+      value = rec.productId_;
+      return true;
+    case ConditionField::UserId:
+      value = rec.userId_;
+      return true;
+    case ConditionField::AcctGrpId:
+      value = rec.acctGrpId_;
+      return true;
+    case ConditionField::AcctId:
+      value = rec.acctId_;
+      return true;
+    case ConditionField::TrdAcctId:
+      value = rec.trdAcctId_;
+      return true;
+    case ConditionField::StgGrpId:
+      value = rec.stgGrpId_;
+      return true;
+    case ConditionField::StgId:
+      value = rec.stgId_;
+      return true;
+    case ConditionField::StgInstId:
+      value = rec.stgInstId_;
+      return true;
+    case ConditionField::AlgoId:
+      value = rec.algoId_;
+      return true;
+    case ConditionField::MarketCode:
+      value = static_cast<std::uint64_t>(rec.marketCode_);
+      return true;
+    case ConditionField::SymbolType:
+      value = static_cast<std::uint64_t>(rec.symbolType_);
+      return true;
+    case ConditionField::SymbolCode:
+      value = XXH3_64bits(rec.symbolCode_, strlen(rec.symbolCode_));
+      return true;
+    case ConditionField::Side:
+      value = static_cast<std::uint64_t>(rec.side_);
+      return true;
+    case ConditionField::PosSide:
+      value = static_cast<std::uint64_t>(rec.posSide_);
+      return true;
+    case ConditionField::ParValue: {
+      //! 不同结构中parValue_的类型不同，按照格式化之后的字符串取哈希值，
+      //! 和原来的字符串比较的语义一致
+      char buf[64];
+      const auto end = fmt::format_to(buf, FMT_COMPILE("{}"), rec.parValue_);
+      value = XXH3_64bits(buf, end - buf);
+      return true;
+    }
+    case ConditionField::FeeCurrency:
+      value = XXH3_64bits(rec.feeCurrency_, strlen(rec.feeCurrency_));
+      return true;
+
+    case ConditionField::PosDirection:
+      if constexpr (std::is_same_v<T, OrderInfo>) {
+        value = static_cast<std::uint64_t>(rec.posDirection_);
+        return true;
+      }
+      return false;
+    case ConditionField::OrderType:
+      if constexpr (std::is_same_v<T, OrderInfo>) {
+        value = static_cast<std::uint64_t>(rec.orderType_);
+        return true;
+      }
+      return false;
+    case ConditionField::OrderTypeExtra:
+      if constexpr (std::is_same_v<T, OrderInfo>) {
+        value = static_cast<std::uint64_t>(rec.orderTypeExtra_);
+        return true;
+      }
+      return false;
+
+    default:
+      return false;
+  }
+}
+
+template <typename T>
+bool DoMakeConditionKey(const T& rec, ConditionFieldMask fieldMask,
+                        ConditionKey& conditionKey) {
+  conditionKey.fieldMask_ = fieldMask;
+  conditionKey.num_ = 0;
+  while (fieldMask != 0) {
+    const auto field = static_cast<ConditionField>(__builtin_ctz(fieldMask));
+    fieldMask &= fieldMask - 1;
+    auto& value = conditionKey.valueGroup_[conditionKey.num_++];
+    if (!GetValueOfConditionField(rec, field, value)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool MakeConditionKey(const OrderInfo& rec, ConditionFieldMask fieldMask,
+                      ConditionKey& conditionKey) {
+  return DoMakeConditionKey(rec, fieldMask, conditionKey);
+}
+
+bool MakeConditionKey(const PosInfo& rec, ConditionFieldMask fieldMask,
+                      ConditionKey& conditionKey) {
+  return DoMakeConditionKey(rec, fieldMask, conditionKey);
+}
+
+template <typename T>
+bool DoMatchCompiledCondition(const T& rec, const ConditionKey& conditionKey,
+                              const CompiledCondition& compiledCondition) {
+  if (!compiledCondition.matchExactField(conditionKey)) {
+    return false;
+  }
+  for (const auto& [field, prefix] : compiledCondition.prefixGroup_) {
+    const auto value = field == ConditionField::SymbolCode
+                           ? std::string_view(rec.symbolCode_)
+                           : std::string_view(rec.feeCurrency_);
+    if (!matchPrefix(value, prefix)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool MatchCompiledCondition(const OrderInfo& rec,
+                            const ConditionKey& conditionKey,
+                            const CompiledCondition& compiledCondition) {
+  return DoMatchCompiledCondition(rec, conditionKey, compiledCondition);
+}
+
+bool MatchCompiledCondition(const PosInfo& rec,
+                            const ConditionKey& conditionKey,
+                            const CompiledCondition& compiledCondition) {
+  return DoMatchCompiledCondition(rec, conditionKey, compiledCondition);
+}
+
+bool MatchCompiledCondition(const OrderInfo& rec,
+                            const CompiledCondition& compiledCondition) {
+  ConditionKey conditionKey;
+  if (!MakeConditionKey(rec, compiledCondition.fieldMask_, conditionKey)) {
+    return false;
+  }
+  return DoMatchCompiledCondition(rec, conditionKey, compiledCondition);
+}
+
+bool MatchCompiledCondition(const PosInfo& rec,
+                            const CompiledCondition& compiledCondition) {
+  ConditionKey conditionKey;
+  if (!MakeConditionKey(rec, compiledCondition.fieldMask_, conditionKey)) {
+    return false;
+  }
+  return DoMatchCompiledCondition(rec, conditionKey, compiledCondition);
+}
+
+std::string ConditionKey::toStr() const {
+  const auto ret = fmt::format(
+      "fieldMask: {:#x}; valueGroup: [{}]", fieldMask_,
+      fmt::join(valueGroup_.begin(), valueGroup_.begin() + num_, ","));
+  return ret;
+}
+
+std::string CompiledCondition::toStr() const {
+  std::string prefixGroup;
+  for (const auto& [field, prefix] : prefixGroup_) {
+    prefixGroup.append(fmt::format("{}={};", magic_enum::enum_name(field),
+                                   prefix));
+  }
+  const auto ret = fmt::format(
+      "fieldMask: {:#x}; exactMask: {:#x}; exactKey: {}; prefixGroup: [{}]; "
+      "neverMatch: {}",
+      fieldMask_, exactMask_, exactKey_.toStr(), prefixGroup, neverMatch_);
+  return ret;
+}
+
 //! acctId=10000&marketCode=SSE -> acctId&marketCode
 std::string ExtractFieldName(const std::string& cond) {
   std::vector<std::string> fieldName2ValueGroup;
@@ -10,6 +10,7 @@
 
 #include "def/DataStruOfMD.hpp"
 
+#include "SHMIPCTopicRegistry.hpp"
 #include "def/Def.hpp"
 #include "util/BQUtil.hpp"
 #include "util/Datetime.hpp"
@@ -541,6 +542,14 @@ std::string Books::getTDEngSqlRawValuesPart(void* data,
   return ret;
 }
 
+std::string BooksDelta::toStr() const {
+  const auto ret = fmt::format(
+      "{} {} seqNo: {} isFullRefresh: {} numOfAsks: {} numOfBids: {}",
+      shmHeader_.toStr(), mdHeader_.toStr(), seqNo_, isFullRefresh_,
+      numOfAsks_, numOfBids_);
+  return ret;
+}
+
 std::string Bid1Ask1::toStr() const {
   const auto ret =
       fmt::format("{} {} askPrice: {}; askSize: {}; bidPrice: {}; bidSize: {}",
@@ -1152,7 +1161,8 @@ void initMDHeader(SHMHeader& shmHeader, MDHeader& mdHeader, const Doc& doc) {
         MakeTopicInfo(marketCode, symbolType, symbolCode, mdHeader.mdType_);
   }
   shmHeader.topicHash_ = topicHash;
-  strncpy(shmHeader.topic_, topic.c_str(), sizeof(shmHeader.topic_) - 1);
+  shmHeader.topicId_ =
+      SHMIPCTopicRegistry::get_mutable_instance().intern(topic, topicHash);
 }
 
 /*
@@ -933,7 +933,7 @@ Key2PosInfoGroup MakePosUpdateOfAll(
     const PosUpdateOfAllForPubSPtr& posUpdateOfAllForPub) {
   Key2PosInfoGroup ret;
   auto posInfoAddr = posUpdateOfAllForPub->posInfoGroup_;
-  for (std::uint16_t i = 0; i < posUpdateOfAllForPub->num_; ++i) {
+  for (std::uint32_t i = 0; i < posUpdateOfAllForPub->num_; ++i) {
     const auto posInfoRecv = reinterpret_cast<const PosInfo*>(posInfoAddr);
     const auto posInfo = std::make_shared<PosInfo>(*posInfoRecv);
     ret.emplace(posInfo->getKey(), posInfo);
@@ -10,16 +10,129 @@
 
 #include "def/RawMD.hpp"
 
+#include "SHMIPCTopicRegistry.hpp"
+#include "util/LatencyTrace.hpp"
+#include "util/RawMDPool.hpp"
+#include "util/SymbolRegistry.hpp"
+
 namespace bq {
 
+RawMD::RawMD(MsgType msgType, const void* data, std::uint32_t dataLen,
+             bool isLast, std::uint64_t localTs) {
+  init(msgType, dataLen, isLast, localTs);
+  data_ = malloc(dataLen);
+  memcpy(data_, data, dataLen_);
+}
+
+RawMD::RawMD(const RawMDPoolSPtr& rawMDPool, MsgType msgType, const void* data,
+             std::uint32_t dataLen, bool isLast, std::uint64_t localTs)
+    : rawMDPool_(rawMDPool) {
+  init(msgType, dataLen, isLast, localTs);
+  data_ = rawMDPool_->allocData(dataLen);
+  memcpy(data_, data, dataLen_);
+}
+
+RawMD::~RawMD() {
+  if (rawMDPool_ != nullptr) {
+    rawMDPool_->freeData(data_);
+    rawMDPool_->freeData(dataAfterConv_);
+  } else {
+    SAFE_FREE(data_);
+    SAFE_FREE(dataAfterConv_);
+  }
+}
+
+void* RawMD::allocDataAfterConv(std::uint32_t dataAfterConvLen) {
+  if (rawMDPool_ != nullptr) {
+    dataAfterConv_ = rawMDPool_->allocData(dataAfterConvLen);
+    memset(dataAfterConv_, 0, dataAfterConvLen);
+  } else {
+    dataAfterConv_ = calloc(1, dataAfterConvLen);
+  }
+  dataAfterConvLen_ = dataAfterConvLen;
+  return dataAfterConv_;
+}
+
+void RawMD::init(MsgType msgType, std::uint32_t dataLen, bool isLast,
+                 std::uint64_t localTs) {
+  msgType_ = msgType;
+  localTs_ = localTs;
+  tscOfRecv_ = LatencyTrace::get_mutable_instance().stamp(TraceHop::MDRecv, 0);
+  dataLen_ = dataLen;
+  isLast_ = isLast;
+
+  switch (msgType) {
+    case MsgType::Tickers:
+      mdType_ = MDType::Tickers;
+      break;
+    case MsgType::Trades:
+      mdType_ = MDType::Trades;
+      break;
+    case MsgType::Orders:
+      mdType_ = MDType::Orders;
+      break;
+    case MsgType::Books:
+      mdType_ = MDType::Books;
+      break;
+    case MsgType::Candle:
+      mdType_ = MDType::Candle;
+      break;
+    case MsgType::Bid1Ask1:
+      mdType_ = MDType::Bid1Ask1;
+      break;
+    case MsgType::LastPrice:
+      mdType_ = MDType::LastPrice;
+      break;
+    case MsgType::DynCandle:
+      mdType_ = MDType::DynCandle;
+      break;
+    default:
+      mdType_ = MDType::Others;
+      break;
+  }
+}
+
 //! MD@SH@Spot@600600@Tickers
 void InitTopicInfo(RawMDSPtr& rawMD) {
-  rawMD->topic_ = fmt::format(
-      "{}{}{}{}{}{}{}{}{}", TOPIC_PREFIX_OF_MARKET_DATA, SEP_OF_TOPIC,
-      GetMarketName(rawMD->marketCode_), SEP_OF_TOPIC,
-      magic_enum::enum_name(rawMD->symbolType_), SEP_OF_TOPIC,
-      rawMD->symbolCode_, SEP_OF_TOPIC, magic_enum::enum_name(rawMD->mdType_));
+  //! 品种登记之后topic和topicHash都是预先生成的，这里只需要查一次索引表
+  auto& symbolRegistry = SymbolRegistry::get_mutable_instance();
+  rawMD->symbolId_ = symbolRegistry.intern(
+      rawMD->marketCode_, rawMD->symbolType_, rawMD->symbolCode_);
+  const auto symbol = symbolRegistry.getSymbol(rawMD->symbolId_);
+  const auto topicInfo =
+      symbol != nullptr ? symbol->getTopicInfo(rawMD->mdType_) : nullptr;
+  if (topicInfo != nullptr) {
+    rawMD->topic_ = topicInfo->topic_;
+    rawMD->topicHash_ = topicInfo->topicHash_;
+    rawMD->topicId_ = topicInfo->getTopicId();
+    return;
+  }
+
+  //! 注册表已满或者mdType为Others的时候现场生成
+  rawMD->topic_ = MakeTopicOfSymbol(rawMD->marketCode_, rawMD->symbolType_,
+                                    rawMD->symbolCode_, rawMD->mdType_);
   rawMD->topicHash_ = XXH3_64bits(rawMD->topic_.data(), rawMD->topic_.size());
+  rawMD->topicId_ = SHMIPCTopicRegistry::get_mutable_instance().intern(
+      rawMD->topic_, rawMD->topicHash_);
+}
+
+//! 由rawMD生成的其他类型行情的topic信息，比如由Tickers生成的Bid1Ask1
+std::tuple<TopicHash, TopicId> GetTopicInfoOfMDType(const RawMDSPtr& rawMD,
+                                                    MDType mdType) {
+  const auto symbol =
+      SymbolRegistry::get_const_instance().getSymbol(rawMD->symbolId_);
+  const auto topicInfo =
+      symbol != nullptr ? symbol->getTopicInfo(mdType) : nullptr;
+  if (topicInfo != nullptr) {
+    return {topicInfo->topicHash_, topicInfo->getTopicId()};
+  }
+
+  const auto topic = MakeTopicOfSymbol(rawMD->marketCode_, rawMD->symbolType_,
+                                       rawMD->symbolCode_, mdType);
+  const auto topicHash = XXH3_64bits(topic.data(), topic.size());
+  const auto topicId =
+      SHMIPCTopicRegistry::get_mutable_instance().intern(topic, topicHash);
+  return {topicHash, topicId};
 }
 
 }  // namespace bq
@@ -13,6 +13,7 @@
 #include "def/BQConst.hpp"
 #include "def/BQDef.hpp"
 #include "def/Const.hpp"
+#include "def/DataStruOfTD.hpp"
 #include "def/Def.hpp"
 #include "def/StatusCode.hpp"
 #include "util/Decimal.hpp"
@@ -229,4 +230,37 @@ std::string ConvertSimedTDInfoToJsonFmt(const SimedTDInfoSPtr& simedTDInfo) {
   return strBuf.GetString();
 }
 
+void UpdateOrderInfoByTransDetail(const OrderInfoSPtr& orderInfo,
+                                  const TransDetailSPtr& transDetail,
+                                  const std::string& tradeId,
+                                  std::uint64_t dealTime) {
+  const auto dealSize = orderInfo->orderSize_ * transDetail->filledPer_;
+  const auto slippage = orderInfo->orderPrice_ * transDetail->slippage_;
+  const auto dealPrice = orderInfo->side_ == Side::Bid
+                             ? orderInfo->orderPrice_ - slippage
+                             : orderInfo->orderPrice_ + slippage;
+  UpdateOrderInfoByFill(orderInfo, dealPrice, dealSize, tradeId, dealTime);
+}
+
+void UpdateOrderInfoByFill(const OrderInfoSPtr& orderInfo, Decimal dealPrice,
+                           Decimal dealSize, const std::string& tradeId,
+                           std::uint64_t dealTime) {
+  strncpy(orderInfo->lastTradeId_, tradeId.c_str(),
+          sizeof(orderInfo->lastTradeId_) - 1);
+  orderInfo->lastDealPrice_ = dealPrice;
+  orderInfo->lastDealSize_ =
+      orderInfo->side_ == Side::Bid ? dealSize : dealSize * -1;
+  orderInfo->lastDealTime_ = dealTime;
+
+  //! 计算成交均价
+  const auto prevDealAmt = orderInfo->avgDealPrice_ * orderInfo->dealSize_;
+  const auto lastDealAmt = orderInfo->lastDealPrice_ * orderInfo->lastDealSize_;
+  const auto totalDealSize = orderInfo->dealSize_ + orderInfo->lastDealSize_;
+  if (!DEC::ZERO(totalDealSize)) {
+    orderInfo->avgDealPrice_ = (prevDealAmt + lastDealAmt) / totalDealSize;
+  }
+  //! 成交数量
+  orderInfo->dealSize_ = totalDealSize;
+}
+
 }  // namespace bq
@@ -12,6 +12,7 @@
 
 #include "def/StatusCode.hpp"
 #include "util/Logger.hpp"
+#include "util/SymbolRegistry.hpp"
 
 namespace bq {
 
@@ -24,6 +25,9 @@ void SymbolInfoTable::add(const SymbolInfoSPtr& symbolInfo) {
             symbolInfo->toStr());
     }
   }
+  SymbolRegistry::get_mutable_instance().intern(
+      symbolInfo->marketCode_, symbolInfo->symbolType_,
+      symbolInfo->symbolCode_, symbolInfo->exchSymbolCode_);
 }
 
 std::tuple<int, SymbolInfoSPtr> SymbolInfoTable::getSymbolInfoBySym(
@@ -0,0 +1,120 @@
+/*!
+ * \file BooksRebuilder.cpp
+ * \project BetterQuant
+ *
+ * \author byrnexu
+ * \date 2023/03/24
+ *
+ * \brief
+ */
+
+#include "util/BooksRebuilder.hpp"
+
+#include "SHMIPC.hpp"
+#include "def/StatusCode.hpp"
+#include "util/Decimal.hpp"
+#include "util/Logger.hpp"
+
+namespace bq {
+
+BooksRebuilder::BooksRebuilder(
+    const BooksSnapshotReqCallback& booksSnapshotReqCallback)
+    : booksSnapshotReqCallback_(booksSnapshotReqCallback) {}
+
+template <typename DepthGroup>
+void BooksRebuilder::mergeDepth(DepthGroup& depthGroup, const Depth* depthDelta,
+                                std::uint32_t numOfDepthDelta) {
+  for (std::uint32_t i = 0; i < numOfDepthDelta; ++i) {
+    const auto& depth = depthDelta[i];
+    if (DEC::ZERO(depth.size_)) {
+      depthGroup.erase(depth.price_);
+    } else {
+      depthGroup[depth.price_] = depth;
+    }
+  }
+}
+
+template <typename DepthGroup>
+void BooksRebuilder::copyDepth(const DepthGroup& depthGroup, Depth* depth) {
+  std::uint32_t lvl = 0;
+  for (auto iter = std::begin(depthGroup);
+       iter != std::end(depthGroup) && lvl < MAX_DEPTH_LEVEL; ++iter, ++lvl) {
+    depth[lvl] = iter->second;
+  }
+  for (; lvl < MAX_DEPTH_LEVEL; ++lvl) {
+    depth[lvl] = Depth();
+  }
+}
+
+int BooksRebuilder::rebuild(const BooksDelta* booksDelta, Books* books) {
+  const auto topicHash = booksDelta->shmHeader_.topicHash_;
+  const auto booksOfRebuilder = getBooksOfRebuilder(topicHash);
+
+  //! 同一个topic只会在同一个行情服务的接收线程中处理，不需要再加锁
+  if (booksDelta->isFullRefresh_) {
+    booksOfRebuilder->asks_.clear();
+    booksOfRebuilder->bids_.clear();
+    booksOfRebuilder->isReady_ = true;
+    booksOfRebuilder->isSnapshotReqSent_ = false;
+  } else if (!booksOfRebuilder->isReady_) {
+    reqSnapshotIfNotSent(booksDelta, *booksOfRebuilder);
+    return SCODE_BQPUB_BOOKS_NOT_READY;
+  } else if (booksDelta->seqNo_ != booksOfRebuilder->seqNo_ + 1) {
+    LOG_W(
+        "The seq no of books delta {} is discontinuous, "
+        "request full refresh. [prev = {}; curr = {}]",
+        booksDelta->mdHeader_.symbolCode_, booksOfRebuilder->seqNo_,
+        booksDelta->seqNo_);
+    booksOfRebuilder->isReady_ = false;
+    reqSnapshotIfNotSent(booksDelta, *booksOfRebuilder);
+    return SCODE_BQPUB_BOOKS_DELTA_DISCONTINUOUS;
+  }
+  booksOfRebuilder->seqNo_ = booksDelta->seqNo_;
+
+  mergeDepth(booksOfRebuilder->asks_, booksDelta->asks(),
+             booksDelta->numOfAsks_);
+  mergeDepth(booksOfRebuilder->bids_, booksDelta->bids(),
+             booksDelta->numOfBids_);
+
+  books->shmHeader_ = booksDelta->shmHeader_;
+  books->shmHeader_.msgId_ = MSG_ID_ON_MD_BOOKS;
+  books->mdHeader_ = booksDelta->mdHeader_;
+  //! 增量中没有这些字段，和直接推送的Books一样置0
+  books->lastPrice_ = 0;
+  books->totalVol_ = 0;
+  books->totalAmt_ = 0;
+  books->tradesCount_ = 0;
+  memset(books->tradingDay_, 0, sizeof(books->tradingDay_));
+  copyDepth(booksOfRebuilder->asks_, books->asks_);
+  copyDepth(booksOfRebuilder->bids_, books->bids_);
+  books->extDataLen_ = 0;
+
+  return 0;
+}
+
+BooksOfRebuilderSPtr BooksRebuilder::getBooksOfRebuilder(TopicHash topicHash) {
+  std::lock_guard<std::ext::spin_mutex> guard(mtxTopicHash2BooksOfRebuilder_);
+  auto& ret = topicHash2BooksOfRebuilder_[topicHash];
+  if (ret == nullptr) {
+    ret = std::make_shared<BooksOfRebuilder>();
+  }
+  return ret;
+}
+
+void BooksRebuilder::reqSnapshotIfNotSent(const BooksDelta* booksDelta,
+                                          BooksOfRebuilder& booksOfRebuilder) {
+  if (!booksSnapshotReqCallback_ || booksOfRebuilder.isSnapshotReqSent_) {
+    return;
+  }
+  booksOfRebuilder.isSnapshotReqSent_ = true;
+  LOG_I("Request full refresh of books {}. [seqNo = {}]",
+        booksDelta->mdHeader_.symbolCode_, booksOfRebuilder.seqNo_);
+  booksSnapshotReqCallback_(booksDelta->mdHeader_, booksOfRebuilder.seqNo_);
+}
+
+void BooksRebuilder::reset() {
+  std::lock_guard<std::ext::spin_mutex> guard(mtxTopicHash2BooksOfRebuilder_);
+  topicHash2BooksOfRebuilder_.clear();
+}
+
+}  // namespace bq
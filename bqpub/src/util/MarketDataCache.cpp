@@ -17,12 +17,24 @@
 #include "util/Datetime.hpp"
 #include "util/Decimal.hpp"
 #include "util/Logger.hpp"
+#include "util/SymbolRegistry.hpp"
 
 namespace bq {
 
-MarketDataCache::MarketDataCache() {}
+//! 槽位按缓存行对齐，避免不同品种的写入互相干扰
+struct alignas(64) TickersSlot {
+  std::atomic<TopicHash> topicHash_{0};
+  std::atomic<std::uint64_t> seqNo_{0};
+  Tickers tickers_;
+};
 
-void MarketDataCache::cache(const TickersSPtr& tickers) {
+MarketDataCache::MarketDataCache(std::uint32_t maxNumOfSymbol)
+    : numOfSlot_(getNumOfSlot(maxNumOfSymbol)),
+      slots_(std::make_unique<TickersSlot[]>(numOfSlot_)) {}
+
+MarketDataCache::~MarketDataCache() {}
+
+void MarketDataCache::cache(const Tickers* tickers) {
 #ifndef NDEBUG
   std::uint64_t loggerThreshold = 100000;
 #else
@@ -30,27 +42,39 @@ void MarketDataCache::cache(const TickersSPtr& tickers) {
 #endif
 
   //! xtp有收到一些价格为0的tickers，但是有昨收或者昨结这样的数据，这里不过滤
-  {
-    std::lock_guard<std::ext::spin_mutex> guard(mtxTopic2LastTickersGroup_);
-    topic2LastTickersGroup_[tickers->shmHeader_.topicHash_] = tickers;
-    if (++timesOfRecvTickers_ % loggerThreshold == 0) {
-      LOG_D("===== TICKERS CACHE ===== {} \n{}", timesOfRecvTickers_,
-            tickers2Str());
-    }
+  const auto symbolId = findOrAllocSlot(tickers->shmHeader_.topicHash_);
+  if (symbolId == INVALID_SYMBOL_ID) {
+    LOG_W("Cache tickers of {} failed because of no free slot. [num = {}]",
+          tickers->mdHeader_.symbolCode_, numOfSlot_);
+    return;
+  }
+
+  //! 序列号为奇数表示正在写入，同一个品种一般只有一个写入方，这里用cas兼容多个
+  auto& slot = slots_[symbolId];
+  auto seqNo = slot.seqNo_.load(std::memory_order_relaxed);
+  while ((seqNo & 1) != 0 ||
+         !slot.seqNo_.compare_exchange_weak(seqNo, seqNo + 1,
+                                            std::memory_order_acquire)) {
+    seqNo = slot.seqNo_.load(std::memory_order_relaxed);
+  }
+  std::atomic_thread_fence(std::memory_order_release);
+  memcpy(&slot.tickers_, tickers, sizeof(Tickers));
+  slot.tickers_.extDataLen_ = 0;
+  slot.seqNo_.store(seqNo + 2, std::memory_order_release);
+
+  if (++timesOfRecvTickers_ % loggerThreshold == 0) {
+    LOG_D("===== TICKERS CACHE ===== {} \n{}", timesOfRecvTickers_.load(),
+          tickers2Str());
   }
 }
 
 //! topic = MD@Binance@Spot@BTC-USDT@Tickers
 //! topic = MD@SSE@Spot@600600@Tickers
 TickersSPtr MarketDataCache::getLastTickers(const std::string& topic) {
-  TickersSPtr ret;
   const auto topicHash = XXH3_64bits(topic.data(), topic.size());
-  {
-    std::lock_guard<std::ext::spin_mutex> guard(mtxTopic2LastTickersGroup_);
-    const auto iter = topic2LastTickersGroup_.find(topicHash);
-    if (iter != std::end(topic2LastTickersGroup_)) {
-      ret = iter->second;
-    }
+  auto ret = std::make_shared<Tickers>();
+  if (!getLastTickers(topicHash, *ret)) {
+    return nullptr;
   }
   return ret;
 }
@@ -60,18 +84,116 @@ TickersSPtr MarketDataCache::getLastTickers(const std::string& topic) {
 TickersSPtr MarketDataCache::getLastTickers(MarketCode marketCode,
                                             SymbolType symbolType,
                                             const std::string& symbolCode) {
-  const auto topic =
-      fmt::format("{}{}{}{}{}{}{}{}{}", TOPIC_PREFIX_OF_MARKET_DATA,
-                  SEP_OF_TOPIC, GetMarketName(marketCode), SEP_OF_TOPIC,
-                  magic_enum::enum_name(symbolType), SEP_OF_TOPIC, symbolCode,
-                  SEP_OF_TOPIC, magic_enum::enum_name(MDType::Tickers));
-  return getLastTickers(topic);
+  const auto topicHash = SymbolRegistry::get_mutable_instance().getTopicHash(
+      marketCode, symbolType, symbolCode, MDType::Tickers);
+  auto ret = std::make_shared<Tickers>();
+  if (!getLastTickers(topicHash, *ret)) {
+    return nullptr;
+  }
+  return ret;
+}
+
+bool MarketDataCache::getLastTickers(TopicHash topicHash,
+                                     Tickers& tickers) const {
+  const auto symbolId = findSlot(topicHash);
+  if (symbolId == INVALID_SYMBOL_ID) {
+    return false;
+  }
+  return readSlot(symbolId, tickers);
+}
+
+SymbolId MarketDataCache::getSymbolId(MarketCode marketCode,
+                                      SymbolType symbolType,
+                                      const std::string& symbolCode) {
+  const auto topicHash = SymbolRegistry::get_mutable_instance().getTopicHash(
+      marketCode, symbolType, symbolCode, MDType::Tickers);
+  //! 行情还没到的时候先占用槽位，之后的行情写入同一个槽位
+  return findOrAllocSlot(topicHash);
+}
+
+bool MarketDataCache::getLastTickers(MarketCode marketCode,
+                                     SymbolType symbolType, SymbolId symbolId,
+                                     Tickers& tickers) const {
+  if (symbolId >= numOfSlot_) {
+    return false;
+  }
+  if (!readSlot(symbolId, tickers)) {
+    return false;
+  }
+  return tickers.mdHeader_.marketCode_ == marketCode &&
+         tickers.mdHeader_.symbolType_ == symbolType;
+}
+
+//! 槽位数量取2的幂并且至少是品种数量的2倍，保证开放寻址的探测长度
+std::uint32_t MarketDataCache::getNumOfSlot(std::uint32_t maxNumOfSymbol) {
+  std::uint32_t ret = 1;
+  while (ret < maxNumOfSymbol * 2) {
+    ret <<= 1;
+  }
+  return ret;
+}
+
+SymbolId MarketDataCache::findSlot(TopicHash topicHash) const {
+  const auto mask = numOfSlot_ - 1;
+  auto symbolId = static_cast<SymbolId>(topicHash & mask);
+  for (std::uint32_t i = 0; i < numOfSlot_; ++i) {
+    const auto topicHashInSlot =
+        slots_[symbolId].topicHash_.load(std::memory_order_acquire);
+    if (topicHashInSlot == topicHash) {
+      return symbolId;
+    }
+    if (topicHashInSlot == 0) {
+      return INVALID_SYMBOL_ID;
+    }
+    symbolId = (symbolId + 1) & mask;
+  }
+  return INVALID_SYMBOL_ID;
+}
+
+SymbolId MarketDataCache::findOrAllocSlot(TopicHash topicHash) {
+  const auto mask = numOfSlot_ - 1;
+  auto symbolId = static_cast<SymbolId>(topicHash & mask);
+  for (std::uint32_t i = 0; i < numOfSlot_; ++i) {
+    auto& topicHashInSlot = slots_[symbolId].topicHash_;
+    TopicHash expected = topicHashInSlot.load(std::memory_order_acquire);
+    if (expected == 0 && topicHashInSlot.compare_exchange_strong(
+                             expected, topicHash, std::memory_order_acq_rel)) {
+      return symbolId;
+    }
+    if (expected == topicHash) {
+      return symbolId;
+    }
+    symbolId = (symbolId + 1) & mask;
+  }
+  return INVALID_SYMBOL_ID;
+}
+
+bool MarketDataCache::readSlot(SymbolId symbolId, Tickers& tickers) const {
+  const auto& slot = slots_[symbolId];
+  while (true) {
+    const auto seqNoBeforeRead = slot.seqNo_.load(std::memory_order_acquire);
+    if (seqNoBeforeRead == 0) {
+      //! 槽位已分配但是还没有收到过行情
+      return false;
+    }
+    if ((seqNoBeforeRead & 1) != 0) {
+      continue;
+    }
+    memcpy(&tickers, &slot.tickers_, sizeof(Tickers));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.seqNo_.load(std::memory_order_relaxed) == seqNoBeforeRead) {
+      return true;
+    }
+  }
 }
 
 std::string MarketDataCache::tickers2Str() const {
   std::string ret;
-  for (const auto& rec : topic2LastTickersGroup_) {
-    ret = ret + rec.second->toStr() + "\n";
+  Tickers tickers;
+  for (SymbolId symbolId = 0; symbolId < numOfSlot_; ++symbolId) {
+    if (readSlot(symbolId, tickers)) {
+      ret = ret + tickers.toStr() + "\n";
+    }
   }
   return ret;
 }
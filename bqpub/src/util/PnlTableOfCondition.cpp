@@ -0,0 +1,190 @@
+/*!
+ * \file PnlTableOfCondition.cpp
+ * \project BetterQuant
+ *
+ * \author byrnexu
+ * \date 2023/04/21
+ *
+ * \brief
+ */
+
+#include "util/PnlTableOfCondition.hpp"
+
+#include "util/Datetime.hpp"
+#include "util/Logger.hpp"
+#include "util/SHMUtil.hpp"
+#include "util/Util.hpp"
+
+namespace bq {
+
+std::uint64_t PnlOfCondition::delay() const {
+  const auto realDelay = GetTotalSecSince1970() - updateTime_ / 1000000;
+  return realDelay;
+}
+
+void PnlTableOfCondition::load(const std::string& segmentIdentity,
+                               std::uint32_t maxNumOfCondition) {
+  const auto numOfSlot = CalcNumOfSlot(maxNumOfCondition);
+  const auto len = sizeof(PnlTableHeaderOfCondition) +
+                   numOfSlot * sizeof(PnlSlotOfCondition) + 64 * 1024;
+  segment_ = std::make_shared<bip::managed_shared_memory>(
+      bip::open_or_create, segmentIdentity.c_str(), len);
+
+  header_ = segment_->find_or_construct<PnlTableHeaderOfCondition>(
+      NAME_OF_PNL_TABLE_HEADER)(numOfSlot);
+  slots_ = segment_->find_or_construct<PnlSlotOfCondition>(
+      NAME_OF_PNL_SLOT_GROUP)[header_->numOfSlot_]();
+
+  LOG_I("Load pnl table of condition from segment {}. [numOfSlot = {}] {}",
+        segmentIdentity, header_->numOfSlot_, FreeSegmentPerDesc(*segment_));
+}
+
+bool PnlTableOfCondition::reg(const std::string& condition) {
+  if (condition.empty() || condition.size() >= MAX_CONDITION_LEN) {
+    LOG_W("Reg condition {} to pnl table failed because of invalid len.",
+          condition);
+    return false;
+  }
+
+  const auto hashOfCondition = XXH3_64bits(condition.data(), condition.size());
+  const auto mask = header_->numOfSlot_ - 1;
+  auto slotNo = static_cast<std::uint32_t>(hashOfCondition & mask);
+  for (std::uint32_t i = 0; i < header_->numOfSlot_; ++i) {
+    auto& slot = slots_[slotNo];
+    std::uint64_t expected =
+        slot.hashOfCondition_.load(std::memory_order_acquire);
+    if (expected == 0 && slot.hashOfCondition_.compare_exchange_strong(
+                             expected, hashOfCondition,
+                             std::memory_order_acq_rel)) {
+      memcpy(slot.condition_, condition.data(), condition.size());
+      slot.condition_[condition.size()] = '\0';
+      slot.lenOfCondition_.store(condition.size(), std::memory_order_release);
+      LOG_I("Reg condition {} to slot {} of pnl table.", condition, slotNo);
+      return true;
+    }
+    if (expected == hashOfCondition) {
+      return true;
+    }
+    slotNo = (slotNo + 1) & mask;
+  }
+
+  LOG_W("Reg condition {} to pnl table failed because of no free slot.",
+        condition);
+  return false;
+}
+
+std::uint32_t PnlTableOfCondition::resetSeqNoOfWriter() {
+  std::uint32_t ret = 0;
+  for (std::uint32_t slotNo = 0; slotNo < header_->numOfSlot_; ++slotNo) {
+    auto& slot = slots_[slotNo];
+    const auto seqNo = slot.seqNo_.load(std::memory_order_acquire);
+    if ((seqNo & 1) == 0) {
+      continue;
+    }
+    //! 盈亏可能只写了一半，清空之后updateTime_为0，读取方会按超时处理
+    slot.pnlOfCondition_ = PnlOfCondition();
+    slot.seqNo_.store(seqNo + 1, std::memory_order_release);
+    LOG_W("Reset seq no {} of slot {} left by the last writer.", seqNo,
+          slotNo);
+    ++ret;
+  }
+  return ret;
+}
+
+std::uint32_t PnlTableOfCondition::update(
+    const CalcPnlOfConditionCallback& calcPnlOfCondition) {
+  std::uint32_t ret = 0;
+  PnlOfCondition pnlOfCondition;
+  for (std::uint32_t slotNo = 0; slotNo < header_->numOfSlot_; ++slotNo) {
+    auto& slot = slots_[slotNo];
+    const auto lenOfCondition =
+        slot.lenOfCondition_.load(std::memory_order_acquire);
+    if (lenOfCondition == 0) {
+      continue;
+    }
+
+    const auto condition = std::string(slot.condition_, lenOfCondition);
+    if (calcPnlOfCondition(condition, pnlOfCondition) != 0) {
+      continue;
+    }
+
+    //! 序列号为奇数表示正在写入，风控服务一般只有一个写入方，这里用cas兼容多个
+    auto seqNo = slot.seqNo_.load(std::memory_order_relaxed);
+    while ((seqNo & 1) != 0 ||
+           !slot.seqNo_.compare_exchange_weak(seqNo, seqNo + 1,
+                                              std::memory_order_acquire)) {
+      seqNo = slot.seqNo_.load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(&slot.pnlOfCondition_, &pnlOfCondition, sizeof(PnlOfCondition));
+    slot.seqNo_.store(seqNo + 2, std::memory_order_release);
+    ++ret;
+  }
+  return ret;
+}
+
+bool PnlTableOfCondition::getPnl(std::uint64_t hashOfCondition,
+                                 PnlOfCondition& pnlOfCondition) const {
+  const auto slot = findSlot(hashOfCondition);
+  if (slot == nullptr) {
+    return false;
+  }
+
+  for (std::uint32_t i = 0; i < MAX_NUM_OF_RETRY_OF_GET_PNL; ++i) {
+    const auto seqNoBeforeRead = slot->seqNo_.load(std::memory_order_acquire);
+    if (seqNoBeforeRead == 0) {
+      //! 条件已经注册但是风控服务还没有计算过盈亏
+      return false;
+    }
+    if ((seqNoBeforeRead & 1) == 0) {
+      memcpy(&pnlOfCondition, &slot->pnlOfCondition_, sizeof(PnlOfCondition));
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (slot->seqNo_.load(std::memory_order_relaxed) == seqNoBeforeRead) {
+        return true;
+      }
+    }
+    if (i < NUM_OF_RETRY_OF_GET_PNL_BEFORE_YIELD) {
+      CpuRelax();
+    } else {
+      std::this_thread::yield();
+    }
+  }
+
+  //! 写入方可能在写入过程中退出，序列号停留在奇数，不能一直重读
+  return false;
+}
+
+std::uint32_t PnlTableOfCondition::getNumOfSlot() const {
+  return header_->numOfSlot_;
+}
+
+//! 槽位数量取2的幂并且至少是条件数量的2倍，保证开放寻址的探测长度
+std::uint32_t PnlTableOfCondition::CalcNumOfSlot(
+    std::uint32_t maxNumOfCondition) {
+  std::uint32_t ret = 1;
+  while (ret < maxNumOfCondition * 2) {
+    ret <<= 1;
+  }
+  return ret;
+}
+
+PnlSlotOfCondition* PnlTableOfCondition::findSlot(
+    std::uint64_t hashOfCondition) const {
+  const auto mask = header_->numOfSlot_ - 1;
+  auto slotNo = static_cast<std::uint32_t>(hashOfCondition & mask);
+  for (std::uint32_t i = 0; i < header_->numOfSlot_; ++i) {
+    auto& slot = slots_[slotNo];
+    const auto hashOfConditionInSlot =
+        slot.hashOfCondition_.load(std::memory_order_acquire);
+    if (hashOfConditionInSlot == hashOfCondition) {
+      return &slot;
+    }
+    if (hashOfConditionInSlot == 0) {
+      return nullptr;
+    }
+    slotNo = (slotNo + 1) & mask;
+  }
+  return nullptr;
+}
+
+}  // namespace bq
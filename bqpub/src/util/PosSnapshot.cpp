@@ -25,6 +25,10 @@ const std::map<std::string, PosInfoSPtr>& PosSnapshot::getPosInfoDetail()
   return posSnapshotImpl_->getPosInfoDetail();
 }
 
+void PosSnapshot::applyPosDelta(const PosDelta& posDelta) {
+  posSnapshotImpl_->applyPosDelta(posDelta);
+}
+
 std::tuple<int, PnlSPtr> PosSnapshot::queryPnl(
     const std::string& groupCond, const std::string& quoteCurrencyForCalc,
     const std::string& quoteCurrencyForConv,
@@ -30,6 +30,18 @@ const std::map<std::string, PosInfoSPtr>& PosSnapshotImpl::getPosInfoDetail()
   return posInfoDetail_;
 }
 
+void PosSnapshotImpl::applyPosDelta(const PosDelta& posDelta) {
+  const auto key = posDelta.posInfo_.getKey();
+  if (posDelta.posDeltaType_ == PosDeltaType::Del) {
+    posInfoDetail_.erase(key);
+  } else {
+    //! 之前查询返回的结果可能还持有旧的仓位，所以替换指针而不是原地修改
+    posInfoDetail_[key] = std::make_shared<PosInfo>(posDelta.posInfo_);
+  }
+  cond2Key2PnlGroup_.clear();
+  cond2Key2PosInfoBundle_.clear();
+}
+
 std::tuple<int, PnlSPtr> PosSnapshotImpl::queryPnl(
     const std::string& queryCond, const std::string& quoteCurrencyForCalc,
     const std::string& quoteCurrencyForConv,
@@ -0,0 +1,99 @@
+/*!
+ * \file PosSnapshotRebuilder.cpp
+ * \project BetterQuant
+ *
+ * \author byrnexu
+ * \date 2023/04/20
+ *
+ * \brief
+ */
+
+#include "util/PosSnapshotRebuilder.hpp"
+
+#include "SHMIPC.hpp"
+#include "def/PosInfo.hpp"
+#include "def/StatusCode.hpp"
+#include "util/Logger.hpp"
+#include "util/PosSnapshot.hpp"
+
+namespace bq {
+
+PosSnapshotRebuilder::PosSnapshotRebuilder(
+    const PosKeyframeReqCallback& posKeyframeReqCallback,
+    const MarketDataCacheSPtr& marketDataCache)
+    : posKeyframeReqCallback_(posKeyframeReqCallback),
+      marketDataCache_(marketDataCache) {}
+
+int PosSnapshotRebuilder::rebuild(const void* shmBuf) {
+  const auto shmHeader = static_cast<const SHMHeader*>(shmBuf);
+  switch (shmHeader->msgId_) {
+    case MSG_ID_POS_UPDATE_OF_ALL:
+    case MSG_ID_POS_SNAPSHOT_OF_ALL:
+      return onPosKeyframe(static_cast<const PosUpdateOfAllForPub*>(shmBuf));
+    case MSG_ID_POS_DELTA_OF_ALL:
+      return onPosDelta(static_cast<const PosDeltaOfAllForPub*>(shmBuf));
+    default:
+      LOG_W("Unable to rebuild pos snapshot by msgId {} - {}.",
+            shmHeader->msgId_, GetMsgName(shmHeader->msgId_));
+      return SCODE_BQPUB_POS_SNAPSHOT_NOT_READY;
+  }
+}
+
+int PosSnapshotRebuilder::onPosKeyframe(
+    const PosUpdateOfAllForPub* posUpdateOfAllForPub) {
+  Key2PosInfoGroup posInfoDetail;
+  auto posInfoAddr = posUpdateOfAllForPub->posInfoGroup_;
+  for (std::uint32_t i = 0; i < posUpdateOfAllForPub->num_; ++i) {
+    const auto posInfoRecv = reinterpret_cast<const PosInfo*>(posInfoAddr);
+    const auto posInfo = std::make_shared<PosInfo>(*posInfoRecv);
+    posInfoDetail.emplace(posInfo->getKey(), posInfo);
+    posInfoAddr += sizeof(PosInfo);
+  }
+  posSnapshot_ = std::make_shared<PosSnapshot>(posInfoDetail, marketDataCache_);
+
+  if (!isReady_) {
+    LOG_I("Pos snapshot of all is ready. [seqNo = {}; num = {}]",
+          posUpdateOfAllForPub->seqNo_, posUpdateOfAllForPub->num_);
+  }
+  seqNo_ = posUpdateOfAllForPub->seqNo_;
+  isReady_ = true;
+  return 0;
+}
+
+int PosSnapshotRebuilder::onPosDelta(
+    const PosDeltaOfAllForPub* posDeltaOfAllForPub) {
+  if (!isReady_) {
+    return SCODE_BQPUB_POS_SNAPSHOT_NOT_READY;
+  }
+
+  //! 关键帧中已经包含的增量直接丢弃
+  if (posDeltaOfAllForPub->seqNo_ <= seqNo_) {
+    LOG_D("Discard pos delta which is already in keyframe. [{} <= {}]",
+          posDeltaOfAllForPub->seqNo_, seqNo_);
+    return SCODE_BQPUB_POS_SNAPSHOT_NOT_READY;
+  }
+
+  if (posDeltaOfAllForPub->seqNo_ != seqNo_ + 1) {
+    LOG_W(
+        "The seq no of pos delta is discontinuous, "
+        "request keyframe. [prev = {}; curr = {}]",
+        seqNo_, posDeltaOfAllForPub->seqNo_);
+    isReady_ = false;
+    if (posKeyframeReqCallback_) {
+      posKeyframeReqCallback_(seqNo_);
+    }
+    return SCODE_BQPUB_POS_DELTA_DISCONTINUOUS;
+  }
+  seqNo_ = posDeltaOfAllForPub->seqNo_;
+
+  auto posDeltaAddr = posDeltaOfAllForPub->posDeltaGroup_;
+  for (std::uint32_t i = 0; i < posDeltaOfAllForPub->num_; ++i) {
+    const auto posDelta = reinterpret_cast<const PosDelta*>(posDeltaAddr);
+    posSnapshot_->applyPosDelta(*posDelta);
+    posDeltaAddr += sizeof(PosDelta);
+  }
+
+  return 0;
+}
+
+}  // namespace bq
@@ -0,0 +1,85 @@
+/*!
+ * \file RawMDPool.cpp
+ * \project BetterQuant
+ *
+ * \author byrnexu
+ * \date 2023/04/14
+ *
+ * \brief
+ */
+
+#include "util/RawMDPool.hpp"
+
+#include "def/RawMD.hpp"
+
+namespace bq {
+
+//! allocate_shared分配的内存块中除了RawMD还有虚表指针、引用计数和分配器
+constexpr static std::size_t EXTRA_SIZE_OF_RAW_MD_IN_MEM_POOL = 64;
+
+RawMDPool::RawMDPool(std::size_t numOfBlock,
+                     const std::vector<std::size_t>& sizeGroupOfData) {
+  memPoolOfRawMD_ = std::make_shared<FixedSizeMemPool>(
+      sizeof(RawMD) + EXTRA_SIZE_OF_RAW_MD_IN_MEM_POOL, numOfBlock);
+
+  //! 块大小会向上取整到缓存行，取整之后相同的只保留一级
+  std::set<std::size_t> blockSizeGroup;
+  for (const auto size : sizeGroupOfData) {
+    blockSizeGroup.emplace((size + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE *
+                           CACHE_LINE_SIZE);
+  }
+  for (const auto blockSize : blockSizeGroup) {
+    memPoolGroupOfData_.emplace_back(
+        std::make_shared<FixedSizeMemPool>(blockSize, numOfBlock));
+  }
+}
+
+RawMDSPtr RawMDPool::makeRawMD(MsgType msgType, const void* data,
+                               std::uint32_t dataLen, bool isLast) {
+  return std::allocate_shared<RawMD>(
+      MemPoolAllocator<RawMD>(memPoolOfRawMD_), shared_from_this(), msgType,
+      data, dataLen, isLast);
+}
+
+void* RawMDPool::allocData(std::size_t dataLen) {
+  for (const auto& memPool : memPoolGroupOfData_) {
+    if (dataLen <= memPool->getBlockSize()) {
+      return memPool->alloc(dataLen);
+    }
+  }
+  //! 比最大的一级还大，由最大的一级退回malloc并计数
+  if (!memPoolGroupOfData_.empty()) {
+    return memPoolGroupOfData_.back()->alloc(dataLen);
+  }
+  return malloc(dataLen);
+}
+
+void RawMDPool::freeData(void* data) {
+  if (data == nullptr) return;
+  for (const auto& memPool : memPoolGroupOfData_) {
+    if (memPool->isFromPool(data)) {
+      memPool->free(data);
+      return;
+    }
+  }
+  free(data);
+}
+
+std::string RawMDPool::getStatistic() const {
+  std::string ret =
+      fmt::format("RawMD: {}", memPoolOfRawMD_->getStatistic().toStr());
+  for (const auto& memPool : memPoolGroupOfData_) {
+    ret.append(fmt::format("; Data: {}", memPool->getStatistic().toStr()));
+  }
+  return ret;
+}
+
+std::uint64_t RawMDPool::getNumOfExhausted() const {
+  auto ret = memPoolOfRawMD_->getStatistic().numOfExhausted_;
+  for (const auto& memPool : memPoolGroupOfData_) {
+    ret += memPool->getStatistic().numOfExhausted_;
+  }
+  return ret;
+}
+
+}  // namespace bq
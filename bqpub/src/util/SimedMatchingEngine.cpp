@@ -0,0 +1,516 @@
+/*!
+ * \file SimedMatchingEngine.cpp
+ * \project BetterQuant
+ *
+ * \author byrnexu
+ * \date 2023/03/30
+ *
+ * \brief
+ */
+
+#include "util/SimedMatchingEngine.hpp"
+
+#include "def/DataStruOfTD.hpp"
+#include "def/SimedTDInfo.hpp"
+#include "def/StatusCode.hpp"
+#include "util/Decimal.hpp"
+#include "util/Logger.hpp"
+
+namespace bq {
+
+SimedOrderBook::SimedOrderBook(SimedMatchingEngine* simedMatchingEngine)
+    : simedMatchingEngine_(simedMatchingEngine) {}
+
+void SimedOrderBook::order(const OrderInfoSPtr& orderInfo, std::uint64_t ts) {
+  const auto tsOfArrival =
+      ts + simedMatchingEngine_->param_.usLatencyOfOrder_;
+  tsOfArrival2SimedReq_.emplace(tsOfArrival, SimedReq{orderInfo, false});
+  advanceTo(ts);
+}
+
+void SimedOrderBook::cancelOrder(const OrderInfoSPtr& orderInfo,
+                                 std::uint64_t ts) {
+  const auto tsOfArrival =
+      ts + simedMatchingEngine_->param_.usLatencyOfCancelOrder_;
+  tsOfArrival2SimedReq_.emplace(tsOfArrival, SimedReq{orderInfo, true});
+  advanceTo(ts);
+}
+
+void SimedOrderBook::advanceTo(std::uint64_t ts) {
+  while (!tsOfArrival2SimedReq_.empty()) {
+    const auto iter = std::begin(tsOfArrival2SimedReq_);
+    if (iter->first > ts) break;
+    const auto tsOfArrival = iter->first;
+    const auto simedReq = iter->second;
+    tsOfArrival2SimedReq_.erase(iter);
+    if (simedReq.isCancel_) {
+      execCancelOrder(simedReq.orderInfo_, tsOfArrival);
+    } else {
+      execOrder(simedReq.orderInfo_, tsOfArrival);
+    }
+  }
+}
+
+void SimedOrderBook::onBooks(const BooksCSPtr& books, std::uint64_t ts) {
+  //! 在新快照之前到达的请求和旧的快照撮合
+  advanceTo(ts);
+
+  books_ = books;
+  numOfAsks_ = GetNumOfDepth(books_->asks_);
+  numOfBids_ = GetNumOfDepth(books_->bids_);
+  sizeTakenOfAsks_.clear();
+  sizeTakenOfBids_.clear();
+
+  matchByBooks(simedBids_, Side::Bid, ts);
+  matchByBooks(simedAsks_, Side::Ask, ts);
+
+  updateQueueAhead(simedBids_, Side::Bid);
+  updateQueueAhead(simedAsks_, Side::Ask);
+}
+
+void SimedOrderBook::onTrades(const Trades& trades, std::uint64_t ts) {
+  advanceTo(ts);
+
+  //! trades.side_为主动方向，主动卖撮合模拟的买单，主动买撮合模拟的卖单
+  if (trades.side_ == Side::Ask) {
+    matchByTrades(simedBids_, Side::Bid, trades, ts);
+  } else if (trades.side_ == Side::Bid) {
+    matchByTrades(simedAsks_, Side::Ask, trades, ts);
+  }
+}
+
+void SimedOrderBook::execOrder(const OrderInfoSPtr& orderInfo,
+                               std::uint64_t ts) {
+  const auto& cbOnSimedOrderRet = simedMatchingEngine_->cbOnSimedOrderRet_;
+
+  if (books_ == nullptr) {
+    orderInfo->orderStatus_ = OrderStatus::Failed;
+    orderInfo->statusCode_ = SCODE_BQPUB_SIMED_MATCHING_NO_BOOKS;
+    cbOnSimedOrderRet(orderInfo, MSG_ID_ON_ORDER_RET,
+                      LiquidityDirection::Others);
+    return;
+  }
+
+  //! 只做maker的订单如果会立即成交，那么交易所直接拒单
+  const auto [depthOfOppo, numOfOppo] = getDepthOfOppo(orderInfo->side_);
+  if (orderInfo->orderTypeExtra_ == OrderTypeExtra::MakeOnly &&
+      numOfOppo != 0 &&
+      IsCrossed(orderInfo->side_, orderInfo->orderPrice_,
+                depthOfOppo[0].price_)) {
+    orderInfo->orderStatus_ = OrderStatus::Failed;
+    orderInfo->statusCode_ = SCODE_BQPUB_SIMED_MATCHING_MAKE_ONLY_WILL_TAKE;
+    cbOnSimedOrderRet(orderInfo, MSG_ID_ON_ORDER_RET,
+                      LiquidityDirection::Others);
+    return;
+  }
+
+  orderInfo->orderStatus_ = OrderStatus::ConfirmedByExch;
+  orderInfo->statusCode_ = SCODE_SUCCESS;
+  const auto exchOrderId = simedMatchingEngine_->getNextExchOrderId();
+  strncpy(orderInfo->exchOrderId_, exchOrderId.c_str(),
+          sizeof(orderInfo->exchOrderId_) - 1);
+  orderInfo->dealSize_ = 0;
+  orderInfo->avgDealPrice_ = 0;
+  orderInfo->lastTradeId_[0] = '\0';
+  orderInfo->lastDealPrice_ = 0;
+  orderInfo->lastDealSize_ = 0;
+  orderInfo->lastDealTime_ = ts;
+  cbOnSimedOrderRet(orderInfo, MSG_ID_ON_ORDER_RET, LiquidityDirection::Others);
+
+  //! fok订单不能全部成交的时候整单撤销
+  if (orderInfo->orderTypeExtra_ != OrderTypeExtra::Fok ||
+      DEC::GE(getSizeCanBeTaken(orderInfo), orderInfo->orderSize_)) {
+    take(orderInfo, LiquidityDirection::Taker, ts);
+  }
+
+  const auto sizeLeft = orderInfo->orderSize_ - std::fabs(orderInfo->dealSize_);
+  if (!DEC::GT(sizeLeft, 0)) return;
+
+  //! ioc和fok订单未成交的部分直接撤销，其他订单挂单
+  if (orderInfo->orderTypeExtra_ == OrderTypeExtra::Ioc ||
+      orderInfo->orderTypeExtra_ == OrderTypeExtra::Fok) {
+    orderInfo->orderStatus_ = DEC::ZERO(orderInfo->dealSize_)
+                                  ? OrderStatus::Canceled
+                                  : OrderStatus::PartialFilledCanceled;
+    cbOnSimedOrderRet(orderInfo, MSG_ID_ON_ORDER_RET,
+                      LiquidityDirection::Others);
+    return;
+  }
+
+  rest(orderInfo);
+}
+
+void SimedOrderBook::execCancelOrder(const OrderInfoSPtr& orderInfo,
+                                     std::uint64_t ts) {
+  const auto& cbOnSimedOrderRet = simedMatchingEngine_->cbOnSimedOrderRet_;
+
+  const auto iter = orderId2SimedOrder_.find(orderInfo->orderId_);
+  if (iter != std::end(orderId2SimedOrder_)) {
+    const auto simedOrder = iter->second;
+    removeSimedOrder(simedOrder);
+    const auto& orderInfoInBook = simedOrder->orderInfo_;
+    orderInfoInBook->orderStatus_ = DEC::ZERO(orderInfoInBook->dealSize_)
+                                        ? OrderStatus::Canceled
+                                        : OrderStatus::PartialFilledCanceled;
+    cbOnSimedOrderRet(orderInfoInBook, MSG_ID_ON_ORDER_RET,
+                      LiquidityDirection::Others);
+    return;
+  }
+
+  //! 撤单的延时比报单小的时候，撤单可能先于报单到达，此时报单不再撮合
+  for (auto iterOfReq = std::begin(tsOfArrival2SimedReq_);
+       iterOfReq != std::end(tsOfArrival2SimedReq_); ++iterOfReq) {
+    const auto& simedReq = iterOfReq->second;
+    if (simedReq.isCancel_ == false &&
+        simedReq.orderInfo_->orderId_ == orderInfo->orderId_) {
+      const auto orderInfoInFlight = simedReq.orderInfo_;
+      tsOfArrival2SimedReq_.erase(iterOfReq);
+      orderInfoInFlight->orderStatus_ = OrderStatus::Canceled;
+      cbOnSimedOrderRet(orderInfoInFlight, MSG_ID_ON_ORDER_RET,
+                        LiquidityDirection::Others);
+      return;
+    }
+  }
+
+  //! 订单已经完结或者不存在
+  orderInfo->statusCode_ = SCODE_BQPUB_SIMED_MATCHING_ORDER_NOT_EXISTS;
+  cbOnSimedOrderRet(orderInfo, MSG_ID_ON_CANCEL_ORDER_RET,
+                    LiquidityDirection::Others);
+}
+
+Decimal SimedOrderBook::getSizeCanBeTaken(
+    const OrderInfoSPtr& orderInfo) const {
+  const auto [depthOfOppo, numOfOppo] = getDepthOfOppo(orderInfo->side_);
+  const auto& sizeTakenOfOppo = orderInfo->side_ == Side::Bid
+                                    ? sizeTakenOfAsks_
+                                    : sizeTakenOfBids_;
+  Decimal ret = 0;
+  for (std::uint32_t i = 0; i < numOfOppo; ++i) {
+    if (!IsCrossed(orderInfo->side_, orderInfo->orderPrice_,
+                   depthOfOppo[i].price_)) {
+      break;
+    }
+    ret += depthOfOppo[i].size_;
+    const auto iter = sizeTakenOfOppo.find(depthOfOppo[i].price_);
+    if (iter != std::end(sizeTakenOfOppo)) {
+      ret -= iter->second;
+    }
+    if (DEC::GE(ret, orderInfo->orderSize_)) break;
+  }
+  return ret;
+}
+
+void SimedOrderBook::take(const OrderInfoSPtr& orderInfo,
+                          LiquidityDirection liquidityDirection,
+                          std::uint64_t ts) {
+  const auto [depthOfOppo, numOfOppo] = getDepthOfOppo(orderInfo->side_);
+  auto& sizeTakenOfOppo = getSizeTakenOfOppo(orderInfo->side_);
+
+  auto sizeLeft = orderInfo->orderSize_ - std::fabs(orderInfo->dealSize_);
+  Decimal sizeOfMaker = 0;
+  for (std::uint32_t i = 0; i < numOfOppo && DEC::GT(sizeLeft, 0); ++i) {
+    if (!IsCrossed(orderInfo->side_, orderInfo->orderPrice_,
+                   depthOfOppo[i].price_)) {
+      break;
+    }
+
+    auto& sizeTaken = sizeTakenOfOppo[depthOfOppo[i].price_];
+    const auto sizeCanBeTaken = depthOfOppo[i].size_ - sizeTaken;
+    if (!DEC::GT(sizeCanBeTaken, 0)) continue;
+
+    const auto dealSize = std::min(sizeLeft, sizeCanBeTaken);
+    sizeTaken += dealSize;
+    sizeLeft -= dealSize;
+
+    //! 主动成交按对手方档位的价格成交，被动成交按挂单价合并成一笔
+    if (liquidityDirection == LiquidityDirection::Taker) {
+      fill(orderInfo, depthOfOppo[i].price_, dealSize, liquidityDirection, ts);
+    } else {
+      sizeOfMaker += dealSize;
+    }
+  }
+
+  if (DEC::GT(sizeOfMaker, 0)) {
+    fill(orderInfo, orderInfo->orderPrice_, sizeOfMaker, liquidityDirection,
+         ts);
+  }
+}
+
+void SimedOrderBook::rest(const OrderInfoSPtr& orderInfo) {
+  const auto simedOrder = std::make_shared<SimedOrder>(orderInfo);
+
+  //! 同价位已有的市场挂单都排在前面
+  const auto [depthOfSameSide, numOfSameSide] =
+      getDepthOfSameSide(orderInfo->side_);
+  const auto no = FindDepth(depthOfSameSide, numOfSameSide,
+                            orderInfo->orderPrice_, orderInfo->side_);
+  if (no != numOfSameSide) {
+    simedOrder->queueAhead_ = depthOfSameSide[no].size_;
+  }
+
+  if (orderInfo->side_ == Side::Bid) {
+    simedBids_[orderInfo->orderPrice_].emplace_back(simedOrder);
+  } else {
+    simedAsks_[orderInfo->orderPrice_].emplace_back(simedOrder);
+  }
+  orderId2SimedOrder_.emplace(orderInfo->orderId_, simedOrder);
+}
+
+template <typename SimedOrderGroup>
+void SimedOrderBook::matchByBooks(SimedOrderGroup& simedOrderGroup, Side side,
+                                  std::uint64_t ts) {
+  const auto [depthOfOppo, numOfOppo] = getDepthOfOppo(side);
+  if (numOfOppo == 0) return;
+
+  //! 对手方越过了挂单价，说明该价位的流动性已经被吃完，按挂单价成交
+  for (auto iter = std::begin(simedOrderGroup);
+       iter != std::end(simedOrderGroup);) {
+    if (!IsCrossed(side, iter->first, depthOfOppo[0].price_)) break;
+    for (const auto& simedOrder : iter->second) {
+      simedOrder->queueAhead_ = 0;
+      take(simedOrder->orderInfo_, LiquidityDirection::Maker, ts);
+    }
+    removeFilledSimedOrder(iter->second);
+    if (iter->second.empty()) {
+      iter = simedOrderGroup.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+}
+
+template <typename SimedOrderGroup>
+void SimedOrderBook::matchByTrades(SimedOrderGroup& simedOrderGroup, Side side,
+                                   const Trades& trades, std::uint64_t ts) {
+  auto sizeLeftOfTrades = trades.size_;
+  for (auto iter = std::begin(simedOrderGroup);
+       iter != std::end(simedOrderGroup) && DEC::GT(sizeLeftOfTrades, 0);) {
+    const auto price = iter->first;
+    if (!IsCrossed(side, price, trades.price_)) break;
+
+    //! 成交价劣于挂单价，说明该价位的市场挂单已经全部成交，不用再排队
+    const auto isTradeThrough = IsBetter(side, price, trades.price_);
+
+    //!
+    //! 市场上的成交量先消耗排在前面的市场挂单，剩余的部分再按时间优先分配给
+    //! 模拟订单，模拟订单并不真实存在，所以不影响其他模拟订单的排队位置。
+    //!
+    Decimal sizeFilled = 0;
+    for (const auto& simedOrder : iter->second) {
+      Decimal queueAhead = 0;
+      if (!isTradeThrough) {
+        queueAhead = simedOrder->queueAhead_;
+        simedOrder->queueAhead_ =
+            std::max<Decimal>(queueAhead - sizeLeftOfTrades, 0);
+      } else {
+        simedOrder->queueAhead_ = 0;
+      }
+
+      const auto sizeCanBeFilled = sizeLeftOfTrades - queueAhead - sizeFilled;
+      if (!DEC::GT(sizeCanBeFilled, 0)) continue;
+
+      const auto& orderInfo = simedOrder->orderInfo_;
+      const auto sizeLeft =
+          orderInfo->orderSize_ - std::fabs(orderInfo->dealSize_);
+      const auto dealSize = std::min(sizeLeft, sizeCanBeFilled);
+      sizeFilled += dealSize;
+      fill(orderInfo, price, dealSize, LiquidityDirection::Maker, ts);
+    }
+    sizeLeftOfTrades -= sizeFilled;
+
+    removeFilledSimedOrder(iter->second);
+    if (iter->second.empty()) {
+      iter = simedOrderGroup.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+}
+
+template <typename SimedOrderGroup>
+void SimedOrderBook::updateQueueAhead(SimedOrderGroup& simedOrderGroup,
+                                      Side side) {
+  const auto [depthOfSameSide, numOfSameSide] = getDepthOfSameSide(side);
+  if (numOfSameSide == 0) return;
+
+  const auto priceOfLastDepth = depthOfSameSide[numOfSameSide - 1].price_;
+  for (auto& [price, simedOrderQueue] : simedOrderGroup) {
+    Decimal sizeOfDepth = 0;
+    const auto no = FindDepth(depthOfSameSide, numOfSameSide, price, side);
+    if (no != numOfSameSide) {
+      sizeOfDepth = depthOfSameSide[no].size_;
+    } else if (!IsBetter(side, price, priceOfLastDepth)) {
+      //! 挂单价超出了快照的深度，无法判断排队情况
+      continue;
+    }
+
+    //! 市场挂单只会因为成交或者撤单而减少，后来的挂单排在模拟订单后面
+    for (auto& simedOrder : simedOrderQueue) {
+      simedOrder->queueAhead_ = std::min(simedOrder->queueAhead_, sizeOfDepth);
+    }
+  }
+}
+
+void SimedOrderBook::removeFilledSimedOrder(SimedOrderQueue& simedOrderQueue) {
+  for (auto iter = std::begin(simedOrderQueue);
+       iter != std::end(simedOrderQueue);) {
+    const auto& orderInfo = (*iter)->orderInfo_;
+    if (orderInfo->orderStatus_ == OrderStatus::Filled) {
+      orderId2SimedOrder_.erase(orderInfo->orderId_);
+      iter = simedOrderQueue.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+}
+
+void SimedOrderBook::fill(const OrderInfoSPtr& orderInfo, Decimal dealPrice,
+                          Decimal dealSize,
+                          LiquidityDirection liquidityDirection,
+                          std::uint64_t ts) {
+  UpdateOrderInfoByFill(orderInfo, dealPrice, dealSize,
+                        simedMatchingEngine_->getNextTradeId(), ts);
+  orderInfo->orderStatus_ =
+      DEC::GE(std::fabs(orderInfo->dealSize_), orderInfo->orderSize_)
+          ? OrderStatus::Filled
+          : OrderStatus::PartialFilled;
+  simedMatchingEngine_->cbOnSimedOrderRet_(orderInfo, MSG_ID_ON_ORDER_RET,
+                                           liquidityDirection);
+}
+
+void SimedOrderBook::removeSimedOrder(const SimedOrderSPtr& simedOrder) {
+  const auto& orderInfo = simedOrder->orderInfo_;
+  const auto removeFrom = [&](auto& simedOrderGroup) {
+    const auto iter = simedOrderGroup.find(orderInfo->orderPrice_);
+    if (iter == std::end(simedOrderGroup)) return;
+    iter->second.remove(simedOrder);
+    if (iter->second.empty()) {
+      simedOrderGroup.erase(iter);
+    }
+  };
+
+  if (orderInfo->side_ == Side::Bid) {
+    removeFrom(simedBids_);
+  } else {
+    removeFrom(simedAsks_);
+  }
+  orderId2SimedOrder_.erase(orderInfo->orderId_);
+}
+
+std::tuple<const Depth*, std::uint32_t> SimedOrderBook::getDepthOfOppo(
+    Side side) const {
+  if (books_ == nullptr) return {nullptr, 0};
+  if (side == Side::Bid) {
+    return {books_->asks_, numOfAsks_};
+  }
+  return {books_->bids_, numOfBids_};
+}
+
+std::tuple<const Depth*, std::uint32_t> SimedOrderBook::getDepthOfSameSide(
+    Side side) const {
+  if (books_ == nullptr) return {nullptr, 0};
+  if (side == Side::Bid) {
+    return {books_->bids_, numOfBids_};
+  }
+  return {books_->asks_, numOfAsks_};
+}
+
+std::map<Decimal, Decimal>& SimedOrderBook::getSizeTakenOfOppo(Side side) {
+  return side == Side::Bid ? sizeTakenOfAsks_ : sizeTakenOfBids_;
+}
+
+std::uint32_t SimedOrderBook::GetNumOfDepth(const Depth* depth) {
+  const auto iter = std::partition_point(
+      depth, depth + MAX_DEPTH_LEVEL,
+      [](const auto& rec) { return !DEC::ZERO(rec.price_); });
+  return std::distance(depth, iter);
+}
+
+std::uint32_t SimedOrderBook::FindDepth(const Depth* depth, std::uint32_t num,
+                                        Decimal price, Side side) {
+  const auto iter = std::lower_bound(
+      depth, depth + num, price, [side](const auto& rec, Decimal value) {
+        return IsBetter(side, rec.price_, value);
+      });
+  if (iter != depth + num && DEC::EQ(iter->price_, price)) {
+    return std::distance(depth, iter);
+  }
+  return num;
+}
+
+bool SimedOrderBook::IsCrossed(Side side, Decimal orderPrice,
+                               Decimal priceOfOppo) {
+  if (side == Side::Bid) {
+    return DEC::LE(priceOfOppo, orderPrice);
+  }
+  return DEC::GE(priceOfOppo, orderPrice);
+}
+
+bool SimedOrderBook::IsBetter(Side side, Decimal lhs, Decimal rhs) {
+  if (side == Side::Bid) {
+    return DEC::GT(lhs, rhs);
+  }
+  return DEC::LT(lhs, rhs);
+}
+
+SimedMatchingEngine::SimedMatchingEngine(
+    const SimedMatchingEngineParam& param,
+    const CBOnSimedOrderRet& cbOnSimedOrderRet)
+    : param_(param), cbOnSimedOrderRet_(cbOnSimedOrderRet) {}
+
+void SimedMatchingEngine::order(const OrderInfoSPtr& orderInfo,
+                                std::uint64_t ts) {
+  getSimedOrderBook(orderInfo->marketCode_, orderInfo->symbolType_,
+                    orderInfo->symbolCode_)
+      ->order(orderInfo, ts);
+}
+
+void SimedMatchingEngine::cancelOrder(const OrderInfoSPtr& orderInfo,
+                                      std::uint64_t ts) {
+  getSimedOrderBook(orderInfo->marketCode_, orderInfo->symbolType_,
+                    orderInfo->symbolCode_)
+      ->cancelOrder(orderInfo, ts);
+}
+
+void SimedMatchingEngine::onBooks(const BooksCSPtr& books, std::uint64_t ts) {
+  const auto& mdHeader = books->mdHeader_;
+  getSimedOrderBook(mdHeader.marketCode_, mdHeader.symbolType_,
+                    mdHeader.symbolCode_)
+      ->onBooks(books, ts);
+}
+
+void SimedMatchingEngine::onTrades(const Trades& trades, std::uint64_t ts) {
+  const auto& mdHeader = trades.mdHeader_;
+  getSimedOrderBook(mdHeader.marketCode_, mdHeader.symbolType_,
+                    mdHeader.symbolCode_)
+      ->onTrades(trades, ts);
+}
+
+std::uint32_t SimedMatchingEngine::GetShardNo(const std::string& symbolCode,
+                                              std::uint32_t numOfShard) {
+  if (numOfShard <= 1) return 0;
+  return XXH3_64bits(symbolCode.data(), symbolCode.size()) % numOfShard;
+}
+
+SimedOrderBookSPtr SimedMatchingEngine::getSimedOrderBook(
+    MarketCode marketCode, SymbolType symbolType,
+    const std::string& symbolCode) {
+  auto symbolKey = std::make_tuple(marketCode, symbolType, symbolCode);
+  const auto iter = symbolKey2SimedOrderBook_.find(symbolKey);
+  if (iter != std::end(symbolKey2SimedOrderBook_)) {
+    return iter->second;
+  }
+  const auto simedOrderBook = std::make_shared<SimedOrderBook>(this);
+  symbolKey2SimedOrderBook_.emplace(std::move(symbolKey), simedOrderBook);
+  return simedOrderBook;
+}
+
+std::string SimedMatchingEngine::getNextExchOrderId() {
+  return std::to_string(++noOfExchOrderId_ * param_.numOfShard_ + param_.no_);
+}
+
+std::string SimedMatchingEngine::getNextTradeId() {
+  return std::to_string(++noOfTradeId_ * param_.numOfShard_ + param_.no_);
+}
+
+}  // namespace bq
@@ -12,6 +12,7 @@
 
 #include "SHMCli.hpp"
 #include "SHMIPCConst.hpp"
+#include "def/DataStruOfMD.hpp"
 #include "def/StatusCode.hpp"
 #include "util/BQUtil.hpp"
 #include "util/Logger.hpp"
@@ -20,9 +21,11 @@
 namespace bq {
 
 SubMgr::SubMgr(const std::string& appNameOfSubscriber,
-               const DataRecvCallback& dataRecvCallback)
+               const DataRecvCallback& dataRecvCallback,
+               ClientChannel clientChannelOfMD)
     : appNameOfSubscriber_(appNameOfSubscriber),
-      dataRecvCallback_(dataRecvCallback) {}
+      dataRecvCallback_(dataRecvCallback),
+      clientChannelOfMD_(clientChannelOfMD) {}
 
 SubMgr::~SubMgr() {}
 
@@ -91,9 +94,19 @@ void SubMgr::initSHMCli(const std::string& addr) {
     if (iter != std::end(addr2SHMCliGroup_)) {
       return;
     }
-    shmCli = std::make_shared<SHMCli>(addr, dataRecvCallback_);
-    //! 订阅行情服务端的 PUB_CHANNEL
-    shmCli->setClientChannel(PUB_CHANNEL);
+    //! 订阅行情服务端的 PUB_CHANNEL，如果开启了过滤，那么行情服务使用独立的频道，
+    //! 其他服务（比如风控）仍然使用 PUB_CHANNEL
+    const auto mdSvcIdentity = fmt::format(
+        "{}{}{}", SEP_OF_SHM_SVC, TOPIC_PREFIX_OF_MARKET_DATA, SEP_OF_SHM_SVC);
+    const auto isMDSvc = boost::contains(addr, mdSvcIdentity);
+    //! 只有行情允许丢弃或者合并，其他服务的推送（比如订单和资产）必须阻塞
+    const auto slowConsumerPolicy =
+        isMDSvc ? slowConsumerPolicyOfMD_ : SlowConsumerPolicy::Block;
+    shmCli =
+        std::make_shared<SHMCli>(addr, dataRecvCallback_, slowConsumerPolicy);
+    const auto clientChannel = isMDSvc ? clientChannelOfMD_ : PUB_CHANNEL;
+    shmCli->setClientChannel(clientChannel);
+    shmCli->setMaxNumOfChunkHeld(maxNumOfChunkHeld_);
     addr2SHMCliGroup_.emplace(addr, shmCli);
   }
   shmCli->start();
@@ -175,4 +188,39 @@ Addr2SHMCliGroup SubMgr::getSHMCliGroup() const {
   return ret;
 }
 
+SHMCliSPtr SubMgr::getSHMCliByTopic(const std::string& topic) const {
+  const auto [ret, addr] =
+      GetAddrFromTopic(appNameOfSubscriber_, convertTopic(topic));
+  if (ret != 0) {
+    return nullptr;
+  }
+
+  std::lock_guard<std::ext::spin_mutex> guard(mtxAddr2SHMCliGroup_);
+  const auto iter = addr2SHMCliGroup_.find(addr);
+  if (iter == std::end(addr2SHMCliGroup_) || !iter->second->isReady()) {
+    return nullptr;
+  }
+  return iter->second;
+}
+
+void SubMgr::reqBooksSnapshot(const MDHeader& mdHeader,
+                              std::uint64_t seqNo) const {
+  const auto topic = fmt::format("{}{}", mdHeader.getTopicPrefix(),
+                                 magic_enum::enum_name(MDType::Books));
+  const auto shmCli = getSHMCliByTopic(topic);
+  if (!shmCli) {
+    LOG_W("Req snapshot of books failed. [topic = {}; seqNo = {}]", topic,
+          seqNo);
+    return;
+  }
+  shmCli->asyncSendMsgWithZeroCopy(
+      [&](void* shmBuf) {
+        auto booksSnapshotReq = static_cast<BooksSnapshotReq*>(shmBuf);
+        strncpy(booksSnapshotReq->symbolCode_, mdHeader.symbolCode_,
+                sizeof(booksSnapshotReq->symbolCode_) - 1);
+        booksSnapshotReq->seqNo_ = seqNo;
+      },
+      MSG_ID_BOOKS_SNAPSHOT_REQ, sizeof(BooksSnapshotReq));
+}
+
 }  // namespace bq
@@ -0,0 +1,293 @@
+/*!
+ * \file SymbolRegistry.cpp
+ * \project BetterQuant
+ *
+ * \author byrnexu
+ * \date 2023/04/13
+ *
+ * \brief
+ */
+
+#include "util/SymbolRegistry.hpp"
+
+#include "SHMIPCTopicRegistry.hpp"
+#include "def/BQConst.hpp"
+#include "util/Logger.hpp"
+#include "util/String.hpp"
+
+namespace bq {
+
+constexpr static std::uint32_t NUM_OF_IDX_REC_IN_SYMBOL_REGISTRY =
+    MAX_NUM_OF_SYMBOL_IN_REGISTRY * 2;
+
+TopicId TopicInfoOfSymbol::getTopicId() const {
+  auto ret = topicId_.load(std::memory_order_relaxed);
+  if (ret == INVALID_TOPIC_ID) {
+    //! 多个线程同时登记得到的是同一个topicId
+    ret = SHMIPCTopicRegistry::get_mutable_instance().intern(topic_,
+                                                             topicHash_);
+    topicId_.store(ret, std::memory_order_relaxed);
+  }
+  return ret;
+}
+
+const TopicInfoOfSymbol* InternedSymbol::getTopicInfo(MDType mdType,
+                                                      bool withExt) const {
+  const auto idx = static_cast<std::uint32_t>(mdType);
+  if (idx == 0 || idx >= NUM_OF_MD_TYPE_IN_SYMBOL_REGISTRY) {
+    return nullptr;
+  }
+  return withExt ? &topicInfoWithExtGroup_[idx] : &topicInfoGroup_[idx];
+}
+
+SymbolRegistry::SymbolRegistry()
+    : symbolGroup_(std::make_unique<std::atomic<InternedSymbol*>[]>(
+          MAX_NUM_OF_SYMBOL_IN_REGISTRY)),
+      idxOfSymbolCode_(std::make_unique<IdxRecOfSymbolRegistry[]>(
+          NUM_OF_IDX_REC_IN_SYMBOL_REGISTRY)),
+      idxOfExchSymbolCode_(std::make_unique<IdxRecOfSymbolRegistry[]>(
+          NUM_OF_IDX_REC_IN_SYMBOL_REGISTRY)) {
+  for (std::uint32_t i = 0; i < MAX_NUM_OF_SYMBOL_IN_REGISTRY; ++i) {
+    symbolGroup_[i].store(nullptr, std::memory_order_relaxed);
+  }
+}
+
+SymbolRegistry::~SymbolRegistry() {
+  const auto numOfSymbol = numOfSymbol_.load(std::memory_order_acquire);
+  for (std::uint32_t i = 0; i < numOfSymbol; ++i) {
+    delete symbolGroup_[i].load(std::memory_order_relaxed);
+  }
+}
+
+InternedSymbolId SymbolRegistry::intern(MarketCode marketCode,
+                                        SymbolType symbolType,
+                                        const std::string& symbolCode,
+                                        const std::string& exchSymbolCode) {
+  const auto symbolId = getIdBySymbolCode(marketCode, symbolType, symbolCode);
+  if (symbolId != INVALID_INTERNED_SYMBOL_ID) {
+    const auto symbol = getSymbol(symbolId);
+    if (exchSymbolCode.empty() || symbol->exchSymbolCode_ == exchSymbolCode) {
+      return symbolId;
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> guard(mtxAdd_);
+    return add(marketCode, symbolType, symbolCode, exchSymbolCode);
+  }
+}
+
+InternedSymbolId SymbolRegistry::getIdBySymbolCode(
+    MarketCode marketCode, SymbolType symbolType,
+    const std::string& symbolCode) const {
+  const auto keyHash = getKeyHash(marketCode, symbolType, symbolCode);
+  return find(idxOfSymbolCode_.get(), keyHash, marketCode, symbolType,
+              symbolCode, false);
+}
+
+InternedSymbolId SymbolRegistry::getIdByExchSymbolCode(
+    MarketCode marketCode, SymbolType symbolType,
+    const std::string& exchSymbolCode) const {
+  if (exchSymbolCode.empty()) {
+    return INVALID_INTERNED_SYMBOL_ID;
+  }
+  const auto keyHash = getKeyHash(marketCode, symbolType, exchSymbolCode);
+  return find(idxOfExchSymbolCode_.get(), keyHash, marketCode, symbolType,
+              exchSymbolCode, true);
+}
+
+const InternedSymbol* SymbolRegistry::getSymbol(
+    InternedSymbolId symbolId) const {
+  if (symbolId >= numOfSymbol_.load(std::memory_order_acquire)) {
+    return nullptr;
+  }
+  return symbolGroup_[symbolId].load(std::memory_order_acquire);
+}
+
+TopicHash SymbolRegistry::getTopicHash(MarketCode marketCode,
+                                       SymbolType symbolType,
+                                       const std::string& symbolCode,
+                                       MDType mdType) {
+  const auto symbolId = intern(marketCode, symbolType, symbolCode);
+  const auto symbol = getSymbol(symbolId);
+  if (symbol != nullptr) {
+    const auto topicInfo = symbol->getTopicInfo(mdType);
+    if (topicInfo != nullptr) {
+      return topicInfo->topicHash_;
+    }
+  }
+  const auto topic =
+      MakeTopicOfSymbol(marketCode, symbolType, symbolCode, mdType);
+  return XXH3_64bits(topic.data(), topic.size());
+}
+
+std::size_t SymbolRegistry::size() const {
+  return numOfSymbol_.load(std::memory_order_acquire);
+}
+
+//! 两张索引表中的key都是code的hash，以marketCode和symbolType作为种子
+std::uint64_t SymbolRegistry::getKeyHash(MarketCode marketCode,
+                                         SymbolType symbolType,
+                                         const std::string& code) {
+  const auto seed = (static_cast<std::uint64_t>(marketCode) << 32) |
+                    static_cast<std::uint64_t>(symbolType);
+  const auto ret = XXH3_64bits_withSeed(code.data(), code.size(), seed);
+  //! 0表示索引表中的空位
+  return ret == 0 ? 1 : ret;
+}
+
+InternedSymbolId SymbolRegistry::add(MarketCode marketCode,
+                                     SymbolType symbolType,
+                                     const std::string& symbolCode,
+                                     const std::string& exchSymbolCode) {
+  //! 加锁之后再查一次，可能已经被其他线程登记
+  const auto symbolIdInIdx =
+      getIdBySymbolCode(marketCode, symbolType, symbolCode);
+  if (symbolIdInIdx != INVALID_INTERNED_SYMBOL_ID) {
+    const auto symbol = getSymbol(symbolIdInIdx);
+    if (exchSymbolCode.empty() || symbol->exchSymbolCode_ == exchSymbolCode) {
+      return symbolIdInIdx;
+    }
+  }
+
+  const auto symbolId = numOfSymbol_.load(std::memory_order_relaxed);
+  if (symbolId >= MAX_NUM_OF_SYMBOL_IN_REGISTRY) {
+    LOG_W("Add {} - {} - {} to symbol registry failed because of full. [{}]",
+          GetMarketName(marketCode), magic_enum::enum_name(symbolType),
+          symbolCode, MAX_NUM_OF_SYMBOL_IN_REGISTRY);
+    return INVALID_INTERNED_SYMBOL_ID;
+  }
+
+  auto symbol = new InternedSymbol();
+  symbol->symbolId_ = symbolId;
+  symbol->marketCode_ = marketCode;
+  symbol->symbolType_ = symbolType;
+  symbol->symbolCode_ = symbolCode;
+  symbol->exchSymbolCode_ = exchSymbolCode;
+  for (std::uint32_t i = 1; i < NUM_OF_MD_TYPE_IN_SYMBOL_REGISTRY; ++i) {
+    const auto mdType = static_cast<MDType>(i);
+    auto& topicInfo = symbol->topicInfoGroup_[i];
+    topicInfo.topic_ =
+        MakeTopicOfSymbol(marketCode, symbolType, symbolCode, mdType);
+    topicInfo.topicHash_ =
+        XXH3_64bits(topicInfo.topic_.data(), topicInfo.topic_.size());
+    auto& topicInfoWithExt = symbol->topicInfoWithExtGroup_[i];
+    topicInfoWithExt.topic_ =
+        MakeTopicOfSymbol(marketCode, symbolType, symbolCode, mdType, true);
+    topicInfoWithExt.topicHash_ = XXH3_64bits(topicInfoWithExt.topic_.data(),
+                                              topicInfoWithExt.topic_.size());
+  }
+
+  symbolGroup_[symbolId].store(symbol, std::memory_order_release);
+  numOfSymbol_.store(symbolId + 1, std::memory_order_release);
+
+  //! exchSymbolCode变化了，旧的exchSymbolCode不再指向这个品种
+  if (symbolIdInIdx != INVALID_INTERNED_SYMBOL_ID) {
+    const auto& oldExchSymbolCode = getSymbol(symbolIdInIdx)->exchSymbolCode_;
+    if (!oldExchSymbolCode.empty()) {
+      setIdx(idxOfExchSymbolCode_.get(),
+             getKeyHash(marketCode, symbolType, oldExchSymbolCode), marketCode,
+             symbolType, oldExchSymbolCode, true, INVALID_INTERNED_SYMBOL_ID);
+    }
+  }
+
+  setIdx(idxOfSymbolCode_.get(), getKeyHash(marketCode, symbolType, symbolCode),
+         marketCode, symbolType, symbolCode, false, symbolId);
+  if (!exchSymbolCode.empty()) {
+    setIdx(idxOfExchSymbolCode_.get(),
+           getKeyHash(marketCode, symbolType, exchSymbolCode), marketCode,
+           symbolType, exchSymbolCode, true, symbolId);
+  }
+
+  LOG_D("Add {} - {} - {} - {} to symbol registry. [symbolId = {}]",
+        GetMarketName(marketCode), magic_enum::enum_name(symbolType),
+        symbolCode, exchSymbolCode, symbolId);
+  return symbolId;
+}
+
+InternedSymbolId SymbolRegistry::find(const IdxRecOfSymbolRegistry* idx,
+                                      std::uint64_t keyHash,
+                                      MarketCode marketCode,
+                                      SymbolType symbolType,
+                                      const std::string& code,
+                                      bool isExchSymbolCode) const {
+  constexpr auto mask = NUM_OF_IDX_REC_IN_SYMBOL_REGISTRY - 1;
+  auto pos = static_cast<std::uint32_t>(keyHash) & mask;
+  for (std::uint32_t i = 0; i < NUM_OF_IDX_REC_IN_SYMBOL_REGISTRY; ++i) {
+    const auto& rec = idx[pos];
+    const auto keyHashInIdx = rec.keyHash_.load(std::memory_order_acquire);
+    if (keyHashInIdx == 0) {
+      return INVALID_INTERNED_SYMBOL_ID;
+    }
+    if (keyHashInIdx == keyHash) {
+      //! hash相同还要比较一次原始的key，被删除的exchSymbolCode的位置继续向后找
+      const auto symbolId = rec.symbolId_.load(std::memory_order_acquire);
+      const auto symbol = getSymbol(symbolId);
+      if (symbol != nullptr && symbol->marketCode_ == marketCode &&
+          symbol->symbolType_ == symbolType &&
+          (isExchSymbolCode ? symbol->exchSymbolCode_ : symbol->symbolCode_) ==
+              code) {
+        return symbolId;
+      }
+    }
+    pos = (pos + 1) & mask;
+  }
+  return INVALID_INTERNED_SYMBOL_ID;
+}
+
+void SymbolRegistry::setIdx(IdxRecOfSymbolRegistry* idx, std::uint64_t keyHash,
+                            MarketCode marketCode, SymbolType symbolType,
+                            const std::string& code, bool isExchSymbolCode,
+                            InternedSymbolId symbolId) {
+  constexpr auto mask = NUM_OF_IDX_REC_IN_SYMBOL_REGISTRY - 1;
+  auto pos = static_cast<std::uint32_t>(keyHash) & mask;
+  for (std::uint32_t i = 0; i < NUM_OF_IDX_REC_IN_SYMBOL_REGISTRY; ++i) {
+    auto& rec = idx[pos];
+    const auto keyHashInIdx = rec.keyHash_.load(std::memory_order_relaxed);
+    if (keyHashInIdx == 0) {
+      if (symbolId != INVALID_INTERNED_SYMBOL_ID) {
+        //! 先写symbolId再写keyHash，读取方看到keyHash的时候symbolId已经可见
+        rec.symbolId_.store(symbolId, std::memory_order_relaxed);
+        rec.keyHash_.store(keyHash, std::memory_order_release);
+      }
+      return;
+    }
+    if (keyHashInIdx == keyHash) {
+      const auto symbol =
+          getSymbol(rec.symbolId_.load(std::memory_order_relaxed));
+      if (symbol == nullptr ||
+          (symbol->marketCode_ == marketCode &&
+           symbol->symbolType_ == symbolType &&
+           (isExchSymbolCode ? symbol->exchSymbolCode_
+                             : symbol->symbolCode_) == code)) {
+        rec.symbolId_.store(symbolId, std::memory_order_release);
+        return;
+      }
+    }
+    pos = (pos + 1) & mask;
+  }
+}
+
+//! MD@SH@Spot@600600@Tickers
+//! MD@Binance@Spot@BTC-USDT@Books@400
+std::string MakeTopicOfSymbol(MarketCode marketCode, SymbolType symbolType,
+                              const std::string& symbolCode, MDType mdType,
+                              bool withExt) {
+  auto ret = fmt::format(
+      "{}{}{}{}{}{}{}{}{}", TOPIC_PREFIX_OF_MARKET_DATA, SEP_OF_TOPIC,
+      GetMarketName(marketCode), SEP_OF_TOPIC,
+      magic_enum::enum_name(symbolType), SEP_OF_TOPIC, symbolCode,
+      SEP_OF_TOPIC, magic_enum::enum_name(mdType));
+  if (withExt) {
+    if (mdType == MDType::Books) {
+      ret.append(SEP_OF_TOPIC);
+      ret.append(Int2StrInCompileTime<MAX_DEPTH_LEVEL>::type::value);
+    } else if (mdType == MDType::Candle) {
+      ret.append(SEP_OF_TOPIC);
+      ret.append(SUFFIX_OF_CANDLE_DETAIL);
+    }
+  }
+  return ret;
+}
+
+}  // namespace bq
@@ -10,6 +10,8 @@
 
 #include "util/TopicMgr.hpp"
 
+#include "CommonIPCData.hpp"
+#include "SHMSrv.hpp"
 #include "util/BQUtil.hpp"
 #include "util/Datetime.hpp"
 #include "util/Logger.hpp"
@@ -287,4 +289,45 @@ Subscriber2TopicGroup TopicMgr::fromJson(
   return ret;
 }
 
+TopicHashGroup MakeTopicHashGroup(
+    const std::string& subscriber2TopicGroupInJsonFmt) {
+  Doc doc;
+  doc.Parse(subscriber2TopicGroupInJsonFmt.c_str());
+
+  TopicHashGroup ret;
+  if (doc.HasParseError() || !doc.HasMember("subscriber2TopicGroup")) {
+    LOG_W("Make topic hash group failed because of invalid sub info. {}",
+          subscriber2TopicGroupInJsonFmt);
+    return ret;
+  }
+
+  //! 一个客户端有多个subscriber，合并之后就是这个客户端需要的所有topic，topic
+  //! 已经是convertTopic之后的格式，和SubMgr中计算topicHash的方式一致
+  for (std::size_t i = 0; i < doc["subscriber2TopicGroup"].Size(); ++i) {
+    const auto& d = doc["subscriber2TopicGroup"][i];
+    for (std::size_t j = 0; j < d["topicGroup"].Size(); ++j) {
+      const auto& topic = d["topicGroup"][j];
+      ret.emplace(XXH3_64bits(topic.GetString(), topic.GetStringLength()));
+    }
+  }
+  return ret;
+}
+
+void UpdateTopicFilterBySyncSubInfo(
+    const void* shmBuf, const std::vector<SHMSrvSPtr>& shmSrvGroup) {
+  const auto commonIPCData = static_cast<const CommonIPCData*>(shmBuf);
+  const auto clientChannel = commonIPCData->shmHeader_.clientChannel_;
+  if (clientChannel == PUB_CHANNEL) {
+    return;
+  }
+
+  //! 客户端同步的是所有市场的订阅信息，其他市场的topicHash在当前SHMSrv中不会
+  //! 被匹配到
+  const auto topicHashGroup =
+      MakeTopicHashGroup(std::string(commonIPCData->data_));
+  for (const auto& shmSrv : shmSrvGroup) {
+    shmSrv->updateTopicFilter(clientChannel, topicHashGroup);
+  }
+}
+
 }  // namespace bq
@@ -13,14 +13,25 @@
 
 #include <string>
 
+#include "SHMIPCMsgId.hpp"
 #include "def/BQConst.hpp"
 #include "def/BQDef.hpp"
 #include "def/ConditionUtil.hpp"
+#include "def/DataStruOfTD.hpp"
 #include "def/PosInfo.hpp"
 #include "def/SimedTDInfo.hpp"
+#include "def/StatusCode.hpp"
 #include "def/SymbolCode.hpp"
 #include "util/BQUtil.hpp"
+#include "util/BooksRebuilder.hpp"
+#include "util/Datetime.hpp"
+#include "util/MarketDataCache.hpp"
+#include "util/PnlTableOfCondition.hpp"
+#include "util/PosSnapshot.hpp"
 #include "util/PosSnapshotImpl.hpp"
+#include "util/PosSnapshotRebuilder.hpp"
+#include "util/SimedMatchingEngine.hpp"
+#include "util/SymbolRegistry.hpp"
 #include "util/TopicMgr.hpp"
 
 using namespace bq;
@@ -359,6 +370,58 @@ TEST(MatchPrefixTest, InvalidMatch) {
 
 TEST(MatchPrefixTest, InvalidInput) { EXPECT_FALSE(matchPrefix("", "IF*")); }
 
+TEST(testCompiledCondition, testMatchCompiledCondition) {
+  OrderInfo orderInfo;
+  orderInfo.acctId_ = 10000;
+  orderInfo.marketCode_ = MarketCode::CFFEX;
+  strncpy(orderInfo.symbolCode_, "IF2309", sizeof(orderInfo.symbolCode_) - 1);
+
+  const auto compile = [](const std::string& condition) {
+    const auto [statusCode, statusMsg, conditionTemplate] =
+        MakeConditionTemplate(condition);
+    EXPECT_EQ(statusCode, 0);
+    const auto [retOfCompile, msgOfCompile, compiledCondition] =
+        CompileConditionTemplate(conditionTemplate);
+    EXPECT_EQ(retOfCompile, 0);
+    return compiledCondition;
+  };
+
+  auto cc = compile("acctId=10000&marketCode=*&symbolCode=IF*");
+  ConditionKey conditionKey;
+  ASSERT_TRUE(MakeConditionKey(orderInfo, cc.fieldMask_, conditionKey));
+  EXPECT_TRUE(MatchCompiledCondition(orderInfo, conditionKey, cc));
+
+  //! 字段顺序不同但条件相同的时候生成的 conditionKey 相同
+  ConditionKey conditionKeyOfOtherOrder;
+  const auto [statusCode, statusMsg, fieldMask] =
+      MakeConditionFieldMask({"symbolCode", "marketCode", "acctId"});
+  ASSERT_EQ(statusCode, 0);
+  ASSERT_TRUE(MakeConditionKey(orderInfo, fieldMask, conditionKeyOfOtherOrder));
+  EXPECT_TRUE(conditionKey == conditionKeyOfOtherOrder);
+
+  strncpy(orderInfo.symbolCode_, "IC2309", sizeof(orderInfo.symbolCode_) - 1);
+  EXPECT_FALSE(MatchCompiledCondition(orderInfo, cc));
+
+  cc = compile("acctId=10001&symbolCode=IC2309");
+  EXPECT_FALSE(MatchCompiledCondition(orderInfo, cc));
+  cc = compile("acctId=&symbolCode=IC2309");
+  EXPECT_TRUE(MatchCompiledCondition(orderInfo, cc));
+
+  //! 原来按字符串比较，所以 010000 和 abc 都不能匹配任何订单
+  cc = compile("acctId=010000");
+  EXPECT_TRUE(cc.neverMatch_);
+  EXPECT_FALSE(MatchCompiledCondition(orderInfo, cc));
+  cc = compile("acctId=abc");
+  EXPECT_FALSE(MatchCompiledCondition(orderInfo, cc));
+
+  //! parValue按字符串形式比较
+  orderInfo.parValue_ = 300;
+  cc = compile("acctId=10000&parValue=300");
+  EXPECT_TRUE(MatchCompiledCondition(orderInfo, cc));
+  cc = compile("acctId=10000&parValue=300.0");
+  EXPECT_FALSE(MatchCompiledCondition(orderInfo, cc));
+}
+
 TEST(testTopicMgr, testTopicMgr) {}
 
 TEST(is_any_value_of, IntValues) {
@@ -410,6 +473,440 @@ TEST(IsCNMarket2Test, InvalidMarkets) {
   ASSERT_FALSE(IsCNMarket(MarketCode::Others));
 }
 
+TEST(testBooksRebuilder, testRebuild) {
+  std::vector<char> buf(GetSizeOfBooksDelta(3));
+  auto booksDelta = reinterpret_cast<BooksDelta*>(buf.data());
+  booksDelta->shmHeader_.topicHash_ = 1;
+  auto books = std::make_unique<Books>();
+  BooksRebuilder booksRebuilder;
+
+  //! 收到全量刷新之前不输出
+  booksDelta->seqNo_ = 1;
+  EXPECT_EQ(booksRebuilder.rebuild(booksDelta, books.get()),
+            SCODE_BQPUB_BOOKS_NOT_READY);
+
+  booksDelta->seqNo_ = 2;
+  booksDelta->isFullRefresh_ = true;
+  booksDelta->numOfAsks_ = 2;
+  booksDelta->numOfBids_ = 1;
+  booksDelta->depthGroup_[0] = {101, 1, 0};
+  booksDelta->depthGroup_[1] = {102, 2, 0};
+  booksDelta->depthGroup_[2] = {100, 3, 0};
+  EXPECT_EQ(booksRebuilder.rebuild(booksDelta, books.get()), 0);
+  EXPECT_EQ(books->shmHeader_.msgId_, MSG_ID_ON_MD_BOOKS);
+  EXPECT_DOUBLE_EQ(books->asks_[0].price_, 101);
+  EXPECT_DOUBLE_EQ(books->asks_[1].price_, 102);
+  EXPECT_DOUBLE_EQ(books->bids_[0].price_, 100);
+
+  //! size为0删除该价位
+  booksDelta->seqNo_ = 3;
+  booksDelta->isFullRefresh_ = false;
+  booksDelta->numOfAsks_ = 1;
+  booksDelta->numOfBids_ = 0;
+  booksDelta->depthGroup_[0] = {101, 0, 0};
+  EXPECT_EQ(booksRebuilder.rebuild(booksDelta, books.get()), 0);
+  EXPECT_DOUBLE_EQ(books->asks_[0].price_, 102);
+  EXPECT_DOUBLE_EQ(books->asks_[1].price_, 0);
+
+  //! 序号不连续需要等待全量刷新
+  booksDelta->seqNo_ = 5;
+  EXPECT_EQ(booksRebuilder.rebuild(booksDelta, books.get()),
+            SCODE_BQPUB_BOOKS_DELTA_DISCONTINUOUS);
+  booksDelta->seqNo_ = 6;
+  EXPECT_EQ(booksRebuilder.rebuild(booksDelta, books.get()),
+            SCODE_BQPUB_BOOKS_NOT_READY);
+}
+
+TEST(testBooksRebuilder, testRecoverFromGap) {
+  std::vector<char> buf(GetSizeOfBooksDelta(2));
+  auto booksDelta = reinterpret_cast<BooksDelta*>(buf.data());
+  booksDelta->shmHeader_.topicHash_ = 1;
+  strncpy(booksDelta->mdHeader_.symbolCode_, "BTC-USDT",
+          sizeof(booksDelta->mdHeader_.symbolCode_) - 1);
+  auto books = std::make_unique<Books>();
+  std::vector<std::uint64_t> seqNoOfSnapshotReq;
+  BooksRebuilder booksRebuilder([&](const auto& mdHeader, auto seqNo) {
+    EXPECT_STREQ(mdHeader.symbolCode_, "BTC-USDT");
+    seqNoOfSnapshotReq.emplace_back(seqNo);
+  });
+
+  //! 后加入的接收端不用等定期的全量刷新，每次等待只请求一次
+  booksDelta->seqNo_ = 7;
+  booksDelta->numOfAsks_ = 1;
+  booksDelta->numOfBids_ = 1;
+  booksDelta->depthGroup_[0] = {101, 1, 0};
+  booksDelta->depthGroup_[1] = {100, 1, 0};
+  EXPECT_EQ(booksRebuilder.rebuild(booksDelta, books.get()),
+            SCODE_BQPUB_BOOKS_NOT_READY);
+  booksDelta->seqNo_ = 8;
+  EXPECT_EQ(booksRebuilder.rebuild(booksDelta, books.get()),
+            SCODE_BQPUB_BOOKS_NOT_READY);
+  EXPECT_EQ(seqNoOfSnapshotReq, std::vector<std::uint64_t>{0});
+
+  booksDelta->seqNo_ = 9;
+  booksDelta->isFullRefresh_ = true;
+  EXPECT_EQ(booksRebuilder.rebuild(booksDelta, books.get()), 0);
+
+  //! 丢了seqNo为10的增量（比如DropOldest），请求全量刷新之后恢复
+  booksDelta->seqNo_ = 11;
+  booksDelta->isFullRefresh_ = false;
+  booksDelta->depthGroup_[0] = {101, 0, 0};
+  booksDelta->depthGroup_[1] = {99, 2, 0};
+  EXPECT_EQ(booksRebuilder.rebuild(booksDelta, books.get()),
+            SCODE_BQPUB_BOOKS_DELTA_DISCONTINUOUS);
+  EXPECT_EQ(seqNoOfSnapshotReq, (std::vector<std::uint64_t>{0, 9}));
+
+  booksDelta->seqNo_ = 12;
+  booksDelta->isFullRefresh_ = true;
+  booksDelta->depthGroup_[0] = {102, 3, 0};
+  booksDelta->depthGroup_[1] = {99, 2, 0};
+  EXPECT_EQ(booksRebuilder.rebuild(booksDelta, books.get()), 0);
+  EXPECT_DOUBLE_EQ(books->asks_[0].price_, 102);
+  EXPECT_DOUBLE_EQ(books->asks_[1].price_, 0);
+  EXPECT_DOUBLE_EQ(books->bids_[0].price_, 99);
+  EXPECT_DOUBLE_EQ(books->bids_[1].price_, 0);
+
+  booksDelta->seqNo_ = 13;
+  booksDelta->isFullRefresh_ = false;
+  booksDelta->depthGroup_[0] = {103, 1, 0};
+  booksDelta->depthGroup_[1] = {98, 1, 0};
+  EXPECT_EQ(booksRebuilder.rebuild(booksDelta, books.get()), 0);
+  EXPECT_DOUBLE_EQ(books->asks_[1].price_, 103);
+  EXPECT_DOUBLE_EQ(books->bids_[1].price_, 98);
+  EXPECT_EQ(seqNoOfSnapshotReq.size(), 2);
+}
+
+TEST(testPosSnapshotRebuilder, testRebuild) {
+  PosInfo posInfo1;
+  posInfo1.acctId_ = 1;
+  posInfo1.pos_ = 1;
+  PosInfo posInfo2;
+  posInfo2.acctId_ = 2;
+  posInfo2.pos_ = 2;
+
+  std::vector<std::uint64_t> seqNoOfKeyframeReq;
+  PosSnapshotRebuilder posSnapshotRebuilder(
+      [&](std::uint64_t seqNo) { seqNoOfKeyframeReq.emplace_back(seqNo); });
+
+  std::vector<char> bufOfDelta(sizeof(PosDeltaOfAllForPub) +
+                               2 * sizeof(PosDelta));
+  auto posDeltaOfAllForPub =
+      reinterpret_cast<PosDeltaOfAllForPub*>(bufOfDelta.data());
+  posDeltaOfAllForPub->shmHeader_.msgId_ = MSG_ID_POS_DELTA_OF_ALL;
+  auto posDeltaGroup =
+      reinterpret_cast<PosDelta*>(posDeltaOfAllForPub->posDeltaGroup_);
+
+  //! 收到关键帧之前不输出
+  posDeltaOfAllForPub->seqNo_ = 1;
+  posDeltaOfAllForPub->num_ = 0;
+  EXPECT_EQ(posSnapshotRebuilder.rebuild(posDeltaOfAllForPub),
+            SCODE_BQPUB_POS_SNAPSHOT_NOT_READY);
+  EXPECT_TRUE(posSnapshotRebuilder.getPosSnapshot() == nullptr);
+
+  std::vector<char> bufOfKeyframe(sizeof(PosUpdateOfAllForPub) +
+                                  sizeof(PosInfo));
+  auto posUpdateOfAllForPub =
+      reinterpret_cast<PosUpdateOfAllForPub*>(bufOfKeyframe.data());
+  posUpdateOfAllForPub->shmHeader_.msgId_ = MSG_ID_POS_SNAPSHOT_OF_ALL;
+  posUpdateOfAllForPub->seqNo_ = 1;
+  posUpdateOfAllForPub->num_ = 1;
+  memcpy(posUpdateOfAllForPub->posInfoGroup_, &posInfo1, sizeof(PosInfo));
+  EXPECT_EQ(posSnapshotRebuilder.rebuild(posUpdateOfAllForPub), 0);
+  const auto posSnapshot = posSnapshotRebuilder.getPosSnapshot();
+  EXPECT_EQ(posSnapshot->getPosInfoDetail().size(), 1);
+
+  //! 关键帧中已经包含的增量直接丢弃
+  EXPECT_EQ(posSnapshotRebuilder.rebuild(posDeltaOfAllForPub),
+            SCODE_BQPUB_POS_SNAPSHOT_NOT_READY);
+
+  //! 增量原地更新同一个posSnapshot
+  posDeltaOfAllForPub->seqNo_ = 2;
+  posDeltaOfAllForPub->num_ = 2;
+  posInfo1.pos_ = 3;
+  posDeltaGroup[0].posDeltaType_ = PosDeltaType::Chg;
+  memcpy(&posDeltaGroup[0].posInfo_, &posInfo1, sizeof(PosInfo));
+  posDeltaGroup[1].posDeltaType_ = PosDeltaType::Add;
+  memcpy(&posDeltaGroup[1].posInfo_, &posInfo2, sizeof(PosInfo));
+  EXPECT_EQ(posSnapshotRebuilder.rebuild(posDeltaOfAllForPub), 0);
+  EXPECT_TRUE(posSnapshotRebuilder.getPosSnapshot() == posSnapshot);
+  EXPECT_EQ(posSnapshot->getPosInfoDetail().size(), 2);
+  EXPECT_DOUBLE_EQ(
+      posSnapshot->getPosInfoDetail().at(posInfo1.getKey())->pos_, 3);
+
+  posDeltaOfAllForPub->seqNo_ = 3;
+  posDeltaOfAllForPub->num_ = 1;
+  posDeltaGroup[0].posDeltaType_ = PosDeltaType::Del;
+  EXPECT_EQ(posSnapshotRebuilder.rebuild(posDeltaOfAllForPub), 0);
+  EXPECT_EQ(posSnapshot->getPosInfoDetail().size(), 1);
+  EXPECT_EQ(posSnapshot->getPosInfoDetail().count(posInfo2.getKey()), 1);
+
+  //! 序号不连续请求一次关键帧，收到关键帧之前丢弃增量
+  posDeltaOfAllForPub->seqNo_ = 5;
+  EXPECT_EQ(posSnapshotRebuilder.rebuild(posDeltaOfAllForPub),
+            SCODE_BQPUB_POS_DELTA_DISCONTINUOUS);
+  posDeltaOfAllForPub->seqNo_ = 6;
+  EXPECT_EQ(posSnapshotRebuilder.rebuild(posDeltaOfAllForPub),
+            SCODE_BQPUB_POS_SNAPSHOT_NOT_READY);
+  EXPECT_EQ(seqNoOfKeyframeReq, std::vector<std::uint64_t>{3});
+
+  //! MSG_ID_POS_UPDATE_OF_ALL和关键帧的格式相同，同样按关键帧处理
+  posUpdateOfAllForPub->shmHeader_.msgId_ = MSG_ID_POS_UPDATE_OF_ALL;
+  posUpdateOfAllForPub->seqNo_ = 6;
+  EXPECT_EQ(posSnapshotRebuilder.rebuild(posUpdateOfAllForPub), 0);
+  EXPECT_EQ(posSnapshotRebuilder.getSeqNo(), 6);
+  EXPECT_TRUE(posSnapshotRebuilder.isReady());
+}
+
+TEST(testMarketDataCache, testCacheAndGet) {
+  MarketDataCache marketDataCache(4);
+  const std::string topic = "MD@Binance@Spot@BTC-USDT@Tickers";
+  const auto topicHash = XXH3_64bits(topic.data(), topic.size());
+
+  //! 先获取symbolId，行情到达之后写入同一个槽位
+  const auto symbolId = marketDataCache.getSymbolId(
+      MarketCode::Binance, SymbolType::Spot, "BTC-USDT");
+  EXPECT_NE(symbolId, INVALID_SYMBOL_ID);
+
+  Tickers tickers;
+  EXPECT_FALSE(marketDataCache.getLastTickers(topicHash, tickers));
+
+  Tickers tickersRecv;
+  tickersRecv.shmHeader_.topicHash_ = topicHash;
+  tickersRecv.mdHeader_.marketCode_ = MarketCode::Binance;
+  tickersRecv.mdHeader_.symbolType_ = SymbolType::Spot;
+  tickersRecv.lastPrice_ = 100;
+  marketDataCache.cache(&tickersRecv);
+
+  EXPECT_TRUE(marketDataCache.getLastTickers(topicHash, tickers));
+  EXPECT_DOUBLE_EQ(tickers.lastPrice_, 100);
+  EXPECT_TRUE(marketDataCache.getLastTickers(
+      MarketCode::Binance, SymbolType::Spot, symbolId, tickers));
+  EXPECT_FALSE(marketDataCache.getLastTickers(
+      MarketCode::Binance, SymbolType::Perp, symbolId, tickers));
+
+  const auto lastTickers = marketDataCache.getLastTickers(topic);
+  ASSERT_TRUE(lastTickers != nullptr);
+  EXPECT_DOUBLE_EQ(lastTickers->lastPrice_, 100);
+}
+
+TEST(testPnlTableOfCondition, testRegAndUpdate) {
+  const std::string segmentIdentity = "TEST-PNL-TABLE-OF-CONDITION.dat";
+  bip::shared_memory_object::remove(segmentIdentity.c_str());
+
+  //! 交易服务和风控服务各自打开同一块共享内存
+  PnlTableOfCondition pnlTableOfReader;
+  pnlTableOfReader.load(segmentIdentity, 4);
+  PnlTableOfCondition pnlTableOfWriter;
+  pnlTableOfWriter.load(segmentIdentity, 1024);
+  EXPECT_EQ(pnlTableOfWriter.getNumOfSlot(), pnlTableOfReader.getNumOfSlot());
+  EXPECT_EQ(pnlTableOfWriter.resetSeqNoOfWriter(), 0);
+
+  const std::string condition = "acctId=10000&trdAcctId=100000";
+  const auto hashOfCondition = XXH3_64bits(condition.data(), condition.size());
+
+  PnlOfCondition pnlOfCondition;
+  EXPECT_FALSE(pnlTableOfReader.getPnl(hashOfCondition, pnlOfCondition));
+
+  //! 注册之后还没有计算过盈亏
+  EXPECT_TRUE(pnlTableOfReader.reg(condition));
+  EXPECT_TRUE(pnlTableOfReader.reg(condition));
+  EXPECT_FALSE(pnlTableOfReader.getPnl(hashOfCondition, pnlOfCondition));
+  EXPECT_FALSE(pnlTableOfReader.reg(std::string(MAX_CONDITION_LEN, 'a')));
+
+  std::vector<std::string> conditionGroup;
+  const auto num = pnlTableOfWriter.update(
+      [&](const std::string& condition, PnlOfCondition& pnlOfCondition) {
+        conditionGroup.emplace_back(condition);
+        pnlOfCondition.pnlUnReal_ = 100;
+        pnlOfCondition.pnlReal_ = -20;
+        pnlOfCondition.fee_ = 5;
+        pnlOfCondition.updateTime_ = GetTotalUSSince1970();
+        return 0;
+      });
+  EXPECT_EQ(num, 1);
+  ASSERT_EQ(conditionGroup.size(), 1);
+  EXPECT_EQ(conditionGroup[0], condition);
+
+  EXPECT_TRUE(pnlTableOfReader.getPnl(hashOfCondition, pnlOfCondition));
+  EXPECT_DOUBLE_EQ(pnlOfCondition.getTotalPnl(), 75);
+  EXPECT_LE(pnlOfCondition.delay(), 1);
+
+  //! 计算失败的条件保留上一次的盈亏
+  EXPECT_EQ(pnlTableOfWriter.update([](const auto&, auto&) { return -1; }), 0);
+  EXPECT_TRUE(pnlTableOfReader.getPnl(hashOfCondition, pnlOfCondition));
+  EXPECT_DOUBLE_EQ(pnlOfCondition.getTotalPnl(), 75);
+
+  //! 写入完成的槽位序列号是偶数，重启之后不需要复位
+  EXPECT_EQ(pnlTableOfWriter.resetSeqNoOfWriter(), 0);
+  EXPECT_TRUE(pnlTableOfReader.getPnl(hashOfCondition, pnlOfCondition));
+
+  bip::shared_memory_object::remove(segmentIdentity.c_str());
+}
+
+TEST(testPnlTableOfCondition, testResetSeqNoOfWriter) {
+  const std::string segmentIdentity = "TEST-PNL-TABLE-OF-CONDITION.dat";
+  bip::shared_memory_object::remove(segmentIdentity.c_str());
+
+  PnlTableOfCondition pnlTableOfReader;
+  pnlTableOfReader.load(segmentIdentity, 4);
+  PnlTableOfCondition pnlTableOfWriter;
+  pnlTableOfWriter.load(segmentIdentity);
+
+  const std::string condition = "acctId=10000&trdAcctId=100000";
+  const auto hashOfCondition = XXH3_64bits(condition.data(), condition.size());
+  EXPECT_TRUE(pnlTableOfReader.reg(condition));
+  const auto calcPnlOfCondition = [](const auto&, auto& pnlOfCondition) {
+    pnlOfCondition.pnlUnReal_ = 100;
+    pnlOfCondition.updateTime_ = GetTotalUSSince1970();
+    return 0;
+  };
+  EXPECT_EQ(pnlTableOfWriter.update(calcPnlOfCondition), 1);
+
+  //! 模拟写入方在写入过程中退出，槽位的序列号停留在奇数
+  bip::managed_shared_memory segment(bip::open_only, segmentIdentity.c_str());
+  const auto [slots, numOfSlot] =
+      segment.find<PnlSlotOfCondition>(NAME_OF_PNL_SLOT_GROUP);
+  ASSERT_TRUE(slots != nullptr);
+  ASSERT_EQ(numOfSlot, pnlTableOfWriter.getNumOfSlot());
+  PnlSlotOfCondition* slot = nullptr;
+  for (std::size_t slotNo = 0; slotNo < numOfSlot; ++slotNo) {
+    if (slots[slotNo].hashOfCondition_.load() == hashOfCondition) {
+      slot = &slots[slotNo];
+      break;
+    }
+  }
+  ASSERT_TRUE(slot != nullptr);
+  ASSERT_EQ(slot->seqNo_.load(), 2);
+  slot->seqNo_ = 3;
+
+  //! 读取方重读MAX_NUM_OF_RETRY_OF_GET_PNL次之后放弃，不会一直等下去
+  PnlOfCondition pnlOfCondition;
+  EXPECT_FALSE(pnlTableOfReader.getPnl(hashOfCondition, pnlOfCondition));
+  EXPECT_EQ(slot->seqNo_.load(), 3);
+
+  //! 写入方重启之后复位该槽位，盈亏清空，读取方按超时处理
+  EXPECT_EQ(pnlTableOfWriter.resetSeqNoOfWriter(), 1);
+  EXPECT_EQ(slot->seqNo_.load(), 4);
+  EXPECT_TRUE(pnlTableOfReader.getPnl(hashOfCondition, pnlOfCondition));
+  EXPECT_EQ(pnlOfCondition.updateTime_, 0);
+  EXPECT_DOUBLE_EQ(pnlOfCondition.getTotalPnl(), 0);
+  EXPECT_GT(pnlOfCondition.delay(), 24 * 3600);
+  EXPECT_EQ(pnlTableOfWriter.resetSeqNoOfWriter(), 0);
+
+  //! 下一轮计算之后恢复正常
+  EXPECT_EQ(pnlTableOfWriter.update(calcPnlOfCondition), 1);
+  EXPECT_TRUE(pnlTableOfReader.getPnl(hashOfCondition, pnlOfCondition));
+  EXPECT_LE(pnlOfCondition.delay(), 1);
+
+  bip::shared_memory_object::remove(segmentIdentity.c_str());
+}
+
+TEST(testSymbolRegistry, testInternAndGet) {
+  auto& symbolRegistry = SymbolRegistry::get_mutable_instance();
+  const auto symbolId = symbolRegistry.intern(
+      MarketCode::Binance, SymbolType::Spot, "ETH-USDT", "ethusdt");
+  ASSERT_NE(symbolId, INVALID_INTERNED_SYMBOL_ID);
+  EXPECT_EQ(symbolRegistry.intern(MarketCode::Binance, SymbolType::Spot,
+                                  "ETH-USDT"),
+            symbolId);
+  EXPECT_EQ(symbolRegistry.getIdByExchSymbolCode(MarketCode::Binance,
+                                                 SymbolType::Spot, "ethusdt"),
+            symbolId);
+  EXPECT_EQ(symbolRegistry.getIdByExchSymbolCode(MarketCode::Binance,
+                                                 SymbolType::Perp, "ethusdt"),
+            INVALID_INTERNED_SYMBOL_ID);
+
+  const auto symbol = symbolRegistry.getSymbol(symbolId);
+  ASSERT_TRUE(symbol != nullptr);
+  const std::string topic = "MD@Binance@Spot@ETH-USDT@Tickers";
+  EXPECT_EQ(symbol->getTopicInfo(MDType::Tickers)->topic_, topic);
+  EXPECT_EQ(symbol->getTopicInfo(MDType::Tickers)->topicHash_,
+            XXH3_64bits(topic.data(), topic.size()));
+  EXPECT_EQ(symbol->getTopicInfo(MDType::Books, true)->topic_,
+            "MD@Binance@Spot@ETH-USDT@Books@400");
+  EXPECT_TRUE(symbol->getTopicInfo(MDType::Others) == nullptr);
+
+  //! exchSymbolCode变化之后旧的exchSymbolCode查不到
+  const auto symbolIdAfterChg = symbolRegistry.intern(
+      MarketCode::Binance, SymbolType::Spot, "ETH-USDT", "ethusdt2");
+  EXPECT_NE(symbolIdAfterChg, symbolId);
+  EXPECT_EQ(symbolRegistry.getIdBySymbolCode(MarketCode::Binance,
+                                             SymbolType::Spot, "ETH-USDT"),
+            symbolIdAfterChg);
+  EXPECT_EQ(symbolRegistry.getIdByExchSymbolCode(MarketCode::Binance,
+                                                 SymbolType::Spot, "ethusdt"),
+            INVALID_INTERNED_SYMBOL_ID);
+}
+
+TEST(testSimedMatchingEngine, testMatchByBooksAndTrades) {
+  std::vector<std::tuple<OrderStatus, Decimal, LiquidityDirection>> retGroup;
+  SimedMatchingEngine simedMatchingEngine(
+      SimedMatchingEngineParam(),
+      [&](const auto& orderInfo, auto msgId, auto liquidityDirection) {
+        retGroup.emplace_back(orderInfo->orderStatus_, orderInfo->dealSize_,
+                              liquidityDirection);
+      });
+
+  const auto makeOrderInfo = [](OrderId orderId, Decimal price, Decimal size) {
+    auto orderInfo = std::make_shared<OrderInfo>();
+    orderInfo->orderId_ = orderId;
+    orderInfo->marketCode_ = MarketCode::Binance;
+    orderInfo->symbolType_ = SymbolType::Spot;
+    strcpy(orderInfo->symbolCode_, "BTC-USDT");
+    orderInfo->side_ = Side::Bid;
+    orderInfo->orderPrice_ = price;
+    orderInfo->orderSize_ = size;
+    return orderInfo;
+  };
+
+  //! 收到订单簿之前的订单被拒绝
+  simedMatchingEngine.order(makeOrderInfo(1, 101, 1), 1);
+  ASSERT_EQ(retGroup.size(), 1);
+  EXPECT_EQ(std::get<0>(retGroup[0]), OrderStatus::Failed);
+
+  auto books = std::make_shared<Books>();
+  books->mdHeader_.marketCode_ = MarketCode::Binance;
+  books->mdHeader_.symbolType_ = SymbolType::Spot;
+  strcpy(books->mdHeader_.symbolCode_, "BTC-USDT");
+  books->asks_[0] = {101, 1, 0};
+  books->asks_[1] = {102, 2, 0};
+  books->bids_[0] = {100, 3, 0};
+  simedMatchingEngine.onBooks(books, 2);
+
+  //! 吃掉卖一之后剩余部分挂单
+  retGroup.clear();
+  simedMatchingEngine.order(makeOrderInfo(2, 101.5, 2), 3);
+  ASSERT_EQ(retGroup.size(), 2);
+  EXPECT_EQ(std::get<0>(retGroup[1]), OrderStatus::PartialFilled);
+  EXPECT_DOUBLE_EQ(std::get<1>(retGroup[1]), 1);
+  EXPECT_EQ(std::get<2>(retGroup[1]), LiquidityDirection::Taker);
+
+  //! 买一价挂单排在已有的3个之后
+  retGroup.clear();
+  simedMatchingEngine.order(makeOrderInfo(3, 100, 1), 4);
+  ASSERT_EQ(retGroup.size(), 1);
+  EXPECT_EQ(std::get<0>(retGroup[0]), OrderStatus::ConfirmedByExch);
+
+  Trades trades;
+  trades.mdHeader_ = books->mdHeader_;
+  trades.side_ = Side::Ask;
+  trades.price_ = 100;
+  trades.size_ = 3;
+  retGroup.clear();
+  simedMatchingEngine.onTrades(trades, 5);
+  ASSERT_EQ(retGroup.size(), 1);
+  EXPECT_EQ(std::get<0>(retGroup[0]), OrderStatus::Filled);
+  EXPECT_EQ(std::get<2>(retGroup[0]), LiquidityDirection::Maker);
+
+  //! 排在前面的3个已经消耗了2个，剩余的成交量才分配给模拟订单
+  trades.size_ = 2;
+  retGroup.clear();
+  simedMatchingEngine.onTrades(trades, 6);
+  ASSERT_EQ(retGroup.size(), 1);
+  EXPECT_EQ(std::get<0>(retGroup[0]), OrderStatus::Filled);
+  EXPECT_DOUBLE_EQ(std::get<1>(retGroup[0]), 1);
+}
+
 int main(int argc, char** argv) {
   testing::AddGlobalTestEnvironment(new global_event);
   testing::InitGoogleTest(&argc, argv);
@@ -79,8 +79,18 @@ struct LimitValueInSHM {
   }
 };
 
-//! map of {{"acctId=10000&marketCode=SSE",  LimitValueInSHM*}}
-using ConditionValue2LimitValueGroup = std::map<std::string, LimitValueInSHM*>;
+//! conditionValueInStrFmt 用于生成共享内存中 limitValueInSHM 的名字，
+//! 只在第一次创建和重建流控时间队列的时候使用
+struct LimitValueOfConditionValue {
+  std::string conditionValueInStrFmt_;
+  LimitValueInSHM* limitValueInSHM_{nullptr};
+};
+
+//! map of {{ConditionKey of acctId=10000&marketCode=SSE,
+//! {"acctId=10000&marketCode=SSE", LimitValueInSHM*}}}
+using ConditionValue2LimitValueGroup =
+    ankerl::unordered_dense::map<ConditionKey, LimitValueOfConditionValue,
+                                 ConditionKeyHash>;
 
 struct FlowCtrlRule {
   std::uint32_t no_;
@@ -98,7 +108,13 @@ struct FlowCtrlRule {
   //! {{"acctId": "*"}, {"stgId": "10000"}}
   ConditionTemplate conditionTemplate_;
 
-  //! std::map<std::string, LimitValue>; 各种acctId和stgId组合的流控状态缓存
+  //! conditionFieldGroup_ 的字段掩码，用于根据订单生成 ConditionKey
+  ConditionFieldMask conditionFieldMask_{0};
+
+  //! conditionTemplate_ 编译之后的形式，匹配订单的时候使用
+  CompiledCondition compiledCondition_;
+
+  //! 各种acctId和stgId组合的流控状态缓存
   ConditionValue2LimitValueGroup conditionValue2LimitValueGroup_;
 
   //! 每次、总数或者单位时间内的限制
@@ -28,7 +28,9 @@
 //! | |-condition           = "acctId=*&marketCode=SSE"
 //! | |-conditionFieldGroup = ["acctId", "marketCode"]
 //! | |-conditionTemplate   = {{"acctId":""}, {"marketCode":"SSE"}} [std::map<std::string, std::string>] 
-//! | |-conditionValue2LimitValueGroup [std::map<std::string, LimitValue>]
+//! | |-conditionFieldMask  = (1 << AcctId) | (1 << MarketCode)
+//! | |-compiledCondition   = {exactMask = (1 << MarketCode), exactKey = {0, SSE}}
+//! | |-conditionValue2LimitValueGroup [unordered_dense::map<ConditionKey, LimitValue>]
 //! | | |- acctId=10000&marketCode=SSE -> struct LimitValue {value, msInterval, circular_buffer<std::uint64> tsGroup}
 //! | | |- acctId=10001&marketCode=SSE -> struct LimitValue {value, msInterval, circular_buffer<std::uint64> tsGroup}
 //! | | |- ...
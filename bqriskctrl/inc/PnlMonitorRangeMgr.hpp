@@ -22,23 +22,14 @@ class TDSrv;
 
 namespace bq {
 
-class PosSnapshot;
-using PosSnapshotSPtr = std::shared_ptr<PosSnapshot>;
+class PnlTableOfCondition;
+using PnlTableOfConditionSPtr = std::shared_ptr<PnlTableOfCondition>;
 
 struct OrderInfo;
 using OrderInfoSPtr = std::shared_ptr<OrderInfo>;
 
-class SubMgr;
-using SubMgrSPtr = std::shared_ptr<SubMgr>;
-
 using Key2PnlMonitorRangeGroup = std::map<std::string, PnlMonitorRangeSPtr>;
 
-struct Pnl;
-using PnlSPtr = std::shared_ptr<Pnl>;
-
-using Condition2PnlGroup = std::map<std::string, PnlSPtr>;
-using Condition2PnlGroupSPtr = std::shared_ptr<Condition2PnlGroup>;
-
 class PnlMonitorRangeMgr : public RiskCtrlDataMgr {
  public:
   PnlMonitorRangeMgr(const PnlMonitorRangeMgr&) = delete;
@@ -59,15 +50,7 @@ class PnlMonitorRangeMgr : public RiskCtrlDataMgr {
       const db::pnlMonitorRange::RecordSPtr& rec);
 
  private:
-  void initSubMgr();
-  void onDataRecv(const void* shmBuf, std::size_t shmBufLen);
-
-  Condition2PnlGroupSPtr initCondition2PnlGroup();
-  void initPnlInCondition2PnlGroup(Condition2PnlGroupSPtr& condition2PnlGroup);
-  void updateCondition2PnlGroup(
-      const Condition2PnlGroupSPtr& condition2PnlGroup);
-
-  PnlSPtr getPnl(const std::string& condition);
+  void initPnlTableOfCondition();
 
  public:
   std::tuple<int, std::string> checkIfTriggerRiskCtrl(
@@ -88,8 +71,8 @@ class PnlMonitorRangeMgr : public RiskCtrlDataMgr {
   //! 核心逻辑：
   //! 
   //! 收到订单之后遍历 Key2PnlMonitorRangeGroup，找出触发风控的condition，再根据 
-  //! condition 也就是 "acctId=10000&trdAcctId=100000", 从 condition2PnlGroup_ 
-  //! 找到 pnl
+  //! condition 也就是 "acctId=10000&trdAcctId=100000" 的哈希, 从风控服务写入的
+  //! pnlTableOfCondition_ 中读取 pnl
   //! 
   //! key 是 "acctId&trdAcctId" key 就是创建的时候用到，用来归集同一类风控范围
   //! val 是 PnlMonitorRangeSPtr 
@@ -109,13 +92,8 @@ class PnlMonitorRangeMgr : public RiskCtrlDataMgr {
   Key2PnlMonitorRangeGroup key2PnlMonitorRangeGroup_;
   std::ext::spin_mutex mtxKey2PnlMonitorRangeGroup_;
 
-  //! 来了一条行情之后结合key2PnlMonitorRangeGroup_初始化conditionFieldGroup_，
-  //! 然后再填充其中的pnl用于风控
-  Condition2PnlGroupSPtr condition2PnlGroup_{nullptr};
-  std::ext::spin_mutex mtxCondition2PnlGroup_;
-
-  SubMgrSPtr subMgr_{nullptr};
-  PosSnapshotSPtr posSnapshot_{nullptr};
+  //! 共享内存中的盈亏表，这里只注册监控条件和读取盈亏，盈亏由风控服务计算
+  PnlTableOfConditionSPtr pnlTableOfCondition_{nullptr};
 };
 
 }  // namespace bq
@@ -120,6 +120,20 @@ std::tuple<int, std::string> FlowCtrlRuleMgr::handleCurFlowCtrlRuleRec(
     return {statusCode, statusMsg};
   }
 
+  //! 获取 rule->conditionFieldMask_
+  std::tie(statusCode, statusMsg, rule->conditionFieldMask_) =
+      MakeConditionFieldMask(rule->conditionFieldGroup_);
+  if (statusCode != 0) {
+    return {statusCode, statusMsg};
+  }
+
+  //! 获取 rule->compiledCondition_
+  std::tie(statusCode, statusMsg, rule->compiledCondition_) =
+      CompileConditionTemplate(rule->conditionTemplate_);
+  if (statusCode != 0) {
+    return {statusCode, statusMsg};
+  }
+
   //! 获取 rule->limitType_
   std::tie(statusCode, statusMsg, rule->limitType_) =
       GetLimitType(rule->target_);
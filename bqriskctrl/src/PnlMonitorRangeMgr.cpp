@@ -10,32 +10,23 @@
 
 #include "PnlMonitorRangeMgr.hpp"
 
-#include "SHMIPCTask.hpp"
 #include "TDSrv.hpp"
 #include "db/TBLPnlMonitorRange.hpp"
 #include "def/ConditionUtil.hpp"
 #include "def/DataStruOfTD.hpp"
-#include "def/PosInfo.hpp"
 #include "def/StatusCode.hpp"
 #include "util/Decimal.hpp"
-#include "util/Literal.hpp"
 #include "util/Logger.hpp"
-#include "util/PosSnapshot.hpp"
-#include "util/SubMgr.hpp"
+#include "util/PnlTableOfCondition.hpp"
 
 namespace bq {
 
 PnlMonitorRangeMgr::PnlMonitorRangeMgr(
     const std::string& step, std::uint32_t threadNo,
     const std::string& fieldGroupUsedToGenHash)
-    : RiskCtrlDataMgr(step, threadNo, fieldGroupUsedToGenHash),
-      condition2PnlGroup_(std::make_shared<Condition2PnlGroup>()) {}
+    : RiskCtrlDataMgr(step, threadNo, fieldGroupUsedToGenHash) {}
 
-PnlMonitorRangeMgr::~PnlMonitorRangeMgr() {
-  if (subMgr_) {
-    subMgr_->stop();
-  }
-}
+PnlMonitorRangeMgr::~PnlMonitorRangeMgr() {}
 
 std::tuple<int, std::string> PnlMonitorRangeMgr::init(
     const std::vector<db::pnlMonitorRange::RecordSPtr>& recSet) {
@@ -45,7 +36,7 @@ std::tuple<int, std::string> PnlMonitorRangeMgr::init(
       return {statusCode, statusMsg};
     }
   }
-  initSubMgr();
+  initPnlTableOfCondition();
   return {0, ""};
 }
 
@@ -112,75 +103,34 @@ std::tuple<int, std::string> PnlMonitorRangeMgr::handleCurPnlMonitorRec(
   return {0, ""};
 }
 
-void PnlMonitorRangeMgr::initSubMgr() {
-  // 因为每个风控模组都会调用这个代码，为了避免不必要的订阅，增加以下判断
+void PnlMonitorRangeMgr::initPnlTableOfCondition() {
+  std::vector<std::string> conditionGroup;
   {
     std::lock_guard<std::ext::spin_mutex> guard(mtxKey2PnlMonitorRangeGroup_);
-    if (key2PnlMonitorRangeGroup_.empty()) {
-      return;
+    for (const auto& rec : key2PnlMonitorRangeGroup_) {
+      const auto& pnlMonitorRange = rec.second;
+      for (const auto& rec : pnlMonitorRange->hash2PnlThresholdGroup_) {
+        const auto& pnlThreshold = rec.second;
+        conditionGroup.emplace_back(pnlThreshold->condition_);
+      }
     }
-  }
-
-  if (subMgr_) {
-    return;
-  }
-
-  const auto appNameOfSubscriber =
-      fmt::format("pnl-monitor-{}-{}", step_, threadNo_);
-  subMgr_ = std::make_shared<SubMgr>(
-      appNameOfSubscriber, [this](const void* shmBuf, std::size_t shmBufLen) {
-        onDataRecv(shmBuf, shmBufLen);
-      });
-  subMgr_->start();
 
-  subMgr_->sub(0, "RISK@PubChannel@Trade@PosInfo@All");
-}
-
-void PnlMonitorRangeMgr::onDataRecv(const void* shmBuf, std::size_t shmBufLen) {
-  const auto shmHeader = static_cast<const SHMHeader*>(shmBuf);
-  if (shmHeader->msgId_ != MSG_ID_POS_SNAPSHOT_OF_ALL) return;
-
-  LOG_T("Step {} of thread {} recv {} bytes of data.", step_, threadNo_,
-        shmBufLen);
-
-  //! 根据订阅得到的消息构建 posSnapshot
-  auto buf = malloc(shmBufLen);
-  memcpy(buf, shmBuf, shmBufLen);
-
-  const auto posUpdateOfAllForPub =
-      MakeMsgSPtrByTask<PosUpdateOfAllForPub>(buf);
-  const auto posUpdateOfAll = MakePosUpdateOfAll(posUpdateOfAllForPub);
-  posSnapshot_ =
-      std::make_shared<PosSnapshot>(std::move(posUpdateOfAll), nullptr);
-
-  //! 以最快的速度通过 key2PnlMonitorRangeGroup_ 包含所有 condition 和空的 pnl
-  //! 的 map
-  auto condition2PnlGroup = initCondition2PnlGroup();
-
-  //! 将上面得到的 condition2PnlGroup 的 pnl 全填上
-  initPnlInCondition2PnlGroup(condition2PnlGroup);
-
-  //! 更新风控用的 condition2PnlGroup_
-  updateCondition2PnlGroup(condition2PnlGroup);
-}
+    // 因为每个风控模组都会调用这个代码，为了避免不必要的共享内存，增加以下判断
+    if (conditionGroup.empty()) {
+      return;
+    }
 
-void PnlMonitorRangeMgr::updateCondition2PnlGroup(
-    const Condition2PnlGroupSPtr& condition2PnlGroup) {
-  {
-    std::lock_guard<std::ext::spin_mutex> guard(mtxCondition2PnlGroup_);
-    condition2PnlGroup_ = condition2PnlGroup;
+    //! checkIfTriggerRiskCtrl 在同一把锁中读取 pnlTableOfCondition_
+    if (!pnlTableOfCondition_) {
+      pnlTableOfCondition_ = std::make_shared<PnlTableOfCondition>();
+      pnlTableOfCondition_->load(SEGMENT_OF_PNL_TABLE_OF_CONDITION);
+    }
   }
-}
 
-PnlSPtr PnlMonitorRangeMgr::getPnl(const std::string& condition) {
-  {
-    std::lock_guard<std::ext::spin_mutex> guard(mtxCondition2PnlGroup_);
-    const auto iter = condition2PnlGroup_->find(condition);
-    if (iter != std::end(*condition2PnlGroup_)) {
-      return iter->second;
-    }
+  //! 重复注册同一个条件没有副作用，风控服务下一次计算时开始更新新的条件
+  for (const auto& condition : conditionGroup) {
+    pnlTableOfCondition_->reg(condition);
   }
-  return nullptr;
 }
 
 std::tuple<int, std::string> PnlMonitorRangeMgr::checkIfTriggerRiskCtrl(
@@ -207,14 +157,16 @@ std::tuple<int, std::string> PnlMonitorRangeMgr::checkIfTriggerRiskCtrl(
         continue;
       }
 
-      const auto pnl = getPnl(condition);
-      if (pnl == nullptr) {
+      //! 读取盈亏不加锁，遇到风控服务正在写入则重读
+      PnlOfCondition pnlOfCondition;
+      if (!pnlTableOfCondition_ ||
+          !pnlTableOfCondition_->getPnl(hashOfCondition, pnlOfCondition)) {
         const auto statusMsg = fmt::format(
             "Trigger risk ctrl because pnl of {} is null.", condition);
         return {SCODE_TD_SRV_RISK_PNL_IS_NULL, statusMsg};
       }
 
-      const auto delay = pnl->delay();
+      const auto delay = pnlOfCondition.delay();
       if (delay > secDelayOfPrice) {
         const auto statusMsg = fmt::format(
             "Trigger risk ctrl because delay {} of pnl {} greater than {}.",
@@ -222,7 +174,7 @@ std::tuple<int, std::string> PnlMonitorRangeMgr::checkIfTriggerRiskCtrl(
         return {SCODE_TD_SRV_RISK_PNL_IS_TIMEOUT, statusMsg};
       }
 
-      const auto totalPnl = pnl->getTotalPnl();
+      const auto totalPnl = pnlOfCondition.getTotalPnl();
       const auto& pnlThreshold = iter->second;
       const auto pnlType = pnlThreshold->pnlType_;
       const auto limitValue = pnlThreshold->limitValue_;
@@ -252,50 +204,6 @@ std::tuple<int, std::string> PnlMonitorRangeMgr::checkIfTriggerRiskCtrl(
   return {0, ""};
 }
 
-Condition2PnlGroupSPtr PnlMonitorRangeMgr::initCondition2PnlGroup() {
-  //! 为了加快速度，先将所有的condition取出来放到一个conditionGroup中
-  std::vector<std::string> conditionGroup;
-  conditionGroup.reserve(1024);
-  {
-    std::lock_guard<std::ext::spin_mutex> guard(mtxKey2PnlMonitorRangeGroup_);
-    for (const auto& rec : key2PnlMonitorRangeGroup_) {
-      const auto& pnlMonitorRange = rec.second;
-      const auto& hash2PnlThresholdGroup =
-          pnlMonitorRange->hash2PnlThresholdGroup_;
-      for (const auto& rec : hash2PnlThresholdGroup) {
-        const auto& pnlThreshold = rec.second;
-        conditionGroup.emplace_back(pnlThreshold->condition_);
-      }
-    }
-  }
-
-  //! 根据 conditionGroup 生成 condition2PnlGroup
-  const auto ret = std::make_shared<Condition2PnlGroup>();
-  for (const auto& condition : conditionGroup) {
-    ret->emplace(condition, PnlSPtr());
-  }
-
-  return ret;
-}
-
-void PnlMonitorRangeMgr::initPnlInCondition2PnlGroup(
-    Condition2PnlGroupSPtr& condition2PnlGroup) {
-  for (auto& rec : *condition2PnlGroup) {
-    const auto& condition = rec.first;
-    const auto [statusCode, pnl] =
-        posSnapshot_->queryPnl(condition, QuoteCurrencyForCalc("CNY"));
-    if (statusCode == 0 && pnl) {
-      rec.second = pnl;
-      LOG_I("Recv {}", pnl->toStr());
-    } else {
-      if (pnl) {
-        LOG_W("Init pnl of {} in condition2PnlGroup failed. [{} - {}]",
-              condition, statusCode, GetStatusMsg(statusCode));
-      }
-    }
-  }
-}
-
 /*
 {
         "pluginName": "risk-plugin-pnl-monitor",
@@ -319,7 +227,7 @@ std::tuple<int, std::string> PnlMonitorRangeMgr::handleTableChgTypeOfAdd(
     return {statusCode, statusMsg};
   }
 
-  initSubMgr();
+  initPnlTableOfCondition();
 
   return {statusCode, statusMsg};
 }
@@ -0,0 +1,109 @@
+/*!
+ * \file PnlEngine.hpp
+ * \project BetterQuant
+ *
+ * \author byrnexu
+ * \date 2023/04/19
+ *
+ * \brief
+ */
+
+#pragma once
+
+#include "def/BQDef.hpp"
+#include "def/DefIF.hpp"
+#include "def/PosInfo.hpp"
+#include "util/Pch.hpp"
+#include "util/StdExt.hpp"
+
+namespace bq {
+struct Tickers;
+struct LastPrice;
+
+class MarketDataCache;
+using MarketDataCacheSPtr = std::shared_ptr<MarketDataCache>;
+}  // namespace bq
+
+namespace bq::riskmgr {
+
+using Currency2PnlUnReal = ankerl::unordered_dense::map<std::string, Decimal>;
+
+//!
+//! 按行情增量计算仓位的浮动盈亏：
+//! 1. 仓位按品种（Tickers和LastPrice的topicHash）索引，收到某个品种的行情
+//!    只重新计算该品种的仓位的pnlUnReal；
+//! 2. 账户、策略、策略实例层面的pnlUnReal按币种分别累加所属仓位的pnlUnReal，
+//!    仓位的pnlUnReal变化的时候只累加差值，不同币种的pnlUnReal不相加；
+//! 3. pnlUnReal有变化的仓位标记为dirty，写数据库的时候只写这部分仓位。
+//!
+//! 仓位是PosMgr中仓位的拷贝，成交引起的仓位变化通过onPosChg更新，再由sync
+//! 定期和PosMgr对齐，补上PosMgr中新增的空仓位等记录，sync不会用比onPosChg
+//! 更旧的拷贝覆盖仓位。
+//!
+class PnlEngine {
+ public:
+  PnlEngine(const PnlEngine&) = delete;
+  PnlEngine& operator=(const PnlEngine&) = delete;
+  PnlEngine(const PnlEngine&&) = delete;
+  PnlEngine& operator=(const PnlEngine&&) = delete;
+
+  explicit PnlEngine(const MarketDataCacheSPtr& marketDataCache);
+
+ public:
+  //! 只有新增或者发生变化的仓位才会重新计算pnlUnReal
+  void sync(const PosInfoGroup& posInfoGroup);
+  void onPosChg(const PosChgInfoSPtr& posChgInfo);
+
+  void onTickers(const Tickers* tickers);
+  void onLastPrice(const LastPrice* lastPrice);
+
+ public:
+  //! 返回所有仓位的拷贝，其中的pnlUnReal和updateTime已经是最新的
+  PosInfoGroup getPosInfoGroup() const;
+
+  //! 返回上次调用之后pnlUnReal有变化的仓位的拷贝并清除dirty标记
+  PosInfoGroup getPosInfoGroupOfDirty();
+
+  //! 返回各个币种的pnlUnReal的累加值
+  Currency2PnlUnReal getPnlUnRealOfAcctId(AcctId acctId) const;
+  Currency2PnlUnReal getPnlUnRealOfStgId(StgId stgId) const;
+  Currency2PnlUnReal getPnlUnRealOfStgInstId(StgId stgId,
+                                             StgInstId stgInstId) const;
+
+  std::size_t size() const;
+
+ private:
+  void upsert(const PosInfoSPtr& posInfo);
+  void onLastPrice(TopicHash topicHash, Decimal lastPrice,
+                   std::uint64_t exchTs);
+
+  //! lastPrice为0的时候表示没有行情
+  void updatePnlUnReal(const PosInfoSPtr& posInfo, Decimal lastPrice,
+                       std::uint64_t exchTs);
+  void addPnlUnRealOfGroup(const PosInfo& posInfo, Decimal value);
+
+  static std::uint32_t GetStgInstKey(StgId stgId, StgInstId stgInstId) {
+    return (static_cast<std::uint32_t>(stgId) << 16) | stgInstId;
+  }
+
+ private:
+  MarketDataCacheSPtr marketDataCache_{nullptr};
+
+  ankerl::unordered_dense::map<std::uint64_t, PosInfoSPtr> keyHash2PosInfo_;
+  ankerl::unordered_dense::map<TopicHash, PosInfoGroup>
+      topicHash2PosInfoGroup_;
+  ankerl::unordered_dense::set<std::uint64_t> keyHashGroupOfDirty_;
+
+  //! 仓位的pnlUnReal的计价币种，仓位新增的时候根据品种确定，之后不再变化
+  ankerl::unordered_dense::map<std::uint64_t, std::string>
+      keyHash2CurrencyOfPnlUnReal_;
+  ankerl::unordered_dense::map<AcctId, Currency2PnlUnReal> acctId2PnlUnReal_;
+  ankerl::unordered_dense::map<StgId, Currency2PnlUnReal> stgId2PnlUnReal_;
+  ankerl::unordered_dense::map<std::uint32_t, Currency2PnlUnReal>
+      stgInstKey2PnlUnReal_;
+
+  mutable std::ext::spin_mutex mtx_;
+};
+using PnlEngineSPtr = std::shared_ptr<PnlEngine>;
+
+}  // namespace bq::riskmgr
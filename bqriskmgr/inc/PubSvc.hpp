@@ -59,17 +59,25 @@ class PubSvc {
 
   explicit PubSvc(RiskMgr* riskMgr);
 
- private:
-  void initPnlUnReal(PosInfoGroup& posInfoGroup);
-
  public:
   void pubPosSnapshotOfAll();
 
+  //! 接收端发现增量不连续的时候请求，下一次发布时发送关键帧
+  void reqPosKeyframeOfAll() { isPosKeyframeOfAllReq_ = true; }
+
  private:
   void updatePosInfoInDB(const PosInfoGroup& posInfoGroup);
+  bool isTimeToPubPosKeyframeOfAll();
+  PosDeltaGroup getPosDeltaGroupOfAll(
+      const Key2PosInfoGroupSPtr& key2PosInfoGroupNew);
 
  private:
   void pushPosInfoOfAll(MsgId msgId, const PosInfoGroup& posInfoGroup);
+  void pushPosDeltaOfAll(const PosDeltaGroup& posDeltaGroup);
+
+ public:
+  //! 每个盈亏监控条件只计算一次，结果写入共享内存供交易服务读取
+  void pubPnlOfCondition();
 
  public:
   void pubPosUpdateOfAcctId();
@@ -124,6 +132,12 @@ class PubSvc {
  private:
   RiskMgr* riskMgr_{nullptr};
 
+  //! 上一次发布的全部仓位，用于生成增量
+  Key2PosInfoGroupSPtr key2PosInfoGroupOfAll_{nullptr};
+  std::uint64_t seqNoOfPosDeltaOfAll_{0};
+  std::uint64_t msOfLastPosKeyframeOfAll_{0};
+  std::atomic_bool isPosKeyframeOfAllReq_{false};
+
   AcctId2Key2PosInfoGroupSPtr acctId2Key2PosInfoGroup_{nullptr};
   StgId2Key2PosInfoGroupSPtr stgId2Key2PosInfoGroup_{nullptr};
   StgInstId2Key2PosInfoGroupSPtr stgInstId2Key2PosInfoGroup_{nullptr};
@@ -43,6 +43,9 @@ using ScheduleTaskBundleSPtr = std::shared_ptr<ScheduleTaskBundle>;
 class MarketDataCache;
 using MarketDataCacheSPtr = std::shared_ptr<MarketDataCache>;
 
+class PnlTableOfCondition;
+using PnlTableOfConditionSPtr = std::shared_ptr<PnlTableOfCondition>;
+
 }  // namespace bq
 
 namespace bq::db {
@@ -64,6 +67,9 @@ using ClientChannelGroupSPtr = std::shared_ptr<ClientChannelGroup>;
 class PubSvc;
 using PubSvcSPtr = std::shared_ptr<PubSvc>;
 
+class PnlEngine;
+using PnlEngineSPtr = std::shared_ptr<PnlEngine>;
+
 class RiskMgr : public SvcBase {
  public:
   using SvcBase::SvcBase;
@@ -102,7 +108,11 @@ class RiskMgr : public SvcBase {
   AssetsMgrSPtr getAssetsMgr() const { return assetsMgr_; }
   RiskOrdMgrSPtr getOrdMgr() const { return ordMgr_; }
 
+  PnlEngineSPtr getPnlEngine() const { return pnlEngine_; }
   PubSvcSPtr getPubSvc() const { return pubSvc_; }
+  PnlTableOfConditionSPtr getPnlTableOfCondition() const {
+    return pnlTableOfCondition_;
+  }
 
   ClientChannelGroupSPtr getTDGWGroup() const { return tdGWGroup_; }
   ClientChannelGroupSPtr getStgEngGroup() const { return stgEngGroup_; }
@@ -131,7 +141,9 @@ class RiskMgr : public SvcBase {
   AssetsMgrSPtr assetsMgr_{nullptr};
   RiskOrdMgrSPtr ordMgr_{nullptr};
 
+  PnlEngineSPtr pnlEngine_{nullptr};
   PubSvcSPtr pubSvc_{nullptr};
+  PnlTableOfConditionSPtr pnlTableOfCondition_{nullptr};
 
   ClientChannelGroupSPtr tdGWGroup_{nullptr};
   ClientChannelGroupSPtr stgEngGroup_{nullptr};
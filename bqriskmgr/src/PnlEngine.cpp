@@ -0,0 +1,243 @@
+/*!
+ * \file PnlEngine.cpp
+ * \project BetterQuant
+ *
+ * \author byrnexu
+ * \date 2023/04/19
+ *
+ * \brief
+ */
+
+#include "PnlEngine.hpp"
+
+#include "PosMgrUtil.hpp"
+#include "def/BQConst.hpp"
+#include "def/DataStruOfMD.hpp"
+#include "util/Decimal.hpp"
+#include "util/Logger.hpp"
+#include "util/MarketDataCache.hpp"
+#include "util/String.hpp"
+
+namespace bq::riskmgr {
+
+namespace {
+
+//! 品种代码的格式为 基础币种-计价币种[-后缀]，现货和u本位合约的pnlUnReal以计价
+//! 币种计价，币本位合约以基础币种计价，国内市场以人民币计价
+std::string GetCurrencyOfPnlUnReal(const PosInfo& posInfo) {
+  switch (posInfo.symbolType_) {
+    case SymbolType::CN_MainBoard:
+    case SymbolType::CN_SecondBoard:
+    case SymbolType::CN_StartupBoard:
+    case SymbolType::CN_TechBoard:
+    case SymbolType::CN_Futures:
+      return CN_OFFICIAL_CURRENCY;
+    default:
+      break;
+  }
+
+  const auto fieldGroup = SplitStr(posInfo.symbolCode_, SEP_OF_SYMBOL_SPOT);
+  if (fieldGroup.size() < 2) {
+    LOG_W("Get currency of pnl unreal of {} failed.", posInfo.symbolCode_);
+    return "";
+  }
+  if (posInfo.symbolType_ == SymbolType::CPerp ||
+      posInfo.symbolType_ == SymbolType::CFutures) {
+    return std::string(fieldGroup[0]);
+  }
+  return std::string(fieldGroup[1]);
+}
+
+template <typename Id2PnlUnReal>
+Currency2PnlUnReal GetPnlUnReal(const Id2PnlUnReal& id2PnlUnReal,
+                                typename Id2PnlUnReal::key_type id) {
+  const auto iter = id2PnlUnReal.find(id);
+  return iter != std::end(id2PnlUnReal) ? iter->second : Currency2PnlUnReal();
+}
+
+}  // namespace
+
+PnlEngine::PnlEngine(const MarketDataCacheSPtr& marketDataCache)
+    : marketDataCache_(marketDataCache) {}
+
+void PnlEngine::sync(const PosInfoGroup& posInfoGroup) {
+  std::lock_guard<std::ext::spin_mutex> guard(mtx_);
+  for (const auto& posInfo : posInfoGroup) {
+    const auto iter = keyHash2PosInfo_.find(posInfo->keyHash_);
+    if (iter != std::end(keyHash2PosInfo_)) {
+      //! 每次成交都会更新lastNoUsedToCalcPos_，没有变化的仓位不需要重新计算
+      const auto& posInfoInEngine = iter->second;
+      //! PosMgr的拷贝可能早于onPosChg推送的仓位，不能用旧的仓位覆盖新的仓位
+      if (posInfoInEngine->lastNoUsedToCalcPos_ >
+          posInfo->lastNoUsedToCalcPos_) {
+        continue;
+      }
+      if (posInfoInEngine->lastNoUsedToCalcPos_ ==
+              posInfo->lastNoUsedToCalcPos_ &&
+          DEC::EQ(posInfoInEngine->pos_, posInfo->pos_) &&
+          DEC::EQ(posInfoInEngine->avgOpenPrice_, posInfo->avgOpenPrice_)) {
+        continue;
+      }
+    }
+    upsert(posInfo);
+  }
+}
+
+void PnlEngine::onPosChg(const PosChgInfoSPtr& posChgInfo) {
+  if (!posChgInfo || posChgInfo->empty()) return;
+  std::lock_guard<std::ext::spin_mutex> guard(mtx_);
+  for (const auto& posInfo : *posChgInfo) {
+    upsert(posInfo);
+  }
+}
+
+void PnlEngine::upsert(const PosInfoSPtr& posInfo) {
+  //! topicPrefix = MD@SSE@Spot@600600@
+  const auto topicPrefix = posInfo->getTopicPrefixForSub();
+
+  PosInfoSPtr posInfoInEngine;
+  const auto iter = keyHash2PosInfo_.find(posInfo->keyHash_);
+  if (iter != std::end(keyHash2PosInfo_)) {
+    //! 品种索引中保存的是同一个指针，原地更新
+    posInfoInEngine = iter->second;
+    addPnlUnRealOfGroup(*posInfoInEngine, posInfoInEngine->pnlUnReal_ * -1);
+    *posInfoInEngine = *posInfo;
+  } else {
+    posInfoInEngine = std::make_shared<PosInfo>(*posInfo);
+    keyHash2PosInfo_.emplace(posInfo->keyHash_, posInfoInEngine);
+    keyHash2CurrencyOfPnlUnReal_.emplace(posInfo->keyHash_,
+                                         GetCurrencyOfPnlUnReal(*posInfo));
+    for (const auto mdType : {MDType::Tickers, MDType::LastPrice}) {
+      const auto topic =
+          fmt::format("{}{}", topicPrefix, magic_enum::enum_name(mdType));
+      const auto topicHash = XXH3_64bits(topic.data(), topic.size());
+      topicHash2PosInfoGroup_[topicHash].emplace_back(posInfoInEngine);
+    }
+  }
+  addPnlUnRealOfGroup(*posInfoInEngine, posInfoInEngine->pnlUnReal_);
+
+  //! 新增或者发生变化的仓位用缓存中的最新价重新计算一次
+  const auto topic = fmt::format("{}{}", topicPrefix,
+                                 magic_enum::enum_name(MDType::Tickers));
+  const auto topicHash = XXH3_64bits(topic.data(), topic.size());
+  auto& tickers = std::ext::tls_get<Tickers>();
+  const auto found = marketDataCache_->getLastTickers(topicHash, tickers);
+  updatePnlUnReal(posInfoInEngine, found ? tickers.lastPrice_ : 0,
+                  tickers.mdHeader_.exchTs_);
+  keyHashGroupOfDirty_.emplace(posInfo->keyHash_);
+}
+
+void PnlEngine::onTickers(const Tickers* tickers) {
+  onLastPrice(tickers->shmHeader_.topicHash_, tickers->lastPrice_,
+              tickers->mdHeader_.exchTs_);
+}
+
+void PnlEngine::onLastPrice(const LastPrice* lastPrice) {
+  onLastPrice(lastPrice->shmHeader_.topicHash_, lastPrice->lastPrice_,
+              lastPrice->mdHeader_.exchTs_);
+}
+
+void PnlEngine::onLastPrice(TopicHash topicHash, Decimal lastPrice,
+                            std::uint64_t exchTs) {
+  if (DEC::ZERO(lastPrice) || DEC::EQ(lastPrice, DBL_MAX)) return;
+
+  std::lock_guard<std::ext::spin_mutex> guard(mtx_);
+  const auto iter = topicHash2PosInfoGroup_.find(topicHash);
+  if (iter == std::end(topicHash2PosInfoGroup_)) return;
+
+  for (const auto& posInfo : iter->second) {
+    const auto pnlUnReal = posInfo->pnlUnReal_;
+    updatePnlUnReal(posInfo, lastPrice, exchTs);
+    if (!DEC::EQ(pnlUnReal, posInfo->pnlUnReal_)) {
+      keyHashGroupOfDirty_.emplace(posInfo->keyHash_);
+    }
+  }
+}
+
+void PnlEngine::updatePnlUnReal(const PosInfoSPtr& posInfo, Decimal lastPrice,
+                                std::uint64_t exchTs) {
+  if (DEC::ZERO(lastPrice) || DEC::EQ(lastPrice, DBL_MAX)) {
+    //!
+    //! 如果查不到价格，或者说价格不合法，那么将更新时间设置为一个很早的值，可
+    //! 以说明，pnlUnReal 为 0 是无效值。
+    //!
+    LOG_T(
+        "Failed to obtain the price of {}, "
+        "so unreal pnl cannot be calculated.",
+        posInfo->getTopicPrefixForSub());
+    posInfo->updateTime_ = UNDEFINED_FIELD_MIN_TS;
+    return;
+  }
+
+  Decimal pnlUnReal = 0;
+  if (posInfo->pos_ > 0) {
+    pnlUnReal =
+        calcPnlOfCloseLong(posInfo->symbolType_, posInfo->avgOpenPrice_,
+                           lastPrice, posInfo->pos_, posInfo->parValue_);
+  } else if (posInfo->pos_ < 0) {
+    pnlUnReal =
+        calcPnlOfCloseShort(posInfo->symbolType_, posInfo->avgOpenPrice_,
+                            lastPrice, posInfo->pos_ * -1, posInfo->parValue_);
+  }
+
+  addPnlUnRealOfGroup(*posInfo, pnlUnReal - posInfo->pnlUnReal_);
+  posInfo->pnlUnReal_ = pnlUnReal;
+  posInfo->updateTime_ = exchTs;
+}
+
+void PnlEngine::addPnlUnRealOfGroup(const PosInfo& posInfo, Decimal value) {
+  if (DEC::ZERO(value)) return;
+  const auto& currency = keyHash2CurrencyOfPnlUnReal_[posInfo.keyHash_];
+  acctId2PnlUnReal_[posInfo.acctId_][currency] += value;
+  stgId2PnlUnReal_[posInfo.stgId_][currency] += value;
+  stgInstKey2PnlUnReal_[GetStgInstKey(posInfo.stgId_, posInfo.stgInstId_)]
+                       [currency] += value;
+}
+
+PosInfoGroup PnlEngine::getPosInfoGroup() const {
+  PosInfoGroup ret;
+  std::lock_guard<std::ext::spin_mutex> guard(mtx_);
+  ret.reserve(keyHash2PosInfo_.size());
+  for (const auto& rec : keyHash2PosInfo_) {
+    ret.emplace_back(std::make_shared<PosInfo>(*rec.second));
+  }
+  return ret;
+}
+
+PosInfoGroup PnlEngine::getPosInfoGroupOfDirty() {
+  PosInfoGroup ret;
+  std::lock_guard<std::ext::spin_mutex> guard(mtx_);
+  ret.reserve(keyHashGroupOfDirty_.size());
+  for (const auto keyHash : keyHashGroupOfDirty_) {
+    const auto iter = keyHash2PosInfo_.find(keyHash);
+    if (iter != std::end(keyHash2PosInfo_)) {
+      ret.emplace_back(std::make_shared<PosInfo>(*iter->second));
+    }
+  }
+  keyHashGroupOfDirty_.clear();
+  return ret;
+}
+
+Currency2PnlUnReal PnlEngine::getPnlUnRealOfAcctId(AcctId acctId) const {
+  std::lock_guard<std::ext::spin_mutex> guard(mtx_);
+  return GetPnlUnReal(acctId2PnlUnReal_, acctId);
+}
+
+Currency2PnlUnReal PnlEngine::getPnlUnRealOfStgId(StgId stgId) const {
+  std::lock_guard<std::ext::spin_mutex> guard(mtx_);
+  return GetPnlUnReal(stgId2PnlUnReal_, stgId);
+}
+
+Currency2PnlUnReal PnlEngine::getPnlUnRealOfStgInstId(
+    StgId stgId, StgInstId stgInstId) const {
+  std::lock_guard<std::ext::spin_mutex> guard(mtx_);
+  return GetPnlUnReal(stgInstKey2PnlUnReal_,
+                      GetStgInstKey(stgId, stgInstId));
+}
+
+std::size_t PnlEngine::size() const {
+  std::lock_guard<std::ext::spin_mutex> guard(mtx_);
+  return keyHash2PosInfo_.size();
+}
+
+}  // namespace bq::riskmgr
@@ -12,23 +12,26 @@
 
 #include "AssetsMgr.hpp"
 #include "Config.hpp"
-#include "PosMgr.hpp"
-#include "PosMgrUtil.hpp"
+#include "PnlEngine.hpp"
 #include "RiskMgr.hpp"
 #include "SHMIPC.hpp"
 #include "def/DataStruOfAssets.hpp"
-#include "def/DataStruOfMD.hpp"
 #include "def/DataStruOfOthers.hpp"
+#include "def/Pnl.hpp"
+#include "def/StatusCode.hpp"
 #include "util/Datetime.hpp"
 #include "util/Decimal.hpp"
+#include "util/Literal.hpp"
 #include "util/Logger.hpp"
-#include "util/MarketDataCache.hpp"
+#include "util/PnlTableOfCondition.hpp"
+#include "util/PosSnapshot.hpp"
 #include "util/String.hpp"
 
 namespace bq::riskmgr {
 
 PubSvc::PubSvc(RiskMgr* riskMgr)
     : riskMgr_(riskMgr),
+      key2PosInfoGroupOfAll_(std::make_shared<Key2PosInfoGroup>()),
       acctId2Key2PosInfoGroup_(std::make_shared<AcctId2Key2PosInfoGroup>()),
       stgId2Key2PosInfoGroup_(std::make_shared<StgId2Key2PosInfoGroup>()),
       stgInstId2Key2PosInfoGroup_(
@@ -36,57 +39,79 @@ PubSvc::PubSvc(RiskMgr* riskMgr)
       acctId2Key2AssetInfoGroup_(
           std::make_shared<AcctId2Key2AssetInfoGroup>()) {}
 
-void PubSvc::initPnlUnReal(PosInfoGroup& posInfoGroup) {
-  for (auto& posInfo : posInfoGroup) {
-    //! topicPrefix = MD@SSE@Spot@600600@
-    const auto topicPrefix = posInfo->getTopicPrefixForSub();
-    //! topic = MD@SSE@Spot@600600@Tickers
-    const auto topic = fmt::format("{}{}", topicPrefix,
-                                   magic_enum::enum_name(MDType::Tickers));
-    const auto tickers = riskMgr_->getMarketDataCache()->getLastTickers(topic);
-    if (tickers == nullptr ||  //
-        DEC::ZERO(tickers->lastPrice_) ||
-        DEC::EQ(tickers->lastPrice_, DBL_MAX)) {
-      //!
-      //! 如果查不到价格，或者说价格不合法，那么将更新时间设置为一个很早的值，可
-      //! 以说明，pnlUnReal 为 0 是无效值。
-      //!
-      LOG_T(
-          "Failed to obtain the price of {}, "
-          "so unreal pnl cannot be calculated.",
-          topic);
-      posInfo->updateTime_ = UNDEFINED_FIELD_MIN_TS;
-      continue;
-    }
+void PubSvc::pubPosSnapshotOfAll() {
+  //! 只有pnlUnReal有变化的仓位才更新数据库中的pnlUnReal和updateTime
+  updatePosInfoInDB(riskMgr_->getPnlEngine()->getPosInfoGroupOfDirty());
 
-    posInfo->updateTime_ = tickers->mdHeader_.exchTs_;
-    if (posInfo->pos_ > 0) {
-      posInfo->pnlUnReal_ = calcPnlOfCloseLong(
-          posInfo->symbolType_, posInfo->avgOpenPrice_, tickers->lastPrice_,
-          posInfo->pos_, posInfo->parValue_);
-    } else if (posInfo->pos_ < 0) {
-      posInfo->pnlUnReal_ = calcPnlOfCloseShort(
-          posInfo->symbolType_, posInfo->avgOpenPrice_, tickers->lastPrice_,
-          posInfo->pos_ * -1, posInfo->parValue_);
-    } else {
-      posInfo->pnlUnReal_ = 0;
+  //! 从PnlEngine拷贝一份仓位列表，pnlUnReal和updateTime已经随行情计算好
+  auto posInfoGroup = riskMgr_->getPnlEngine()->getPosInfoGroup();
+  MergePosInfoHasNoFeeCurrency(posInfoGroup);
+
+  auto key2PosInfoGroup = std::make_shared<Key2PosInfoGroup>();
+  for (const auto& posInfo : posInfoGroup) {
+    key2PosInfoGroup->emplace(posInfo->getKey(), posInfo);
+  }
+
+  //!
+  //! 定期或者接收端请求的时候发送全部仓位作为关键帧，其余时候只发送和上一次
+  //! 相比新增、变化和移除的仓位，没有变化的时候不发送，seqNo也不增加。
+  //!
+  if (isTimeToPubPosKeyframeOfAll()) {
+    pushPosInfoOfAll(MSG_ID_POS_SNAPSHOT_OF_ALL, posInfoGroup);
+  } else {
+    const auto posDeltaGroup = getPosDeltaGroupOfAll(key2PosInfoGroup);
+    if (!posDeltaGroup.empty()) {
+      pushPosDeltaOfAll(posDeltaGroup);
     }
   }
+
+  //! 重置key2PosInfoGroupOfAll_
+  key2PosInfoGroupOfAll_ = key2PosInfoGroup;
 }
 
-void PubSvc::pubPosSnapshotOfAll() {
-  //! DeepClone一份仓位列表
-  auto posInfoGroup = riskMgr_->getPosMgr()->getPosInfoGroup<LockFunc::True>();
-  MergePosInfoHasNoFeeCurrency(posInfoGroup);
+bool PubSvc::isTimeToPubPosKeyframeOfAll() {
+  const auto milliSecIntervalOfPubPosKeyframeOfAll =
+      CONFIG["milliSecIntervalOfPubPosKeyframeOfAll"].as<std::uint64_t>();
+  const auto now = GetTotalMSSince1970();
+  const auto isTimeout = now - msOfLastPosKeyframeOfAll_ >=
+                         milliSecIntervalOfPubPosKeyframeOfAll;
+  if (isPosKeyframeOfAllReq_.exchange(false) || isTimeout) {
+    msOfLastPosKeyframeOfAll_ = now;
+    return true;
+  }
+  return false;
+}
 
-  //! 计算并填充pnlUnReal和updateTime
-  initPnlUnReal(posInfoGroup);
+PosDeltaGroup PubSvc::getPosDeltaGroupOfAll(
+    const Key2PosInfoGroupSPtr& key2PosInfoGroupNew) {
+  PosDeltaGroup ret;
+
+  for (const auto& [key, posInfo] : *key2PosInfoGroupNew) {
+    const auto iter = key2PosInfoGroupOfAll_->find(key);
+    if (iter == std::end(*key2PosInfoGroupOfAll_)) {
+      //! 新的仓位表中有旧的仓位表中没有，是新增的仓位。
+      ret.emplace_back(PosDelta{PosDeltaType::Add, *posInfo});
+    } else {
+      //!
+      //! 新旧仓位表中都有，那么要看仓位信息是否发生了变化。updateTime也要
+      //! 比较，否则接收端判断价格延时的时候会误认为仓位的pnl已经过期。
+      //!
+      const auto& posInfoOld = iter->second;
+      if (posInfo->isEqual(posInfoOld) == false ||
+          posInfo->updateTime_ != posInfoOld->updateTime_) {
+        ret.emplace_back(PosDelta{PosDeltaType::Chg, *posInfo});
+      }
+    }
+  }
 
-  //! 更新数据库中的pnlUnReal和updateTime
-  updatePosInfoInDB(posInfoGroup);
+  //! 旧的仓位表中有新的仓位表中没有，是移除的仓位。
+  for (const auto& [key, posInfo] : *key2PosInfoGroupOfAll_) {
+    if (key2PosInfoGroupNew->find(key) == std::end(*key2PosInfoGroupNew)) {
+      ret.emplace_back(PosDelta{PosDeltaType::Del, *posInfo});
+    }
+  }
 
-  //! 发送仓位信息
-  pushPosInfoOfAll(MSG_ID_POS_SNAPSHOT_OF_ALL, posInfoGroup);
+  return ret;
 }
 
 void PubSvc::updatePosInfoInDB(const PosInfoGroup& posInfoGroup) {
@@ -121,6 +146,7 @@ void PubSvc::pushPosInfoOfAll(MsgId msgId, const PosInfoGroup& posInfoGroup) {
       [&](void* shmBuf) {
         auto posUpdateOfAllForPub = static_cast<PosUpdateOfAllForPub*>(shmBuf);
         posUpdateOfAllForPub->shmHeader_.topicHash_ = makeTopicHash();
+        posUpdateOfAllForPub->seqNo_ = seqNoOfPosDeltaOfAll_;
         posUpdateOfAllForPub->num_ = posInfoGroup.size();
         auto posInfoAddr = posUpdateOfAllForPub->posInfoGroup_;
         for (const auto& posInfo : posInfoGroup) {
@@ -132,14 +158,70 @@ void PubSvc::pushPosInfoOfAll(MsgId msgId, const PosInfoGroup& posInfoGroup) {
       sizeof(PosUpdateOfAllForPub) + posInfoGroup.size() * sizeof(PosInfo));
 }
 
+// topic = "RISK@PubChannel@Trade@PosInfo@All"
+void PubSvc::pushPosDeltaOfAll(const PosDeltaGroup& posDeltaGroup) {
+  const auto seqNo = ++seqNoOfPosDeltaOfAll_;
+  const auto makeTopicHash = [&]() {
+    const auto pubChannel = CONFIG["pubChannel"].as<std::string>();
+    const auto topic =
+        fmt::format("{}{}PosInfo{}All", pubChannel, SEP_OF_TOPIC, SEP_OF_TOPIC);
+    LOG_T("Pub delta {} [seqNo = {}; num = {}]", topic, seqNo,
+          posDeltaGroup.size());
+    const auto topicHash = XXH3_64bits(topic.data(), topic.size());
+    return topicHash;
+  };
+
+  riskMgr_->getSHMSrvOfPub()->pushMsgWithZeroCopy(
+      [&](void* shmBuf) {
+        auto posDeltaOfAllForPub = static_cast<PosDeltaOfAllForPub*>(shmBuf);
+        posDeltaOfAllForPub->shmHeader_.topicHash_ = makeTopicHash();
+        posDeltaOfAllForPub->seqNo_ = seqNo;
+        posDeltaOfAllForPub->num_ = posDeltaGroup.size();
+        memcpy(posDeltaOfAllForPub->posDeltaGroup_, posDeltaGroup.data(),
+               posDeltaGroup.size() * sizeof(PosDelta));
+      },
+      PUB_CHANNEL, MSG_ID_POS_DELTA_OF_ALL,
+      sizeof(PosDeltaOfAllForPub) + posDeltaGroup.size() * sizeof(PosDelta));
+}
+
+void PubSvc::pubPnlOfCondition() {
+  //! 第一个已注册的条件出现时才生成仓位快照，所有条件共用这一份快照
+  PosSnapshotSPtr posSnapshot{nullptr};
+  const auto calcPnlOfCondition = [&](const std::string& condition,
+                                      PnlOfCondition& pnlOfCondition) {
+    if (posSnapshot == nullptr) {
+      auto posInfoGroup = riskMgr_->getPnlEngine()->getPosInfoGroup();
+      MergePosInfoHasNoFeeCurrency(posInfoGroup);
+      Key2PosInfoGroup posInfoDetail;
+      for (const auto& posInfo : posInfoGroup) {
+        posInfoDetail.emplace(posInfo->getKey(), posInfo);
+      }
+      posSnapshot = std::make_shared<PosSnapshot>(
+          posInfoDetail, riskMgr_->getMarketDataCache());
+    }
+
+    const auto [statusCode, pnl] =
+        posSnapshot->queryPnl(condition, QuoteCurrencyForCalc("CNY"));
+    if (statusCode != 0 || pnl == nullptr) {
+      return statusCode != 0 ? statusCode : SCODE_BQPUB_PNL_NOT_EXISTS;
+    }
+
+    pnlOfCondition.pnlUnReal_ = pnl->pnlUnReal_;
+    pnlOfCondition.pnlReal_ = pnl->pnlReal_;
+    pnlOfCondition.fee_ = pnl->fee_;
+    pnlOfCondition.updateTime_ = pnl->updateTime_;
+    LOG_T("Pub pnl of condition. {}", pnl->toStr());
+    return 0;
+  };
+
+  riskMgr_->getPnlTableOfCondition()->update(calcPnlOfCondition);
+}
+
 void PubSvc::pubPosUpdateOfAcctId() {
-  //! DeepClone一份仓位列表
-  auto posInfoGroup = riskMgr_->getPosMgr()->getPosInfoGroup<LockFunc::True>();
+  //! 从PnlEngine拷贝一份仓位列表，pnlUnReal和updateTime已经随行情计算好
+  auto posInfoGroup = riskMgr_->getPnlEngine()->getPosInfoGroup();
   MergePosInfoHasNoFeeCurrency(posInfoGroup);
 
-  //! 计算并填充pnlUnReal和updateTime
-  initPnlUnReal(posInfoGroup);
-
   //! 对PosInfo进行分组
   const auto acctId2Key2PosInfoGroup = posInfoGroupByAcctId(posInfoGroup);
 
@@ -159,13 +241,10 @@ void PubSvc::pubPosUpdateOfAcctId() {
 }
 
 void PubSvc::pubPosSnapshotOfAcctId() {
-  //! DeepClone一份仓位列表
-  auto posInfoGroup = riskMgr_->getPosMgr()->getPosInfoGroup<LockFunc::True>();
+  //! 从PnlEngine拷贝一份仓位列表，pnlUnReal和updateTime已经随行情计算好
+  auto posInfoGroup = riskMgr_->getPnlEngine()->getPosInfoGroup();
   MergePosInfoHasNoFeeCurrency(posInfoGroup);
 
-  //! 计算并填充pnlUnReal和updateTime
-  initPnlUnReal(posInfoGroup);
-
   //! 对PosInfo进行分组
   const auto acctId2Key2PosInfoGroup = posInfoGroupByAcctId(posInfoGroup);
 
@@ -265,13 +344,10 @@ void PubSvc::pushAcctId2Key2PosInfoGroup(
 }
 
 void PubSvc::pubPosUpdateOfStgId() {
-  //! DeepClone一份仓位列表
-  auto posInfoGroup = riskMgr_->getPosMgr()->getPosInfoGroup<LockFunc::True>();
+  //! 从PnlEngine拷贝一份仓位列表，pnlUnReal和updateTime已经随行情计算好
+  auto posInfoGroup = riskMgr_->getPnlEngine()->getPosInfoGroup();
   MergePosInfoHasNoFeeCurrency(posInfoGroup);
 
-  //! 计算并填充pnlUnReal和updateTime
-  initPnlUnReal(posInfoGroup);
-
   //! 对PosInfo进行分组
   const auto stgId2Key2PosInfoGroup = posInfoGroupByStgId(posInfoGroup);
 
@@ -291,13 +367,10 @@ void PubSvc::pubPosUpdateOfStgId() {
 }
 
 void PubSvc::pubPosSnapshotOfStgId() {
-  //! DeepClone一份仓位列表
-  auto posInfoGroup = riskMgr_->getPosMgr()->getPosInfoGroup<LockFunc::True>();
+  //! 从PnlEngine拷贝一份仓位列表，pnlUnReal和updateTime已经随行情计算好
+  auto posInfoGroup = riskMgr_->getPnlEngine()->getPosInfoGroup();
   MergePosInfoHasNoFeeCurrency(posInfoGroup);
 
-  //! 计算并填充pnlUnReal和updateTime
-  initPnlUnReal(posInfoGroup);
-
   //! 对PosInfo进行分组
   const auto stgId2Key2PosInfoGroup = posInfoGroupByStgId(posInfoGroup);
 
@@ -396,13 +469,10 @@ void PubSvc::pushStgId2Key2PosInfoGroup(
 }
 
 void PubSvc::pubPosUpdateOfStgInstId() {
-  //! DeepClone一份仓位列表
-  auto posInfoGroup = riskMgr_->getPosMgr()->getPosInfoGroup<LockFunc::True>();
+  //! 从PnlEngine拷贝一份仓位列表，pnlUnReal和updateTime已经随行情计算好
+  auto posInfoGroup = riskMgr_->getPnlEngine()->getPosInfoGroup();
   MergePosInfoHasNoFeeCurrency(posInfoGroup);
 
-  //! 计算并填充pnlUnReal和updateTime
-  initPnlUnReal(posInfoGroup);
-
   //! 对PosInfo进行分组
   const auto stgInstId2Key2PosInfoGroup = posInfoGroupByStgInstId(posInfoGroup);
 
@@ -422,13 +492,10 @@ void PubSvc::pubPosUpdateOfStgInstId() {
 }
 
 void PubSvc::pubPosSnapshotOfStgInstId() {
-  //! DeepClone一份仓位列表
-  auto posInfoGroup = riskMgr_->getPosMgr()->getPosInfoGroup<LockFunc::True>();
+  //! 从PnlEngine拷贝一份仓位列表，pnlUnReal和updateTime已经随行情计算好
+  auto posInfoGroup = riskMgr_->getPnlEngine()->getPosInfoGroup();
   MergePosInfoHasNoFeeCurrency(posInfoGroup);
 
-  //! 计算并填充pnlUnReal和updateTime
-  initPnlUnReal(posInfoGroup);
-
   //! 对PosInfo进行分组
   const auto stgId2Key2PosInfoGroup = posInfoGroupByStgInstId(posInfoGroup);
 
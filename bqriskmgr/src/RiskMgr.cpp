@@ -14,6 +14,7 @@
 #include "ClientChannelGroup.hpp"
 #include "Config.hpp"
 #include "OrdMgr.hpp"
+#include "PnlEngine.hpp"
 #include "PosMgr.hpp"
 #include "PubSvc.hpp"
 #include "RiskMgrConst.hpp"
@@ -33,6 +34,7 @@
 #include "util/Literal.hpp"
 #include "util/Logger.hpp"
 #include "util/MarketDataCache.hpp"
+#include "util/PnlTableOfCondition.hpp"
 #include "util/ScheduleTaskBundle.hpp"
 #include "util/Scheduler.hpp"
 #include "util/StdExt.hpp"
@@ -70,14 +72,21 @@ int RiskMgr::doInit() {
   initTBLMonitorOfSymbolInfo();
 
   marketDataCache_ = std::make_shared<MarketDataCache>();
+  pnlEngine_ = std::make_shared<PnlEngine>(marketDataCache_);
   subMgr_ = std::make_shared<SubMgr>(
       AppName, [this](const auto shmBuf, auto shmBufLen) {
-        const auto task = std::make_shared<SHMIPCTask>(shmBuf, shmBufLen);
-        const auto header = static_cast<const SHMHeader*>(task->data_);
+        //! 直接从共享内存写入缓存，不再拷贝一份tickers，同时只重新计算该品种
+        //! 的仓位的pnlUnReal
+        const auto header = static_cast<const SHMHeader*>(shmBuf);
         if (header->msgId_ == MSG_ID_ON_MD_TICKERS) {
-          const auto tickers = MakeMsgSPtrByTask<Tickers>(task);
+          const auto tickers = static_cast<const Tickers*>(shmBuf);
           marketDataCache_->cache(tickers);
+          pnlEngine_->onTickers(tickers);
+        } else if (header->msgId_ == MSG_ID_ON_MD_LAST_PRICE) {
+          pnlEngine_->onLastPrice(static_cast<const LastPrice*>(shmBuf));
         }
+        //! 订单簿不参与盈亏计算，PUB_CHANNEL上收到的Books和BooksDelta都直接
+        //! 忽略，所以这里不重建增量订单簿，也不会因为增量不连续而请求全量刷新
       });
 
   initPosMgr();
@@ -86,6 +95,11 @@ int RiskMgr::doInit() {
 
   pubSvc_ = std::make_shared<PubSvc>(this);
 
+  //! 交易服务的盈亏监控插件在其中注册监控条件，由风控服务统一计算盈亏
+  pnlTableOfCondition_ = std::make_shared<PnlTableOfCondition>();
+  pnlTableOfCondition_->load(SEGMENT_OF_PNL_TABLE_OF_CONDITION);
+  pnlTableOfCondition_->resetSeqNoOfWriter();
+
   tdGWGroup_ = std::make_shared<ClientChannelGroup>("TDGW");
   stgEngGroup_ = std::make_shared<ClientChannelGroup>("StgEng");
 
@@ -252,7 +266,17 @@ void RiskMgr::initSHMSrv() {
   const auto pubChannel =
       fmt::format("{}@{}", AppName, CONFIG["pubChannel"].as<std::string>());
   shmSrvOfPub_ = std::make_shared<SHMSrv>(
-      pubChannel, [this](const auto* shmBuf, std::size_t shmBufLen) {});
+      pubChannel, [this](const auto* shmBuf, std::size_t shmBufLen) {
+        //! 订阅仓位的接收端发现增量不连续之后请求关键帧
+        const auto shmHeader = static_cast<const SHMHeader*>(shmBuf);
+        if (shmHeader->msgId_ == MSG_ID_POS_KEYFRAME_REQ_OF_ALL) {
+          const auto posKeyframeReqOfAll =
+              static_cast<const PosKeyframeReqOfAll*>(shmBuf);
+          LOG_I("Recv keyframe req of pos info of all. [seqNo = {}]",
+                posKeyframeReqOfAll->seqNo_);
+          getPubSvc()->reqPosKeyframeOfAll();
+        }
+      });
 }
 
 void RiskMgr::initScheduleTaskBundle() {
@@ -278,6 +302,8 @@ void RiskMgr::initScheduleTaskBundle() {
               "{}{}", topicPrefix, magic_enum::enum_name(MDType::Tickers));
           getSubMgr()->sub(PUB_CHANNEL, topic);
         }
+        //! 顺便补上PnlEngine中没有的仓位，比如PosMgr中新增的空仓位
+        getPnlEngine()->sync(posInfoGroup);
         return true;
       },
       ExecAtStartup::True, milliSecIntervalOfSubMarketData));
@@ -292,6 +318,16 @@ void RiskMgr::initScheduleTaskBundle() {
       },
       ExecAtStartup::True, milliSecIntervalOfPubPosSnapshotOfAll));
 
+  const auto milliSecIntervalOfPubPnlOfCondition =
+      CONFIG["milliSecIntervalOfPubPnlOfCondition"].as<std::uint32_t>();
+  getScheduleTaskBundle()->emplace_back(std::make_shared<ScheduleTask>(
+      "pubPnlOfCondition",
+      [this]() {
+        getPubSvc()->pubPnlOfCondition();
+        return true;
+      },
+      ExecAtStartup::True, milliSecIntervalOfPubPnlOfCondition));
+
   const auto milliSecIntervalOfPubPosUpdateOfAcctId =
       CONFIG["milliSecIntervalOfPubPosUpdateOfAcctId"].as<std::uint32_t>();
   getScheduleTaskBundle()->emplace_back(std::make_shared<ScheduleTask>(
@@ -371,6 +407,16 @@ void RiskMgr::initScheduleTaskBundle() {
         return true;
       },
       ExecAtStartup::True, milliSecIntervalOfPubAssetsSnapshot));
+
+  const auto milliSecIntervalOfEvictClosedOrder =
+      CONFIG["milliSecIntervalOfEvictClosedOrder"].as<std::uint32_t>(60000);
+  getScheduleTaskBundle()->emplace_back(std::make_shared<ScheduleTask>(
+      "evictClosedOrder",
+      [this]() {
+        getOrdMgr()->evictOrderInfoOfClosedGroup<LockFunc::True>();
+        return true;
+      },
+      ExecAtStartup::False, milliSecIntervalOfEvictClosedOrder));
 }
 
 int RiskMgr::doRun() {
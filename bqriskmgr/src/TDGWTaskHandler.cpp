@@ -13,6 +13,7 @@
 #include "AssetsMgr.hpp"
 #include "ClientChannelGroup.hpp"
 #include "OrdMgr.hpp"
+#include "PnlEngine.hpp"
 #include "PosMgr.hpp"
 #include "RiskMgr.hpp"
 #include "SHMHeader.hpp"
@@ -71,7 +72,10 @@ void TDGWTaskHandler::handleMsgIdOnOrderRet(
 
   //! 用ordRet更新仓位
   if (isTheOrderCanBeUsedCalcPos == IsTheOrderCanBeUsedCalcPos::True) {
-    riskMgr_->getPosMgr()->updateByOrderInfoFromTDGW<LockFunc::True>(ordRet);
+    const auto posChgInfo =
+        riskMgr_->getPosMgr()->updateByOrderInfoFromTDGW<LockFunc::True>(
+            ordRet);
+    riskMgr_->getPnlEngine()->onPosChg(posChgInfo);
   }
 }
 
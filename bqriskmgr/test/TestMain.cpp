@@ -13,6 +13,15 @@
 
 #include <string>
 
+#include "PnlEngine.hpp"
+#include "def/DataStruOfMD.hpp"
+#include "def/PosInfo.hpp"
+#include "util/Decimal.hpp"
+#include "util/MarketDataCache.hpp"
+
+using namespace bq;
+using namespace bq::riskmgr;
+
 class global_event : public testing::Environment {
  public:
   virtual void SetUp() {}
@@ -21,6 +30,182 @@ class global_event : public testing::Environment {
 
 TEST(test, test1) {}
 
+namespace {
+
+PosInfoSPtr MakePosInfoForTest(std::uint64_t keyHash,
+                               const std::string& symbolCode, Decimal pos,
+                               Decimal avgOpenPrice,
+                               std::uint64_t lastNoUsedToCalcPos) {
+  auto posInfo = std::make_shared<PosInfo>();
+  posInfo->keyHash_ = keyHash;
+  posInfo->acctId_ = 10000;
+  posInfo->marketCode_ = MarketCode::Binance;
+  posInfo->symbolType_ = SymbolType::Spot;
+  strncpy(posInfo->symbolCode_, symbolCode.c_str(),
+          sizeof(posInfo->symbolCode_) - 1);
+  posInfo->pos_ = pos;
+  posInfo->avgOpenPrice_ = avgOpenPrice;
+  posInfo->lastNoUsedToCalcPos_ = lastNoUsedToCalcPos;
+  return posInfo;
+}
+
+TopicHash GetTopicHashForTest(const PosInfoSPtr& posInfo, MDType mdType) {
+  const auto topic = fmt::format("{}{}", posInfo->getTopicPrefixForSub(),
+                                 magic_enum::enum_name(mdType));
+  return XXH3_64bits(topic.data(), topic.size());
+}
+
+PosInfoSPtr FindPosInfoForTest(const PosInfoGroup& posInfoGroup,
+                               std::uint64_t keyHash) {
+  for (const auto& posInfo : posInfoGroup) {
+    if (posInfo->keyHash_ == keyHash) return posInfo;
+  }
+  return nullptr;
+}
+
+}  // namespace
+
+TEST(test, testPnlEngineOnMarketData) {
+  auto pnlEngine =
+      std::make_shared<PnlEngine>(std::make_shared<MarketDataCache>());
+  const auto posInfoOfBTC = MakePosInfoForTest(1, "BTC-USDT", 2, 100, 1);
+  const auto posInfoOfETH = MakePosInfoForTest(2, "ETH-USDT", -1, 10, 1);
+  pnlEngine->sync({posInfoOfBTC, posInfoOfETH});
+  EXPECT_TRUE(pnlEngine->size() == 2);
+  EXPECT_TRUE(pnlEngine->getPosInfoGroupOfDirty().size() == 2);
+
+  //! 只重新计算收到行情的品种的仓位
+  Tickers tickers;
+  tickers.shmHeader_.topicHash_ =
+      GetTopicHashForTest(posInfoOfBTC, MDType::Tickers);
+  tickers.mdHeader_.exchTs_ = 1;
+  tickers.lastPrice_ = 110;
+  pnlEngine->onTickers(&tickers);
+
+  auto posInfoGroup = pnlEngine->getPosInfoGroupOfDirty();
+  EXPECT_TRUE(posInfoGroup.size() == 1);
+  auto posInfo = FindPosInfoForTest(posInfoGroup, 1);
+  EXPECT_TRUE(posInfo && DEC::EQ(posInfo->pnlUnReal_, 20));
+  EXPECT_TRUE(posInfo && posInfo->updateTime_ == 1);
+
+  LastPrice lastPrice;
+  lastPrice.shmHeader_.topicHash_ =
+      GetTopicHashForTest(posInfoOfETH, MDType::LastPrice);
+  lastPrice.mdHeader_.exchTs_ = 2;
+  lastPrice.lastPrice_ = 8;
+  pnlEngine->onLastPrice(&lastPrice);
+
+  posInfoGroup = pnlEngine->getPosInfoGroupOfDirty();
+  EXPECT_TRUE(posInfoGroup.size() == 1);
+  posInfo = FindPosInfoForTest(posInfoGroup, 2);
+  EXPECT_TRUE(posInfo && DEC::EQ(posInfo->pnlUnReal_, 2));
+  posInfo = FindPosInfoForTest(pnlEngine->getPosInfoGroup(), 1);
+  EXPECT_TRUE(posInfo && DEC::EQ(posInfo->pnlUnReal_, 20));
+}
+
+TEST(test, testPnlEngineOnPosChg) {
+  auto marketDataCache = std::make_shared<MarketDataCache>();
+  auto pnlEngine = std::make_shared<PnlEngine>(marketDataCache);
+
+  //! 新增的仓位用缓存中的最新价计算一次
+  const auto posInfoOfBTC = MakePosInfoForTest(1, "BTC-USDT", 2, 100, 1);
+  Tickers tickers;
+  tickers.shmHeader_.topicHash_ =
+      GetTopicHashForTest(posInfoOfBTC, MDType::Tickers);
+  tickers.mdHeader_.exchTs_ = 1;
+  tickers.lastPrice_ = 105;
+  marketDataCache->cache(&tickers);
+
+  pnlEngine->onPosChg(std::make_shared<PosChgInfo>(PosChgInfo{posInfoOfBTC}));
+  EXPECT_TRUE(pnlEngine->size() == 1);
+  auto posInfo = FindPosInfoForTest(pnlEngine->getPosInfoGroup(), 1);
+  EXPECT_TRUE(posInfo && DEC::EQ(posInfo->pnlUnReal_, 10));
+
+  //! 平仓之后仓位保留，pnlUnReal归0，之后的行情不再产生浮动盈亏
+  const auto posInfoOfClose = MakePosInfoForTest(1, "BTC-USDT", 0, 0, 2);
+  pnlEngine->onPosChg(
+      std::make_shared<PosChgInfo>(PosChgInfo{posInfoOfClose}));
+  EXPECT_TRUE(pnlEngine->size() == 1);
+  tickers.lastPrice_ = 120;
+  pnlEngine->onTickers(&tickers);
+  posInfo = FindPosInfoForTest(pnlEngine->getPosInfoGroup(), 1);
+  EXPECT_TRUE(posInfo && DEC::ZERO(posInfo->pos_));
+  EXPECT_TRUE(posInfo && DEC::ZERO(posInfo->pnlUnReal_));
+
+  pnlEngine->onPosChg(nullptr);
+  pnlEngine->onPosChg(std::make_shared<PosChgInfo>());
+  EXPECT_TRUE(pnlEngine->size() == 1);
+}
+
+TEST(test, testPnlEngineSyncWithOlderPosInfo) {
+  auto pnlEngine =
+      std::make_shared<PnlEngine>(std::make_shared<MarketDataCache>());
+  pnlEngine->onPosChg(std::make_shared<PosChgInfo>(
+      PosChgInfo{MakePosInfoForTest(1, "BTC-USDT", 3, 100, 5)}));
+
+  //! PosMgr的拷贝早于onPosChg，不能覆盖更新的仓位
+  pnlEngine->sync({MakePosInfoForTest(1, "BTC-USDT", 2, 100, 4)});
+  auto posInfo = FindPosInfoForTest(pnlEngine->getPosInfoGroup(), 1);
+  EXPECT_TRUE(posInfo && DEC::EQ(posInfo->pos_, 3));
+  EXPECT_TRUE(posInfo && posInfo->lastNoUsedToCalcPos_ == 5);
+
+  //! 更新的拷贝正常覆盖
+  pnlEngine->sync({MakePosInfoForTest(1, "BTC-USDT", 4, 100, 6)});
+  posInfo = FindPosInfoForTest(pnlEngine->getPosInfoGroup(), 1);
+  EXPECT_TRUE(posInfo && DEC::EQ(posInfo->pos_, 4));
+  EXPECT_TRUE(posInfo && posInfo->lastNoUsedToCalcPos_ == 6);
+}
+
+TEST(test, testPnlEngineSumOfPnlUnReal) {
+  auto pnlEngine =
+      std::make_shared<PnlEngine>(std::make_shared<MarketDataCache>());
+  auto posInfoOfBTC = MakePosInfoForTest(1, "BTC-USDT", 2, 100, 1);
+  auto posInfoOfETH = MakePosInfoForTest(2, "ETH-USDT", 1, 10, 1);
+  auto posInfoOfETHBTC = MakePosInfoForTest(3, "ETH-BTC", 10, 0.05, 1);
+  for (const auto& posInfo : {posInfoOfBTC, posInfoOfETH, posInfoOfETHBTC}) {
+    posInfo->stgId_ = 1;
+    posInfo->stgInstId_ = 2;
+  }
+  pnlEngine->sync({posInfoOfBTC, posInfoOfETH, posInfoOfETHBTC});
+
+  const auto onTickers = [&](const PosInfoSPtr& posInfo, Decimal lastPrice) {
+    Tickers tickers;
+    tickers.shmHeader_.topicHash_ =
+        GetTopicHashForTest(posInfo, MDType::Tickers);
+    tickers.mdHeader_.exchTs_ = 1;
+    tickers.lastPrice_ = lastPrice;
+    pnlEngine->onTickers(&tickers);
+  };
+  onTickers(posInfoOfBTC, 110);
+  onTickers(posInfoOfETH, 15);
+  onTickers(posInfoOfETHBTC, 0.06);
+
+  //! 不同币种的pnlUnReal分别累加
+  for (const auto& pnlUnReal :
+       {pnlEngine->getPnlUnRealOfAcctId(10000),
+        pnlEngine->getPnlUnRealOfStgId(1),
+        pnlEngine->getPnlUnRealOfStgInstId(1, 2)}) {
+    EXPECT_TRUE(pnlUnReal.size() == 2);
+    EXPECT_TRUE(DEC::EQ(pnlUnReal.at("USDT"), 25));
+    EXPECT_TRUE(DEC::EQ(pnlUnReal.at("BTC"), 0.1));
+  }
+  EXPECT_TRUE(pnlEngine->getPnlUnRealOfAcctId(10001).empty());
+  EXPECT_TRUE(pnlEngine->getPnlUnRealOfStgInstId(1, 3).empty());
+
+  //! 行情和仓位变化的时候只累加差值
+  onTickers(posInfoOfBTC, 90);
+  EXPECT_TRUE(
+      DEC::EQ(pnlEngine->getPnlUnRealOfAcctId(10000).at("USDT"), -15));
+  auto posInfoOfClose = MakePosInfoForTest(2, "ETH-USDT", 0, 0, 2);
+  posInfoOfClose->stgId_ = 1;
+  posInfoOfClose->stgInstId_ = 2;
+  pnlEngine->onPosChg(
+      std::make_shared<PosChgInfo>(PosChgInfo{posInfoOfClose}));
+  const auto pnlUnReal = pnlEngine->getPnlUnRealOfStgInstId(1, 2);
+  EXPECT_TRUE(DEC::EQ(pnlUnReal.at("USDT"), -20));
+  EXPECT_TRUE(DEC::EQ(pnlUnReal.at("BTC"), 0.1));
+}
+
 int main(int argc, char** argv) {
   testing::AddGlobalTestEnvironment(new global_event);
   testing::InitGoogleTest(&argc, argv);
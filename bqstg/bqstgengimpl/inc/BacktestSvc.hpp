@@ -0,0 +1,204 @@
+/*!
+ * \file BacktestSvc.hpp
+ * \project BetterQuant
+ *
+ * \author byrnexu
+ * \date 2023/03/28
+ *
+ * \brief
+ */
+
+#pragma once
+
+#include "def/BQConst.hpp"
+#include "def/BQDef.hpp"
+#include "def/Const.hpp"
+#include "def/Def.hpp"
+#include "util/Pch.hpp"
+
+namespace bq {
+
+template <typename Task>
+struct AsyncTask;
+
+struct SHMIPCTask;
+using SHMIPCTaskSPtr = std::shared_ptr<SHMIPCTask>;
+
+using SHMIPCAsyncTask = AsyncTask<SHMIPCTaskSPtr>;
+using SHMIPCAsyncTaskSPtr = std::shared_ptr<SHMIPCAsyncTask>;
+
+struct OrderInfo;
+using OrderInfoSPtr = std::shared_ptr<OrderInfo>;
+
+struct SimedTDInfo;
+using SimedTDInfoSPtr = std::shared_ptr<SimedTDInfo>;
+
+class SimedMatchingEngine;
+using SimedMatchingEngineSPtr = std::shared_ptr<SimedMatchingEngine>;
+
+enum class ExecAtStartup;
+
+}  // namespace bq
+
+namespace bq::stg {
+
+struct TaskOfFixedTime;
+using TaskOfFixedTimeSPtr = std::shared_ptr<TaskOfFixedTime>;
+
+//!
+//! 回测事件，ts相同的事件按照no也就是入队的先后顺序处理，保证每次回测的处理顺序
+//! 完全一致
+//!
+struct BacktestEvent {
+  BacktestEvent(std::uint64_t ts, std::uint64_t no,
+                std::function<void()>&& callback)
+      : ts_(ts), no_(no), callback_(std::move(callback)) {}
+  std::uint64_t ts_{0};
+  std::uint64_t no_{0};
+  std::function<void()> callback_;
+};
+using BacktestEventSPtr = std::shared_ptr<BacktestEvent>;
+
+struct BacktestEventComp {
+  bool operator()(const BacktestEventSPtr& lhs,
+                  const BacktestEventSPtr& rhs) const {
+    if (lhs->ts_ != rhs->ts_) {
+      return lhs->ts_ > rhs->ts_;
+    }
+    return lhs->no_ > rhs->no_;
+  }
+};
+
+using BacktestEventQueue =
+    std::priority_queue<BacktestEventSPtr, std::vector<BacktestEventSPtr>,
+                        BacktestEventComp>;
+
+struct TimerOfBacktest {
+  TimerOfBacktest(StgInstId stgInstId, const std::string& timerName,
+                  std::uint64_t usInterval, std::uint64_t maxExecTimes)
+      : stgInstId_(stgInstId),
+        timerName_(timerName),
+        usInterval_(usInterval),
+        maxExecTimes_(maxExecTimes) {}
+  StgInstId stgInstId_;
+  std::string timerName_;
+  std::uint64_t usInterval_{0};
+  std::uint64_t maxExecTimes_{UINT64_MAX};
+  std::uint64_t execTimes_{0};
+  bool uninstalled_{false};
+};
+using TimerOfBacktestSPtr = std::shared_ptr<TimerOfBacktest>;
+
+class StgEngImpl;
+
+class BacktestSvc;
+using BacktestSvcSPtr = std::shared_ptr<BacktestSvc>;
+
+//!
+//! 回测模式下策略在进程内运行，不连接行情服务和交易服务：
+//! 历史行情、模拟的委托回报和成交回报、定时器都作为事件放入同一个按时间排序的
+//! 队列，由虚拟时钟驱动，在同一个线程中依次交给StgInstTaskHandler处理，不做任
+//! 何等待，所以回测速度只取决于cpu，而且多次回测的结果完全一致。
+//!
+//! 注意：策略回调中调用的下单、撤单、订阅、定时器等接口都会重入本模块，所以只能
+//! 在回调线程中调用。
+//!
+class BacktestSvc {
+ public:
+  BacktestSvc(const BacktestSvc&) = delete;
+  BacktestSvc& operator=(const BacktestSvc&) = delete;
+  BacktestSvc(const BacktestSvc&&) = delete;
+  BacktestSvc& operator=(const BacktestSvc&&) = delete;
+
+  explicit BacktestSvc(StgEngImpl* stgEng);
+
+ public:
+  int init();
+  int run();
+
+ public:
+  std::uint64_t now() const { return now_; }
+  OrderId getNextOrderId() { return ++noOfOrderId_; }
+
+ public:
+  int sub(StgInstId subscriber, const std::string& topic);
+  int unSub(StgInstId subscriber, const std::string& topic);
+
+ public:
+  void order(const OrderInfoSPtr& orderInfo);
+  void cancelOrder(const OrderInfoSPtr& orderInfo);
+
+ public:
+  void installStgInstTimer(const TaskOfFixedTimeSPtr& taskOfFixedTime);
+  void installStgInstTimer(StgInstId stgInstId, const std::string& timerName,
+                           ExecAtStartup execAtStartUp,
+                           std::uint32_t milliSecInterval,
+                           std::uint64_t maxExecTimes);
+  void uninstallStgInstTimer(const std::string& timerName);
+
+ private:
+  void push(std::uint64_t ts, std::function<void()>&& callback);
+  void handle(const SHMIPCAsyncTaskSPtr& asyncTask);
+
+  int loadHisMD(std::uint64_t tsBegin, std::uint64_t tsEnd);
+  int loadHisMD(const std::string& topic, std::uint64_t tsBegin,
+                std::uint64_t tsEnd);
+  void dispatchHisMD(const std::string& topic, const std::string& md);
+
+  void execTimer(const TimerOfBacktestSPtr& timer);
+  void execTaskOfFixedTime();
+
+ private:
+  void simOnOrder(const OrderInfoSPtr& ordReq,
+                  const SimedTDInfoSPtr& simedTDInfo);
+  void simOnCancelOrder(const OrderInfoSPtr& ordReq);
+  void sendOrderRet(const OrderInfoSPtr& ordRet, MsgId msgId);
+
+ private:
+  int subMDOfMatchingEngine(const OrderInfoSPtr& ordReq);
+  void onSimedOrderRet(const OrderInfoSPtr& orderInfo, MsgId msgId,
+                       LiquidityDirection liquidityDirection);
+
+ private:
+  StgEngImpl* stgEng_{nullptr};
+
+  std::string storageRootPath_;
+  std::uint64_t tsBegin_{0};
+  std::uint64_t tsEnd_{0};
+  std::uint64_t usOfLoadHisMDEachTime_{3600 * 1000000ULL};
+  std::uint32_t maxNumOfHisMDLoadedEachTime_{1000000};
+
+  std::uint64_t usLatencyOfOrder_{0};
+  std::uint64_t usLatencyOfCancelOrder_{0};
+  Decimal feeRatioOfMaker_{0.002};
+  Decimal feeRatioOfTaker_{0.003};
+
+  //! 开启之后根据回放的Books和Trades撮合，不再使用extData中的模拟成交信息
+  SimedMatchingEngineSPtr simedMatchingEngine_{nullptr};
+
+  //! 虚拟时钟
+  std::uint64_t now_{0};
+  //! 历史行情已经加载到了这个时间点（不含）
+  std::uint64_t tsOfHisMDLoaded_{0};
+
+  BacktestEventQueue eventQueue_;
+  std::uint64_t noOfEvent_{0};
+  std::uint64_t numOfEventHandled_{0};
+
+  //! 用std::map保证加载和分发行情的顺序固定
+  std::map<std::string, std::set<StgInstId>> topic2SubscriberGroup_;
+
+  std::vector<TimerOfBacktestSPtr> timerGroup_;
+  std::vector<TaskOfFixedTimeSPtr> taskOfFixedTimeGroup_;
+  bool isTaskOfFixedTimeChecking_{false};
+
+  //! 模拟交易所中未完结的订单
+  std::map<OrderId, OrderInfoSPtr> orderId2OrderInfo_;
+
+  OrderId noOfOrderId_{0};
+  std::uint64_t noOfExchOrderId_{0};
+  std::uint64_t noOfTradeId_{0};
+  std::uint64_t noUsedToCalcPos_{0};
+};
+
+}  // namespace bq::stg
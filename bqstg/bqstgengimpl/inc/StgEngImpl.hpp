@@ -10,6 +10,7 @@
 
 #pragma once
 
+#include "SHMIPCConst.hpp"
 #include "SHMIPCMsgId.hpp"
 #include "StgEngDef.hpp"
 #include "def/BQConstIF.hpp"
@@ -73,6 +74,9 @@ using AsyncTaskSPtr = std::shared_ptr<AsyncTask<Task>>;
 class SubMgr;
 using SubMgrSPtr = std::shared_ptr<SubMgr>;
 
+class BooksRebuilder;
+using BooksRebuilderSPtr = std::shared_ptr<BooksRebuilder>;
+
 class TopicMgr;
 using TopicMgrSPtr = std::shared_ptr<TopicMgr>;
 
@@ -134,6 +138,9 @@ using DynCandleSvcSPtr = std::shared_ptr<DynCandleSvc>;
 class SysInstructionSvc;
 using SysInstructionSvcSPtr = std::shared_ptr<SysInstructionSvc>;
 
+class BacktestSvc;
+using BacktestSvcSPtr = std::shared_ptr<BacktestSvc>;
+
 class StgEngImpl;
 using StgEngImplSPtr = std::shared_ptr<StgEngImpl>;
 
@@ -188,6 +195,8 @@ class StgEngImpl : public SvcBase {
 
  private:
   int doRun();
+  int doRunOfBacktest();
+  int afterRun() final;
 
  private:
   void sendStgStartSignal();
@@ -344,6 +353,10 @@ class StgEngImpl : public SvcBase {
 
   SHMCliSPtr getSHMCliOfWebSrv() const { return shmCliOfWebSrv_; }
 
+  //! 回测模式下不连接行情服务、交易服务、风控和web服务
+  bool isBacktestMode() const { return backtestSvc_ != nullptr; }
+  BacktestSvcSPtr getBacktestSvc() const { return backtestSvc_; }
+
  private:
   void resetBarrierOfStgStartSignal() {
     barrierOfStgStartSignal_ = std::make_shared<std::promise<void>>();
@@ -415,6 +428,7 @@ class StgEngImpl : public SvcBase {
   YAML::Node config_;
 
   StgId stgId_{1};
+  std::uint32_t maxNumOfSHMChunkHeld_{DEFAULT_MAX_NUM_OF_CHUNK_HELD};
   std::string appName_;
 
   std::string rootDirOfStgPrivateData_;
@@ -443,12 +457,15 @@ class StgEngImpl : public SvcBase {
   StgOrdMgrSPtr ordMgr_{nullptr};
   StgPosMgrSPtr posMgr_{nullptr};
   SubMgrSPtr subMgr_{nullptr};
+  BooksRebuilderSPtr booksRebuilder_{nullptr};
   TopicMgrSPtr topicMgr_{nullptr};
 
   SHMCliSPtr shmCliOfTDSrv_{nullptr};
   SHMCliSPtr shmCliOfRiskMgr_{nullptr};
   SHMCliSPtr shmCliOfWebSrv_{nullptr};
 
+  BacktestSvcSPtr backtestSvc_{nullptr};
+
   StgInstTaskHandlerImplSPtr stgInstTaskHandler_{nullptr};
   TaskDispatcherSPtr<SHMIPCTaskSPtr, BlockType::Block> stgInstTaskDispatcher_{
       nullptr};
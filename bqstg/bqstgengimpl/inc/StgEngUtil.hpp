@@ -39,4 +39,8 @@ std::tuple<int, StgInstId> GetStgInstId(const CommonIPCData* commonIPCData);
 
 int InitPosSide(OrderInfoSPtr& orderInfo);
 
+//! ts为utc时间，判断定时任务在ts这一秒是否需要触发
+bool IsTimeToExecTaskOfFixedTime(const TaskOfFixedTimeSPtr& taskOfFixedTime,
+                                 const boost::posix_time::ptime& ts);
+
 }  // namespace bq::stg
@@ -0,0 +1,563 @@
+/*!
+ * \file BacktestSvc.cpp
+ * \project BetterQuant
+ *
+ * \author byrnexu
+ * \date 2023/03/28
+ *
+ * \brief
+ */
+
+#include "BacktestSvc.hpp"
+
+#include "SHMHeader.hpp"
+#include "SHMIPCTask.hpp"
+#include "StgEngDef.hpp"
+#include "StgEngImpl.hpp"
+#include "StgEngUtil.hpp"
+#include "StgInstTaskHandlerImpl.hpp"
+#include "db/TBLMonitorOfStgInstInfo.hpp"
+#include "db/TBLMonitorOfSymbolInfo.hpp"
+#include "db/TBLSymbolInfo.hpp"
+#include "def/DataStruOfMD.hpp"
+#include "def/DataStruOfTD.hpp"
+#include "def/MarketDataIF.hpp"
+#include "def/SimedTDInfo.hpp"
+#include "def/StatusCode.hpp"
+#include "util/BQMDHis.hpp"
+#include "util/BQUtil.hpp"
+#include "util/Datetime.hpp"
+#include "util/Decimal.hpp"
+#include "util/FeeUtil.hpp"
+#include "util/MarketDataCond.hpp"
+#include "util/SimedMatchingEngine.hpp"
+#include "util/StdExt.hpp"
+#include "util/String.hpp"
+#include "util/TaskDispatcher.hpp"
+
+namespace bq::stg {
+
+BacktestSvc::BacktestSvc(StgEngImpl* stgEng) : stgEng_(stgEng) {}
+
+int BacktestSvc::init() {
+  const auto config = stgEng_->getConfig()["backtest"];
+
+  storageRootPath_ = config["storageRootPath"].as<std::string>("data");
+
+  //! 回测的起止时间，格式为 20230120T000000，utc时间
+  const auto dateTimeStart = config["dateTimeStart"].as<std::string>("");
+  const auto dateTimeEnd = config["dateTimeEnd"].as<std::string>("");
+  int statusCode = 0;
+  std::tie(statusCode, tsBegin_) = ConvertISODatetimeToTs(dateTimeStart);
+  if (statusCode != 0) {
+    stgEng_->logError("Init backtest failed because of invalid start time {}.",
+                      {dateTimeStart}, stgEng_->getDftStgInstInfo());
+    return SCODE_STG_BACKTEST_INVALID_DATETIME;
+  }
+  std::tie(statusCode, tsEnd_) = ConvertISODatetimeToTs(dateTimeEnd);
+  if (statusCode != 0 || tsEnd_ <= tsBegin_) {
+    stgEng_->logError("Init backtest failed because of invalid end time {}.",
+                      {dateTimeEnd}, stgEng_->getDftStgInstInfo());
+    return SCODE_STG_BACKTEST_INVALID_DATETIME;
+  }
+
+  //! 历史行情按时间窗口分批加载，避免一次性加载全部行情占用过多内存
+  usOfLoadHisMDEachTime_ =
+      config["secOfLoadHisMDEachTime"].as<std::uint64_t>(3600) * 1000000;
+  maxNumOfHisMDLoadedEachTime_ =
+      config["maxNumOfHisMDLoadedEachTime"].as<std::uint32_t>(1000000);
+
+  usLatencyOfOrder_ = config["microSecLatencyOfOrder"].as<std::uint64_t>(0);
+  usLatencyOfCancelOrder_ =
+      config["microSecLatencyOfCancelOrder"].as<std::uint64_t>(0);
+  feeRatioOfMaker_ = config["feeRatioOfMaker"].as<Decimal>(0.002);
+  feeRatioOfTaker_ = config["feeRatioOfTaker"].as<Decimal>(0.003);
+
+  //! 报单和撤单的延时已经由虚拟时钟模拟，撮合引擎中不再叠加延时
+  if (config["matchingEngine"]["enabled"].as<bool>(false) == true) {
+    simedMatchingEngine_ = std::make_shared<SimedMatchingEngine>(
+        SimedMatchingEngineParam(),
+        [this](const auto& orderInfo, auto msgId, auto liqDirection) {
+          onSimedOrderRet(orderInfo, msgId, liqDirection);
+        });
+  }
+
+  stgEng_->logInfo("Init backtest between {} and {} success. [path = {}]",
+                   {dateTimeStart, dateTimeEnd, storageRootPath_},
+                   stgEng_->getDftStgInstInfo());
+  return 0;
+}
+
+int BacktestSvc::run() {
+  const auto tsStartOfRun = GetTotalUSSince1970();
+
+  now_ = tsBegin_;
+  tsOfHisMDLoaded_ = tsBegin_;
+
+  //! 策略启动信号和策略实例启动信号直接处理，策略在回调中完成订阅和定时器的安装
+  handle(MakeStgSignal(MSG_ID_ON_STG_START, 1));
+  const auto stgInstIdGroup =
+      stgEng_->getTBLMonitorOfStgInstInfo()->getStgInstIdGroup();
+  for (const auto stgInstId : stgInstIdGroup) {
+    handle(MakeStgSignal(MSG_ID_ON_STG_INST_START, stgInstId));
+  }
+
+  while (true) {
+    //! 队列中的事件都不早于已加载行情的时间点时，先加载下一个时间窗口的行情，
+    //! 保证事件按时间顺序处理
+    if (eventQueue_.empty() || eventQueue_.top()->ts_ >= tsOfHisMDLoaded_) {
+      if (tsOfHisMDLoaded_ >= tsEnd_) break;
+      const auto tsBegin = tsOfHisMDLoaded_;
+      const auto tsEnd = std::min(tsBegin + usOfLoadHisMDEachTime_, tsEnd_);
+      if (const auto ret = loadHisMD(tsBegin, tsEnd); ret != 0) {
+        return ret;
+      }
+      tsOfHisMDLoaded_ = tsEnd;
+      continue;
+    }
+
+    const auto event = eventQueue_.top();
+    eventQueue_.pop();
+    now_ = event->ts_;
+    event->callback_();
+    ++numOfEventHandled_;
+  }
+
+  now_ = tsEnd_;
+  for (const auto stgInstId : stgInstIdGroup) {
+    handle(MakeStgSignal(MSG_ID_ON_STG_INST_STOP, stgInstId));
+  }
+  handle(MakeStgSignal(MSG_ID_ON_STG_STOP, 1));
+
+  const auto usTimeUsed = GetTotalUSSince1970() - tsStartOfRun;
+  stgEng_->logInfo(
+      "Backtest finished. [num of event handled = {}, time used = {} ms]",
+      {std::to_string(numOfEventHandled_), std::to_string(usTimeUsed / 1000)},
+      stgEng_->getDftStgInstInfo());
+  return 0;
+}
+
+void BacktestSvc::push(std::uint64_t ts, std::function<void()>&& callback) {
+  //! 虚拟时钟不能倒退
+  ts = std::max(ts, now_);
+  eventQueue_.emplace(
+      std::make_shared<BacktestEvent>(ts, ++noOfEvent_, std::move(callback)));
+}
+
+void BacktestSvc::handle(const SHMIPCAsyncTaskSPtr& asyncTask) {
+  stgEng_->getStgInstTaskHandler()->handleAsyncTask(asyncTask);
+}
+
+int BacktestSvc::loadHisMD(std::uint64_t tsBegin, std::uint64_t tsEnd) {
+  //! 曾经订阅过的topic都会继续加载，这样取消订阅之后再订阅不会重复加载行情
+  for (const auto& rec : topic2SubscriberGroup_) {
+    if (const auto ret = loadHisMD(rec.first, tsBegin, tsEnd); ret != 0) {
+      return ret;
+    }
+  }
+  return 0;
+}
+
+int BacktestSvc::loadHisMD(const std::string& topic, std::uint64_t tsBegin,
+                           std::uint64_t tsEnd) {
+  const auto [statusCode, ts2HisMDGroup] = md::MDHis::LoadHisMDBetweenTs(
+      storageRootPath_, topic, tsBegin, tsEnd, md::IndexType::ByExchTs,
+      maxNumOfHisMDLoadedEachTime_);
+  if (statusCode != 0) {
+    stgEng_->logError(
+        "Load his market data of {} between {} and {} failed. [{} - {}]",
+        {topic, std::to_string(tsBegin), std::to_string(tsEnd),
+         std::to_string(statusCode), GetStatusMsg(statusCode)},
+        stgEng_->getDftStgInstInfo());
+    return SCODE_STG_BACKTEST_LOAD_HIS_MD_FAILED;
+  }
+
+  for (auto& rec : *ts2HisMDGroup) {
+    push(rec.first, [this, topic, md = std::move(rec.second)]() {
+      dispatchHisMD(topic, md);
+    });
+  }
+  return 0;
+}
+
+void BacktestSvc::dispatchHisMD(const std::string& topic,
+                                const std::string& md) {
+  const auto iter = topic2SubscriberGroup_.find(topic);
+  if (iter == std::end(topic2SubscriberGroup_)) {
+    return;
+  }
+
+  const auto [statusCode, marketDataCond] = GetMarketDataCondFromTopic(topic);
+  if (statusCode != 0) return;
+
+  //! 没有订阅者的Books和Trades也要交给撮合引擎
+  const auto isMDOfMatchingEngine =
+      simedMatchingEngine_ != nullptr &&
+      (marketDataCond->mdType_ == MDType::Books ||
+       marketDataCond->mdType_ == MDType::Trades);
+  if (iter->second.empty() && !isMDOfMatchingEngine) {
+    return;
+  }
+
+  SHMIPCTaskSPtr shmIPCTask;
+  switch (marketDataCond->mdType_) {
+    case MDType::Trades: {
+      const auto [ret, trades] = MakeTrades(md);
+      if (ret != 0) return;
+      shmIPCTask = std::make_shared<SHMIPCTask>(&trades, sizeof(Trades));
+    } break;
+    case MDType::Books: {
+      const auto [ret, books] = MakeBooks(md);
+      if (ret != 0) return;
+      shmIPCTask = std::make_shared<SHMIPCTask>(&books, sizeof(Books));
+    } break;
+    case MDType::Candle: {
+      const auto [ret, candle] = MakeCandle(md);
+      if (ret != 0) return;
+      shmIPCTask = std::make_shared<SHMIPCTask>(&candle, sizeof(Candle));
+    } break;
+    case MDType::Tickers: {
+      const auto [ret, tickers] = MakeTickers(md);
+      if (ret != 0) return;
+      shmIPCTask = std::make_shared<SHMIPCTask>(&tickers, sizeof(Tickers));
+    } break;
+    default:
+      return;
+  }
+
+  //! 先撮合再分发，策略收到行情时看到的是撮合之后的委托状态
+  if (isMDOfMatchingEngine) {
+    if (marketDataCond->mdType_ == MDType::Books) {
+      simedMatchingEngine_->onBooks(
+          BooksCSPtr(shmIPCTask, static_cast<const Books*>(shmIPCTask->data_)),
+          now_);
+    } else {
+      simedMatchingEngine_->onTrades(
+          *static_cast<const Trades*>(shmIPCTask->data_), now_);
+    }
+  }
+
+  //! 复制一份订阅者，策略在回调中取消订阅不影响本次分发
+  const auto subscriberGroup = iter->second;
+  for (const auto stgInstId : subscriberGroup) {
+    handle(std::make_shared<SHMIPCAsyncTask>(shmIPCTask, stgInstId));
+  }
+}
+
+int BacktestSvc::sub(StgInstId subscriber, const std::string& topic) {
+  const auto [statusCode, marketDataCond] = GetMarketDataCondFromTopic(topic);
+  if (statusCode != 0) {
+    return statusCode;
+  }
+
+  //! 动态k线和算法交易引擎一样依赖实时线程，回测模式下不支持
+  if (marketDataCond->mdType_ != MDType::Trades &&
+      marketDataCond->mdType_ != MDType::Books &&
+      marketDataCond->mdType_ != MDType::Candle &&
+      marketDataCond->mdType_ != MDType::Tickers) {
+    stgEng_->logWarn("Sub {} failed because it's not supported in backtest.",
+                     {topic}, stgEng_->getDftStgInstInfo());
+    return SCODE_STG_BACKTEST_UNSUPPORTED_TOPIC;
+  }
+
+  const auto isNewTopic = topic2SubscriberGroup_.count(topic) == 0;
+  topic2SubscriberGroup_[topic].emplace(subscriber);
+
+  //! 回测过程中新订阅的topic，补充加载当前时间窗口中剩余部分的行情
+  if (isNewTopic && tsOfHisMDLoaded_ > now_) {
+    return loadHisMD(topic, now_, tsOfHisMDLoaded_);
+  }
+  return 0;
+}
+
+int BacktestSvc::unSub(StgInstId subscriber, const std::string& topic) {
+  const auto iter = topic2SubscriberGroup_.find(topic);
+  if (iter != std::end(topic2SubscriberGroup_)) {
+    iter->second.erase(subscriber);
+  }
+  return 0;
+}
+
+void BacktestSvc::order(const OrderInfoSPtr& orderInfo) {
+  //! 模拟成交信息解析出来之后，克隆的时候不再带上extData
+  auto ordReq = std::make_shared<OrderInfo>(*orderInfo);
+  ordReq->extDataLen_ = 0;
+
+  if (simedMatchingEngine_ != nullptr) {
+    const auto [statusCode, symbolInfo] =
+        stgEng_->getTBLMonitorOfSymbolInfo()->getRecSymbolInfoBySymbolCode(
+            GetMarketName(ordReq->marketCode_), ordReq->symbolCode_);
+    if (statusCode != SCODE_SUCCESS) {
+      ordReq->orderStatus_ = OrderStatus::Failed;
+      ordReq->statusCode_ = statusCode;
+      push(now_ + usLatencyOfOrder_,
+           [this, ordReq]() { sendOrderRet(ordReq, MSG_ID_ON_ORDER_RET); });
+      return;
+    }
+
+    ordReq->fee_ = 0;
+    const auto feeCurrency = getFeeCurrency(ordReq, symbolInfo->baseCurrency,
+                                            symbolInfo->quoteCurrency);
+    strncpy(ordReq->feeCurrency_, feeCurrency.c_str(),
+            sizeof(ordReq->feeCurrency_) - 1);
+
+    subMDOfMatchingEngine(ordReq);
+    push(now_ + usLatencyOfOrder_,
+         [this, ordReq]() { simedMatchingEngine_->order(ordReq, now_); });
+    return;
+  }
+
+  SimedTDInfoSPtr simedTDInfo;
+  if (orderInfo->extDataLen_ != 0 && orderInfo->extData_[0] != '\0') {
+    int statusCode = 0;
+    std::tie(statusCode, simedTDInfo) = MakeSimedTDInfo(orderInfo->extData_);
+    if (statusCode != 0) {
+      ordReq->orderStatus_ = OrderStatus::Failed;
+      ordReq->statusCode_ = statusCode;
+      push(now_ + usLatencyOfOrder_,
+           [this, ordReq]() { sendOrderRet(ordReq, MSG_ID_ON_ORDER_RET); });
+      return;
+    }
+  } else {
+    //! 没有指定模拟成交信息的时候按委托价全部成交
+    simedTDInfo = std::make_shared<SimedTDInfo>(
+        OrderStatus::Filled,
+        std::vector<std::tuple<Decimal, Decimal, LiquidityDirection>>{
+            {0, 1, LiquidityDirection::Taker}});
+  }
+
+  push(now_ + usLatencyOfOrder_,
+       [this, ordReq, simedTDInfo]() { simOnOrder(ordReq, simedTDInfo); });
+}
+
+void BacktestSvc::cancelOrder(const OrderInfoSPtr& orderInfo) {
+  auto ordReq = std::make_shared<OrderInfo>(*orderInfo);
+  ordReq->extDataLen_ = 0;
+  if (simedMatchingEngine_ != nullptr) {
+    push(now_ + usLatencyOfCancelOrder_, [this, ordReq]() {
+      simedMatchingEngine_->cancelOrder(ordReq, now_);
+    });
+    return;
+  }
+  push(now_ + usLatencyOfCancelOrder_,
+       [this, ordReq]() { simOnCancelOrder(ordReq); });
+}
+
+void BacktestSvc::simOnOrder(const OrderInfoSPtr& ordReq,
+                             const SimedTDInfoSPtr& simedTDInfo) {
+  if (simedTDInfo->orderStatus_ == OrderStatus::Failed) {
+    ordReq->orderStatus_ = OrderStatus::Failed;
+    ordReq->statusCode_ = SCODE_TD_SVC_SIMED_ORDER_STATSU_FAILED;
+    sendOrderRet(ordReq, MSG_ID_ON_ORDER_RET);
+    return;
+  }
+
+  const auto [statusCode, symbolInfo] =
+      stgEng_->getTBLMonitorOfSymbolInfo()->getRecSymbolInfoBySymbolCode(
+          GetMarketName(ordReq->marketCode_), ordReq->symbolCode_);
+  if (statusCode != SCODE_SUCCESS) {
+    ordReq->orderStatus_ = OrderStatus::Failed;
+    ordReq->statusCode_ = statusCode;
+    sendOrderRet(ordReq, MSG_ID_ON_ORDER_RET);
+    return;
+  }
+
+  ordReq->orderStatus_ = OrderStatus::ConfirmedByExch;
+  ordReq->statusCode_ = SCODE_SUCCESS;
+  strncpy(ordReq->exchOrderId_, std::to_string(++noOfExchOrderId_).c_str(),
+          sizeof(ordReq->exchOrderId_) - 1);
+  ordReq->dealSize_ = 0;
+  ordReq->avgDealPrice_ = 0;
+  ordReq->lastTradeId_[0] = '\0';
+  ordReq->lastDealPrice_ = 0;
+  ordReq->lastDealSize_ = 0;
+  ordReq->lastDealTime_ = now_;
+
+  ordReq->fee_ = 0;
+  const auto feeCurrency = getFeeCurrency(ordReq, symbolInfo->baseCurrency,
+                                          symbolInfo->quoteCurrency);
+  strncpy(ordReq->feeCurrency_, feeCurrency.c_str(),
+          sizeof(ordReq->feeCurrency_) - 1);
+  sendOrderRet(ordReq, MSG_ID_ON_ORDER_RET);
+
+  if (simedTDInfo->orderStatus_ == OrderStatus::ConfirmedByExch) {
+    orderId2OrderInfo_.emplace(ordReq->orderId_, ordReq);
+    return;
+  }
+
+  const auto& transDetailGroup = simedTDInfo->transDetailGroup_;
+  for (std::size_t i = 0; i < transDetailGroup.size(); ++i) {
+    //! 最后一条模拟成交，如果模拟的是全部成交，委托状态修改为 Filled
+    const auto isLast = (i == transDetailGroup.size() - 1);
+    ordReq->orderStatus_ =
+        isLast && simedTDInfo->orderStatus_ == OrderStatus::Filled
+            ? OrderStatus::Filled
+            : OrderStatus::PartialFilled;
+
+    UpdateOrderInfoByTransDetail(ordReq, transDetailGroup[i],
+                                 std::to_string(++noOfTradeId_), now_);
+
+    const auto feeRatio =
+        transDetailGroup[i]->liquidityDirection_ == LiquidityDirection::Maker
+            ? feeRatioOfMaker_
+            : feeRatioOfTaker_;
+    ordReq->fee_ = calcFee(ordReq, feeRatio, symbolInfo->parValue);
+    sendOrderRet(ordReq, MSG_ID_ON_ORDER_RET);
+  }
+
+  if (ordReq->orderStatus_ != OrderStatus::Filled) {
+    orderId2OrderInfo_.emplace(ordReq->orderId_, ordReq);
+  }
+}
+
+void BacktestSvc::simOnCancelOrder(const OrderInfoSPtr& ordReq) {
+  //! 下单后马上撤单的情况下，订单可能还没有到达模拟交易所，也可能已经全部成交
+  const auto iter = orderId2OrderInfo_.find(ordReq->orderId_);
+  if (iter == std::end(orderId2OrderInfo_)) {
+    ordReq->statusCode_ = SCODE_STG_BACKTEST_ORDER_OF_CANCEL_NOT_EXISTS;
+    sendOrderRet(ordReq, MSG_ID_ON_CANCEL_ORDER_RET);
+    return;
+  }
+
+  const auto orderInfo = iter->second;
+  orderId2OrderInfo_.erase(iter);
+  orderInfo->orderStatus_ = DEC::ZERO(orderInfo->dealSize_)
+                                ? OrderStatus::Canceled
+                                : OrderStatus::PartialFilledCanceled;
+  sendOrderRet(orderInfo, MSG_ID_ON_ORDER_RET);
+}
+
+void BacktestSvc::sendOrderRet(const OrderInfoSPtr& ordRet, MsgId msgId) {
+  ordRet->noUsedToCalcPos_ = ++noUsedToCalcPos_;
+
+  //! 在这里生成快照，后续对ordRet的修改不影响已经发出的回报
+  auto shmIPCTask = std::make_shared<SHMIPCTask>(ordRet.get(), ordRet->size());
+  static_cast<SHMHeader*>(shmIPCTask->data_)->msgId_ = msgId;
+
+  const auto stgInstId = ordRet->stgInstId_;
+  push(now_, [this, shmIPCTask, stgInstId]() {
+    handle(std::make_shared<SHMIPCAsyncTask>(shmIPCTask, stgInstId));
+  });
+}
+
+int BacktestSvc::subMDOfMatchingEngine(const OrderInfoSPtr& ordReq) {
+  const auto marketCode = GetMarketName(ordReq->marketCode_);
+  const auto symbolType =
+      std::string(magic_enum::enum_name(ordReq->symbolType_));
+  const auto [topicOfBooks, topicHashOfBooks] = MakeTopicInfo(
+      marketCode, symbolType, ordReq->symbolCode_, MDType::Books,
+      Int2StrInCompileTime<MAX_DEPTH_LEVEL>::type::value);
+  const auto [topicOfTrades, topicHashOfTrades] = MakeTopicInfo(
+      marketCode, symbolType, ordReq->symbolCode_, MDType::Trades);
+
+  //! 没有订阅者的topic也会加载，由撮合引擎使用
+  for (const auto& topic : {topicOfBooks, topicOfTrades}) {
+    if (topic2SubscriberGroup_.count(topic) != 0) continue;
+    topic2SubscriberGroup_[topic];
+    if (tsOfHisMDLoaded_ > now_) {
+      if (const auto ret = loadHisMD(topic, now_, tsOfHisMDLoaded_); ret != 0) {
+        return ret;
+      }
+    }
+  }
+  return 0;
+}
+
+void BacktestSvc::onSimedOrderRet(const OrderInfoSPtr& orderInfo, MsgId msgId,
+                                  LiquidityDirection liquidityDirection) {
+  //! 成交回报，按本笔成交是maker还是taker累加手续费
+  if (liquidityDirection != LiquidityDirection::Others) {
+    const auto [statusCode, symbolInfo] =
+        stgEng_->getTBLMonitorOfSymbolInfo()->getRecSymbolInfoBySymbolCode(
+            GetMarketName(orderInfo->marketCode_), orderInfo->symbolCode_);
+    const auto feeRatio = liquidityDirection == LiquidityDirection::Maker
+                              ? feeRatioOfMaker_
+                              : feeRatioOfTaker_;
+    auto lastDeal = std::make_shared<OrderInfo>(*orderInfo);
+    lastDeal->dealSize_ = orderInfo->lastDealSize_;
+    lastDeal->avgDealPrice_ = orderInfo->lastDealPrice_;
+    orderInfo->fee_ +=
+        calcFee(lastDeal, feeRatio, symbolInfo ? symbolInfo->parValue : 0);
+  }
+  sendOrderRet(orderInfo, msgId);
+}
+
+void BacktestSvc::installStgInstTimer(
+    const TaskOfFixedTimeSPtr& taskOfFixedTime) {
+  taskOfFixedTimeGroup_.emplace_back(taskOfFixedTime);
+  if (isTaskOfFixedTimeChecking_) return;
+
+  //! 从下一个整秒开始每秒检测一次
+  isTaskOfFixedTimeChecking_ = true;
+  const auto oneSec = 1000000ULL;
+  push((now_ + oneSec - 1) / oneSec * oneSec,
+       [this]() { execTaskOfFixedTime(); });
+}
+
+void BacktestSvc::installStgInstTimer(StgInstId stgInstId,
+                                      const std::string& timerName,
+                                      ExecAtStartup execAtStartUp,
+                                      std::uint32_t milliSecInterval,
+                                      std::uint64_t maxExecTimes) {
+  if (maxExecTimes == 0) return;
+  const auto timer = std::make_shared<TimerOfBacktest>(
+      stgInstId, timerName, milliSecInterval * 1000ULL, maxExecTimes);
+  timerGroup_.emplace_back(timer);
+
+  const auto ts = execAtStartUp == ExecAtStartup::True
+                      ? now_
+                      : now_ + timer->usInterval_;
+  push(ts, [this, timer]() { execTimer(timer); });
+}
+
+void BacktestSvc::uninstallStgInstTimer(const std::string& timerName) {
+  std::ext::erase_if(timerGroup_, [&](const auto& timer) {
+    if (timer->timerName_ == timerName) {
+      //! 已经在队列中的事件触发时直接跳过
+      timer->uninstalled_ = true;
+      return true;
+    }
+    return false;
+  });
+
+  std::ext::erase_if(taskOfFixedTimeGroup_, [&](const auto& taskOfFixedTime) {
+    return taskOfFixedTime->timerName_ == timerName;
+  });
+}
+
+void BacktestSvc::execTimer(const TimerOfBacktestSPtr& timer) {
+  if (timer->uninstalled_) return;
+
+  handle(MakeStgSignal(MSG_ID_ON_STG_INST_TIMER, timer->stgInstId_,
+                       timer->timerName_));
+
+  if (++timer->execTimes_ < timer->maxExecTimes_) {
+    //! 间隔为0的定时器也至少推进1us，避免虚拟时钟停滞
+    const auto usInterval = std::max<std::uint64_t>(timer->usInterval_, 1);
+    push(now_ + usInterval, [this, timer]() { execTimer(timer); });
+  } else {
+    std::ext::erase_if(timerGroup_,
+                       [&](const auto& rec) { return rec == timer; });
+  }
+}
+
+void BacktestSvc::execTaskOfFixedTime() {
+  const auto ts = boost::posix_time::from_time_t(now_ / 1000000);
+
+  //! 回调中可能安装或者卸载定时器，所以先复制一份
+  const auto taskOfFixedTimeGroup = taskOfFixedTimeGroup_;
+  for (const auto& task : taskOfFixedTimeGroup) {
+    if (IsTimeToExecTaskOfFixedTime(task, ts)) {
+      handle(MakeStgSignal(MSG_ID_ON_STG_INST_TIMER, task->stgInstId_,
+                           task->timerName_));
+    }
+  }
+
+  if (taskOfFixedTimeGroup_.empty()) {
+    isTaskOfFixedTimeChecking_ = false;
+    return;
+  }
+  push(now_ + 1000000, [this]() { execTaskOfFixedTime(); });
+}
+
+}  // namespace bq::stg
@@ -11,6 +11,7 @@
 #include "StgEngImpl.hpp"
 
 #include "AlgoMgr.hpp"
+#include "BacktestSvc.hpp"
 #include "CommonIPCData.hpp"
 #include "DynCandleSvc.hpp"
 #include "OrdMgr.hpp"
@@ -48,7 +49,9 @@
 #include "tdeng/TDEngConst.hpp"
 #include "tdeng/TDEngParam.hpp"
 #include "util/AcctInfoCache.hpp"
+#include "util/BooksRebuilder.hpp"
 #include "util/File.hpp"
+#include "util/LatencyTrace.hpp"
 #include "util/Literal.hpp"
 #include "util/LoggerUtil.hpp"
 #include "util/MarketDataCache.hpp"
@@ -85,6 +88,10 @@ int StgEngImpl::prepareInit() {
 
   stgId_ = getConfig()["stgId"].as<StgId>();
   appName_ = fmt::format("Stg-{}", getStgId());
+  //! 接收端零拷贝持有的chunk数量上限，为0的时候关闭零拷贝
+  maxNumOfSHMChunkHeld_ =
+      getConfig()["maxNumOfSHMChunkHeld"].as<std::uint32_t>(
+          DEFAULT_MAX_NUM_OF_CHUNK_HELD);
   rootDirOfStgPrivateData_ = fmt::format(
       "{}/{}", getConfig()["rootDirOfStgPrivateData"].as<std::string>(),
       getStgId());
@@ -98,6 +105,11 @@ int StgEngImpl::prepareInit() {
     return ret;
   }
 
+  //! 时延追踪默认关闭，开启后向进程发送SIGUSR1输出各环节的时延分布
+  if (getConfig()["enableLatencyTrace"].as<bool>(false)) {
+    LatencyTrace::get_mutable_instance().enable();
+  }
+
   if (auto ret = initDBEng(); ret != 0) {
     logError("[{}] Init stg {} failed because of init dbeng failed.",
              {appName_, std::to_string(getStgId())});
@@ -150,6 +162,16 @@ void StgEngImpl::initDftStgInstInfo() {
 }
 
 int StgEngImpl::doInit() {
+  //! 回测模式下由回测模块驱动策略，不连接行情、交易、风控和web服务
+  if (getConfig()["backtest"]["enable"].as<bool>(false)) {
+    backtestSvc_ = std::make_shared<BacktestSvc>(this);
+    if (const auto ret = backtestSvc_->init(); ret != 0) {
+      logError("Do init failed because of init backtest failed.",
+               getDftStgInstInfo());
+      return ret;
+    }
+  }
+
   //! 初始化策略实例监控模块
   initTBLMonitorOfStgInstInfo();
 
@@ -186,22 +208,26 @@ int StgEngImpl::doInit() {
   //! 动态k线生成模块
   dynCandle_ = std::make_shared<DynCandleSvc>(this);
 
-  initSubMgr();
-  initTopicMgr();
+  if (!isBacktestMode()) {
+    initSubMgr();
+    initTopicMgr();
+  }
 
   initOrdMgr();
   initPosMgr();
 
   initStgInstTaskDispatcher();
 
-  //! 初始化交易服务客户端
-  initSHMCliOfTDSrv();
+  if (!isBacktestMode()) {
+    //! 初始化交易服务客户端
+    initSHMCliOfTDSrv();
 
-  //! 初始化风控子系统客户端
-  initSHMCliOfRiskMgr();
+    //! 初始化风控子系统客户端
+    initSHMCliOfRiskMgr();
 
-  //! 初始化web服务客户端
-  initSHMCliOfWebSrv();
+    //! 初始化web服务客户端
+    initSHMCliOfWebSrv();
+  }
 
   //! 初始化动态k线生成模块
   dynCandle_->init();
@@ -322,8 +348,30 @@ void StgEngImpl::initSubMgr() {
       dynCandle_->handle(shmBuf, shmBufLen);
     }
 
+    SHMIPCTaskSPtr shmIPCTask;
+    if (shmHeader->msgId_ == MSG_ID_ON_MD_BOOKS_DELTA) {
+      //! 增量订单簿在这里重建为完整的订单簿，之后和Books一样处理
+      shmIPCTask = std::make_shared<SHMIPCTask>();
+      shmIPCTask->data_ = malloc(sizeof(Books));
+      shmIPCTask->len_ = sizeof(Books);
+      const auto ret =
+          booksRebuilder_->rebuild(static_cast<const BooksDelta*>(shmBuf),
+                                   static_cast<Books*>(shmIPCTask->data_));
+      if (ret != 0) {
+        return;
+      }
+    } else {
+      //! 算法交易引擎和所有订阅者共享同一个chunk，不再拷贝
+      shmIPCTask = MakeSHMIPCTask(shmBuf, shmBufLen);
+    }
+
+    if (shmHeader->msgId_ >= MSG_ID_ON_MD_TRADES &&
+        shmHeader->msgId_ <= MSG_ID_ON_MD_BOOKS_DELTA) {
+      shmIPCTask->tscOfDispatch_ = LatencyTrace::get_mutable_instance().stamp(
+          TraceHop::StgEngDispatch, GetMDHeader(shmBuf).tscOfPub_);
+    }
+
     //! 发送一份行情给算法交易引擎，注意这里是所有行情，在algoMgr中会过滤为订阅的行情
-    auto shmIPCTask = std::make_shared<SHMIPCTask>(shmBuf, shmBufLen);
     getAlgoMgr()->handle(shmIPCTask);
 
     //! 发送行情给所有的订阅此行情的策略实例
@@ -335,7 +383,29 @@ void StgEngImpl::initSubMgr() {
     }
   };
 
-  subMgr_ = std::make_shared<SubMgr>(appName_, onSHMDataRecv);
+  //! 配置了clientChannelOfMD的情况下，行情服务只推送本策略引擎订阅了的行情
+  const auto clientChannelOfMD =
+      getConfig()["clientChannelOfMD"].as<ClientChannel>(PUB_CHANNEL);
+  booksRebuilder_ = std::make_shared<BooksRebuilder>(
+      [this](const auto& mdHeader, auto seqNo) {
+        subMgr_->reqBooksSnapshot(mdHeader, seqNo);
+      });
+  subMgr_ =
+      std::make_shared<SubMgr>(appName_, onSHMDataRecv, clientChannelOfMD);
+  subMgr_->setMaxNumOfChunkHeld(maxNumOfSHMChunkHeld_);
+
+  //! 策略处理不过来的时候行情的处理方式，Block会阻塞行情服务，DropOldest丢弃
+  //! 最旧的行情，Conflate对同一个topic的最新值类行情只保留最后一条
+  const auto slowConsumerPolicyInStrFmt =
+      getConfig()["slowConsumerPolicyOfMD"].as<std::string>("Block");
+  const auto slowConsumerPolicy =
+      magic_enum::enum_cast<SlowConsumerPolicy>(slowConsumerPolicyInStrFmt);
+  if (slowConsumerPolicy.has_value()) {
+    subMgr_->setSlowConsumerPolicyOfMD(slowConsumerPolicy.value());
+  } else {
+    logWarn("Invalid slow consumer policy of md {}, use Block instead.",
+            {slowConsumerPolicyInStrFmt}, getDftStgInstInfo());
+  }
 }
 
 void StgEngImpl::initTopicMgr() {
@@ -391,7 +461,7 @@ void StgEngImpl::initSHMCliOfTDSrv() {
     }
 
     //! 发送一份将来自交易服务的消息至算法交易引擎
-    auto shmIPCTask = std::make_shared<SHMIPCTask>(shmBuf, shmBufLen);
+    auto shmIPCTask = MakeSHMIPCTask(shmBuf, shmBufLen);
     getAlgoMgr()->handle(shmIPCTask);
 
     //! 将来自交易服务的消息发给策略实例处理
@@ -401,6 +471,10 @@ void StgEngImpl::initSHMCliOfTDSrv() {
 
   shmCliOfTDSrv_ = std::make_shared<SHMCli>(addr, onSHMDataRecv);
   shmCliOfTDSrv_->setClientChannel(getStgId());
+  shmCliOfTDSrv_->setMaxNumOfChunkHeld(maxNumOfSHMChunkHeld_);
+  //! 对时延敏感的通道可以配置为绑核轮询，见SHMIPCRecvParam
+  shmCliOfTDSrv_->setRecvParam(
+      getConfig()["recvParamOfStgEngChannelOfTDSrv"].as<std::string>(""));
 }
 
 void StgEngImpl::initSHMCliOfRiskMgr() {
@@ -420,12 +494,13 @@ void StgEngImpl::initSHMCliOfRiskMgr() {
       stgInstId = static_cast<const OrderInfo*>(shmBuf)->stgInstId_;
     }
     auto asyncTask = std::make_shared<SHMIPCAsyncTask>(
-        std::make_shared<SHMIPCTask>(shmBuf, shmBufLen), stgInstId);
+        MakeSHMIPCTask(shmBuf, shmBufLen), stgInstId);
     stgInstTaskDispatcher_->dispatch(asyncTask);
   };
 
   shmCliOfRiskMgr_ = std::make_shared<SHMCli>(addr, onSHMDataRecv);
   shmCliOfRiskMgr_->setClientChannel(getStgId());
+  shmCliOfRiskMgr_->setMaxNumOfChunkHeld(maxNumOfSHMChunkHeld_);
 }
 
 void StgEngImpl::initSHMCliOfWebSrv() {
@@ -509,16 +584,6 @@ void StgEngImpl::initScheduleTaskBundleOfTimer() {
 }
 
 void StgEngImpl::execTaskBunndleOfTimer() {
-  //! 将时间从 YYYY-MM-DDTHH:MM:SS 格式转换为 Y2020M01D23h10m15s20
-  auto convertLocalTs = [](auto& localTsInStrFmt) {
-    localTsInStrFmt[04] = 'M';
-    localTsInStrFmt[07] = 'D';
-    localTsInStrFmt[10] = 'h';
-    localTsInStrFmt[13] = 'm';
-    localTsInStrFmt[16] = 's';
-    localTsInStrFmt = "Y" + localTsInStrFmt;
-  };
-
   //! clone taskOfFixedTimeGroup_
   std::vector<TaskOfFixedTimeSPtr> taskOfFixedTimeGroup;
   {
@@ -540,13 +605,7 @@ void StgEngImpl::execTaskBunndleOfTimer() {
   //! 从上次检测时间到现在之间的所有时间点有没有被触发的task
   for (auto ts = prevExecTaskBunndleOfTimer_; ts <= now; ts += oneSec) {
     for (const auto& task : taskOfFixedTimeGroup) {
-      //! 根据时区转换为本地时间
-      const auto localTs = ts + boost::posix_time::hours(task->timeZone_);
-      //! 本地时间转换为YYYY-MM-DDTHH:MM:SS格式
-      auto localTsInStrFmt = boost::posix_time::to_iso_extended_string(localTs);
-      convertLocalTs(localTsInStrFmt);
-
-      if (boost::contains(localTsInStrFmt, task->execTime_)) {
+      if (IsTimeToExecTaskOfFixedTime(task, ts)) {
         auto asynTask = MakeStgSignal(  //
             MSG_ID_ON_STG_INST_TIMER, task->stgInstId_, task->timerName_);
         stgInstTaskDispatcher_->dispatch(asynTask);
@@ -622,6 +681,23 @@ void StgEngImpl::initScheduleTaskBundle() {
       },
       ExecAtStartup::False, milliSecIntervalOfSyncTask));
 
+  //! 定时输出行情频道丢弃和合并的消息数量
+  scheduleTaskBundle_->emplace_back(std::make_shared<ScheduleTask>(
+      "checkSlowConsumer",
+      [this]() {
+        if (!subMgr_) return true;
+        for (const auto& [addr, shmCli] : subMgr_->getSHMCliGroup()) {
+          if (shmCli->getNumOfMsgDropped() == 0 &&
+              shmCli->getNumOfMsgConflated() == 0) {
+            continue;
+          }
+          logInfo("[{}] {}", {appName_, shmCli->getSlowConsumerStatistics()},
+                  getDftStgInstInfo());
+        }
+        return true;
+      },
+      ExecAtStartup::False, MilliSecInterval(60000)));
+
   //! 往前端定时发送health情况
   scheduleTaskBundle_->emplace_back(std::make_shared<ScheduleTask>(
       "healthCheck",
@@ -673,6 +749,10 @@ int StgEngImpl::doRun() {
     return ret;
   }
 
+  if (isBacktestMode()) {
+    return doRunOfBacktest();
+  }
+
   algoMgr_->start();
   dynCandle_->start();
 
@@ -704,6 +784,34 @@ int StgEngImpl::doRun() {
   return 0;
 }
 
+int StgEngImpl::doRunOfBacktest() {
+  //! 回测在当前线程中同步执行，所以先同步加载一次各种缓存
+  productInfoCache_->reload();
+  stgInfoCache_->reload();
+  acctInfoCache_->reload();
+  trdAcctInfoCache_->reload();
+
+  //! 策略启动信号在回测线程中处理，barrier需要有效
+  resetBarrierOfStgStartSignal();
+  if (const auto ret = backtestSvc_->run(); ret != 0) {
+    logError("[{}] Run backtest failed. [{} - {}]",
+             {appName_, std::to_string(ret), GetStatusMsg(ret)},
+             getDftStgInstInfo());
+    return ret;
+  }
+
+  return 0;
+}
+
+int StgEngImpl::afterRun() {
+  //! 回测结束后不再等待退出信号，直接走正常的退出流程
+  if (isBacktestMode()) {
+    exit(nullptr, 0);
+    return 0;
+  }
+  return SvcBase::afterRun();
+}
+
 void StgEngImpl::sendStgStartSignal() {
   const StgInstId stgInstId = 1;
   auto asynTask = MakeStgSignal(MSG_ID_ON_STG_START, stgInstId);
@@ -800,6 +908,15 @@ void StgEngImpl::handleSyncTaskGroup() {
 }
 
 void StgEngImpl::doExit(const boost::system::error_code* ec, int signalNum) {
+  if (isBacktestMode()) {
+    stgInstTaskDispatcher_->stop();
+    tblMonitorOfSymbolInfo_->stop();
+    tblMonitorOfStgInstInfo_->stop();
+    tdEngConnpool_->uninit();
+    getDBEng()->stop();
+    return;
+  }
+
   scheduleTaskBundleExecutor_->stop();
   scheduleTaskBundleExecutorOfTimer_->stop();
   shmCliOfWebSrv_->stop();
@@ -1084,7 +1201,12 @@ std::tuple<int, OrderId> StgEngImpl::order(OrderInfoSPtr& orderInfo) {
   }
 
   if (orderInfo->orderId_ == 0) {
-    orderInfo->orderId_ = GET_RAND_INT();
+    //! 回测模式下使用递增的订单号，保证每次回测的结果一致
+    orderInfo->orderId_ = isBacktestMode() ? backtestSvc_->getNextOrderId()
+                                           : GET_RAND_INT();
+  }
+  if (isBacktestMode()) {
+    orderInfo->orderTime_ = backtestSvc_->now();
   }
   orderInfo->parValue_ = recSymbolInfo->parValue;
   strncpy(orderInfo->exchSymbolCode_, recSymbolInfo->exchSymbolCode.c_str(),
@@ -1111,6 +1233,24 @@ std::tuple<int, OrderId> StgEngImpl::order(OrderInfoSPtr& orderInfo) {
   EXEC_PERF_TEST("Order", orderInfo->orderTime_, 100, 10);
 #endif
 
+  //! 回测模式下发送到模拟撮合，不同步到风控和数据库
+  if (isBacktestMode()) {
+#ifndef OPT_LOG
+    logInfo("Send order {}", {orderInfo->toShortStr()},
+            tblMonitorOfStgInstInfo_->getStgInstInfo<StgInstInfoSPtr>(
+                orderInfo->stgInstId_));
+#endif
+    backtestSvc_->order(orderInfo);
+    return {0, orderInfo->orderId_};
+  }
+
+  //! 在行情回调中下单的时候带上这条行情的时延追踪记录
+  if (LatencyTrace::get_const_instance().enabled()) {
+    orderInfo->traceCtx_ = MakeTraceCtx(std::ext::tls_get<TraceRecord>());
+    LatencyTrace::get_mutable_instance().stamp(orderInfo->traceCtx_,
+                                               TraceHop::OrderSend);
+  }
+
   shmCliOfTDSrv_->asyncSendMsgWithZeroCopy(
       [this, &orderInfo](void* shmBufOfReq) {
         InitMsgBodyExt(shmBufOfReq, *orderInfo);
@@ -1145,6 +1285,14 @@ int StgEngImpl::cancelOrder(OrderId orderId) {
     return statusCode;
   }
 
+  if (isBacktestMode()) {
+    logInfo("Send cancel order {}", {orderInfo->toShortStr()},
+            tblMonitorOfStgInstInfo_->getStgInstInfo<StgInstInfoSPtr>(
+                orderInfo->stgInstId_));
+    backtestSvc_->cancelOrder(orderInfo);
+    return 0;
+  }
+
   shmCliOfTDSrv_->asyncSendMsgWithZeroCopy(
       [&](void* shmBufOfReq) {
         InitMsgBodyExt(shmBufOfReq, *orderInfo);
@@ -1201,6 +1349,10 @@ std::tuple<int, AlgoId> StgEngImpl::algoOrder(
     const StgInstInfoSPtr& stgInstInfo, const std::string& algoType,
     const std::string& algoName, std::uint32_t lifetime,
     const std::string& algoParamsInJsonFmt) {
+  //! 算法交易引擎在独立线程中运行，回测模式下不支持
+  if (isBacktestMode()) {
+    return {SCODE_STG_BACKTEST_UNSUPPORTED_ALGO_ORDER, 0};
+  }
   return algoMgr_->algoOrder(stgInstInfo, algoType, algoName, lifetime,
                              algoParamsInJsonFmt);
 }
@@ -1214,6 +1366,9 @@ std::string StgEngImpl::getProgressOfAlgoOrder(AlgoId algoId) {
 }
 
 int StgEngImpl::sub(StgInstId subscriber, const std::string& topic) {
+  if (isBacktestMode()) {
+    return backtestSvc_->sub(subscriber, topic);
+  }
   if (boost::contains(topic, magic_enum::enum_name(MDType::DynCandle))) {
     //! 动态k线本地生成，所以特殊处理
     return dynCandle_->sub(subscriber, topic);
@@ -1226,6 +1381,9 @@ int StgEngImpl::sub(StgInstId subscriber, const std::string& topic) {
 }
 
 int StgEngImpl::unSub(StgInstId subscriber, const std::string& topic) {
+  if (isBacktestMode()) {
+    return backtestSvc_->unSub(subscriber, topic);
+  }
   if (boost::contains(topic, magic_enum::enum_name(MDType::DynCandle))) {
     //! 动态k线本地生成，所以特殊处理
     return dynCandle_->unSub(subscriber, topic);
@@ -1422,6 +1580,10 @@ void StgEngImpl::installStgInstTimer(StgInstId stgInstId,
       fmt::format("{}{}-{}", PREFIX_OF_TIMER_NAME, stgInstId, timerName);
   const auto task = std::make_shared<TaskOfFixedTime>(
       stgInstId, timerNameWithInstId, execTime, timeZone);
+  if (isBacktestMode()) {
+    backtestSvc_->installStgInstTimer(task);
+    return;
+  }
   {
     std::lock_guard<std::ext::spin_mutex> guard(mtxTaskOfFixedTimeGroup_);
     taskOfFixedTimeGroup_.emplace_back(task);
@@ -1443,6 +1605,13 @@ void StgEngImpl::installStgInstTimer(StgInstId stgInstId,
        std::to_string(maxExecTimes)},
       tblMonitorOfStgInstInfo_->getStgInstInfo<StgInstInfoSPtr>(stgInstId));
 
+  if (isBacktestMode()) {
+    backtestSvc_->installStgInstTimer(stgInstId, timerNameWithInstId,
+                                      execAtStartUp, milliSecInterval,
+                                      maxExecTimes);
+    return;
+  }
+
   const auto callback = [stgInstId, timerNameWithInstId, this]() {
     auto asynTask =
         MakeStgSignal(MSG_ID_ON_STG_INST_TIMER, stgInstId, timerNameWithInstId);
@@ -1470,6 +1639,11 @@ void StgEngImpl::uninstallStgInstTimer(StgInstId stgInstId,
   const auto timerNameWithInstId =
       fmt::format("{}{}-{}", PREFIX_OF_TIMER_NAME, stgInstId, timerName);
 
+  if (isBacktestMode()) {
+    backtestSvc_->uninstallStgInstTimer(timerNameWithInstId);
+    return;
+  }
+
   {
     std::lock_guard<std::ext::spin_mutex> guard(mtxTaskOfFixedTimeGroup_);
     std::ext::erase_if(
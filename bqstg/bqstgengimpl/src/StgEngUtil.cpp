@@ -110,4 +110,23 @@ int InitPosSide(OrderInfoSPtr& orderInfo) {
   return 0;
 }
 
+bool IsTimeToExecTaskOfFixedTime(const TaskOfFixedTimeSPtr& taskOfFixedTime,
+                                 const boost::posix_time::ptime& ts) {
+  //! 根据时区转换为本地时间
+  const auto localTs =
+      ts + boost::posix_time::hours(taskOfFixedTime->timeZone_);
+  //! 本地时间转换为YYYY-MM-DDTHH:MM:SS格式
+  auto localTsInStrFmt = boost::posix_time::to_iso_extended_string(localTs);
+
+  //! 将时间从 YYYY-MM-DDTHH:MM:SS 格式转换为 Y2020M01D23h10m15s20
+  localTsInStrFmt[04] = 'M';
+  localTsInStrFmt[07] = 'D';
+  localTsInStrFmt[10] = 'h';
+  localTsInStrFmt[13] = 'm';
+  localTsInStrFmt[16] = 's';
+  localTsInStrFmt = "Y" + localTsInStrFmt;
+
+  return boost::contains(localTsInStrFmt, taskOfFixedTime->execTime_);
+}
+
 }  // namespace bq::stg
@@ -30,6 +30,7 @@
 #include "def/DataStruOfTD.hpp"
 #include "def/StgConst.hpp"
 #include "util/Datetime.hpp"
+#include "util/LatencyTrace.hpp"
 #include "util/MarketDataCache.hpp"
 #include "util/PosSnapshot.hpp"
 #include "util/TaskDispatcher.hpp"
@@ -60,6 +61,20 @@ void StgInstTaskHandlerImpl::handleAsyncTaskImpl(
     const StgInstInfoSPtr& stgInstInfo, const SHMIPCAsyncTaskSPtr& asyncTask) {
   const auto data = asyncTask->task_->data_;
   const auto msgId = static_cast<const SHMHeader*>(data)->msgId_;
+
+  //! 开启时延追踪的时候，策略在行情回调中下单会从当前线程取走这条行情的记录
+  const auto traceMD = asyncTask->task_->tscOfDispatch_ != 0;
+  if (traceMD) {
+    const auto& mdHeader = GetMDHeader(data);
+    auto& traceRecord = std::ext::tls_get<TraceRecord>();
+    traceRecord.set(TraceHop::MDRecv, mdHeader.tscOfRecv_);
+    traceRecord.set(TraceHop::MDPub, mdHeader.tscOfPub_);
+    traceRecord.set(TraceHop::StgEngDispatch,
+                    asyncTask->task_->tscOfDispatch_);
+    LatencyTrace::get_mutable_instance().stamp(traceRecord,
+                                               TraceHop::StgCallback);
+  }
+
   switch (msgId) {
     case MSG_ID_ON_STG_MANUAL_INTERVENTION: {
       const auto commonIPCData =
@@ -362,6 +377,10 @@ void StgInstTaskHandlerImpl::handleAsyncTaskImpl(
       }
     } break;
   }
+
+  if (traceMD) {
+    std::ext::tls_get<TraceRecord>() = TraceRecord();
+  }
 }
 
 void StgInstTaskHandlerImpl::beforeOnOrderRet(
@@ -381,8 +400,8 @@ void StgInstTaskHandlerImpl::beforeOnOrderRet(
         orderRet);
   }
 
-  //! 手拍单转发到web服务
-  if (stgInstInfo->stgId_ == STG_OF_MANUAL) {
+  //! 手拍单转发到web服务，回测模式下没有web服务
+  if (stgInstInfo->stgId_ == STG_OF_MANUAL && !stgEng_->isBacktestMode()) {
     const auto orderInfoInJsonFmt = orderRet->toJson();
     const auto shmBufLen =
         sizeof(CommonIPCData) + orderInfoInJsonFmt.size() + 1;
@@ -406,8 +425,8 @@ bool StgInstTaskHandlerImpl::beforeOnStgManualIntervention(
 
 void StgInstTaskHandlerImpl::beforeOnCancelOrderRet(
     const StgInstInfoSPtr& stgInstInfo, const OrderInfo* orderInfo) {
-  //! 手拍单转发到web服务
-  if (stgInstInfo->stgId_ == STG_OF_MANUAL) {
+  //! 手拍单转发到web服务，回测模式下没有web服务
+  if (stgInstInfo->stgId_ == STG_OF_MANUAL && !stgEng_->isBacktestMode()) {
     const auto orderInfoInJsonFmt = orderInfo->toJson();
     const auto shmBufLen =
         sizeof(CommonIPCData) + orderInfoInJsonFmt.size() + 1;
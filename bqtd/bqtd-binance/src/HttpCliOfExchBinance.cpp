@@ -24,6 +24,7 @@
 #include "def/TDWSCliAsyncTaskArg.hpp"
 #include "util/Datetime.hpp"
 #include "util/Decimal.hpp"
+#include "util/DecimalParser.hpp"
 #include "util/ExternalStatusCodeCache.hpp"
 #include "util/TaskDispatcher.hpp"
 
@@ -339,12 +340,12 @@ HttpCliOfExchBinance::makeAssetInfoGroupOfSpot(const JsonDataSPtr& jsonData) {
       } else if (yyjson_equals_str(valFieldName, "free")) {
         valFieldValue = yyjson_obj_iter_get_val(valFieldName);
         const auto free = yyjson_get_str(valFieldValue);
-        assetInfo->available_ = CONV(Decimal, free);
+        assetInfo->available_ = Str2Dbl(free);
 
       } else if (yyjson_equals_str(valFieldName, "locked")) {
         valFieldValue = yyjson_obj_iter_get_val(valFieldName);
         const auto locked = yyjson_get_str(valFieldValue);
-        assetInfo->frozen_ = CONV(Decimal, locked);
+        assetInfo->frozen_ = Str2Dbl(locked);
       }
     }
 
@@ -430,27 +431,27 @@ HttpCliOfExchBinance::makeAssetInfoGroupUBasedContracts(
       } else if (yyjson_equals_str(valFieldName, "balance")) {
         valFieldValue = yyjson_obj_iter_get_val(valFieldName);
         const auto balance = yyjson_get_str(valFieldValue);
-        assetInfo->vol_ = CONV(Decimal, balance);
+        assetInfo->vol_ = Str2Dbl(balance);
 
       } else if (yyjson_equals_str(valFieldName, "crossWalletBalance")) {
         valFieldValue = yyjson_obj_iter_get_val(valFieldName);
         const auto crossWalletBalance = yyjson_get_str(valFieldValue);
-        assetInfo->crossVol_ = CONV(Decimal, crossWalletBalance);
+        assetInfo->crossVol_ = Str2Dbl(crossWalletBalance);
 
       } else if (yyjson_equals_str(valFieldName, "crossUnPnl")) {
         valFieldValue = yyjson_obj_iter_get_val(valFieldName);
         const auto crossUnPnl = yyjson_get_str(valFieldValue);
-        assetInfo->pnlUnreal_ = CONV(Decimal, crossUnPnl);
+        assetInfo->pnlUnreal_ = Str2Dbl(crossUnPnl);
 
       } else if (yyjson_equals_str(valFieldName, "availableBalance")) {
         valFieldValue = yyjson_obj_iter_get_val(valFieldName);
         const auto availableBalance = yyjson_get_str(valFieldValue);
-        assetInfo->available_ = CONV(Decimal, availableBalance);
+        assetInfo->available_ = Str2Dbl(availableBalance);
 
       } else if (yyjson_equals_str(valFieldName, "maxWithdrawAmount")) {
         valFieldValue = yyjson_obj_iter_get_val(valFieldName);
         const auto maxWithdrawAmount = yyjson_get_str(valFieldValue);
-        assetInfo->maxWithdraw_ = CONV(Decimal, maxWithdrawAmount);
+        assetInfo->maxWithdraw_ = Str2Dbl(maxWithdrawAmount);
 
       } else if (yyjson_equals_str(valFieldName, "updateTime")) {
         valFieldValue = yyjson_obj_iter_get_val(valFieldName);
@@ -523,12 +524,12 @@ HttpCliOfExchBinance::makeAssetInfoGroupCBasedContracts(
       } else if (yyjson_equals_str(valFieldName, "balance")) {
         valFieldValue = yyjson_obj_iter_get_val(valFieldName);
         const auto balance = yyjson_get_str(valFieldValue);
-        assetInfo->vol_ = CONV(Decimal, balance);
+        assetInfo->vol_ = Str2Dbl(balance);
 
       } else if (yyjson_equals_str(valFieldName, "withdrawAvailable")) {
         valFieldValue = yyjson_obj_iter_get_val(valFieldName);
         const auto withdrawAvailable = yyjson_get_str(valFieldValue);
-        assetInfo->maxWithdraw_ = CONV(Decimal, withdrawAvailable);
+        assetInfo->maxWithdraw_ = Str2Dbl(withdrawAvailable);
 
       } else if (yyjson_equals_str(valFieldName, "updateTime")) {
         valFieldValue = yyjson_obj_iter_get_val(valFieldName);
@@ -538,12 +539,12 @@ HttpCliOfExchBinance::makeAssetInfoGroupCBasedContracts(
       } else if (yyjson_equals_str(valFieldName, "crossWalletBalance")) {
         valFieldValue = yyjson_obj_iter_get_val(valFieldName);
         const auto crossWalletBalance = yyjson_get_str(valFieldValue);
-        assetInfo->crossVol_ = CONV(Decimal, crossWalletBalance);
+        assetInfo->crossVol_ = Str2Dbl(crossWalletBalance);
 
       } else if (yyjson_equals_str(valFieldName, "crossUnPnl")) {
         valFieldValue = yyjson_obj_iter_get_val(valFieldName);
         const auto crossUnPnl = yyjson_get_str(valFieldValue);
-        assetInfo->pnlUnreal_ = CONV(Decimal, crossUnPnl);
+        assetInfo->pnlUnreal_ = Str2Dbl(crossUnPnl);
       }
     }
 
@@ -706,8 +707,8 @@ OrderInfoSPtr HttpCliOfExchBinance::makeOrderInfoFromExchOfSpot(
     const auto executedQty = yyjson_get_str(valExecuteQty);
     const auto cummulativeQuoteQty = yyjson_get_str(valCummulativeQuoteQty);
 
-    const auto dealSize = CONV(Decimal, executedQty);
-    const auto dealAmt = CONV(Decimal, cummulativeQuoteQty);
+    const auto dealSize = Str2Dbl(executedQty);
+    const auto dealAmt = Str2Dbl(cummulativeQuoteQty);
 
     Decimal avgDealPrice = 0;
     if (!DEC::ZERO(dealSize)) {
@@ -810,8 +811,8 @@ OrderInfoSPtr HttpCliOfExchBinance::makeOrderInfoFromExchOfUBasedContracts(
     const auto valAvgPrice = yyjson_obj_get(jsonData->root_, "avgPrice");
     const auto executedQty = yyjson_get_str(valExecuteQty);
     const auto avgPrice = yyjson_get_str(valAvgPrice);
-    ret->dealSize_ = CONV(Decimal, executedQty);
-    ret->avgDealPrice_ = CONV(Decimal, avgPrice);
+    ret->dealSize_ = Str2Dbl(executedQty);
+    ret->avgDealPrice_ = Str2Dbl(avgPrice);
 
     const auto valStatus = yyjson_obj_get(jsonData->root_, "status");
     const auto status = yyjson_get_str(valStatus);
@@ -908,8 +909,8 @@ OrderInfoSPtr HttpCliOfExchBinance::makeOrderInfoFromExchOfCBasedContracts(
     const auto valAvgPrice = yyjson_obj_get(jsonData->root_, "avgPrice");
     const auto executedQty = yyjson_get_str(valExecuteQty);
     const auto avgPrice = yyjson_get_str(valAvgPrice);
-    ret->dealSize_ = CONV(Decimal, executedQty);
-    ret->avgDealPrice_ = CONV(Decimal, avgPrice);
+    ret->dealSize_ = Str2Dbl(executedQty);
+    ret->avgDealPrice_ = Str2Dbl(avgPrice);
 
     const auto valStatus = yyjson_obj_get(jsonData->root_, "status");
     const auto status = yyjson_get_str(valStatus);
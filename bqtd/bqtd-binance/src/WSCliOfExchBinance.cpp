@@ -24,6 +24,7 @@
 #include "def/Def.hpp"
 #include "def/TDWSCliAsyncTaskArg.hpp"
 #include "util/Decimal.hpp"
+#include "util/DecimalParser.hpp"
 #include "util/Json.hpp"
 #include "util/String.hpp"
 #include "util/TaskDispatcher.hpp"
@@ -147,12 +148,12 @@ std::vector<AssetInfoSPtr> WSCliOfExchBinance::makeAssetsUpdate(
       } else if (yyjson_equals_str(valFieldName, "f")) {
         valFieldValue = yyjson_obj_iter_get_val(valFieldName);
         const auto fieldValue = yyjson_get_str(valFieldValue);
-        assetInfo->available_ = CONV(Decimal, fieldValue);
+        assetInfo->available_ = Str2Dbl(fieldValue);
 
       } else if (yyjson_equals_str(valFieldName, "l")) {
         valFieldValue = yyjson_obj_iter_get_val(valFieldName);
         const auto fieldValue = yyjson_get_str(valFieldValue);
-        assetInfo->frozen_ = CONV(Decimal, fieldValue);
+        assetInfo->frozen_ = Str2Dbl(fieldValue);
       }
       assetInfo->vol_ = assetInfo->available_ + assetInfo->frozen_;
     }
@@ -318,8 +319,8 @@ OrderInfoSPtr WSCliOfExchBinance::makeOrderInfoFromExchOfSpot(
     }
   }
 
-  const auto totalDealAmt = CONV(Decimal, yyjson_get_str(valZ));
-  const auto totalDealSize = CONV(Decimal, yyjson_get_str(valz));
+  const auto totalDealAmt = Str2Dbl(yyjson_get_str(valZ));
+  const auto totalDealSize = Str2Dbl(yyjson_get_str(valz));
   Decimal avgDealPrice = 0;
   if (!DEC::ZERO(totalDealSize)) {
     avgDealPrice = totalDealAmt / totalDealSize;
@@ -339,7 +340,7 @@ OrderInfoSPtr WSCliOfExchBinance::makeOrderInfoFromExchOfSpot(
           sizeof(orderInfoFromExch->exchOrderId_) - 1);
 
   if (valn) {
-    orderInfoFromExch->fee_ = CONV(Decimal, yyjson_get_str(valn));
+    orderInfoFromExch->fee_ = Str2Dbl(yyjson_get_str(valn));
   }
   if (valN) {
     if (!yyjson_is_null(valN)) {
@@ -347,15 +348,15 @@ OrderInfoSPtr WSCliOfExchBinance::makeOrderInfoFromExchOfSpot(
               sizeof(orderInfoFromExch->feeCurrency_) - 1);
     }
   }
-  orderInfoFromExch->dealSize_ = CONV(Decimal, yyjson_get_str(valz));
+  orderInfoFromExch->dealSize_ = Str2Dbl(yyjson_get_str(valz));
   orderInfoFromExch->avgDealPrice_ = avgDealPrice;
 
   const auto t = CONV(std::string, yyjson_get_sint(valt));
   strncpy(orderInfoFromExch->lastTradeId_, t.c_str(),
           sizeof(orderInfoFromExch->lastTradeId_) - 1);
 
-  orderInfoFromExch->lastDealPrice_ = CONV(Decimal, yyjson_get_str(valL));
-  orderInfoFromExch->lastDealSize_ = CONV(Decimal, yyjson_get_str(vall));
+  orderInfoFromExch->lastDealPrice_ = Str2Dbl(yyjson_get_str(valL));
+  orderInfoFromExch->lastDealSize_ = Str2Dbl(yyjson_get_str(vall));
   orderInfoFromExch->lastDealTime_ = yyjson_get_uint(valT) * 1000;
 
   const auto orderStatus = getOrderStatus(orderInfoFromExch, exchOrderStatus);
@@ -443,7 +444,7 @@ OrderInfoSPtr WSCliOfExchBinance::makeOrderInfoFromExchOfContracts(
           fmt::format("{}", yyjson_get_uint(vali)).c_str(),
           sizeof(orderInfoFromExch->exchOrderId_) - 1);
   if (valn) {
-    orderInfoFromExch->fee_ = CONV(Decimal, yyjson_get_str(valn));
+    orderInfoFromExch->fee_ = Str2Dbl(yyjson_get_str(valn));
   }
   if (valN) {
     if (!yyjson_is_null(valN)) {
@@ -451,15 +452,15 @@ OrderInfoSPtr WSCliOfExchBinance::makeOrderInfoFromExchOfContracts(
               sizeof(orderInfoFromExch->feeCurrency_) - 1);
     }
   }
-  orderInfoFromExch->dealSize_ = CONV(Decimal, yyjson_get_str(valz));
-  orderInfoFromExch->avgDealPrice_ = CONV(Decimal, yyjson_get_str(valap));
+  orderInfoFromExch->dealSize_ = Str2Dbl(yyjson_get_str(valz));
+  orderInfoFromExch->avgDealPrice_ = Str2Dbl(yyjson_get_str(valap));
 
   const auto t = CONV(std::string, yyjson_get_uint(valt));
   strncpy(orderInfoFromExch->lastTradeId_, t.c_str(),
           sizeof(orderInfoFromExch->lastTradeId_) - 1);
 
-  orderInfoFromExch->lastDealPrice_ = CONV(Decimal, yyjson_get_str(valL));
-  orderInfoFromExch->lastDealSize_ = CONV(Decimal, yyjson_get_str(vall));
+  orderInfoFromExch->lastDealPrice_ = Str2Dbl(yyjson_get_str(valL));
+  orderInfoFromExch->lastDealSize_ = Str2Dbl(yyjson_get_str(vall));
 
   const auto orderStatus = getOrderStatus(orderInfoFromExch, exchOrderStatus);
   orderInfoFromExch->orderStatus_ = orderStatus;
@@ -24,6 +24,7 @@ struct FlowCtrlRule;
 using FlowCtrlRuleSPtr = std::shared_ptr<FlowCtrlRule>;
 
 struct LimitValueInSHM;
+struct LimitValueOfConditionValue;
 }  // namespace bq
 
 namespace bq::td::srv {
@@ -62,71 +63,75 @@ class FlowCtrlOnStepBase {
   std::tuple<bool, std::string> checkIfTriggerFlowCtrl(
       const OrderInfoSPtr& orderInfo, std::uint32_t combNo,
       std::uint32_t threadNo, const FlowCtrlRuleSPtr& rule,
-      const std::string& conditionValueInStrFmt,
+      const ConditionKey& conditionKey,
       UpdateStgOfLimitValue updateStgOfLimitValue, Decimal value);
 
  private:
   std::tuple<bool, std::string> checkIfTriggerFlowCtrlOfHoldInfo(
       const OrderInfoSPtr& orderInfo, std::uint32_t combNo,
       std::uint32_t threadNo, const FlowCtrlRuleSPtr& rule,
-      const std::string& conditionValueInStrFmt,
-      const ConditionFieldGroup& conditionFieldGroup);
+      const ConditionKey& conditionKey);
 
   std::tuple<bool, std::string> checkIfTriggerFlowCtrlOfOpenTDay(
       const OrderInfoSPtr& orderInfo, std::uint32_t combNo,
       std::uint32_t threadNo, const FlowCtrlRuleSPtr& rule,
-      const std::string& conditionValueInStrFmt,
-      const ConditionFieldGroup& conditionFieldGroup);
+      const ConditionKey& conditionKey);
 
  private:
   std::tuple<bool, std::string> checkIfTriggerFlowCtrlForNumLimitEachTime(
       const OrderInfoSPtr& orderInfo, std::uint32_t combNo,
       std::uint32_t threadNo, const FlowCtrlRuleSPtr& rule,
-      const std::string& conditionValueInStrFmt, Decimal value);
+      const ConditionKey& conditionKey, Decimal value);
 
  private:
   std::tuple<bool, std::string> checkIfTriggerFlowCtrlForNumLimitTotal(
       const OrderInfoSPtr& orderInfo, std::uint32_t combNo,
       std::uint32_t threadNo, const FlowCtrlRuleSPtr& rule,
-      const std::string& conditionValueInStrFmt,
+      const ConditionKey& conditionKey,
       UpdateStgOfLimitValue updateStgOfLimitValue, Decimal value);
 
   std::tuple<bool, std::string> numLimitTotalCompareAndUpdate(
       const OrderInfoSPtr& orderInfo, std::uint32_t combNo,
       std::uint32_t threadNo, const FlowCtrlRuleSPtr& rule,
-      const std::string& conditionValueInStrFmt, Decimal value);
+      const ConditionKey& conditionKey, Decimal value);
 
   std::tuple<bool, std::string> numLimitTotalCompare(
       const OrderInfoSPtr& orderInfo, std::uint32_t combNo,
       std::uint32_t threadNo, const FlowCtrlRuleSPtr& rule,
-      const std::string& conditionValueInStrFmt);
+      const ConditionKey& conditionKey);
 
   void numLimitTotalUpdate(const OrderInfoSPtr& orderInfo, std::uint32_t combNo,
                            std::uint32_t threadNo, const FlowCtrlRuleSPtr& rule,
-                           const std::string& conditionValueInStrFmt,
+                           const ConditionKey& conditionKey,
                            Decimal value);
 
  private:
   std::tuple<bool, std::string> checkIfTriggerFlowCtrlForNumLimitWithInTime(
       const OrderInfoSPtr& orderInfo, std::uint32_t combNo,
       std::uint32_t threadNo, const FlowCtrlRuleSPtr& rule,
-      const std::string& conditionValueInStrFmt,
+      const ConditionKey& conditionKey,
       UpdateStgOfLimitValue updateStgOfLimitValue);
 
   std::tuple<bool, std::string> numLimitWithInTimeCompareAndUpdate(
       const OrderInfoSPtr& orderInfo, std::uint32_t combNo,
       std::uint32_t threadNo, const FlowCtrlRuleSPtr& rule,
-      const std::string& conditionValueInStrFmt);
+      const ConditionKey& conditionKey);
 
   std::tuple<bool, std::string> numLimitWithInTimeCompare(
       const OrderInfoSPtr& orderInfo, std::uint32_t combNo,
       std::uint32_t threadNo, const FlowCtrlRuleSPtr& rule,
-      const std::string& conditionValueInStrFmt);
+      const ConditionKey& conditionKey);
 
   void numLimitWithInTimeUpdate(const OrderInfoSPtr& orderInfo,
                                 std::uint32_t combNo, std::uint32_t threadNo,
                                 const FlowCtrlRuleSPtr& rule,
-                                const std::string& conditionValueInStrFmt);
+                                const ConditionKey& conditionKey);
+
+ private:
+  const LimitValueOfConditionValue& addLimitValue(
+      const OrderInfoSPtr& orderInfo, std::uint32_t combNo,
+      std::uint32_t threadNo, const FlowCtrlRuleSPtr& rule,
+      const ConditionKey& conditionKey, bool createTSQue = false);
 
  protected:
   TDSrvRiskPluginFlowCtrlPlus* plugin_{nullptr};
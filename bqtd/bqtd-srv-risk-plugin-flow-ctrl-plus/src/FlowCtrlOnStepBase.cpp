@@ -7,13 +7,13 @@
  *
  * \brief
  *
- * 功能：根据 orderInfo 和 conditionFieldGroup 生成 conditionValueInStrFmt
- * "acctId=10000&marketCode=SSE" ，然后再根据数据库里的 condition
- * "acctId=10001&marketCode=*" 字段判断 是否触发风风控，如果触发风控，那么找出
- * rule 的 c2l 中的 limitValue 也就是 c2l[conditionValueInStrFmt]
+ * 功能：根据 orderInfo 和 conditionFieldMask 生成 conditionKey，也就是
+ * "acctId=10000&marketCode=SSE" 对应的整数元组，然后再根据数据库里的 condition
+ * "acctId=10001&marketCode=*" 编译出的 compiledCondition 判断是否触发风控，
+ * 如果触发风控，那么找出 rule 的 c2l 中的 limitValue 也就是 c2l[conditionKey]
  * 判断是不是超流控
  *
- * 注意：MatchConditionTemplate 仅仅用于判断当前 orderInfo 是否符合触发风控的
+ * 注意：MatchCompiledCondition 仅仅用于判断当前 orderInfo 是否符合触发风控的
  * condition，checkIfTriggerFlowCtrl 中 limitValue 的统计单位还是
  * acctId=10000&marketCode=SSE 这样精确的 key 并不是 acctId=10000&marketCode=*
  * 这样的 key，但是在 checkIfTriggerFlowCtrlOfHoldInfo 和
@@ -70,59 +70,47 @@ std::tuple<int, std::string> FlowCtrlOnStepBase::handleFlowCtrlForTarget(
 
     /*
      *
-     * 根据 orderInfo 和 conditionFieldGroup ["acctId", "marketCode"] 获取：
+     * 根据 orderInfo 和 conditionFieldMask (由 conditionFieldGroup
+     * ["acctId", "marketCode"] 生成) 获取 conditionKey，也就是
+     * "acctId=10000&marketCode=SSE" 对应的整数元组，流控状态按照 conditionKey
+     * 缓存，字符串形式只在第一次创建 limitValueInSHM 的时候生成。
      *
-     * conditionValueInStrFmt = "acctId=10000&marketCode=SSE"
-     * conditionValue = {{"acctId":"10000"}, {"marketCode":"SSE"}}
-     *
-     * conditionValueInStrFmt 是根据 conditionFieldGroup 的顺序也就是数据库中
-     * condition 的顺序生成的，因此会出现 condition 字符串中字段的顺序不一样但
-     * 实际的条件一样的情况，不过这样也不影响流控的处理，有一种可能的结果就是
-     * ConditionValue2LimitValueGroup 中会出现两条记录，但他们 conditionValue
-     * 是一样的，只是字段顺序不同而已。
+     * conditionKey 中字段按照字段编号排列，因此 condition 字符串中字段的顺序
+     * 不一样但实际条件一样的时候生成的 conditionKey 是一样的。
      *
      */
 
-    const auto& conditionFieldGroup = rule->conditionFieldGroup_;
-    const auto [sCodeOfMake, sMsgOfMake, conditionValueInStrFmt,
-                conditionValue] =
-        MakeConditioValue(orderInfo, conditionFieldGroup);
-    if (sCodeOfMake != 0) {
-      L_W(plugin_->logger(), "[{}] {}", plugin_->name(), sMsgOfMake);
+    ConditionKey conditionKey;
+    if (!MakeConditionKey(*orderInfo, rule->conditionFieldMask_,
+                          conditionKey)) {
+      L_W(plugin_->logger(), "[{}] Make condition key failed. {}",
+          plugin_->name(), rule->toStr());
       //! 检查下一条风控规则
       continue;
     }
 
-    //! 检查 conditionValue 是否符合风控条件模板 conditionTemplate
-    const auto [sCodeOfMatch, sMsgOfMatch, matchConditionTemplte] =
-        MatchConditionTemplate(conditionValue, rule->conditionTemplate_);
-    if (sCodeOfMatch != 0) {
-      L_W(plugin_->logger(), "[{}] {}", plugin_->name(), sMsgOfMatch);
-      //! 检查下一条风控规则
+    //! 如果当前订单不符合风控条件模板，那么检查下一条风控规则
+    if (!MatchCompiledCondition(*orderInfo, conditionKey,
+                                rule->compiledCondition_)) {
       continue;
     }
 
-    //! 如果当前订单不符合风控条件，那么检查下一条风控规则
-    if (matchConditionTemplte == false) continue;
-
     //! 如果当前订单符合风控条件，那么检查是否触发风控
     bool triggerRiskCtrl = false;
     std::string details;
     if (rule->target_ == FlowCtrlTarget::HoldVolTotal ||
         rule->target_ == FlowCtrlTarget::HoldAmtTotal) {
       std::tie(triggerRiskCtrl, details) = checkIfTriggerFlowCtrlOfHoldInfo(
-          orderInfo, combNo, threadNo, rule, conditionValueInStrFmt,
-          conditionFieldGroup);
+          orderInfo, combNo, threadNo, rule, conditionKey);
 
     } else if (rule->target_ == FlowCtrlTarget::OpenTDayTotal) {
       std::tie(triggerRiskCtrl, details) = checkIfTriggerFlowCtrlOfOpenTDay(
-          orderInfo, combNo, threadNo, rule, conditionValueInStrFmt,
-          conditionFieldGroup);
+          orderInfo, combNo, threadNo, rule, conditionKey);
 
     } else {
-      std::tie(triggerRiskCtrl, details) = checkIfTriggerFlowCtrl(
-          orderInfo, combNo, threadNo, rule, conditionValueInStrFmt,
-          updateStgOfLimitValue, value);
+      std::tie(triggerRiskCtrl, details) =
+          checkIfTriggerFlowCtrl(orderInfo, combNo, threadNo, rule,
+                                 conditionKey, updateStgOfLimitValue, value);
     }
 
     //! 如果没有触发风控，那么检查下一条风控规则
@@ -138,24 +126,24 @@ std::tuple<int, std::string> FlowCtrlOnStepBase::handleFlowCtrlForTarget(
 std::tuple<bool, std::string> FlowCtrlOnStepBase::checkIfTriggerFlowCtrl(
     const OrderInfoSPtr& orderInfo, std::uint32_t combNo,
     std::uint32_t threadNo, const FlowCtrlRuleSPtr& rule,
-    const std::string& conditionValueInStrFmt,
+    const ConditionKey& conditionKey,
     UpdateStgOfLimitValue updateStgOfLimitValue, Decimal value) {
   switch (rule->limitType_) {
     //! 检查每笔是否超限的流控
     case FlowCtrlLimitType::NumLimitEachTime:
       return checkIfTriggerFlowCtrlForNumLimitEachTime(
-          orderInfo, combNo, threadNo, rule, conditionValueInStrFmt, value);
+          orderInfo, combNo, threadNo, rule, conditionKey, value);
 
     //! 检查总数是否超限的流控
     case FlowCtrlLimitType::NumLimitTotal:
       return checkIfTriggerFlowCtrlForNumLimitTotal(
-          orderInfo, combNo, threadNo, rule, conditionValueInStrFmt,
+          orderInfo, combNo, threadNo, rule, conditionKey,
           updateStgOfLimitValue, value);
 
     //! 检查单位时间内数量是否超限的流控
     case FlowCtrlLimitType::NumLimitWithinTime:
       return checkIfTriggerFlowCtrlForNumLimitWithInTime(
-          orderInfo, combNo, threadNo, rule, conditionValueInStrFmt,
+          orderInfo, combNo, threadNo, rule, conditionKey,
           updateStgOfLimitValue);
 
     default:
@@ -169,7 +157,7 @@ std::tuple<bool, std::string>
 FlowCtrlOnStepBase::checkIfTriggerFlowCtrlForNumLimitEachTime(
     const OrderInfoSPtr& orderInfo, std::uint32_t combNo,
     std::uint32_t threadNo, const FlowCtrlRuleSPtr& rule,
-    const std::string& conditionValueInStrFmt, Decimal value) {
+    const ConditionKey& conditionKey, Decimal value) {
   bool triggerRiskCtrl = false;
   std::string details;
   if (DEC::GT(value, rule->limitValueInConf_.value_)) {
@@ -196,23 +184,23 @@ std::tuple<bool, std::string>
 FlowCtrlOnStepBase::checkIfTriggerFlowCtrlForNumLimitTotal(
     const OrderInfoSPtr& orderInfo, std::uint32_t combNo,
     std::uint32_t threadNo, const FlowCtrlRuleSPtr& rule,
-    const std::string& conditionValueInStrFmt,
+    const ConditionKey& conditionKey,
     UpdateStgOfLimitValue updateStgOfLimitValue, Decimal value) {
   switch (updateStgOfLimitValue) {
     //! 判断累计数量是否超限并更新
     case UpdateStgOfLimitValue::CompareAndUpdate:
       return numLimitTotalCompareAndUpdate(orderInfo, combNo, threadNo, rule,
-                                           conditionValueInStrFmt, value);
+                                           conditionKey, value);
 
     //! 仅判断累计数量是否超限
     case UpdateStgOfLimitValue::Compare:
       return numLimitTotalCompare(orderInfo, combNo, threadNo, rule,
-                                  conditionValueInStrFmt);
+                                  conditionKey);
 
     //! 仅更新累计数量
     case UpdateStgOfLimitValue::Update:
-      numLimitTotalUpdate(orderInfo, combNo, threadNo, rule,
-                          conditionValueInStrFmt, value);
+      numLimitTotalUpdate(orderInfo, combNo, threadNo, rule, conditionKey,
+                          value);
   }
   return {false, ""};
 }
@@ -221,16 +209,16 @@ FlowCtrlOnStepBase::checkIfTriggerFlowCtrlForNumLimitTotal(
 std::tuple<bool, std::string> FlowCtrlOnStepBase::numLimitTotalCompareAndUpdate(
     const OrderInfoSPtr& orderInfo, std::uint32_t combNo,
     std::uint32_t threadNo, const FlowCtrlRuleSPtr& rule,
-    const std::string& conditionValueInStrFmt, Decimal value) {
+    const ConditionKey& conditionKey, Decimal value) {
   bool triggerRiskCtrl = false;
   std::string details;
 
   auto& c2l = rule->conditionValue2LimitValueGroup_;
   //! 根据 "acctId=10000&marketCode=SSE" 找到 limitValue
-  const auto iter = c2l.find(conditionValueInStrFmt);
+  const auto iter = c2l.find(conditionKey);
   if (iter != std::end(c2l)) {
     //! 如果 "acctId=10000&marketCode=SSE" 对应的 limitValue 存在
-    auto limitValueInSHM = iter->second;
+    auto limitValueInSHM = iter->second.limitValueInSHM_;
     //! 先计算出当前 value 累加后的 newValue
     const auto newValue = limitValueInSHM->value_ + value;
     if (!DEC::GT(newValue, rule->limitValueInConf_.value_)) {
@@ -259,11 +247,9 @@ std::tuple<bool, std::string> FlowCtrlOnStepBase::numLimitTotalCompareAndUpdate(
     //! 如果该 conditionValue 是第一次进入风控检查
     if (!DEC::GT(value, rule->limitValueInConf_.value_)) {
       //! 构建或者打开 limitValueInSHM (重启服务的时候limitValueInSHM所以是打开)
-      auto limitValueInSHM = plugin_->openOrCtorLimitValue(
-          combNo, threadNo, rule, conditionValueInStrFmt);
-
-      //! 设置 c2l[conditionValueInStrFmt]
-      c2l[conditionValueInStrFmt] = limitValueInSHM;
+      auto limitValueInSHM =
+          addLimitValue(orderInfo, combNo, threadNo, rule, conditionKey)
+              .limitValueInSHM_;
 
       //! 重启后还会进入这个逻辑，因此下面是累加 value，而不是将 value 赋给
       //! newValue
@@ -319,7 +305,7 @@ std::tuple<bool, std::string> FlowCtrlOnStepBase::numLimitTotalCompareAndUpdate(
 std::tuple<bool, std::string> FlowCtrlOnStepBase::numLimitTotalCompare(
     const OrderInfoSPtr& orderInfo, std::uint32_t combNo,
     std::uint32_t threadNo, const FlowCtrlRuleSPtr& rule,
-    const std::string& conditionValueInStrFmt) {
+    const ConditionKey& conditionKey) {
   bool triggerRiskCtrl = false;
   std::string details;
 
@@ -327,18 +313,18 @@ std::tuple<bool, std::string> FlowCtrlOnStepBase::numLimitTotalCompare(
 
   auto& c2l = rule->conditionValue2LimitValueGroup_;
   //! 根据 "acctId=10000&marketCode=SSE" 找到 limitValue
-  const auto iter = c2l.find(conditionValueInStrFmt);
+  const auto iter = c2l.find(conditionKey);
   if (iter != std::end(c2l)) {
-    limitValueInSHM = iter->second;
+    limitValueInSHM = iter->second.limitValueInSHM_;
   } else {
     /*
      * 如果没有下面的代码，那么假设已经到达触发风控的阈值，系统关闭重启，由于c2l
      * 中没有limitValueInSHM，因此只有再此触发一次风控c2l中产生limitValueInSHM之
      * 后才会继续触发风控。
      */
-    limitValueInSHM = plugin_->openOrCtorLimitValue(combNo, threadNo, rule,
-                                                    conditionValueInStrFmt);
-    c2l[conditionValueInStrFmt] = limitValueInSHM;
+    limitValueInSHM =
+        addLimitValue(orderInfo, combNo, threadNo, rule, conditionKey)
+            .limitValueInSHM_;
   }
 
   if (DEC::GT(limitValueInSHM->value_, rule->limitValueInConf_.value_)) {
@@ -361,14 +347,14 @@ std::tuple<bool, std::string> FlowCtrlOnStepBase::numLimitTotalCompare(
 void FlowCtrlOnStepBase::numLimitTotalUpdate(
     const OrderInfoSPtr& orderInfo, std::uint32_t combNo,
     std::uint32_t threadNo, const FlowCtrlRuleSPtr& rule,
-    const std::string& conditionValueInStrFmt, Decimal value) {
+    const ConditionKey& conditionKey, Decimal value) {
   auto& c2l = rule->conditionValue2LimitValueGroup_;
 
   //! 根据 "acctId=10000&marketCode=SSE" 找到 limitValue
-  const auto iter = c2l.find(conditionValueInStrFmt);
+  const auto iter = c2l.find(conditionKey);
   if (iter != std::end(c2l)) {
     //! 如果 "acctId=10000&marketCode=SSE" 对应的 limitValue 存在
-    auto limitValueInSHM = iter->second;
+    auto limitValueInSHM = iter->second.limitValueInSHM_;
 
     //! 那么更新 limitValueInSHM->value_
     plugin_->getTDSrv()
@@ -379,11 +365,9 @@ void FlowCtrlOnStepBase::numLimitTotalUpdate(
 
   } else {
     //! 如果该 conditionValue 是第一次进入风控检查
-    auto limitValueInSHM = plugin_->openOrCtorLimitValue(
-        combNo, threadNo, rule, conditionValueInStrFmt);
-
-    //! 设置 c2l[conditionValueInStrFmt]
-    c2l[conditionValueInStrFmt] = limitValueInSHM;
+    const auto& limitValue =
+        addLimitValue(orderInfo, combNo, threadNo, rule, conditionKey);
+    auto limitValueInSHM = limitValue.limitValueInSHM_;
 
     //! 重启后还会进入这个逻辑，因此即使是第一次进入，下面也是累加 value
     //! 而不是赋值
@@ -395,7 +379,8 @@ void FlowCtrlOnStepBase::numLimitTotalUpdate(
 
     L_T(plugin_->logger(),
         "Add rec {} to c2l, Only update cur value to {} + {}, not compare. {}",
-        conditionValueInStrFmt, limitValueInSHM->value_, value, rule->toStr());
+        limitValue.conditionValueInStrFmt_, limitValueInSHM->value_, value,
+        rule->toStr());
 
     if (c2l.size() % 100 == 0) {
       L_W(plugin_->logger(), "Size of risk ctrl list is {}. {}", c2l.size(),
@@ -409,23 +394,23 @@ std::tuple<bool, std::string>
 FlowCtrlOnStepBase::checkIfTriggerFlowCtrlForNumLimitWithInTime(
     const OrderInfoSPtr& orderInfo, std::uint32_t combNo,
     std::uint32_t threadNo, const FlowCtrlRuleSPtr& rule,
-    const std::string& conditionValueInStrFmt,
+    const ConditionKey& conditionKey,
     UpdateStgOfLimitValue updateStgOfLimitValue) {
   switch (updateStgOfLimitValue) {
     //! 判断是否超流控并更新流控时间队列
     case UpdateStgOfLimitValue::CompareAndUpdate:
       return numLimitWithInTimeCompareAndUpdate(orderInfo, combNo, threadNo,
-                                                rule, conditionValueInStrFmt);
+                                                rule, conditionKey);
 
     //! 判断是否超流控
     case UpdateStgOfLimitValue::Compare:
       return numLimitWithInTimeCompare(orderInfo, combNo, threadNo, rule,
-                                       conditionValueInStrFmt);
+                                       conditionKey);
 
     //! 更新流控时间队列
     case UpdateStgOfLimitValue::Update:
       numLimitWithInTimeUpdate(orderInfo, combNo, threadNo, rule,
-                               conditionValueInStrFmt);
+                               conditionKey);
   }
   return {false, ""};
 }
@@ -435,7 +420,7 @@ std::tuple<bool, std::string>
 FlowCtrlOnStepBase::numLimitWithInTimeCompareAndUpdate(
     const OrderInfoSPtr& orderInfo, std::uint32_t combNo,
     std::uint32_t threadNo, const FlowCtrlRuleSPtr& rule,
-    const std::string& conditionValueInStrFmt) {
+    const ConditionKey& conditionKey) {
   bool triggerRiskCtrl = false;
   std::string details;
 
@@ -443,10 +428,11 @@ FlowCtrlOnStepBase::numLimitWithInTimeCompareAndUpdate(
 
   auto& c2l = rule->conditionValue2LimitValueGroup_;
   //! 根据 "acctId=10000&marketCode=SSE" 找到 limitValue
-  const auto iter = c2l.find(conditionValueInStrFmt);
+  const auto iter = c2l.find(conditionKey);
   if (iter != std::end(c2l)) {
     //! 如果 "acctId=10000&marketCode=SSE" 对应的 limitValue 存在
-    auto limitValueInSHM = iter->second;
+    const auto& limitValue = iter->second;
+    auto limitValueInSHM = limitValue.limitValueInSHM_;
     //! 先计算出假设当前订单报出的 curMSInterval
     const auto curMSInterval = now - limitValueInSHM->tsQue_->front();
     if (curMSInterval < rule->limitValueInConf_.msInterval_) {
@@ -468,12 +454,12 @@ FlowCtrlOnStepBase::numLimitWithInTimeCompareAndUpdate(
           ->stash(
               [limitValueInSHM, now]() { limitValueInSHM->tsQue_->push(now); });
       L_T(plugin_->logger(), "Stash push action. keyOfTSQue = {}, ts = {} {}",
-          conditionValueInStrFmt, now, rule->toStr());
+          limitValue.conditionValueInStrFmt_, now, rule->toStr());
       L_T(plugin_->logger(),
           "{} {} - {} >= {} so not trigger. keyOfTSQue = {}, [tsQueSize = {}]",
           rule->no_, now, limitValueInSHM->tsQue_->front(),
-          rule->limitValueInConf_.msInterval_, conditionValueInStrFmt,
-          limitValueInSHM->tsQue_->size());
+          rule->limitValueInConf_.msInterval_,
+          limitValue.conditionValueInStrFmt_, limitValueInSHM->tsQue_->size());
     }
 
   } else {
@@ -481,11 +467,9 @@ FlowCtrlOnStepBase::numLimitWithInTimeCompareAndUpdate(
     bool createTSQue = true;
 
     //! 构建或者打开 limitValueInSHM (重启服务的时候limitValueInSHM所以是打开)
-    auto limitValueInSHM = plugin_->openOrCtorLimitValue(
-        combNo, threadNo, rule, conditionValueInStrFmt, createTSQue);
-
-    //! 设置 c2l[conditionValueInStrFmt]
-    c2l[conditionValueInStrFmt] = limitValueInSHM;
+    const auto& limitValue = addLimitValue(orderInfo, combNo, threadNo, rule,
+                                           conditionKey, createTSQue);
+    auto limitValueInSHM = limitValue.limitValueInSHM_;
 
     //! 更新 tsQue ，这里做了简单处理，不考虑重启以后第一次就触发风控的场景
     plugin_->getTDSrv()
@@ -495,13 +479,13 @@ FlowCtrlOnStepBase::numLimitWithInTimeCompareAndUpdate(
             [limitValueInSHM, now]() { limitValueInSHM->tsQue_->push(now); });
 
     L_T(plugin_->logger(), "Stash push action. keyOfTSQue = {}, ts = {} {}",
-        conditionValueInStrFmt, now, rule->toStr());
+        limitValue.conditionValueInStrFmt_, now, rule->toStr());
 
     L_T(plugin_->logger(),
         "{} {} - {} >= {} ? at first time, so not trigger. "
         "keyOfTSQue = {}, [tsQueSize = {}] ",
         rule->no_, now, limitValueInSHM->tsQue_->front(),
-        rule->limitValueInConf_.msInterval_, conditionValueInStrFmt,
+        rule->limitValueInConf_.msInterval_, limitValue.conditionValueInStrFmt_,
         limitValueInSHM->tsQue_->size());
 
     if (c2l.size() % 100 == 0) {
@@ -517,18 +501,18 @@ FlowCtrlOnStepBase::numLimitWithInTimeCompareAndUpdate(
 std::tuple<bool, std::string> FlowCtrlOnStepBase::numLimitWithInTimeCompare(
     const OrderInfoSPtr& orderInfo, std::uint32_t combNo,
     std::uint32_t threadNo, const FlowCtrlRuleSPtr& rule,
-    const std::string& conditionValueInStrFmt) {
+    const ConditionKey& conditionKey) {
   bool triggerRiskCtrl = false;
   std::string details;
 
-  LimitValueInSHM* limitValueInSHM = nullptr;
+  const LimitValueOfConditionValue* limitValue = nullptr;
 
   //! 先获取 limitValueInSHM
   const auto now = GetTotalMSSince1970();
   auto& c2l = rule->conditionValue2LimitValueGroup_;
-  const auto iter = c2l.find(conditionValueInStrFmt);
+  const auto iter = c2l.find(conditionKey);
   if (iter != std::end(c2l)) {
-    limitValueInSHM = iter->second;
+    limitValue = &iter->second;
   } else {
     /*
      * 如果没有下面的代码，那么假设已经到达触发风控的阈值，系统关闭重启，由于c2l
@@ -536,10 +520,10 @@ std::tuple<bool, std::string> FlowCtrlOnStepBase::numLimitWithInTimeCompare(
      * 后才会继续触发风控。
      */
     bool createTSQue = true;
-    limitValueInSHM = plugin_->openOrCtorLimitValue(
-        combNo, threadNo, rule, conditionValueInStrFmt, createTSQue);
-    c2l[conditionValueInStrFmt] = limitValueInSHM;
+    limitValue = &addLimitValue(orderInfo, combNo, threadNo, rule,
+                                conditionKey, createTSQue);
   }
+  const auto limitValueInSHM = limitValue->limitValueInSHM_;
 
   //! 先计算出假设当前订单报出的 curMSInterval
   const auto curMSInterval = now - limitValueInSHM->tsQue_->front();
@@ -564,8 +548,9 @@ std::tuple<bool, std::string> FlowCtrlOnStepBase::numLimitWithInTimeCompare(
         "[{}] {} - {} >= {} keyOfTSQue = {}, [tsQueSize = {}], "
         "so not trigger. {}",
         plugin_->name(), now, limitValueInSHM->tsQue_->front(),
-        rule->limitValueInConf_.msInterval_, conditionValueInStrFmt,
-        limitValueInSHM->tsQue_->size(), rule->toStr());
+        rule->limitValueInConf_.msInterval_,
+        limitValue->conditionValueInStrFmt_, limitValueInSHM->tsQue_->size(),
+        rule->toStr());
   }
 
   return {triggerRiskCtrl, details};
@@ -575,36 +560,37 @@ std::tuple<bool, std::string> FlowCtrlOnStepBase::numLimitWithInTimeCompare(
 void FlowCtrlOnStepBase::numLimitWithInTimeUpdate(
     const OrderInfoSPtr& orderInfo, std::uint32_t combNo,
     std::uint32_t threadNo, const FlowCtrlRuleSPtr& rule,
-    const std::string& conditionValueInStrFmt) {
+    const ConditionKey& conditionKey) {
   const auto now = GetTotalMSSince1970();
 
   auto& c2l = rule->conditionValue2LimitValueGroup_;
   //! 根据 "acctId=10000&marketCode=SSE" 找到 limitValue
-  const auto iter = c2l.find(conditionValueInStrFmt);
+  const auto iter = c2l.find(conditionKey);
   if (iter != std::end(c2l)) {
     //! 如果 "acctId=10000&marketCode=SSE" 对应的 limitValue 存在
-    auto limitValueInSHM = iter->second;
+    const auto& limitValue = iter->second;
+    auto limitValueInSHM = limitValue.limitValueInSHM_;
     plugin_->getTDSrv()
         ->getRiskCtrlModuleComb()[combNo]
         ->getRiskCtrlStatusUpdatersGroup()[threadNo]
         ->stash(
             [limitValueInSHM, now]() { limitValueInSHM->tsQue_->push(now); });
     L_T(plugin_->logger(), "Stash push action. keyOfTSQue = {}, ts = {} {}",
-        conditionValueInStrFmt, now, rule->toStr());
+        limitValue.conditionValueInStrFmt_, now, rule->toStr());
 
   } else {
     //! 如果该 conditionValue 是第一次进入风控检查
     bool createTSQue = true;
-    auto limitValueInSHM = plugin_->openOrCtorLimitValue(
-        combNo, threadNo, rule, conditionValueInStrFmt, createTSQue);
-    c2l[conditionValueInStrFmt] = limitValueInSHM;
+    const auto& limitValue = addLimitValue(orderInfo, combNo, threadNo, rule,
+                                           conditionKey, createTSQue);
+    auto limitValueInSHM = limitValue.limitValueInSHM_;
     plugin_->getTDSrv()
         ->getRiskCtrlModuleComb()[combNo]
         ->getRiskCtrlStatusUpdatersGroup()[threadNo]
         ->stash(
             [limitValueInSHM, now]() { limitValueInSHM->tsQue_->push(now); });
     L_T(plugin_->logger(), "Stash push action. keyOfTSQue = {}, ts = {} {}",
-        conditionValueInStrFmt, now, rule->toStr());
+        limitValue.conditionValueInStrFmt_, now, rule->toStr());
 
     if (c2l.size() % 100 == 0) {
       L_W(plugin_->logger(), "Size of risk ctrl list is {}. {}", c2l.size(),
@@ -613,12 +599,30 @@ void FlowCtrlOnStepBase::numLimitWithInTimeUpdate(
   }
 }
 
+//!
+//! 构建或者打开 limitValueInSHM 并加入 c2l，共享内存中 limitValueInSHM 的名字
+//! 仍然使用 "acctId=10000&marketCode=SSE" 这样的字符串，保证重启之后可以恢复
+//!
+const LimitValueOfConditionValue& FlowCtrlOnStepBase::addLimitValue(
+    const OrderInfoSPtr& orderInfo, std::uint32_t combNo,
+    std::uint32_t threadNo, const FlowCtrlRuleSPtr& rule,
+    const ConditionKey& conditionKey, bool createTSQue) {
+  auto conditionValueInStrFmt = MakeConditioFieldInfoInStrFmt(
+      orderInfo.get(), rule->conditionFieldGroup_);
+  auto limitValueInSHM = plugin_->openOrCtorLimitValue(
+      combNo, threadNo, rule, conditionValueInStrFmt, createTSQue);
+
+  auto& limitValue = rule->conditionValue2LimitValueGroup_[conditionKey];
+  limitValue.conditionValueInStrFmt_ = std::move(conditionValueInStrFmt);
+  limitValue.limitValueInSHM_ = limitValueInSHM;
+  return limitValue;
+}
+
 std::tuple<bool, std::string>
 FlowCtrlOnStepBase::checkIfTriggerFlowCtrlOfHoldInfo(
     const OrderInfoSPtr& orderInfo, std::uint32_t combNo,
     std::uint32_t threadNo, const FlowCtrlRuleSPtr& rule,
-    const std::string& conditionValueInStrFmt,
-    const ConditionFieldGroup& conditionFieldGroup) {
+    const ConditionKey& conditionKey) {
   Decimal newValue = 0;
 
   bool triggerRiskCtrl;
@@ -631,7 +635,7 @@ FlowCtrlOnStepBase::checkIfTriggerFlowCtrlOfHoldInfo(
           ->getRiskCtrlModuleComb()[combNo]
           ->getPosMgrGroup()[threadNo]
           ->getPosInfoGroup<LockFunc::False, DeepClone::False>(
-              rule->conditionTemplate_, conditionFieldGroup);
+              rule->compiledCondition_);
   for (const auto& posInfo : posInfoGroup) {
     switch (rule->target_) {
       case FlowCtrlTarget::HoldVolTotal:
@@ -652,7 +656,7 @@ FlowCtrlOnStepBase::checkIfTriggerFlowCtrlOfHoldInfo(
           ->getRiskCtrlModuleComb()[combNo]
           ->getOrdMgrGroup()[threadNo]
           ->getOrderInfoGroup<LockFunc::False, DeepClone::False>(
-              rule->conditionTemplate_, conditionFieldGroup);
+              rule->compiledCondition_);
   for (const auto& orderInfo : orderInfoGroup) {
     switch (rule->target_) {
       case FlowCtrlTarget::HoldVolTotal:
@@ -693,8 +697,7 @@ std::tuple<bool, std::string>
 FlowCtrlOnStepBase::checkIfTriggerFlowCtrlOfOpenTDay(
     const OrderInfoSPtr& orderInfo, std::uint32_t combNo,
     std::uint32_t threadNo, const FlowCtrlRuleSPtr& rule,
-    const std::string& conditionValueInStrFmt,
-    const ConditionFieldGroup& conditionFieldGroup) {
+    const ConditionKey& conditionKey) {
   Decimal newValue = 0;
 
   bool triggerRiskCtrl;
@@ -707,7 +710,7 @@ FlowCtrlOnStepBase::checkIfTriggerFlowCtrlOfOpenTDay(
           ->getRiskCtrlModuleComb()[combNo]
           ->getPosMgrGroup()[threadNo]
           ->getPosInfoGroup<LockFunc::False, DeepClone::False>(
-              rule->conditionTemplate_, conditionFieldGroup);
+              rule->compiledCondition_);
   for (const auto& posInfo : posInfoGroup) {
     newValue += std::fabs(posInfo->totalOpenSize_ - posInfo->preTotalOpenSize_);
   }
@@ -719,7 +722,7 @@ FlowCtrlOnStepBase::checkIfTriggerFlowCtrlOfOpenTDay(
           ->getRiskCtrlModuleComb()[combNo]
           ->getOrdMgrGroup()[threadNo]
           ->getOrderInfoGroup<LockFunc::False, DeepClone::False>(
-              rule->conditionTemplate_, conditionFieldGroup);
+              rule->compiledCondition_);
   for (const auto& orderInfo : orderInfoGroup) {
     newValue += orderInfo->getUndealedSize();
   }
@@ -149,7 +149,7 @@ void TDSrvRiskPluginFlowCtrlPlus::updateTsQueOfLimitValueInSHM(
     //! 下面代码如果配置中 tsQue 长度发生变化，那么会重建
     for (const auto& rec : rule->conditionValue2LimitValueGroup_) {
       //! conditionValueInStrFmt = "acctId=10000&trdAcctId=100000"
-      const auto& conditionValueInStrFmt = rec.first;
+      const auto& conditionValueInStrFmt = rec.second.conditionValueInStrFmt_;
       openOrCtorLimitValue(combNo, threadNo, rule, conditionValueInStrFmt,
                            createTSQue);
     }
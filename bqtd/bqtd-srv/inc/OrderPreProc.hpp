@@ -38,6 +38,8 @@ class OrderPreProc {
 
   void handle(const SHMIPCTaskSPtr& asyncTask);
 
+  OPOrdMgrSPtr getOrdMgr() const { return ordMgr_; }
+
  private:
   void initPosMgr();
   void initOrdMgr();
@@ -10,6 +10,7 @@
 
 #pragma ocne
 
+#include "SHMIPCMsgId.hpp"
 #include "TDSrvDef.hpp"
 #include "def/BQConst.hpp"
 #include "def/BQDef.hpp"
@@ -22,6 +23,16 @@ namespace bq {
 
 struct SHMIPCTask;
 using SHMIPCTaskSPtr = std::shared_ptr<SHMIPCTask>;
+template <typename Task>
+struct AsyncTask;
+using SHMIPCAsyncTask = AsyncTask<SHMIPCTaskSPtr>;
+using SHMIPCAsyncTaskSPtr = std::shared_ptr<SHMIPCAsyncTask>;
+
+struct OrderInfo;
+using OrderInfoSPtr = std::shared_ptr<OrderInfo>;
+
+class LatencyHistogram;
+using LatencyHistogramSPtr = std::shared_ptr<LatencyHistogram>;
 
 template <typename Task, BlockType blockType>
 class TaskDispatcher;
@@ -97,12 +108,37 @@ class RiskCtrlModule {
   std::uint64_t getHashFromTask(const SHMIPCTaskSPtr& task,
                                 const ConditionFieldGroup& conditionFieldGroup);
 
+  void initFusedWithPrev();
+
  public:
   int start();
 
  public:
   void stop();
 
+ public:
+  void handleAsyncTask(const SHMIPCAsyncTaskSPtr& asyncTask);
+
+  //!
+  //! 将订单相关的消息交给下一个风控模组：下一个模组和本模组融合的时候，直接在
+  //! 当前线程中处理，否则放入下一个模组的队列。
+  //!
+  void forwardToNextRiskCtrlModule(const OrderInfoSPtr& orderInfo, MsgId msgId);
+
+  //!
+  //! 开启fuseRiskCtrlModule之后，如果本模组和上一个模组的分区数量相同，并且分区
+  //! 字段相同或者只有一个分区，那么同一个订单在两个模组中一定落在编号相同的线程，
+  //! 本模组不再启动自己的线程，由上一个模组的线程直接调用，省掉一次队列切换。
+  //!
+  bool isFusedWithPrev() const { return fusedWithPrev_; }
+
+  //! 订单进入本模组的时延（微秒），第一个模组从策略引擎发出开始计算，其他模组
+  //! 从进入上一个模组开始计算，每个线程一个直方图
+  std::string getLatencyOfOrderInStrFmt() const;
+  std::vector<LatencyHistogramSPtr>& getLatencyHistogramGroup() {
+    return latencyHistogramGroup_;
+  }
+
  public:
   const RiskCtrlModuleConfSPtr& getTDSrvTaskDispatcherConf() {
     return tdSrvTaskDispatcherConf_;
@@ -150,6 +186,7 @@ class RiskCtrlModule {
   std::uint32_t no_{0};
 
   ConditionFieldGroup conditionFieldGroup_;
+  bool fusedWithPrev_{false};
 
   RiskCtrlModuleConfSPtr tdSrvTaskDispatcherConf_{nullptr};
 
@@ -166,6 +203,7 @@ class RiskCtrlModule {
   std::vector<FlowCtrlRuleMgrSPtr> flowCtrlRuleMgrGroup_;
   std::vector<TDPosMgrSPtr> posMgrGroup_;
   std::vector<TDOrdMgrSPtr> ordMgrGroup_;
+  std::vector<LatencyHistogramSPtr> latencyHistogramGroup_;
 
   TaskDispatcherSPtr<SHMIPCTaskSPtr, BlockType::Block> tdSrvTaskDispatcher_{
       nullptr};
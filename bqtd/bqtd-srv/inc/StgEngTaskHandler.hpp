@@ -40,6 +40,10 @@ class StgEngTaskHandler {
  public:
   void handleAsyncTask(const SHMIPCAsyncTaskSPtr& asyncTask);
 
+  //! 融合的风控模组直接调用，不经过队列
+  void handleOrder(const OrderInfoSPtr& ordReq);
+  void handleCancelOrder(const OrderInfoSPtr& ordReq);
+
  private:
   void handleMsgIdOnRiskCtrlConfChg(const SHMIPCAsyncTaskSPtr& asyncTask);
 
@@ -19,6 +19,9 @@ template <typename Task>
 struct AsyncTask;
 using SHMIPCAsyncTask = AsyncTask<SHMIPCTaskSPtr>;
 using SHMIPCAsyncTaskSPtr = std::shared_ptr<SHMIPCAsyncTask>;
+
+struct OrderInfo;
+using OrderInfoSPtr = std::shared_ptr<OrderInfo>;
 }  // namespace bq
 
 namespace bq::td::srv {
@@ -37,6 +40,10 @@ class TDGWTaskHandler {
  public:
   void handleAsyncTask(const SHMIPCAsyncTaskSPtr& asyncTask);
 
+  //! 融合的风控模组直接调用，不经过队列
+  void handleOrderRet(const OrderInfoSPtr& ordRet);
+  void handleCancelOrderRet(const OrderInfoSPtr& ordRet);
+
  private:
   void handleMsgIdOnOrderRet(const SHMIPCAsyncTaskSPtr& asyncTask);
   void handleMsgIdOnCancelOrderRet(const SHMIPCAsyncTaskSPtr& asyncTask);
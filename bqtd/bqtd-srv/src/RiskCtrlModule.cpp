@@ -18,6 +18,7 @@
 #include "PosMgr.hpp"
 #include "RiskCtrlStatusUpdaters.hpp"
 #include "SHMIPC.hpp"
+#include "SHMIPCTask.hpp"
 #include "SelfTradeCtrlRangeMgr.hpp"
 #include "StgEngTaskHandler.hpp"
 #include "TDGWTaskHandler.hpp"
@@ -35,6 +36,7 @@
 #include "def/DataStruOfOthers.hpp"
 #include "def/PosInfo.hpp"
 #include "util/BQUtil.hpp"
+#include "util/LatencyHistogram.hpp"
 #include "util/Literal.hpp"
 #include "util/Logger.hpp"
 #include "util/StdExt.hpp"
@@ -109,6 +111,11 @@ int RiskCtrlModule::init() {
   //! 初始化订单管理服务数组
   initOrdMgr(threadPoolSize);
 
+  //! 初始化每个分区的时延统计
+  for (std::uint32_t threadNo = 0; threadNo < threadPoolSize; ++threadNo) {
+    latencyHistogramGroup_.emplace_back(std::make_shared<LatencyHistogram>());
+  }
+
   //! 获取当前分区名和分区字段数组
   const auto fieldGroupUsedToGenHash =
       tdSrvTaskDispatcherConf_->fieldGroupUsedToGenHash_;
@@ -133,36 +140,7 @@ int RiskCtrlModule::init() {
   };
 
   const auto handleAsyncTask = [this](auto& asyncTask) {
-    const auto shmHeader =
-        static_cast<const SHMHeader*>(asyncTask->task_->data_);
-    switch (shmHeader->msgId_) {
-      case MSG_ID_ON_RISK_CTRL_CONF_CHG:
-        stgEngTaskHandler_->handleAsyncTask(asyncTask);
-        break;
-      case MSG_ID_ON_ORDER:
-        stgEngTaskHandler_->handleAsyncTask(asyncTask);
-        break;
-      case MSG_ID_ON_CANCEL_ORDER:
-        stgEngTaskHandler_->handleAsyncTask(asyncTask);
-        break;
-      case MSG_ID_ON_STG_REG:
-        stgEngTaskHandler_->handleAsyncTask(asyncTask);
-        break;
-
-      case MSG_ID_ON_ORDER_RET:
-        tdGWTaskHandler_->handleAsyncTask(asyncTask);
-        break;
-      case MSG_ID_ON_CANCEL_ORDER_RET:
-        tdGWTaskHandler_->handleAsyncTask(asyncTask);
-        break;
-      case MSG_ID_ON_TDGW_REG:
-        tdGWTaskHandler_->handleAsyncTask(asyncTask);
-        break;
-
-      default:
-        LOG_W("[{}] Unable to process msgId {}.", no_, shmHeader->msgId_);
-        break;
-    }
+    this->handleAsyncTask(asyncTask);
   };
 
   tdSrvTaskDispatcher_ = std::make_shared<TaskDispatcher<SHMIPCTaskSPtr>>(
@@ -170,6 +148,9 @@ int RiskCtrlModule::init() {
       handleAsyncTask);
   tdSrvTaskDispatcher_->init();
 
+  //! 上一个模组已经初始化完成，判断能否和上一个模组融合
+  initFusedWithPrev();
+
   //! 构造的时候会用shm创建一些数据结构，因此放在后面
   tdSrvRiskPluginMgr_->load();
 
@@ -333,11 +314,116 @@ std::uint64_t RiskCtrlModule::getHashFromTask(
   return ret;
 }
 
+void RiskCtrlModule::initFusedWithPrev() {
+  if (no_ == 0 || CONFIG["fuseRiskCtrlModule"].as<bool>(false) == false) {
+    return;
+  }
+
+  const auto& prev = tdSrv_->getRiskCtrlModuleComb()[no_ - 1];
+  const auto threadPoolSizeOfPrev =
+      prev->tdSrvTaskDispatcher_->getTaskDispatcherParam()
+          ->taskSpecificThreadPoolSize_;
+  const auto threadPoolSize =
+      tdSrvTaskDispatcher_->getTaskDispatcherParam()
+          ->taskSpecificThreadPoolSize_;
+  if (threadPoolSize != threadPoolSizeOfPrev) {
+    return;
+  }
+
+  if (threadPoolSize == 1 ||
+      conditionFieldGroup_ == prev->conditionFieldGroup_) {
+    fusedWithPrev_ = true;
+    LOG_I("[{}] Risk ctrl module {} is fused with {}. [threadPoolSize = {}]",
+          no_, tdSrvTaskDispatcherConf_->step_,
+          prev->tdSrvTaskDispatcherConf_->step_, threadPoolSize);
+  }
+}
+
 int RiskCtrlModule::start() {
+  //! 融合的模组由上一个模组的线程调用，不启动自己的线程
+  if (fusedWithPrev_) return 0;
   tdSrvTaskDispatcher_->start();
   return 0;
 }
 
-void RiskCtrlModule::stop() { tdSrvTaskDispatcher_->stop(); }
+void RiskCtrlModule::stop() {
+  if (fusedWithPrev_) return;
+  tdSrvTaskDispatcher_->stop();
+}
+
+void RiskCtrlModule::handleAsyncTask(const SHMIPCAsyncTaskSPtr& asyncTask) {
+  const auto shmHeader = static_cast<const SHMHeader*>(asyncTask->task_->data_);
+  switch (shmHeader->msgId_) {
+    case MSG_ID_ON_RISK_CTRL_CONF_CHG:
+      stgEngTaskHandler_->handleAsyncTask(asyncTask);
+      break;
+    case MSG_ID_ON_ORDER:
+      stgEngTaskHandler_->handleAsyncTask(asyncTask);
+      break;
+    case MSG_ID_ON_CANCEL_ORDER:
+      stgEngTaskHandler_->handleAsyncTask(asyncTask);
+      break;
+    case MSG_ID_ON_STG_REG:
+      stgEngTaskHandler_->handleAsyncTask(asyncTask);
+      break;
+
+    case MSG_ID_ON_ORDER_RET:
+      tdGWTaskHandler_->handleAsyncTask(asyncTask);
+      break;
+    case MSG_ID_ON_CANCEL_ORDER_RET:
+      tdGWTaskHandler_->handleAsyncTask(asyncTask);
+      break;
+    case MSG_ID_ON_TDGW_REG:
+      tdGWTaskHandler_->handleAsyncTask(asyncTask);
+      break;
+
+    default:
+      LOG_W("[{}] Unable to process msgId {}.", no_, shmHeader->msgId_);
+      break;
+  }
+}
+
+void RiskCtrlModule::forwardToNextRiskCtrlModule(
+    const OrderInfoSPtr& orderInfo, MsgId msgId) {
+  const auto& next = tdSrv_->getRiskCtrlModuleComb()[no_ + 1];
+  if (!next->isFusedWithPrev()) {
+    auto task =
+        std::make_shared<SHMIPCTask>(orderInfo.get(), orderInfo->size());
+    next->getTDSrvTaskDispatcher()->dispatch(task);
+    return;
+  }
+
+  //! 每个风控模组保存的是各自的订单副本，所以这里仍然需要复制一份
+  auto buf = malloc(orderInfo->size());
+  memcpy(buf, orderInfo.get(), orderInfo->size());
+  const auto orderInfoOfNext = MakeMsgSPtrByTask<OrderInfo>(buf);
+  switch (msgId) {
+    case MSG_ID_ON_ORDER:
+      next->stgEngTaskHandler_->handleOrder(orderInfoOfNext);
+      break;
+    case MSG_ID_ON_CANCEL_ORDER:
+      next->stgEngTaskHandler_->handleCancelOrder(orderInfoOfNext);
+      break;
+    case MSG_ID_ON_ORDER_RET:
+      next->tdGWTaskHandler_->handleOrderRet(orderInfoOfNext);
+      break;
+    case MSG_ID_ON_CANCEL_ORDER_RET:
+      next->tdGWTaskHandler_->handleCancelOrderRet(orderInfoOfNext);
+      break;
+    default:
+      LOG_W("[{}] Unable to forward msgId {}.", no_, msgId);
+      break;
+  }
+}
+
+std::string RiskCtrlModule::getLatencyOfOrderInStrFmt() const {
+  LatencyHistogramData latencyHistogramData;
+  for (const auto& latencyHistogram : latencyHistogramGroup_) {
+    latencyHistogramData.merge(latencyHistogram->getData());
+  }
+  return fmt::format("[{}] [{}] [fused = {}] {}", no_,
+                     tdSrvTaskDispatcherConf_->step_, fusedWithPrev_,
+                     latencyHistogramData.toStr());
+}
 
 }  // namespace bq::td::srv
@@ -33,6 +33,8 @@
 #include "def/StatusCode.hpp"
 #include "def/SyncTask.hpp"
 #include "util/Datetime.hpp"
+#include "util/LatencyHistogram.hpp"
+#include "util/LatencyTrace.hpp"
 #include "util/StdExt.hpp"
 #include "util/TaskDispatcher.hpp"
 #include "util/Util.hpp"
@@ -79,21 +81,42 @@ void StgEngTaskHandler::handleMsgIdOnRiskCtrlConfChg(
       ->onRiskCtrlConfChg(conf, no_, threadNo);
 
   if (!tdSrv_->isLastRiskCtrlModule(no_)) {
-    //! 因为投递用的dispatchToAllThread所以第一个线程投递即可，不然会重复投递
-    if (threadNo == 0) {
+    const auto& next = tdSrv_->getRiskCtrlModuleComb()[no_ + 1];
+    if (next->isFusedWithPrev()) {
+      //! 融合的模组和本模组线程一一对应，每个线程各自交给下一个模组处理
+      next->handleAsyncTask(asyncTask);
+    } else if (threadNo == 0) {
+      //! 因为投递用的dispatchToAllThread所以第一个线程投递即可，不然会重复投递
       auto task = std::make_shared<SHMIPCTask>(
           commonIPCData.get(), sizeof(CommonIPCData) + commonIPCData->dataLen_);
       auto asyncTask = std::make_shared<SHMIPCAsyncTask>(task, std::any());
-      tdSrv_->getRiskCtrlModuleComb()[no_ + 1]
-          ->getTDSrvTaskDispatcher()
-          ->dispatchToAllThread(asyncTask);
+      next->getTDSrvTaskDispatcher()->dispatchToAllThread(asyncTask);
     }
   }
 }
 
 void StgEngTaskHandler::handleMsgIdOnOrder(
     const AsyncTaskSPtr<SHMIPCTaskSPtr>& asyncTask) {
-  auto ordReq = MakeMsgSPtrByTask<OrderInfo>(asyncTask->task_);
+  const auto ordReq = MakeMsgSPtrByTask<OrderInfo>(asyncTask->task_);
+  if (tdSrv_->isFirstRiskCtrlModule(no_)) {
+    LatencyTrace::get_mutable_instance().stamp(ordReq->traceCtx_,
+                                               TraceHop::TDSrvRecv);
+  }
+  handleOrder(ordReq);
+}
+
+void StgEngTaskHandler::handleOrder(const OrderInfoSPtr& ordReq) {
+  const auto threadNo = std::ext::tls_get<ThreadInfo>().no_;
+  //! 每个模组只统计和上一个模组之间的时延，而不是从下单开始的累计时延
+  const auto now = GetTotalUSSince1970();
+  const auto tsOfPrev = tdSrv_->isFirstRiskCtrlModule(no_)
+                            ? ordReq->orderTime_
+                            : ordReq->tsOfPrevRiskCtrlModule_;
+  tdSrv_->getRiskCtrlModuleComb()[no_]
+      ->getLatencyHistogramGroup()[threadNo]
+      ->record(now > tsOfPrev ? now - tsOfPrev : 0);
+  ordReq->tsOfPrevRiskCtrlModule_ = now;
+
 #ifndef OPT_LOG
   LOG_I("[{}] Recv order {}", no_, ordReq->toShortStr());
 #endif
@@ -130,7 +153,6 @@ void StgEngTaskHandler::handleMsgIdOnOrder(
    *
    */
 
-  const auto threadNo = std::ext::tls_get<ThreadInfo>().no_;
   const auto ret = tdSrv_->getRiskCtrlModuleComb()[no_]
                        ->getOrdMgrGroup()[threadNo]
                        ->add<LockFunc::False, DeepClone::False>(ordReq);
@@ -186,7 +208,7 @@ void StgEngTaskHandler::handleMsgIdOnOrder(
     //! 移除OrdMgr中的订单
     tdSrv_->getRiskCtrlModuleComb()[no_]
         ->getOrdMgrGroup()[threadNo]
-        ->remove<LockFunc::False>(ordReq->orderId_);
+        ->remove<LockFunc::False>(ordReq->orderId_, ordReq->acctId_);
 
     //! cache task of sync group
     tdSrv_->cacheSyncTaskGroup(MSG_ID_ON_ORDER_RET, ordReq,
@@ -194,6 +216,9 @@ void StgEngTaskHandler::handleMsgIdOnOrder(
     return;
   }
 
+  LatencyTrace::get_mutable_instance().stamp(ordReq->traceCtx_,
+                                             GetTraceHopOfRiskCtrlModule(no_));
+
   if (tdSrv_->isLastRiskCtrlModule(no_)) {
     tdSrv_->getSHMSrvOfTDGW()->pushMsgWithZeroCopy(
         [&](void* shmBuf) {
@@ -206,10 +231,8 @@ void StgEngTaskHandler::handleMsgIdOnOrder(
         ordReq->acctId_, MSG_ID_ON_ORDER, ordReq->size());
 
   } else {
-    auto task = std::make_shared<SHMIPCTask>(ordReq.get(), ordReq->size());
-    tdSrv_->getRiskCtrlModuleComb()[no_ + 1]
-        ->getTDSrvTaskDispatcher()
-        ->dispatch(task);
+    tdSrv_->getRiskCtrlModuleComb()[no_]->forwardToNextRiskCtrlModule(
+        ordReq, MSG_ID_ON_ORDER);
   }
 
   //! 批量更新风控状态变化，优先发送报单
@@ -227,7 +250,11 @@ void StgEngTaskHandler::handleMsgIdOnOrder(
 
 void StgEngTaskHandler::handleMsgIdOnCancelOrder(
     const AsyncTaskSPtr<SHMIPCTaskSPtr>& asyncTask) {
-  auto ordReq = MakeMsgSPtrByTask<OrderInfo>(asyncTask->task_);
+  const auto ordReq = MakeMsgSPtrByTask<OrderInfo>(asyncTask->task_);
+  handleCancelOrder(ordReq);
+}
+
+void StgEngTaskHandler::handleCancelOrder(const OrderInfoSPtr& ordReq) {
 
   if (tdSrv_->isFirstRiskCtrlModule(no_)) {
     if (tdSrv_->getTDGWGroup()->exists(ordReq->acctId_) == false) {
@@ -292,10 +319,8 @@ void StgEngTaskHandler::handleMsgIdOnCancelOrder(
         ordReq->acctId_, MSG_ID_ON_CANCEL_ORDER, ordReq->size());
 
   } else {
-    auto task = std::make_shared<SHMIPCTask>(ordReq.get(), ordReq->size());
-    tdSrv_->getRiskCtrlModuleComb()[no_ + 1]
-        ->getTDSrvTaskDispatcher()
-        ->dispatch(task);
+    tdSrv_->getRiskCtrlModuleComb()[no_]->forwardToNextRiskCtrlModule(
+        ordReq, MSG_ID_ON_CANCEL_ORDER);
   }
 
   //! 批量更新风控状态变化，优先发送撤单应答
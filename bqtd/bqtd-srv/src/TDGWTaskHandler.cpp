@@ -59,6 +59,10 @@ void TDGWTaskHandler::handleAsyncTask(const SHMIPCAsyncTaskSPtr& asyncTask) {
 void TDGWTaskHandler::handleMsgIdOnOrderRet(
     const SHMIPCAsyncTaskSPtr& asyncTask) {
   const auto ordRet = MakeMsgSPtrByTask<OrderInfo>(asyncTask->task_);
+  handleOrderRet(ordRet);
+}
+
+void TDGWTaskHandler::handleOrderRet(const OrderInfoSPtr& ordRet) {
 #ifndef OPT_LOG
   LOG_I("[{}] Recv order ret {}", no_, ordRet->toShortStr());
 #endif
@@ -135,16 +139,18 @@ void TDGWTaskHandler::handleMsgIdOnOrderRet(
 
   //! 将消息丢给下一个风控模组
   if (!tdSrv_->isLastRiskCtrlModule(no_)) {
-    auto task = std::make_shared<SHMIPCTask>(ordRet.get(), ordRet->size());
-    tdSrv_->getRiskCtrlModuleComb()[no_ + 1]
-        ->getTDSrvTaskDispatcher()
-        ->dispatch(task);
+    tdSrv_->getRiskCtrlModuleComb()[no_]->forwardToNextRiskCtrlModule(
+        ordRet, MSG_ID_ON_ORDER_RET);
   }
 }
 
 void TDGWTaskHandler::handleMsgIdOnCancelOrderRet(
     const SHMIPCAsyncTaskSPtr& asyncTask) {
-  auto ordRet = MakeMsgSPtrByTask<OrderInfo>(asyncTask->task_);
+  const auto ordRet = MakeMsgSPtrByTask<OrderInfo>(asyncTask->task_);
+  handleCancelOrderRet(ordRet);
+}
+
+void TDGWTaskHandler::handleCancelOrderRet(const OrderInfoSPtr& ordRet) {
   LOG_I("[{}] Recv cancel order ret {}", no_, ordRet->toShortStr());
 
   //! 优先发送应答给策略
@@ -187,10 +193,8 @@ void TDGWTaskHandler::handleMsgIdOnCancelOrderRet(
 
   //! 将消息丢给下一个风控模组
   if (!tdSrv_->isLastRiskCtrlModule(no_)) {
-    auto task = std::make_shared<SHMIPCTask>(ordRet.get(), ordRet->size());
-    tdSrv_->getRiskCtrlModuleComb()[no_ + 1]
-        ->getTDSrvTaskDispatcher()
-        ->dispatch(task);
+    tdSrv_->getRiskCtrlModuleComb()[no_]->forwardToNextRiskCtrlModule(
+        ordRet, MSG_ID_ON_CANCEL_ORDER_RET);
   }
 }
 
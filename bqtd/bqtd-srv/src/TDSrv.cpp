@@ -40,6 +40,7 @@
 #include "def/PosInfo.hpp"
 #include "def/SyncTask.hpp"
 #include "util/BQUtil.hpp"
+#include "util/LatencyTrace.hpp"
 #include "util/Literal.hpp"
 #include "util/Logger.hpp"
 #include "util/ScheduleTaskBundle.hpp"
@@ -66,6 +67,11 @@ int TDSrv::prepareInit() {
     return ret;
   }
 
+  //! 时延追踪默认关闭，开启后向进程发送SIGUSR1输出各环节的时延分布
+  if (CONFIG["enableLatencyTrace"].as<bool>(false)) {
+    LatencyTrace::get_mutable_instance().enable();
+  }
+
   return 0;
 }
 
@@ -237,6 +243,9 @@ void TDSrv::initSHMSrv() {
         auto task = std::make_shared<SHMIPCTask>(shmBuf, shmBufLen);
         orderPreProc_->handle(task);
       });
+  //! 对时延敏感的通道可以配置为绑核轮询，见SHMIPCRecvParam
+  shmSrvOfTDGW_->setRecvParam(
+      CONFIG["recvParamOfTDGWChannel"].as<std::string>(""));
 
   const auto stgEngAddr =
       fmt::format("{}@{}", AppName, CONFIG["stgEngChannel"].as<std::string>());
@@ -245,6 +254,8 @@ void TDSrv::initSHMSrv() {
         auto task = std::make_shared<SHMIPCTask>(shmBuf, shmBufLen);
         orderPreProc_->handle(task);
       });
+  shmSrvOfStgEng_->setRecvParam(
+      CONFIG["recvParamOfStgEngChannel"].as<std::string>(""));
 
   plugInChannel_ = CONFIG["plugInChannel"].as<std::string>();
   const auto plugInAddr = fmt::format("{}@{}", AppName, plugInChannel_);
@@ -287,6 +298,36 @@ void TDSrv::initScheduleTaskBundle() {
         return true;
       },
       ExecAtStartup::False, milliSecIntervalRiskCtrlConfMonitor));
+
+  const auto milliSecIntervalOfLogLatencyOfRiskCtrlModule =
+      CONFIG["milliSecIntervalOfLogLatencyOfRiskCtrlModule"].as<std::uint32_t>(
+          60000);
+  getScheduleTaskBundle()->emplace_back(std::make_shared<ScheduleTask>(
+      "logLatencyOfRiskCtrlModule",
+      [this]() {
+        for (const auto& riskCtrlModule : riskCtrlModuleComb_) {
+          LOG_I("Latency of order in risk ctrl module(us): {}",
+                riskCtrlModule->getLatencyOfOrderInStrFmt());
+        }
+        return true;
+      },
+      ExecAtStartup::False, milliSecIntervalOfLogLatencyOfRiskCtrlModule));
+
+  //! 风控模组中的OrdMgr只在所属线程中访问，不加锁，这里只通知所属线程淘汰
+  const auto milliSecIntervalOfEvictClosedOrder =
+      CONFIG["milliSecIntervalOfEvictClosedOrder"].as<std::uint32_t>(60000);
+  getScheduleTaskBundle()->emplace_back(std::make_shared<ScheduleTask>(
+      "evictClosedOrder",
+      [this]() {
+        orderPreProc_->getOrdMgr()->requestEviction();
+        for (const auto& riskCtrlModule : riskCtrlModuleComb_) {
+          for (const auto& ordMgr : riskCtrlModule->getOrdMgrGroup()) {
+            ordMgr->requestEviction();
+          }
+        }
+        return true;
+      },
+      ExecAtStartup::False, milliSecIntervalOfEvictClosedOrder));
 }
 
 int TDSrv::doRun() {
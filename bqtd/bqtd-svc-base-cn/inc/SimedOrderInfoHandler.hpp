@@ -15,12 +15,27 @@
 #include "def/Const.hpp"
 #include "def/Def.hpp"
 #include "util/Pch.hpp"
+#include "util/StdExt.hpp"
 
 namespace bq {
 struct OrderInfo;
 using OrderInfoSPTr = std::shared_ptr<OrderInfo>;
 struct SimedTDInfo;
 using SimedTDInfoSPtr = std::shared_ptr<SimedTDInfo>;
+
+template <typename Task, BlockType blockType>
+class TaskDispatcher;
+template <typename Task, BlockType blockType>
+using TaskDispatcherSPtr = std::shared_ptr<TaskDispatcher<Task, blockType>>;
+
+class SimedMatchingEngine;
+using SimedMatchingEngineSPtr = std::shared_ptr<SimedMatchingEngine>;
+
+class SubMgr;
+using SubMgrSPtr = std::shared_ptr<SubMgr>;
+
+class BooksRebuilder;
+using BooksRebuilderSPtr = std::shared_ptr<BooksRebuilder>;
 }  // namespace bq
 
 namespace bq::db::symbolInfo {
@@ -42,6 +57,11 @@ class SimedOrderInfoHandler {
 
   explicit SimedOrderInfoHandler(TDSvcOfCN* tdSvc);
 
+ public:
+  int init();
+  void start();
+  void stop();
+
  public:
   void simOnOrder(OrderInfoSPTr& ordReq);
 
@@ -64,6 +84,20 @@ class SimedOrderInfoHandler {
  public:
   void simOnCancelOrder(OrderInfoSPTr& ordReq);
 
+ private:
+  int initSimedMatchingEngine();
+  void initSubMgr();
+
+  void simOnOrderByMatchingEngine(OrderInfoSPTr& ordReq);
+  void simOnCancelOrderByMatchingEngine(OrderInfoSPTr& ordReq);
+  int subMDOfSymbol(const OrderInfoSPTr& ordReq);
+
+  void handleTaskOfMatchingEngine(const SHMIPCAsyncTaskSPtr& asyncTask);
+  void onSimedOrderRet(const OrderInfoSPTr& orderInfo, MsgId msgId,
+                       LiquidityDirection liquidityDirection);
+
+  static std::string GetSymbolCodeOfTask(const SHMIPCTaskSPtr& task);
+
  private:
   TDSvcOfCN* tdSvc_;
 
@@ -71,6 +105,17 @@ class SimedOrderInfoHandler {
   Decimal feeRatioOfMaker_;
   Decimal feeRatioOfTaker_;
   std::uint32_t milliSecIntervalOfSimOrderStatus_{0};
+
+  //! 根据订单簿和逐笔成交撮合模拟订单，按品种分片到不同的线程
+  bool simedMatchingEngineEnabled_{false};
+  std::vector<SimedMatchingEngineSPtr> simedMatchingEngineGroup_;
+  TaskDispatcherSPtr<SHMIPCTaskSPtr, BlockType::Block>
+      taskDispatcherOfMatchingEngine_{nullptr};
+
+  BooksRebuilderSPtr booksRebuilder_{nullptr};
+  SubMgrSPtr subMgr_{nullptr};
+  std::set<std::string> topicGroupSubed_;
+  std::ext::spin_mutex mtxTopicGroupSubed_;
 };
 
 }  // namespace bq::td::svc
@@ -206,7 +206,8 @@ class TDSvcOfCN : public SvcBase {
   AcctId acctId_;
   std::string apiName_;
 
-  std::uint64_t maxNoUsedToCalcPos_{0};
+  //! 模拟撮合引擎的多个线程会同时生成回报
+  std::atomic<std::uint64_t> maxNoUsedToCalcPos_{0};
 
   //! "TD-XTP-INSTANCE-10001@TD@TDGWChannel@Trade"
   std::string appName_;
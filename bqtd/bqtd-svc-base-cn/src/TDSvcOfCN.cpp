@@ -34,6 +34,7 @@
 #include "util/ExternalStatusCodeCache.hpp"
 #include "util/FeeInfoCache.hpp"
 #include "util/FlowCtrlSvc.hpp"
+#include "util/LatencyTrace.hpp"
 #include "util/Literal.hpp"
 #include "util/MapRelOfCliIdAndOrdId.hpp"
 #include "util/OpenedContractGroup.hpp"
@@ -67,6 +68,11 @@ int TDSvcOfCN::prepareInit() {
   acctId_ = CONFIG["acctId"].as<AcctId>();
   apiName_ = CONFIG["api"]["apiName"].as<std::string>();
 
+  //! 时延追踪默认关闭，开启后向进程发送SIGUSR1输出各环节的时延分布
+  if (CONFIG["enableLatencyTrace"].as<bool>(false)) {
+    LatencyTrace::get_mutable_instance().enable();
+  }
+
   return 0;
 }
 
@@ -103,6 +109,10 @@ int TDSvcOfCN::doInit() {
   if (CONFIG["simedMode"]["enabled"].as<bool>(false) == true) {
     //! 模拟成交模式
     simedOrderInfoHandler_ = std::make_shared<SimedOrderInfoHandler>(this);
+    if (const auto ret = simedOrderInfoHandler_->init(); ret != 0) {
+      LOG_E("Do init failed.");
+      return ret;
+    }
   } else {
     //! 实盘模式
     assert(tdGateway_ != nullptr && "tdGateway_ != nullptr");
@@ -226,7 +236,7 @@ int TDSvcOfCN::queryMaxNoUsedToCalcPos() {
     maxNoUsedToCalcPos_ = orderInfo->getRecWithAllFields()->noUsedToCalcPos;
   }
   LOG_I("Query maxNoUsedToCalcPos success. [maxNoUsedToCalcPos = {}]",
-        maxNoUsedToCalcPos_);
+        maxNoUsedToCalcPos_.load());
 
   return 0;
 }
@@ -304,6 +314,9 @@ void TDSvcOfCN::initSHMCliOfTDSrv() {
 
   shmCliOfTDSrv_ = std::make_shared<SHMCli>(addr, onSHMDataRecv);
   shmCliOfTDSrv_->setClientChannel(acctId_);
+  //! 对时延敏感的通道可以配置为绑核轮询，见SHMIPCRecvParam
+  shmCliOfTDSrv_->setRecvParam(
+      CONFIG["recvParamOfTDSrvChannel"].as<std::string>(""));
 }
 
 void TDSvcOfCN::initSHMCliOfRiskMgr() {
@@ -444,6 +457,10 @@ int TDSvcOfCN::doRun() {
     }
   }
 
+  if (CONFIG["simedMode"]["enabled"].as<bool>(false) == true) {
+    simedOrderInfoHandler_->start();
+  }
+
   tdSrvTaskDispatcher_->start();
   shmCliOfTDSrv_->start();
 
@@ -586,6 +603,9 @@ void TDSvcOfCN::doExit(const boost::system::error_code* ec, int signalNum) {
   shmCliOfRiskMgr_->stop();
   shmCliOfTDSrv_->stop();
   tdSrvTaskDispatcher_->stop();
+  if (CONFIG["simedMode"]["enabled"].as<bool>(false) == true) {
+    simedOrderInfoHandler_->stop();
+  }
   if (CONFIG["simedMode"]["enabled"].as<bool>(false) == false) {
     tdGateway_->stop();
   }
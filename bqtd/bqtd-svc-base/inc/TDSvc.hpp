@@ -225,7 +225,8 @@ class TDSvc : public SvcBase {
   MarketCode marketCodeEnum_;
   SymbolType symbolTypeEnum_;
 
-  std::uint64_t maxNoUsedToCalcPos_{0};
+  //! 模拟撮合引擎的多个线程会同时生成回报
+  std::atomic<std::uint64_t> maxNoUsedToCalcPos_{0};
 
   //! "TD-Binance-Spot-10000@TD@TDGWChannel@Trade"
   std::string appName_;
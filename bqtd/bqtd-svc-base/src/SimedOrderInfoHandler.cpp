@@ -28,11 +28,17 @@
 #include "def/SimedTDInfo.hpp"
 #include "def/StatusCode.hpp"
 #include "def/SyncTask.hpp"
+#include "util/BQUtil.hpp"
+#include "util/BooksRebuilder.hpp"
 #include "util/Datetime.hpp"
 #include "util/Decimal.hpp"
 #include "util/FeeUtil.hpp"
 #include "util/Logger.hpp"
 #include "util/Random.hpp"
+#include "util/SimedMatchingEngine.hpp"
+#include "util/String.hpp"
+#include "util/SubMgr.hpp"
+#include "util/TaskDispatcher.hpp"
 
 namespace bq::td::svc {
 
@@ -45,14 +51,48 @@ SimedOrderInfoHandler::SimedOrderInfoHandler(TDSvc* tdSvc) : tdSvc_(tdSvc) {
           0);
 }
 
+int SimedOrderInfoHandler::init() {
+  simedMatchingEngineEnabled_ =
+      CONFIG["simedMode"]["matchingEngine"]["enabled"].as<bool>(false);
+  if (simedMatchingEngineEnabled_ == false) {
+    return 0;
+  }
+
+  if (const auto ret = initSimedMatchingEngine(); ret != 0) {
+    LOG_E("Init simed matching engine failed.");
+    return ret;
+  }
+  initSubMgr();
+
+  return 0;
+}
+
+void SimedOrderInfoHandler::start() {
+  if (simedMatchingEngineEnabled_ == false) return;
+  taskDispatcherOfMatchingEngine_->start();
+  subMgr_->start();
+}
+
+void SimedOrderInfoHandler::stop() {
+  if (simedMatchingEngineEnabled_ == false) return;
+  subMgr_->stop();
+  taskDispatcherOfMatchingEngine_->stop();
+}
+
 void SimedOrderInfoHandler::simOnOrder(OrderInfoSPtr& ordReq) {
+  if (simedMatchingEngineEnabled_) {
+    simOnOrderByMatchingEngine(ordReq);
+    return;
+  }
+
   const auto [statusCode, simedTDInfo] = MakeSimedTDInfo(ordReq->extData_);
   if (statusCode != 0) {
     ordReq->orderStatus_ = OrderStatus::Failed;
     ordReq->statusCode_ = statusCode;
     LOG_W("Handle order in simed td mode failed. [{} - {}] {}", statusCode,
           GetStatusMsg(statusCode), ordReq->toShortStr());
-    tdSvc_->getOrdMgr()->remove<LockFunc::True>(ordReq->orderId_);
+    tdSvc_->getOrdMgr()->remove<LockFunc::True>(ordReq->orderId_,
+                                                ordReq->acctId_);
     tdSvc_->getSHMCliOfTDSrv()->asyncSendMsgWithZeroCopy(
         [&](void* shmBuf) {
           InitMsgBodyExt(shmBuf, *ordReq);
@@ -116,7 +156,8 @@ db::symbolInfo::RecordSPtr SimedOrderInfoHandler::simOnOrderConfirmedByExch(
         marketCode, ordReq->symbolCode_, statusCode, GetStatusMsg(statusCode));
     ordReq->orderStatus_ = OrderStatus::Failed;
     ordReq->statusCode_ = statusCode;
-    tdSvc_->getOrdMgr()->remove<LockFunc::True>(ordReq->orderId_);
+    tdSvc_->getOrdMgr()->remove<LockFunc::True>(ordReq->orderId_,
+                                                ordReq->acctId_);
     tdSvc_->getSHMCliOfTDSrv()->asyncSendMsgWithZeroCopy(
         [&](void* shmBuf) {
           InitMsgBodyExt(shmBuf, *ordReq);
@@ -190,32 +231,10 @@ void SimedOrderInfoHandler::simOnOrderFilled(
       ordReq->orderStatus_ = OrderStatus::Filled;
     }
 
-    const auto lastTradeId = fmt::format("{}", GET_RAND_INT());
-    strncpy(ordReq->lastTradeId_, lastTradeId.c_str(),
-            sizeof(ordReq->lastTradeId_) - 1);
-    if (ordReq->side_ == Side::Bid) {
-      ordReq->lastDealSize_ =
-          ordReq->orderSize_ * simedTDInfo->transDetailGroup_[i]->filledPer_;
-      ordReq->lastDealPrice_ =
-          ordReq->orderPrice_ -
-          ordReq->orderPrice_ * simedTDInfo->transDetailGroup_[i]->slippage_;
-    } else {
-      ordReq->lastDealSize_ = ordReq->orderSize_ *
-                              simedTDInfo->transDetailGroup_[i]->filledPer_ *
-                              -1;
-      ordReq->lastDealPrice_ =
-          ordReq->orderPrice_ +
-          ordReq->orderPrice_ * simedTDInfo->transDetailGroup_[i]->slippage_;
-    }
-    ordReq->lastDealTime_ = GetTotalUSSince1970();
-
-    const auto prevDealAmt = ordReq->avgDealPrice_ * ordReq->dealSize_;
-    const auto lastDealAmt = ordReq->lastDealPrice_ * ordReq->lastDealSize_;
-    const auto totalDealSize = ordReq->dealSize_ + ordReq->lastDealSize_;
-    if (!DEC::ZERO(totalDealSize)) {
-      ordReq->avgDealPrice_ = (prevDealAmt + lastDealAmt) / totalDealSize;
-    }
-    ordReq->dealSize_ = totalDealSize;
+    //! 填写lastTrade相关的字段以及成交均价和成交数量
+    UpdateOrderInfoByTransDetail(ordReq, simedTDInfo->transDetailGroup_[i],
+                                 fmt::format("{}", GET_RAND_INT()),
+                                 GetTotalUSSince1970());
 
     const auto liquidityDirection =
         simedTDInfo->transDetailGroup_[i]->liquidityDirection_;
@@ -260,32 +279,10 @@ void SimedOrderInfoHandler::simOnOrderPartialFilled(
           std::chrono::milliseconds(milliSecIntervalOfSimOrderStatus_));
     }
 
-    const auto lastTradeId = fmt::format("{}", GET_RAND_INT());
-    strncpy(ordReq->lastTradeId_, lastTradeId.c_str(),
-            sizeof(ordReq->lastTradeId_) - 1);
-    if (ordReq->side_ == Side::Bid) {
-      ordReq->lastDealSize_ =
-          ordReq->orderSize_ * simedTDInfo->transDetailGroup_[i]->filledPer_;
-      ordReq->lastDealPrice_ =
-          ordReq->orderPrice_ -
-          ordReq->orderPrice_ * simedTDInfo->transDetailGroup_[i]->slippage_;
-    } else {
-      ordReq->lastDealSize_ = ordReq->orderSize_ *
-                              simedTDInfo->transDetailGroup_[i]->filledPer_ *
-                              -1;
-      ordReq->lastDealPrice_ =
-          ordReq->orderPrice_ +
-          ordReq->orderPrice_ * simedTDInfo->transDetailGroup_[i]->slippage_;
-    }
-    ordReq->lastDealTime_ = GetTotalUSSince1970();
-
-    const auto prevDealAmt = ordReq->avgDealPrice_ * ordReq->dealSize_;
-    const auto lastDealAmt = ordReq->lastDealPrice_ * ordReq->lastDealSize_;
-    const auto totalDealSize = ordReq->dealSize_ + ordReq->lastDealSize_;
-    if (!DEC::ZERO(totalDealSize)) {
-      ordReq->avgDealPrice_ = (prevDealAmt + lastDealAmt) / totalDealSize;
-    }
-    ordReq->dealSize_ = totalDealSize;
+    //! 填写lastTrade相关的字段以及成交均价和成交数量
+    UpdateOrderInfoByTransDetail(ordReq, simedTDInfo->transDetailGroup_[i],
+                                 fmt::format("{}", GET_RAND_INT()),
+                                 GetTotalUSSince1970());
 
     const auto liquidityDirection =
         simedTDInfo->transDetailGroup_[i]->liquidityDirection_;
@@ -321,7 +318,8 @@ void SimedOrderInfoHandler::simOnOrderFailed(
     OrderInfoSPTr& ordReq, const SimedTDInfoSPtr& simedTDInfo) {
   ordReq->orderStatus_ = OrderStatus::Failed;
   ordReq->statusCode_ = SCODE_TD_SVC_SIMED_ORDER_STATSU_FAILED;
-  tdSvc_->getOrdMgr()->remove<LockFunc::True>(ordReq->orderId_);
+  tdSvc_->getOrdMgr()->remove<LockFunc::True>(ordReq->orderId_,
+                                              ordReq->acctId_);
   tdSvc_->getSHMCliOfTDSrv()->asyncSendMsgWithZeroCopy(
       [&](void* shmBuf) {
         InitMsgBodyExt(shmBuf, *ordReq);
@@ -336,6 +334,11 @@ void SimedOrderInfoHandler::simOnOrderFailed(
 }
 
 void SimedOrderInfoHandler::simOnCancelOrder(OrderInfoSPtr& ordReq) {
+  if (simedMatchingEngineEnabled_) {
+    simOnCancelOrderByMatchingEngine(ordReq);
+    return;
+  }
+
   //! 获取 OrdMgr 中的订单(下单后马上撤单的情况下，传过来的 ordReq 可能不正确)
   int statusCode = 0;
   OrderInfoSPtr orderInfoInOrdMgr{nullptr};
@@ -360,7 +363,278 @@ void SimedOrderInfoHandler::simOnCancelOrder(OrderInfoSPtr& ordReq) {
                                         ? OrderStatus::Canceled
                                         : OrderStatus::PartialFilledCanceled;
 
-  tdSvc_->getOrdMgr()->remove<LockFunc::True>(orderInfoInOrdMgr->orderId_);
+  tdSvc_->getOrdMgr()->remove<LockFunc::True>(orderInfoInOrdMgr->orderId_,
+                                              orderInfoInOrdMgr->acctId_);
+  tdSvc_->getSHMCliOfTDSrv()->asyncSendMsgWithZeroCopy(
+      [&](void* shmBuf) {
+        InitMsgBodyExt(shmBuf, *orderInfoInOrdMgr);
+#ifndef OPT_LOG
+        LOG_I("Send simed order ret. {}",
+              static_cast<OrderInfo*>(shmBuf)->toShortStr());
+#endif
+      },
+      MSG_ID_ON_ORDER_RET, orderInfoInOrdMgr->size());
+  tdSvc_->cacheSyncTaskGroup(MSG_ID_ON_ORDER_RET, orderInfoInOrdMgr,
+                             SyncToRiskMgr::True, SyncToDB::True);
+}
+
+int SimedOrderInfoHandler::initSimedMatchingEngine() {
+  const auto taskDispatcherParamInStrFmt = SetParam(
+      DEFAULT_TASK_DISPATCHER_PARAM,
+      CONFIG["simedMode"]["matchingEngine"]["taskDispatcherParam"]
+          .as<std::string>(""));
+  const auto [ret, taskDispatcherParam] =
+      MakeTaskDispatcherParam(taskDispatcherParamInStrFmt);
+  if (ret != 0) {
+    LOG_E("Init taskdispatcher of simed matching engine failed. {}",
+          taskDispatcherParamInStrFmt);
+    return ret;
+  }
+
+  //! 每个线程一个撮合引擎的分片，同一个品种的委托和行情总是在同一个线程中处理
+  SimedMatchingEngineParam simedMatchingEngineParam;
+  simedMatchingEngineParam.usLatencyOfOrder_ =
+      CONFIG["simedMode"]["matchingEngine"]["microSecLatencyOfOrder"]
+          .as<std::uint64_t>(0);
+  simedMatchingEngineParam.usLatencyOfCancelOrder_ =
+      CONFIG["simedMode"]["matchingEngine"]["microSecLatencyOfCancelOrder"]
+          .as<std::uint64_t>(0);
+  simedMatchingEngineParam.numOfShard_ =
+      taskDispatcherParam->taskSpecificThreadPoolSize_;
+  for (std::uint32_t no = 0; no < simedMatchingEngineParam.numOfShard_; ++no) {
+    simedMatchingEngineParam.no_ = no;
+    simedMatchingEngineGroup_.emplace_back(
+        std::make_shared<SimedMatchingEngine>(
+            simedMatchingEngineParam,
+            [this](const auto& orderInfo, auto msgId, auto liqDirection) {
+              onSimedOrderRet(orderInfo, msgId, liqDirection);
+            }));
+  }
+
+  const auto getThreadForAsyncTask = [](const auto& asyncTask,
+                                        auto taskSpecificThreadPoolSize) {
+    return SimedMatchingEngine::GetShardNo(
+        GetSymbolCodeOfTask(asyncTask->task_), taskSpecificThreadPoolSize);
+  };
+
+  const auto handleAsyncTask = [this](auto& asyncTask) {
+    handleTaskOfMatchingEngine(asyncTask);
+  };
+
+  taskDispatcherOfMatchingEngine_ =
+      std::make_shared<TaskDispatcher<SHMIPCTaskSPtr>>(
+          taskDispatcherParam, nullptr, getThreadForAsyncTask,
+          handleAsyncTask);
+  taskDispatcherOfMatchingEngine_->init();
+
+  return 0;
+}
+
+void SimedOrderInfoHandler::initSubMgr() {
+  //! 行情服务通过PUB_CHANNEL推送所有品种的行情，这里只处理订阅了的品种
+  const auto onSHMDataRecv = [this](const void* shmBuf, std::size_t shmBufLen) {
+    const auto shmHeader = static_cast<const SHMHeader*>(shmBuf);
+    if (subMgr_->getSubscriberGroupByTopicHash(shmHeader->topicHash_)
+            .empty()) {
+      return;
+    }
+
+    SHMIPCTaskSPtr shmIPCTask;
+    if (shmHeader->msgId_ == MSG_ID_ON_MD_BOOKS_DELTA) {
+      shmIPCTask = std::make_shared<SHMIPCTask>();
+      shmIPCTask->data_ = malloc(sizeof(Books));
+      shmIPCTask->len_ = sizeof(Books);
+      const auto ret =
+          booksRebuilder_->rebuild(static_cast<const BooksDelta*>(shmBuf),
+                                   static_cast<Books*>(shmIPCTask->data_));
+      if (ret != 0) {
+        return;
+      }
+    } else if (shmHeader->msgId_ == MSG_ID_ON_MD_BOOKS ||
+               shmHeader->msgId_ == MSG_ID_ON_MD_TRADES) {
+      //! 撮合引擎持有最新的Books直到下一个快照到达，chunk不用拷贝
+      shmIPCTask = MakeSHMIPCTask(shmBuf, shmBufLen);
+    } else {
+      return;
+    }
+
+    const auto asyncTask = std::make_shared<SHMIPCAsyncTask>(shmIPCTask);
+    taskDispatcherOfMatchingEngine_->dispatch(asyncTask);
+  };
+
+  booksRebuilder_ = std::make_shared<BooksRebuilder>(
+      [this](const auto& mdHeader, auto seqNo) {
+        subMgr_->reqBooksSnapshot(mdHeader, seqNo);
+      });
+  subMgr_ = std::make_shared<SubMgr>(tdSvc_->getAppName(), onSHMDataRecv);
+}
+
+void SimedOrderInfoHandler::simOnOrderByMatchingEngine(OrderInfoSPtr& ordReq) {
+  const auto marketCode = GetMarketName(ordReq->marketCode_);
+  const auto [statusCode, symbolInfo] =
+      tdSvc_->getTBLMonitorOfSymbolInfo()->getRecSymbolInfoBySymbolCode(
+          marketCode, ordReq->symbolCode_);
+  if (statusCode != SCODE_SUCCESS) {
+    LOG_W(
+        "Handle order by simed matching engine failed because of query "
+        "symbol info of {} - {} failed. [{} - {}]",
+        marketCode, ordReq->symbolCode_, statusCode, GetStatusMsg(statusCode));
+    ordReq->orderStatus_ = OrderStatus::Failed;
+    ordReq->statusCode_ = statusCode;
+    onSimedOrderRet(ordReq, MSG_ID_ON_ORDER_RET, LiquidityDirection::Others);
+    return;
+  }
+
+  ordReq->fee_ = 0;
+  const auto feeCurrency = getFeeCurrency(ordReq, symbolInfo->baseCurrency,
+                                          symbolInfo->quoteCurrency);
+  strncpy(ordReq->feeCurrency_, feeCurrency.c_str(),
+          sizeof(ordReq->feeCurrency_) - 1);
+
+  //! 订阅失败的话撮合引擎中没有订单簿，订单会被拒绝
+  subMDOfSymbol(ordReq);
+
+  const auto task = std::make_shared<SHMIPCTask>(ordReq.get(), ordReq->size());
+  static_cast<SHMHeader*>(task->data_)->msgId_ = MSG_ID_ON_ORDER;
+  const auto asyncTask = std::make_shared<SHMIPCAsyncTask>(task);
+  taskDispatcherOfMatchingEngine_->dispatch(asyncTask);
+}
+
+void SimedOrderInfoHandler::simOnCancelOrderByMatchingEngine(
+    OrderInfoSPtr& ordReq) {
+  const auto task = std::make_shared<SHMIPCTask>(ordReq.get(), ordReq->size());
+  static_cast<SHMHeader*>(task->data_)->msgId_ = MSG_ID_ON_CANCEL_ORDER;
+  const auto asyncTask = std::make_shared<SHMIPCAsyncTask>(task);
+  taskDispatcherOfMatchingEngine_->dispatch(asyncTask);
+}
+
+int SimedOrderInfoHandler::subMDOfSymbol(const OrderInfoSPtr& ordReq) {
+  const auto marketCode = GetMarketName(ordReq->marketCode_);
+  const auto symbolType =
+      std::string(magic_enum::enum_name(ordReq->symbolType_));
+  const auto [topicOfBooks, topicHashOfBooks] = MakeTopicInfo(
+      marketCode, symbolType, ordReq->symbolCode_, MDType::Books,
+      Int2StrInCompileTime<MAX_DEPTH_LEVEL>::type::value);
+  const auto [topicOfTrades, topicHashOfTrades] = MakeTopicInfo(
+      marketCode, symbolType, ordReq->symbolCode_, MDType::Trades);
+
+  for (const auto& topic : {topicOfBooks, topicOfTrades}) {
+    {
+      std::lock_guard<std::ext::spin_mutex> guard(mtxTopicGroupSubed_);
+      if (topicGroupSubed_.emplace(topic).second == false) continue;
+    }
+    if (const auto ret = subMgr_->sub(tdSvc_->getAcctId(), topic); ret != 0) {
+      LOG_W("Sub {} for simed matching engine failed. [{} - {}]", topic, ret,
+            GetStatusMsg(ret));
+      std::lock_guard<std::ext::spin_mutex> guard(mtxTopicGroupSubed_);
+      topicGroupSubed_.erase(topic);
+      return ret;
+    }
+    LOG_I("Sub {} for simed matching engine success.", topic);
+  }
+
+  return 0;
+}
+
+void SimedOrderInfoHandler::handleTaskOfMatchingEngine(
+    const SHMIPCAsyncTaskSPtr& asyncTask) {
+  const auto& task = asyncTask->task_;
+  const auto shardNo = SimedMatchingEngine::GetShardNo(
+      GetSymbolCodeOfTask(task), simedMatchingEngineGroup_.size());
+  const auto& simedMatchingEngine = simedMatchingEngineGroup_[shardNo];
+
+  const auto now = GetTotalUSSince1970();
+  const auto shmHeader = static_cast<const SHMHeader*>(task->data_);
+  switch (shmHeader->msgId_) {
+    case MSG_ID_ON_ORDER:
+      simedMatchingEngine->order(MakeMsgSPtrByTask<OrderInfo>(task), now);
+      break;
+    case MSG_ID_ON_CANCEL_ORDER:
+      simedMatchingEngine->cancelOrder(MakeMsgSPtrByTask<OrderInfo>(task),
+                                       now);
+      break;
+    case MSG_ID_ON_MD_BOOKS:
+    case MSG_ID_ON_MD_BOOKS_DELTA: {
+      //! 和task共享所有权，task释放的时候才归还chunk
+      const auto books =
+          BooksCSPtr(task, static_cast<const Books*>(task->data_));
+      simedMatchingEngine->onBooks(books, now);
+    } break;
+    case MSG_ID_ON_MD_TRADES:
+      simedMatchingEngine->onTrades(*static_cast<const Trades*>(task->data_),
+                                    now);
+      break;
+    default:
+      LOG_W("Unhandled msg of simed matching engine. {} - {}",
+            shmHeader->msgId_, GetMsgName(shmHeader->msgId_));
+      break;
+  }
+}
+
+void SimedOrderInfoHandler::onSimedOrderRet(
+    const OrderInfoSPtr& orderInfo, MsgId msgId,
+    LiquidityDirection liquidityDirection) {
+  //! 撤单失败，订单已经完结或者不存在
+  if (msgId == MSG_ID_ON_CANCEL_ORDER_RET) {
+    tdSvc_->getSHMCliOfTDSrv()->asyncSendMsgWithZeroCopy(
+        [&](void* shmBuf) {
+          InitMsgBodyExt(shmBuf, *orderInfo);
+#ifndef OPT_LOG
+          LOG_I("Send simed order ret. {}",
+                static_cast<OrderInfo*>(shmBuf)->toShortStr());
+#endif
+        },
+        MSG_ID_ON_CANCEL_ORDER_RET, orderInfo->size());
+    return;
+  }
+
+  if (orderInfo->orderStatus_ == OrderStatus::Failed) {
+    LOG_W("Handle order by simed matching engine failed. [{} - {}] {}",
+          orderInfo->statusCode_, GetStatusMsg(orderInfo->statusCode_),
+          orderInfo->toShortStr());
+    tdSvc_->getOrdMgr()->remove<LockFunc::True>(orderInfo->orderId_,
+                                                orderInfo->acctId_);
+    tdSvc_->getSHMCliOfTDSrv()->asyncSendMsgWithZeroCopy(
+        [&](void* shmBuf) {
+          InitMsgBodyExt(shmBuf, *orderInfo);
+#ifndef OPT_LOG
+          LOG_I("Send simed order ret. {}",
+                static_cast<OrderInfo*>(shmBuf)->toShortStr());
+#endif
+        },
+        MSG_ID_ON_ORDER_RET, orderInfo->size());
+    tdSvc_->cacheSyncTaskGroup(MSG_ID_ON_ORDER_RET,
+                               std::make_shared<OrderInfo>(*orderInfo),
+                               SyncToRiskMgr::True, SyncToDB::True);
+    return;
+  }
+
+  //! 成交回报，按本笔成交是maker还是taker累加手续费
+  if (liquidityDirection != LiquidityDirection::Others) {
+    const auto marketCode = GetMarketName(orderInfo->marketCode_);
+    const auto [statusCode, symbolInfo] =
+        tdSvc_->getTBLMonitorOfSymbolInfo()->getRecSymbolInfoBySymbolCode(
+            marketCode, orderInfo->symbolCode_);
+    const auto feeRatio = liquidityDirection == LiquidityDirection::Maker
+                              ? feeRatioOfMaker_
+                              : feeRatioOfTaker_;
+    auto lastDeal = std::make_shared<OrderInfo>(*orderInfo);
+    lastDeal->dealSize_ = orderInfo->lastDealSize_;
+    lastDeal->avgDealPrice_ = orderInfo->lastDealPrice_;
+    orderInfo->fee_ +=
+        calcFee(lastDeal, feeRatio, symbolInfo ? symbolInfo->parValue : 0);
+  }
+
+  const auto [isTheOrderInfoUpdated, orderInfoInOrdMgr] =
+      tdSvc_->getOrdMgr()
+          ->updateByOrderInfoFromExch<LockFunc::True, DeepClone::True>(
+              orderInfo, tdSvc_->getNextNoUsedToCalcPos());
+  if (orderInfoInOrdMgr == nullptr) {
+    LOG_W("Update order info by simed order ret failed. {}",
+          orderInfo->toShortStr());
+    return;
+  }
+
   tdSvc_->getSHMCliOfTDSrv()->asyncSendMsgWithZeroCopy(
       [&](void* shmBuf) {
         InitMsgBodyExt(shmBuf, *orderInfoInOrdMgr);
@@ -370,8 +644,23 @@ void SimedOrderInfoHandler::simOnCancelOrder(OrderInfoSPtr& ordReq) {
 #endif
       },
       MSG_ID_ON_ORDER_RET, orderInfoInOrdMgr->size());
+
+  //! orderInfoInOrdMgr是一个副本，不用再复制
   tdSvc_->cacheSyncTaskGroup(MSG_ID_ON_ORDER_RET, orderInfoInOrdMgr,
                              SyncToRiskMgr::True, SyncToDB::True);
 }
 
+std::string SimedOrderInfoHandler::GetSymbolCodeOfTask(
+    const SHMIPCTaskSPtr& task) {
+  const auto shmHeader = static_cast<const SHMHeader*>(task->data_);
+  switch (shmHeader->msgId_) {
+    case MSG_ID_ON_ORDER:
+    case MSG_ID_ON_CANCEL_ORDER:
+      return static_cast<const OrderInfo*>(task->data_)->symbolCode_;
+    default:
+      //! 各类行情的结构体都以shmHeader_和mdHeader_开头
+      return static_cast<const Books*>(task->data_)->mdHeader_.symbolCode_;
+  }
+}
+
 }  // namespace bq::td::svc
@@ -30,6 +30,7 @@
 #include "util/Datetime.hpp"
 #include "util/ExceedFlowCtrlHandler.hpp"
 #include "util/FlowCtrlSvc.hpp"
+#include "util/LatencyTrace.hpp"
 #include "util/Logger.hpp"
 #include "util/TaskDispatcher.hpp"
 #include "util/TrdSymbolCache.hpp"
@@ -111,6 +112,11 @@ void TDSrvTaskHandler::handleMsgIdOnOrder(SHMIPCAsyncTaskSPtr& asyncTask) {
   //! 另外这个add动作一定要在报单请求的前面，不然回报回来太快的话OrdMgr::add还
   //! 没有调用，回报在OrdMgr中找不到报单记录。
   //!
+  //! 时延追踪的GatewaySend也要在add之前写入，这样OrdMgr中的副本在交易所确认
+  //! 的时候才能统计ExchAck。
+  //!
+  LatencyTrace::get_mutable_instance().stamp(ordReq->traceCtx_,
+                                             TraceHop::GatewaySend);
   ordReq->orderStatus_ = OrderStatus::Pending;
   if (const auto ret =
           tdSvc_->getOrdMgr()->add<LockFunc::True, DeepClone::True>(ordReq);
@@ -189,7 +195,8 @@ void TDSrvTaskHandler::handleMsgIdOnOrderInRealTDMode(OrderInfoSPtr& ordReq) {
     LOG_W("Handle order in real td mode failed. {}", ordReq->toShortStr());
     ordReq->orderStatus_ = OrderStatus::Failed;
     ordReq->statusCode_ = ret;
-    tdSvc_->getOrdMgr()->remove<LockFunc::True>(ordReq->orderId_);
+    tdSvc_->getOrdMgr()->remove<LockFunc::True>(ordReq->orderId_,
+                                                ordReq->acctId_);
 
     tdSvc_->getSHMCliOfTDSrv()->asyncSendMsgWithZeroCopy(
         [&](void* shmBuf) { InitMsgBodyExt(shmBuf, *ordReq); },
@@ -230,7 +237,8 @@ void TDSrvTaskHandler::handleMsgIdOnOrderInSimedTDMode(OrderInfoSPtr& ordReq) {
     LOG_W("Handle order in simed td mode failed. [{} - {}] {}",
           ordReq->statusCode_, GetStatusMsg(ordReq->statusCode_),
           ordReq->toShortStr());
-    tdSvc_->getOrdMgr()->remove<LockFunc::True>(ordReq->orderId_);
+    tdSvc_->getOrdMgr()->remove<LockFunc::True>(ordReq->orderId_,
+                                                ordReq->acctId_);
     tdSvc_->getSHMCliOfTDSrv()->asyncSendMsgWithZeroCopy(
         [&](void* shmBuf) { InitMsgBodyExt(shmBuf, *ordReq); },
         MSG_ID_ON_ORDER_RET, ordReq->size());
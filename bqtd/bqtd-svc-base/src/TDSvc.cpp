@@ -35,6 +35,7 @@
 #include "util/ExceedFlowCtrlHandler.hpp"
 #include "util/ExternalStatusCodeCache.hpp"
 #include "util/FlowCtrlSvc.hpp"
+#include "util/LatencyTrace.hpp"
 #include "util/Literal.hpp"
 #include "util/ScheduleTaskBundle.hpp"
 #include "util/Scheduler.hpp"
@@ -63,6 +64,11 @@ int TDSvc::prepareInit() {
     return retOfLoggerInit;
   }
 
+  //! 时延追踪默认关闭，开启后向进程发送SIGUSR1输出各环节的时延分布
+  if (CONFIG["enableLatencyTrace"].as<bool>(false)) {
+    LatencyTrace::get_mutable_instance().enable();
+  }
+
   return 0;
 }
 
@@ -113,6 +119,10 @@ int TDSvc::doInit() {
 
   if (CONFIG["simedMode"]["enabled"].as<bool>(false) == true) {
     simedOrderInfoHandler_ = std::make_shared<SimedOrderInfoHandler>(this);
+    if (const auto ret = simedOrderInfoHandler_->init(); ret != 0) {
+      LOG_E("Do init failed.");
+      return ret;
+    }
   } else {
     assert(wsCliOfExch_ != nullptr && "wsCliOfExch_ != nullptr");
     if (const auto ret = wsCliOfExch_->init(); ret != 0) {
@@ -205,7 +215,7 @@ int TDSvc::queryMaxNoUsedToCalcPos() {
     maxNoUsedToCalcPos_ = orderInfo->getRecWithAllFields()->noUsedToCalcPos;
   }
   LOG_I("Query maxNoUsedToCalcPos success. [maxNoUsedToCalcPos = {}]",
-        maxNoUsedToCalcPos_);
+        maxNoUsedToCalcPos_.load());
 
   return 0;
 }
@@ -308,6 +318,9 @@ void TDSvc::initSHMCliOfTDSrv() {
 
   shmCliOfTDSrv_ = std::make_shared<SHMCli>(addr, onSHMDataRecv);
   shmCliOfTDSrv_->setClientChannel(acctId_);
+  //! 对时延敏感的通道可以配置为绑核轮询，见SHMIPCRecvParam
+  shmCliOfTDSrv_->setRecvParam(
+      CONFIG["recvParamOfTDSrvChannel"].as<std::string>(""));
 }
 
 void TDSvc::initSHMCliOfRiskMgr() {
@@ -432,6 +445,10 @@ int TDSvc::doRun() {
     }
   }
 
+  if (CONFIG["simedMode"]["enabled"].as<bool>(false) == true) {
+    simedOrderInfoHandler_->start();
+  }
+
   tdSrvTaskDispatcher_->start();
   shmCliOfTDSrv_->start();
   shmCliOfRiskMgr_->start();
@@ -567,6 +584,9 @@ void TDSvc::doExit(const boost::system::error_code* ec, int signalNum) {
   shmCliOfRiskMgr_->stop();
   shmCliOfTDSrv_->stop();
   tdSrvTaskDispatcher_->stop();
+  if (CONFIG["simedMode"]["enabled"].as<bool>(false) == true) {
+    simedOrderInfoHandler_->stop();
+  }
   if (CONFIG["simedMode"]["enabled"].as<bool>(false) == false) {
     wsCliOfExch_->stop();
   }
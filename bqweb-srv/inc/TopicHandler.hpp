@@ -18,6 +18,9 @@ namespace bq {
 
 class WebSrv;
 
+class BooksRebuilder;
+using BooksRebuilderSPtr = std::shared_ptr<BooksRebuilder>;
+
 class TopicHandler;
 using TopicHandlerSPtr = std::shared_ptr<TopicHandler>;
 
@@ -39,6 +42,7 @@ class TopicHandler {
   void handleMsgIdTickers(const void* shmBuf, std::size_t shmBufLen);
   void handleMsgIdCandle(const void* shmBuf, std::size_t shmBufLen);
   void handleMsgIdBooks(const void* shmBuf, std::size_t shmBufLen);
+  void handleMsgIdBooksDelta(const void* shmBuf, std::size_t shmBufLen);
   void handleMsgIdMDBid1Ask1(const void* shmBuf, std::size_t shmBufLen);
   void handleMsgIdMDLastPrice(const void* shmBuf, std::size_t shmBufLen);
   void handleMsgIdPosSnapshot(const void* shmBuf, std::size_t shmBufLen);
@@ -48,6 +52,7 @@ class TopicHandler {
 
  private:
   WebSrv* webSrv_{nullptr};
+  BooksRebuilderSPtr booksRebuilder_{nullptr};
 };
 
 }  // namespace bq
@@ -44,6 +44,9 @@ using SubMgrSPtr = std::shared_ptr<SubMgr>;
 class PosSnapshot;
 using PosSnapshotSPtr = std::shared_ptr<PosSnapshot>;
 
+class PosSnapshotRebuilder;
+using PosSnapshotRebuilderSPtr = std::shared_ptr<PosSnapshotRebuilder>;
+
 class TopicMgr;
 using TopicMgrSPtr = std::shared_ptr<TopicMgr>;
 
@@ -87,6 +90,7 @@ class WebSrv : public SvcBase, public boost::serialization::singleton<WebSrv> {
   int initDBEng();
   int initTDEng();
   void initSubMgr();
+  void reqPosKeyframeOfAll(std::uint64_t seqNo);
   void initTopicMgr();
   int initStgEngTaskDispatcher();
   void initSHMSrv();
@@ -116,8 +120,8 @@ class WebSrv : public SvcBase, public boost::serialization::singleton<WebSrv> {
   StgMgrSPtr& getStgMgr() { return stgMgr_; }
   SubMgrSPtr& getSubMgr() { return subMgr_; }
 
-  void setPosSnapshotOfAll(const PosSnapshotSPtr& value);
-  PosSnapshotSPtr getPosSnapshotOfAll() const;
+  //! 处理仓位的关键帧和增量
+  void rebuildPosSnapshotOfAll(const void* shmBuf);
 
   std::tuple<int, Key2PnlGroupSPtr> queryPnlGroupBy(
       const std::string& groupCond);
@@ -150,6 +154,7 @@ class WebSrv : public SvcBase, public boost::serialization::singleton<WebSrv> {
   TopicMgrSPtr topicMgr_{nullptr};
   SubMgrSPtr subMgr_{nullptr};
 
+  PosSnapshotRebuilderSPtr posSnapshotRebuilder_{nullptr};
   PosSnapshotSPtr posSnapshot_{nullptr};
   mutable std::ext::spin_mutex mtxPosSnapshot_;
 
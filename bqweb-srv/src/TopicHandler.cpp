@@ -30,6 +30,7 @@
 #include "def/StatusCode.hpp"
 #include "def/SyncTask.hpp"
 #include "def/WebSrvMsgName.hpp"
+#include "util/BooksRebuilder.hpp"
 #include "util/Datetime.hpp"
 #include "util/Logger.hpp"
 #include "util/PosSnapshot.hpp"
@@ -40,7 +41,12 @@
 
 namespace bq {
 
-TopicHandler::TopicHandler(WebSrv* webSrv) : webSrv_(webSrv) {}
+TopicHandler::TopicHandler(WebSrv* webSrv)
+    : webSrv_(webSrv),
+      booksRebuilder_(std::make_shared<BooksRebuilder>(
+          [this](const auto& mdHeader, auto seqNo) {
+            webSrv_->getSubMgr()->reqBooksSnapshot(mdHeader, seqNo);
+          })) {}
 
 void TopicHandler::handleData(const void* shmBuf, std::size_t shmBufLen) {
   const auto shmHeader = static_cast<const SHMHeader*>(shmBuf);
@@ -60,6 +66,9 @@ void TopicHandler::handleData(const void* shmBuf, std::size_t shmBufLen) {
     case MSG_ID_ON_MD_BOOKS:
       handleMsgIdBooks(shmBuf, shmBufLen);
       break;
+    case MSG_ID_ON_MD_BOOKS_DELTA:
+      handleMsgIdBooksDelta(shmBuf, shmBufLen);
+      break;
     case MSG_ID_ON_MD_BID1_ASK1:
       handleMsgIdMDBid1Ask1(shmBuf, shmBufLen);
       break;
@@ -68,6 +77,7 @@ void TopicHandler::handleData(const void* shmBuf, std::size_t shmBufLen) {
       break;
     case MSG_ID_POS_UPDATE_OF_ALL:
     case MSG_ID_POS_SNAPSHOT_OF_ALL:
+    case MSG_ID_POS_DELTA_OF_ALL:
       handleMsgIdPosSnapshot(shmBuf, shmBufLen);
       break;
     case MSG_ID_POS_UPDATE_OF_ACCT_ID:
@@ -124,6 +134,18 @@ void TopicHandler::handleMsgIdBooks(const void* shmBuf, std::size_t shmBufLen) {
   pushMarketData(md->shmHeader_.topicHash_, std::move(marketData));
 }
 
+//! 重建为完整的订单簿之后和Books一样推送给前端
+void TopicHandler::handleMsgIdBooksDelta(const void* shmBuf,
+                                         std::size_t shmBufLen) {
+  auto& books = std::ext::tls_get<Books>();
+  const auto ret = booksRebuilder_->rebuild(
+      static_cast<const BooksDelta*>(shmBuf), &books);
+  if (ret != 0) {
+    return;
+  }
+  handleMsgIdBooks(&books, sizeof(Books));
+}
+
 void TopicHandler::handleMsgIdMDBid1Ask1(const void* shmBuf,
                                          std::size_t shmBufLen) {
   const auto md = static_cast<const Bid1Ask1*>(shmBuf);
@@ -142,16 +164,8 @@ void TopicHandler::handleMsgIdMDLastPrice(const void* shmBuf,
 
 void TopicHandler::handleMsgIdPosSnapshot(const void* shmBuf,
                                           std::size_t shmBufLen) {
-  //! 根据订阅得到的消息构建 posSnapshot
-  auto buf = malloc(shmBufLen);
-  memcpy(buf, shmBuf, shmBufLen);
-
-  const auto posUpdateOfAllForPub =
-      MakeMsgSPtrByTask<PosUpdateOfAllForPub>(buf);
-  const auto posUpdateOfAll = MakePosUpdateOfAll(posUpdateOfAllForPub);
-  const auto posSnapshotOfAll =
-      std::make_shared<PosSnapshot>(std::move(posUpdateOfAll), nullptr);
-  webSrv_->setPosSnapshotOfAll(posSnapshotOfAll);
+  //! 关键帧重建 posSnapshot，增量原地更新 posSnapshot
+  webSrv_->rebuildPosSnapshotOfAll(shmBuf);
 }
 
 void TopicHandler::pushMarketData(std::uint64_t topicHash,
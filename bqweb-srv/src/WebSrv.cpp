@@ -34,6 +34,7 @@
 #include "util/Literal.hpp"
 #include "util/Logger.hpp"
 #include "util/PosSnapshot.hpp"
+#include "util/PosSnapshotRebuilder.hpp"
 #include "util/Random.hpp"
 #include "util/ScheduleTaskBundle.hpp"
 #include "util/Scheduler.hpp"
@@ -163,8 +164,39 @@ void WebSrv::initSubMgr() {
   const auto onSHMDataRecv = [this](const void* shmBuf, std::size_t shmBufLen) {
     topicHandler_->handleData(shmBuf, shmBufLen);
   };
-  subMgr_ = std::make_shared<SubMgr>(APP_NAME, onSHMDataRecv);
-  subMgr_->sub(0, "RISK@PubChannel@Trade@PosInfo@All");
+  const auto clientChannelOfMD =
+      CONFIG["clientChannelOfMD"].as<ClientChannel>(PUB_CHANNEL);
+  subMgr_ =
+      std::make_shared<SubMgr>(APP_NAME, onSHMDataRecv, clientChannelOfMD);
+  //! 行情只是转发给前端展示，处理不过来的时候可以配置为合并或者丢弃
+  const auto slowConsumerPolicyInStrFmt =
+      CONFIG["slowConsumerPolicyOfMD"].as<std::string>("Block");
+  const auto slowConsumerPolicy =
+      magic_enum::enum_cast<SlowConsumerPolicy>(slowConsumerPolicyInStrFmt);
+  if (slowConsumerPolicy.has_value()) {
+    subMgr_->setSlowConsumerPolicyOfMD(slowConsumerPolicy.value());
+  } else {
+    LOG_W("Invalid slow consumer policy of md {}, use Block instead.",
+          slowConsumerPolicyInStrFmt);
+  }
+
+  posSnapshotRebuilder_ = std::make_shared<PosSnapshotRebuilder>(
+      [this](std::uint64_t seqNo) { reqPosKeyframeOfAll(seqNo); });
+  subMgr_->sub(0, TOPIC_OF_POS_INFO_OF_ALL);
+}
+
+void WebSrv::reqPosKeyframeOfAll(std::uint64_t seqNo) {
+  const auto shmCli = subMgr_->getSHMCliByTopic(TOPIC_OF_POS_INFO_OF_ALL);
+  if (!shmCli) {
+    LOG_W("Req keyframe of pos info failed. [seqNo = {}]", seqNo);
+    return;
+  }
+  shmCli->asyncSendMsgWithZeroCopy(
+      [&](void* shmBuf) {
+        auto posKeyframeReqOfAll = static_cast<PosKeyframeReqOfAll*>(shmBuf);
+        posKeyframeReqOfAll->seqNo_ = seqNo;
+      },
+      MSG_ID_POS_KEYFRAME_REQ_OF_ALL, sizeof(PosKeyframeReqOfAll));
 }
 
 void WebSrv::initTopicMgr() {
@@ -328,17 +360,13 @@ void WebSrv::unSubAllTopic(UserId userId) {
   subMgr_->unSubAllTopic(userId);
 }
 
-void WebSrv::setPosSnapshotOfAll(const PosSnapshotSPtr& value) {
+void WebSrv::rebuildPosSnapshotOfAll(const void* shmBuf) {
   {
+    //! 增量是原地更新的，和queryPnlGroupBy使用同一把锁
     std::lock_guard<std::ext::spin_mutex> guard(mtxPosSnapshot_);
-    posSnapshot_ = value;
-  }
-}
-
-PosSnapshotSPtr WebSrv::getPosSnapshotOfAll() const {
-  {
-    std::lock_guard<std::ext::spin_mutex> guard(mtxPosSnapshot_);
-    return posSnapshot_;
+    if (posSnapshotRebuilder_->rebuild(shmBuf) == 0) {
+      posSnapshot_ = posSnapshotRebuilder_->getPosSnapshot();
+    }
   }
 }
 
@@ -27,6 +27,8 @@ struct TaskFromSrv {
               const bq::web::MsgSPtr& msg);
 
   const std::int64_t localTs_;
+  //! 开启时延追踪的时候为收到消息时的tsc，否则为0
+  const std::uint64_t tscOfRecv_;
   WSCli* wsCli_;
   ConnMetadataSPtr connMetadata_;
   MsgSPtr msg_;
@@ -12,6 +12,7 @@
 
 #include "WebDef.hpp"
 #include "util/Datetime.hpp"
+#include "util/LatencyTrace.hpp"
 
 namespace bq::web {
 
@@ -19,6 +20,8 @@ TaskFromSrv::TaskFromSrv(bq::web::WSCli* wsCli,
                          const bq::web::ConnMetadataSPtr& connMetadata,
                          const bq::web::MsgSPtr& msg)
     : localTs_(GetTotalUSSince1970()),
+      tscOfRecv_(LatencyTrace::get_mutable_instance().stamp(TraceHop::MDRecv,
+                                                             0)),
       wsCli_(wsCli),
       connMetadata_(connMetadata),
       msg_(msg) {}
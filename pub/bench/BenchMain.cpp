@@ -9,6 +9,17 @@
  */
 
 #include <benchmark/benchmark.h>
+#include <fmt/format.h>
+#include <yyjson.h>
+
+#include <boost/convert.hpp>
+#include <boost/convert/spirit.hpp>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "util/DecimalParser.hpp"
 
 class FixtureTest : public benchmark::Fixture {
  public:
@@ -27,4 +38,120 @@ BENCHMARK_REGISTER_F(FixtureTest, test)
     ->Unit(benchmark::kMicrosecond)
     ->Arg(1000);
 
+//!
+//! 比较价格和数量字符串的两种转换方式，数据来源：
+//! 1. 环境变量 BQ_BENCH_FRAME_FILE 指定的币安行情抓包文件，每行一帧json，
+//!    取出其中所有的数值字符串；
+//! 2. 没有指定的时候使用1000档的BTCUSDT深度快照，格式和币安一致。
+//!
+class FixtureOfDecimalParser : public benchmark::Fixture {
+ public:
+  void SetUp(const ::benchmark::State& state) {
+    if (!strGroup_.empty()) return;
+    const auto frameFile = std::getenv("BQ_BENCH_FRAME_FILE");
+    if (frameFile != nullptr) {
+      std::ifstream ifs(frameFile);
+      std::string frame;
+      while (std::getline(ifs, frame)) {
+        addFrame(frame);
+      }
+    }
+    if (strGroup_.empty()) {
+      addFrame(makeDepthSnapshot(1000));
+    }
+  }
+
+  void TearDown(const ::benchmark::State& state) {}
+
+ private:
+  static std::string makeDepthSnapshot(int numOfLevel) {
+    std::string ret = R"({"lastUpdateId":1027024,"bids":[)";
+    for (int i = 0; i < numOfLevel; ++i) {
+      ret += i == 0 ? "" : ",";
+      ret += fmt::format(R"(["{:.8f}","{:.8f}"])", 29000.12 - i * 0.01,
+                         0.00051 * (i % 37 + 1));
+    }
+    ret += R"(],"asks":[)";
+    for (int i = 0; i < numOfLevel; ++i) {
+      ret += i == 0 ? "" : ",";
+      ret += fmt::format(R"(["{:.8f}","{:.8f}"])", 29000.13 + i * 0.01,
+                         0.00037 * (i % 41 + 1));
+    }
+    ret += "]}";
+    return ret;
+  }
+
+  void addFrame(const std::string& frame) {
+    auto doc = yyjson_read(frame.data(), frame.size(), 0);
+    if (doc == nullptr) return;
+    collectNumStr(yyjson_doc_get_root(doc));
+    yyjson_doc_free(doc);
+  }
+
+  void collectNumStr(yyjson_val* val) {
+    if (yyjson_is_str(val)) {
+      const std::string str = yyjson_get_str(val);
+      if (!str.empty() &&
+          str.find_first_not_of("-.0123456789") == std::string::npos) {
+        strGroup_.emplace_back(str);
+      }
+    } else if (yyjson_is_arr(val)) {
+      std::size_t idx, max;
+      yyjson_val* item;
+      yyjson_arr_foreach(val, idx, max, item) { collectNumStr(item); }
+    } else if (yyjson_is_obj(val)) {
+      std::size_t idx, max;
+      yyjson_val *key, *item;
+      yyjson_obj_foreach(val, idx, max, key, item) { collectNumStr(item); }
+    }
+  }
+
+ protected:
+  inline static std::vector<std::string> strGroup_;
+};
+
+BENCHMARK_DEFINE_F(FixtureOfDecimalParser, testBoostConvert)
+(benchmark::State& st) {
+  for (auto _ : st) {
+    double sum = 0;
+    for (const auto& str : strGroup_) {
+      sum += boost::convert<double>(str.c_str(), boost::cnv::spirit()).value();
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  st.SetItemsProcessed(st.iterations() * strGroup_.size());
+}
+BENCHMARK_REGISTER_F(FixtureOfDecimalParser, testBoostConvert)
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_DEFINE_F(FixtureOfDecimalParser, testStr2Dbl)
+(benchmark::State& st) {
+  for (auto _ : st) {
+    double sum = 0;
+    for (const auto& str : strGroup_) {
+      sum += bq::Str2Dbl(str.c_str(), str.size());
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  st.SetItemsProcessed(st.iterations() * strGroup_.size());
+}
+BENCHMARK_REGISTER_F(FixtureOfDecimalParser, testStr2Dbl)
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_DEFINE_F(FixtureOfDecimalParser, testStr2ScaledInt)
+(benchmark::State& st) {
+  for (auto _ : st) {
+    std::int64_t sum = 0;
+    for (const auto& str : strGroup_) {
+      std::int64_t value = 0;
+      bq::Str2ScaledInt(str.c_str(), str.size(), 8, value);
+      sum += value;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  st.SetItemsProcessed(st.iterations() * strGroup_.size());
+}
+BENCHMARK_REGISTER_F(FixtureOfDecimalParser, testStr2ScaledInt)
+    ->Unit(benchmark::kMicrosecond);
+
 BENCHMARK_MAIN();
@@ -23,6 +23,13 @@ const static int SCODE_BQPUB_POS_INFO_GROUP_NOT_EXISTS = -1113;
 const static int SCODE_BQPUB_INVALID_FORMAT_OF_SIMED_TD_INFO = -1121;
 const static int SCODE_BQPUB_INVALID_TRANS_DETAIL_IN_SIMED_TD_INFO = -1122;
 const static int SCODE_BQPUB_INVALID_ORDER_STATUS_IN_SIMED_TD_INFO = -1123;
+const static int SCODE_BQPUB_BOOKS_DELTA_DISCONTINUOUS = -1131;
+const static int SCODE_BQPUB_BOOKS_NOT_READY = -1132;
+const static int SCODE_BQPUB_POS_DELTA_DISCONTINUOUS = -1133;
+const static int SCODE_BQPUB_POS_SNAPSHOT_NOT_READY = -1134;
+const static int SCODE_BQPUB_SIMED_MATCHING_NO_BOOKS = -1141;
+const static int SCODE_BQPUB_SIMED_MATCHING_MAKE_ONLY_WILL_TAKE = -1142;
+const static int SCODE_BQPUB_SIMED_MATCHING_ORDER_NOT_EXISTS = -1143;
 
 //! 交易网关自身的状态码
 const static int SCODE_TD_SVC_EXCEED_FLOW_CTRL = -3501;
@@ -50,6 +57,9 @@ const static int SCODE_HIS_MD_MAKE_INDEX_GROUP_FAILED = -4511;
 const static int SCODE_HIS_MD_GET_EXCH_TS_FAILED = -4512;
 const static int SCODE_HIS_MD_SAVE_INDEX_GROUP_FAILED = -4513;
 const static int SCODE_HIS_MD_LOAD_INDEX_GROUP_FAILED = -4514;
+const static int SCODE_HIS_MD_OPEN_BIN_FILE_FAILED = -4515;
+const static int SCODE_HIS_MD_INVALID_BIN_FILE = -4516;
+const static int SCODE_HIS_MD_SAVE_BIN_FILE_FAILED = -4517;
 
 //! 数据库相关状态码
 const static int SCODE_DB_CAN_NOT_FIND_SYM_CODE = -5001;
@@ -77,6 +87,11 @@ const static int SCODE_STG_ENG_INVALID_CONFIG_FILENAME = -6041;
 const static int SCODE_STG_INST_TASK_HANDLER_NOT_INSTALL = -6051;
 const static int SCODE_STG_SEND_HTTP_REQ_TO_QUERY_HIS_MD_FAILED = -6061;
 const static int SCODE_STG_INVALID_TOPIC = -6071;
+const static int SCODE_STG_BACKTEST_INVALID_DATETIME = -6081;
+const static int SCODE_STG_BACKTEST_LOAD_HIS_MD_FAILED = -6082;
+const static int SCODE_STG_BACKTEST_UNSUPPORTED_TOPIC = -6083;
+const static int SCODE_STG_BACKTEST_UNSUPPORTED_ALGO_ORDER = -6084;
+const static int SCODE_STG_BACKTEST_ORDER_OF_CANCEL_NOT_EXISTS = -6085;
 
 //! 算法单相关状态码
 const static int SCODE_ALGO_INVALID_ALGO_TYPE = -6501;
@@ -92,6 +107,8 @@ const static int SCODE_ALGO_BID1_ASK1_IS_NULL = -6551;
 const static int SCODE_ORD_MGR_ADD_ORDER_INFO_FAILED = -7001;
 const static int SCODE_ORD_MGR_REMOVE_ORDER_INFO_FAILED = -7002;
 const static int SCODE_ORD_MGR_CAN_NOT_FIND_ORDER = -7005;
+const static int SCODE_ORD_MGR_OPEN_ARCHIVE_FAILED = -7011;
+const static int SCODE_ORD_MGR_APPEND_TO_ARCHIVE_FAILED = -7012;
 
 //! 内置WebSrv服务状态码
 const static int SCODE_WEB_SRV_SESSION_TIMEOUT = -8001;
@@ -155,6 +172,20 @@ inline std::string GetStatusMsg(int statusCode) {
     return "Invalid trans detail in simed td info";
   } else if (statusCode == SCODE_BQPUB_INVALID_ORDER_STATUS_IN_SIMED_TD_INFO) {
     return "Invalid order status in simed td info";
+  } else if (statusCode == SCODE_BQPUB_BOOKS_DELTA_DISCONTINUOUS) {
+    return "Books delta discontinuous";
+  } else if (statusCode == SCODE_BQPUB_BOOKS_NOT_READY) {
+    return "Books not ready, wait for full refresh";
+  } else if (statusCode == SCODE_BQPUB_POS_DELTA_DISCONTINUOUS) {
+    return "Pos delta discontinuous";
+  } else if (statusCode == SCODE_BQPUB_POS_SNAPSHOT_NOT_READY) {
+    return "Pos snapshot not ready, wait for keyframe";
+  } else if (statusCode == SCODE_BQPUB_SIMED_MATCHING_NO_BOOKS) {
+    return "No books of the symbol in simed matching engine";
+  } else if (statusCode == SCODE_BQPUB_SIMED_MATCHING_MAKE_ONLY_WILL_TAKE) {
+    return "Make only order will take liquidity in simed matching engine";
+  } else if (statusCode == SCODE_BQPUB_SIMED_MATCHING_ORDER_NOT_EXISTS) {
+    return "Order not exists in simed matching engine";
   } else if (statusCode == SCODE_TD_SVC_EXCEED_FLOW_CTRL) {
     return "Exceed flow control in td svc.";
   } else if (statusCode == SCODE_TD_SVC_REAL_RECV_SIMED_ORDER) {
@@ -223,6 +254,16 @@ inline std::string GetStatusMsg(int statusCode) {
     return "Stg send http request to query his market data failed";
   } else if (statusCode == SCODE_STG_INVALID_TOPIC) {
     return "Invalid topic";
+  } else if (statusCode == SCODE_STG_BACKTEST_INVALID_DATETIME) {
+    return "Invalid datetime of backtest";
+  } else if (statusCode == SCODE_STG_BACKTEST_LOAD_HIS_MD_FAILED) {
+    return "Load his market data for backtest failed";
+  } else if (statusCode == SCODE_STG_BACKTEST_UNSUPPORTED_TOPIC) {
+    return "Topic not supported in backtest mode";
+  } else if (statusCode == SCODE_STG_BACKTEST_UNSUPPORTED_ALGO_ORDER) {
+    return "Algo order not supported in backtest mode";
+  } else if (statusCode == SCODE_STG_BACKTEST_ORDER_OF_CANCEL_NOT_EXISTS) {
+    return "Order of cancel not exists in backtest mode";
   } else if (statusCode == SCODE_ALGO_INVALID_ALGO_TYPE) {
     return "Invalid type of algo order";
   } else if (statusCode == SCODE_ALGO_INVALID_ALGO_PARAM) {
@@ -245,6 +286,10 @@ inline std::string GetStatusMsg(int statusCode) {
     return "Remove order info failed";
   } else if (statusCode == SCODE_ORD_MGR_CAN_NOT_FIND_ORDER) {
     return "Can not find orderinfo, order may have finished.";
+  } else if (statusCode == SCODE_ORD_MGR_OPEN_ARCHIVE_FAILED) {
+    return "Open archive of order info failed";
+  } else if (statusCode == SCODE_ORD_MGR_APPEND_TO_ARCHIVE_FAILED) {
+    return "Append order info to archive failed";
   } else if (statusCode == SCODE_TD_SVC_PARSE_HTTP_RSP_OF_ORDER_FAILED) {
     return "Parse http rsp of order failed";
   } else if (statusCode == SCODE_TD_SVC_PARSE_HTTP_RSP_OF_CANCEL_ORDER_FAILED) {
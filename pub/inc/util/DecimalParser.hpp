@@ -0,0 +1,205 @@
+/*!
+ * \file DecimalParser.hpp
+ * \project BetterQuant
+ *
+ * \author byrnexu
+ * \date 2023/04/12
+ *
+ * \brief
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+namespace bq {
+
+//!
+//! 交易所json中价格和数量的字符串（比如 "29000.12000000"、"-0.5"）的快速解析：
+//! 1. 只支持 [-+]digits[.digits] 格式，不依赖locale，不分配内存；
+//! 2. 一次处理8个数字（SWAR），币安的价格和数量固定8位小数，正好一次处理完；
+//! 3. 数字不超过19位的时候得到精确的整数尾数和小数位数，超出或者格式不支持
+//!    （比如科学计数法）的时候返回false，由调用者退回通用的转换方式。
+//!
+struct ParsedDecimal {
+  std::uint64_t mantissa_{0};
+  std::uint32_t scale_{0};
+  bool negative_{false};
+};
+
+constexpr static std::uint32_t MAX_NUM_OF_DIGITS_IN_PARSED_DECIMAL = 19;
+
+constexpr static std::uint64_t POW10_TBL[] = {
+    1ULL,
+    10ULL,
+    100ULL,
+    1000ULL,
+    10000ULL,
+    100000ULL,
+    1000000ULL,
+    10000000ULL,
+    100000000ULL,
+    1000000000ULL,
+    10000000000ULL,
+    100000000000ULL,
+    1000000000000ULL,
+    10000000000000ULL,
+    100000000000000ULL,
+    1000000000000000ULL,
+    10000000000000000ULL,
+    100000000000000000ULL,
+    1000000000000000000ULL,
+    10000000000000000000ULL,
+};
+
+//! 2^53以内的整数和1e22以内的10的幂都可以用double精确表示，两者相除的结果
+//! 是正确舍入的，和strtod的结果一致
+constexpr static double DBL_POW10_TBL[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+constexpr static std::uint64_t MAX_MANTISSA_OF_EXACT_DBL = 1ULL << 53;
+
+inline bool IsMadeOfEightDigits(const char* str) {
+  std::uint64_t val;
+  std::memcpy(&val, str, sizeof(val));
+  return ((((val + 0x4646464646464646ULL) | (val - 0x3030303030303030ULL)) &
+           0x8080808080808080ULL) == 0);
+}
+
+//! 调用前需要先用IsMadeOfEightDigits判断
+inline std::uint32_t ParseEightDigits(const char* str) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  std::uint64_t val;
+  std::memcpy(&val, str, sizeof(val));
+  //! mul1 = 100 + (1000000 << 32), mul2 = 1 + (10000 << 32)
+  constexpr std::uint64_t mask = 0x000000FF000000FFULL;
+  constexpr std::uint64_t mul1 = 0x000F424000000064ULL;
+  constexpr std::uint64_t mul2 = 0x0000271000000001ULL;
+  val -= 0x3030303030303030ULL;
+  val = (val * 10) + (val >> 8);
+  val = (((val & mask) * mul1) + (((val >> 16) & mask) * mul2)) >> 32;
+  return static_cast<std::uint32_t>(val);
+#else
+  std::uint32_t ret = 0;
+  for (int i = 0; i < 8; ++i) {
+    ret = ret * 10 + static_cast<std::uint32_t>(str[i] - '0');
+  }
+  return ret;
+#endif
+}
+
+//! 从str开始累加连续的数字，返回第一个非数字的位置
+inline const char* AccumulateDigits(const char* str, const char* end,
+                                    std::uint64_t& value) {
+  while (end - str >= 8 && IsMadeOfEightDigits(str)) {
+    value = value * 100000000ULL + ParseEightDigits(str);
+    str += 8;
+  }
+  for (; str < end; ++str) {
+    const auto digit = static_cast<std::uint32_t>(*str - '0');
+    if (digit > 9) {
+      break;
+    }
+    value = value * 10 + digit;
+  }
+  return str;
+}
+
+inline bool ParseDecimal(const char* str, std::size_t len,
+                         ParsedDecimal& parsedDecimal) {
+  if (str == nullptr || len == 0) {
+    return false;
+  }
+
+  const char* end = str + len;
+  parsedDecimal.negative_ = false;
+  if (*str == '-' || *str == '+') {
+    parsedDecimal.negative_ = (*str == '-');
+    ++str;
+  }
+
+  std::uint64_t mantissa = 0;
+  const char* endOfInt = AccumulateDigits(str, end, mantissa);
+  std::size_t numOfDigits = endOfInt - str;
+
+  std::size_t numOfFracDigits = 0;
+  const char* cur = endOfInt;
+  if (cur < end && *cur == '.') {
+    const char* beginOfFrac = cur + 1;
+    cur = AccumulateDigits(beginOfFrac, end, mantissa);
+    numOfFracDigits = cur - beginOfFrac;
+    numOfDigits += numOfFracDigits;
+  }
+
+  //! 超过19位的时候mantissa可能已经溢出，交给调用者处理
+  if (cur != end || numOfDigits == 0 ||
+      numOfDigits > MAX_NUM_OF_DIGITS_IN_PARSED_DECIMAL) {
+    return false;
+  }
+
+  parsedDecimal.mantissa_ = mantissa;
+  parsedDecimal.scale_ = static_cast<std::uint32_t>(numOfFracDigits);
+  return true;
+}
+
+//!
+//! 字符串转double，快速路径的结果和strtod完全一致，无法走快速路径的时候退回
+//! strtod（程序中没有调用setlocale，小数点始终是'.'），此时str必须以'\0'结尾，
+//! yyjson_get_str返回的字符串满足这个条件
+//!
+inline double Str2Dbl(const char* str, std::size_t len) {
+  ParsedDecimal parsedDecimal;
+  if (ParseDecimal(str, len, parsedDecimal) &&
+      parsedDecimal.mantissa_ <= MAX_MANTISSA_OF_EXACT_DBL) {
+    const auto ret = static_cast<double>(parsedDecimal.mantissa_) /
+                     DBL_POW10_TBL[parsedDecimal.scale_];
+    return parsedDecimal.negative_ ? -ret : ret;
+  }
+  return str == nullptr ? 0 : std::strtod(str, nullptr);
+}
+
+inline double Str2Dbl(const char* str) {
+  return Str2Dbl(str, str == nullptr ? 0 : std::strlen(str));
+}
+
+//!
+//! 字符串转换为已知精度的整数，比如 precision 为 8 时 "0.01" 转换为 1000000，
+//! 小数位数超出精度的部分四舍五入，溢出或者格式不支持的时候返回false
+//!
+inline bool Str2ScaledInt(const char* str, std::size_t len,
+                          std::uint32_t precision, std::int64_t& value) {
+  ParsedDecimal parsedDecimal;
+  if (precision > MAX_NUM_OF_DIGITS_IN_PARSED_DECIMAL ||
+      !ParseDecimal(str, len, parsedDecimal)) {
+    return false;
+  }
+
+  auto mantissa = parsedDecimal.mantissa_;
+  if (parsedDecimal.scale_ > precision) {
+    const auto divisor = POW10_TBL[parsedDecimal.scale_ - precision];
+    mantissa = mantissa / divisor + (mantissa % divisor >= divisor / 2 ? 1 : 0);
+  } else if (parsedDecimal.scale_ < precision) {
+    const auto multiplier = POW10_TBL[precision - parsedDecimal.scale_];
+    if (mantissa > static_cast<std::uint64_t>(INT64_MAX) / multiplier) {
+      return false;
+    }
+    mantissa *= multiplier;
+  }
+  if (mantissa > static_cast<std::uint64_t>(INT64_MAX)) {
+    return false;
+  }
+
+  value = parsedDecimal.negative_ ? -static_cast<std::int64_t>(mantissa)
+                                  : static_cast<std::int64_t>(mantissa);
+  return true;
+}
+
+inline bool Str2ScaledInt(const char* str, std::uint32_t precision,
+                          std::int64_t& value) {
+  return Str2ScaledInt(str, str == nullptr ? 0 : std::strlen(str), precision,
+                       value);
+}
+
+}  // namespace bq
@@ -0,0 +1,94 @@
+/*!
+ * \file LatencyHistogram.hpp
+ * \project BetterQuant
+ *
+ * \author byrnexu
+ * \date 2023/04/05
+ *
+ * \brief
+ */
+
+#pragma once
+
+#include "util/PchBase.hpp"
+
+namespace bq {
+
+//! 低7位是桶内的线性部分，相对误差不超过1/64
+constexpr static std::size_t BITS_OF_LATENCY_SUB_BUCKET = 7;
+constexpr static std::size_t NUM_OF_LATENCY_HALF_SUB_BUCKET =
+    1ULL << (BITS_OF_LATENCY_SUB_BUCKET - 1);
+//! 最大记录2^40，超过的按最大值记录
+constexpr static std::uint64_t MAX_VALUE_OF_LATENCY_HISTOGRAM =
+    (1ULL << 40) - 1;
+constexpr static std::size_t NUM_OF_LATENCY_BUCKET =
+    (40 - BITS_OF_LATENCY_SUB_BUCKET + 2) * NUM_OF_LATENCY_HALF_SUB_BUCKET;
+
+//! 直方图某一时刻的快照，可以合并多个线程的快照后再计算分位数
+struct LatencyHistogramData {
+  std::array<std::uint64_t, NUM_OF_LATENCY_BUCKET> bucketGroup_{};
+  std::uint64_t num_{0};
+  std::uint64_t total_{0};
+  std::uint64_t max_{0};
+
+  void merge(const LatencyHistogramData& rhs);
+
+  //! 返回分位数所在桶的上限
+  std::uint64_t getPercentile(double percentile) const;
+
+  std::string toStr() const;
+};
+
+class LatencyHistogram;
+using LatencyHistogramSPtr = std::shared_ptr<LatencyHistogram>;
+
+//!
+//! 对数分级、级内线性分桶的时延直方图（HDR），小于128的值精确统计，其他的值
+//! 相对误差不超过1/64。所有计数都是原子加，多个线程可以同时写入，不加锁。
+//!
+class LatencyHistogram {
+ public:
+  LatencyHistogram(const LatencyHistogram&) = delete;
+  LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+  LatencyHistogram(const LatencyHistogram&&) = delete;
+  LatencyHistogram& operator=(const LatencyHistogram&&) = delete;
+
+  LatencyHistogram() = default;
+
+ public:
+  void record(std::uint64_t latency) {
+    latency = std::min(latency, MAX_VALUE_OF_LATENCY_HISTOGRAM);
+    bucketGroup_[GetBucketNo(latency)].fetch_add(1, std::memory_order_relaxed);
+    num_.fetch_add(1, std::memory_order_relaxed);
+    total_.fetch_add(latency, std::memory_order_relaxed);
+    auto max = max_.load(std::memory_order_relaxed);
+    while (max < latency && !max_.compare_exchange_weak(
+                                max, latency, std::memory_order_relaxed)) {
+    }
+  }
+
+  LatencyHistogramData getData() const;
+  void reset();
+
+  static std::size_t GetBucketNo(std::uint64_t value) {
+    if (value < NUM_OF_LATENCY_HALF_SUB_BUCKET * 2) return value;
+    const std::size_t shift =
+        63 - __builtin_clzll(value) - (BITS_OF_LATENCY_SUB_BUCKET - 1);
+    return shift * NUM_OF_LATENCY_HALF_SUB_BUCKET + (value >> shift);
+  }
+
+  static std::uint64_t GetUpperBoundOfBucket(std::size_t bucketNo) {
+    if (bucketNo < NUM_OF_LATENCY_HALF_SUB_BUCKET * 2) return bucketNo;
+    const std::size_t shift = bucketNo / NUM_OF_LATENCY_HALF_SUB_BUCKET - 1;
+    const std::uint64_t sub = bucketNo - shift * NUM_OF_LATENCY_HALF_SUB_BUCKET;
+    return ((sub + 1) << shift) - 1;
+  }
+
+ private:
+  std::array<std::atomic<std::uint64_t>, NUM_OF_LATENCY_BUCKET> bucketGroup_{};
+  std::atomic<std::uint64_t> num_{0};
+  std::atomic<std::uint64_t> total_{0};
+  std::atomic<std::uint64_t> max_{0};
+};
+
+}  // namespace bq
@@ -0,0 +1,58 @@
+/*!
+ * \file LatencyTrace.hpp
+ * \project BetterQuant
+ *
+ * \author byrnexu
+ * \date 2023/04/16
+ *
+ * \brief
+ */
+
+#pragma once
+
+#include "util/LatencyHistogram.hpp"
+#include "util/LatencyTraceDef.hpp"
+#include "util/Pch.hpp"
+
+namespace bq {
+
+//!
+//! 进程内的时延追踪，默认关闭：
+//! 1. 行情、订单经过每个环节的时候在随消息传递的记录中写入tsc，并把和上一个
+//!    经过的环节之间的时延（纳秒）记入该环节的直方图；
+//! 2. 每个进程只统计自己经过的环节，通过dump（或者向进程发送SIGUSR1）输出；
+//! 3. 关闭的时候stamp直接返回0，消息中不写入tsc。
+//!
+class LatencyTrace : public boost::serialization::singleton<LatencyTrace> {
+ public:
+  LatencyTrace();
+
+ public:
+  //! 开启的时候校准tsc和纳秒的比例，耗时约10ms
+  void enable();
+  //! 和enable中的release配对，看到true的时候nsPerTSC_已经写入
+  bool enabled() const { return enabled_.load(std::memory_order_acquire); }
+
+  //! 写入当前tsc并统计和tscOfPrevHop之间的时延，返回写入的tsc
+  std::uint64_t stamp(TraceHop traceHop, std::uint64_t tscOfPrevHop);
+
+  //! 上一个环节取traceRecord中最近一个已经经过的环节
+  void stamp(TraceRecord& traceRecord, TraceHop traceHop);
+
+  //! 上一个环节取traceCtx中的tscOfPrevHop_，写入后更新为当前tsc
+  void stamp(TraceCtx& traceCtx, TraceHop traceHop);
+
+  std::string dump() const;
+  void reset();
+
+ private:
+  void record(TraceHop traceHop, std::uint64_t tsc, std::uint64_t tscOfPrev);
+
+ private:
+  std::atomic<bool> enabled_{false};
+  double nsPerTSC_{1.0};
+  //! 构造的时候创建好，之后不再变化，写入和读取的线程都不需要同步
+  std::vector<std::unique_ptr<LatencyHistogram>> histogramGroup_;
+};
+
+}  // namespace bq
@@ -0,0 +1,113 @@
+/*!
+ * \file LatencyTraceDef.hpp
+ * \project BetterQuant
+ *
+ * \author byrnexu
+ * \date 2023/04/16
+ *
+ * \brief
+ */
+
+#pragma once
+
+#include "util/PchBase.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace bq {
+
+//! 从收到行情到交易所确认订单途经的各个环节，按先后顺序排列
+enum class TraceHop : std::uint8_t {
+  MDRecv = 0,
+  MDPub,
+  StgEngDispatch,
+  StgCallback,
+  OrderSend,
+  TDSrvRecv,
+  RiskCtrlModule0,
+  RiskCtrlModule1,
+  RiskCtrlModule2,
+  RiskCtrlModule3,
+  RiskCtrlModule4,
+  RiskCtrlModule5,
+  GatewaySend,
+  ExchAck,
+  TickToOrder
+};
+
+//! TickToOrder不是一个环节，是MDRecv到GatewaySend的汇总，不占用TraceRecord
+constexpr static std::size_t NUM_OF_TRACE_HOP =
+    static_cast<std::size_t>(TraceHop::TickToOrder);
+constexpr static std::size_t NUM_OF_TRACED_RISK_CTRL_MODULE = 6;
+
+//! 超过NUM_OF_TRACED_RISK_CTRL_MODULE的风控模组共用最后一个环节
+inline TraceHop GetTraceHopOfRiskCtrlModule(std::uint32_t no) {
+  return static_cast<TraceHop>(
+      static_cast<std::uint8_t>(TraceHop::RiskCtrlModule0) +
+      std::min<std::uint32_t>(no, NUM_OF_TRACED_RISK_CTRL_MODULE - 1));
+}
+
+//! 同一台机器上各个进程读到的tsc是一致的，因此可以跨进程计算时延
+inline std::uint64_t GetTSC() {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+#endif
+}
+
+//!
+//! 策略引擎线程内的时延追踪记录，每个环节写入经过时的tsc，没有经过的环节为0。
+//! 固定128字节，只在线程内使用，下单的时候转成TraceCtx随订单传递。
+//!
+struct TraceRecord {
+  std::uint64_t tscGroup_[16]{0};
+
+  std::uint64_t get(TraceHop traceHop) const {
+    return tscGroup_[static_cast<std::size_t>(traceHop)];
+  }
+  void set(TraceHop traceHop, std::uint64_t tsc) {
+    tscGroup_[static_cast<std::size_t>(traceHop)] = tsc;
+  }
+
+  //! traceHop之前最近一个经过的环节的tsc，没有的话返回0
+  std::uint64_t getTSCOfPrevHop(TraceHop traceHop) const {
+    for (auto i = static_cast<std::size_t>(traceHop); i > 0; --i) {
+      if (tscGroup_[i - 1] != 0) return tscGroup_[i - 1];
+    }
+    return 0;
+  }
+
+  //! 最早经过的环节的tsc，没有的话返回0
+  std::uint64_t getTSCOfFirstHop() const {
+    for (std::size_t i = 0; i < NUM_OF_TRACE_HOP; ++i) {
+      if (tscGroup_[i] != 0) return tscGroup_[i];
+    }
+    return 0;
+  }
+};
+
+static_assert(sizeof(TraceRecord) == 128, "sizeof(TraceRecord) == 128");
+static_assert(NUM_OF_TRACE_HOP <= 16, "NUM_OF_TRACE_HOP <= 16");
+
+//!
+//! 随订单传递的时延追踪上下文，只保存最早经过的环节和上一个经过的环节的tsc，
+//! 固定16字节，未开启时延追踪的时候全为0。
+//!
+struct TraceCtx {
+  std::uint64_t tscOfFirstHop_{0};
+  std::uint64_t tscOfPrevHop_{0};
+};
+
+static_assert(sizeof(TraceCtx) == 16, "sizeof(TraceCtx) == 16");
+
+inline TraceCtx MakeTraceCtx(const TraceRecord& traceRecord) {
+  return {traceRecord.getTSCOfFirstHop(),
+          traceRecord.getTSCOfPrevHop(TraceHop::TickToOrder)};
+}
+
+}  // namespace bq
@@ -0,0 +1,207 @@
+/*!
+ * \file MemPool.hpp
+ * \project BetterQuant
+ *
+ * \author byrnexu
+ * \date 2023/04/14
+ *
+ * \brief
+ */
+
+#pragma once
+
+#include <algorithm>
+
+#include "util/PchBase.hpp"
+#include "util/RingQueue.hpp"
+
+namespace bq {
+
+struct MemPoolStatistic {
+  std::size_t blockSize_{0};
+  std::size_t numOfBlock_{0};
+  std::uint64_t numOfInUse_{0};
+  std::uint64_t maxNumOfInUse_{0};
+  std::uint64_t numOfAlloc_{0};
+  std::uint64_t numOfExhausted_{0};
+
+  std::string toStr() const {
+    return "[blockSize = " + std::to_string(blockSize_) +
+           "; numOfBlock = " + std::to_string(numOfBlock_) +
+           "; numOfInUse = " + std::to_string(numOfInUse_) +
+           "; maxNumOfInUse = " + std::to_string(maxNumOfInUse_) +
+           "; numOfAlloc = " + std::to_string(numOfAlloc_) +
+           "; numOfExhausted = " + std::to_string(numOfExhausted_) + "]";
+  }
+};
+
+//!
+//! 定长内存块池：
+//! 1. 构造的时候一次性申请所有内存块，空闲块组成一个无锁的栈，分配和回收
+//!    只需要一次cas，可以在不同的线程中分配和回收；
+//! 2. 栈顶带一个版本号，避免ABA问题；
+//! 3. 后进先出，最近回收的块最先被复用，缓存是热的，并且没有用到的内存页
+//!    不会被操作系统真正分配，池可以按最坏情况设置得比较大；
+//! 4. 池耗尽或者申请的大小超过块大小的时候退回malloc并计数，回收的时候按
+//!    地址判断是否属于池。
+//!
+class FixedSizeMemPool {
+  constexpr static std::uint32_t INVALID_IDX = UINT32_MAX;
+
+ public:
+  FixedSizeMemPool(const FixedSizeMemPool&) = delete;
+  FixedSizeMemPool& operator=(const FixedSizeMemPool&) = delete;
+  FixedSizeMemPool(const FixedSizeMemPool&&) = delete;
+  FixedSizeMemPool& operator=(const FixedSizeMemPool&&) = delete;
+
+  //! 块大小向上取整到缓存行大小，每个块都按缓存行对齐
+  FixedSizeMemPool(std::size_t blockSize, std::size_t numOfBlock)
+      : blockSize_((blockSize + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE *
+                   CACHE_LINE_SIZE),
+        numOfBlock_(std::min<std::size_t>(numOfBlock, INVALID_IDX)) {
+    if (numOfBlock_ != 0) {
+      buf_ = static_cast<char*>(
+          std::aligned_alloc(CACHE_LINE_SIZE, blockSize_ * numOfBlock_));
+    }
+    if (buf_ == nullptr) {
+      numOfBlock_ = 0;
+      return;
+    }
+    nextIdxGroup_ = std::make_unique<std::atomic<std::uint32_t>[]>(numOfBlock_);
+    for (std::size_t i = 0; i < numOfBlock_; ++i) {
+      const auto nextIdx = i + 1 < numOfBlock_ ? i + 1 : INVALID_IDX;
+      nextIdxGroup_[i].store(nextIdx, std::memory_order_relaxed);
+    }
+    head_.store(0, std::memory_order_release);
+  }
+
+  ~FixedSizeMemPool() { std::free(buf_); }
+
+ public:
+  void* alloc(std::size_t size) {
+    numOfAlloc_.fetch_add(1, std::memory_order_relaxed);
+    const auto idx = size <= blockSize_ ? pop() : INVALID_IDX;
+    if (idx == INVALID_IDX) {
+      numOfExhausted_.fetch_add(1, std::memory_order_relaxed);
+      return std::malloc(size);
+    }
+
+    const auto numOfInUse =
+        numOfInUse_.fetch_add(1, std::memory_order_relaxed) + 1;
+    auto maxNumOfInUse = maxNumOfInUse_.load(std::memory_order_relaxed);
+    while (numOfInUse > maxNumOfInUse &&
+           !maxNumOfInUse_.compare_exchange_weak(maxNumOfInUse, numOfInUse,
+                                                 std::memory_order_relaxed)) {
+    }
+    return buf_ + idx * blockSize_;
+  }
+
+  void free(void* data) {
+    if (data == nullptr) return;
+    if (!isFromPool(data)) {
+      std::free(data);
+      return;
+    }
+    const auto idx = static_cast<std::uint32_t>(
+        (static_cast<char*>(data) - buf_) / blockSize_);
+    push(idx);
+    numOfInUse_.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  bool isFromPool(const void* data) const {
+    const auto addr = static_cast<const char*>(data);
+    return addr >= buf_ && addr < buf_ + blockSize_ * numOfBlock_;
+  }
+
+  std::size_t getBlockSize() const { return blockSize_; }
+
+  MemPoolStatistic getStatistic() const {
+    MemPoolStatistic ret;
+    ret.blockSize_ = blockSize_;
+    ret.numOfBlock_ = numOfBlock_;
+    ret.numOfInUse_ = numOfInUse_.load(std::memory_order_relaxed);
+    ret.maxNumOfInUse_ = maxNumOfInUse_.load(std::memory_order_relaxed);
+    ret.numOfAlloc_ = numOfAlloc_.load(std::memory_order_relaxed);
+    ret.numOfExhausted_ = numOfExhausted_.load(std::memory_order_relaxed);
+    return ret;
+  }
+
+ private:
+  //! 栈顶的低32位是块的下标，高32位是版本号
+  std::uint32_t pop() {
+    auto head = head_.load(std::memory_order_acquire);
+    while (true) {
+      const auto idx = static_cast<std::uint32_t>(head);
+      if (idx == INVALID_IDX) return INVALID_IDX;
+      const auto nextIdx = nextIdxGroup_[idx].load(std::memory_order_relaxed);
+      const auto newHead = ((head >> 32) + 1) << 32 | nextIdx;
+      if (head_.compare_exchange_weak(head, newHead,
+                                      std::memory_order_acquire)) {
+        return idx;
+      }
+    }
+  }
+
+  void push(std::uint32_t idx) {
+    auto head = head_.load(std::memory_order_relaxed);
+    while (true) {
+      nextIdxGroup_[idx].store(static_cast<std::uint32_t>(head),
+                               std::memory_order_relaxed);
+      const auto newHead = ((head >> 32) + 1) << 32 | idx;
+      if (head_.compare_exchange_weak(head, newHead,
+                                      std::memory_order_release)) {
+        return;
+      }
+    }
+  }
+
+ private:
+  std::size_t blockSize_{0};
+  std::size_t numOfBlock_{0};
+  char* buf_{nullptr};
+  std::unique_ptr<std::atomic<std::uint32_t>[]> nextIdxGroup_;
+
+  alignas(CACHE_LINE_SIZE) std::atomic<std::uint64_t> head_{INVALID_IDX};
+
+  alignas(CACHE_LINE_SIZE) std::atomic<std::uint64_t> numOfInUse_{0};
+  std::atomic<std::uint64_t> maxNumOfInUse_{0};
+  std::atomic<std::uint64_t> numOfAlloc_{0};
+  std::atomic<std::uint64_t> numOfExhausted_{0};
+};
+using FixedSizeMemPoolSPtr = std::shared_ptr<FixedSizeMemPool>;
+
+//!
+//! 用于std::allocate_shared，对象和引用计数在同一个内存块中，分配器持有
+//! 内存池的shared_ptr，保证最后一个对象回收之前内存池不会析构
+//!
+template <typename T>
+class MemPoolAllocator {
+ public:
+  using value_type = T;
+
+  explicit MemPoolAllocator(const FixedSizeMemPoolSPtr& memPool)
+      : memPool_(memPool) {}
+
+  template <typename U>
+  MemPoolAllocator(const MemPoolAllocator<U>& other)
+      : memPool_(other.memPool_) {}
+
+  T* allocate(std::size_t num) {
+    return static_cast<T*>(memPool_->alloc(num * sizeof(T)));
+  }
+
+  void deallocate(T* data, std::size_t num) { memPool_->free(data); }
+
+  template <typename U>
+  bool operator==(const MemPoolAllocator<U>& other) const {
+    return memPool_ == other.memPool_;
+  }
+  template <typename U>
+  bool operator!=(const MemPoolAllocator<U>& other) const {
+    return memPool_ != other.memPool_;
+  }
+
+  FixedSizeMemPoolSPtr memPool_;
+};
+
+}  // namespace bq
@@ -11,12 +11,15 @@
 #pragma once
 
 #include <any>
+#include <array>
+#include <atomic>
 #include <charconv>
 #include <chrono>
 #include <condition_variable>
 #include <cstddef>
 #include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <ctime>
 #include <deque>
 #include <forward_list>
@@ -28,6 +31,7 @@
 #include <list>
 #include <mutex>
 #include <optional>
+#include <queue>
 #include <random>
 #include <regex>
 #include <set>
@@ -0,0 +1,126 @@
+/*!
+ * \file RingQueue.hpp
+ * \project BetterQuant
+ *
+ * \author byrnexu
+ * \date 2023/04/03
+ *
+ * \brief
+ */
+
+#pragma once
+
+#include "util/PchBase.hpp"
+
+namespace bq {
+
+constexpr static std::size_t CACHE_LINE_SIZE = 64;
+
+//!
+//! 有界的多生产者多消费者无锁环形队列（Dmitry Vyukov算法）：
+//! 1. 所有槽位在构造的时候一次性分配，元素按值存放在槽位中，入队出队没有内存分配；
+//! 2. 每个槽位带一个序号，生产者和消费者各自通过cas抢占位置，不需要加锁，
+//!    单生产者或者单消费者的场景同样适用；
+//! 3. 队列满的时候tryPush返回false，由调用方决定等待还是丢弃。
+//!
+template <typename T>
+class RingQueue {
+  struct alignas(CACHE_LINE_SIZE) Slot {
+    std::atomic<std::size_t> seq_{0};
+    T data_;
+  };
+
+ public:
+  RingQueue(const RingQueue&) = delete;
+  RingQueue& operator=(const RingQueue&) = delete;
+  RingQueue(const RingQueue&&) = delete;
+  RingQueue& operator=(const RingQueue&&) = delete;
+
+  //! 容量向上取整到2的幂次，便于用位运算代替取模
+  explicit RingQueue(std::size_t capacity) {
+    capacity_ = 2;
+    while (capacity_ < capacity) capacity_ <<= 1;
+    mask_ = capacity_ - 1;
+    slotGroup_ = std::make_unique<Slot[]>(capacity_);
+    for (std::size_t i = 0; i < capacity_; ++i) {
+      slotGroup_[i].seq_.store(i, std::memory_order_relaxed);
+    }
+  }
+
+ public:
+  template <typename U>
+  bool tryPush(U&& data) {
+    auto pos = posOfPush_.load(std::memory_order_relaxed);
+    while (true) {
+      auto& slot = slotGroup_[pos & mask_];
+      const auto seq = slot.seq_.load(std::memory_order_acquire);
+      const auto diff =
+          static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+      if (diff == 0) {
+        if (posOfPush_.compare_exchange_weak(pos, pos + 1,
+                                             std::memory_order_relaxed)) {
+          slot.data_ = std::forward<U>(data);
+          slot.seq_.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = posOfPush_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  bool tryPop(T& data) {
+    auto pos = posOfPop_.load(std::memory_order_relaxed);
+    while (true) {
+      auto& slot = slotGroup_[pos & mask_];
+      const auto seq = slot.seq_.load(std::memory_order_acquire);
+      const auto diff = static_cast<std::intptr_t>(seq) -
+                        static_cast<std::intptr_t>(pos + 1);
+      if (diff == 0) {
+        if (posOfPop_.compare_exchange_weak(pos, pos + 1,
+                                            std::memory_order_relaxed)) {
+          data = std::move(slot.data_);
+          slot.seq_.store(pos + capacity_, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = posOfPop_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  //! 最多取出maxNum个元素依次写入first开始的位置，返回实际取出的数量
+  template <typename Iter>
+  std::size_t tryPopBulk(Iter first, std::size_t maxNum) {
+    std::size_t num = 0;
+    while (num < maxNum && tryPop(*first)) {
+      ++first;
+      ++num;
+    }
+    return num;
+  }
+
+  //! 并发情况下只是一个近似值
+  std::size_t size_approx() const {
+    const auto posOfPush = posOfPush_.load(std::memory_order_relaxed);
+    const auto posOfPop = posOfPop_.load(std::memory_order_relaxed);
+    return posOfPush > posOfPop ? posOfPush - posOfPop : 0;
+  }
+
+  std::size_t capacity() const { return capacity_; }
+
+ private:
+  std::size_t capacity_{0};
+  std::size_t mask_{0};
+  std::unique_ptr<Slot[]> slotGroup_;
+
+  //! 生产者和消费者的位置放在不同的缓存行，避免伪共享
+  alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> posOfPush_{0};
+  alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> posOfPop_{0};
+};
+
+}  // namespace bq
@@ -55,6 +55,10 @@ class SvcBase {
   virtual int afterRun();
 
  private:
+  SignalHandlerSPtr makeSignalHandler();
+
+ protected:
+  //! 收到退出信号时调用，服务也可以在不需要等待信号的时候直接调用
   void exit(const boost::system::error_code* ec, int signalNum);
 
  private:
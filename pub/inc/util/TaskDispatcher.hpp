@@ -15,7 +15,10 @@
 #include "def/Def.hpp"
 #include "util/Logger.hpp"
 #include "util/Pch.hpp"
+#include "util/RingQueue.hpp"
 #include "util/StdExt.hpp"
+#include "util/TaskWaiter.hpp"
+#include "util/Util.hpp"
 
 namespace bq {
 
@@ -45,6 +48,46 @@ using AsyncTaskBulk = std::deque<AsyncTaskSPtr<Task>>;
 template <typename Task>
 using AsyncTaskBulkSPtr = std::shared_ptr<AsyncTaskBulk<Task>>;
 
+//!
+//! 队列的统计信息，只有环形队列模式下才会统计，moodycamel队列模式下只有depth_，
+//! 时延为任务从入队到被工作线程取出的时间
+//!
+struct TaskQueueStatistic {
+  std::uint64_t numOfEnqueued_{0};
+  std::uint64_t numOfDequeued_{0};
+  std::uint64_t numOfStolen_{0};
+  std::uint64_t numOfQueueFull_{0};
+  std::uint64_t depth_{0};
+  std::uint64_t nsTotalLatency_{0};
+  std::uint64_t nsMaxLatency_{0};
+
+  std::uint64_t nsAvgLatency() const {
+    return numOfDequeued_ == 0 ? 0 : nsTotalLatency_ / numOfDequeued_;
+  }
+  std::string toStr() const {
+    return fmt::format(
+        "[enqueued = {}; dequeued = {}; stolen = {}; queueFull = {}; "
+        "depth = {}; nsAvgLatency = {}; nsMaxLatency = {}]",
+        numOfEnqueued_, numOfDequeued_, numOfStolen_, numOfQueueFull_, depth_,
+        nsAvgLatency(), nsMaxLatency_);
+  }
+};
+
+struct alignas(CACHE_LINE_SIZE) TaskQueueCounter {
+  std::atomic<std::uint64_t> numOfEnqueued_{0};
+  std::atomic<std::uint64_t> numOfDequeued_{0};
+  std::atomic<std::uint64_t> numOfStolen_{0};
+  std::atomic<std::uint64_t> numOfQueueFull_{0};
+  std::atomic<std::uint64_t> nsTotalLatency_{0};
+  std::atomic<std::uint64_t> nsMaxLatency_{0};
+};
+
+inline std::uint64_t GetNSOfSteadyClock() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
 template <typename Task, BlockType blockType = BlockType::Block>
 class TaskDispatcher;
 
@@ -58,6 +101,20 @@ class TaskDispatcher {
       moodycamel::BlockingConcurrentQueue<AsyncTaskSPtr<Task>>,
       moodycamel::ConcurrentQueue<AsyncTaskSPtr<Task>>>::type;
 
+  //! 环形队列中按值存放的槽位，带上入队时间用于统计排队时延
+  struct AsyncTaskSlot {
+    AsyncTaskSPtr<Task> asyncTask_{nullptr};
+    std::uint64_t nsOfEnqueue_{0};
+  };
+
+  struct AsyncTaskRingQueue {
+    explicit AsyncTaskRingQueue(std::size_t capacity) : queue_(capacity) {}
+    RingQueue<AsyncTaskSlot> queue_;
+    TaskQueueCounter counter_;
+    TaskWaiter taskWaiter_;
+  };
+  using AsyncTaskRingQueueUPtr = std::unique_ptr<AsyncTaskRingQueue>;
+
  public:
   TaskDispatcher(const TaskDispatcher&) = delete;
   TaskDispatcher& operator=(const TaskDispatcher&) = delete;
@@ -78,9 +135,16 @@ class TaskDispatcher {
         cbOnThreadExit_(cbOnThreadExit) {}
 
   void init() {
+    useRingQueue_ = taskDispatcherParam_->queueCapacity_ != 0;
+    if (useRingQueue_) {
+      initRingQueue();
+    }
+
     for (std::uint32_t i = 0;
          i < taskDispatcherParam_->taskSpecificThreadPoolSize_; ++i) {
-      taskSpecificQueueGroup_.emplace_back(AsyncQueueType());
+      if (!useRingQueue_) {
+        taskSpecificQueueGroup_.emplace_back(AsyncQueueType());
+      }
       {
         std::lock_guard<std::ext::spin_mutex> guard(mtxTaskSpecificThreadPool_);
         taskSpecificThreadPool_.emplace_back(std::shared_ptr<std::thread>());
@@ -92,7 +156,7 @@ class TaskDispatcher {
     for (std::uint32_t i = 0;
          i < taskDispatcherParam_->taskRandAssignedThreadPoolSize_; ++i) {
       taskRandAssignedThreadPool_.emplace_back(
-          std::thread([this]() { doStart(); }));
+          std::thread([this, i]() { doStartOfRandAssignedThread(i); }));
     }
     //!
     //! TDSrv收到报单请求的时候，由于发起报单请求的时候，在StgEng已经将该订单入库，
@@ -111,60 +175,216 @@ class TaskDispatcher {
   }
 
  private:
-  void doStart() {
+  void initRingQueue() {
+    const auto capacity = taskDispatcherParam_->queueCapacity_;
+    for (std::uint32_t i = 0;
+         i < taskDispatcherParam_->taskSpecificThreadPoolSize_; ++i) {
+      ringQueueGroupOfTaskSpecificThread_.emplace_back(
+          std::make_unique<AsyncTaskRingQueue>(capacity));
+    }
+
+    //! 开启任务窃取时每个随机线程有自己的队列，否则所有随机线程共用一个队列
+    const auto numOfRandAssignedQueue =
+        taskDispatcherParam_->enableWorkStealing_
+            ? std::max<std::uint32_t>(
+                  1, taskDispatcherParam_->taskRandAssignedThreadPoolSize_)
+            : 1;
+    for (std::uint32_t i = 0; i < numOfRandAssignedQueue; ++i) {
+      ringQueueGroupOfTaskRandAssignedThread_.emplace_back(
+          std::make_unique<AsyncTaskRingQueue>(capacity));
+    }
+  }
+
+  void bindCpu(const std::vector<int>& cpuIdGroup, std::uint32_t index) {
+    if (cpuIdGroup.empty()) return;
+    const auto cpuId = cpuIdGroup[index % cpuIdGroup.size()];
+    if (SetCpuAffinityOfCurThread(cpuId) == 0) {
+      LOG_I("[{}] Bind thread {} to cpu {}.",
+            taskDispatcherParam_->moduleName_, index, cpuId);
+    }
+  }
+
+  void doStartOfRandAssignedThread(std::uint32_t index) {
     std::ext::tls_get<ThreadInfo>().no_ = RAND_THREAD;
+    bindCpu(taskDispatcherParam_->cpuIdGroupOfTaskRandAssignedThread_, index);
+    if (useRingQueue_) {
+      doStartOfRandAssignedThreadWithRingQueue(index);
+      return;
+    }
+
+    //! 存放异步任务的缓冲区在线程启动时分配一次，之后反复使用
+    AsyncTaskBulk<Task> asyncTaskBulk(
+        taskDispatcherParam_->maxBulkRecvTaskNumEveryTime_);
+
     while (stopped_ == false || taskRandAssignedQueue_.size_approx() != 0) {
       //! 检查队列堆积情况
       checkUnprocessedAsyncTaskAndAlert(taskRandAssignedQueue_, RAND_THREAD);
 
-      //! 生出存放异步任务的队列
-      auto asyncTaskBulk = std::make_shared<AsyncTaskBulk<Task>>(
-          taskDispatcherParam_->maxBulkRecvTaskNumEveryTime_);
-
+      std::size_t asyncTaskNumInQue = 0;
       if constexpr (blockType == BlockType::Block) {
-        if (const auto asyncTaskNumInQue =
-                taskRandAssignedQueue_.wait_dequeue_bulk_timed(
-                    std::begin(*asyncTaskBulk),
-                    taskDispatcherParam_->maxBulkRecvTaskNumEveryTime_,
-                    std::chrono::milliseconds(
-                        taskDispatcherParam_->timeDurOfWaitForTask_));
-            asyncTaskNumInQue != 0) {
-          asyncTaskBulk->resize(asyncTaskNumInQue);
-        } else {
-          continue;
-        }
-
-        for (auto& asyncTask : *asyncTaskBulk) {
-          if (cbHandleAsyncTask_) cbHandleAsyncTask_(asyncTask);
-        }
+        asyncTaskNumInQue = taskRandAssignedQueue_.wait_dequeue_bulk_timed(
+            std::begin(asyncTaskBulk),
+            taskDispatcherParam_->maxBulkRecvTaskNumEveryTime_,
+            std::chrono::milliseconds(
+                taskDispatcherParam_->timeDurOfWaitForTask_));
+        if (asyncTaskNumInQue == 0) continue;
 
       } else {
-        if (const auto asyncTaskNumInQue =
-                taskRandAssignedQueue_.try_dequeue_bulk(
-                    std::begin(*asyncTaskBulk),
-                    taskDispatcherParam_->maxBulkRecvTaskNumEveryTime_);
-            asyncTaskNumInQue != 0) {
-          asyncTaskBulk->resize(asyncTaskNumInQue);
-        }
-
-        if (asyncTaskBulk->empty()) {
+        asyncTaskNumInQue = taskRandAssignedQueue_.try_dequeue_bulk(
+            std::begin(asyncTaskBulk),
+            taskDispatcherParam_->maxBulkRecvTaskNumEveryTime_);
+        if (asyncTaskNumInQue == 0) {
           if (cbHandleAsyncTask_) {
             AsyncTaskSPtr<Task> asyncTask = nullptr;
             cbHandleAsyncTask_(asyncTask);
           }
-        } else {
-          for (auto& asyncTask : *asyncTaskBulk) {
-            if (cbHandleAsyncTask_) cbHandleAsyncTask_(asyncTask);
-          }
+          continue;
         }
       }
+
+      for (std::size_t i = 0; i < asyncTaskNumInQue; ++i) {
+        if (cbHandleAsyncTask_) cbHandleAsyncTask_(asyncTaskBulk[i]);
+        //! 及时释放任务，避免共享内存中的数据被缓冲区长时间引用
+        asyncTaskBulk[i].reset();
+      }
+    }
+  }
+
+  //!
+  //! 环形队列模式下的随机线程，开启任务窃取时先处理自己的队列，自己的队列为空时
+  //! 依次从其他随机线程的队列中窃取任务，都没有任务时按照自旋、让出cpu、休眠的
+  //! 顺序等待
+  //!
+  void doStartOfRandAssignedThreadWithRingQueue(std::uint32_t index) {
+    const auto numOfQueue = ringQueueGroupOfTaskRandAssignedThread_.size();
+    auto& ownQueue =
+        *ringQueueGroupOfTaskRandAssignedThread_[index % numOfQueue];
+    const auto hasTask = [this]() {
+      for (const auto& queue : ringQueueGroupOfTaskRandAssignedThread_) {
+        if (queue->queue_.size_approx() != 0) return true;
+      }
+      return false;
+    };
+
+    std::vector<AsyncTaskSlot> asyncTaskSlotGroup(
+        taskDispatcherParam_->maxBulkRecvTaskNumEveryTime_);
+    std::uint32_t numOfIdle = 0;
+    while (stopped_ == false || ownQueue.queue_.size_approx() != 0) {
+      checkUnprocessedAsyncTaskAndAlert(ownQueue, RAND_THREAD);
+
+      auto num = dequeueAndHandle(ownQueue, asyncTaskSlotGroup, false);
+      for (std::size_t i = 1; num == 0 && i < numOfQueue; ++i) {
+        auto& queue =
+            *ringQueueGroupOfTaskRandAssignedThread_[(index + i) % numOfQueue];
+        num = dequeueAndHandle(queue, asyncTaskSlotGroup, true);
+      }
+
+      if (num != 0) {
+        numOfIdle = 0;
+      } else {
+        onIdle(numOfIdle, firstRandAssignedQueue().taskWaiter_, hasTask);
+      }
+    }
+  }
+
+  void doStartOfSpecificThreadWithRingQueue(AsyncTaskRingQueue& ringQueue,
+                                            std::uint32_t threadNo) {
+    const auto hasTask = [&ringQueue]() {
+      return ringQueue.queue_.size_approx() != 0;
+    };
+
+    std::vector<AsyncTaskSlot> asyncTaskSlotGroup(
+        taskDispatcherParam_->maxBulkRecvTaskNumEveryTime_);
+    std::uint32_t numOfIdle = 0;
+    while (stopped_ == false || ringQueue.queue_.size_approx() != 0) {
+      checkUnprocessedAsyncTaskAndAlert(ringQueue, threadNo);
+      if (dequeueAndHandle(ringQueue, asyncTaskSlotGroup, false) != 0) {
+        numOfIdle = 0;
+      } else {
+        onIdle(numOfIdle, ringQueue.taskWaiter_, hasTask);
+      }
+    }
+  }
+
+  std::size_t dequeueAndHandle(AsyncTaskRingQueue& ringQueue,
+                               std::vector<AsyncTaskSlot>& asyncTaskSlotGroup,
+                               bool isSteal) {
+    const auto num = ringQueue.queue_.tryPopBulk(
+        std::begin(asyncTaskSlotGroup), asyncTaskSlotGroup.size());
+    if (num == 0) return 0;
+
+    const auto now = GetNSOfSteadyClock();
+    std::uint64_t nsTotalLatency = 0;
+    std::uint64_t nsMaxLatency = 0;
+    for (std::size_t i = 0; i < num; ++i) {
+      const auto nsLatency = now > asyncTaskSlotGroup[i].nsOfEnqueue_
+                                 ? now - asyncTaskSlotGroup[i].nsOfEnqueue_
+                                 : 0;
+      nsTotalLatency += nsLatency;
+      nsMaxLatency = std::max(nsMaxLatency, nsLatency);
+    }
+
+    auto& counter = ringQueue.counter_;
+    counter.numOfDequeued_.fetch_add(num, std::memory_order_relaxed);
+    counter.nsTotalLatency_.fetch_add(nsTotalLatency,
+                                      std::memory_order_relaxed);
+    auto nsMaxLatencyOfQueue =
+        counter.nsMaxLatency_.load(std::memory_order_relaxed);
+    while (nsMaxLatencyOfQueue < nsMaxLatency &&
+           !counter.nsMaxLatency_.compare_exchange_weak(
+               nsMaxLatencyOfQueue, nsMaxLatency, std::memory_order_relaxed)) {
+    }
+    if (isSteal) {
+      counter.numOfStolen_.fetch_add(num, std::memory_order_relaxed);
+    }
+
+    for (std::size_t i = 0; i < num; ++i) {
+      auto& asyncTask = asyncTaskSlotGroup[i].asyncTask_;
+      if (cbHandleAsyncTask_) cbHandleAsyncTask_(asyncTask);
+      asyncTask.reset();
+    }
+    return num;
+  }
+
+  //!
+  //! 空闲时先自旋，再让出cpu，最后休眠等待生产者唤醒。NoBlock模式下每次空闲都会
+  //! 用空任务调用一次回调，保持原有的定时处理语义，此时休眠时长决定了定时精度。
+  //!
+  template <typename CBHasTask>
+  void onIdle(std::uint32_t& numOfIdle, TaskWaiter& taskWaiter,
+              const CBHasTask& hasTask) {
+    if constexpr (blockType == BlockType::NoBlock) {
+      if (cbHandleAsyncTask_) {
+        AsyncTaskSPtr<Task> asyncTask = nullptr;
+        cbHandleAsyncTask_(asyncTask);
+      }
+    }
+
+    const auto spinCount = taskDispatcherParam_->spinCountBeforeYield_;
+    const auto yieldCount = taskDispatcherParam_->yieldCountBeforePark_;
+    if (numOfIdle < spinCount) {
+      ++numOfIdle;
+      CpuRelax();
+    } else if (numOfIdle < spinCount + yieldCount) {
+      ++numOfIdle;
+      std::this_thread::yield();
+    } else {
+      taskWaiter.park(taskDispatcherParam_->timeDurOfWaitForTask_, hasTask);
     }
   }
 
   void doStart(std::uint32_t threadNo) {
     std::ext::tls_get<ThreadInfo>().no_ = threadNo;
+    bindCpu(taskDispatcherParam_->cpuIdGroupOfTaskSpecificThread_, threadNo);
     if (cbOnThreadStart_) cbOnThreadStart_(threadNo);
 
+    if (useRingQueue_) {
+      doStartOfSpecificThreadWithRingQueue(
+          *ringQueueGroupOfTaskSpecificThread_[threadNo], threadNo);
+      if (cbOnThreadExit_) cbOnThreadExit_(threadNo);
+      return;
+    }
+
     while (stopped_ == false ||
            taskSpecificQueueGroup_[threadNo].size_approx() != 0) {
       //! 检查队列堆积情况
@@ -203,9 +423,44 @@ class TaskDispatcher {
     }
   }
 
+  void checkUnprocessedAsyncTaskAndAlert(const AsyncTaskRingQueue& ringQueue,
+                                         std::uint32_t i) {
+    const auto size_approx = ringQueue.queue_.size_approx();
+    if (size_approx > 0 &&
+        size_approx % taskDispatcherParam_->numOfUnprocessedTaskAlert_ == 0) {
+      std::string threadNo =
+          i != RAND_THREAD ? std::to_string(i) : "RAND_THREAD";
+      LOG_W("[{}] Too many unprocessed task info. [threadNo = {}] {}",
+            taskDispatcherParam_->moduleName_, threadNo,
+            MakeTaskQueueStatistic(ringQueue).toStr());
+    }
+  }
+
+  static TaskQueueStatistic MakeTaskQueueStatistic(
+      const AsyncTaskRingQueue& ringQueue) {
+    TaskQueueStatistic ret;
+    const auto& counter = ringQueue.counter_;
+    ret.numOfEnqueued_ = counter.numOfEnqueued_.load(std::memory_order_relaxed);
+    ret.numOfDequeued_ = counter.numOfDequeued_.load(std::memory_order_relaxed);
+    ret.numOfStolen_ = counter.numOfStolen_.load(std::memory_order_relaxed);
+    ret.numOfQueueFull_ =
+        counter.numOfQueueFull_.load(std::memory_order_relaxed);
+    ret.depth_ = ringQueue.queue_.size_approx();
+    ret.nsTotalLatency_ =
+        counter.nsTotalLatency_.load(std::memory_order_relaxed);
+    ret.nsMaxLatency_ = counter.nsMaxLatency_.load(std::memory_order_relaxed);
+    return ret;
+  }
+
  public:
   void stop() {
     stopped_ = true;
+    for (auto& ringQueue : ringQueueGroupOfTaskSpecificThread_) {
+      ringQueue->taskWaiter_.notifyAll();
+    }
+    for (auto& ringQueue : ringQueueGroupOfTaskRandAssignedThread_) {
+      ringQueue->taskWaiter_.notifyAll();
+    }
 
     for (std::uint32_t i = 0;
          i < taskDispatcherParam_->taskSpecificThreadPoolSize_; ++i) {
@@ -260,10 +515,58 @@ class TaskDispatcher {
 
  private:
   inline int dispatchToRandAssignedThread(AsyncTaskSPtr<Task>& asyncTask) {
-    taskRandAssignedQueue_.enqueue(asyncTask);
+    if (!useRingQueue_) {
+      taskRandAssignedQueue_.enqueue(asyncTask);
+      return 0;
+    }
+
+    //! 轮流放入各个随机线程的队列，满了就尝试下一个，全部满了再等待
+    const auto numOfQueue = ringQueueGroupOfTaskRandAssignedThread_.size();
+    const auto index =
+        noOfRandAssignedQueue_.fetch_add(1, std::memory_order_relaxed);
+    AsyncTaskSlot asyncTaskSlot{asyncTask, GetNSOfSteadyClock()};
+    for (std::size_t i = 0; i < numOfQueue; ++i) {
+      auto& ringQueue =
+          *ringQueueGroupOfTaskRandAssignedThread_[(index + i) % numOfQueue];
+      if (ringQueue.queue_.tryPush(asyncTaskSlot)) {
+        ringQueue.counter_.numOfEnqueued_.fetch_add(1,
+                                                    std::memory_order_relaxed);
+        firstRandAssignedQueue().taskWaiter_.notify();
+        return 0;
+      }
+    }
+    auto& ringQueue =
+        *ringQueueGroupOfTaskRandAssignedThread_[index % numOfQueue];
+    enqueueUntilSucc(ringQueue, asyncTaskSlot,
+                     firstRandAssignedQueue().taskWaiter_);
     return 0;
   }
 
+  //! 随机线程共用第一个队列的TaskWaiter，任何一个被唤醒的线程都可以窃取任务
+  AsyncTaskRingQueue& firstRandAssignedQueue() {
+    return *ringQueueGroupOfTaskRandAssignedThread_.front();
+  }
+
+  //! 队列满的时候生产者自旋等待，起到反压的作用
+  void enqueueUntilSucc(AsyncTaskRingQueue& ringQueue,
+                        AsyncTaskSlot& asyncTaskSlot, TaskWaiter& taskWaiter) {
+    if (!ringQueue.queue_.tryPush(asyncTaskSlot)) {
+      ringQueue.counter_.numOfQueueFull_.fetch_add(1,
+                                                   std::memory_order_relaxed);
+      std::uint32_t numOfRetry = 0;
+      while (!ringQueue.queue_.tryPush(asyncTaskSlot)) {
+        taskWaiter.notify();
+        if (++numOfRetry < taskDispatcherParam_->spinCountBeforeYield_) {
+          CpuRelax();
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    }
+    ringQueue.counter_.numOfEnqueued_.fetch_add(1, std::memory_order_relaxed);
+    taskWaiter.notify();
+  }
+
   inline int dispatchToSpecifiedThread(AsyncTaskSPtr<Task>& asyncTask,
                                        std::uint32_t threadNo) {
     if (threadNo >= taskDispatcherParam_->taskSpecificThreadPoolSize_) {
@@ -283,6 +586,13 @@ class TaskDispatcher {
       }
     }
 
+    if (useRingQueue_) {
+      auto& ringQueue = *ringQueueGroupOfTaskSpecificThread_[threadNo];
+      AsyncTaskSlot asyncTaskSlot{asyncTask, GetNSOfSteadyClock()};
+      enqueueUntilSucc(ringQueue, asyncTaskSlot, ringQueue.taskWaiter_);
+      return 0;
+    }
+
     taskSpecificQueueGroup_[threadNo].enqueue(asyncTask);
     return 0;
   }
@@ -292,8 +602,41 @@ class TaskDispatcher {
     return taskDispatcherParam_;
   }
 
+  //! threadNo为RAND_THREAD时返回所有随机线程队列的汇总
+  TaskQueueStatistic getTaskQueueStatistic(std::uint32_t threadNo) const {
+    TaskQueueStatistic ret;
+    if (!useRingQueue_) {
+      if (threadNo == RAND_THREAD) {
+        ret.depth_ = taskRandAssignedQueue_.size_approx();
+      } else if (threadNo < taskSpecificQueueGroup_.size()) {
+        ret.depth_ = taskSpecificQueueGroup_[threadNo].size_approx();
+      }
+      return ret;
+    }
+
+    if (threadNo != RAND_THREAD) {
+      if (threadNo < ringQueueGroupOfTaskSpecificThread_.size()) {
+        ret = MakeTaskQueueStatistic(
+            *ringQueueGroupOfTaskSpecificThread_[threadNo]);
+      }
+      return ret;
+    }
+
+    for (const auto& ringQueue : ringQueueGroupOfTaskRandAssignedThread_) {
+      const auto statistic = MakeTaskQueueStatistic(*ringQueue);
+      ret.numOfEnqueued_ += statistic.numOfEnqueued_;
+      ret.numOfDequeued_ += statistic.numOfDequeued_;
+      ret.numOfStolen_ += statistic.numOfStolen_;
+      ret.numOfQueueFull_ += statistic.numOfQueueFull_;
+      ret.depth_ += statistic.depth_;
+      ret.nsTotalLatency_ += statistic.nsTotalLatency_;
+      ret.nsMaxLatency_ = std::max(ret.nsMaxLatency_, statistic.nsMaxLatency_);
+    }
+    return ret;
+  }
+
  private:
-  bool stopped_{false};
+  std::atomic<bool> stopped_{false};
 
   CBMsgParser<Task> cbMsgParser_{nullptr};
   CBGetThreadNoForTask<Task> cbGetThreadNoForTask_{nullptr};
@@ -310,6 +653,12 @@ class TaskDispatcher {
   std::vector<AsyncQueueType> taskSpecificQueueGroup_;
   std::vector<std::shared_ptr<std::thread>> taskSpecificThreadPool_;
   std::ext::spin_mutex mtxTaskSpecificThreadPool_;
+
+  //! queueCapacity_大于0时使用以下的环形队列代替上面的moodycamel队列
+  bool useRingQueue_{false};
+  std::vector<AsyncTaskRingQueueUPtr> ringQueueGroupOfTaskRandAssignedThread_;
+  std::vector<AsyncTaskRingQueueUPtr> ringQueueGroupOfTaskSpecificThread_;
+  std::atomic<std::size_t> noOfRandAssignedQueue_{0};
 };
 
 }  // namespace bq
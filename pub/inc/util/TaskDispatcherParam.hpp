@@ -21,7 +21,10 @@ const static std::string DEFAULT_TASK_DISPATCHER_PARAM =
     "moduleName=TaskDispatcher; numOfUnprocessedTaskAlert=100; "
     "maxBulkRecvTaskNumEveryTime=1; timeDurOfWaitForTask=500; "
     "taskRandAssignedThreadPoolSize=1; taskSpecificThreadPoolSize=4; "
-    "preCreateTaskSpecificThreadPool=0";
+    "preCreateTaskSpecificThreadPool=0; queueCapacity=0; "
+    "enableWorkStealing=0; spinCountBeforeYield=1000; "
+    "yieldCountBeforePark=100; cpuIdGroupOfTaskRandAssignedThread=; "
+    "cpuIdGroupOfTaskSpecificThread=";
 
 struct TaskDispatcherParam;
 using TaskDispatcherParamSPtr = std::shared_ptr<TaskDispatcherParam>;
@@ -43,8 +46,28 @@ struct TaskDispatcherParam {
   std::uint32_t maxBulkRecvTaskNumEveryTime_{1};
   std::uint32_t timeDurOfWaitForTask_{1000};
   bool preCreateTaskSpecificThreadPool_{false};
+
+  //!
+  //! 以下参数未配置时保持原有的行为：
+  //! queueCapacity_大于0时使用预分配的环形队列代替moodycamel队列，队列满的时候
+  //! 生产者自旋等待，同时统计队列深度和任务排队时延；
+  //! enableWorkStealing_只在环形队列模式下生效，随机分配的任务轮流放入每个随机
+  //! 线程自己的队列，空闲的线程从其他线程的队列中窃取任务；
+  //! 空闲线程先自旋spinCountBeforeYield_次，再让出cpu yieldCountBeforePark_次，
+  //! 之后通过futex休眠，最长休眠timeDurOfWaitForTask_毫秒；
+  //! cpuIdGroup为逗号分隔的cpu编号，线程按编号依次绑定，为空则不绑定。
+  //!
+  std::uint32_t queueCapacity_{0};
+  bool enableWorkStealing_{false};
+  std::uint32_t spinCountBeforeYield_{1000};
+  std::uint32_t yieldCountBeforePark_{100};
+  std::vector<int> cpuIdGroupOfTaskRandAssignedThread_;
+  std::vector<int> cpuIdGroupOfTaskSpecificThread_;
 };
 
+//! 将"2,3,4"格式的cpu编号列表转换为数组，格式错误时抛出异常
+std::vector<int> MakeCpuIdGroup(const std::string& cpuIdGroupInStrFmt);
+
 std::tuple<int, TaskDispatcherParamSPtr> MakeTaskDispatcherParam(
     const std::string& taskDispatcherParamInStrFmt);
 
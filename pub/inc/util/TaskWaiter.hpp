@@ -0,0 +1,63 @@
+/*!
+ * \file TaskWaiter.hpp
+ * \project BetterQuant
+ *
+ * \author byrnexu
+ * \date 2023/04/03
+ *
+ * \brief
+ */
+
+#pragma once
+
+#include "util/PchBase.hpp"
+
+namespace bq {
+
+//!
+//! 空闲的消费者线程通过futex休眠，生产者入队之后唤醒：
+//! 1. 只有存在休眠的线程时notify才会产生系统调用，忙碌的时候开销只是一次原子读；
+//! 2. 休眠前登记之后再检查一次队列，和生产者的入队、检查配合，不会丢失唤醒；
+//! 3. 休眠有超时，即使出现意外也只会延迟处理而不会一直阻塞。
+//!
+class TaskWaiter {
+ public:
+  TaskWaiter(const TaskWaiter&) = delete;
+  TaskWaiter& operator=(const TaskWaiter&) = delete;
+  TaskWaiter(const TaskWaiter&&) = delete;
+  TaskWaiter& operator=(const TaskWaiter&&) = delete;
+
+  TaskWaiter() = default;
+
+ public:
+  void notify() { doNotify(1); }
+  void notifyAll() { doNotify(INT32_MAX); }
+
+  template <typename CBHasTask>
+  void park(std::uint32_t milliSecTimeout, const CBHasTask& cbHasTask) {
+    const auto seq = seq_.load(std::memory_order_acquire);
+    numOfParked_.fetch_add(1, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!cbHasTask()) {
+      wait(seq, milliSecTimeout);
+    }
+    numOfParked_.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+ private:
+  void doNotify(int numOfThreadToWake) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (numOfParked_.load(std::memory_order_relaxed) == 0) return;
+    seq_.fetch_add(1, std::memory_order_release);
+    wake(numOfThreadToWake);
+  }
+
+  void wait(std::uint32_t seq, std::uint32_t milliSecTimeout);
+  void wake(int numOfThreadToWake);
+
+ private:
+  std::atomic<std::uint32_t> seq_{0};
+  std::atomic<std::uint32_t> numOfParked_{0};
+};
+
+}  // namespace bq
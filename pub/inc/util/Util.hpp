@@ -61,4 +61,16 @@ struct AutoFreeYYDoc {
 
 void SetThreadName(const std::thread t, const std::string& name);
 
+//! 将当前线程绑定到指定的cpu，成功返回0
+int SetCpuAffinityOfCurThread(int cpuId);
+
+//! 自旋等待时调用，降低功耗并且让出流水线给同一个物理核上的其他超线程
+inline void CpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield" ::: "memory");
+#endif
+}
+
 }  // namespace bq
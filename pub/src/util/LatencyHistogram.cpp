@@ -0,0 +1,68 @@
+/*!
+ * \file LatencyHistogram.cpp
+ * \project BetterQuant
+ *
+ * \author byrnexu
+ * \date 2023/04/05
+ *
+ * \brief
+ */
+
+#include "util/LatencyHistogram.hpp"
+
+#include "util/Pch.hpp"
+
+namespace bq {
+
+void LatencyHistogramData::merge(const LatencyHistogramData& rhs) {
+  for (std::size_t i = 0; i < NUM_OF_LATENCY_BUCKET; ++i) {
+    bucketGroup_[i] += rhs.bucketGroup_[i];
+  }
+  num_ += rhs.num_;
+  total_ += rhs.total_;
+  max_ = std::max(max_, rhs.max_);
+}
+
+std::uint64_t LatencyHistogramData::getPercentile(double percentile) const {
+  if (num_ == 0) return 0;
+  const auto target = static_cast<std::uint64_t>(std::ceil(num_ * percentile));
+  std::uint64_t num = 0;
+  for (std::size_t i = 0; i < NUM_OF_LATENCY_BUCKET; ++i) {
+    num += bucketGroup_[i];
+    if (num >= target) {
+      return std::min(LatencyHistogram::GetUpperBoundOfBucket(i), max_);
+    }
+  }
+  return max_;
+}
+
+std::string LatencyHistogramData::toStr() const {
+  return fmt::format(
+      "[num = {}; avg = {:.2f}; p50 = {}; p90 = {}; p99 = {}; p999 = {}; "
+      "max = {}]",
+      num_, num_ == 0 ? 0.0 : static_cast<double>(total_) / num_,
+      getPercentile(0.5), getPercentile(0.9), getPercentile(0.99),
+      getPercentile(0.999), max_);
+}
+
+LatencyHistogramData LatencyHistogram::getData() const {
+  LatencyHistogramData ret;
+  for (std::size_t i = 0; i < NUM_OF_LATENCY_BUCKET; ++i) {
+    ret.bucketGroup_[i] = bucketGroup_[i].load(std::memory_order_relaxed);
+  }
+  ret.num_ = num_.load(std::memory_order_relaxed);
+  ret.total_ = total_.load(std::memory_order_relaxed);
+  ret.max_ = max_.load(std::memory_order_relaxed);
+  return ret;
+}
+
+void LatencyHistogram::reset() {
+  for (auto& bucket : bucketGroup_) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+  num_.store(0, std::memory_order_relaxed);
+  total_.store(0, std::memory_order_relaxed);
+  max_.store(0, std::memory_order_relaxed);
+}
+
+}  // namespace bq
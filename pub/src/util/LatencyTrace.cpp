@@ -0,0 +1,103 @@
+/*!
+ * \file LatencyTrace.cpp
+ * \project BetterQuant
+ *
+ * \author byrnexu
+ * \date 2023/04/16
+ *
+ * \brief
+ */
+
+#include "util/LatencyTrace.hpp"
+
+#include "util/Logger.hpp"
+
+namespace bq {
+
+LatencyTrace::LatencyTrace() {
+  //! 每个环节一个直方图，最后一个是TickToOrder
+  for (std::size_t i = 0; i <= NUM_OF_TRACE_HOP; ++i) {
+    histogramGroup_.emplace_back(std::make_unique<LatencyHistogram>());
+  }
+}
+
+void LatencyTrace::enable() {
+  if (enabled()) return;
+
+#if defined(__x86_64__) || defined(__i386__)
+  const auto nsStart = std::chrono::steady_clock::now();
+  const auto tscStart = GetTSC();
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  const auto tscEnd = GetTSC();
+  const auto nsEnd = std::chrono::steady_clock::now();
+  const auto ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(nsEnd - nsStart)
+          .count();
+  if (tscEnd > tscStart) {
+    nsPerTSC_ = static_cast<double>(ns) / (tscEnd - tscStart);
+  }
+#endif
+
+  enabled_.store(true, std::memory_order_release);
+  LOG_I("Enable latency trace. [nsPerTSC = {:.6f}]", nsPerTSC_);
+}
+
+std::uint64_t LatencyTrace::stamp(TraceHop traceHop,
+                                  std::uint64_t tscOfPrevHop) {
+  if (!enabled()) return 0;
+  const auto tsc = GetTSC();
+  record(traceHop, tsc, tscOfPrevHop);
+  return tsc;
+}
+
+void LatencyTrace::stamp(TraceRecord& traceRecord, TraceHop traceHop) {
+  if (!enabled()) return;
+  const auto tsc = GetTSC();
+  traceRecord.set(traceHop, tsc);
+  record(traceHop, tsc, traceRecord.getTSCOfPrevHop(traceHop));
+  if (traceHop == TraceHop::GatewaySend) {
+    record(TraceHop::TickToOrder, tsc, traceRecord.getTSCOfFirstHop());
+  }
+}
+
+void LatencyTrace::stamp(TraceCtx& traceCtx, TraceHop traceHop) {
+  if (!enabled()) return;
+  const auto tsc = GetTSC();
+  record(traceHop, tsc, traceCtx.tscOfPrevHop_);
+  traceCtx.tscOfPrevHop_ = tsc;
+  if (traceCtx.tscOfFirstHop_ == 0) {
+    traceCtx.tscOfFirstHop_ = tsc;
+  }
+  if (traceHop == TraceHop::GatewaySend) {
+    record(TraceHop::TickToOrder, tsc, traceCtx.tscOfFirstHop_);
+  }
+}
+
+void LatencyTrace::record(TraceHop traceHop, std::uint64_t tsc,
+                          std::uint64_t tscOfPrev) {
+  //! 上一个环节没有经过或者tsc回退（不同的机器）的时候不统计
+  if (tscOfPrev == 0 || tscOfPrev > tsc) return;
+  const auto ns = static_cast<std::uint64_t>((tsc - tscOfPrev) * nsPerTSC_);
+  histogramGroup_[static_cast<std::size_t>(traceHop)]->record(ns);
+}
+
+std::string LatencyTrace::dump() const {
+  if (!enabled()) return "Latency trace is not enabled.";
+  std::string ret = "Latency trace in ns:";
+  for (std::size_t i = 0; i < histogramGroup_.size(); ++i) {
+    const auto histogramData = histogramGroup_[i]->getData();
+    if (histogramData.num_ == 0) continue;
+    ret += fmt::format("\n[{}] {}",
+                       magic_enum::enum_name(static_cast<TraceHop>(i)),
+                       histogramData.toStr());
+  }
+  return ret;
+}
+
+void LatencyTrace::reset() {
+  for (auto& histogram : histogramGroup_) {
+    histogram->reset();
+  }
+}
+
+}  // namespace bq
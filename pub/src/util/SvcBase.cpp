@@ -11,6 +11,7 @@
 #include "util/SvcBase.hpp"
 
 #include "db/DBE.hpp"
+#include "util/LatencyTrace.hpp"
 #include "util/Logger.hpp"
 #include "util/Random.hpp"
 #include "util/SignalHandler.hpp"
@@ -23,9 +24,7 @@ SvcBase::SvcBase(const std::string& configFilename,
   RandomStr::get_mutable_instance().init();
   RandomInt::get_mutable_instance().init();
   if (installSignalHandler == InstallSignalHandler::True) {
-    signalHandler_ = std::make_shared<SignalHandler>(
-        "SVC_BASE", [this](const boost::system::error_code& ec,
-                           int signalNumber) { exit(&ec, signalNumber); });
+    signalHandler_ = makeSignalHandler();
   }
 }
 
@@ -39,9 +38,7 @@ int SvcBase::init(const std::string& configFilename,
 
   if (signalHandler_ == nullptr &&
       installSignalHandler == InstallSignalHandler::True) {
-    signalHandler_ = std::make_shared<SignalHandler>(
-        "SVC_BASE", [this](const boost::system::error_code& ec,
-                           int signalNumber) { exit(&ec, signalNumber); });
+    signalHandler_ = makeSignalHandler();
   }
 
   if (auto ret = prepareInit(); ret != 0) {
@@ -92,6 +89,22 @@ int SvcBase::afterRun() {
   return 0;
 }
 
+SignalHandlerSPtr SvcBase::makeSignalHandler() {
+  auto ret = std::make_shared<SignalHandler>(
+      "SVC_BASE", [this](const boost::system::error_code& ec,
+                         int signalNumber) { exit(&ec, signalNumber); });
+  //! SIGUSR1输出时延追踪的统计结果
+  ret->setDefaultSignalHandler(
+      [](const boost::system::error_code& ec, int signalNumber) {
+#if defined(__linux__)
+        if (signalNumber == SIGUSR1) {
+          LOG_I("{}", LatencyTrace::get_const_instance().dump());
+        }
+#endif
+      });
+  return ret;
+}
+
 void SvcBase::exit(const boost::system::error_code* ec, int signalNum) {
   beforeExit(ec, signalNum);
   doExit(ec, signalNum);
@@ -30,6 +30,15 @@ TaskDispatcherParam::TaskDispatcherParam(
       timeDurOfWaitForTask_(timeDurOfWaitForTask),
       preCreateTaskSpecificThreadPool_(preCreateTaskSpecificThreadPool) {}
 
+std::vector<int> MakeCpuIdGroup(const std::string& cpuIdGroupInStrFmt) {
+  std::vector<int> ret;
+  const auto cpuIdGroup = SplitStr(cpuIdGroupInStrFmt, ",");
+  for (const auto& cpuId : cpuIdGroup) {
+    ret.emplace_back(CONV(int, std::string(cpuId)));
+  }
+  return ret;
+}
+
 std::tuple<int, TaskDispatcherParamSPtr> MakeTaskDispatcherParam(
     const std::string& taskDispatcherParamInStrFmt) {
   auto [retOfStr2Map, taskDispatcherParamTable] =
@@ -76,6 +85,39 @@ std::tuple<int, TaskDispatcherParamSPtr> MakeTaskDispatcherParam(
     auto preCreate = CONV(std::uint32_t, fieldValue);
     ret->preCreateTaskSpecificThreadPool_ = preCreate == 0 ? false : true;
 
+    //! 以下为可选参数，兼容没有合并默认参数的配置
+    fieldName = "queuecapacity";
+    fieldValue = taskDispatcherParamTable[fieldName];
+    if (!fieldValue.empty()) {
+      ret->queueCapacity_ = CONV(std::uint32_t, fieldValue);
+    }
+
+    fieldName = "enableworkstealing";
+    fieldValue = taskDispatcherParamTable[fieldName];
+    if (!fieldValue.empty()) {
+      ret->enableWorkStealing_ = CONV(std::uint32_t, fieldValue) != 0;
+    }
+
+    fieldName = "spincountbeforeyield";
+    fieldValue = taskDispatcherParamTable[fieldName];
+    if (!fieldValue.empty()) {
+      ret->spinCountBeforeYield_ = CONV(std::uint32_t, fieldValue);
+    }
+
+    fieldName = "yieldcountbeforepark";
+    fieldValue = taskDispatcherParamTable[fieldName];
+    if (!fieldValue.empty()) {
+      ret->yieldCountBeforePark_ = CONV(std::uint32_t, fieldValue);
+    }
+
+    fieldName = "cpuidgroupoftaskrandassignedthread";
+    fieldValue = taskDispatcherParamTable[fieldName];
+    ret->cpuIdGroupOfTaskRandAssignedThread_ = MakeCpuIdGroup(fieldValue);
+
+    fieldName = "cpuidgroupoftaskspecificthread";
+    fieldValue = taskDispatcherParamTable[fieldName];
+    ret->cpuIdGroupOfTaskSpecificThread_ = MakeCpuIdGroup(fieldValue);
+
   } catch (const std::exception& e) {
     LOG_E(
         "Make task dispatcher param failed "
@@ -0,0 +1,44 @@
+/*!
+ * \file TaskWaiter.cpp
+ * \project BetterQuant
+ *
+ * \author byrnexu
+ * \date 2023/04/03
+ *
+ * \brief
+ */
+
+#include "util/TaskWaiter.hpp"
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace bq {
+
+void TaskWaiter::wait(std::uint32_t seq, std::uint32_t milliSecTimeout) {
+#if defined(__linux__)
+  struct timespec timeout;
+  timeout.tv_sec = milliSecTimeout / 1000;
+  timeout.tv_nsec = (milliSecTimeout % 1000) * 1000000;
+  //! seq_已经变化说明在登记之后有新的任务入队，futex会直接返回
+  syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&seq_),
+          FUTEX_WAIT_PRIVATE, seq, &timeout, nullptr, 0);
+#else
+  if (seq_.load(std::memory_order_acquire) == seq) {
+    std::this_thread::sleep_for(
+        std::chrono::milliseconds(std::min<std::uint32_t>(milliSecTimeout, 1)));
+  }
+#endif
+}
+
+void TaskWaiter::wake(int numOfThreadToWake) {
+#if defined(__linux__)
+  syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&seq_),
+          FUTEX_WAKE_PRIVATE, numOfThreadToWake, nullptr, nullptr, 0);
+#endif
+}
+
+}  // namespace bq
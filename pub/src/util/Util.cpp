@@ -12,6 +12,12 @@
 
 #include "def/SHMDef.hpp"
 #include "util/LRUCache.hpp"
+#include "util/Logger.hpp"
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 namespace bq {
 
@@ -21,4 +27,22 @@ void SetThreadName(const std::thread t, const std::string& name) {
 #endif
 }
 
+int SetCpuAffinityOfCurThread(int cpuId) {
+#if defined(__linux__)
+  cpu_set_t cpuSet;
+  CPU_ZERO(&cpuSet);
+  CPU_SET(cpuId, &cpuSet);
+  const auto ret =
+      pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuSet);
+  if (ret != 0) {
+    LOG_W("Set cpu affinity of cur thread to {} failed. [ret = {}]", cpuId,
+          ret);
+    return -1;
+  }
+  return 0;
+#else
+  return -1;
+#endif
+}
+
 }  // namespace bq
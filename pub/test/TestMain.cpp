@@ -13,8 +13,12 @@
 
 #include <string>
 
+#include "util/DecimalParser.hpp"
 #include "util/File.hpp"
+#include "util/LatencyHistogram.hpp"
+#include "util/LatencyTrace.hpp"
 #include "util/String.hpp"
+#include "util/TaskDispatcher.hpp"
 
 using namespace bq;
 
@@ -49,6 +53,19 @@ TEST(test, testBase64) {
   EXPECT_TRUE(origStr == decodeStr);
 }
 
+TEST(test, testDecimalParser) {
+  EXPECT_TRUE(Str2Dbl("29000.12000000") == strtod("29000.12000000", nullptr));
+  EXPECT_TRUE(Str2Dbl("-0.00051000") == -0.00051);
+  EXPECT_TRUE(Str2Dbl("1e-8") == 1e-8);
+
+  std::int64_t value = 0;
+  EXPECT_TRUE(Str2ScaledInt("0.29", 12, value));
+  EXPECT_TRUE(value == 290000000000);
+  EXPECT_TRUE(Str2ScaledInt("0.123456785", 8, value));
+  EXPECT_TRUE(value == 12345679);
+  EXPECT_FALSE(Str2ScaledInt("1e-8", 8, value));
+}
+
 TEST(test, testFile) {
   std::vector<std::string> lineGroup;
   lineGroup.emplace_back("aaa");
@@ -61,6 +78,100 @@ TEST(test, testFile) {
   EXPECT_TRUE(lg[1] == "bbb");
 }
 
+TEST(test, testTaskDispatcherWithRingQueue) {
+  const auto taskDispatcherParamInStrFmt = SetParam(
+      DEFAULT_TASK_DISPATCHER_PARAM,
+      "moduleName=test; queueCapacity=8; enableWorkStealing=1; "
+      "taskRandAssignedThreadPoolSize=2; taskSpecificThreadPoolSize=2; "
+      "maxBulkRecvTaskNumEveryTime=4; timeDurOfWaitForTask=10");
+  const auto [ret, taskDispatcherParam] =
+      MakeTaskDispatcherParam(taskDispatcherParamInStrFmt);
+  EXPECT_TRUE(ret == 0);
+  EXPECT_TRUE(taskDispatcherParam->queueCapacity_ == 8);
+  EXPECT_TRUE(taskDispatcherParam->enableWorkStealing_);
+
+  std::atomic<std::uint64_t> sum{0};
+  TaskDispatcher<std::uint64_t> taskDispatcher(
+      taskDispatcherParam, nullptr,
+      [](const auto& asyncTask, std::uint32_t taskSpecificThreadPoolSize) {
+        return asyncTask->task_ % 2 == 0
+                   ? RAND_THREAD
+                   : asyncTask->task_ % taskSpecificThreadPoolSize;
+      },
+      [&](auto& asyncTask) { sum += asyncTask->task_; });
+  taskDispatcher.init();
+  taskDispatcher.start();
+
+  std::uint64_t expected = 0;
+  for (std::uint64_t i = 1; i <= 10000; ++i) {
+    auto asyncTask = std::make_shared<AsyncTask<std::uint64_t>>(i);
+    taskDispatcher.dispatch(asyncTask);
+    expected += i;
+  }
+  taskDispatcher.stop();
+
+  EXPECT_TRUE(sum == expected);
+  const auto statistic = taskDispatcher.getTaskQueueStatistic(RAND_THREAD);
+  EXPECT_TRUE(statistic.numOfEnqueued_ == 5000);
+  EXPECT_TRUE(statistic.numOfDequeued_ == 5000);
+  EXPECT_TRUE(statistic.depth_ == 0);
+}
+
+TEST(test, testLatencyHistogram) {
+  for (const auto value : std::initializer_list<std::uint64_t>{
+           0, 127, 128, 1000, 123456789, MAX_VALUE_OF_LATENCY_HISTOGRAM}) {
+    const auto bucketNo = LatencyHistogram::GetBucketNo(value);
+    EXPECT_TRUE(bucketNo < NUM_OF_LATENCY_BUCKET);
+    EXPECT_TRUE(LatencyHistogram::GetUpperBoundOfBucket(bucketNo) >= value);
+    EXPECT_TRUE(bucketNo == 0 ||
+                LatencyHistogram::GetUpperBoundOfBucket(bucketNo - 1) < value);
+    //! 相对误差不超过1/64
+    EXPECT_TRUE(LatencyHistogram::GetUpperBoundOfBucket(bucketNo) - value <=
+                value / 64);
+  }
+
+  LatencyHistogram latencyHistogram;
+  for (std::uint64_t i = 1; i <= 1000; ++i) latencyHistogram.record(i);
+  auto data = latencyHistogram.getData();
+  EXPECT_TRUE(data.num_ == 1000);
+  EXPECT_TRUE(data.max_ == 1000);
+  EXPECT_TRUE(data.getPercentile(0.5) >= 500 && data.getPercentile(0.5) < 508);
+  EXPECT_TRUE(data.getPercentile(0.99) >= 990 &&
+              data.getPercentile(0.99) < 1000);
+
+  data.merge(latencyHistogram.getData());
+  EXPECT_TRUE(data.num_ == 2000);
+
+  latencyHistogram.reset();
+  EXPECT_TRUE(latencyHistogram.getData().num_ == 0);
+}
+
+TEST(test, testLatencyTrace) {
+  TraceRecord traceRecord;
+  traceRecord.set(TraceHop::MDRecv, 100);
+  traceRecord.set(TraceHop::OrderSend, 200);
+  EXPECT_TRUE(traceRecord.getTSCOfPrevHop(TraceHop::TDSrvRecv) == 200);
+  EXPECT_TRUE(traceRecord.getTSCOfPrevHop(TraceHop::MDPub) == 100);
+  EXPECT_TRUE(traceRecord.getTSCOfFirstHop() == 100);
+
+  const auto traceCtx = MakeTraceCtx(traceRecord);
+  EXPECT_TRUE(traceCtx.tscOfFirstHop_ == 100);
+  EXPECT_TRUE(traceCtx.tscOfPrevHop_ == 200);
+
+  TraceCtx traceCtxOfOrder;
+  LatencyTrace::get_mutable_instance().enable();
+  LatencyTrace::get_mutable_instance().stamp(traceCtxOfOrder,
+                                             TraceHop::OrderSend);
+  EXPECT_TRUE(traceCtxOfOrder.tscOfFirstHop_ != 0);
+  EXPECT_TRUE(traceCtxOfOrder.tscOfPrevHop_ ==
+              traceCtxOfOrder.tscOfFirstHop_);
+  LatencyTrace::get_mutable_instance().stamp(traceCtxOfOrder,
+                                             TraceHop::GatewaySend);
+  EXPECT_TRUE(traceCtxOfOrder.tscOfPrevHop_ >=
+              traceCtxOfOrder.tscOfFirstHop_);
+  EXPECT_TRUE(GetTraceHopOfRiskCtrlModule(100) == TraceHop::RiskCtrlModule5);
+}
+
 int main(int argc, char** argv) {
   testing::AddGlobalTestEnvironment(new global_event);
   testing::InitGoogleTest(&argc, argv);